@@ -0,0 +1,1017 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/* httpapi_async on top of a curl multi handle: all the requests of an instance share the multi handle,
+   its connection cache and its socket callbacks, so one thread drives them all from httpapi_async_dowork
+   with curl_multi_socket_action. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <poll.h>
+
+#include "curl/curl.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/httpapi_async.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/singlylinkedlist.h"
+#include "azure_c_shared_utility/shared_util_options.h"
+#ifdef USE_OPENSSL
+#include "azure_c_shared_utility/x509_openssl.h"
+#elif USE_WOLFSSL
+#define WOLFSSL_OPTIONS_IGNORE_SYS
+#include "wolfssl/options.h"
+#include "wolfssl/ssl.h"
+#include "wolfssl/error-ssl.h"
+#endif
+
+/* curl's default for CURLMOPT_MAX_CONCURRENT_STREAMS */
+#define MAX_STREAMS_PER_CONNECTION 100
+
+DEFINE_ENUM_STRINGS(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_RESULT_VALUES);
+
+typedef struct ASYNC_REQUEST_TAG
+{
+    struct HTTPAPI_ASYNC_INSTANCE_TAG* httpapi_async;
+    CURL* curl;
+    struct curl_slist* request_headers;
+    /* the item in pending_requests, or in active_requests once the easy handle is in the multi handle */
+    LIST_ITEM_HANDLE list_item;
+    bool is_active;
+    ON_HTTPAPI_ASYNC_REQUEST_COMPLETE on_request_complete;
+    void* callback_context;
+    HTTP_HEADERS_HANDLE response_headers;
+    BUFFER_HANDLE response_content;
+    bool is_response_failed;
+    bool is_retried;
+} ASYNC_REQUEST;
+
+typedef struct HTTPAPI_ASYNC_INSTANCE_TAG
+{
+    char* host_url;
+    CURLM* multi;
+    size_t max_connections;
+    size_t active_count;
+    /* set once a request completed over HTTP/2, from then on a connection carries many requests at once */
+    bool is_multiplexed;
+    /* requests wait here until a transfer slot is free, curl does work for every handle it holds on each call */
+    SINGLYLINKEDLIST_HANDLE pending_requests;
+    SINGLYLINKEDLIST_HANDLE active_requests;
+    /* the sockets curl asked to watch, kept in the layout poll wants */
+    struct pollfd* sockets;
+    size_t socket_count;
+    size_t socket_capacity;
+    struct pollfd* ready_sockets;
+    bool is_timer_armed;
+    char* trusted_certs;
+    char* x509_certificate;
+    char* x509_private_key;
+    char* proxy;
+    char* proxy_user_password;
+    unsigned int timeout_ms;
+    long low_speed_limit;
+    long low_speed_time;
+    long fresh_connect;
+    long forbid_reuse;
+    long verbose;
+    long http_version;
+} HTTPAPI_ASYNC_INSTANCE;
+
+static const char* get_request_type_string(HTTPAPI_REQUEST_TYPE request_type)
+{
+    const char* result;
+
+    switch (request_type)
+    {
+    case HTTPAPI_REQUEST_GET:
+        result = "GET";
+        break;
+    case HTTPAPI_REQUEST_POST:
+        result = "POST";
+        break;
+    case HTTPAPI_REQUEST_PUT:
+        result = "PUT";
+        break;
+    case HTTPAPI_REQUEST_DELETE:
+        result = "DELETE";
+        break;
+    case HTTPAPI_REQUEST_PATCH:
+        result = "PATCH";
+        break;
+    default:
+        result = NULL;
+        break;
+    }
+
+    return result;
+}
+
+static int on_socket(CURL* curl, curl_socket_t socket, int what, void* user_context, void* socket_context)
+{
+    int result;
+    HTTPAPI_ASYNC_INSTANCE* httpapi_async = (HTTPAPI_ASYNC_INSTANCE*)user_context;
+    size_t i;
+    (void)curl;
+    (void)socket_context;
+
+    for (i = 0; i < httpapi_async->socket_count; i++)
+    {
+        if (httpapi_async->sockets[i].fd == socket)
+        {
+            break;
+        }
+    }
+
+    if (what == CURL_POLL_REMOVE)
+    {
+        if (i < httpapi_async->socket_count)
+        {
+            httpapi_async->sockets[i] = httpapi_async->sockets[--httpapi_async->socket_count];
+        }
+        result = 0;
+    }
+    else
+    {
+        result = 0;
+
+        if (i == httpapi_async->socket_count)
+        {
+            if (httpapi_async->socket_count == httpapi_async->socket_capacity)
+            {
+                size_t new_capacity = (httpapi_async->socket_capacity == 0) ? 4 : httpapi_async->socket_capacity * 2;
+                struct pollfd* new_sockets = (struct pollfd*)realloc(httpapi_async->sockets, new_capacity * sizeof(struct pollfd));
+                struct pollfd* new_ready_sockets;
+                if (new_sockets == NULL)
+                {
+                    LogError("Cannot allocate memory for the socket list");
+                    result = -1;
+                }
+                else
+                {
+                    httpapi_async->sockets = new_sockets;
+                    new_ready_sockets = (struct pollfd*)realloc(httpapi_async->ready_sockets, new_capacity * sizeof(struct pollfd));
+                    if (new_ready_sockets == NULL)
+                    {
+                        LogError("Cannot allocate memory for the socket list");
+                        result = -1;
+                    }
+                    else
+                    {
+                        httpapi_async->ready_sockets = new_ready_sockets;
+                        httpapi_async->socket_capacity = new_capacity;
+                    }
+                }
+            }
+
+            if (result == 0)
+            {
+                httpapi_async->sockets[i].fd = socket;
+                httpapi_async->socket_count++;
+            }
+        }
+
+        if (result == 0)
+        {
+            httpapi_async->sockets[i].events = (short)(((what & CURL_POLL_IN) ? POLLIN : 0) | ((what & CURL_POLL_OUT) ? POLLOUT : 0));
+            httpapi_async->sockets[i].revents = 0;
+        }
+    }
+
+    return result;
+}
+
+static int on_timer(CURLM* multi, long timeout_ms, void* user_context)
+{
+    HTTPAPI_ASYNC_INSTANCE* httpapi_async = (HTTPAPI_ASYNC_INSTANCE*)user_context;
+    (void)multi;
+
+    /* the timeout itself is not tracked: curl_multi_socket_action with CURL_SOCKET_TIMEOUT is cheap and does nothing before
+       the deadline, so httpapi_async_dowork calls it on every pass while a timer is armed */
+    httpapi_async->is_timer_armed = (timeout_ms >= 0);
+    return 0;
+}
+
+static size_t on_header(char* buffer, size_t size, size_t nitems, void* user_context)
+{
+    ASYNC_REQUEST* request = (ASYNC_REQUEST*)user_context;
+    size_t length = size * nitems;
+    size_t name_length = 0;
+
+    /* curl passes one complete header line per call, status lines included; only "name: value" lines are kept */
+    while ((name_length < length) && (buffer[name_length] != ':') && (buffer[name_length] != '\r') && (buffer[name_length] != '\n'))
+    {
+        name_length++;
+    }
+
+    if ((name_length > 0) && (name_length < length) && (buffer[name_length] == ':') && (strncmp(buffer, "HTTP/", 5) != 0))
+    {
+        size_t value_start = name_length + 1;
+        size_t value_end = length;
+        char* line;
+
+        while ((value_start < value_end) && ((buffer[value_start] == ' ') || (buffer[value_start] == '\t')))
+        {
+            value_start++;
+        }
+        while ((value_end > value_start) && ((buffer[value_end - 1] == '\r') || (buffer[value_end - 1] == '\n') || (buffer[value_end - 1] == ' ') || (buffer[value_end - 1] == '\t')))
+        {
+            value_end--;
+        }
+
+        line = (char*)malloc(length + 1);
+        if (line == NULL)
+        {
+            LogError("Cannot allocate memory for the response header");
+            request->is_response_failed = true;
+        }
+        else
+        {
+            (void)memcpy(line, buffer, name_length);
+            line[name_length] = '\0';
+            (void)memcpy(line + name_length + 1, buffer + value_start, value_end - value_start);
+            line[name_length + 1 + value_end - value_start] = '\0';
+
+            if (HTTPHeaders_AddHeaderNameValuePair(request->response_headers, line, line + name_length + 1) != HTTP_HEADERS_OK)
+            {
+                LogError("Cannot add the response header");
+                request->is_response_failed = true;
+            }
+
+            free(line);
+        }
+    }
+
+    return request->is_response_failed ? 0 : length;
+}
+
+static size_t on_content(char* buffer, size_t size, size_t nmemb, void* user_context)
+{
+    ASYNC_REQUEST* request = (ASYNC_REQUEST*)user_context;
+    size_t length = size * nmemb;
+
+    if ((length > 0) && (BUFFER_append_build(request->response_content, (const unsigned char*)buffer, length) != 0))
+    {
+        LogError("Cannot allocate memory for the response content");
+        request->is_response_failed = true;
+        length = 0;
+    }
+
+    return length;
+}
+
+static CURLcode on_ssl_ctx(CURL* curl, void* ssl_ctx, void* user_context)
+{
+    CURLcode result;
+    HTTPAPI_ASYNC_INSTANCE* httpapi_async = (HTTPAPI_ASYNC_INSTANCE*)user_context;
+    (void)curl;
+
+#ifdef USE_OPENSSL
+    if ((httpapi_async->x509_certificate != NULL) && (httpapi_async->x509_private_key != NULL) &&
+        (x509_openssl_add_credentials(ssl_ctx, httpapi_async->x509_certificate, httpapi_async->x509_private_key) != 0))
+    {
+        LogError("unable to x509_openssl_add_credentials");
+        result = CURLE_SSL_CERTPROBLEM;
+    }
+    else if ((httpapi_async->trusted_certs != NULL) &&
+        (x509_openssl_add_certificates(ssl_ctx, httpapi_async->trusted_certs) != 0))
+    {
+        LogError("failure in x509_openssl_add_certificates");
+        result = CURLE_SSL_CERTPROBLEM;
+    }
+#elif USE_WOLFSSL
+    if ((httpapi_async->x509_certificate != NULL) && (httpapi_async->x509_private_key != NULL) &&
+        ((wolfSSL_use_certificate_chain_buffer(ssl_ctx, (unsigned char*)httpapi_async->x509_certificate, strlen(httpapi_async->x509_certificate)) != SSL_SUCCESS) ||
+         (wolfSSL_use_PrivateKey_buffer(ssl_ctx, (unsigned char*)httpapi_async->x509_private_key, strlen(httpapi_async->x509_private_key), SSL_FILETYPE_PEM) != SSL_SUCCESS)))
+    {
+        LogError("unable to add x509 certs to wolfssl");
+        result = CURLE_SSL_CERTPROBLEM;
+    }
+    else if ((httpapi_async->trusted_certs != NULL) &&
+        (wolfSSL_CTX_load_verify_buffer(ssl_ctx, (const unsigned char*)httpapi_async->trusted_certs, strlen(httpapi_async->trusted_certs), SSL_FILETYPE_PEM) != SSL_SUCCESS))
+    {
+        LogError("failure in adding trusted certificate to client");
+        result = CURLE_SSL_CERTPROBLEM;
+    }
+#else
+    (void)ssl_ctx;
+    if ((httpapi_async->x509_certificate != NULL) || (httpapi_async->x509_private_key != NULL))
+    {
+        LogError("Failure no platform is enabled to handle certificates");
+        result = CURLE_SSL_CERTPROBLEM;
+    }
+#endif
+    else
+    {
+        result = CURLE_OK;
+    }
+
+    return result;
+}
+
+static int set_request_options(HTTPAPI_ASYNC_INSTANCE* httpapi_async, ASYNC_REQUEST* request, HTTPAPI_REQUEST_TYPE request_type, const char* relative_path, const unsigned char* content, size_t content_length)
+{
+    int result;
+    char* url = (char*)malloc(strlen(httpapi_async->host_url) + strlen(relative_path) + 1);
+
+    if (url == NULL)
+    {
+        LogError("Cannot allocate memory for the request URL");
+        result = __FAILURE__;
+    }
+    else
+    {
+        (void)strcpy(url, httpapi_async->host_url);
+        (void)strcat(url, relative_path);
+
+        if ((curl_easy_setopt(request->curl, CURLOPT_URL, url) != CURLE_OK) ||
+            (curl_easy_setopt(request->curl, CURLOPT_PRIVATE, request) != CURLE_OK) ||
+            (curl_easy_setopt(request->curl, CURLOPT_NOSIGNAL, 1L) != CURLE_OK) ||
+            (curl_easy_setopt(request->curl, CURLOPT_HTTP_VERSION, httpapi_async->http_version) != CURLE_OK) ||
+#if LIBCURL_VERSION_NUM >= 0x072B00
+            /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_030: [ When `CURLOPT_HTTP_VERSION` asks for HTTP/2, `httpapi_async_execute_request` shall also set `CURLOPT_PIPEWAIT`, so the request waits for a connection it can multiplex on instead of opening a new one. ]*/
+            ((httpapi_async->http_version >= CURL_HTTP_VERSION_2_0) && (curl_easy_setopt(request->curl, CURLOPT_PIPEWAIT, 1L) != CURLE_OK)) ||
+#endif
+            (curl_easy_setopt(request->curl, CURLOPT_HTTPHEADER, request->request_headers) != CURLE_OK) ||
+            (curl_easy_setopt(request->curl, CURLOPT_HEADERFUNCTION, on_header) != CURLE_OK) ||
+            (curl_easy_setopt(request->curl, CURLOPT_HEADERDATA, request) != CURLE_OK) ||
+            (curl_easy_setopt(request->curl, CURLOPT_WRITEFUNCTION, on_content) != CURLE_OK) ||
+            (curl_easy_setopt(request->curl, CURLOPT_WRITEDATA, request) != CURLE_OK) ||
+            (curl_easy_setopt(request->curl, CURLOPT_VERBOSE, httpapi_async->verbose) != CURLE_OK) ||
+            (curl_easy_setopt(request->curl, CURLOPT_LOW_SPEED_LIMIT, httpapi_async->low_speed_limit) != CURLE_OK) ||
+            (curl_easy_setopt(request->curl, CURLOPT_LOW_SPEED_TIME, httpapi_async->low_speed_time) != CURLE_OK) ||
+            (curl_easy_setopt(request->curl, CURLOPT_FRESH_CONNECT, httpapi_async->fresh_connect) != CURLE_OK) ||
+            (curl_easy_setopt(request->curl, CURLOPT_FORBID_REUSE, httpapi_async->forbid_reuse) != CURLE_OK) ||
+            ((httpapi_async->timeout_ms != 0) && (curl_easy_setopt(request->curl, CURLOPT_TIMEOUT_MS, (long)httpapi_async->timeout_ms) != CURLE_OK)) ||
+            ((httpapi_async->proxy != NULL) && (curl_easy_setopt(request->curl, CURLOPT_PROXY, httpapi_async->proxy) != CURLE_OK)) ||
+            ((httpapi_async->proxy_user_password != NULL) && (curl_easy_setopt(request->curl, CURLOPT_PROXYUSERPWD, httpapi_async->proxy_user_password) != CURLE_OK)))
+        {
+            LogError("Cannot set the request options");
+            result = __FAILURE__;
+        }
+        else if (((httpapi_async->trusted_certs != NULL) || (httpapi_async->x509_certificate != NULL) || (httpapi_async->x509_private_key != NULL)) &&
+            ((curl_easy_setopt(request->curl, CURLOPT_SSL_CTX_FUNCTION, on_ssl_ctx) != CURLE_OK) ||
+             (curl_easy_setopt(request->curl, CURLOPT_SSL_CTX_DATA, httpapi_async) != CURLE_OK)))
+        {
+            LogError("Cannot set the TLS options on the request");
+            result = __FAILURE__;
+        }
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_017: [ A GET request shall set `CURLOPT_HTTPGET`; any other request shall copy `content` into the easy handle with `CURLOPT_COPYPOSTFIELDS`, and a request other than POST shall also set `CURLOPT_CUSTOMREQUEST`. ]*/
+        else if (request_type == HTTPAPI_REQUEST_GET)
+        {
+            result = (curl_easy_setopt(request->curl, CURLOPT_HTTPGET, 1L) != CURLE_OK) ? __FAILURE__ : 0;
+        }
+        /* the body is copied into the easy handle, so content is not used after httpapi_async_execute_request returns */
+        else if ((curl_easy_setopt(request->curl, CURLOPT_POSTFIELDSIZE, (long)content_length) != CURLE_OK) ||
+            (curl_easy_setopt(request->curl, CURLOPT_COPYPOSTFIELDS, (content_length == 0) ? "" : (const char*)content) != CURLE_OK) ||
+            ((request_type != HTTPAPI_REQUEST_POST) && (curl_easy_setopt(request->curl, CURLOPT_CUSTOMREQUEST, get_request_type_string(request_type)) != CURLE_OK)))
+        {
+            LogError("Cannot set the request content");
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+
+        free(url);
+    }
+
+    return result;
+}
+
+static int reset_response(ASYNC_REQUEST* request)
+{
+    int result;
+
+    HTTPHeaders_Free(request->response_headers);
+    BUFFER_delete(request->response_content);
+    request->response_content = NULL;
+    request->is_response_failed = false;
+
+    if ((request->response_headers = HTTPHeaders_Alloc()) == NULL)
+    {
+        LogError("Cannot allocate the response headers");
+        result = __FAILURE__;
+    }
+    else if ((request->response_content = BUFFER_new()) == NULL)
+    {
+        LogError("Cannot allocate the response content");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+static void destroy_request(ASYNC_REQUEST* request)
+{
+    if (request->curl != NULL)
+    {
+        curl_easy_cleanup(request->curl);
+    }
+    curl_slist_free_all(request->request_headers);
+    HTTPHeaders_Free(request->response_headers);
+    BUFFER_delete(request->response_content);
+    free(request);
+}
+
+/* takes the request out of the multi handle and its list, calls its callback and frees it */
+static void complete_request(ASYNC_REQUEST* request, HTTPAPI_ASYNC_RESULT result, unsigned int status_code)
+{
+    HTTPAPI_ASYNC_INSTANCE* httpapi_async = request->httpapi_async;
+
+    if (request->is_active)
+    {
+        (void)curl_multi_remove_handle(httpapi_async->multi, request->curl);
+        (void)singlylinkedlist_remove(httpapi_async->active_requests, request->list_item);
+        httpapi_async->active_count--;
+    }
+    else if (request->list_item != NULL)
+    {
+        (void)singlylinkedlist_remove(httpapi_async->pending_requests, request->list_item);
+    }
+
+    if (result != HTTPAPI_ASYNC_OK)
+    {
+        LogError("HTTP request failed: %s", ENUM_TO_STRING(HTTPAPI_ASYNC_RESULT, result));
+    }
+
+    request->on_request_complete(request->callback_context, result, status_code,
+        (result == HTTPAPI_ASYNC_OK) ? request->response_headers : NULL,
+        (result == HTTPAPI_ASYNC_OK) ? request->response_content : NULL);
+    destroy_request(request);
+}
+
+static void dispatch_pending_requests(HTTPAPI_ASYNC_INSTANCE* httpapi_async)
+{
+    LIST_ITEM_HANDLE list_item;
+    size_t max_active = httpapi_async->is_multiplexed ? httpapi_async->max_connections * MAX_STREAMS_PER_CONNECTION : httpapi_async->max_connections;
+
+    /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_021: [ `httpapi_async_dowork` shall add the queued requests, in order, to the multi handle with `curl_multi_add_handle` while fewer than `max_connections` requests are in progress, or fewer than 100 times `max_connections` once a request completed over HTTP/2, which libcurl 7.50 or later reports. ]*/
+    while ((httpapi_async->active_count < max_active) &&
+        ((list_item = singlylinkedlist_get_head_item(httpapi_async->pending_requests)) != NULL))
+    {
+        ASYNC_REQUEST* request = (ASYNC_REQUEST*)singlylinkedlist_item_get_value(list_item);
+        LIST_ITEM_HANDLE active_item;
+
+        (void)singlylinkedlist_remove(httpapi_async->pending_requests, list_item);
+        request->list_item = NULL;
+
+        /* adding the handle only arms the multi timer, the transfer starts in the next curl_multi_socket_action */
+        if ((active_item = singlylinkedlist_add(httpapi_async->active_requests, request)) == NULL)
+        {
+            LogError("Cannot add the request to the active requests");
+            complete_request(request, HTTPAPI_ASYNC_ERROR, 0);
+        }
+        else
+        {
+            request->list_item = active_item;
+            request->is_active = true;
+            httpapi_async->active_count++;
+
+            if (curl_multi_add_handle(httpapi_async->multi, request->curl) != CURLM_OK)
+            {
+                /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_022: [ If `curl_multi_add_handle` fails, `on_request_complete` shall be called with `HTTPAPI_ASYNC_ERROR`. ]*/
+                LogError("unable to curl_multi_add_handle");
+                (void)singlylinkedlist_remove(httpapi_async->active_requests, active_item);
+                request->is_active = false;
+                request->list_item = NULL;
+                httpapi_async->active_count--;
+                complete_request(request, HTTPAPI_ASYNC_ERROR, 0);
+            }
+        }
+    }
+}
+
+static void process_completed_requests(HTTPAPI_ASYNC_INSTANCE* httpapi_async)
+{
+    CURLMsg* message;
+    int messages_left;
+
+    while ((message = curl_multi_info_read(httpapi_async->multi, &messages_left)) != NULL)
+    {
+        if (message->msg == CURLMSG_DONE)
+        {
+            ASYNC_REQUEST* request;
+            CURLcode curl_result = message->data.result;
+            CURL* curl = message->easy_handle;
+
+            if ((curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char**)&request) != CURLE_OK) || (request == NULL))
+            {
+                LogError("Cannot find the request of a completed transfer");
+                (void)curl_multi_remove_handle(httpapi_async->multi, curl);
+            }
+            else if ((curl_result == CURLE_OK) && !request->is_response_failed)
+            {
+                long status_code;
+                if (curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code) != CURLE_OK)
+                {
+                    LogError("Cannot get the response status code");
+                    complete_request(request, HTTPAPI_ASYNC_ERROR, 0);
+                }
+                else
+                {
+#if LIBCURL_VERSION_NUM >= 0x073200
+                    long http_version;
+                    if ((curl_easy_getinfo(curl, CURLINFO_HTTP_VERSION, &http_version) == CURLE_OK) && (http_version == CURL_HTTP_VERSION_2_0))
+                    {
+                        httpapi_async->is_multiplexed = true;
+                    }
+#endif
+                    /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_024: [ When a transfer completes with `CURLE_OK`, `httpapi_async_dowork` shall call `on_request_complete` with `HTTPAPI_ASYNC_OK`, the response status code, headers and content. ]*/
+                    complete_request(request, HTTPAPI_ASYNC_OK, (unsigned int)status_code);
+                }
+            }
+            else if (curl_result == CURLE_OPERATION_TIMEDOUT)
+            {
+                /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_025: [ When a transfer completes with `CURLE_OPERATION_TIMEDOUT`, `on_request_complete` shall be called with `HTTPAPI_ASYNC_TIMEOUT`. ]*/
+                complete_request(request, HTTPAPI_ASYNC_TIMEOUT, 0);
+            }
+            /* a connection taken from the cache may have been dropped by the server while idle, so a failed request is sent once more */
+            else if ((curl_result != CURLE_WRITE_ERROR) && !request->is_response_failed && !request->is_retried)
+            {
+                LogInfo("Request to %s failed (%s), retrying", httpapi_async->host_url, curl_easy_strerror(curl_result));
+                /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_026: [ When a transfer fails with any other error, the request shall be added to the multi handle again once. ]*/
+                request->is_retried = true;
+                (void)curl_multi_remove_handle(httpapi_async->multi, curl);
+                if ((reset_response(request) != 0) ||
+                    (curl_multi_add_handle(httpapi_async->multi, curl) != CURLM_OK))
+                {
+                    LogError("Cannot queue the request again");
+                    complete_request(request, HTTPAPI_ASYNC_ERROR, 0);
+                }
+            }
+            else
+            {
+                /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_027: [ If a request that was already sent again fails, or its response could not be stored, `on_request_complete` shall be called with `HTTPAPI_ASYNC_ERROR`. ]*/
+                LogError("Request to %s failed: %s", httpapi_async->host_url, curl_easy_strerror(curl_result));
+                complete_request(request, HTTPAPI_ASYNC_ERROR, 0);
+            }
+        }
+    }
+}
+
+HTTPAPI_ASYNC_HANDLE httpapi_async_create(const char* host_name, size_t max_connections)
+{
+    HTTPAPI_ASYNC_INSTANCE* result;
+
+    if ((host_name == NULL) || (max_connections == 0))
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_001: [ If `host_name` is NULL or `max_connections` is 0, `httpapi_async_create` shall fail and return NULL. ]*/
+        LogError("Invalid arguments: host_name = %p, max_connections = %lu", host_name, (unsigned long)max_connections);
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_002: [ `httpapi_async_create` shall allocate a new instance, build the `https://host_name` URL, call `HTTPAPI_Init`, create the pending and active request lists and create a multi handle with `curl_multi_init`. ]*/
+        result = (HTTPAPI_ASYNC_INSTANCE*)malloc(sizeof(HTTPAPI_ASYNC_INSTANCE));
+        if (result == NULL)
+        {
+            /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_004: [ If any error occurs, `httpapi_async_create` shall release what it created, fail and return NULL. ]*/
+            LogError("Cannot allocate memory for the httpapi_async instance");
+        }
+        else
+        {
+            (void)memset(result, 0, sizeof(HTTPAPI_ASYNC_INSTANCE));
+
+            if ((result->host_url = (char*)malloc(strlen("https://") + strlen(host_name) + 1)) == NULL)
+            {
+                LogError("Cannot allocate memory for the host URL");
+                free(result);
+                result = NULL;
+            }
+            else if (HTTPAPI_Init() != HTTPAPI_OK)
+            {
+                LogError("unable to HTTPAPI_Init");
+                free(result->host_url);
+                free(result);
+                result = NULL;
+            }
+            else if ((result->pending_requests = singlylinkedlist_create()) == NULL)
+            {
+                LogError("Cannot create the request queue");
+                HTTPAPI_Deinit();
+                free(result->host_url);
+                free(result);
+                result = NULL;
+            }
+            else if ((result->active_requests = singlylinkedlist_create()) == NULL)
+            {
+                LogError("Cannot create the active request list");
+                singlylinkedlist_destroy(result->pending_requests);
+                HTTPAPI_Deinit();
+                free(result->host_url);
+                free(result);
+                result = NULL;
+            }
+            else if ((result->multi = curl_multi_init()) == NULL)
+            {
+                LogError("unable to curl_multi_init");
+                singlylinkedlist_destroy(result->active_requests);
+                singlylinkedlist_destroy(result->pending_requests);
+                HTTPAPI_Deinit();
+                free(result->host_url);
+                free(result);
+                result = NULL;
+            }
+            /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_003: [ `httpapi_async_create` shall set `CURLMOPT_MAX_HOST_CONNECTIONS` to `max_connections`, with libcurl 7.43 or later `CURLMOPT_PIPELINING` to `CURLPIPE_MULTIPLEX`, and the socket and timer callbacks on the multi handle. ]*/
+            else if ((curl_multi_setopt(result->multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)max_connections) != CURLM_OK) ||
+#if LIBCURL_VERSION_NUM >= 0x072B00
+                (curl_multi_setopt(result->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX) != CURLM_OK) ||
+#endif
+                (curl_multi_setopt(result->multi, CURLMOPT_SOCKETFUNCTION, on_socket) != CURLM_OK) ||
+                (curl_multi_setopt(result->multi, CURLMOPT_SOCKETDATA, result) != CURLM_OK) ||
+                (curl_multi_setopt(result->multi, CURLMOPT_TIMERFUNCTION, on_timer) != CURLM_OK) ||
+                (curl_multi_setopt(result->multi, CURLMOPT_TIMERDATA, result) != CURLM_OK))
+            {
+                LogError("unable to curl_multi_setopt");
+                (void)curl_multi_cleanup(result->multi);
+                singlylinkedlist_destroy(result->active_requests);
+                singlylinkedlist_destroy(result->pending_requests);
+                HTTPAPI_Deinit();
+                free(result->host_url);
+                free(result);
+                result = NULL;
+            }
+            else
+            {
+                result->max_connections = max_connections;
+                result->http_version = CURL_HTTP_VERSION_1_1;
+                (void)strcpy(result->host_url, "https://");
+                (void)strcat(result->host_url, host_name);
+            }
+        }
+    }
+
+    return result;
+}
+
+void httpapi_async_destroy(HTTPAPI_ASYNC_HANDLE httpapi_async)
+{
+    /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_005: [ If `httpapi_async` is NULL, `httpapi_async_destroy` shall do nothing. ]*/
+    if (httpapi_async != NULL)
+    {
+        LIST_ITEM_HANDLE list_item;
+
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_006: [ `httpapi_async_destroy` shall call `on_request_complete` with `HTTPAPI_ASYNC_CANCELLED` for the requests handed to curl and then for the queued ones, clean up the multi handle, call `HTTPAPI_Deinit` and free all the resources. ]*/
+        while ((list_item = singlylinkedlist_get_head_item(httpapi_async->active_requests)) != NULL)
+        {
+            complete_request((ASYNC_REQUEST*)singlylinkedlist_item_get_value(list_item), HTTPAPI_ASYNC_CANCELLED, 0);
+        }
+
+        while ((list_item = singlylinkedlist_get_head_item(httpapi_async->pending_requests)) != NULL)
+        {
+            complete_request((ASYNC_REQUEST*)singlylinkedlist_item_get_value(list_item), HTTPAPI_ASYNC_CANCELLED, 0);
+        }
+
+        (void)curl_multi_cleanup(httpapi_async->multi);
+        singlylinkedlist_destroy(httpapi_async->active_requests);
+        singlylinkedlist_destroy(httpapi_async->pending_requests);
+        HTTPAPI_Deinit();
+        free(httpapi_async->sockets);
+        free(httpapi_async->ready_sockets);
+        free(httpapi_async->trusted_certs);
+        free(httpapi_async->x509_certificate);
+        free(httpapi_async->x509_private_key);
+        free(httpapi_async->proxy);
+        free(httpapi_async->proxy_user_password);
+        free(httpapi_async->host_url);
+        free(httpapi_async);
+    }
+}
+
+static int replace_string_option(char** destination, const void* value)
+{
+    int result;
+    char* copy;
+
+    if (mallocAndStrcpy_s(&copy, (const char*)value) != 0)
+    {
+        LogError("Cannot copy the option value");
+        result = __FAILURE__;
+    }
+    else
+    {
+        free(*destination);
+        *destination = copy;
+        result = 0;
+    }
+
+    return result;
+}
+
+static int check_http_version(long http_version)
+{
+    int result;
+
+    switch (http_version)
+    {
+    case CURL_HTTP_VERSION_NONE:
+    case CURL_HTTP_VERSION_1_0:
+    case CURL_HTTP_VERSION_1_1:
+        result = 0;
+        break;
+
+#if LIBCURL_VERSION_NUM >= 0x073100
+    case CURL_HTTP_VERSION_2_0:
+    case CURL_HTTP_VERSION_2TLS:
+    case CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE:
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_029: [ If `CURLOPT_HTTP_VERSION` asks for HTTP/2 and `curl_version_info` does not report `CURL_VERSION_HTTP2`, setting it shall fail and return a non-zero value. ]*/
+        if ((curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2) == 0)
+        {
+            LogError("libcurl was built without HTTP/2");
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+        break;
+#endif
+
+    default:
+        LogError("Unsupported HTTP version %ld", http_version);
+        result = __FAILURE__;
+        break;
+    }
+
+    return result;
+}
+
+static int set_proxy_option(HTTPAPI_ASYNC_INSTANCE* httpapi_async, const HTTP_PROXY_OPTIONS* proxy_options)
+{
+    int result;
+    char* proxy = NULL;
+    char* proxy_user_password = NULL;
+
+    if ((proxy_options->host_address == NULL) ||
+        ((proxy_options->username == NULL) != (proxy_options->password == NULL)))
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_011: [ If `host_address` is NULL, or only one of `username` and `password` is NULL, setting `proxy_data` shall fail and return a non-zero value. ]*/
+        LogError("Invalid proxy options: host_address = %p, username = %p, password = %p", proxy_options->host_address, proxy_options->username, proxy_options->password);
+        result = __FAILURE__;
+    }
+    /* the strings are formatted right away, the caller does not keep the options alive */
+    else if ((proxy = (char*)malloc(strlen(proxy_options->host_address) + 12)) == NULL)
+    {
+        LogError("Cannot allocate memory for the proxy");
+        result = __FAILURE__;
+    }
+    else if ((proxy_options->username != NULL) &&
+        ((proxy_user_password = (char*)malloc(strlen(proxy_options->username) + strlen(proxy_options->password) + 2)) == NULL))
+    {
+        LogError("Cannot allocate memory for the proxy credentials");
+        free(proxy);
+        result = __FAILURE__;
+    }
+    else
+    {
+        (void)sprintf(proxy, "%s:%d", proxy_options->host_address, proxy_options->port);
+        if (proxy_user_password != NULL)
+        {
+            (void)sprintf(proxy_user_password, "%s:%s", proxy_options->username, proxy_options->password);
+        }
+
+        free(httpapi_async->proxy);
+        free(httpapi_async->proxy_user_password);
+        httpapi_async->proxy = proxy;
+        httpapi_async->proxy_user_password = proxy_user_password;
+        result = 0;
+    }
+
+    return result;
+}
+
+int httpapi_async_set_option(HTTPAPI_ASYNC_HANDLE httpapi_async, const char* option_name, const void* value)
+{
+    int result;
+
+    if ((httpapi_async == NULL) || (option_name == NULL) || (value == NULL))
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_007: [ If `httpapi_async`, `option_name` or `value` is NULL, `httpapi_async_set_option` shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: httpapi_async = %p, option_name = %p, value = %p", httpapi_async, option_name, value);
+        result = __FAILURE__;
+    }
+    else if (strcmp(option_name, OPTION_TRUSTED_CERT) == 0)
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_008: [ `httpapi_async_set_option` shall save a copy of the `TrustedCerts`, `x509certificate`, `x509privatekey`, `x509EccCertificate` and `x509EccAliasKey` options, and the requests created afterwards shall add them to the TLS context through `CURLOPT_SSL_CTX_FUNCTION`. ]*/
+        result = replace_string_option(&httpapi_async->trusted_certs, value);
+    }
+    else if ((strcmp(option_name, SU_OPTION_X509_CERT) == 0) || (strcmp(option_name, OPTION_X509_ECC_CERT) == 0))
+    {
+        result = replace_string_option(&httpapi_async->x509_certificate, value);
+    }
+    else if ((strcmp(option_name, SU_OPTION_X509_PRIVATE_KEY) == 0) || (strcmp(option_name, OPTION_X509_ECC_KEY) == 0))
+    {
+        result = replace_string_option(&httpapi_async->x509_private_key, value);
+    }
+    else if (strcmp(option_name, OPTION_HTTP_TIMEOUT) == 0)
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_009: [ The `timeout` option shall be read as an `unsigned int` number of milliseconds and set as `CURLOPT_TIMEOUT_MS` on the requests created afterwards, 0 meaning no timeout. ]*/
+        httpapi_async->timeout_ms = *(const unsigned int*)value;
+        result = 0;
+    }
+    else if (strcmp(option_name, OPTION_HTTP_PROXY) == 0)
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_010: [ The `proxy_data` option shall be read as an `HTTP_PROXY_OPTIONS` and set as `CURLOPT_PROXY` (`host_address:port`) and `CURLOPT_PROXYUSERPWD` (`username:password`) on the requests created afterwards. ]*/
+        result = set_proxy_option(httpapi_async, (const HTTP_PROXY_OPTIONS*)value);
+    }
+    else if (strcmp(option_name, OPTION_CURL_LOW_SPEED_LIMIT) == 0)
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_012: [ The `CURLOPT_LOW_SPEED_LIMIT`, `CURLOPT_LOW_SPEED_TIME`, `CURLOPT_FRESH_CONNECT`, `CURLOPT_FORBID_REUSE` and `CURLOPT_VERBOSE` options shall be read as a `long` and set on the requests created afterwards. ]*/
+        httpapi_async->low_speed_limit = *(const long*)value;
+        result = 0;
+    }
+    else if (strcmp(option_name, OPTION_CURL_LOW_SPEED_TIME) == 0)
+    {
+        httpapi_async->low_speed_time = *(const long*)value;
+        result = 0;
+    }
+    else if (strcmp(option_name, OPTION_CURL_FRESH_CONNECT) == 0)
+    {
+        httpapi_async->fresh_connect = *(const long*)value;
+        result = 0;
+    }
+    else if (strcmp(option_name, OPTION_CURL_FORBID_REUSE) == 0)
+    {
+        httpapi_async->forbid_reuse = *(const long*)value;
+        result = 0;
+    }
+    else if (strcmp(option_name, OPTION_CURL_VERBOSE) == 0)
+    {
+        httpapi_async->verbose = *(const long*)value;
+        result = 0;
+    }
+    else if (strcmp(option_name, OPTION_CURL_HTTP_VERSION) == 0)
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_028: [ The `CURLOPT_HTTP_VERSION` option shall be read as a `long` and set on the requests created afterwards when it is `CURL_HTTP_VERSION_NONE`, `CURL_HTTP_VERSION_1_0`, `CURL_HTTP_VERSION_1_1` or, with libcurl 7.49 or later, `CURL_HTTP_VERSION_2_0`, `CURL_HTTP_VERSION_2TLS` or `CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE`; for any other value setting it shall fail and return a non-zero value. ]*/
+        long http_version = *(const long*)value;
+        if (check_http_version(http_version) != 0)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            httpapi_async->http_version = http_version;
+            result = 0;
+        }
+    }
+    else if (strcmp(option_name, OPTION_CURL_SHARE) == 0)
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_013: [ The `CURLOPT_SHARE` option shall be accepted and ignored, since the requests of an instance already share the caches of the multi handle. ]*/
+        result = 0;
+    }
+    else
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_014: [ For any other option `httpapi_async_set_option` shall fail and return a non-zero value. ]*/
+        LogError("Option not supported: %s", option_name);
+        result = __FAILURE__;
+    }
+
+    return result;
+}
+
+int httpapi_async_execute_request(HTTPAPI_ASYNC_HANDLE httpapi_async, HTTPAPI_REQUEST_TYPE request_type, const char* relative_path, HTTP_HEADERS_HANDLE request_headers, const unsigned char* content, size_t content_length, ON_HTTPAPI_ASYNC_REQUEST_COMPLETE on_request_complete, void* callback_context)
+{
+    int result;
+    size_t header_count;
+
+    if ((httpapi_async == NULL) || (get_request_type_string(request_type) == NULL) || (relative_path == NULL) || (request_headers == NULL) ||
+        ((content == NULL) && (content_length > 0)) || (on_request_complete == NULL))
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_015: [ If `httpapi_async`, `relative_path`, `request_headers` or `on_request_complete` is NULL, `request_type` is not valid, or `content` is NULL while `content_length` is not 0, `httpapi_async_execute_request` shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: httpapi_async = %p, request_type = %d, relative_path = %p, request_headers = %p, content = %p, content_length = %lu, on_request_complete = %p",
+            httpapi_async, (int)request_type, relative_path, request_headers, content, (unsigned long)content_length, on_request_complete);
+        result = __FAILURE__;
+    }
+    else if (HTTPHeaders_GetHeaderCount(request_headers, &header_count) != HTTP_HEADERS_OK)
+    {
+        LogError("Cannot get the request header count");
+        result = __FAILURE__;
+    }
+    else
+    {
+        ASYNC_REQUEST* request = (ASYNC_REQUEST*)malloc(sizeof(ASYNC_REQUEST));
+        if (request == NULL)
+        {
+            LogError("Cannot allocate memory for the request");
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t i;
+
+            (void)memset(request, 0, sizeof(ASYNC_REQUEST));
+            request->httpapi_async = httpapi_async;
+            request->on_request_complete = on_request_complete;
+            request->callback_context = callback_context;
+            result = 0;
+
+            /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_016: [ `httpapi_async_execute_request` shall create an easy handle with `curl_easy_init` for the URL of `relative_path` on the host, with a copy of the headers made with `curl_slist_append`, so `request_headers` is not used after it returns. ]*/
+            for (i = 0; (result == 0) && (i < header_count); i++)
+            {
+                char* header;
+                if (HTTPHeaders_GetHeader(request_headers, i, &header) != HTTP_HEADERS_OK)
+                {
+                    LogError("Cannot get request header %lu", (unsigned long)i);
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    struct curl_slist* new_headers = curl_slist_append(request->request_headers, header);
+                    if (new_headers == NULL)
+                    {
+                        LogError("unable to curl_slist_append");
+                        result = __FAILURE__;
+                    }
+                    else
+                    {
+                        request->request_headers = new_headers;
+                    }
+                    free(header);
+                }
+            }
+
+            if (result != 0)
+            {
+                destroy_request(request);
+            }
+            else if ((request->curl = curl_easy_init()) == NULL)
+            {
+                LogError("unable to curl_easy_init");
+                destroy_request(request);
+                result = __FAILURE__;
+            }
+            else if ((reset_response(request) != 0) ||
+                (set_request_options(httpapi_async, request, request_type, relative_path, content, content_length) != 0))
+            {
+                destroy_request(request);
+                result = __FAILURE__;
+            }
+            /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_018: [ `httpapi_async_execute_request` shall queue the request and return 0 without adding it to the multi handle. ]*/
+            /* the request is handed to curl in httpapi_async_dowork, so no IO happens here */
+            else if ((request->list_item = singlylinkedlist_add(httpapi_async->pending_requests, request)) == NULL)
+            {
+                /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_019: [ If any error occurs, `httpapi_async_execute_request` shall fail and return a non-zero value. ]*/
+                LogError("Cannot queue the request");
+                destroy_request(request);
+                result = __FAILURE__;
+            }
+        }
+    }
+
+    return result;
+}
+
+void httpapi_async_dowork(HTTPAPI_ASYNC_HANDLE httpapi_async)
+{
+    /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_020: [ If `httpapi_async` is NULL, `httpapi_async_dowork` shall do nothing. ]*/
+    if (httpapi_async != NULL)
+    {
+        int running_handles;
+
+        dispatch_pending_requests(httpapi_async);
+
+        /* Codes_SRS_HTTPAPI_ASYNC_CURL_01_023: [ `httpapi_async_dowork` shall `poll` the sockets curl asked to watch without blocking and call `curl_multi_socket_action` for each ready socket, and with `CURL_SOCKET_TIMEOUT` while the curl timer is armed. ]*/
+        if ((httpapi_async->socket_count > 0) &&
+            (poll(httpapi_async->sockets, (nfds_t)httpapi_async->socket_count, 0) > 0))
+        {
+            /* curl_multi_socket_action can add and remove sockets, so the ready ones are copied out first */
+            size_t ready_count = 0;
+            size_t i;
+
+            for (i = 0; i < httpapi_async->socket_count; i++)
+            {
+                if (httpapi_async->sockets[i].revents != 0)
+                {
+                    httpapi_async->ready_sockets[ready_count++] = httpapi_async->sockets[i];
+                }
+            }
+
+            for (i = 0; i < ready_count; i++)
+            {
+                short revents = httpapi_async->ready_sockets[i].revents;
+                int events = ((revents & (POLLIN | POLLHUP)) ? CURL_CSELECT_IN : 0) |
+                    ((revents & POLLOUT) ? CURL_CSELECT_OUT : 0) |
+                    ((revents & (POLLERR | POLLNVAL)) ? CURL_CSELECT_ERR : 0);
+                (void)curl_multi_socket_action(httpapi_async->multi, httpapi_async->ready_sockets[i].fd, events, &running_handles);
+            }
+        }
+
+        if (httpapi_async->is_timer_armed)
+        {
+            (void)curl_multi_socket_action(httpapi_async->multi, CURL_SOCKET_TIMEOUT, 0, &running_handles);
+        }
+
+        process_completed_requests(httpapi_async);
+
+        /* transfer slots freed by this pass can take queued requests right away */
+        dispatch_pending_requests(httpapi_async);
+    }
+}
@@ -3,9 +3,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
-#include <ctype.h>
 #include <string.h>
-#include <limits.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/httpheaders.h"
 #include "azure_c_shared_utility/http_proxy_io.h"
@@ -16,6 +14,8 @@
 #include "azure_c_shared_utility/tlsio.h"
 #include "azure_c_shared_utility/socketio.h"
 #include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/http_response_parser.h"
 #include "azure_c_shared_utility/shared_util_options.h"
 
 #ifdef _MSC_VER
@@ -29,6 +29,8 @@
 
 #define MAX_HOSTNAME     64
 #define TEMP_BUFFER_SIZE 1024
+/* Contents up to this size are sent in the same write as the request head. */
+#define MAX_INLINE_CONTENT_SIZE 4096
 
 /*Codes_SRS_HTTPAPI_COMPACT_21_077: [ The HTTPAPI_ExecuteRequest shall wait, at least, 10 seconds for the SSL open process. ]*/
 #define MAX_OPEN_RETRY   1000
@@ -38,17 +40,40 @@
 #define MAX_SEND_RETRY   200
 /*Codes_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
 #define MAX_RECEIVE_RETRY   2000
-/*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries for the SSL open process. ]*/
+/*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall block on the transport until it can make progress, and only poll it between retries when the transport cannot wait on its own. ]*/
 #define OPEN_RETRY_INTERVAL_IN_MILLISECONDS  10
-/*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_CloseConnection shall wait, at least, 100 milliseconds between retries for the SSL close process. ]*/
+/*Codes_SRS_HTTPAPI_COMPACT_21_086: [ The HTTPAPI_CloseConnection shall block on the transport until the close can make progress, and only poll it between retries when the transport cannot wait on its own. ]*/
 #define CLOSE_RETRY_INTERVAL_IN_MILLISECONDS  100
-/*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries to send a buffer using the SSL connection. ]*/
+/*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall block on the transport until it can make progress, and only poll it between retries when the transport cannot wait on its own. ]*/
 #define SEND_RETRY_INTERVAL_IN_MILLISECONDS  100
-/*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 10 milliseconds between retries to read the message with the response. ]*/
+/*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall block on the transport until it can make progress, and only poll it between retries when the transport cannot wait on its own. ]*/
 #define RECEIVE_RETRY_INTERVAL_IN_MILLISECONDS  10
 
+/* The retries above are a time budget; when the transport can wait on its socket the budget is spent blocked
+   on readiness instead of sleeping, and the intervals are only used by transports that can not. */
+#define OPEN_TIMEOUT_IN_MILLISECONDS    (MAX_OPEN_RETRY * OPEN_RETRY_INTERVAL_IN_MILLISECONDS)
+#define CLOSE_TIMEOUT_IN_MILLISECONDS   (MAX_CLOSE_RETRY * CLOSE_RETRY_INTERVAL_IN_MILLISECONDS)
+#define SEND_TIMEOUT_IN_MILLISECONDS    (MAX_SEND_RETRY * SEND_RETRY_INTERVAL_IN_MILLISECONDS)
+#define RECEIVE_TIMEOUT_IN_MILLISECONDS (MAX_RECEIVE_RETRY * RECEIVE_RETRY_INTERVAL_IN_MILLISECONDS)
+
 DEFINE_ENUM_STRINGS(HTTPAPI_RESULT, HTTPAPI_RESULT_VALUES)
 
+/* Where the parts of the response being received are delivered, for the duration of one request. */
+typedef struct HTTP_RESPONSE_TARGET_TAG
+{
+    unsigned int*       statusCode;
+    char*               reasonPhrase;
+    size_t              maxReasonPhraseSize;
+    HTTP_HEADERS_HANDLE responseHeadersHandle;
+    BUFFER_HANDLE       responseContent;
+    ON_CHUNK_RECEIVED   onChunkReceived;
+    void*               onChunkReceivedContext;
+    size_t              contentSize;
+    size_t              chunkStart;
+    bool                chunked;
+    HTTPAPI_RESULT      result;
+} HTTP_RESPONSE_TARGET;
+
 typedef struct HTTP_HANDLE_DATA_TAG
 {
     char*           certificate;
@@ -57,144 +82,223 @@ typedef struct HTTP_HANDLE_DATA_TAG
     char*           tlsIoVersion;
 
     XIO_HANDLE      xio_handle;
+    TICK_COUNTER_HANDLE tick_counter;
+    HTTP_RESPONSE_PARSER_HANDLE response_parser;
+    HTTP_RESPONSE_PARSER_RESULT response_parser_result;
+    HTTP_RESPONSE_TARGET* response_target;
     size_t          received_bytes_count;
     unsigned char*  received_bytes;
+    size_t          request_buffer_size;
+    unsigned char*  request_buffer;
     unsigned int    is_io_error : 1;
     unsigned int    is_connected : 1;
     unsigned int    send_completed : 1;
+    unsigned int    io_wait_unsupported : 1;
+    unsigned int    is_data_received : 1;
 } HTTP_HANDLE_DATA;
 
-static HTTPAPI_RESULT OpenXIOConnection(HTTP_HANDLE_DATA* http_instance);
+typedef struct IO_DEADLINE_TAG
+{
+    tickcounter_ms_t start_ms;
+    tickcounter_ms_t timeout_ms;
+    unsigned int retry_interval_ms;
+} IO_DEADLINE;
 
-/*Read a decimal from a char[], returns a decimal and the remaining part which cannot be converted to a number.*/
-/*the following function does the same as sscanf_s(pos2, "%d %s", &sec, remaining)*/
-/*this function only exists because some of platforms do not have sscanf. */
-static int ParseStringToDecimalAndRemaining(const char *src, int* dst, char* remaining, const size_t maxRemainingSize)
+static int start_deadline(HTTP_HANDLE_DATA* http_instance, IO_DEADLINE* deadline, tickcounter_ms_t timeout_ms, unsigned int retry_interval_ms)
 {
     int result;
-    char* next;
-    long num = strtol(src, &next, 0);
-    if (src == next || num < INT_MIN || num > INT_MAX)
+
+    deadline->timeout_ms = timeout_ms;
+    deadline->retry_interval_ms = retry_interval_ms;
+    if (tickcounter_get_current_ms(http_instance->tick_counter, &deadline->start_ms) != 0)
     {
-        result = EOF;
+        LogError("Failed getting the current time");
+        result = __FAILURE__;
     }
     else
     {
-        result = 1;
+        result = 0;
     }
-    if (num < INT_MIN) num = INT_MIN;
-    if (num > INT_MAX) num = INT_MAX;
-    *dst = (int)num;
-    if (remaining && maxRemainingSize > 0)
-    {
-        size_t cLen = strlen(next);
-        if (cLen > maxRemainingSize - 1)
-        {
-            cLen = maxRemainingSize - 1;
-        }
-        (void)strcpy_s(remaining, cLen + 1, next);
-        remaining[maxRemainingSize - 1] = 0;
-    }    
+
     return result;
 }
 
-/*the following function does the same as sscanf(pos2, "%x", &sec)*/
-/*this function only exists because some of platforms do not have sscanf. This is not a full implementation; it only works with well-defined x numbers. */
-#define HEXA_DIGIT_VAL(c)         (((c>='0') && (c<='9')) ? (c-'0') : ((c>='a') && (c<='f')) ? (c-'a'+10) : ((c>='A') && (c<='F')) ? (c-'A'+10) : -1)
-static int ParseStringToHexadecimal(const char *src, size_t* dst)
+/* Blocks until the transport can make progress and returns 0, or returns non-zero once the deadline is spent. */
+static int wait_for_io(HTTP_HANDLE_DATA* http_instance, const IO_DEADLINE* deadline)
 {
     int result;
-    int digitVal;
-    if (src == NULL)
+    tickcounter_ms_t now_ms;
+
+    if (tickcounter_get_current_ms(http_instance->tick_counter, &now_ms) != 0)
     {
-        result = EOF;
+        LogError("Failed getting the current time");
+        result = __FAILURE__;
     }
-    else if (HEXA_DIGIT_VAL(*src) == -1)
+    else if ((now_ms - deadline->start_ms) >= deadline->timeout_ms)
     {
-        result = EOF;
+        result = __FAILURE__;
     }
     else
     {
-        (*dst) = 0;
-        while ((digitVal = HEXA_DIGIT_VAL(*src)) != -1)
+        unsigned int wait_ms = (unsigned int)(deadline->timeout_ms - (now_ms - deadline->start_ms));
+
+        if ((http_instance->io_wait_unsupported != 0) ||
+            (xio_setoption(http_instance->xio_handle, OPTION_IO_WAIT_MS, &wait_ms) != 0))
         {
-            (*dst) *= 0x10;
-            (*dst) += (size_t)digitVal;
-            src++;
+            /* The transport cannot block on its socket, so poll it at the retry interval. */
+            http_instance->io_wait_unsupported = 1;
+            ThreadAPI_Sleep(deadline->retry_interval_ms);
         }
-        result = 1;
+
+        result = 0;
     }
+
     return result;
 }
 
-/*the following function does the same as sscanf_s(buf, "HTTP/%*d.%*d %d %s[^\r\n]", &code, reasonPhrase) */
-/*this function only exists because some of platforms do not have sscanf. This is not a full implementation; it only works with well-defined HTTP response. */
-static int  ParseHttpResponse(const char* src, int* code, char* reasonPhrase, const size_t maxReasonPhraseSize)
+static int on_response_status(void* context, int status_code, const char* reason_phrase, size_t reason_phrase_length)
+{
+    HTTP_RESPONSE_TARGET* target = ((HTTP_HANDLE_DATA*)context)->response_target;
+
+    /*Codes_SRS_HTTPAPI_COMPACT_21_046: [ The HTTPAPI_ExecuteRequest shall return the http status reported by the host in the received response. ]*/
+    /*Codes_SRS_HTTPAPI_COMPACT_21_048: [ If the statusCode is NULL, the HTTPAPI_ExecuteRequest shall report not report any status. ]*/
+    if (target->statusCode != NULL)
+    {
+        /*Codes_SRS_HTTPAPI_COMPACT_21_047: [ The HTTPAPI_ExecuteRequest shall report the status in the statusCode parameter. ]*/
+        *target->statusCode = (unsigned int)status_code;
+    }
+
+    if ((target->reasonPhrase != NULL) && (target->maxReasonPhraseSize > 0))
+    {
+        size_t copyLength = (reason_phrase_length < target->maxReasonPhraseSize) ? reason_phrase_length : (target->maxReasonPhraseSize - 1);
+        (void)memcpy(target->reasonPhrase, reason_phrase, copyLength);
+        target->reasonPhrase[copyLength] = '\0';
+    }
+
+    return 0;
+}
+
+static int on_response_header(void* context, const char* name, size_t name_length, const char* value, size_t value_length)
 {
     int result;
-    static const char HTTPPrefix[] = "HTTP/";
-    bool fail;
-    const char* runPrefix;
+    HTTP_RESPONSE_TARGET* target = ((HTTP_HANDLE_DATA*)context)->response_target;
 
-    if ((src == NULL) || (code == NULL))
+    /*Codes_SRS_HTTPAPI_COMPACT_21_049: [ If responseHeadersHandle is provide, the HTTPAPI_ExecuteRequest shall prepare a Response Header usign the HTTPHeaders_AddHeaderNameValuePair. ]*/
+    if (target->responseHeadersHandle == NULL)
     {
-        result = EOF;
+        result = 0;
     }
     else
     {
-        fail = false;
-        runPrefix = HTTPPrefix;
+        /* HTTPHeaders wants NUL terminated strings, the parser hands out views */
+        char    buf[TEMP_BUFFER_SIZE];
+        char*   nameValue = ((name_length + value_length + 2) <= sizeof(buf)) ? buf : (char*)malloc(name_length + value_length + 2);
 
-        while((*runPrefix) != '\0')
+        if (nameValue == NULL)
         {
-            if ((*runPrefix) != (*src))
-            {
-                fail = true;
-                break;
-            }
-            src++;
-            runPrefix++;
+            /*Codes_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
+            LogError("Cannot allocate memory for the response header");
+            target->result = HTTPAPI_ALLOC_FAILED;
+            result = __FAILURE__;
         }
-
-        if (!fail)
+        else
         {
-            while ((*src) != '.')
-            {
-                if ((*src) == '\0')
-                {
-                    fail = true;
-                    break;
-                }
-                src++;
-            }
-        }
+            (void)memcpy(nameValue, name, name_length);
+            nameValue[name_length] = '\0';
+            (void)memcpy(nameValue + name_length + 1, value, value_length);
+            nameValue[name_length + 1 + value_length] = '\0';
 
-        if (!fail)
-        {
-            while ((*src) != ' ')
+            (void)HTTPHeaders_AddHeaderNameValuePair(target->responseHeadersHandle, nameValue, nameValue + name_length + 1);
+
+            if (nameValue != buf)
             {
-                if ((*src) == '\0')
-                {
-                    fail = true;
-                    break;
-                }
-                src++;
+                free(nameValue);
             }
+            result = 0;
         }
+    }
 
-        if (fail)
-        {
-            result = EOF;
-        }
-        else
-        {
-            result = ParseStringToDecimalAndRemaining(src, code, reasonPhrase, maxReasonPhraseSize);
-        }
+    return result;
+}
+
+static int on_response_headers_complete(void* context, size_t content_length, bool chunked, bool* has_body)
+{
+    int result;
+    HTTP_RESPONSE_TARGET* target = ((HTTP_HANDLE_DATA*)context)->response_target;
+    (void)has_body;
+
+    target->chunked = chunked;
+
+    /* The size of a Content-Length body is known up front, so the content buffer is sized once. */
+    if ((target->responseContent != NULL) && !chunked && (content_length > 0) &&
+        (BUFFER_pre_build(target->responseContent, content_length) != 0))
+    {
+        /*Codes_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
+        LogError("Cannot allocate memory for the response content");
+        target->result = HTTPAPI_ALLOC_FAILED;
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+static int on_response_body(void* context, const unsigned char* buffer, size_t size)
+{
+    int result;
+    HTTP_RESPONSE_TARGET* target = ((HTTP_HANDLE_DATA*)context)->response_target;
+
+    /*Codes_SRS_HTTPAPI_COMPACT_21_051: [ If the responseContent is NULL, the HTTPAPI_ExecuteRequest shall ignore any content in the response. ]*/
+    if (target->responseContent == NULL)
+    {
+        result = 0;
+    }
+    else if (target->chunked && (BUFFER_enlarge(target->responseContent, size) != 0))
+    {
+        /*Codes_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
+        LogError("Cannot allocate memory for the response content");
+        (void)BUFFER_unbuild(target->responseContent);
+        target->result = HTTPAPI_ALLOC_FAILED;
+        result = __FAILURE__;
+    }
+    else
+    {
+        /*Codes_SRS_HTTPAPI_COMPACT_21_050: [ If there is a content in the response, the HTTPAPI_ExecuteRequest shall copy it in the responseContent buffer. ]*/
+        (void)memcpy(BUFFER_u_char(target->responseContent) + target->contentSize, buffer, size);
+        target->contentSize += size;
+        result = 0;
     }
 
     return result;
 }
 
+static int on_response_chunk_complete(void* context)
+{
+    HTTP_RESPONSE_TARGET* target = ((HTTP_HANDLE_DATA*)context)->response_target;
+
+    if ((target->responseContent != NULL) && (target->onChunkReceived != NULL))
+    {
+        target->onChunkReceived(target->onChunkReceivedContext, BUFFER_u_char(target->responseContent) + target->chunkStart, target->contentSize - target->chunkStart);
+    }
+    target->chunkStart = target->contentSize;
+
+    return 0;
+}
+
+static const HTTP_RESPONSE_PARSER_CALLBACKS response_parser_callbacks =
+{
+    on_response_status,
+    on_response_header,
+    on_response_headers_complete,
+    on_response_body,
+    on_response_chunk_complete
+};
+
+static HTTPAPI_RESULT OpenXIOConnection(HTTP_HANDLE_DATA* http_instance);
+
 HTTPAPI_RESULT HTTPAPI_Init(void)
 {
 /*Codes_SRS_HTTPAPI_COMPACT_21_004: [ The HTTPAPI_Init shall allocate all memory to control the http protocol. ]*/
@@ -303,12 +407,33 @@ HTTP_HANDLE HTTPAPI_CreateConnection_Advanced(const char* hostName, int port, bo
                     free(http_instance);
                     http_instance = NULL;
                 }
+                else if ((http_instance->tick_counter = tickcounter_create()) == NULL)
+                {
+                    LogError("Create tick counter failed");
+                    xio_destroy(http_instance->xio_handle);
+                    free(http_instance);
+                    http_instance = NULL;
+                }
+                else if ((http_instance->response_parser = http_response_parser_create(&response_parser_callbacks, http_instance)) == NULL)
+                {
+                    LogError("Create response parser failed");
+                    tickcounter_destroy(http_instance->tick_counter);
+                    xio_destroy(http_instance->xio_handle);
+                    free(http_instance);
+                    http_instance = NULL;
+                }
                 else
                 {
+                    http_instance->response_target = NULL;
+                    http_instance->response_parser_result = HTTP_RESPONSE_PARSER_NEED_MORE_DATA;
                     http_instance->is_connected = 0;
                     http_instance->is_io_error = 0;
+                    http_instance->io_wait_unsupported = 0;
+                    http_instance->is_data_received = 0;
                     http_instance->received_bytes_count = 0;
                     http_instance->received_bytes = NULL;
+                    http_instance->request_buffer_size = 0;
+                    http_instance->request_buffer = NULL;
                     http_instance->certificate = NULL;
                     http_instance->x509ClientCertificate = NULL;
                     http_instance->x509ClientPrivateKey = NULL;
@@ -325,6 +450,9 @@ HTTP_HANDLE HTTPAPI_CreateConnection_Advanced(const char* hostName, int port, bo
         if ((result = OpenXIOConnection(http_instance)) != HTTPAPI_OK)
         {
             LogError("Open HTTP connection failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+            http_response_parser_destroy(http_instance->response_parser);
+            tickcounter_destroy(http_instance->tick_counter);
+            xio_destroy(http_instance->xio_handle);
             free(http_instance);
             http_instance = NULL;
         }
@@ -364,18 +492,16 @@ void HTTPAPI_CloseConnection(HTTP_HANDLE handle)
             }
             else
             {
+                IO_DEADLINE deadline;
                 /*Codes_SRS_HTTPAPI_COMPACT_21_084: [ The HTTPAPI_CloseConnection shall wait, at least, 10 seconds for the SSL close process. ]*/
-                int countRetry = MAX_CLOSE_RETRY;
+                if (start_deadline(http_instance, &deadline, CLOSE_TIMEOUT_IN_MILLISECONDS, CLOSE_RETRY_INTERVAL_IN_MILLISECONDS) != 0)
+                {
+                    http_instance->is_connected = 0;
+                }
                 while (http_instance->is_connected == 1)
                 {
                     xio_dowork(http_instance->xio_handle);
-                    if ((countRetry--) < 0)
-                    {
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_085: [ If the HTTPAPI_CloseConnection retries 10 seconds to close the connection without success, it shall destroy the connection anyway. ]*/
-                        LogError("Close timeout. The SSL didn't close the connection");
-                        http_instance->is_connected = 0;
-                    }
-                    else if (http_instance->is_io_error == 1)
+                    if (http_instance->is_io_error == 1)
                     {
                         LogError("The SSL got error closing the connection");
                         http_instance->is_connected = 0;
@@ -383,13 +509,25 @@ void HTTPAPI_CloseConnection(HTTP_HANDLE handle)
                     else if (http_instance->is_connected == 1)
                     {
                         LogInfo("Waiting for TLS close connection");
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_086: [ The HTTPAPI_CloseConnection shall wait, at least, 100 milliseconds between retries. ]*/
-                        ThreadAPI_Sleep(CLOSE_RETRY_INTERVAL_IN_MILLISECONDS);
+                        /*Codes_SRS_HTTPAPI_COMPACT_21_086: [ The HTTPAPI_CloseConnection shall block on the transport until the close can make progress, and only poll it between retries when the transport cannot wait on its own. ]*/
+                        if (wait_for_io(http_instance, &deadline) != 0)
+                        {
+                            /*Codes_SRS_HTTPAPI_COMPACT_21_085: [ If the HTTPAPI_CloseConnection retries 10 seconds to close the connection without success, it shall destroy the connection anyway. ]*/
+                            LogError("Close timeout. The SSL didn't close the connection");
+                            http_instance->is_connected = 0;
+                        }
                     }
                 }
             }
             /*Codes_SRS_HTTPAPI_COMPACT_21_076: [ After close the connection, The HTTPAPI_CloseConnection shall destroy the connection previously created in HTTPAPI_CreateConnection. ]*/
             xio_destroy(http_instance->xio_handle);
+            tickcounter_destroy(http_instance->tick_counter);
+            http_response_parser_destroy(http_instance->response_parser);
+        }
+
+        if (http_instance->request_buffer != NULL)
+        {
+            free(http_instance->request_buffer);
         }
 
         /*Codes_SRS_HTTPAPI_COMPACT_21_018: [ If there is a certificate associated to this connection, the HTTPAPI_CloseConnection shall free all allocated memory for the certificate. ]*/
@@ -454,34 +592,6 @@ static void on_send_complete(void* context, IO_SEND_RESULT send_result)
     }
 }
 
-#define TOLOWER(c) (((c>='A') && (c<='Z'))?c-'A'+'a':c)
-static int InternStrnicmp(const char* s1, const char* s2, size_t n)
-{
-    int result;
-
-    if (s1 == NULL) result = -1;
-    else if (s2 == NULL) result = 1;
-    else
-    {
-        result = 0;
-
-        while(n-- && result == 0)
-        {
-            if (*s1 == 0) result = -1;
-            else if (*s2 == 0) result = 1;
-            else
-            {
-
-                result = TOLOWER(*s1) - TOLOWER(*s2);
-                ++s1;
-                ++s2;
-            }
-        }
-    }
-
-    return result;
-}
-
 static void on_bytes_received(void* context, const unsigned char* buffer, size_t size)
 {
     unsigned char* new_received_bytes;
@@ -496,6 +606,22 @@ static void on_bytes_received(void* context, const unsigned char* buffer, size_t
             LogError("NULL pointer error");
         }
         else
+        {
+            http_instance->is_data_received = 1;
+
+            if ((http_instance->response_target != NULL) &&
+                (http_instance->received_bytes_count == 0) &&
+                (http_instance->response_parser_result == HTTP_RESPONSE_PARSER_NEED_MORE_DATA))
+            {
+                /* A response is being read and nothing is queued ahead of these bytes, so parse them in place */
+                size_t bytes_consumed;
+                http_instance->response_parser_result = http_response_parser_feed(http_instance->response_parser, buffer, size, &bytes_consumed);
+                buffer += bytes_consumed;
+                size -= bytes_consumed;
+            }
+        }
+
+        if ((buffer != NULL) && (size > 0))
         {
             /* Here we got some bytes so we'll buffer them so the receive functions can consumer it */
             new_received_bytes = (unsigned char*)realloc(http_instance->received_bytes, http_instance->received_bytes_count + size);
@@ -531,56 +657,6 @@ static void on_io_error(void* context)
     }
 }
 
-static int conn_receive(HTTP_HANDLE_DATA* http_instance, char* buffer, int count)
-{
-    int result;
-
-    if ((http_instance == NULL) || (buffer == NULL) || (count < 0))
-    {
-        LogError("conn_receive: %s", ((http_instance == NULL) ? "Invalid HTTP instance" : "Invalid HTTP buffer"));
-        result = -1;
-    }
-    else
-    {
-        result = 0;
-        while (result < count)
-        {
-            xio_dowork(http_instance->xio_handle);
-
-            /* if any error was detected while receiving then simply break and report it */
-            if (http_instance->is_io_error != 0)
-            {
-                LogError("xio reported error on dowork");
-                result = -1;
-                break;
-            }
-
-            if (http_instance->received_bytes_count >= (size_t)count)
-            {
-                /* Consuming bytes from the receive buffer */
-                (void)memcpy(buffer, http_instance->received_bytes, count);
-                (void)memmove(http_instance->received_bytes, http_instance->received_bytes + count, http_instance->received_bytes_count - count);
-                http_instance->received_bytes_count -= count;
-
-                /* we're not reallocating at each consumption so that we don't trash due to byte by byte consumption */
-                if (http_instance->received_bytes_count == 0)
-                {
-                    free(http_instance->received_bytes);
-                    http_instance->received_bytes = NULL;
-                }
-
-                result = count;
-                break;
-            }
-
-            /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
-            ThreadAPI_Sleep(RECEIVE_RETRY_INTERVAL_IN_MILLISECONDS);
-        }
-    }
-
-    return result;
-}
-
 static void conn_receive_discard_buffer(HTTP_HANDLE_DATA* http_instance)
 {
     if (http_instance != NULL)
@@ -594,186 +670,6 @@ static void conn_receive_discard_buffer(HTTP_HANDLE_DATA* http_instance)
     }
 }
 
-static int readLine(HTTP_HANDLE_DATA* http_instance, char* buf, const size_t maxBufSize)
-{
-    int resultLineSize;
-
-    if ((http_instance == NULL) || (buf == NULL) || (maxBufSize == 0))
-    {
-        LogError("%s", ((http_instance == NULL) ? "Invalid HTTP instance" : "Invalid HTTP buffer"));
-        resultLineSize = -1;
-    }
-    else
-    {
-        char* destByte = buf;
-        /*Codes_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
-        int countRetry = MAX_RECEIVE_RETRY;
-        bool endOfSearch = false;
-        resultLineSize = -1;
-        while (!endOfSearch)
-        {
-            xio_dowork(http_instance->xio_handle);
-
-            /* if any error was detected while receiving then simply break and report it */
-            if (http_instance->is_io_error != 0)
-            {
-                LogError("xio reported error on dowork");
-                endOfSearch = true;
-            }
-            else
-            {
-                unsigned char* receivedByte = http_instance->received_bytes;
-                while (receivedByte < (http_instance->received_bytes + http_instance->received_bytes_count))
-                {
-                    if ((*receivedByte) != '\r')
-                    {
-                        (*destByte) = (*receivedByte);
-                        destByte++;
-                        receivedByte++;
-
-                        if (destByte >= (buf + maxBufSize - 1))
-                        {
-                            LogError("Received message is bigger than the http buffer");
-                            receivedByte = http_instance->received_bytes + http_instance->received_bytes_count;
-                            endOfSearch = true;
-                            break;
-                        }
-                    }
-                    else
-                    {
-                        receivedByte++;
-                        if ((receivedByte < (http_instance->received_bytes + http_instance->received_bytes_count)) && ((*receivedByte) == '\n'))
-                        {
-                            receivedByte++;
-                        }
-                        (*destByte) = '\0';
-                        resultLineSize = (int)(destByte - buf);
-                        endOfSearch = true;
-                        break;
-                    }
-                }
-
-                http_instance->received_bytes_count -= (receivedByte - http_instance->received_bytes);
-                if (http_instance->received_bytes_count != 0)
-                {
-                    (void)memmove(http_instance->received_bytes, receivedByte, http_instance->received_bytes_count);
-                }
-                else
-                {
-                    conn_receive_discard_buffer(http_instance);
-                }
-            }
-
-            if (!endOfSearch)
-            {
-                if ((countRetry--) > 0)
-                {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
-                    ThreadAPI_Sleep(RECEIVE_RETRY_INTERVAL_IN_MILLISECONDS);
-                }
-                else
-                {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-                    LogError("Receive timeout. The HTTP request is incomplete");
-                    endOfSearch = true;
-                }
-            }
-        }
-    }
-
-    return resultLineSize;
-}
-
-static int readChunk(HTTP_HANDLE_DATA* http_instance, char* buf, size_t size)
-{
-    int cur, offset;
-
-    // read content with specified length, even if it is received
-    // only in chunks due to fragmentation in the networking layer.
-    // returns -1 in case of error.
-    offset = 0;
-    while (size > (size_t)0)
-    {
-        cur = conn_receive(http_instance, buf + offset, (int)size);
-
-        // end of stream reached
-        if (cur == 0)
-        {
-            break;
-        }
-
-        // read cur bytes (might be less than requested)
-        size -= (size_t)cur;
-        offset += cur;
-    }
-
-    return offset;
-}
-
-static int skipN(HTTP_HANDLE_DATA* http_instance, size_t n)
-{
-    // read and abandon response content with specified length
-    // returns -1 in case of error.
-
-    int result;
-
-    if (http_instance == NULL)
-    {
-        LogError("Invalid HTTP instance");
-        result = -1;
-    }
-    else
-    {
-        /*Codes_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
-        int countRetry = MAX_RECEIVE_RETRY;
-        result = (int)n;
-        while (n > 0)
-        {
-            xio_dowork(http_instance->xio_handle);
-
-            /* if any error was detected while receiving then simply break and report it */
-            if (http_instance->is_io_error != 0)
-            {
-                LogError("xio reported error on dowork");
-                result = -1;
-                n = 0;
-            }
-            else
-            {
-                if (http_instance->received_bytes_count <= n)
-                {
-                    n -= http_instance->received_bytes_count;
-                    http_instance->received_bytes_count = 0;
-                }
-                else
-                {
-                    http_instance->received_bytes_count -= n;
-                    (void)memmove(http_instance->received_bytes, http_instance->received_bytes + n, http_instance->received_bytes_count);
-                    n = 0;
-                }
-
-                if (n > 0)
-                {
-                    if ((countRetry--) > 0)
-                    {
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
-                        ThreadAPI_Sleep(RECEIVE_RETRY_INTERVAL_IN_MILLISECONDS);
-                    }
-                    else
-                    {
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-                        LogError("Receive timeout. The HTTP request is incomplete");
-                        n = 0;
-                        result = -1;
-                    }
-                }
-            }
-        }
-    }
-
-    return result;
-}
-
 
 /*Codes_SRS_HTTPAPI_COMPACT_21_021: [ The HTTPAPI_ExecuteRequest shall execute the http communtication with the provided host, sending a request and reciving the response. ]*/
 static HTTPAPI_RESULT OpenXIOConnection(HTTP_HANDLE_DATA* http_instance)
@@ -830,27 +726,35 @@ static HTTPAPI_RESULT OpenXIOConnection(HTTP_HANDLE_DATA* http_instance)
             }
             else
             {
-				int countRetry;
+                IO_DEADLINE deadline;
                 /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
                 result = HTTPAPI_OK;
                 /*Codes_SRS_HTTPAPI_COMPACT_21_077: [ The HTTPAPI_ExecuteRequest shall wait, at least, 10 seconds for the SSL open process. ]*/
-                countRetry = MAX_OPEN_RETRY;
-                while ((http_instance->is_connected == 0) &&
-                    (http_instance->is_io_error == 0))
+                if (start_deadline(http_instance, &deadline, OPEN_TIMEOUT_IN_MILLISECONDS, OPEN_RETRY_INTERVAL_IN_MILLISECONDS) != 0)
                 {
-                    xio_dowork(http_instance->xio_handle);
-                    LogInfo("Waiting for TLS connection");
-                    if ((countRetry--) < 0)
-                    {
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_078: [ If the HTTPAPI_ExecuteRequest cannot open the connection in 10 seconds, it shall fail and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
-                        LogError("Open timeout. The HTTP request is incomplete");
-                        result = HTTPAPI_OPEN_REQUEST_FAILED;
-                        break;
-                    }
-                    else
+                    result = HTTPAPI_OPEN_REQUEST_FAILED;
+                }
+                else
+                {
+                    while ((http_instance->is_connected == 0) &&
+                        (http_instance->is_io_error == 0))
                     {
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
-                        ThreadAPI_Sleep(OPEN_RETRY_INTERVAL_IN_MILLISECONDS);
+                        xio_dowork(http_instance->xio_handle);
+                        if ((http_instance->is_connected != 0) ||
+                            (http_instance->is_io_error != 0))
+                        {
+                            break;
+                        }
+
+                        LogInfo("Waiting for TLS connection");
+                        /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall block on the transport until it can make progress, and only poll it between retries when the transport cannot wait on its own. ]*/
+                        if (wait_for_io(http_instance, &deadline) != 0)
+                        {
+                            /*Codes_SRS_HTTPAPI_COMPACT_21_078: [ If the HTTPAPI_ExecuteRequest cannot open the connection in 10 seconds, it shall fail and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
+                            LogError("Open timeout. The HTTP request is incomplete");
+                            result = HTTPAPI_OPEN_REQUEST_FAILED;
+                            break;
+                        }
                     }
                 }
             }
@@ -879,10 +783,10 @@ static HTTPAPI_RESULT conn_send_all(HTTP_HANDLE_DATA* http_instance, const unsig
     }
     else
     {
+        IO_DEADLINE deadline;
         /*Codes_SRS_HTTPAPI_COMPACT_21_079: [ The HTTPAPI_ExecuteRequest shall wait, at least, 20 seconds to send a buffer using the SSL connection. ]*/
-        int countRetry = MAX_SEND_RETRY;
         /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
-        result = HTTPAPI_OK;
+        result = (start_deadline(http_instance, &deadline, SEND_TIMEOUT_IN_MILLISECONDS, SEND_RETRY_INTERVAL_IN_MILLISECONDS) != 0) ? HTTPAPI_SEND_REQUEST_FAILED : HTTPAPI_OK;
         while ((http_instance->send_completed == 0) && (result == HTTPAPI_OK))
         {
             xio_dowork(http_instance->xio_handle);
@@ -891,18 +795,15 @@ static HTTPAPI_RESULT conn_send_all(HTTP_HANDLE_DATA* http_instance, const unsig
                 /*Codes_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_HTTP_HEADERS_FAILED. ]*/
                 result = HTTPAPI_SEND_REQUEST_FAILED;
             }
-            else if ((countRetry--) <= 0)
+            /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall block on the transport until it can make progress, and only poll it between retries when the transport cannot wait on its own. ]*/
+            else if ((http_instance->send_completed == 0) &&
+                (wait_for_io(http_instance, &deadline) != 0))
             {
                 /*Codes_SRS_HTTPAPI_COMPACT_21_080: [ If the HTTPAPI_ExecuteRequest retries to send the message for 20 seconds without success, it shall fail and return HTTPAPI_SEND_REQUEST_FAILED. ]*/
                 LogError("Send timeout. The HTTP request is incomplete");
                 /*Codes_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_HTTP_HEADERS_FAILED. ]*/
                 result = HTTPAPI_SEND_REQUEST_FAILED;
             }
-            else
-            {
-                /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
-                ThreadAPI_Sleep(SEND_RETRY_INTERVAL_IN_MILLISECONDS);
-            }
         }
     }
 
@@ -917,55 +818,122 @@ const char* get_request_type(HTTPAPI_REQUEST_TYPE requestType)
 }
 
 /*Codes_SRS_HTTPAPI_COMPACT_21_026: [ If the open process succeed, the HTTPAPI_ExecuteRequest shall send the request message to the host. ]*/
-static HTTPAPI_RESULT SendHeadsToXIO(HTTP_HANDLE_DATA* http_instance, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE httpHeadersHandle, size_t headersCount)
+/* Grows the request buffer, which is kept between requests, so that it can hold at least size bytes. */
+static HTTPAPI_RESULT reserve_request_buffer(HTTP_HANDLE_DATA* http_instance, size_t size)
 {
     HTTPAPI_RESULT result;
-    char    buf[TEMP_BUFFER_SIZE];
-    int     ret;
-
-    //Send request
-    /*Codes_SRS_HTTPAPI_COMPACT_21_038: [ The HTTPAPI_ExecuteRequest shall execute the resquest for the path in relativePath parameter. ]*/
-    /*Codes_SRS_HTTPAPI_COMPACT_21_036: [ The request type shall be provided in the parameter requestType. ]*/
-    if (((ret = snprintf(buf, sizeof(buf), "%s %s HTTP/1.1\r\n", get_request_type(requestType), relativePath)) < 0) ||
-        (ret >= sizeof(buf)))
+
+    if (size <= http_instance->request_buffer_size)
     {
-        /*Codes_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
-        result = HTTPAPI_STRING_PROCESSING_ERROR;
+        result = HTTPAPI_OK;
     }
-        /*Codes_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_HTTP_HEADERS_FAILED. ]*/
-    else if ((result = conn_send_all(http_instance, (const unsigned char*)buf, strlen(buf))) == HTTPAPI_OK)
+    else
     {
-		size_t i;
-        //Send default headers
-        /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
-        for (i = 0; ((i < headersCount) && (result == HTTPAPI_OK)); i++)
+        unsigned char* new_request_buffer = (unsigned char*)realloc(http_instance->request_buffer, size);
+        if (new_request_buffer == NULL)
         {
-            char* header;
-            if (HTTPHeaders_GetHeader(httpHeadersHandle, i, &header) != HTTP_HEADERS_OK)
-            {
-                /*Codes_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
-                result = HTTPAPI_STRING_PROCESSING_ERROR;
-            }
-            else
-            {
-                if ((result = conn_send_all(http_instance, (const unsigned char*)header, strlen(header))) == HTTPAPI_OK)
-                {
-                    result = conn_send_all(http_instance, (const unsigned char*)"\r\n", (size_t)2);
-                }
-                free(header);
-            }
+            LogError("Cannot allocate memory for the request");
+            result = HTTPAPI_ALLOC_FAILED;
+        }
+        else
+        {
+            http_instance->request_buffer = new_request_buffer;
+            http_instance->request_buffer_size = size;
+            result = HTTPAPI_OK;
+        }
+    }
+
+    return result;
+}
+
+/* The request line, the headers and, when it is small, the content are serialized in the request buffer and sent with a
+   single xio_send, so that a request is one write (and one TLS record) instead of one per header line. */
+static HTTPAPI_RESULT SendHeadsToXIO(HTTP_HANDLE_DATA* http_instance, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE httpHeadersHandle, size_t headersCount,
+    const unsigned char* content, size_t contentLength, bool* contentSent)
+{
+    HTTPAPI_RESULT result = HTTPAPI_OK;
+    const char* requestTypeString = get_request_type(requestType);
+    size_t requestTypeLength = strlen(requestTypeString);
+    size_t relativePathLength = strlen(relativePath);
+    size_t headLength = requestTypeLength + 1 + relativePathLength + (sizeof(" HTTP/1.1\r\n") - 1) + 2;
+    size_t inlineContentLength = ((content != NULL) && (contentLength <= MAX_INLINE_CONTENT_SIZE)) ? contentLength : 0;
+    size_t i;
+
+    /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
+    for (i = 0; ((i < headersCount) && (result == HTTPAPI_OK)); i++)
+    {
+        const char* name;
+        const char* value;
+        if (HTTPHeaders_GetHeaderNameValue(httpHeadersHandle, i, &name, &value) != HTTP_HEADERS_OK)
+        {
+            /*Codes_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
+            result = HTTPAPI_STRING_PROCESSING_ERROR;
+        }
+        else
+        {
+            headLength += strlen(name) + 2 + strlen(value) + 2;
+        }
+    }
+
+    if (result != HTTPAPI_OK)
+    {
+        LogError("Cannot get the request headers");
+    }
+    /*Codes_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
+    else if ((result = reserve_request_buffer(http_instance, headLength + inlineContentLength)) == HTTPAPI_OK)
+    {
+        unsigned char* position = http_instance->request_buffer;
+
+        //Request line
+        /*Codes_SRS_HTTPAPI_COMPACT_21_038: [ The HTTPAPI_ExecuteRequest shall execute the resquest for the path in relativePath parameter. ]*/
+        /*Codes_SRS_HTTPAPI_COMPACT_21_036: [ The request type shall be provided in the parameter requestType. ]*/
+        (void)memcpy(position, requestTypeString, requestTypeLength);
+        position += requestTypeLength;
+        *(position++) = ' ';
+        (void)memcpy(position, relativePath, relativePathLength);
+        position += relativePathLength;
+        (void)memcpy(position, " HTTP/1.1\r\n", sizeof(" HTTP/1.1\r\n") - 1);
+        position += sizeof(" HTTP/1.1\r\n") - 1;
+
+        //Headers; the count was validated by the loop above
+        for (i = 0; i < headersCount; i++)
+        {
+            const char* name;
+            const char* value;
+            size_t length;
+            (void)HTTPHeaders_GetHeaderNameValue(httpHeadersHandle, i, &name, &value);
+
+            length = strlen(name);
+            (void)memcpy(position, name, length);
+            position += length;
+            *(position++) = ':';
+            *(position++) = ' ';
+            length = strlen(value);
+            (void)memcpy(position, value, length);
+            position += length;
+            *(position++) = '\r';
+            *(position++) = '\n';
         }
 
         //Close headers
-        if (result == HTTPAPI_OK)
+        *(position++) = '\r';
+        *(position++) = '\n';
+
+        if (inlineContentLength > 0)
         {
-            result = conn_send_all(http_instance, (const unsigned char*)"\r\n", (size_t)2);
+            (void)memcpy(position, content, inlineContentLength);
+            position += inlineContentLength;
         }
+
+        /*Codes_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_HTTP_HEADERS_FAILED. ]*/
+        result = conn_send_all(http_instance, http_instance->request_buffer, (size_t)(position - http_instance->request_buffer));
     }
+
+    *contentSent = (result == HTTPAPI_OK) && (inlineContentLength > 0);
+
     return result;
 }
 
-/*Codes_SRS_HTTPAPI_COMPACT_21_042: [ The request can contain the a content message, provided in content parameter. ]*/
 static HTTPAPI_RESULT SendContentToXIO(HTTP_HANDLE_DATA* http_instance, const unsigned char* content, size_t contentLength)
 {
     HTTPAPI_RESULT result;
@@ -987,280 +955,105 @@ static HTTPAPI_RESULT SendContentToXIO(HTTP_HANDLE_DATA* http_instance, const un
 }
 
 /*Codes_SRS_HTTPAPI_COMPACT_21_030: [ At the end of the transmission, the HTTPAPI_ExecuteRequest shall receive the response from the host. ]*/
-static HTTPAPI_RESULT ReceiveHeaderFromXIO(HTTP_HANDLE_DATA* http_instance, unsigned int* statusCode, char* reasonPhrase, const size_t maxReasonPhraseSize)
+static void feed_received_bytes(HTTP_HANDLE_DATA* http_instance)
 {
-    HTTPAPI_RESULT result;
-    char    buf[TEMP_BUFFER_SIZE];
-    int     ret;
+    size_t bytes_consumed;
 
-    http_instance->is_io_error = 0;
-
-    //Receive response
-    if (readLine(http_instance, buf, TEMP_BUFFER_SIZE) < 0)
-    {
-        /*Codes_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
-        /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-        result = HTTPAPI_READ_DATA_FAILED;
-    }
-    //Parse HTTP response
-    else if (ParseHttpResponse(buf, &ret, reasonPhrase, maxReasonPhraseSize) != 1)
+    http_instance->response_parser_result = http_response_parser_feed(http_instance->response_parser, http_instance->received_bytes, http_instance->received_bytes_count, &bytes_consumed);
+    http_instance->received_bytes_count -= bytes_consumed;
+    if (http_instance->received_bytes_count != 0)
     {
-        //Cannot match string, error
-        /*Codes_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
-        LogInfo("Not a correct HTTP answer");
-        result = HTTPAPI_RECEIVE_RESPONSE_FAILED;
+        /* keep what follows the response; it is dropped with the rest of the buffer at the end of the request */
+        (void)memmove(http_instance->received_bytes, http_instance->received_bytes + bytes_consumed, http_instance->received_bytes_count);
     }
     else
     {
-        /*Codes_SRS_HTTPAPI_COMPACT_21_046: [ The HTTPAPI_ExecuteRequest shall return the http status reported by the host in the received response. ]*/
-        /*Codes_SRS_HTTPAPI_COMPACT_21_048: [ If the statusCode is NULL, the HTTPAPI_ExecuteRequest shall report not report any status. ]*/
-        if (statusCode)
-        {
-            /*Codes_SRS_HTTPAPI_COMPACT_21_047: [ The HTTPAPI_ExecuteRequest shall report the status in the statusCode parameter. ]*/
-            *statusCode = ret;
-        }
-        /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
-        result = HTTPAPI_OK;
+        conn_receive_discard_buffer(http_instance);
     }
-
-    return result;
 }
 
-static HTTPAPI_RESULT ReceiveContentInfoFromXIO(HTTP_HANDLE_DATA* http_instance, HTTP_HEADERS_HANDLE responseHeadersHandle, size_t* bodyLength, bool* chunked)
+/*Codes_SRS_HTTPAPI_COMPACT_21_030: [ At the end of the transmission, the HTTPAPI_ExecuteRequest shall receive the response from the host. ]*/
+static HTTPAPI_RESULT ReceiveResponseFromXIO(HTTP_HANDLE_DATA* http_instance, HTTP_RESPONSE_TARGET* target)
 {
     HTTPAPI_RESULT result;
-    char    buf[TEMP_BUFFER_SIZE];
-    const char* substr;
-    char* whereIsColon;
-    int lengthInMsg;
-    const char ContentLength[] = "content-length:";
-    const size_t ContentLengthSize = sizeof(ContentLength) - 1;
-    const char TransferEncoding[] = "transfer-encoding:";
-    const size_t TransferEncodingSize = sizeof(TransferEncoding) - 1;
-    const char Chunked[] = "chunked";
-    const size_t ChunkedSize = sizeof(Chunked) - 1;
+    IO_DEADLINE deadline;
 
     http_instance->is_io_error = 0;
+    http_instance->response_target = target;
+    http_instance->response_parser_result = HTTP_RESPONSE_PARSER_NEED_MORE_DATA;
 
-    //Read HTTP response headers
-    if (readLine(http_instance, buf, sizeof(buf)) < 0)
+    /*Codes_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
+    if ((http_response_parser_reset(http_instance->response_parser) != 0) ||
+        (start_deadline(http_instance, &deadline, RECEIVE_TIMEOUT_IN_MILLISECONDS, RECEIVE_RETRY_INTERVAL_IN_MILLISECONDS) != 0))
     {
-        /*Codes_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
-        /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-        result = HTTPAPI_READ_DATA_FAILED;
+        result = HTTPAPI_ERROR;
     }
     else
     {
         /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
         result = HTTPAPI_OK;
-
-        while (*buf && (result == HTTPAPI_OK))
+        while ((result == HTTPAPI_OK) &&
+            (http_instance->response_parser_result == HTTP_RESPONSE_PARSER_NEED_MORE_DATA))
         {
-            if (InternStrnicmp(buf, ContentLength, ContentLengthSize) == 0)
+            if (http_instance->received_bytes_count > 0)
             {
-                substr = buf + ContentLengthSize;
-                if (ParseStringToDecimalAndRemaining(substr, &lengthInMsg, NULL, 0) != 1)
-                {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
-                    result = HTTPAPI_READ_DATA_FAILED;
-                }
-                else
-                {
-                    (*bodyLength) = (size_t)lengthInMsg;
-                }
-            }
-            else if (InternStrnicmp(buf, TransferEncoding, TransferEncodingSize) == 0)
-            {
-                substr = buf + TransferEncodingSize;
-
-#ifdef _MSC_VER
-// Disable: error 6330: 'const char' passed as _Param_(1) when 'unsigned char' is required in call to 'isspace'.
-#pragma warning(disable:6330)
-#endif
-                while (isspace(*substr)) substr++;
-#ifdef _MSC_VER
-#pragma warning(default:6330)
-#endif
-
-                if (InternStrnicmp(substr, Chunked, ChunkedSize) == 0)
-                {
-                    (*chunked) = true;
-                }
-            }
-
-            if (result == HTTPAPI_OK)
-            {
-                whereIsColon = strchr((char*)buf, ':');
-                /*Codes_SRS_HTTPAPI_COMPACT_21_049: [ If responseHeadersHandle is provide, the HTTPAPI_ExecuteRequest shall prepare a Response Header usign the HTTPHeaders_AddHeaderNameValuePair. ]*/
-                if (whereIsColon && (responseHeadersHandle != NULL))
-                {
-                    *whereIsColon = '\0';
-                    HTTPHeaders_AddHeaderNameValuePair(responseHeadersHandle, buf, whereIsColon + 1);
-                }
-
-                if (readLine(http_instance, buf, sizeof(buf)) < 0)
-                {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-                    result = HTTPAPI_READ_DATA_FAILED;
-                }
+                /* bytes buffered before the response was expected, e.g. with the send still in progress */
+                feed_received_bytes(http_instance);
             }
-        }
-    }
-
-    return result;
-}
-
-static HTTPAPI_RESULT ReadHTTPResponseBodyFromXIO(HTTP_HANDLE_DATA* http_instance, size_t bodyLength,
-    bool chunked, BUFFER_HANDLE responseContent, ON_CHUNK_RECEIVED on_chunk_received, void* on_chunk_received_context)
-{
-    HTTPAPI_RESULT result;
-    char    buf[TEMP_BUFFER_SIZE];
-    const unsigned char* receivedContent;
-
-    http_instance->is_io_error = 0;
-
-    //Read HTTP response body
-    if (!chunked)
-    {
-        if (bodyLength)
-        {
-            if (responseContent != NULL)
+            else
             {
-                if (BUFFER_pre_build(responseContent, bodyLength) != 0)
-                {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
-                    result = HTTPAPI_ALLOC_FAILED;
-                }
-                else if (BUFFER_content(responseContent, &receivedContent) != 0)
-                {
-                    (void)BUFFER_unbuild(responseContent);
+                /* the bytes received during dowork go straight to the parser through on_bytes_received */
+                http_instance->is_data_received = 0;
+                xio_dowork(http_instance->xio_handle);
 
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
-                    result = HTTPAPI_ALLOC_FAILED;
-                }
-                else if (readChunk(http_instance, (char*)receivedContent, bodyLength) < 0)
+                /* if any error was detected while receiving then simply break and report it */
+                if (http_instance->is_io_error != 0)
                 {
+                    LogError("xio reported error on dowork");
                     /*Codes_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
                     result = HTTPAPI_READ_DATA_FAILED;
                 }
-                else
+                else if (http_instance->is_data_received != 0)
                 {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
-                    result = HTTPAPI_OK;
-
-                    if (on_chunk_received != NULL)
+                    /* the timeout bounds the time without any progress, not the whole transfer */
+                    if (start_deadline(http_instance, &deadline, RECEIVE_TIMEOUT_IN_MILLISECONDS, RECEIVE_RETRY_INTERVAL_IN_MILLISECONDS) != 0)
                     {
-                        on_chunk_received(on_chunk_received_context, receivedContent, bodyLength);
+                        result = HTTPAPI_ERROR;
                     }
                 }
-            }
-            else
-            {
-                /*Codes_SRS_HTTPAPI_COMPACT_21_051: [ If the responseContent is NULL, the HTTPAPI_ExecuteRequest shall ignore any content in the response. ]*/
-                if (skipN(http_instance, bodyLength) < 0)
+                /*Codes_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall block on the transport until it can make progress, and only poll it between retries when the transport cannot wait on its own. ]*/
+                else if (wait_for_io(http_instance, &deadline) != 0)
                 {
                     /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
+                    LogError("Receive timeout. The HTTP request is incomplete");
                     result = HTTPAPI_READ_DATA_FAILED;
                 }
-                else
-                {
-                    result = HTTPAPI_OK;
-                }
             }
         }
-        else
+
+        if (result != HTTPAPI_OK)
         {
-            /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
-            result = HTTPAPI_OK;
+            /* the error was already logged */
         }
-    }
-    else
-    {
-        size_t size = 0;
-        /*Codes_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
-        result = HTTPAPI_OK;
-        while (result == HTTPAPI_OK)
+        else if (http_instance->response_parser_result == HTTP_RESPONSE_PARSER_ERROR)
         {
-            size_t chunkSize;
-            if (readLine(http_instance, buf, sizeof(buf)) < 0)    // read [length in hex]/r/n
-            {
-                /*Codes_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
-                /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-                result = HTTPAPI_READ_DATA_FAILED;
-            }
-            else if (ParseStringToHexadecimal(buf, &chunkSize) != 1)     // chunkSize is length of next line (/r/n is not counted)
-            {
-                //Cannot match string, error
-                /*Codes_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
-                result = HTTPAPI_RECEIVE_RESPONSE_FAILED;
-            }
-            else if (chunkSize == 0)
-            {
-                // 0 length means next line is just '\r\n' and end of chunks
-                if (readChunk(http_instance, (char*)buf, (size_t)2) < 0
-                    || buf[0] != '\r' || buf[1] != '\n') // skip /r/n
-                {
-                    (void)BUFFER_unbuild(responseContent);
-
-                    result = HTTPAPI_READ_DATA_FAILED;
-                }
-                break;
-            }
-            else
-            {
-                if (responseContent != NULL)
-                {
-                    if (BUFFER_enlarge(responseContent, chunkSize) != 0)
-                    {
-                        (void)BUFFER_unbuild(responseContent);
-
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
-                        result = HTTPAPI_ALLOC_FAILED;
-                    }
-                    else if (BUFFER_content(responseContent, &receivedContent) != 0)
-                    {
-                        (void)BUFFER_unbuild(responseContent);
-
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
-                        result = HTTPAPI_ALLOC_FAILED;
-                    }
-                    else if (readChunk(http_instance, (char*)receivedContent + size, chunkSize) < 0)
-                    {
-                        result = HTTPAPI_READ_DATA_FAILED;
-                    }
-                    else if (on_chunk_received != NULL)
-                    {
-                        on_chunk_received(on_chunk_received_context, receivedContent + size, chunkSize);
-                    }
-                }
-                else
-                {
-                    /*Codes_SRS_HTTPAPI_COMPACT_21_051: [ If the responseContent is NULL, the HTTPAPI_ExecuteRequest shall ignore any content in the response. ]*/
-                    if (skipN(http_instance, chunkSize) < 0)
-                    {
-                        /*Codes_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-                        result = HTTPAPI_READ_DATA_FAILED;
-                    }
-                }
-
-                if (result == HTTPAPI_OK)
-                {
-                    if (readChunk(http_instance, (char*)buf, (size_t)2) < 0
-                        || buf[0] != '\r' || buf[1] != '\n') // skip /r/n
-                    {
-                        result = HTTPAPI_READ_DATA_FAILED;
-                    }
-                    size += chunkSize;
-                }
-            }
+            /*Codes_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
+            /*Codes_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
+            LogError("Not a correct HTTP answer");
+            result = (target->result != HTTPAPI_OK) ? target->result : HTTPAPI_RECEIVE_RESPONSE_FAILED;
+        }
+        else if ((!target->chunked) && (target->contentSize > 0) && (target->onChunkReceived != NULL))
+        {
+            /* a Content-Length body is reported to the streaming callback in one piece, once it is whole */
+            target->onChunkReceived(target->onChunkReceivedContext, BUFFER_u_char(target->responseContent), target->contentSize);
         }
-
     }
+
+    http_instance->response_target = NULL;
+
     return result;
 }
 
-
 /*Codes_SRS_HTTPAPI_COMPACT_21_037: [ If the request type is unknown, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
 static bool validRequestType(HTTPAPI_REQUEST_TYPE requestType)
 {
@@ -1289,8 +1082,8 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest_Internal(HTTP_HANDLE handle, HTTPAPI_REQUE
 {
     HTTPAPI_RESULT result = HTTPAPI_ERROR;
     size_t  headersCount;
-    size_t  bodyLength = 0;
-    bool    chunked = false;
+    bool    contentSent = false;
+    HTTP_RESPONSE_TARGET target;
     HTTP_HANDLE_DATA* http_instance = (HTTP_HANDLE_DATA*)handle;
 
     BUFFER_HANDLE internalBuffer = NULL;
@@ -1322,30 +1115,36 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest_Internal(HTTP_HANDLE handle, HTTPAPI_REQUE
         LogError("(result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
     }
     /*Codes_SRS_HTTPAPI_COMPACT_21_026: [ If the open process succeed, the HTTPAPI_ExecuteRequest shall send the request message to the host. ]*/
-    else if ((result = SendHeadsToXIO(http_instance, requestType, relativePath, httpHeadersHandle, headersCount)) != HTTPAPI_OK)
+    else if ((result = SendHeadsToXIO(http_instance, requestType, relativePath, httpHeadersHandle, headersCount, content, contentLength, &contentSent)) != HTTPAPI_OK)
     {
         LogError("Send heads to HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
     }
     /*Codes_SRS_HTTPAPI_COMPACT_21_042: [ The request can contain the a content message, provided in content parameter. ]*/
-    else if ((result = SendContentToXIO(http_instance, content, contentLength)) != HTTPAPI_OK)
+    else if ((result = SendContentToXIO(http_instance, contentSent ? NULL : content, contentLength)) != HTTPAPI_OK)
     {
         LogError("Send content to HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
     }
-    /*Codes_SRS_HTTPAPI_COMPACT_21_030: [ At the end of the transmission, the HTTPAPI_ExecuteRequest shall receive the response from the host. ]*/
-    /*Codes_SRS_HTTPAPI_COMPACT_21_073: [ The message received by the HTTPAPI_ExecuteRequest shall starts with a valid header. ]*/
-    else if ((result = ReceiveHeaderFromXIO(http_instance, statusCode, reasonPhrase, maxReasonPhraseSize)) != HTTPAPI_OK)
-    {
-        LogError("Receive header from HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
-    }
-    /*Codes_SRS_HTTPAPI_COMPACT_21_074: [ After the header, the message received by the HTTPAPI_ExecuteRequest can contain addition information about the content. ]*/
-    else if ((result = ReceiveContentInfoFromXIO(http_instance, responseHeadersHandle, &bodyLength, &chunked)) != HTTPAPI_OK)
-    {
-        LogError("Receive content information from HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
-    }
-    /*Codes_SRS_HTTPAPI_COMPACT_21_075: [ The message received by the HTTPAPI_ExecuteRequest can contain a body with the message content. ]*/
-    else if ((result = ReadHTTPResponseBodyFromXIO(http_instance, bodyLength, chunked, responseContent, onChunkReceived, onChunkReceivedContext)) != HTTPAPI_OK)
+    else
     {
-        LogError("Read HTTP response body from HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+        target.statusCode = statusCode;
+        target.reasonPhrase = reasonPhrase;
+        target.maxReasonPhraseSize = maxReasonPhraseSize;
+        target.responseHeadersHandle = responseHeadersHandle;
+        target.responseContent = responseContent;
+        target.onChunkReceived = onChunkReceived;
+        target.onChunkReceivedContext = onChunkReceivedContext;
+        target.contentSize = 0;
+        target.chunkStart = 0;
+        target.chunked = false;
+        target.result = HTTPAPI_OK;
+
+        /*Codes_SRS_HTTPAPI_COMPACT_21_073: [ The message received by the HTTPAPI_ExecuteRequest shall starts with a valid header. ]*/
+        /*Codes_SRS_HTTPAPI_COMPACT_21_074: [ After the header, the message received by the HTTPAPI_ExecuteRequest can contain addition information about the content. ]*/
+        /*Codes_SRS_HTTPAPI_COMPACT_21_075: [ The message received by the HTTPAPI_ExecuteRequest can contain a body with the message content. ]*/
+        if ((result = ReceiveResponseFromXIO(http_instance, &target)) != HTTPAPI_OK)
+        {
+            LogError("Receive response from HTTP failed (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+        }
     }
 
     conn_receive_discard_buffer(http_instance);
@@ -11,6 +11,7 @@
 #include "azure_c_shared_utility/httpapi.h"
 #include "azure_c_shared_utility/httpheaders.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/lock.h"
 #include "curl/curl.h"
 #include "azure_c_shared_utility/xlogging.h"
 #ifdef USE_OPENSSL
@@ -37,6 +38,8 @@ typedef struct HTTP_HANDLE_DATA_TAG
     long forbidReuse;
     long freshConnect;
     long verbose;
+    long useSharedCache;
+    long httpVersion;
     const char* x509privatekey;
     const char* x509certificate;
     const char* certificates; /*a list of CA certificates*/
@@ -51,11 +54,118 @@ typedef struct HTTP_RESPONSE_CONTENT_BUFFER_TAG
 
 static size_t nUsersOfHTTPAPI = 0; /*used for reference counting (a weak one)*/
 
+/*DNS entries and TLS sessions shared by the handles that opt in, so a new handle to the same host can skip the name resolution and a full handshake*/
+static CURLSH* sharedCache = NULL;
+static LOCK_HANDLE sharedCacheLocks[CURL_LOCK_DATA_LAST];
+
+static void lockSharedCache(CURL* curl, curl_lock_data data, curl_lock_access access, void* userptr)
+{
+    /* Codes_SRS_HTTPAPI_CURL_01_006: [ The lock function of the share handle shall call `Lock` on the lock of the `curl_lock_data` being locked, and the unlock function shall call `Unlock` on it. ]*/
+    (void)curl;
+    (void)access;
+    (void)userptr;
+    if (Lock(sharedCacheLocks[data]) != LOCK_OK)
+    {
+        LogError("unable to Lock");
+    }
+}
+
+static void unlockSharedCache(CURL* curl, curl_lock_data data, void* userptr)
+{
+    /* Codes_SRS_HTTPAPI_CURL_01_006: [ The lock function of the share handle shall call `Lock` on the lock of the `curl_lock_data` being locked, and the unlock function shall call `Unlock` on it. ]*/
+    (void)curl;
+    (void)userptr;
+    if (Unlock(sharedCacheLocks[data]) != LOCK_OK)
+    {
+        LogError("unable to Unlock");
+    }
+}
+
+static void destroySharedCacheLocks(void)
+{
+    size_t i;
+    for (i = 0; i < CURL_LOCK_DATA_LAST; i++)
+    {
+        if (sharedCacheLocks[i] != NULL)
+        {
+            (void)Lock_Deinit(sharedCacheLocks[i]);
+            sharedCacheLocks[i] = NULL;
+        }
+    }
+}
+
+/*the shared cache is an optimization, the handles work without it when it cannot be created*/
+static void createSharedCache(void)
+{
+    /* Codes_SRS_HTTPAPI_CURL_01_001: [ On its first call, `HTTPAPI_Init` shall call `curl_global_init` and create the shared cache: one lock per `curl_lock_data` with `Lock_Init`, and a share handle with `curl_share_init`. ]*/
+    size_t i;
+    for (i = 0; i < CURL_LOCK_DATA_LAST; i++)
+    {
+        if ((sharedCacheLocks[i] = Lock_Init()) == NULL)
+        {
+            break;
+        }
+    }
+
+    /* Codes_SRS_HTTPAPI_CURL_01_003: [ If `Lock_Init`, `curl_share_init` or `curl_share_setopt` fails, `HTTPAPI_Init` shall release what it created for the shared cache and still succeed; the handles then do not share their caches. ]*/
+    if (i < CURL_LOCK_DATA_LAST)
+    {
+        LogError("unable to Lock_Init, handles will not share DNS and TLS sessions");
+        destroySharedCacheLocks();
+    }
+    else if ((sharedCache = curl_share_init()) == NULL)
+    {
+        LogError("unable to curl_share_init, handles will not share DNS and TLS sessions");
+        destroySharedCacheLocks();
+    }
+    /* Codes_SRS_HTTPAPI_CURL_01_002: [ `HTTPAPI_Init` shall set `CURLSHOPT_LOCKFUNC` and `CURLSHOPT_UNLOCKFUNC` on the share handle and share only `CURL_LOCK_DATA_DNS` and `CURL_LOCK_DATA_SSL_SESSION`. ]*/
+    /*not CURL_LOCK_DATA_CONNECT: a shared connection cache is not safe to use from several threads at once*/
+    else if ((curl_share_setopt(sharedCache, CURLSHOPT_LOCKFUNC, lockSharedCache) != CURLSHE_OK) ||
+        (curl_share_setopt(sharedCache, CURLSHOPT_UNLOCKFUNC, unlockSharedCache) != CURLSHE_OK) ||
+        (curl_share_setopt(sharedCache, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS) != CURLSHE_OK) ||
+        (curl_share_setopt(sharedCache, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION) != CURLSHE_OK))
+    {
+        LogError("unable to curl_share_setopt, handles will not share DNS and TLS sessions");
+        (void)curl_share_cleanup(sharedCache);
+        sharedCache = NULL;
+        destroySharedCacheLocks();
+    }
+}
+
+static void destroySharedCache(void)
+{
+    if (sharedCache != NULL)
+    {
+        /* Codes_SRS_HTTPAPI_CURL_01_008: [ If `curl_share_cleanup` fails because a handle that was not closed still uses the share, `HTTPAPI_Deinit` shall not release the locks. ]*/
+        /*leaking the share beats freeing it under that handle*/
+        if (curl_share_cleanup(sharedCache) != CURLSHE_OK)
+        {
+            LogError("unable to curl_share_cleanup, a HTTP_HANDLE was not closed");
+        }
+        else
+        {
+            destroySharedCacheLocks();
+        }
+        sharedCache = NULL;
+    }
+}
+
+/* Codes_SRS_HTTPAPI_CURL_01_009: [ When the handle opted in with `OPTION_CURL_SHARE`, `HTTPAPI_ExecuteRequest` shall attach the easy handle to the share handle with `CURLOPT_SHARE`. ]*/
+/* Codes_SRS_HTTPAPI_CURL_01_010: [ `HTTPAPI_ExecuteRequest` shall set `CURLOPT_SHARE` to NULL when there is no share handle, when the handle did not opt in with `OPTION_CURL_SHARE`, or when it uses x509 credentials or `TrustedCerts`, since curl cannot tell apart the TLS sessions that use the certificates installed by the TLS context callback. ]*/
+static CURLSH* getSharedCache(HTTP_HANDLE_DATA* httpHandleData)
+{
+    return ((httpHandleData->useSharedCache != 0) &&
+        (httpHandleData->x509certificate == NULL) &&
+        (httpHandleData->x509privatekey == NULL) &&
+        (httpHandleData->certificates == NULL)) ? sharedCache : NULL;
+}
+
 HTTPAPI_RESULT HTTPAPI_Init(void)
 {
     HTTPAPI_RESULT result;
     if (nUsersOfHTTPAPI == 0)
     {
+        /* Codes_SRS_HTTPAPI_CURL_01_004: [ If `curl_global_init` fails, `HTTPAPI_Init` shall fail and return `HTTPAPI_INIT_FAILED`. ]*/
         if (curl_global_init(CURL_GLOBAL_NOTHING) != 0)
         {
             result = HTTPAPI_INIT_FAILED;
@@ -63,12 +173,15 @@ HTTPAPI_RESULT HTTPAPI_Init(void)
         }
         else
         {
+            /* Codes_SRS_HTTPAPI_CURL_01_001: [ On its first call, `HTTPAPI_Init` shall call `curl_global_init` and create the shared cache: one lock per `curl_lock_data` with `Lock_Init`, and a share handle with `curl_share_init`. ]*/
+            createSharedCache();
             nUsersOfHTTPAPI++;
             result = HTTPAPI_OK;
         }
     }
     else
     {
+        /* Codes_SRS_HTTPAPI_CURL_01_005: [ The following calls to `HTTPAPI_Init` shall only count the users and return `HTTPAPI_OK`. ]*/
         nUsersOfHTTPAPI++;
         result = HTTPAPI_OK;
     }
@@ -83,6 +196,8 @@ void HTTPAPI_Deinit(void)
         nUsersOfHTTPAPI--;
         if (nUsersOfHTTPAPI == 0)
         {
+            /* Codes_SRS_HTTPAPI_CURL_01_007: [ When its last user calls `HTTPAPI_Deinit`, it shall release the share handle with `curl_share_cleanup`, release the locks with `Lock_Deinit` and call `curl_global_cleanup`. ]*/
+            destroySharedCache();
             curl_global_cleanup();
         }
     }
@@ -132,6 +247,8 @@ HTTP_HANDLE HTTPAPI_CreateConnection(const char* hostName)
                         httpHandleData->forbidReuse = 0;
                         httpHandleData->freshConnect = 0;
                         httpHandleData->verbose = 0;
+                        httpHandleData->useSharedCache = 0;
+                        httpHandleData->httpVersion = CURL_HTTP_VERSION_1_1;
                         httpHandleData->x509certificate = NULL;
                         httpHandleData->x509privatekey = NULL;
                         httpHandleData->certificates = NULL;
@@ -368,11 +485,18 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE r
                 result = HTTPAPI_SET_OPTION_FAILED;
                 LogError("failed to set CURLOPT_FORBID_REUSE (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
             }
-            else if (curl_easy_setopt(httpHandleData->curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1) != CURLE_OK)
+            /* Codes_SRS_HTTPAPI_CURL_01_018: [ `HTTPAPI_ExecuteRequest` shall set `CURLOPT_HTTP_VERSION` to the version set with `OPTION_CURL_HTTP_VERSION`, or to `CURL_HTTP_VERSION_1_1` when the option was not set. ]*/
+            else if (curl_easy_setopt(httpHandleData->curl, CURLOPT_HTTP_VERSION, httpHandleData->httpVersion) != CURLE_OK)
             {
                 result = HTTPAPI_SET_OPTION_FAILED;
                 LogError("failed to set CURLOPT_HTTP_VERSION (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
             }
+            else if (curl_easy_setopt(httpHandleData->curl, CURLOPT_SHARE, getSharedCache(httpHandleData)) != CURLE_OK)
+            {
+                /* Codes_SRS_HTTPAPI_CURL_01_012: [ If setting `CURLOPT_SHARE` fails, `HTTPAPI_ExecuteRequest` shall fail and return `HTTPAPI_SET_OPTION_FAILED`. ]*/
+                result = HTTPAPI_SET_OPTION_FAILED;
+                LogError("failed to set CURLOPT_SHARE (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+            }
             else
             {
                 result = HTTPAPI_OK;
@@ -652,6 +776,44 @@ HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE r
     return result;
 }
 
+/*CURL_HTTP_VERSION_2TLS negotiates HTTP/2 with ALPN, CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE speaks it without negotiation*/
+static HTTPAPI_RESULT checkHttpVersion(long httpVersion)
+{
+    HTTPAPI_RESULT result;
+    switch (httpVersion)
+    {
+    default:
+        /* Codes_SRS_HTTPAPI_CURL_01_016: [ For any other value of `OPTION_CURL_HTTP_VERSION`, `HTTPAPI_SetOption` shall fail and return `HTTPAPI_INVALID_ARG`. ]*/
+        result = HTTPAPI_INVALID_ARG;
+        LogError("unsupported HTTP version %ld (result = %s)", httpVersion, ENUM_TO_STRING(HTTPAPI_RESULT, result));
+        break;
+
+    case CURL_HTTP_VERSION_NONE:
+    case CURL_HTTP_VERSION_1_0:
+    case CURL_HTTP_VERSION_1_1:
+        result = HTTPAPI_OK;
+        break;
+
+#if LIBCURL_VERSION_NUM >= 0x073100
+    case CURL_HTTP_VERSION_2_0:
+    case CURL_HTTP_VERSION_2TLS:
+    case CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE:
+        if ((curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2) == 0)
+        {
+            /* Codes_SRS_HTTPAPI_CURL_01_017: [ If `OPTION_CURL_HTTP_VERSION` asks for HTTP/2 and `curl_version_info` does not report `CURL_VERSION_HTTP2`, `HTTPAPI_SetOption` shall fail and return `HTTPAPI_ERROR`. ]*/
+            result = HTTPAPI_ERROR;
+            LogError("libcurl was built without HTTP/2 (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+        }
+        else
+        {
+            result = HTTPAPI_OK;
+        }
+        break;
+#endif
+    }
+    return result;
+}
+
 HTTPAPI_RESULT HTTPAPI_SetOption(HTTP_HANDLE handle, const char* optionName, const void* value)
 {
     HTTPAPI_RESULT result;
@@ -698,6 +860,22 @@ HTTPAPI_RESULT HTTPAPI_SetOption(HTTP_HANDLE handle, const char* optionName, con
             httpHandleData->verbose = *(const long*)value;
             result = HTTPAPI_OK;
         }
+        else if (strcmp(OPTION_CURL_SHARE, optionName) == 0)
+        {
+            /* Codes_SRS_HTTPAPI_CURL_01_013: [ `OPTION_CURL_SHARE` shall be read as a `long`: any value other than 0 attaches the handle to the shared cache on its next request, 0 detaches it again. Handles are not attached until they set the option. ]*/
+            httpHandleData->useSharedCache = *(const long*)value;
+            result = HTTPAPI_OK;
+        }
+        else if (strcmp(OPTION_CURL_HTTP_VERSION, optionName) == 0)
+        {
+            /* Codes_SRS_HTTPAPI_CURL_01_015: [ `OPTION_CURL_HTTP_VERSION` shall be read as a `long` and used by the next requests of the handle when it is `CURL_HTTP_VERSION_NONE`, `CURL_HTTP_VERSION_1_0`, `CURL_HTTP_VERSION_1_1`, `CURL_HTTP_VERSION_2_0`, `CURL_HTTP_VERSION_2TLS` or `CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE`. ]*/
+            long httpVersion = *(const long*)value;
+            result = checkHttpVersion(httpVersion);
+            if (result == HTTPAPI_OK)
+            {
+                httpHandleData->httpVersion = httpVersion;
+            }
+        }
         else if (strcmp(SU_OPTION_X509_PRIVATE_KEY, optionName) == 0 || strcmp(OPTION_X509_ECC_KEY, optionName) == 0)
         {
             httpHandleData->x509privatekey = value;
@@ -945,9 +1123,12 @@ HTTPAPI_RESULT HTTPAPI_CloneOption(const char* optionName, const void* value, co
             (strcmp(OPTION_CURL_LOW_SPEED_TIME, optionName) == 0) ||
             (strcmp(OPTION_CURL_FRESH_CONNECT, optionName) == 0) ||
             (strcmp(OPTION_CURL_FORBID_REUSE, optionName) == 0) ||
-            (strcmp(OPTION_CURL_VERBOSE, optionName) == 0)
+            (strcmp(OPTION_CURL_VERBOSE, optionName) == 0) ||
+            (strcmp(OPTION_CURL_SHARE, optionName) == 0) ||
+            (strcmp(OPTION_CURL_HTTP_VERSION, optionName) == 0)
             )
         {
+            /* Codes_SRS_HTTPAPI_CURL_01_014: [ `HTTPAPI_CloneOption` shall clone `OPTION_CURL_SHARE` and `OPTION_CURL_HTTP_VERSION` as a `long`. ]*/
             /*by convention value is pointing to an long */
             long* temp = malloc(sizeof(long)); /*shall be freed by HTTPAPIEX*/
             if (temp == NULL)
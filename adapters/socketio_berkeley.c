@@ -21,6 +21,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 #include "azure_c_shared_utility/socketio.h"
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -987,6 +988,44 @@ static void strtoup(char* str)
 }
 #endif // __APPLE__
 
+static int wait_for_socket(SOCKET_IO_INSTANCE* socket_io_instance, unsigned int timeout_ms)
+{
+    int result;
+
+    if (socket_io_instance->socket == INVALID_SOCKET)
+    {
+        LogError("Cannot wait on a closed socket");
+        result = __FAILURE__;
+    }
+    else
+    {
+        struct pollfd fd = { 0 };
+        int retval;
+
+        fd.fd = socket_io_instance->socket;
+        fd.events = POLLIN;
+        if (singlylinkedlist_get_head_item(socket_io_instance->pending_io_list) != NULL)
+        {
+            // Pending sends also make progress once the socket is writable.
+            fd.events |= POLLOUT;
+        }
+
+        retval = poll(&fd, 1, (timeout_ms > INT_MAX) ? INT_MAX : (int)timeout_ms);
+        if ((retval < 0) && (errno != EINTR))
+        {
+            LogError("Failure: poll failure, errno %d.", errno);
+            result = __FAILURE__;
+        }
+        else
+        {
+            // Readiness, timeout and interruption all send the caller back to dowork.
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
 int socketio_setoption(CONCRETE_IO_HANDLE socket_io, const char* optionName, const void* value)
 {
     int result;
@@ -1020,6 +1059,10 @@ int socketio_setoption(CONCRETE_IO_HANDLE socket_io, const char* optionName, con
             result = setsockopt(socket_io_instance->socket, SOL_TCP, TCP_KEEPINTVL, value, sizeof(int));
             if (result == -1) result = errno;
         }
+        else if (strcmp(optionName, OPTION_IO_WAIT_MS) == 0)
+        {
+            result = wait_for_socket(socket_io_instance, *(const unsigned int*)value);
+        }
         else if (strcmp(optionName, OPTION_NET_INT_MAC_ADDRESS) == 0)
         {
 #ifdef __APPLE__
@@ -1,15 +1,116 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
+#define _DEFAULT_SOURCE
+
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/syscall.h>
 #include <uuid/uuid.h>
 #include "azure_c_shared_utility/uniqueid.h"
+#include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/xlogging.h"
 
 DEFINE_ENUM_STRINGS(UNIQUEID_RESULT, UNIQUEID_RESULT_VALUES);
 
+/* Small requests (one UUID at a time) are served from a per thread pool that is refilled with a
+   single getrandom call, instead of one system call per request. */
+#define RANDOM_POOL_SIZE    512
+
+/* Timestamp and sequence are packed into one 64 bit value (milliseconds since the Unix epoch in
+   the upper bits, a 12 bit sequence in the lower bits) so that they can be advanced together with
+   a single compare and swap. The next value is the larger of "last value + 1" and "current time
+   with sequence 0", which keeps the values strictly increasing across threads even when the clock
+   goes backwards or more than 4096 values are requested within one millisecond. */
+#define TIMESTAMP_SEQUENCE_BITS     12
+#define TIMESTAMP_SEQUENCE_MASK     ((1 << TIMESTAMP_SEQUENCE_BITS) - 1)
+
+static __thread unsigned char random_pool[RANDOM_POOL_SIZE];
+static __thread size_t random_pool_available;
+static pthread_once_t random_pool_fork_handler_once = PTHREAD_ONCE_INIT;
+static uint64_t last_timestamp_sequence;
+
+static void on_fork_child(void)
+{
+    /* Only the forking thread exists in the child. Discard its pool so that parent and child
+       do not hand out the same bytes. */
+    random_pool_available = 0;
+}
+
+static void register_fork_handler(void)
+{
+    if (pthread_atfork(NULL, NULL, on_fork_child) != 0)
+    {
+        LogError("Failed registering fork handler for the random pool");
+    }
+}
+
+static int read_urandom(unsigned char* buffer, size_t size)
+{
+    int result;
+    FILE* urandom = fopen("/dev/urandom", "rb");
+
+    if (urandom == NULL)
+    {
+        LogError("Cannot open /dev/urandom");
+        result = __FAILURE__;
+    }
+    else
+    {
+        if (fread(buffer, 1, size, urandom) != size)
+        {
+            LogError("Cannot read from /dev/urandom");
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+
+        (void)fclose(urandom);
+    }
+
+    return result;
+}
+
+static int fill_random(unsigned char* buffer, size_t size)
+{
+    int result = 0;
+
+#ifdef SYS_getrandom
+    while (size > 0)
+    {
+        long bytes_read = syscall(SYS_getrandom, buffer, size, 0);
+        if (bytes_read < 0)
+        {
+            if (errno != EINTR)
+            {
+                break;
+            }
+        }
+        else
+        {
+            buffer += bytes_read;
+            size -= (size_t)bytes_read;
+        }
+    }
+#endif
+
+    /* Kernels older than 3.17 do not have getrandom */
+    if (size > 0)
+    {
+        result = read_urandom(buffer, size);
+    }
+
+    return result;
+}
+
 UNIQUEID_RESULT UniqueId_Generate(char* uid, size_t len)
 {
     UNIQUEID_RESULT result;
@@ -33,3 +134,98 @@ UNIQUEID_RESULT UniqueId_Generate(char* uid, size_t len)
     }
     return result;
 }
+
+UNIQUEID_RESULT UniqueId_GetRandomBytes(unsigned char* buffer, size_t size)
+{
+    UNIQUEID_RESULT result;
+
+    /* Codes_SRS_UNIQUEID_01_002: [ If buffer is NULL or size is 0 then UniqueId_GetRandomBytes shall return UNIQUEID_INVALID_ARG ] */
+    if (buffer == NULL || size == 0)
+    {
+        result = UNIQUEID_INVALID_ARG;
+        LogError("Invalid argument (buffer = %p, size = %lu)", buffer, (unsigned long)size);
+    }
+    else
+    {
+        (void)pthread_once(&random_pool_fork_handler_once, register_fork_handler);
+
+        /* Codes_SRS_UNIQUEID_01_001: [ UniqueId_GetRandomBytes shall fill buffer with size bytes from a cryptographically secure random source. ] */
+        if (size > RANDOM_POOL_SIZE / 4)
+        {
+            /* Large requests gain nothing from the pool */
+            if (fill_random(buffer, size) != 0)
+            {
+                /* Codes_SRS_UNIQUEID_01_003: [ If there is a failure for any reason UniqueId_GetRandomBytes shall return UNIQUEID_ERROR ] */
+                result = UNIQUEID_ERROR;
+            }
+            else
+            {
+                result = UNIQUEID_OK;
+            }
+        }
+        else if ((random_pool_available < size) &&
+            (fill_random(random_pool, RANDOM_POOL_SIZE) != 0))
+        {
+            /* Codes_SRS_UNIQUEID_01_003: [ If there is a failure for any reason UniqueId_GetRandomBytes shall return UNIQUEID_ERROR ] */
+            random_pool_available = 0;
+            result = UNIQUEID_ERROR;
+        }
+        else
+        {
+            unsigned char* pool_bytes;
+
+            if (random_pool_available < size)
+            {
+                random_pool_available = RANDOM_POOL_SIZE;
+            }
+
+            /* Bytes are taken from the end of the pool and wiped once handed out */
+            pool_bytes = random_pool + random_pool_available - size;
+            (void)memcpy(buffer, pool_bytes, size);
+            (void)memset(pool_bytes, 0, size);
+            random_pool_available -= size;
+            result = UNIQUEID_OK;
+        }
+    }
+
+    return result;
+}
+
+UNIQUEID_RESULT UniqueId_GetTimestampSequence(uint64_t* unix_time_ms, uint16_t* sequence)
+{
+    UNIQUEID_RESULT result;
+    struct timespec now;
+
+    /* Codes_SRS_UNIQUEID_01_006: [ If unix_time_ms or sequence is NULL then UniqueId_GetTimestampSequence shall return UNIQUEID_INVALID_ARG ] */
+    if (unix_time_ms == NULL || sequence == NULL)
+    {
+        result = UNIQUEID_INVALID_ARG;
+        LogError("Invalid argument (unix_time_ms = %p, sequence = %p)", unix_time_ms, sequence);
+    }
+    else if (clock_gettime(CLOCK_REALTIME, &now) != 0)
+    {
+        /* Codes_SRS_UNIQUEID_01_007: [ If the current time cannot be obtained UniqueId_GetTimestampSequence shall return UNIQUEID_ERROR ] */
+        result = UNIQUEID_ERROR;
+        LogError("Cannot get current time");
+    }
+    else
+    {
+        uint64_t current = ((uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000) << TIMESTAMP_SEQUENCE_BITS;
+        uint64_t previous;
+        uint64_t next;
+
+        /* Codes_SRS_UNIQUEID_01_004: [ UniqueId_GetTimestampSequence shall return the current time in milliseconds since the Unix epoch and a 12 bit sequence number. ] */
+        /* Codes_SRS_UNIQUEID_01_005: [ The pairs returned by UniqueId_GetTimestampSequence within a process shall be strictly increasing, also when called concurrently. ] */
+        do
+        {
+            previous = last_timestamp_sequence;
+            next = (current > previous) ? current : previous + 1;
+        } while (__sync_val_compare_and_swap(&last_timestamp_sequence, previous, next) != previous);
+
+        *unix_time_ms = next >> TIMESTAMP_SEQUENCE_BITS;
+        *sequence = (uint16_t)(next & TIMESTAMP_SEQUENCE_MASK);
+        result = UNIQUEID_OK;
+    }
+
+    return result;
+}
@@ -9,6 +9,11 @@
 
 DEFINE_ENUM_STRINGS(UNIQUEID_RESULT, UNIQUEID_RESULT_VALUES);
 
+#define TIMESTAMP_SEQUENCE_BITS     12
+#define TIMESTAMP_SEQUENCE_MASK     ((1 << TIMESTAMP_SEQUENCE_BITS) - 1)
+
+static uint64_t last_timestamp_sequence;
+
 static const char tochar[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
 static void generate128BitUUID(unsigned char* arrayOfByte)
 {
@@ -74,3 +79,55 @@ UNIQUEID_RESULT UniqueId_Generate(char* uid, size_t len)
     }
     return result;
 }
+
+// TODO: The User will need to call srand before calling this function
+UNIQUEID_RESULT UniqueId_GetRandomBytes(unsigned char* buffer, size_t size)
+{
+    UNIQUEID_RESULT result;
+
+    /* Codes_SRS_UNIQUEID_01_002: [ If buffer is NULL or size is 0 then UniqueId_GetRandomBytes shall return UNIQUEID_INVALID_ARG ] */
+    if (buffer == NULL || size == 0)
+    {
+        result = UNIQUEID_INVALID_ARG;
+        LogError("Buffer is NULL or size is 0");
+    }
+    else
+    {
+        size_t i;
+
+        /* Not a secure source: this stub is only meant for platforms without one */
+        for (i = 0; i < size; i++)
+        {
+            buffer[i] = (unsigned char)rand();
+        }
+        result = UNIQUEID_OK;
+    }
+    return result;
+}
+
+// The stub has no atomics and no millisecond clock: the sequence is not safe to use from several
+// threads and the timestamp only advances once per second.
+UNIQUEID_RESULT UniqueId_GetTimestampSequence(uint64_t* unix_time_ms, uint16_t* sequence)
+{
+    UNIQUEID_RESULT result;
+
+    /* Codes_SRS_UNIQUEID_01_006: [ If unix_time_ms or sequence is NULL then UniqueId_GetTimestampSequence shall return UNIQUEID_INVALID_ARG ] */
+    if (unix_time_ms == NULL || sequence == NULL)
+    {
+        result = UNIQUEID_INVALID_ARG;
+        LogError("Invalid argument");
+    }
+    else
+    {
+        time_t now = time(NULL);
+        uint64_t current = (now == (time_t)-1) ? 0 : ((uint64_t)now * 1000) << TIMESTAMP_SEQUENCE_BITS;
+
+        /* Codes_SRS_UNIQUEID_01_004: [ UniqueId_GetTimestampSequence shall return the current time in milliseconds since the Unix epoch and a 12 bit sequence number. ] */
+        last_timestamp_sequence = (current > last_timestamp_sequence) ? current : last_timestamp_sequence + 1;
+
+        *unix_time_ms = last_timestamp_sequence >> TIMESTAMP_SEQUENCE_BITS;
+        *sequence = (uint16_t)(last_timestamp_sequence & TIMESTAMP_SEQUENCE_MASK);
+        result = UNIQUEID_OK;
+    }
+    return result;
+}
@@ -3,12 +3,26 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <limits.h>
 #include "azure_c_shared_utility/uniqueid.h"
 #include "azure_c_shared_utility/xlogging.h"
+#include <windows.h>
 #include <rpc.h>
+#include <bcrypt.h>
 
 DEFINE_ENUM_STRINGS(UNIQUEID_RESULT, UNIQUEID_RESULT_VALUES);
 
+/* Timestamp and sequence are packed into one 64 bit value (milliseconds since the Unix epoch in
+   the upper bits, a 12 bit sequence in the lower bits) so that they can be advanced together with
+   a single compare and swap. The next value is the larger of "last value + 1" and "current time
+   with sequence 0". */
+#define TIMESTAMP_SEQUENCE_BITS     12
+#define TIMESTAMP_SEQUENCE_MASK     ((1 << TIMESTAMP_SEQUENCE_BITS) - 1)
+/* 100ns intervals between 1601-01-01 (FILETIME epoch) and 1970-01-01 */
+#define FILETIME_UNIX_EPOCH_OFFSET  116444736000000000ULL
+
+static volatile LONG64 last_timestamp_sequence;
+
 UNIQUEID_RESULT UniqueId_Generate(char* uid, size_t len)
 {
     UNIQUEID_RESULT result;
@@ -56,3 +70,65 @@ UNIQUEID_RESULT UniqueId_Generate(char* uid, size_t len)
     }
     return result;
 }
+
+UNIQUEID_RESULT UniqueId_GetRandomBytes(unsigned char* buffer, size_t size)
+{
+    UNIQUEID_RESULT result;
+
+    /* Codes_SRS_UNIQUEID_01_002: [ If buffer is NULL or size is 0 then UniqueId_GetRandomBytes shall return UNIQUEID_INVALID_ARG ] */
+    if (buffer == NULL || size == 0 || size > ULONG_MAX)
+    {
+        result = UNIQUEID_INVALID_ARG;
+        LogError("Buffer is NULL or size is invalid");
+    }
+    /* Codes_SRS_UNIQUEID_01_001: [ UniqueId_GetRandomBytes shall fill buffer with size bytes from a cryptographically secure random source. ] */
+    else if (!BCRYPT_SUCCESS(BCryptGenRandom(NULL, buffer, (ULONG)size, BCRYPT_USE_SYSTEM_PREFERRED_RNG)))
+    {
+        /* Codes_SRS_UNIQUEID_01_003: [ If there is a failure for any reason UniqueId_GetRandomBytes shall return UNIQUEID_ERROR ] */
+        LogError("Unable to generate random bytes");
+        result = UNIQUEID_ERROR;
+    }
+    else
+    {
+        result = UNIQUEID_OK;
+    }
+    return result;
+}
+
+UNIQUEID_RESULT UniqueId_GetTimestampSequence(uint64_t* unix_time_ms, uint16_t* sequence)
+{
+    UNIQUEID_RESULT result;
+
+    /* Codes_SRS_UNIQUEID_01_006: [ If unix_time_ms or sequence is NULL then UniqueId_GetTimestampSequence shall return UNIQUEID_INVALID_ARG ] */
+    if (unix_time_ms == NULL || sequence == NULL)
+    {
+        result = UNIQUEID_INVALID_ARG;
+        LogError("Invalid argument");
+    }
+    else
+    {
+        FILETIME now;
+        ULARGE_INTEGER now_100ns;
+        LONG64 current;
+        LONG64 previous;
+        LONG64 next;
+
+        GetSystemTimeAsFileTime(&now);
+        now_100ns.LowPart = now.dwLowDateTime;
+        now_100ns.HighPart = now.dwHighDateTime;
+        current = (LONG64)(((now_100ns.QuadPart - FILETIME_UNIX_EPOCH_OFFSET) / 10000) << TIMESTAMP_SEQUENCE_BITS);
+
+        /* Codes_SRS_UNIQUEID_01_004: [ UniqueId_GetTimestampSequence shall return the current time in milliseconds since the Unix epoch and a 12 bit sequence number. ] */
+        /* Codes_SRS_UNIQUEID_01_005: [ The pairs returned by UniqueId_GetTimestampSequence within a process shall be strictly increasing, also when called concurrently. ] */
+        do
+        {
+            previous = last_timestamp_sequence;
+            next = (current > previous) ? current : previous + 1;
+        } while (InterlockedCompareExchange64(&last_timestamp_sequence, next, previous) != previous);
+
+        *unix_time_ms = (uint64_t)next >> TIMESTAMP_SEQUENCE_BITS;
+        *sequence = (uint16_t)(next & TIMESTAMP_SEQUENCE_MASK);
+        result = UNIQUEID_OK;
+    }
+    return result;
+}
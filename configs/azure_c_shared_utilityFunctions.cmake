@@ -549,6 +549,7 @@ function(set_platform_files c_shared_dir)
                 set(HTTP_C_FILE ${c_shared_dir}/adapters/httpapi_winhttp.c PARENT_SCOPE)
             endif()
         endif()
+        set(HTTP_ASYNC_C_FILE ${c_shared_dir}/src/httpapi_async.c PARENT_SCOPE)
         set(PLATFORM_C_FILE ${c_shared_dir}/adapters/platform_win32.c PARENT_SCOPE)
         if (${use_socketio})
             set(SOCKETIO_C_FILE ${c_shared_dir}/adapters/socketio_win32.c PARENT_SCOPE)
@@ -570,8 +571,10 @@ function(set_platform_files c_shared_dir)
 
         if (${use_builtin_httpapi})
             set(HTTP_C_FILE ${c_shared_dir}/adapters/httpapi_compact.c PARENT_SCOPE)
+            set(HTTP_ASYNC_C_FILE ${c_shared_dir}/src/httpapi_async.c PARENT_SCOPE)
         else()
             set(HTTP_C_FILE ${c_shared_dir}/adapters/httpapi_curl.c PARENT_SCOPE)
+            set(HTTP_ASYNC_C_FILE ${c_shared_dir}/adapters/httpapi_async_curl.c PARENT_SCOPE)
         endif()
         set(LOCK_C_FILE ${c_shared_dir}/adapters/lock_pthreads.c PARENT_SCOPE)
         if (use_applessl)
@@ -53,6 +53,30 @@ MOCKABLE_FUNCTION(, BUFFER_HANDLE, Base32_Decode, STRING_HANDLE, handle);
 */
 MOCKABLE_FUNCTION(, BUFFER_HANDLE, Base32_Decode_String, const char*, source);
 
+/**
+* @brief    Encodes source to base 32 into a caller supplied buffer without allocating
+*
+* @param    source              An unsigned char* to be encoded
+* @param    size                The length in bytes of the source variable
+* @param    destination         Buffer receiving the null terminated base32 string
+* @param    destination_size    Size of destination, at least ((size + 4) / 5) * 8 + 1 bytes
+*
+* @return   0 on success, a non-zero value otherwise
+*/
+MOCKABLE_FUNCTION(, int, Base32_Encode_Bytes_Into, const unsigned char*, source, size_t, size, char*, destination, size_t, destination_size);
+
+/**
+* @brief    Decodes a base32 encoded char* into a caller supplied buffer without allocating
+*
+* @param    source              char* of a base32 encode string
+* @param    destination         Buffer receiving the decoded bytes
+* @param    destination_size    Size of destination, at least (strlen(source) / 8) * 5 bytes
+* @param    decoded_size        Receives the number of decoded bytes
+*
+* @return   0 on success, a non-zero value otherwise
+*/
+MOCKABLE_FUNCTION(, int, Base32_Decode_String_Into, const char*, source, unsigned char*, destination, size_t, destination_size, size_t*, decoded_size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -59,6 +59,18 @@ MOCKABLE_FUNCTION(, STRING_HANDLE, Base64_Encoder, BUFFER_HANDLE, input);
  */
 MOCKABLE_FUNCTION(, STRING_HANDLE, Base64_Encode_Bytes, const unsigned char*, source, size_t, size);
 
+/**
+ * @brief	Base64 encodes the buffer pointed to by @p source into a caller supplied buffer without allocating.
+ *
+ * @param	source          	The buffer that needs to be base64 encoded.
+ * @param	size            	The size.
+ * @param	destination     	Buffer receiving the null terminated base64 string.
+ * @param	destination_size	Size of @p destination, at least ((size + 2) / 3) * 4 + 1 bytes.
+ *
+ * @return	0 on success, a non-zero value otherwise.
+ */
+MOCKABLE_FUNCTION(, int, Base64_Encode_Bytes_Into, const unsigned char*, source, size_t, size, char*, destination, size_t, destination_size);
+
 /**
  * @brief	Base64 decodes the buffer pointed to by @p source and returns the resulting buffer.
  *
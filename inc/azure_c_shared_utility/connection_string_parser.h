@@ -9,12 +9,37 @@
 #include "azure_c_shared_utility/strings.h"
 
 #ifdef __cplusplus
+#include <cstddef>
 extern "C" 
 {
+#else
+#include <stddef.h>
 #endif
 
+    /* A value inside the scanned connection string; it is not null terminated. */
+    typedef struct CONNECTION_STRING_FIELD_TAG
+    {
+        const char* value;
+        size_t length;
+    } CONNECTION_STRING_FIELD;
+
+    /* The well-known keys; fields whose key is absent are left with a NULL value and a length of 0. */
+    typedef struct CONNECTION_STRING_FIELDS_TAG
+    {
+        CONNECTION_STRING_FIELD hostName;
+        CONNECTION_STRING_FIELD deviceId;
+        CONNECTION_STRING_FIELD sharedAccessKey;
+        CONNECTION_STRING_FIELD sharedAccessKeyName;
+        CONNECTION_STRING_FIELD sharedAccessSignature;
+    } CONNECTION_STRING_FIELDS;
+
+    /* Return 0 to continue scanning, anything else to stop and fail the scan. */
+    typedef int(*CONNECTION_STRING_PAIR_CALLBACK)(void* context, const char* key, size_t key_length, const char* value, size_t value_length);
+
     MOCKABLE_FUNCTION(, MAP_HANDLE, connectionstringparser_parse_from_char, const char*, connection_string);
     MOCKABLE_FUNCTION(, MAP_HANDLE, connectionstringparser_parse, STRING_HANDLE, connection_string);
+    MOCKABLE_FUNCTION(, int, connectionstringparser_scan, const char*, connection_string, CONNECTION_STRING_PAIR_CALLBACK, on_pair, void*, context);
+    MOCKABLE_FUNCTION(, int, connectionstringparser_parse_fields, const char*, connection_string, CONNECTION_STRING_FIELDS*, fields);
     MOCKABLE_FUNCTION(, int, connectionstringparser_splitHostName_from_char, const char*, hostName, STRING_HANDLE, nameString, STRING_HANDLE, suffixString);
     MOCKABLE_FUNCTION(, int, connectionstringparser_splitHostName, STRING_HANDLE, hostNameString, STRING_HANDLE, nameString, STRING_HANDLE, suffixString);
 
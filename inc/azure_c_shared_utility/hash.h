@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef HASH_H
+#define HASH_H
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/constbuffer.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+typedef struct HASH_INSTANCE_TAG* HASH_HANDLE;
+
+#define HASH_ALGORITHM_VALUES \
+    HASH_ALGORITHM_SHA1,      \
+    HASH_ALGORITHM_SHA224,    \
+    HASH_ALGORITHM_SHA256,    \
+    HASH_ALGORITHM_SHA384,    \
+    HASH_ALGORITHM_SHA512
+
+DEFINE_ENUM(HASH_ALGORITHM, HASH_ALGORITHM_VALUES)
+
+/* @brief               Creates a streaming hash (USHA) for the given algorithm.
+*  @returns             A handle to be fed with the HASH_Update functions, NULL on failure.
+*/
+MOCKABLE_FUNCTION(, HASH_HANDLE, HASH_Create, HASH_ALGORITHM, algorithm);
+
+/* @brief               Creates a streaming HMAC keyed with key/keyLen for the given algorithm.
+*  @returns             A handle to be fed with the HASH_Update functions, NULL on failure.
+*/
+MOCKABLE_FUNCTION(, HASH_HANDLE, HASH_CreateHmac, HASH_ALGORITHM, algorithm, const unsigned char*, key, size_t, keyLen);
+
+/* @brief               Copies the state of a hash, so that the data hashed so far does not need to be hashed again
+*                       to compute the digest of several messages sharing a prefix.
+*/
+MOCKABLE_FUNCTION(, HASH_HANDLE, HASH_Clone, HASH_HANDLE, handle);
+
+MOCKABLE_FUNCTION(, void, HASH_Destroy, HASH_HANDLE, handle);
+
+/* @brief               Adds the next segment of the message. Segments can be of any size, including 0.
+*  @returns             Zero on success, non-zero otherwise.
+*/
+MOCKABLE_FUNCTION(, int, HASH_Update, HASH_HANDLE, handle, const unsigned char*, data, size_t, size);
+MOCKABLE_FUNCTION(, int, HASH_UpdateWithBuffer, HASH_HANDLE, handle, BUFFER_HANDLE, buffer);
+MOCKABLE_FUNCTION(, int, HASH_UpdateWithConstBuffer, HASH_HANDLE, handle, CONSTBUFFER_HANDLE, constBuffer);
+
+/* @brief               Completes the hash and places the digest in digest (replacing its content). The handle cannot
+*                       be updated afterwards, clone it first to keep hashing.
+*  @returns             Zero on success, non-zero otherwise.
+*/
+MOCKABLE_FUNCTION(, int, HASH_Final, HASH_HANDLE, handle, BUFFER_HANDLE, digest);
+
+/* @returns             The size in bytes of the digest HASH_Final produces, 0 if handle is NULL. */
+MOCKABLE_FUNCTION(, size_t, HASH_GetDigestSize, HASH_HANDLE, handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HASH_H */
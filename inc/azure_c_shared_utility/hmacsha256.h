@@ -19,8 +19,28 @@ extern "C" {
 
 DEFINE_ENUM(HMACSHA256_RESULT, HMACSHA256_RESULT_VALUES)
 
+typedef struct HMACSHA256_KEY_TAG* HMACSHA256_KEY_HANDLE;
+
+typedef struct HMACSHA256_PAYLOAD_TAG
+{
+    const unsigned char* payload;
+    size_t payloadLen;
+} HMACSHA256_PAYLOAD;
+
 MOCKABLE_FUNCTION(, HMACSHA256_RESULT, HMACSHA256_ComputeHash, const unsigned char*, key, size_t, keyLen, const unsigned char*, payload, size_t, payloadLen, BUFFER_HANDLE, hash);
 
+/* A key handle holds the SHA-256 states left after hashing the inner and outer key pads, so that signing many payloads
+   with the same key costs only the payload blocks plus one outer block per signature. */
+MOCKABLE_FUNCTION(, HMACSHA256_KEY_HANDLE, HMACSHA256_CreateKey, const unsigned char*, key, size_t, keyLen);
+MOCKABLE_FUNCTION(, void, HMACSHA256_DestroyKey, HMACSHA256_KEY_HANDLE, keyHandle);
+MOCKABLE_FUNCTION(, HMACSHA256_RESULT, HMACSHA256_ComputeHashWithKey, HMACSHA256_KEY_HANDLE, keyHandle, const unsigned char*, payload, size_t, payloadLen, BUFFER_HANDLE, hash);
+
+/* Signs payloadCount payloads with the same key and appends their 32 byte hashes, in order, to hashes. Batches of at
+   least SHA256_LANES (see sha.h) payloads are hashed several at a time, interleaving the SHA-256 rounds of independent payloads;
+   smaller batches fall back to signing one payload after the other as HMACSHA256_ComputeHashWithKey does. The hashes
+   are the same either way. */
+MOCKABLE_FUNCTION(, HMACSHA256_RESULT, HMACSHA256_ComputeHashBatch, HMACSHA256_KEY_HANDLE, keyHandle, const HMACSHA256_PAYLOAD*, payloads, size_t, payloadCount, BUFFER_HANDLE, hashes);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef HTTP_RESPONSE_PARSER_H
+#define HTTP_RESPONSE_PARSER_H
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#include <stdbool.h>
+#endif
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+typedef struct HTTP_RESPONSE_PARSER_INSTANCE_TAG* HTTP_RESPONSE_PARSER_HANDLE;
+
+#define HTTP_RESPONSE_PARSER_RESULT_VALUES \
+    HTTP_RESPONSE_PARSER_NEED_MORE_DATA, \
+    HTTP_RESPONSE_PARSER_COMPLETE, \
+    HTTP_RESPONSE_PARSER_ERROR
+
+DEFINE_ENUM(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_RESULT_VALUES);
+
+/* Lines (status line, headers, chunk sizes and trailers) longer than this fail the response. */
+#define HTTP_RESPONSE_PARSER_MAX_LINE_LENGTH 8192
+
+/* All the callbacks return 0 to continue parsing and non-zero to fail the response.
+   The views passed to them are only valid for the duration of the call and are not NUL terminated. */
+typedef int(*ON_HTTP_RESPONSE_STATUS)(void* context, int status_code, const char* reason_phrase, size_t reason_phrase_length);
+typedef int(*ON_HTTP_RESPONSE_HEADER)(void* context, const char* name, size_t name_length, const char* value, size_t value_length);
+/* has_body is preset from the framing headers and may be cleared for responses that carry no body (HEAD, CONNECT). */
+typedef int(*ON_HTTP_RESPONSE_HEADERS_COMPLETE)(void* context, size_t content_length, bool chunked, bool* has_body);
+typedef int(*ON_HTTP_RESPONSE_BODY)(void* context, const unsigned char* buffer, size_t size);
+typedef int(*ON_HTTP_RESPONSE_CHUNK_COMPLETE)(void* context);
+
+typedef struct HTTP_RESPONSE_PARSER_CALLBACKS_TAG
+{
+    ON_HTTP_RESPONSE_STATUS on_status;
+    ON_HTTP_RESPONSE_HEADER on_header;
+    ON_HTTP_RESPONSE_HEADERS_COMPLETE on_headers_complete;
+    ON_HTTP_RESPONSE_BODY on_body;
+    ON_HTTP_RESPONSE_CHUNK_COMPLETE on_chunk_complete;
+} HTTP_RESPONSE_PARSER_CALLBACKS;
+
+MOCKABLE_FUNCTION(, HTTP_RESPONSE_PARSER_HANDLE, http_response_parser_create, const HTTP_RESPONSE_PARSER_CALLBACKS*, callbacks, void*, callback_context);
+MOCKABLE_FUNCTION(, void, http_response_parser_destroy, HTTP_RESPONSE_PARSER_HANDLE, http_response_parser);
+MOCKABLE_FUNCTION(, int, http_response_parser_reset, HTTP_RESPONSE_PARSER_HANDLE, http_response_parser);
+MOCKABLE_FUNCTION(, HTTP_RESPONSE_PARSER_RESULT, http_response_parser_feed, HTTP_RESPONSE_PARSER_HANDLE, http_response_parser, const unsigned char*, buffer, size_t, size, size_t*, bytes_consumed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HTTP_RESPONSE_PARSER_H */
@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file httpapi_async.h
+*	@brief		Non blocking HTTPS requests to one host, driven by httpapi_async_dowork.
+*
+*	@details	httpapi_async queues requests and runs them over up to max_connections
+*				keep-alive TLS connections (xio), without blocking the caller. All the
+*				IO happens in httpapi_async_dowork, so one thread can keep any number
+*				of requests in flight. Completion callbacks are only called from
+*				httpapi_async_dowork and httpapi_async_destroy.
+*				The module is not thread safe.
+*/
+
+#ifndef HTTPAPI_ASYNC_H
+#define HTTPAPI_ASYNC_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "azure_c_shared_utility/httpapi.h"
+#include "azure_c_shared_utility/httpheaders.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+typedef struct HTTPAPI_ASYNC_INSTANCE_TAG* HTTPAPI_ASYNC_HANDLE;
+
+#define HTTPAPI_ASYNC_RESULT_VALUES \
+    HTTPAPI_ASYNC_OK, \
+    HTTPAPI_ASYNC_ERROR, \
+    HTTPAPI_ASYNC_TIMEOUT, \
+    HTTPAPI_ASYNC_CANCELLED
+
+DEFINE_ENUM(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_RESULT_VALUES);
+
+/* response_headers and response_content are only valid for the duration of the callback, and are NULL unless result is HTTPAPI_ASYNC_OK.
+   The callback can queue new requests, but shall not destroy the httpapi_async instance. */
+typedef void(*ON_HTTPAPI_ASYNC_REQUEST_COMPLETE)(void* context, HTTPAPI_ASYNC_RESULT result, unsigned int status_code, HTTP_HEADERS_HANDLE response_headers, BUFFER_HANDLE response_content);
+
+MOCKABLE_FUNCTION(, HTTPAPI_ASYNC_HANDLE, httpapi_async_create, const char*, host_name, size_t, max_connections);
+MOCKABLE_FUNCTION(, void, httpapi_async_destroy, HTTPAPI_ASYNC_HANDLE, httpapi_async);
+MOCKABLE_FUNCTION(, int, httpapi_async_set_option, HTTPAPI_ASYNC_HANDLE, httpapi_async, const char*, option_name, const void*, value);
+MOCKABLE_FUNCTION(, int, httpapi_async_execute_request, HTTPAPI_ASYNC_HANDLE, httpapi_async, HTTPAPI_REQUEST_TYPE, request_type, const char*, relative_path, HTTP_HEADERS_HANDLE, request_headers, const unsigned char*, content, size_t, content_length, ON_HTTPAPI_ASYNC_REQUEST_COMPLETE, on_request_complete, void*, callback_context);
+MOCKABLE_FUNCTION(, void, httpapi_async_dowork, HTTPAPI_ASYNC_HANDLE, httpapi_async);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HTTPAPI_ASYNC_H */
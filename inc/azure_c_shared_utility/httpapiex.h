@@ -11,6 +11,8 @@
 *					- Implementation independent
 *					- Retry mechanism
 *					- Persistent options
+*					- Optional connection pooling across handles
+*					- Non blocking requests driven by ::HTTPAPIEX_DoWork
 */
 
 #ifndef HTTPAPIEX_H
@@ -18,6 +20,7 @@
 
 #include "azure_c_shared_utility/macro_utils.h"
 #include "azure_c_shared_utility/httpapi.h"
+#include "azure_c_shared_utility/httpapiex_pool.h"
 #include "azure_c_shared_utility/umock_c_prod.h"
  
 #ifdef __cplusplus
@@ -56,6 +59,26 @@ DEFINE_ENUM(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT_VALUES);
  */
 MOCKABLE_FUNCTION(, HTTPAPIEX_HANDLE, HTTPAPIEX_Create, const char*, hostName);
 
+/**
+ * @brief	Creates an @c HTTPAPIEX_HANDLE that shares connections with the other handles
+ *			created on the same @p pool.
+ *
+ * @param	hostName	Pointer to a null-terminated string that contains the host name
+ * 						of an HTTP server.
+ * @param	pool		The pool connections are taken from and given back to, it has to
+ *						outlive the handle. If @c NULL, the handle behaves as if created
+ *						with ::HTTPAPIEX_Create.
+ *
+ *			After every successful request the connection goes back to @p pool, and the
+ *			next request of any handle for the same host takes it from there. Only handles
+ *			whose options are limited to trusted certificates and x509 identities share
+ *			connections, and only with handles that set the same values; handles with other
+ *			options (proxy, timeouts, curl options, ...) keep a private connection.
+ *
+ * @return	An @c HTTAPIEX_HANDLE suitable for further calls to the module.
+ */
+MOCKABLE_FUNCTION(, HTTPAPIEX_HANDLE, HTTPAPIEX_CreateWithPool, const char*, hostName, HTTPAPIEX_POOL_HANDLE, pool);
+
 /**
  * @brief	Tries to execute an HTTP request.
  *
@@ -81,6 +104,51 @@ MOCKABLE_FUNCTION(, HTTPAPIEX_HANDLE, HTTPAPIEX_Create, const char*, hostName);
  */
 MOCKABLE_FUNCTION(, HTTPAPIEX_RESULT, HTTPAPIEX_ExecuteRequest, HTTPAPIEX_HANDLE, handle, HTTPAPI_REQUEST_TYPE, requestType, const char*, relativePath, HTTP_HEADERS_HANDLE, requestHttpHeadersHandle, BUFFER_HANDLE, requestContent, unsigned int*, statusCode, HTTP_HEADERS_HANDLE, responseHttpHeadersHandle, BUFFER_HANDLE, responseContent);
 
+/**
+ * @brief	Called when a request queued by ::HTTPAPIEX_ExecuteRequestAsync completes.
+ *
+ *			@p responseHttpHeadersHandle and @p responseContent are only valid for the
+ *			duration of the call, and are @c NULL unless @p result is @c HTTPAPIEX_OK.
+ *			The callback can queue new requests on the same handle but shall not
+ *			destroy it.
+ */
+typedef void(*ON_HTTPAPIEX_REQUEST_COMPLETE)(void* context, HTTPAPIEX_RESULT result, unsigned int statusCode, HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent);
+
+/**
+ * @brief	Queues an HTTP request without blocking.
+ *
+ * @param	handle					 	A valid @c HTTPAPIEX_HANDLE value.
+ * @param	requestType				 	A value from the ::HTTPAPI_REQUEST_TYPE enum.
+ * @param	relativePath			 	Relative path to send the request to on the server.
+ * @param	requestHttpHeadersHandle 	Handle to the request HTTP headers.
+ * @param	requestContent			 	The request content.
+ * @param	onRequestComplete			Called from ::HTTPAPIEX_DoWork (or ::HTTPAPIEX_Destroy)
+ *										when the request completes.
+ * @param	callbackContext				Passed to @p onRequestComplete.
+ *
+ *			The headers and content are copied before the call returns. The requests
+ *			are sent over keep-alive TLS connections (xio) owned by the handle, several
+ *			at a time, and all the IO happens in ::HTTPAPIEX_DoWork, so one thread can keep
+ *			many requests in flight. A request whose connection fails is sent again once.
+ *			Of the saved options only the trusted certificates, the x509 identities and
+ *			"timeout" apply to these requests, and they do not use the connection pool.
+ *			Requests still in flight when the handle is destroyed complete with
+ *			@c HTTPAPIEX_ERROR; the ones that could not be recovered complete with
+ *			@c HTTPAPIEX_RECOVERYFAILED.
+ *
+ * @return	@c HTTPAPIEX_OK when the request was queued, an error code otherwise, in which
+ *			case @p onRequestComplete is not called.
+ */
+MOCKABLE_FUNCTION(, HTTPAPIEX_RESULT, HTTPAPIEX_ExecuteRequestAsync, HTTPAPIEX_HANDLE, handle, HTTPAPI_REQUEST_TYPE, requestType, const char*, relativePath, HTTP_HEADERS_HANDLE, requestHttpHeadersHandle, BUFFER_HANDLE, requestContent, ON_HTTPAPIEX_REQUEST_COMPLETE, onRequestComplete, void*, callbackContext);
+
+/**
+ * @brief	Sends, receives and completes the requests queued by ::HTTPAPIEX_ExecuteRequestAsync.
+ *			It does not block, and has to be called regularly while requests are in flight.
+ *
+ * @param	handle	The @c HTTPAPIEX_HANDLE the requests were queued on.
+ */
+MOCKABLE_FUNCTION(, void, HTTPAPIEX_DoWork, HTTPAPIEX_HANDLE, handle);
+
 /**
  * @brief	Frees all resources used by the @c HTTPAPIEX_HANDLE object.
  *
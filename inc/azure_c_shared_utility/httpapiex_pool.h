@@ -0,0 +1,82 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file httpapiex_pool.h
+*	@brief		A pool of idle HTTPAPI connections that HTTPAPIEX handles can share.
+*
+*	@details	HTTPAPIEX handles created with ::HTTPAPIEX_CreateWithPool check their
+*				connection in to the pool after every successful request and check one
+*				out before the next, so that handles (and threads) talking to the same
+*				host with the same TLS configuration reuse warm connections instead of
+*				each paying for a TCP and TLS handshake. Connections that stayed idle
+*				longer than the idle timeout are closed instead of being handed out.
+*				The pool is thread safe and has to outlive all the handles using it.
+*/
+
+#ifndef HTTPAPIEX_POOL_H
+#define HTTPAPIEX_POOL_H
+
+#include "azure_c_shared_utility/httpapi.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+typedef struct HTTPAPIEX_POOL_INSTANCE_TAG* HTTPAPIEX_POOL_HANDLE;
+
+#define HTTPAPIEX_POOL_DEFAULT_MAX_CONNECTIONS_PER_HOST 4
+#define HTTPAPIEX_POOL_DEFAULT_IDLE_TIMEOUT_MS 30000
+
+/**
+ * @brief	Creates a connection pool. The pool holds its own reference on HTTPAPI
+ *			(HTTPAPI_Init) until it is destroyed.
+ *
+ * @param	maxConnectionsPerHost	How many idle connections are kept for one host and
+ *									TLS configuration; connections checked in beyond
+ *									that are closed.
+ * @param	idleTimeoutInMs			Idle connections older than this are closed instead
+ *									of being checked out. Servers drop idle keep-alive
+ *									connections on their own, so this should stay below
+ *									the server's keep-alive timeout.
+ *
+ * @return	A handle to the pool or @c NULL on failure.
+ */
+MOCKABLE_FUNCTION(, HTTPAPIEX_POOL_HANDLE, HTTPAPIEX_POOL_Create, size_t, maxConnectionsPerHost, unsigned int, idleTimeoutInMs);
+
+/**
+ * @brief	Closes all the idle connections and frees the pool. Connections checked out
+ *			at that time are not tracked by the pool and stay with their owners.
+ */
+MOCKABLE_FUNCTION(, void, HTTPAPIEX_POOL_Destroy, HTTPAPIEX_POOL_HANDLE, pool);
+
+/**
+ * @brief	Takes the most recently checked in idle connection for @p key out of the pool.
+ *
+ * @return	The connection, or @c NULL when the pool has no usable connection for @p key.
+ */
+MOCKABLE_FUNCTION(, HTTP_HANDLE, HTTPAPIEX_POOL_Checkout, HTTPAPIEX_POOL_HANDLE, pool, const char*, key);
+
+/**
+ * @brief	Hands a connection that completed its last request successfully back to the pool.
+ *			The pool owns @p httpHandle afterwards in all cases, and closes it when it cannot
+ *			be kept.
+ *
+ * @return	0 when the connection was kept, non-zero when it was closed.
+ */
+MOCKABLE_FUNCTION(, int, HTTPAPIEX_POOL_Checkin, HTTPAPIEX_POOL_HANDLE, pool, const char*, key, HTTP_HANDLE, httpHandle);
+
+/**
+ * @brief	Closes the idle connections that outlived the idle timeout. Checkout and checkin
+ *			do this too; call it when the pool can stay untouched for long periods.
+ */
+MOCKABLE_FUNCTION(, void, HTTPAPIEX_POOL_DoWork, HTTPAPIEX_POOL_HANDLE, pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HTTPAPIEX_POOL_H */
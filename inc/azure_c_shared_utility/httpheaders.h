@@ -138,6 +138,24 @@ MOCKABLE_FUNCTION(, HTTP_HEADERS_RESULT, HTTPHeaders_GetHeaderCount, HTTP_HEADER
  */
 MOCKABLE_FUNCTION(, HTTP_HEADERS_RESULT, HTTPHeaders_GetHeader, HTTP_HEADERS_HANDLE, handle, size_t, index, char**, destination);
 
+/**
+ * @brief	This API retrieves the name and the value of the header element at
+ * 			the given @p index without allocating memory.
+ *
+ * @param	handle			A valid @c HTTP_HEADERS_HANDLE value.
+ * @param	index			Zero-based index of the item in the
+ * 							headers collection.
+ * @param   name			Receives a pointer to the stored name.
+ * @param   value			Receives a pointer to the stored value.
+ *
+ *			The returned strings belong to the headers collection and are
+ *			only valid until it is modified or freed.
+ *
+ * @return	Returns @c HTTP_HEADERS_OK when execution is successful or
+ * 			@c HTTP_HEADERS_ERROR when an error occurs.
+ */
+MOCKABLE_FUNCTION(, HTTP_HEADERS_RESULT, HTTPHeaders_GetHeaderNameValue, HTTP_HEADERS_HANDLE, handle, size_t, index, const char**, name, const char**, value);
+
 /**
  * @brief	This API produces a clone of the @p handle parameter.
  *
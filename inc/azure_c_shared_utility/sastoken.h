@@ -16,6 +16,10 @@ extern "C" {
     MOCKABLE_FUNCTION(, STRING_HANDLE, SASToken_Create, STRING_HANDLE, key, STRING_HANDLE, scope, STRING_HANDLE, keyName, size_t, expiry);
     MOCKABLE_FUNCTION(, STRING_HANDLE, SASToken_CreateString, const char*, key, const char*, scope, const char*, keyName, size_t, expiry);
 
+    /* Writes the token SASToken_CreateString would return into destination (null terminated) and its length into tokenLength.
+       Fails when destinationSize cannot hold the token and its null terminator. */
+    MOCKABLE_FUNCTION(, int, SASToken_CreateString_Into, const char*, key, const char*, scope, const char*, keyName, size_t, expiry, char*, destination, size_t, destinationSize, size_t*, tokenLength);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,36 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef SASTOKEN_CACHE_H
+#define SASTOKEN_CACHE_H
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+typedef struct SASTOKEN_CACHE_TAG* SASTOKEN_CACHE_HANDLE;
+
+typedef struct SASTOKEN_CACHE_STATISTICS_TAG
+{
+    size_t hits;
+    size_t misses;
+    size_t renewals;
+    size_t evictions;
+} SASTOKEN_CACHE_STATISTICS;
+
+MOCKABLE_FUNCTION(, SASTOKEN_CACHE_HANDLE, SASTokenCache_Create, size_t, tokenLifetime, unsigned int, renewalPercentage);
+MOCKABLE_FUNCTION(, void, SASTokenCache_Destroy, SASTOKEN_CACHE_HANDLE, handle);
+MOCKABLE_FUNCTION(, const char*, SASTokenCache_GetToken, SASTOKEN_CACHE_HANDLE, handle, const char*, key, const char*, scope, const char*, keyName);
+MOCKABLE_FUNCTION(, int, SASTokenCache_DoWork, SASTOKEN_CACHE_HANDLE, handle);
+MOCKABLE_FUNCTION(, int, SASTokenCache_GetStatistics, SASTOKEN_CACHE_HANDLE, handle, SASTOKEN_CACHE_STATISTICS*, statistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SASTOKEN_CACHE_H */
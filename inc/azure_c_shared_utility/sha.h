@@ -77,6 +77,12 @@ enum {
     SHA512HashSizeBits = 512, USHAMaxHashSizeBits = SHA512HashSizeBits
 };
 
+/*
+ *  Number of independent SHA-256 states advanced together by
+ *  SHA256CompressLanes
+ */
+#define SHA256_LANES 4
+
 /*
  *  These constants are used in the USHA (unified sha) functions.
  */
@@ -210,6 +216,9 @@ extern int SHA256FinalBits(SHA256Context *, const uint8_t bits,
                            unsigned int bitcount);
 extern int SHA256Result(SHA256Context *,
                         uint8_t Message_Digest[SHA256HashSize]);
+/* compresses one block into each of SHA256_LANES independent states */
+extern void SHA256CompressLanes(uint32_t Intermediate_Hash[8][SHA256_LANES],
+                                const uint8_t *blocks[SHA256_LANES]);
 
 /* SHA-384 */
 extern int SHA384Reset(SHA384Context *);
@@ -38,11 +38,17 @@ extern "C"
     static STATIC_VAR_UNUSED const char* const OPTION_CURL_FRESH_CONNECT = "CURLOPT_FRESH_CONNECT";
     static STATIC_VAR_UNUSED const char* const OPTION_CURL_FORBID_REUSE = "CURLOPT_FORBID_REUSE";
     static STATIC_VAR_UNUSED const char* const OPTION_CURL_VERBOSE = "CURLOPT_VERBOSE";
+    static STATIC_VAR_UNUSED const char* const OPTION_CURL_SHARE = "CURLOPT_SHARE";
+    static STATIC_VAR_UNUSED const char* const OPTION_CURL_HTTP_VERSION = "CURLOPT_HTTP_VERSION";
 
     static STATIC_VAR_UNUSED const char* const OPTION_NET_INT_MAC_ADDRESS = "net_interface_mac_address";
 
     static STATIC_VAR_UNUSED const char* const OPTION_TLS_VERSION = "tls_version";
 
+    /* Blocks for up to *(const unsigned int*)value milliseconds until the socket under the IO can make progress.
+       IOs that cannot wait on the socket fail the option, and the caller has to poll instead. */
+    static STATIC_VAR_UNUSED const char* const OPTION_IO_WAIT_MS = "io_wait_ms";
+
     typedef enum TLSIO_VERSION_TAG
     {
         OPTION_TLS_VERSION_1_0 = 10,
@@ -78,6 +78,22 @@ MOCKABLE_FUNCTION(, const char*, StringToken_GetDelimiter, STRING_TOKEN_HANDLE,
 */
 MOCKABLE_FUNCTION(, int, StringToken_Split, const char*, source, size_t, length, const char**, delimiters, size_t, n_delims, bool, include_empty, char***, tokens, size_t*, token_count);
 
+/*
+*    @brief     Splits a string into an array with all the tokens identified using the delimiters provided, using a single allocation.
+*    @Remark    The tokens are the same as the ones produced by StringToken_Split, but the pointer array and the null-terminated
+*               token strings are packed in one memory block, which the caller releases with a single call to free(*tokens).
+*               The delimiters are matched through a table of their first characters, so the source is scanned only once per pass.
+*    @param     source           The string to be tokenized.
+*    @param     length           The length of the source string, not including the null-terminator.
+*    @param     delimiters       Array with null-terminated strings to be used as token delimiters.
+*    @param     n_delims         Number of elements in delimiters array.
+*    @param     include_empty    Indicates if empty strings shall be included (as NULL values) in the resulting array.
+*    @param     tokens           If no failures occur, the resulting array with the split tokens (NULL if there are no tokens).
+*    @param     token_count      The number of elements in the tokens array.
+*    @return    Zero if no failures occur, or a non-zero value otherwise.
+*/
+MOCKABLE_FUNCTION(, int, StringToken_SplitPacked, const char*, source, size_t, length, const char**, delimiters, size_t, n_delims, bool, include_empty, char***, tokens, size_t*, token_count);
+
 /*
 *    @brief     Destroys the handle created when calling StringToken_GetFirst.
 *    @param     token         The handle returned by StringToken_GetFirst.
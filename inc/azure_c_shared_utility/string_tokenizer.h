@@ -9,14 +9,18 @@
 #include "azure_c_shared_utility/string_tokenizer_types.h"
 
 #ifdef __cplusplus
+#include <cstddef>
 extern "C"
 {
 #else
+#include <stddef.h>
 #endif
 
 MOCKABLE_FUNCTION(, STRING_TOKENIZER_HANDLE, STRING_TOKENIZER_create, STRING_HANDLE, handle);
 MOCKABLE_FUNCTION(, STRING_TOKENIZER_HANDLE, STRING_TOKENIZER_create_from_char, const char*, input);
 MOCKABLE_FUNCTION(, int, STRING_TOKENIZER_get_next_token, STRING_TOKENIZER_HANDLE, t, STRING_HANDLE, output, const char*, delimiters);
+MOCKABLE_FUNCTION(, int, STRING_TOKENIZER_compile_delimiters, const char*, delimiters, STRING_TOKENIZER_DELIMITERS*, compiled);
+MOCKABLE_FUNCTION(, int, STRING_TOKENIZER_get_next_token_view, STRING_TOKENIZER_HANDLE, t, const STRING_TOKENIZER_DELIMITERS*, delimiters, const char**, token, size_t*, token_length);
 MOCKABLE_FUNCTION(, void, STRING_TOKENIZER_destroy, STRING_TOKENIZER_HANDLE, t);
 
 #ifdef __cplusplus
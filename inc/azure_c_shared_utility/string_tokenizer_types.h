@@ -4,6 +4,20 @@
 #ifndef STRING_TOKENIZER_TYPES_H
 #define STRING_TOKENIZER_TYPES_H
 
+#ifdef __cplusplus
+#include <cstddef>
+#else
+#include <stddef.h>
+#endif
+
 typedef struct STRING_TOKEN_TAG* STRING_TOKENIZER_HANDLE;
 
+/* A delimiter set compiled once by STRING_TOKENIZER_compile_delimiters and reusable across calls and tokenizers. */
+typedef struct STRING_TOKENIZER_DELIMITERS_TAG
+{
+    unsigned char set[32];
+    size_t count;
+    char first;
+} STRING_TOKENIZER_DELIMITERS;
+
 #endif  /*STRING_TOKENIZER_TYPES_H*/
@@ -26,6 +26,7 @@ MOCKABLE_FUNCTION(, STRING_HANDLE, STRING_from_byte_array, const unsigned char*,
 MOCKABLE_FUNCTION(, void, STRING_delete, STRING_HANDLE, handle);
 MOCKABLE_FUNCTION(, int, STRING_concat, STRING_HANDLE, handle, const char*, s2);
 MOCKABLE_FUNCTION(, int, STRING_concat_with_STRING, STRING_HANDLE, s1, STRING_HANDLE, s2);
+MOCKABLE_FUNCTION(, int, STRING_concat_JSON, STRING_HANDLE, handle, const char*, source);
 MOCKABLE_FUNCTION(, int, STRING_quote, STRING_HANDLE, handle);
 MOCKABLE_FUNCTION(, int, STRING_copy, STRING_HANDLE, s1, const char*, s2);
 MOCKABLE_FUNCTION(, int, STRING_copy_n, STRING_HANDLE, s1, const char*, s2, size_t, n);
@@ -8,9 +8,11 @@
 
 #ifdef __cplusplus
 #include <cstddef>
+#include <cstdint>
 extern "C" {
 #else
 #include <stddef.h>
+#include <stdint.h>
 #endif
 
 #include "azure_c_shared_utility/umock_c_prod.h"
@@ -23,6 +25,8 @@ extern "C" {
     DEFINE_ENUM(UNIQUEID_RESULT, UNIQUEID_RESULT_VALUES)
 
         MOCKABLE_FUNCTION(, UNIQUEID_RESULT, UniqueId_Generate, char*, uid, size_t, bufferSize);
+        MOCKABLE_FUNCTION(, UNIQUEID_RESULT, UniqueId_GetRandomBytes, unsigned char*, buffer, size_t, size);
+        MOCKABLE_FUNCTION(, UNIQUEID_RESULT, UniqueId_GetTimestampSequence, uint64_t*, unix_time_ms, uint16_t*, sequence);
 
 #ifdef __cplusplus
 }
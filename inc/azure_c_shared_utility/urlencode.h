@@ -25,6 +25,22 @@ extern "C" {
     MOCKABLE_FUNCTION(, STRING_HANDLE, URL_Encode, STRING_HANDLE, input);
     MOCKABLE_FUNCTION(, STRING_HANDLE, URL_EncodeString, const char*, textEncode);
 
+    /* @brief   URL Encode a string into a caller supplied buffer, without allocating.
+    *
+    * @param    destination_size must account for the null terminator. The encoded string is
+    * at most 6 times the length of textEncode (3 times for 7-bit ASCII input).
+    *
+    * @return   Returns 0 and the encoded length (excluding the null terminator) in encoded_length,
+    * or a non-zero value on failure, including when destination is too small.
+    */
+    MOCKABLE_FUNCTION(, int, URL_EncodeString_Into, const char*, textEncode, char*, destination, size_t, destination_size, size_t*, encoded_length);
+
+    /* @brief   URL Encode a string and append the result to an existing STRING_HANDLE.
+    *
+    * @return   Returns 0 on success, or a non-zero value on failure.
+    */
+    MOCKABLE_FUNCTION(, int, URL_EncodeString_Append, STRING_HANDLE, destination, const char*, textEncode);
+
     /* @brief   URL Decode (aka percent decode) a string.
     * Please note that the URL decoder only supports decoding characters that fall within the
     * 7-bit ASCII range. It does NOT support 8-bit extended ASCII, and will fail if you try.
@@ -37,6 +53,22 @@ extern "C" {
     MOCKABLE_FUNCTION(, STRING_HANDLE, URL_Decode, STRING_HANDLE, input);
     MOCKABLE_FUNCTION(, STRING_HANDLE, URL_DecodeString, const char*, textDecode);
 
+    /* @brief   URL Decode a string into a caller supplied buffer, without allocating.
+    *
+    * @param    destination_size must account for the null terminator. The decoded string is
+    * never longer than textDecode.
+    *
+    * @return   Returns 0 and the decoded length (excluding the null terminator) in decoded_length,
+    * or a non-zero value on failure, including when destination is too small.
+    */
+    MOCKABLE_FUNCTION(, int, URL_DecodeString_Into, const char*, textDecode, char*, destination, size_t, destination_size, size_t*, decoded_length);
+
+    /* @brief   URL Decode a string and append the result to an existing STRING_HANDLE.
+    *
+    * @return   Returns 0 on success, or a non-zero value on failure.
+    */
+    MOCKABLE_FUNCTION(, int, URL_DecodeString_Append, STRING_HANDLE, destination, const char*, textDecode);
+
 #ifdef __cplusplus
 }
 #endif
@@ -14,8 +14,40 @@ extern "C" {
 
 #include "azure_c_shared_utility/umock_c_prod.h"
 
+typedef struct UTF8_CHECKER_INSTANCE_TAG* UTF8_CHECKER_HANDLE;
+
 MOCKABLE_FUNCTION(, bool, utf8_checker_is_valid_utf8, const unsigned char*, utf8_str, size_t, length);
 
+/**
+ * @brief   Creates a checker that validates UTF-8 delivered in consecutive chunks. A code point may be split across chunks.
+ *
+ * @return  A handle to the checker, or @c NULL on failure.
+ */
+MOCKABLE_FUNCTION(, UTF8_CHECKER_HANDLE, utf8_checker_create);
+
+/**
+ * @brief   Frees a checker created with utf8_checker_create.
+ */
+MOCKABLE_FUNCTION(, void, utf8_checker_destroy, UTF8_CHECKER_HANDLE, utf8_checker);
+
+/**
+ * @brief   Discards any bytes fed so far, so the checker can be reused for a new sequence.
+ */
+MOCKABLE_FUNCTION(, void, utf8_checker_reset, UTF8_CHECKER_HANDLE, utf8_checker);
+
+/**
+ * @brief   Feeds the next chunk of the sequence to the checker.
+ *
+ * @return  @c false as soon as the bytes fed so far cannot be the start of valid UTF-8, @c true otherwise
+ *          (including when the chunk ends in the middle of a code point).
+ */
+MOCKABLE_FUNCTION(, bool, utf8_checker_process, UTF8_CHECKER_HANDLE, utf8_checker, const unsigned char*, utf8_str, size_t, length);
+
+/**
+ * @brief   Tells whether all bytes fed so far form complete, valid UTF-8.
+ */
+MOCKABLE_FUNCTION(, bool, utf8_checker_is_complete, UTF8_CHECKER_HANDLE, utf8_checker);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -24,6 +24,21 @@ typedef unsigned char UUID[16];
 */
 MOCKABLE_FUNCTION(, int, UUID_generate, UUID*, uuid);
 
+/* @brief               Generates a time ordered (version 7) UUID: a millisecond Unix timestamp, a sequence
+*                       number and 62 random bits. UUIDs generated in the same process sort in generation
+*                       order, also across threads.
+*  @param uuid          A pre-allocated buffer for the bytes of the generated UUID
+*  @returns             Zero if no failures occur, non-zero otherwise.
+*/
+MOCKABLE_FUNCTION(, int, UUID_generate_v7, UUID*, uuid);
+
+/* @brief               Generates several random UUIDs, drawing the random bytes for all of them at once.
+*  @param uuids         A pre-allocated array of at least `count` UUIDs.
+*  @param count         Number of UUIDs to generate.
+*  @returns             Zero if no failures occur, non-zero otherwise.
+*/
+MOCKABLE_FUNCTION(, int, UUID_generate_batch, UUID*, uuids, size_t, count);
+
 /* @brief               Gets the UUID value (byte sequence) of an well-formed UUID string.
 *  @param uuid_string   A null-terminated well-formed UUID string (e.g., "7f907d75-5e13-44cf-a1a3-19a01a2b4528").
 *  @param uuid          Sequence of bytes representing an UUID.
@@ -37,6 +52,14 @@ MOCKABLE_FUNCTION(, int, UUID_from_string, const char*, uuid_string, UUID*, uuid
 */
 MOCKABLE_FUNCTION(, char*, UUID_to_string, UUID*, uuid);
 
+/* @brief                   Writes the string representation of the UUID value to a caller supplied buffer.
+*  @param uuid              Sequence of bytes representing an UUID.
+*  @param destination       Buffer that receives the null-terminated string (e.g., "7f907d75-5e13-44cf-a1a3-19a01a2b4528").
+*  @param destination_size  Size of `destination` in bytes; must be at least 37.
+*  @returns                 Zero if no failures occur, non-zero otherwise.
+*/
+MOCKABLE_FUNCTION(, int, UUID_to_string_into, UUID*, uuid, char*, destination, size_t, destination_size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -13,6 +13,7 @@
 #include "azure_c_shared_utility/base32.h"
 
 static const unsigned char BASE32_EQUAL_SIGN = 32;
+static const unsigned char BASE32_INVALID_BIT = 0x80;
 
 static const char BASE32_VALUES[] = "abcdefghijklmnopqrstuvwxyz234567=";
 #define TARGET_BLOCK_SIZE       5
@@ -20,7 +21,30 @@ static const char BASE32_VALUES[] = "abcdefghijklmnopqrstuvwxyz234567=";
 
 #define BASE32_INPUT_SIZE       8
 
-#define ASCII_VALUE_MAX         0x80
+/* Maps every source character to its 5 bit value. Upper and lower case letters decode alike,
+   '=' maps to BASE32_EQUAL_SIGN and anything outside of the alphabet maps to 0xFF (BASE32_INVALID_BIT set) */
+static const unsigned char BASE32_DECODE_TABLE[256] =
+{
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0xff, 0xff, 0xff, 0xff, 0xff, 0x20, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+/* Number of significant characters produced for a trailing block of 1 to 4 bytes */
+static const size_t BASE32_PARTIAL_BLOCK_CHARS[TARGET_BLOCK_SIZE] = { 0, 2, 4, 5, 7 };
 
 static size_t base32_encoding_length(size_t src_len)
 {
@@ -32,39 +56,53 @@ static size_t base32_decoding_length(size_t src_len)
     return ((src_len*TARGET_BLOCK_SIZE) / 8);
 }
 
-static unsigned char convert_value_to_base32_char(unsigned char value)
+static void base32_encode_block(const unsigned char* source, char* destination)
 {
-    unsigned char result;
+    // Load the 5 bytes as one 40-bit value and emit the 8 characters from the high bits down
+    uint64_t block = ((uint64_t)source[0] << 32) |
+        ((uint64_t)source[1] << 24) |
+        ((uint64_t)source[2] << 16) |
+        ((uint64_t)source[3] << 8) |
+        (uint64_t)source[4];
 
-    if (value >= 50 && value <= 55)
-    {
-        result = 0x1a+(value-50);
-    }
-    else if (value == 61)
-    {
-        result = 0x20;
-    }
-    else if ((value <= 49) || (value >= 56 && value <= 64))
-    {
-        result = 0xFF;
-    }
-    else if (value >= 65 && value <= 90)
-    {
-        result = 0x00 + (value - 65);
-    }
-    else if (value >= 91 && value <= 96)
-    {
-        result = 0xFF;
-    }
-    else if (value >= 97 && value <= 123)
+    destination[0] = BASE32_VALUES[(block >> 35) & 0x1f];
+    destination[1] = BASE32_VALUES[(block >> 30) & 0x1f];
+    destination[2] = BASE32_VALUES[(block >> 25) & 0x1f];
+    destination[3] = BASE32_VALUES[(block >> 20) & 0x1f];
+    destination[4] = BASE32_VALUES[(block >> 15) & 0x1f];
+    destination[5] = BASE32_VALUES[(block >> 10) & 0x1f];
+    destination[6] = BASE32_VALUES[(block >> 5) & 0x1f];
+    destination[7] = BASE32_VALUES[block & 0x1f];
+}
+
+static void base32_encode_into(const unsigned char* source, size_t src_size, char* destination)
+{
+    /* Codes_SRS_BASE32_07_010: [ base32_encode_impl shall look through source and separate each block into 5 bit chunks ] */
+    /* Codes_SRS_BASE32_07_011: [ base32_encode_impl shall then map the 5 bit chunks into one of the BASE32 values (a-z,2,3,4,5,6,7) values. ] */
+    while (src_size >= TARGET_BLOCK_SIZE)
     {
-        result = 0x00 + (value - 97);
+        base32_encode_block(source, destination);
+        source += TARGET_BLOCK_SIZE;
+        src_size -= TARGET_BLOCK_SIZE;
+        destination += BASE32_INPUT_SIZE;
     }
-    else // value > 123
+
+    if (src_size > 0)
     {
-        result = 0xFF;
+        unsigned char last_block[TARGET_BLOCK_SIZE] = { 0 };
+        size_t index;
+
+        (void)memcpy(last_block, source, src_size);
+        base32_encode_block(last_block, destination);
+
+        /* Codes_SRS_BASE32_07_012: [ If the src_size is not divisible by 8, base32_encode_impl shall pad the remaining places with =. ] */
+        for (index = BASE32_PARTIAL_BLOCK_CHARS[src_size]; index < BASE32_INPUT_SIZE; index++)
+        {
+            destination[index] = BASE32_VALUES[BASE32_EQUAL_SIGN];
+        }
+        destination += BASE32_INPUT_SIZE;
     }
-    return result;
+    *destination = '\0';
 }
 
 static char* base32_encode_impl(const unsigned char* source, size_t src_size)
@@ -80,83 +118,81 @@ static char* base32_encode_impl(const unsigned char* source, size_t src_size)
     }
     else
     {
-        const unsigned char* iterator = source;
-        size_t block_len = 0;
-        size_t result_len = 0;
-        unsigned char pos1 = 0;
-        unsigned char pos2 = 0;
-        unsigned char pos3 = 0;
-        unsigned char pos4 = 0;
-        unsigned char pos5 = 0;
-        unsigned char pos6 = 0;
-        unsigned char pos7 = 0;
-        unsigned char pos8 = 0;
+        base32_encode_into(source, src_size, result);
+    }
+    return result;
+}
 
-        memset(result, 0, output_len + 1);
+static int base32_decode_into(const char* source, size_t src_length, unsigned char* destination, size_t* decoded_size)
+{
+    int result = 0;
+    const unsigned char* iterator = (const unsigned char*)source;
+    const unsigned char* source_end = iterator + src_length;
+    unsigned char* dest_buff = destination;
+    size_t dest_size = 0;
+
+    while (iterator < source_end)
+    {
+        /* Codes_SRS_BASE32_07_024: [ base32_decode_impl shall loop through and collect 8 characters from the source variable. ] */
+        unsigned char input0 = BASE32_DECODE_TABLE[iterator[0]];
+        unsigned char input1 = BASE32_DECODE_TABLE[iterator[1]];
+        unsigned char input2 = BASE32_DECODE_TABLE[iterator[2]];
+        unsigned char input3 = BASE32_DECODE_TABLE[iterator[3]];
+        unsigned char input4 = BASE32_DECODE_TABLE[iterator[4]];
+        unsigned char input5 = BASE32_DECODE_TABLE[iterator[5]];
+        unsigned char input6 = BASE32_DECODE_TABLE[iterator[6]];
+        unsigned char input7 = BASE32_DECODE_TABLE[iterator[7]];
+        iterator += BASE32_INPUT_SIZE;
 
-        // Go through the source buffer sectioning off blocks of 5
-        /* Codes_SRS_BASE32_07_010: [ base32_encode_impl shall look through source and separate each block into 5 bit chunks ] */
-        while (src_size >= 1 && result != NULL)
+        // Valid values never have BASE32_INVALID_BIT set, so one check on the combined values finds any invalid character
+        if (((input0 | input1 | input2 | input3 | input4 | input5 | input6 | input7) & BASE32_INVALID_BIT) != 0)
         {
-            pos1 = pos2 = pos3 = pos4 = pos5 = pos6 = pos7 = pos8 = 0;
-            block_len = src_size > TARGET_BLOCK_SIZE ? TARGET_BLOCK_SIZE : src_size;
-            // Fall through switch block to process the 5 (or smaller) block
-            switch (block_len)
-            {
-            case 5:
-                pos8 = (iterator[4] & 0x1f);
-                pos7 = ((iterator[4] & 0xe0) >> 5);
-            case 4:
-                pos7 |= ((iterator[3] & 0x03) << 3);
-                pos6 = ((iterator[3] & 0x7c) >> 2);
-                pos5 = ((iterator[3] & 0x80) >> 7);
-            case 3:
-                pos5 |= ((iterator[2] & 0x0f) << 1);
-                pos4 = ((iterator[2] & 0xf0) >> 4);
-            case 2:
-                pos4 |= ((iterator[1] & 0x01) << 4);
-                pos3 = ((iterator[1] & 0x3e) >> 1);
-                pos2 = ((iterator[1] & 0xc0) >> 6);
-            case 1:
-                pos2 |= ((iterator[0] & 0x07) << 2);
-                pos1 = ((iterator[0] & 0xf8) >> 3);
-                break;
-            }
-            // Move the iterator the block size
-            iterator += block_len;
-            // and decrement the src_size;
-            src_size -= block_len;
+            /* Codes_SRS_BASE32_07_028: [ If source contains a character that is not part of the base32 alphabet, base32_decode_impl shall fail. ] */
+            LogError("Failure source encoding");
+            result = __FAILURE__;
+            break;
+        }
+        else
+        {
+            // Codes_SRS_BASE32_07_025: [ base32_decode_impl shall group 5 bytes at a time into the temp buffer. ]
+            uint64_t block = ((uint64_t)(input0 & 0x1f) << 35) |
+                ((uint64_t)(input1 & 0x1f) << 30) |
+                ((uint64_t)(input2 & 0x1f) << 25) |
+                ((uint64_t)(input3 & 0x1f) << 20) |
+                ((uint64_t)(input4 & 0x1f) << 15) |
+                ((uint64_t)(input5 & 0x1f) << 10) |
+                ((uint64_t)(input6 & 0x1f) << 5) |
+                (uint64_t)(input7 & 0x1f);
 
-            /* Codes_SRS_BASE32_07_012: [ If the src_size is not divisible by 8, base32_encode_impl shall pad the remaining places with =. ] */
-            switch (block_len)
+            *dest_buff++ = (unsigned char)(block >> 32);
+            *dest_buff++ = (unsigned char)(block >> 24);
+            *dest_buff++ = (unsigned char)(block >> 16);
+            *dest_buff++ = (unsigned char)(block >> 8);
+            *dest_buff++ = (unsigned char)block;
+            dest_size += TARGET_BLOCK_SIZE;
+            // If there is padding remove it
+            // Because we are packing 5 bytes into an 8 byte variable we need to check every other
+            // variable for padding
+            if (input7 == BASE32_EQUAL_SIGN)
             {
-                case 1: pos3 = pos4 = 32;
-                case 2: pos5 = 32;
-                case 3: pos6 = pos7 = 32;
-                case 4: pos8 = 32;
-                case 5:
-                    break;
+                --dest_size;
+                if (input5 == BASE32_EQUAL_SIGN)
+                {
+                    --dest_size;
+                    if (input4 == BASE32_EQUAL_SIGN)
+                    {
+                        --dest_size;
+                        if (input2 == BASE32_EQUAL_SIGN)
+                        {
+                            --dest_size;
+                        }
+                    }
+                }
             }
-
-            /* Codes_SRS_BASE32_07_011: [ base32_encode_impl shall then map the 5 bit chunks into one of the BASE32 values (a-z,2,3,4,5,6,7) values. ] */
-
-#ifdef _MSC_VER
-// Buffer overrun while writing to 'result':  the writable size is 'output_len+1' bytes, but '2' bytes might be written.
-#pragma warning(disable:6386)
-#endif
-            result[result_len++] = BASE32_VALUES[pos1];
-            result[result_len++] = BASE32_VALUES[pos2];
-            result[result_len++] = BASE32_VALUES[pos3];
-            result[result_len++] = BASE32_VALUES[pos4];
-            result[result_len++] = BASE32_VALUES[pos5];
-            result[result_len++] = BASE32_VALUES[pos6];
-            result[result_len++] = BASE32_VALUES[pos7];
-            result[result_len++] = BASE32_VALUES[pos8];
-#ifdef _MSC_VER
-#pragma warning(default:6386)
-#endif
         }
     }
+
+    *decoded_size = dest_size;
     return result;
 }
 
@@ -173,12 +209,8 @@ static BUFFER_HANDLE base32_decode_impl(const char* source)
     }
     else
     {
-        size_t dest_size = 0;
         unsigned char* temp_buffer;
-        unsigned char* dest_buff;
-        bool continue_processing = true;
-        unsigned char input[8];
-        const char* iterator = source;
+        size_t dest_size;
 
         /* Codes_SRS_BASE32_07_022: [ base32_decode_impl shall allocate a temp buffer to store the in process value. ] */
         size_t allocation_len = base32_decoding_length(src_length);
@@ -190,70 +222,9 @@ static BUFFER_HANDLE base32_decode_impl(const char* source)
         }
         else
         {
-            dest_buff = temp_buffer;
-            while (*iterator != '\0')
-            {
-                size_t index = 0;
-                /* Codes_SRS_BASE32_07_024: [ base32_decode_impl shall loop through and collect 8 characters from the source variable. ] */
-                for (index = 0; index < BASE32_INPUT_SIZE; index++)
-                {
-                    input[index] = *iterator;
-                    iterator++;
-                    if (input[index] >= ASCII_VALUE_MAX)
-                    {
-                        LogError("Failure source encoding");
-                        continue_processing = false;
-                        break;
-                    }
-
-                    input[index] = convert_value_to_base32_char(input[index]);
-                }
-
-                if (!continue_processing)
-                {
-                    result = NULL;
-                    break;
-                }
-                else if ((dest_size + TARGET_BLOCK_SIZE) > allocation_len)
-                {
-                    LogError("Failure target length exceeded");
-                    result = NULL;
-                    continue_processing = false;
-                    break;
-                }
-                else
-                {
-                    // Codes_SRS_BASE32_07_025: [ base32_decode_impl shall group 5 bytes at a time into the temp buffer. ]
-                    *dest_buff++ = ((input[0] & 0x1f) << 3) | ((input[1] & 0x1c) >> 2);
-                    *dest_buff++ = ((input[1] & 0x03) << 6) | ((input[2] & 0x1f) << 1) | ((input[3] & 0x10) >> 4);
-                    *dest_buff++ = ((input[3] & 0x0f) << 4) | ((input[4] & 0x1e) >> 1);
-                    *dest_buff++ = ((input[4] & 0x01) << 7) | ((input[5] & 0x1f) << 2) | ((input[6] & 0x18) >> 3);
-                    *dest_buff++ = ((input[6] & 0x07) << 5) | (input[7] & 0x1f);
-                    dest_size += TARGET_BLOCK_SIZE;
-                    // If there is padding remove it
-                    // Because we are packing 5 bytes into an 8 byte variable we need to check every other
-                    // variable for padding
-                    if (input[7] == BASE32_EQUAL_SIGN)
-                    {
-                        --dest_size;
-                        if (input[5] == BASE32_EQUAL_SIGN)
-                        {
-                            --dest_size;
-                            if (input[4] == BASE32_EQUAL_SIGN)
-                            {
-                                --dest_size;
-                                if (input[2] == BASE32_EQUAL_SIGN)
-                                {
-                                    --dest_size;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-
-            if (!continue_processing)
+            if (base32_decode_into(source, src_length, temp_buffer, &dest_size) != 0)
             {
+                /* Codes_SRS_BASE32_07_023: [ If an error is encountered, base32_decode_impl shall return NULL. ] */
                 result = NULL;
             }
             else
@@ -354,6 +325,68 @@ char* Base32_Encode_Bytes(const unsigned char* source, size_t size)
     return result;
 }
 
+int Base32_Encode_Bytes_Into(const unsigned char* source, size_t size, char* destination, size_t destination_size)
+{
+    int result;
+    if ((source == NULL && size > 0) || destination == NULL)
+    {
+        /* Codes_SRS_BASE32_07_029: [ If source is NULL and size is not 0, or destination is NULL, Base32_Encode_Bytes_Into shall return a non-zero value. ] */
+        LogError("Failure: Invalid input parameter source=%p, destination=%p", source, destination);
+        result = __FAILURE__;
+    }
+    else if (destination_size < base32_encoding_length(size) + 1)
+    {
+        /* Codes_SRS_BASE32_07_030: [ If destination_size is less than the encoded length plus the null terminator, Base32_Encode_Bytes_Into shall return a non-zero value. ] */
+        LogError("Failure: destination size %zu is too small for %zu bytes", destination_size, size);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_BASE32_07_031: [ Base32_Encode_Bytes_Into shall write the null terminated base32 value of source into destination without allocating memory and return 0. ] */
+        base32_encode_into(source, size, destination);
+        result = 0;
+    }
+    return result;
+}
+
+int Base32_Decode_String_Into(const char* source, unsigned char* destination, size_t destination_size, size_t* decoded_size)
+{
+    int result;
+    if (source == NULL || destination == NULL || decoded_size == NULL)
+    {
+        /* Codes_SRS_BASE32_07_032: [ If source, destination or decoded_size is NULL, Base32_Decode_String_Into shall return a non-zero value. ] */
+        LogError("Failure: Invalid input parameter source=%p, destination=%p, decoded_size=%p", source, destination, decoded_size);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t src_length = strlen(source);
+        if (src_length % BASE32_INPUT_SIZE != 0)
+        {
+            /* Codes_SRS_BASE32_07_033: [ If the source length is not evenly divisible by 8, Base32_Decode_String_Into shall return a non-zero value. ] */
+            LogError("Failure invalid input length %zu", src_length);
+            result = __FAILURE__;
+        }
+        else if (destination_size < base32_decoding_length(src_length))
+        {
+            /* Codes_SRS_BASE32_07_034: [ If destination_size is less than 5 bytes for every 8 characters of source, Base32_Decode_String_Into shall return a non-zero value. ] */
+            LogError("Failure: destination size %zu is too small for %zu characters", destination_size, src_length);
+            result = __FAILURE__;
+        }
+        else if (base32_decode_into(source, src_length, destination, decoded_size) != 0)
+        {
+            /* Codes_SRS_BASE32_07_035: [ If source contains a character that is not part of the base32 alphabet, Base32_Decode_String_Into shall return a non-zero value. ] */
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_BASE32_07_036: [ On success Base32_Decode_String_Into shall write the decoded bytes into destination, set decoded_size to their count and return 0. ] */
+            result = 0;
+        }
+    }
+    return result;
+}
+
 STRING_HANDLE Base32_Encode(BUFFER_HANDLE source)
 {
     STRING_HANDLE result;
@@ -6,6 +6,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include "azure_c_shared_utility/base64.h"
+#include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/xlogging.h"
 
 
@@ -233,13 +234,81 @@ BUFFER_HANDLE Base64_Decoder(const char* source)
 }
 
 
+static size_t base64_encoding_length(size_t size)
+{
+    return (size == 0) ? (0) : ((((size - 1) / 3) + 1) * 4);
+}
+
+static void base64_encode_into(const unsigned char* source, size_t size, char* encoded)
+{
+    /*b0            b1(+1)          b2(+2)
+    7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0
+    |----c1---| |----c2---| |----c3---| |----c4---|
+    */
+
+    size_t currentPosition = 0;
+    size_t destinationPosition = 0;
+    while (size - currentPosition >= 3)
+    {
+        char c1 = base64char(source[currentPosition] >> 2);
+        char c2 = base64char(
+            ((source[currentPosition] & 3) << 4) |
+                (source[currentPosition + 1] >> 4)
+        );
+        char c3 = base64char(
+            ((source[currentPosition + 1] & 0x0F) << 2) |
+                ((source[currentPosition + 2] >> 6) & 3)
+        );
+        char c4 = base64char(
+            source[currentPosition + 2] & 0x3F
+        );
+
+        currentPosition += 3;
+        encoded[destinationPosition++] = c1;
+        encoded[destinationPosition++] = c2;
+        encoded[destinationPosition++] = c3;
+        encoded[destinationPosition++] = c4;
+
+    }
+    if (size - currentPosition == 2)
+    {
+        char c1 = base64char(source[currentPosition] >> 2);
+        char c2 = base64char(
+            ((source[currentPosition] & 0x03) << 4) |
+                (source[currentPosition + 1] >> 4)
+        );
+        char c3 = base64b16(source[currentPosition + 1] & 0x0F);
+        encoded[destinationPosition++] = c1;
+        encoded[destinationPosition++] = c2;
+        encoded[destinationPosition++] = c3;
+        encoded[destinationPosition++] = '=';
+    }
+    else if (size - currentPosition == 1)
+    {
+        char c1 = base64char(source[currentPosition] >> 2);
+        char c2 = base64b8(source[currentPosition] & 0x03);
+        encoded[destinationPosition++] = c1;
+        encoded[destinationPosition++] = c2;
+#ifdef _MSC_VER
+        // Disable: Buffer overrun while writing to 'encoded':  the writable size is 'neededSize+1' bytes, but '7' bytes might be written.
+#pragma warning(disable:6386)
+#endif
+        encoded[destinationPosition++] = '=';
+#ifdef _MSC_VER
+#pragma warning(default:6386)
+#endif
+        encoded[destinationPosition++] = '=';
+    }
+
+    /*null terminating the string*/
+    encoded[destinationPosition] = '\0';
+}
+
 static STRING_HANDLE Base64_Encode_Internal(const unsigned char* source, size_t size)
 {
     STRING_HANDLE result;
-    size_t neededSize = 0;
+    size_t neededSize = base64_encoding_length(size);
     char* encoded;
-    size_t currentPosition = 0;
-    neededSize += (size == 0) ? (0) : ((((size - 1) / 3) + 1) * 4);
     neededSize += 1; /*+1 because \0 at the end of the string*/
     /*Codes_SRS_BASE64_06_006: [If when allocating memory to produce the encoding a failure occurs then Base64_Encoder shall return NULL.]*/
     encoded = (char*)malloc(neededSize + 1);
@@ -250,66 +319,7 @@ static STRING_HANDLE Base64_Encode_Internal(const unsigned char* source, size_t
     }
     else
     {
-        /*b0            b1(+1)          b2(+2)
-        7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0
-        |----c1---| |----c2---| |----c3---| |----c4---|
-        */
-
-        size_t destinationPosition = 0;
-        while (size - currentPosition >= 3)
-        {
-            char c1 = base64char(source[currentPosition] >> 2);
-            char c2 = base64char(
-                ((source[currentPosition] & 3) << 4) |
-                    (source[currentPosition + 1] >> 4)
-            );
-            char c3 = base64char(
-                ((source[currentPosition + 1] & 0x0F) << 2) |
-                    ((source[currentPosition + 2] >> 6) & 3)
-            );
-            char c4 = base64char(
-                source[currentPosition + 2] & 0x3F
-            );
-
-            currentPosition += 3;
-            encoded[destinationPosition++] = c1;
-            encoded[destinationPosition++] = c2;
-            encoded[destinationPosition++] = c3;
-            encoded[destinationPosition++] = c4;
-
-        }
-        if (size - currentPosition == 2)
-        {
-            char c1 = base64char(source[currentPosition] >> 2);
-            char c2 = base64char(
-                ((source[currentPosition] & 0x03) << 4) |
-                    (source[currentPosition + 1] >> 4)
-            );
-            char c3 = base64b16(source[currentPosition + 1] & 0x0F);
-            encoded[destinationPosition++] = c1;
-            encoded[destinationPosition++] = c2;
-            encoded[destinationPosition++] = c3;
-            encoded[destinationPosition++] = '=';
-        }
-        else if (size - currentPosition == 1)
-        {
-            char c1 = base64char(source[currentPosition] >> 2);
-            char c2 = base64b8(source[currentPosition] & 0x03);
-            encoded[destinationPosition++] = c1;
-            encoded[destinationPosition++] = c2;
-#ifdef _MSC_VER
-            // Disable: Buffer overrun while writing to 'encoded':  the writable size is 'neededSize+1' bytes, but '7' bytes might be written.
-#pragma warning(disable:6386)
-#endif
-            encoded[destinationPosition++] = '=';
-#ifdef _MSC_VER
-#pragma warning(default:6386)
-#endif
-            encoded[destinationPosition++] = '=';
-        }
-
-        /*null terminating the string*/
-        encoded[destinationPosition] = '\0';
+        base64_encode_into(source, size, encoded);
         /*Codes_SRS_BASE64_06_007: [Otherwise Base64_Encoder shall return a pointer to STRING, that string contains the base 64 encoding of input.]*/
         result = STRING_new_with_memory(encoded);
         if (result == NULL)
@@ -341,6 +351,30 @@ STRING_HANDLE Base64_Encode_Bytes(const unsigned char* source, size_t size)
     return result;
 }
 
+int Base64_Encode_Bytes_Into(const unsigned char* source, size_t size, char* destination, size_t destination_size)
+{
+    int result;
+    if ((source == NULL && size > 0) || destination == NULL)
+    {
+        /*Codes_SRS_BASE64_01_001: [If source is NULL and size is not 0, or destination is NULL, Base64_Encode_Bytes_Into shall return a non-zero value.]*/
+        LogError("Base64_Encode_Bytes_Into:: invalid argument source=%p, destination=%p", source, destination);
+        result = __FAILURE__;
+    }
+    else if (destination_size < base64_encoding_length(size) + 1)
+    {
+        /*Codes_SRS_BASE64_01_002: [If destination_size is less than the encoded length plus the null terminator, Base64_Encode_Bytes_Into shall return a non-zero value.]*/
+        LogError("Base64_Encode_Bytes_Into:: destination size %lu is too small for %lu bytes", (unsigned long)destination_size, (unsigned long)size);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /*Codes_SRS_BASE64_01_003: [Base64_Encode_Bytes_Into shall write the null terminated base64 encoding of source into destination without allocating memory and return 0.]*/
+        base64_encode_into(source, size, destination);
+        result = 0;
+    }
+    return result;
+}
+
 STRING_HANDLE Base64_Encoder(BUFFER_HANDLE input)
 {
     STRING_HANDLE result;
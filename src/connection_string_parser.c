@@ -6,6 +6,7 @@
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/string_tokenizer.h"
 #include <stdbool.h>
+#include <string.h>
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/xlogging.h"
 
@@ -155,6 +156,164 @@ MAP_HANDLE connectionstringparser_parse(STRING_HANDLE connection_string)
     return result;
 }
 
+int connectionstringparser_scan(const char* connection_string, CONNECTION_STRING_PAIR_CALLBACK on_pair, void* context)
+{
+    int result;
+
+    if ((connection_string == NULL) ||
+        (on_pair == NULL))
+    {
+        /* Codes_SRS_CONNECTIONSTRINGPARSER_01_020: [If connection_string or on_pair is NULL, connectionstringparser_scan shall fail and return a non-zero value.] */
+        LogError("Invalid arguments: connection_string = %p, on_pair = %p", connection_string, on_pair);
+        result = __FAILURE__;
+    }
+    else
+    {
+        const char* position = connection_string;
+
+        result = 0;
+
+        /* Codes_SRS_CONNECTIONSTRINGPARSER_01_021: [connectionstringparser_scan shall walk the connection string once, without allocating memory or copying, and call on_pair with the key and value of each `key=value` pair, in order.] */
+        while (*position != '\0')
+        {
+            const char* key;
+            size_t key_length;
+            const char* value;
+            size_t value_length;
+
+            /* Codes_SRS_CONNECTIONSTRINGPARSER_01_022: [Empty `;` separated segments shall be skipped.] */
+            if (*position == ';')
+            {
+                position++;
+                continue;
+            }
+
+            /* Codes_SRS_CONNECTIONSTRINGPARSER_01_023: [The key shall end at the first `=` of the pair; the value shall run from there to the next `;` or the end of the string and may contain `=`.] */
+            key = position;
+            key_length = strcspn(key, "=;");
+            if ((key_length == 0) ||
+                (key[key_length] != '='))
+            {
+                /* Codes_SRS_CONNECTIONSTRINGPARSER_01_024: [If a pair has no `=` or an empty key, connectionstringparser_scan shall fail and return a non-zero value.] */
+                LogError("Invalid key/value pair at offset %lu.", (unsigned long)(key - connection_string));
+                result = __FAILURE__;
+                break;
+            }
+
+            value = key + key_length + 1;
+            value_length = strcspn(value, ";");
+            if (value_length == 0)
+            {
+                /* Codes_SRS_CONNECTIONSTRINGPARSER_01_025: [If a value is empty, connectionstringparser_scan shall fail and return a non-zero value.] */
+                LogError("Empty value at offset %lu.", (unsigned long)(value - connection_string));
+                result = __FAILURE__;
+                break;
+            }
+
+            if (on_pair(context, key, key_length, value, value_length) != 0)
+            {
+                /* Codes_SRS_CONNECTIONSTRINGPARSER_01_026: [If on_pair returns a non-zero value, connectionstringparser_scan shall stop and return a non-zero value.] */
+                LogError("Scanning of the connection string was stopped by the caller.");
+                result = __FAILURE__;
+                break;
+            }
+
+            position = value + value_length;
+        }
+    }
+
+    return result;
+}
+
+static bool key_equals(const char* key, size_t key_length, const char* expected, size_t expected_length)
+{
+    return (key_length == expected_length) && (memcmp(key, expected, key_length) == 0);
+}
+
+#define KEY_AND_LENGTH(key) key, sizeof(key) - 1
+
+static int on_field_pair(void* context, const char* key, size_t key_length, const char* value, size_t value_length)
+{
+    int result;
+    CONNECTION_STRING_FIELDS* fields = (CONNECTION_STRING_FIELDS*)context;
+    CONNECTION_STRING_FIELD* field;
+
+    if (key_equals(key, key_length, KEY_AND_LENGTH("HostName")))
+    {
+        field = &fields->hostName;
+    }
+    else if (key_equals(key, key_length, KEY_AND_LENGTH("DeviceId")))
+    {
+        field = &fields->deviceId;
+    }
+    else if (key_equals(key, key_length, KEY_AND_LENGTH("SharedAccessKey")))
+    {
+        field = &fields->sharedAccessKey;
+    }
+    else if (key_equals(key, key_length, KEY_AND_LENGTH("SharedAccessKeyName")))
+    {
+        field = &fields->sharedAccessKeyName;
+    }
+    else if (key_equals(key, key_length, KEY_AND_LENGTH("SharedAccessSignature")))
+    {
+        field = &fields->sharedAccessSignature;
+    }
+    else
+    {
+        /* Codes_SRS_CONNECTIONSTRINGPARSER_01_029: [Keys other than the well-known ones shall be ignored.] */
+        field = NULL;
+    }
+
+    if (field == NULL)
+    {
+        result = 0;
+    }
+    else if (field->value != NULL)
+    {
+        /* Codes_SRS_CONNECTIONSTRINGPARSER_01_030: [If a well-known key appears more than once, connectionstringparser_parse_fields shall fail and return a non-zero value.] */
+        LogError("Duplicate key %.*s in connection string.", (int)key_length, key);
+        result = __FAILURE__;
+    }
+    else
+    {
+        field->value = value;
+        field->length = value_length;
+        result = 0;
+    }
+
+    return result;
+}
+
+int connectionstringparser_parse_fields(const char* connection_string, CONNECTION_STRING_FIELDS* fields)
+{
+    int result;
+
+    if ((connection_string == NULL) ||
+        (fields == NULL))
+    {
+        /* Codes_SRS_CONNECTIONSTRINGPARSER_01_027: [If connection_string or fields is NULL, connectionstringparser_parse_fields shall fail and return a non-zero value.] */
+        LogError("Invalid arguments: connection_string = %p, fields = %p", connection_string, fields);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_CONNECTIONSTRINGPARSER_01_028: [connectionstringparser_parse_fields shall clear fields and scan the connection string with connectionstringparser_scan, pointing each well-known field (HostName, DeviceId, SharedAccessKey, SharedAccessKeyName, SharedAccessSignature) at its value inside connection_string.] */
+        (void)memset(fields, 0, sizeof(CONNECTION_STRING_FIELDS));
+        if (connectionstringparser_scan(connection_string, on_field_pair, fields) != 0)
+        {
+            /* Codes_SRS_CONNECTIONSTRINGPARSER_01_031: [If scanning fails, connectionstringparser_parse_fields shall fail and return a non-zero value.] */
+            LogError("Failure parsing connection string fields.");
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
 /* Codes_SRS_CONNECTIONSTRINGPARSER_21_022: [connectionstringparser_splitHostName_from_char shall split the provided hostName in name and suffix.]*/
 int connectionstringparser_splitHostName_from_char(const char* hostName, STRING_HANDLE nameString, STRING_HANDLE suffixString)
 {
@@ -0,0 +1,332 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include "azure_c_shared_utility/hash.h"
+#include "azure_c_shared_utility/sha.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/constbuffer.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+/* USHAInput and hmacInput take int/unsigned int lengths, larger segments are fed in pieces */
+#define HASH_MAX_INPUT_CHUNK ((size_t)INT_MAX)
+
+typedef struct HASH_INSTANCE_TAG
+{
+    bool isHmac;
+    int digestSize;
+    /* HMACContext carries its own USHAContext, only one of them is in use */
+    union
+    {
+        USHAContext sha;
+        HMACContext hmac;
+    } context;
+} HASH_INSTANCE;
+
+static int get_sha_version(HASH_ALGORITHM algorithm, SHAversion* whichSha)
+{
+    int result = 0;
+    switch (algorithm)
+    {
+        case HASH_ALGORITHM_SHA1:
+            *whichSha = SHA1;
+            break;
+        case HASH_ALGORITHM_SHA224:
+            *whichSha = SHA224;
+            break;
+        case HASH_ALGORITHM_SHA256:
+            *whichSha = SHA256;
+            break;
+        case HASH_ALGORITHM_SHA384:
+            *whichSha = SHA384;
+            break;
+        case HASH_ALGORITHM_SHA512:
+            *whichSha = SHA512;
+            break;
+        default:
+            result = __FAILURE__;
+            break;
+    }
+    return result;
+}
+
+static HASH_INSTANCE* create_instance(HASH_ALGORITHM algorithm, const unsigned char* key, size_t keyLen)
+{
+    HASH_INSTANCE* result;
+    SHAversion whichSha;
+
+    if (get_sha_version(algorithm, &whichSha) != 0)
+    {
+        /* Codes_SRS_HASH_01_001: [ If algorithm is not one of the HASH_ALGORITHM values, HASH_Create and HASH_CreateHmac shall fail and return NULL. ]*/
+        LogError("Unknown hash algorithm %d", (int)algorithm);
+        result = NULL;
+    }
+    else if ((result = (HASH_INSTANCE*)malloc(sizeof(HASH_INSTANCE))) == NULL)
+    {
+        /* Codes_SRS_HASH_01_004: [ If any error occurs, HASH_Create and HASH_CreateHmac shall fail and return NULL. ]*/
+        LogError("Cannot allocate memory for hash");
+    }
+    else
+    {
+        int shaResult;
+
+        result->digestSize = USHAHashSize(whichSha);
+        result->isHmac = (key != NULL);
+        if (result->isHmac)
+        {
+            /* Codes_SRS_HASH_01_006: [ HASH_CreateHmac shall initialize an HMAC context (hmacReset) for the algorithm and key. ]*/
+            shaResult = hmacReset(&result->context.hmac, whichSha, key, (int)keyLen);
+        }
+        else
+        {
+            /* Codes_SRS_HASH_01_003: [ HASH_Create shall initialize a SHA context (USHAReset) for the algorithm. ]*/
+            shaResult = USHAReset(&result->context.sha, whichSha);
+        }
+
+        if (shaResult != shaSuccess)
+        {
+            /* Codes_SRS_HASH_01_004: [ If any error occurs, HASH_Create and HASH_CreateHmac shall fail and return NULL. ]*/
+            LogError("Cannot initialize the hash context, error %d", shaResult);
+            (void)memset(result, 0, sizeof(HASH_INSTANCE));
+            free(result);
+            result = NULL;
+        }
+    }
+
+    return result;
+}
+
+HASH_HANDLE HASH_Create(HASH_ALGORITHM algorithm)
+{
+    /* Codes_SRS_HASH_01_002: [ HASH_Create shall allocate a new hash instance and return a non-NULL handle to it. ]*/
+    return create_instance(algorithm, NULL, 0);
+}
+
+HASH_HANDLE HASH_CreateHmac(HASH_ALGORITHM algorithm, const unsigned char* key, size_t keyLen)
+{
+    HASH_INSTANCE* result;
+
+    if ((key == NULL) ||
+        (keyLen == 0) ||
+        (keyLen > (size_t)INT_MAX))
+    {
+        /* Codes_SRS_HASH_01_005: [ If key is NULL, keyLen is 0 or keyLen does not fit in an int, HASH_CreateHmac shall fail and return NULL. ]*/
+        LogError("Invalid arguments: key = %p, keyLen = %lu", key, (unsigned long)keyLen);
+        result = NULL;
+    }
+    else
+    {
+        result = create_instance(algorithm, key, keyLen);
+    }
+
+    return result;
+}
+
+HASH_HANDLE HASH_Clone(HASH_HANDLE handle)
+{
+    HASH_INSTANCE* result;
+
+    if (handle == NULL)
+    {
+        /* Codes_SRS_HASH_01_007: [ If handle is NULL, HASH_Clone shall fail and return NULL. ]*/
+        LogError("Invalid argument: handle is NULL");
+        result = NULL;
+    }
+    else if ((result = (HASH_INSTANCE*)malloc(sizeof(HASH_INSTANCE))) == NULL)
+    {
+        /* Codes_SRS_HASH_01_009: [ If allocating the copy fails, HASH_Clone shall fail and return NULL. ]*/
+        LogError("Cannot allocate memory for hash clone");
+    }
+    else
+    {
+        /* Codes_SRS_HASH_01_008: [ HASH_Clone shall return a new handle whose state is a copy of the state of handle, so that both can be updated and completed independently. ]*/
+        (void)memcpy(result, handle, sizeof(HASH_INSTANCE));
+    }
+
+    return result;
+}
+
+void HASH_Destroy(HASH_HANDLE handle)
+{
+    if (handle == NULL)
+    {
+        /* Codes_SRS_HASH_01_010: [ If handle is NULL, HASH_Destroy shall do nothing. ]*/
+        LogError("Invalid argument: handle is NULL");
+    }
+    else
+    {
+        /* Codes_SRS_HASH_01_011: [ HASH_Destroy shall clear the hash state (which may include key material) and free it. ]*/
+        (void)memset(handle, 0, sizeof(HASH_INSTANCE));
+        free(handle);
+    }
+}
+
+int HASH_Update(HASH_HANDLE handle, const unsigned char* data, size_t size)
+{
+    int result;
+
+    if ((handle == NULL) ||
+        ((data == NULL) && (size > 0)))
+    {
+        /* Codes_SRS_HASH_01_012: [ If handle is NULL, or data is NULL while size is not 0, HASH_Update shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: handle = %p, data = %p, size = %lu", handle, data, (unsigned long)size);
+        result = __FAILURE__;
+    }
+    else
+    {
+        int shaResult = shaSuccess;
+
+        /* Codes_SRS_HASH_01_013: [ HASH_Update shall add the size bytes at data to the hash, feeding them in pieces that fit in an int. ]*/
+        while ((size > 0) && (shaResult == shaSuccess))
+        {
+            size_t chunk = (size > HASH_MAX_INPUT_CHUNK) ? HASH_MAX_INPUT_CHUNK : size;
+            if (handle->isHmac)
+            {
+                shaResult = hmacInput(&handle->context.hmac, data, (int)chunk);
+            }
+            else
+            {
+                shaResult = USHAInput(&handle->context.sha, data, (unsigned int)chunk);
+            }
+            data += chunk;
+            size -= chunk;
+        }
+
+        if (shaResult != shaSuccess)
+        {
+            /* Codes_SRS_HASH_01_014: [ If hashing fails (for example after HASH_Final), HASH_Update shall fail and return a non-zero value. ]*/
+            LogError("Cannot hash data, error %d", shaResult);
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_HASH_01_015: [ On success HASH_Update shall return 0. ]*/
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int HASH_UpdateWithBuffer(HASH_HANDLE handle, BUFFER_HANDLE buffer)
+{
+    int result;
+
+    if ((handle == NULL) ||
+        (buffer == NULL))
+    {
+        /* Codes_SRS_HASH_01_016: [ If handle or buffer is NULL, HASH_UpdateWithBuffer shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: handle = %p, buffer = %p", handle, buffer);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_HASH_01_017: [ HASH_UpdateWithBuffer shall hash the content of buffer as HASH_Update does, without copying it. ]*/
+        result = HASH_Update(handle, BUFFER_u_char(buffer), BUFFER_length(buffer));
+    }
+
+    return result;
+}
+
+int HASH_UpdateWithConstBuffer(HASH_HANDLE handle, CONSTBUFFER_HANDLE constBuffer)
+{
+    int result;
+    const CONSTBUFFER* content;
+
+    if ((handle == NULL) ||
+        (constBuffer == NULL))
+    {
+        /* Codes_SRS_HASH_01_018: [ If handle or constBuffer is NULL, HASH_UpdateWithConstBuffer shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: handle = %p, constBuffer = %p", handle, constBuffer);
+        result = __FAILURE__;
+    }
+    else if ((content = CONSTBUFFER_GetContent(constBuffer)) == NULL)
+    {
+        /* Codes_SRS_HASH_01_020: [ If getting the content of constBuffer fails, HASH_UpdateWithConstBuffer shall fail and return a non-zero value. ]*/
+        LogError("Cannot get the content of the const buffer");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_HASH_01_019: [ HASH_UpdateWithConstBuffer shall hash the content of constBuffer as HASH_Update does, without copying it. ]*/
+        result = HASH_Update(handle, content->buffer, content->size);
+    }
+
+    return result;
+}
+
+int HASH_Final(HASH_HANDLE handle, BUFFER_HANDLE digest)
+{
+    int result;
+
+    if ((handle == NULL) ||
+        (digest == NULL))
+    {
+        /* Codes_SRS_HASH_01_021: [ If handle or digest is NULL, HASH_Final shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: handle = %p, digest = %p", handle, digest);
+        result = __FAILURE__;
+    }
+    else
+    {
+        uint8_t hash[USHAMaxHashSize];
+        int shaResult;
+
+        /* Codes_SRS_HASH_01_022: [ HASH_Final shall complete the hash (USHAResult or hmacResult). ]*/
+        if (handle->isHmac)
+        {
+            shaResult = hmacResult(&handle->context.hmac, hash);
+        }
+        else
+        {
+            shaResult = USHAResult(&handle->context.sha, hash);
+        }
+
+        if (shaResult != shaSuccess)
+        {
+            /* Codes_SRS_HASH_01_024: [ If any error occurs, HASH_Final shall fail and return a non-zero value. ]*/
+            LogError("Cannot complete the hash, error %d", shaResult);
+            result = __FAILURE__;
+        }
+        /* Codes_SRS_HASH_01_023: [ HASH_Final shall replace the content of digest with the digest bytes. ]*/
+        else if (BUFFER_build(digest, hash, (size_t)handle->digestSize) != 0)
+        {
+            /* Codes_SRS_HASH_01_024: [ If any error occurs, HASH_Final shall fail and return a non-zero value. ]*/
+            LogError("Cannot store the digest");
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_HASH_01_025: [ On success HASH_Final shall return 0. ]*/
+            result = 0;
+        }
+
+        (void)memset(hash, 0, sizeof(hash));
+    }
+
+    return result;
+}
+
+size_t HASH_GetDigestSize(HASH_HANDLE handle)
+{
+    size_t result;
+
+    if (handle == NULL)
+    {
+        /* Codes_SRS_HASH_01_026: [ If handle is NULL, HASH_GetDigestSize shall return 0. ]*/
+        LogError("Invalid argument: handle is NULL");
+        result = 0;
+    }
+    else
+    {
+        /* Codes_SRS_HASH_01_027: [ Otherwise HASH_GetDigestSize shall return the digest size of the algorithm in bytes. ]*/
+        result = (size_t)handle->digestSize;
+    }
+
+    return result;
+}
@@ -1,10 +1,215 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include "azure_c_shared_utility/hmacsha256.h"
 #include "azure_c_shared_utility/hmac.h"
 #include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/optimize_size.h"
+
+typedef struct HMACSHA256_KEY_TAG
+{
+    SHA256Context innerContext; /* state after hashing (K XOR ipad) */
+    SHA256Context outerContext; /* state after hashing (K XOR opad) */
+} HMACSHA256_KEY;
+
+/* computes one MAC from the precomputed pad states, digest receives SHA256HashSize bytes */
+static int compute_hash_from_key(const HMACSHA256_KEY* key, const unsigned char* payload, size_t payloadLen, unsigned char* digest)
+{
+    int result;
+    SHA256Context context = key->innerContext;
+
+    /* inner hash continues from the ipad midstate, its result is temporarily kept in digest */
+    if ((SHA256Input(&context, payload, (unsigned int)payloadLen) != shaSuccess) ||
+        (SHA256Result(&context, digest) != shaSuccess))
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        context = key->outerContext;
+        if ((SHA256Input(&context, digest, SHA256HashSize) != shaSuccess) ||
+            (SHA256Result(&context, digest) != shaSuccess))
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+
+    (void)memset(&context, 0, sizeof(context));
+    return result;
+}
+
+/* a lane of the batch signer: the payload it is signing and the blocks left to compress for it */
+typedef struct HMACSHA256_LANE_TAG
+{
+    size_t payloadIndex;
+    const unsigned char* nextBlock;     /* next whole block of the payload */
+    size_t wholeBlocks;                 /* whole payload blocks left */
+    unsigned char tail[2 * SHA256_Message_Block_Size]; /* padded end of the inner message, then the outer message */
+    size_t tailOffset;
+    size_t tailBlocks;                  /* tail blocks left */
+    int isOuter;
+} HMACSHA256_LANE;
+
+static void write_be32(unsigned char* destination, uint32_t value)
+{
+    destination[0] = (unsigned char)(value >> 24);
+    destination[1] = (unsigned char)(value >> 16);
+    destination[2] = (unsigned char)(value >> 8);
+    destination[3] = (unsigned char)value;
+}
+
+/* writes the 0x80 terminator, the zero fill and the 64 bit message length in bits, returns the number of blocks used */
+static size_t pad_tail(unsigned char* tail, size_t used, uint64_t messageLen)
+{
+    size_t blocks = (used < SHA256_Message_Block_Size - 8) ? 1 : 2;
+    size_t end = blocks * SHA256_Message_Block_Size;
+    uint64_t messageBits = messageLen * 8;
+
+    tail[used] = 0x80;
+    (void)memset(tail + used + 1, 0, end - 8 - (used + 1));
+    write_be32(tail + end - 8, (uint32_t)(messageBits >> 32));
+    write_be32(tail + end - 4, (uint32_t)messageBits);
+
+    return blocks;
+}
+
+/* points a lane at the inner hash of a payload, starting from the ipad midstate */
+static void start_lane(const HMACSHA256_KEY* key, const HMACSHA256_PAYLOAD* payloads, size_t payloadIndex, HMACSHA256_LANE* lane, uint32_t state[8][SHA256_LANES], size_t laneIndex)
+{
+    const HMACSHA256_PAYLOAD* payload = &payloads[payloadIndex];
+    size_t remainder = payload->payloadLen % SHA256_Message_Block_Size;
+    size_t i;
+
+    lane->payloadIndex = payloadIndex;
+    lane->nextBlock = payload->payload;
+    lane->wholeBlocks = payload->payloadLen / SHA256_Message_Block_Size;
+    (void)memcpy(lane->tail, payload->payload + (payload->payloadLen - remainder), remainder);
+    /* the inner message also holds the ipad block that the midstate already covers */
+    lane->tailBlocks = pad_tail(lane->tail, remainder, (uint64_t)SHA256_Message_Block_Size + payload->payloadLen);
+    lane->tailOffset = 0;
+    lane->isOuter = 0;
+
+    for (i = 0; i < 8; i++)
+    {
+        state[i][laneIndex] = key->innerContext.Intermediate_Hash[i];
+    }
+}
+
+/* turns a finished inner hash into the single outer block, starting from the opad midstate */
+static void start_outer(const HMACSHA256_KEY* key, HMACSHA256_LANE* lane, uint32_t state[8][SHA256_LANES], size_t laneIndex)
+{
+    size_t i;
+
+    for (i = 0; i < 8; i++)
+    {
+        write_be32(lane->tail + (i * 4), state[i][laneIndex]);
+        state[i][laneIndex] = key->outerContext.Intermediate_Hash[i];
+    }
+
+    lane->tailBlocks = pad_tail(lane->tail, SHA256HashSize, (uint64_t)SHA256_Message_Block_Size + SHA256HashSize);
+    lane->tailOffset = 0;
+    lane->isOuter = 1;
+}
+
+/* signs the payloads SHA256_LANES at a time, a lane that finishes picks up the next payload */
+static void compute_hashes_in_lanes(const HMACSHA256_KEY* key, const HMACSHA256_PAYLOAD* payloads, size_t payloadCount, unsigned char* digests)
+{
+    static const unsigned char idleBlock[SHA256_Message_Block_Size] = { 0 };
+    HMACSHA256_LANE lanes[SHA256_LANES];
+    uint32_t state[8][SHA256_LANES];
+    const uint8_t* blocks[SHA256_LANES];
+    size_t nextPayload = 0;
+    size_t busyLanes = 0;
+    size_t laneIndex;
+    size_t i;
+
+    for (laneIndex = 0; laneIndex < SHA256_LANES; laneIndex++)
+    {
+        if (nextPayload < payloadCount)
+        {
+            start_lane(key, payloads, nextPayload++, &lanes[laneIndex], state, laneIndex);
+            busyLanes++;
+        }
+        else
+        {
+            lanes[laneIndex].payloadIndex = payloadCount;
+        }
+    }
+
+    while (busyLanes > 0)
+    {
+        for (laneIndex = 0; laneIndex < SHA256_LANES; laneIndex++)
+        {
+            HMACSHA256_LANE* lane = &lanes[laneIndex];
+
+            if (lane->payloadIndex == payloadCount)
+            {
+                blocks[laneIndex] = idleBlock;
+            }
+            else if (lane->wholeBlocks > 0)
+            {
+                blocks[laneIndex] = lane->nextBlock;
+                lane->nextBlock += SHA256_Message_Block_Size;
+                lane->wholeBlocks--;
+            }
+            else
+            {
+                blocks[laneIndex] = lane->tail + lane->tailOffset;
+                lane->tailOffset += SHA256_Message_Block_Size;
+                lane->tailBlocks--;
+            }
+        }
+
+        SHA256CompressLanes(state, blocks);
+
+        for (laneIndex = 0; laneIndex < SHA256_LANES; laneIndex++)
+        {
+            HMACSHA256_LANE* lane = &lanes[laneIndex];
+
+            if ((lane->payloadIndex == payloadCount) ||
+                (lane->wholeBlocks > 0) ||
+                (lane->tailBlocks > 0))
+            {
+                /* idle, or still has blocks to compress */
+            }
+            else if (!lane->isOuter)
+            {
+                start_outer(key, lane, state, laneIndex);
+            }
+            else
+            {
+                for (i = 0; i < 8; i++)
+                {
+                    write_be32(digests + (lane->payloadIndex * SHA256HashSize) + (i * 4), state[i][laneIndex]);
+                }
+
+                if (nextPayload < payloadCount)
+                {
+                    start_lane(key, payloads, nextPayload++, lane, state, laneIndex);
+                }
+                else
+                {
+                    lane->payloadIndex = payloadCount;
+                    busyLanes--;
+                }
+            }
+        }
+    }
+
+    /* the lanes hold payload bytes and inner digests */
+    (void)memset(lanes, 0, sizeof(lanes));
+    (void)memset(state, 0, sizeof(state));
+}
 
 HMACSHA256_RESULT HMACSHA256_ComputeHash(const unsigned char* key, size_t keyLen, const unsigned char* payload, size_t payloadLen, BUFFER_HANDLE hash)
 {
@@ -33,3 +238,176 @@ HMACSHA256_RESULT HMACSHA256_ComputeHash(const unsigned char* key, size_t keyLen
 
     return result;
 }
+
+HMACSHA256_KEY_HANDLE HMACSHA256_CreateKey(const unsigned char* key, size_t keyLen)
+{
+    HMACSHA256_KEY* result;
+
+    if (key == NULL ||
+        keyLen == 0)
+    {
+        LogError("Invalid arguments: key = %p, keyLen = %lu", key, (unsigned long)keyLen);
+        result = NULL;
+    }
+    else if ((result = (HMACSHA256_KEY*)malloc(sizeof(HMACSHA256_KEY))) == NULL)
+    {
+        LogError("Cannot allocate memory for HMAC key");
+    }
+    else
+    {
+        unsigned char hashedKey[SHA256HashSize];
+        unsigned char k_ipad[SHA256_Message_Block_Size];
+        unsigned char k_opad[SHA256_Message_Block_Size];
+        size_t i;
+        int shaResult = shaSuccess;
+
+        /* keys longer than the block size are replaced by their hash, as in hmacReset */
+        if (keyLen > SHA256_Message_Block_Size)
+        {
+            SHA256Context keyContext;
+            shaResult = SHA256Reset(&keyContext) ||
+                SHA256Input(&keyContext, key, (unsigned int)keyLen) ||
+                SHA256Result(&keyContext, hashedKey);
+            key = hashedKey;
+            keyLen = SHA256HashSize;
+        }
+
+        for (i = 0; i < keyLen; i++)
+        {
+            k_ipad[i] = key[i] ^ 0x36;
+            k_opad[i] = key[i] ^ 0x5c;
+        }
+        for (; i < SHA256_Message_Block_Size; i++)
+        {
+            k_ipad[i] = 0x36;
+            k_opad[i] = 0x5c;
+        }
+
+        /* each pad is exactly one block, so both contexts are left with an empty Message_Block and can be copied as they are */
+        if ((shaResult != shaSuccess) ||
+            (SHA256Reset(&result->innerContext) != shaSuccess) ||
+            (SHA256Input(&result->innerContext, k_ipad, SHA256_Message_Block_Size) != shaSuccess) ||
+            (SHA256Reset(&result->outerContext) != shaSuccess) ||
+            (SHA256Input(&result->outerContext, k_opad, SHA256_Message_Block_Size) != shaSuccess))
+        {
+            LogError("Cannot compute the HMAC key pads");
+            free(result);
+            result = NULL;
+        }
+
+        (void)memset(hashedKey, 0, sizeof(hashedKey));
+        (void)memset(k_ipad, 0, sizeof(k_ipad));
+        (void)memset(k_opad, 0, sizeof(k_opad));
+    }
+
+    return result;
+}
+
+void HMACSHA256_DestroyKey(HMACSHA256_KEY_HANDLE keyHandle)
+{
+    if (keyHandle == NULL)
+    {
+        LogError("Invalid argument: keyHandle is NULL");
+    }
+    else
+    {
+        /* the midstates are as sensitive as the key itself */
+        (void)memset(keyHandle, 0, sizeof(HMACSHA256_KEY));
+        free(keyHandle);
+    }
+}
+
+HMACSHA256_RESULT HMACSHA256_ComputeHashWithKey(HMACSHA256_KEY_HANDLE keyHandle, const unsigned char* payload, size_t payloadLen, BUFFER_HANDLE hash)
+{
+    HMACSHA256_RESULT result;
+
+    if (keyHandle == NULL ||
+        payload == NULL ||
+        payloadLen == 0 ||
+        hash == NULL)
+    {
+        result = HMACSHA256_INVALID_ARG;
+    }
+    else if ((BUFFER_enlarge(hash, SHA256HashSize) != 0) ||
+        (compute_hash_from_key(keyHandle, payload, payloadLen, BUFFER_u_char(hash)) != 0))
+    {
+        result = HMACSHA256_ERROR;
+    }
+    else
+    {
+        result = HMACSHA256_OK;
+    }
+
+    return result;
+}
+
+HMACSHA256_RESULT HMACSHA256_ComputeHashBatch(HMACSHA256_KEY_HANDLE keyHandle, const HMACSHA256_PAYLOAD* payloads, size_t payloadCount, BUFFER_HANDLE hashes)
+{
+    HMACSHA256_RESULT result;
+
+    if (keyHandle == NULL ||
+        payloads == NULL ||
+        payloadCount == 0 ||
+        payloadCount > SIZE_MAX / SHA256HashSize ||
+        hashes == NULL)
+    {
+        LogError("Invalid arguments: keyHandle = %p, payloads = %p, payloadCount = %lu, hashes = %p", keyHandle, payloads, (unsigned long)payloadCount, hashes);
+        result = HMACSHA256_INVALID_ARG;
+    }
+    else
+    {
+        size_t i;
+
+        /* every entry is checked before anything is appended, so a bad entry leaves hashes untouched */
+        for (i = 0; i < payloadCount; i++)
+        {
+            if ((payloads[i].payload == NULL) ||
+                (payloads[i].payloadLen == 0))
+            {
+                break;
+            }
+        }
+
+        if (i < payloadCount)
+        {
+            LogError("Invalid payload at index %lu", (unsigned long)i);
+            result = HMACSHA256_INVALID_ARG;
+        }
+        else
+        {
+            size_t previousSize;
+
+            if ((BUFFER_size(hashes, &previousSize) != 0) ||
+                (BUFFER_enlarge(hashes, payloadCount * SHA256HashSize) != 0))
+            {
+                LogError("Cannot make room for %lu hashes", (unsigned long)payloadCount);
+                result = HMACSHA256_ERROR;
+            }
+            else
+            {
+                unsigned char* digests = BUFFER_u_char(hashes) + previousSize;
+
+                result = HMACSHA256_OK;
+                if (payloadCount < SHA256_LANES)
+                {
+                    /* too few payloads to fill the lanes, the scalar path is cheaper */
+                    for (i = 0; i < payloadCount; i++)
+                    {
+                        if (compute_hash_from_key(keyHandle, payloads[i].payload, payloads[i].payloadLen, digests + (i * SHA256HashSize)) != 0)
+                        {
+                            LogError("Cannot compute the hash of payload %lu", (unsigned long)i);
+                            result = HMACSHA256_ERROR;
+                            break;
+                        }
+                    }
+                }
+                else
+                {
+                    compute_hashes_in_lanes(keyHandle, payloads, payloadCount, digests);
+                }
+            }
+        }
+    }
+
+    return result;
+}
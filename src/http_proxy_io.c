@@ -13,6 +13,7 @@
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/http_proxy_io.h"
 #include "azure_c_shared_utility/base64.h"
+#include "azure_c_shared_utility/http_response_parser.h"
 
 typedef enum HTTP_PROXY_IO_STATE_TAG
 {
@@ -42,8 +43,8 @@ typedef struct HTTP_PROXY_IO_INSTANCE_TAG
     char* username;
     char* password;
     XIO_HANDLE underlying_io;
-    unsigned char* receive_buffer;
-    size_t receive_buffer_size;
+    HTTP_RESPONSE_PARSER_HANDLE connect_response_parser;
+    int connect_response_status_code;
 } HTTP_PROXY_IO_INSTANCE;
 
 static CONCRETE_IO_HANDLE http_proxy_io_create(void* io_create_parameters)
@@ -185,8 +186,7 @@ static CONCRETE_IO_HANDLE http_proxy_io_create(void* io_create_parameters)
                                         result->port = http_proxy_io_config->port;
                                         result->proxy_port = http_proxy_io_config->proxy_port;
                                         LogInfo("%s: Setting up proxy with host:port %s:%d", __FUNCTION__, http_proxy_io_config->proxy_hostname, http_proxy_io_config->proxy_port);
-                                        result->receive_buffer = NULL;
-                                        result->receive_buffer_size = 0;
+                                        result->connect_response_parser = NULL;
                                         result->http_proxy_io_state = HTTP_PROXY_IO_STATE_CLOSED;
                                     }
                                 }
@@ -213,9 +213,9 @@ static void http_proxy_io_destroy(CONCRETE_IO_HANDLE http_proxy_io)
         HTTP_PROXY_IO_INSTANCE* http_proxy_io_instance = (HTTP_PROXY_IO_INSTANCE*)http_proxy_io;
 
         /* Codes_SRS_HTTP_PROXY_IO_01_013: [ `http_proxy_io_destroy` shall free the HTTP proxy IO instance indicated by `http_proxy_io`. ]*/
-        if (http_proxy_io_instance->receive_buffer != NULL)
+        if (http_proxy_io_instance->connect_response_parser != NULL)
         {
-            free(http_proxy_io_instance->receive_buffer);
+            http_response_parser_destroy(http_proxy_io_instance->connect_response_parser);
         }
 
         /* Codes_SRS_HTTP_PROXY_IO_01_016: [ `http_proxy_io_destroy` shall destroy the underlying IO created in `http_proxy_io_create` by calling `xio_destroy`. ]*/
@@ -523,101 +523,36 @@ static void on_underlying_io_close_complete(void* context)
     }
 }
 
-/*the following function does the same as sscanf(pos2, "%d", &sec)*/
-/*this function only exists because some of platforms do not have sscanf. */
-static int ParseStringToDecimal(const char *src, int* dst)
+static int on_connect_response_status(void* context, int status_code, const char* reason_phrase, size_t reason_phrase_length)
 {
-    int result;
-    char* next;
-
-    (*dst) = (int)strtol(src, &next, 0);
-    if ((src == next) || ((((*dst) == INT_MAX) || ((*dst) == INT_MIN)) && (errno != 0)))
-    {
-        result = __LINE__;
-    }
-    else
-    {
-        result = 0;
-    }
+    HTTP_PROXY_IO_INSTANCE* http_proxy_io_instance = (HTTP_PROXY_IO_INSTANCE*)context;
+    (void)reason_phrase;
+    (void)reason_phrase_length;
 
-    return result;
+    http_proxy_io_instance->connect_response_status_code = status_code;
+    return 0;
 }
 
-/*the following function does the same as sscanf(buf, "HTTP/%*d.%*d %d %*[^\r\n]", &ret) */
-/*this function only exists because some of platforms do not have sscanf. This is not a full implementation; it only works with well-defined HTTP response. */
-static int ParseHttpResponse(const char* src, int* dst)
+static int on_connect_response_headers_complete(void* context, size_t content_length, bool chunked, bool* has_body)
 {
-    int result;
-    static const char HTTPPrefix[] = "HTTP/";
-    bool fail;
-    const char* runPrefix;
-
-    if ((src == NULL) || (dst == NULL))
-    {
-        result = __LINE__;
-    }
-    else
-    {
-        fail = false;
-        runPrefix = HTTPPrefix;
-
-        while ((*runPrefix) != '\0')
-        {
-            if ((*runPrefix) != (*src))
-            {
-                fail = true;
-                break;
-            }
-            src++;
-            runPrefix++;
-        }
-
-        if (!fail)
-        {
-            while ((*src) != '.')
-            {
-                if ((*src) == '\0')
-                {
-                    fail = true;
-                    break;
-                }
-                src++;
-            }
-        }
-
-        if (!fail)
-        {
-            while ((*src) != ' ')
-            {
-                if ((*src) == '\0')
-                {
-                    fail = true;
-                    break;
-                }
-                src++;
-            }
-        }
-
-        if (fail)
-        {
-            result = __LINE__;
-        }
-        else
-        {
-            if (ParseStringToDecimal(src, dst) != 0)
-            {
-                result = __LINE__;
-            }
-            else
-            {
-                result = 0;
-            }
-        }
-    }
+    (void)context;
+    (void)content_length;
+    (void)chunked;
 
-    return result;
+    /* Everything after the headers of the CONNECT response belongs to the tunnel. */
+    *has_body = false;
+    return 0;
 }
 
+static const HTTP_RESPONSE_PARSER_CALLBACKS connect_response_parser_callbacks =
+{
+    on_connect_response_status,
+    NULL,
+    on_connect_response_headers_complete,
+    NULL,
+    NULL
+};
+
 static void on_underlying_io_bytes_received(void* context, const unsigned char* buffer, size_t size)
 {
     IO_OPEN_RESULT_DETAILED open_result_detailed;
@@ -648,43 +583,27 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
 
         case HTTP_PROXY_IO_STATE_WAITING_FOR_CONNECT_RESPONSE:
         {
-            /* Codes_SRS_HTTP_PROXY_IO_01_065: [ When bytes are received and the response to the CONNECT request was not yet received, the bytes shall be accumulated until a double new-line is detected. ]*/
-            unsigned char* new_receive_buffer = (unsigned char*)realloc(http_proxy_io_instance->receive_buffer, http_proxy_io_instance->receive_buffer_size + size + 1);
-            if (new_receive_buffer == NULL)
+            /* Codes_SRS_HTTP_PROXY_IO_01_065: [ When bytes are received and the response to the CONNECT request was not yet received, the bytes shall be fed to an HTTP response parser created with `http_response_parser_create` on the first received bytes. ]*/
+            if ((http_proxy_io_instance->connect_response_parser == NULL) &&
+                ((http_proxy_io_instance->connect_response_parser = http_response_parser_create(&connect_response_parser_callbacks, http_proxy_io_instance)) == NULL))
             {
-                /* Codes_SRS_HTTP_PROXY_IO_01_067: [ If allocating memory for the buffered bytes fails, the `on_open_complete` callback shall be triggered with `IO_OPEN_ERROR`, passing also the `on_open_complete_context` argument as `context`. ]*/
-                LogError("Cannot allocate memory for received data");
+                /* Codes_SRS_HTTP_PROXY_IO_01_067: [ If creating the HTTP response parser fails, the `on_open_complete` callback shall be triggered with `IO_OPEN_ERROR`, passing also the `on_open_complete_context` argument as `context`. ]*/
+                LogError("Cannot create the CONNECT response parser");
                 open_result_detailed.code = __FAILURE__;
                 indicate_open_complete_error_and_close(http_proxy_io_instance, open_result_detailed);
             }
             else
             {
-                http_proxy_io_instance->receive_buffer = new_receive_buffer;
-                memcpy(http_proxy_io_instance->receive_buffer + http_proxy_io_instance->receive_buffer_size, buffer, size);
-                http_proxy_io_instance->receive_buffer_size += size;
-            }
+                size_t bytes_consumed;
+                HTTP_RESPONSE_PARSER_RESULT parse_result = http_response_parser_feed(http_proxy_io_instance->connect_response_parser, buffer, size, &bytes_consumed);
 
-            if (http_proxy_io_instance->receive_buffer_size >= 4)
-            {
-                const char* request_end_ptr;
-#ifdef _MSC_VER
-// Disable: Buffer overrun while writing to 'http_proxy_io_instance->receive_buffer':  the writable size is 'http_proxy_io_instance->receive_buffer_size+size+1' bytes, but 'http_proxy_io_instance->receive_buffer_size' bytes might be written.
-#pragma warning(disable:6386)
-#endif
-                http_proxy_io_instance->receive_buffer[http_proxy_io_instance->receive_buffer_size] = 0;
-#ifdef _MSC_VER
-#pragma warning(default:6386)
-#endif
-                /* Codes_SRS_HTTP_PROXY_IO_01_066: [ When a double new-line is detected the response shall be parsed in order to extract the status code. ]*/
-                if ((http_proxy_io_instance->receive_buffer_size >= 4) &&
-                    ((request_end_ptr = strstr((const char*)http_proxy_io_instance->receive_buffer, "\r\n\r\n")) != NULL))
+                /* Codes_SRS_HTTP_PROXY_IO_01_066: [ When the parser reports the whole response, the status code shall be checked and the parser shall be destroyed. ]*/
+                if (parse_result != HTTP_RESPONSE_PARSER_NEED_MORE_DATA)
                 {
-                    int status_code;
-
-                    /* This part should really be done with the HTTPAPI, but that has to be done as a separate step
-                    as the HTTPAPI has to expose somehow the underlying IO and currently this would be a too big of a change. */
+                    http_response_parser_destroy(http_proxy_io_instance->connect_response_parser);
+                    http_proxy_io_instance->connect_response_parser = NULL;
 
-                    if (ParseHttpResponse((const char*)http_proxy_io_instance->receive_buffer, &status_code) != 0)
+                    if (parse_result != HTTP_RESPONSE_PARSER_COMPLETE)
                     {
                         /* Codes_SRS_HTTP_PROXY_IO_01_068: [ If parsing the CONNECT response fails, the `on_open_complete` callback shall be triggered with `IO_OPEN_ERROR`, passing also the `on_open_complete_context` argument as `context`. ]*/
                         LogError("Cannot decode HTTP response");
@@ -693,16 +612,16 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                     }
                     /* Codes_SRS_HTTP_PROXY_IO_01_069: [ Any successful (2xx) response to a CONNECT request indicates that the proxy has established a connection to the requested host and port, and has switched to tunneling the current connection to that server connection. ]*/
                     /* Codes_SRS_HTTP_PROXY_IO_01_090: [ Any successful (2xx) response to a CONNECT request indicates that the proxy has established a connection to the requested host and port, and has switched to tunneling the current connection to that server connection. ]*/
-                    else if ((status_code < 200) || (status_code > 299))
+                    else if ((http_proxy_io_instance->connect_response_status_code < 200) || (http_proxy_io_instance->connect_response_status_code > 299))
                     {
                         /* Codes_SRS_HTTP_PROXY_IO_01_071: [ If the status code is not successful, the `on_open_complete` callback shall be triggered with `IO_OPEN_ERROR`, passing also the `on_open_complete_context` argument as `context`. ]*/
-                        LogError("Bad status (%d) received in CONNECT response", status_code);
+                        LogError("Bad status (%d) received in CONNECT response", http_proxy_io_instance->connect_response_status_code);
                         open_result_detailed.code = __FAILURE__;
                         indicate_open_complete_error_and_close(http_proxy_io_instance, open_result_detailed);
                     }
                     else
                     {
-                        size_t length_remaining = http_proxy_io_instance->receive_buffer + http_proxy_io_instance->receive_buffer_size - ((const unsigned char *)request_end_ptr + 4);
+                        size_t length_remaining = size - bytes_consumed;
                         IO_OPEN_RESULT_DETAILED ok_result = { IO_OPEN_OK, 0 };
 
                         /* Codes_SRS_HTTP_PROXY_IO_01_073: [ Once a success status code was parsed, the IO shall be OPEN. ]*/
@@ -713,7 +632,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                         if (length_remaining > 0)
                         {
                             /* Codes_SRS_HTTP_PROXY_IO_01_072: [ Any bytes that are extra (not consumed by the CONNECT response), shall be indicated as received by calling the `on_bytes_received` callback and passing the `on_bytes_received_context` as context argument. ]*/
-                            http_proxy_io_instance->on_bytes_received(http_proxy_io_instance->on_bytes_received_context, (const unsigned char*)request_end_ptr + 4, length_remaining);
+                            http_proxy_io_instance->on_bytes_received(http_proxy_io_instance->on_bytes_received_context, buffer + bytes_consumed, length_remaining);
                         }
                     }
                 }
@@ -768,6 +687,12 @@ static int http_proxy_io_open(CONCRETE_IO_HANDLE http_proxy_io, ON_IO_OPEN_COMPL
 
             http_proxy_io_instance->http_proxy_io_state = HTTP_PROXY_IO_STATE_OPENING_UNDERLYING_IO;
 
+            /* Codes_SRS_HTTP_PROXY_IO_01_096: [ `http_proxy_io_open` shall discard any partially parsed CONNECT response left from a previous open. ]*/
+            if (http_proxy_io_instance->connect_response_parser != NULL)
+            {
+                (void)http_response_parser_reset(http_proxy_io_instance->connect_response_parser);
+            }
+
             /* Codes_SRS_HTTP_PROXY_IO_01_019: [ `http_proxy_io_open` shall open the underlying IO by calling `xio_open` on the underlying IO handle created in `http_proxy_io_create`, while passing to it the callbacks `on_underlying_io_open_complete`, `on_underlying_io_bytes_received` and `on_underlying_io_error`. ]*/
             if (xio_open(http_proxy_io_instance->underlying_io, on_underlying_io_open_complete, http_proxy_io_instance, on_underlying_io_bytes_received, http_proxy_io_instance, on_underlying_io_error, http_proxy_io_instance) != 0)
             {
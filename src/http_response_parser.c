@@ -0,0 +1,637 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/http_response_parser.h"
+
+#define INITIAL_LINE_CAPACITY 128
+
+typedef enum HTTP_RESPONSE_PARSER_STATE_TAG
+{
+    HTTP_RESPONSE_PARSER_STATE_STATUS_LINE,
+    HTTP_RESPONSE_PARSER_STATE_HEADER_LINE,
+    HTTP_RESPONSE_PARSER_STATE_BODY,
+    HTTP_RESPONSE_PARSER_STATE_CHUNK_SIZE,
+    HTTP_RESPONSE_PARSER_STATE_CHUNK_DATA,
+    HTTP_RESPONSE_PARSER_STATE_CHUNK_DATA_END,
+    HTTP_RESPONSE_PARSER_STATE_TRAILER_LINE,
+    HTTP_RESPONSE_PARSER_STATE_COMPLETE,
+    HTTP_RESPONSE_PARSER_STATE_ERROR
+} HTTP_RESPONSE_PARSER_STATE;
+
+typedef struct HTTP_RESPONSE_PARSER_INSTANCE_TAG
+{
+    HTTP_RESPONSE_PARSER_CALLBACKS callbacks;
+    void* callback_context;
+    HTTP_RESPONSE_PARSER_STATE state;
+    /* holds a line only while it is split across calls to http_response_parser_feed */
+    char* line;
+    size_t line_length;
+    size_t line_capacity;
+    size_t content_length;
+    size_t remaining_body_bytes;
+    bool chunked;
+} HTTP_RESPONSE_PARSER_INSTANCE;
+
+static const char CONTENT_LENGTH_HEADER[] = "content-length";
+static const char TRANSFER_ENCODING_HEADER[] = "transfer-encoding";
+static const char CHUNKED_CODING[] = "chunked";
+
+#define IS_OWS(c) (((c) == ' ') || ((c) == '\t'))
+#define HEX_DIGIT_VALUE(c) ((((c) >= '0') && ((c) <= '9')) ? ((c) - '0') : (((c) >= 'a') && ((c) <= 'f')) ? ((c) - 'a' + 10) : (((c) >= 'A') && ((c) <= 'F')) ? ((c) - 'A' + 10) : -1)
+#define TO_LOWER(c) ((((c) >= 'A') && ((c) <= 'Z')) ? ((c) - 'A' + 'a') : (c))
+
+static bool equals_ignore_case(const char* text, size_t text_length, const char* lowercase_literal, size_t literal_length)
+{
+    bool result;
+
+    if (text_length != literal_length)
+    {
+        result = false;
+    }
+    else
+    {
+        size_t i;
+        for (i = 0; i < text_length; i++)
+        {
+            if (TO_LOWER(text[i]) != lowercase_literal[i])
+            {
+                break;
+            }
+        }
+
+        result = (i == text_length);
+    }
+
+    return result;
+}
+
+static int parse_decimal(const char* text, size_t text_length, size_t* value)
+{
+    int result;
+
+    if (text_length == 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t i;
+        *value = 0;
+        result = 0;
+        for (i = 0; i < text_length; i++)
+        {
+            if ((text[i] < '0') || (text[i] > '9') ||
+                (*value > ((SIZE_MAX - 9) / 10)))
+            {
+                result = __FAILURE__;
+                break;
+            }
+
+            *value = (*value * 10) + (size_t)(text[i] - '0');
+        }
+    }
+
+    return result;
+}
+
+static int parse_status_line(HTTP_RESPONSE_PARSER_INSTANCE* instance, const char* line, size_t line_length)
+{
+    int result;
+    static const char HTTP_PREFIX[] = "HTTP/";
+    const size_t http_prefix_length = sizeof(HTTP_PREFIX) - 1;
+    const char* line_end = line + line_length;
+    const char* code_start;
+
+    /* Codes_SRS_HTTP_RESPONSE_PARSER_01_010: [ The status line shall start with `HTTP/`, followed by the protocol version, one or more spaces and a decimal status code. ]*/
+    if ((line_length <= http_prefix_length) ||
+        (memcmp(line, HTTP_PREFIX, http_prefix_length) != 0) ||
+        ((code_start = (const char*)memchr(line, ' ', line_length)) == NULL))
+    {
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_011: [ If the status line cannot be parsed, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+        LogError("Invalid HTTP status line");
+        result = __FAILURE__;
+    }
+    else
+    {
+        const char* code_end;
+        size_t status_code;
+
+        while ((code_start < line_end) && IS_OWS(*code_start))
+        {
+            code_start++;
+        }
+
+        code_end = code_start;
+        while ((code_end < line_end) && (*code_end >= '0') && (*code_end <= '9'))
+        {
+            code_end++;
+        }
+
+        if ((parse_decimal(code_start, (size_t)(code_end - code_start), &status_code) != 0) ||
+            (status_code > INT_MAX) ||
+            ((code_end < line_end) && !IS_OWS(*code_end)))
+        {
+            /* Codes_SRS_HTTP_RESPONSE_PARSER_01_011: [ If the status line cannot be parsed, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+            LogError("Invalid status code in HTTP status line");
+            result = __FAILURE__;
+        }
+        else
+        {
+            const char* reason_phrase = code_end;
+            while ((reason_phrase < line_end) && IS_OWS(*reason_phrase))
+            {
+                reason_phrase++;
+            }
+
+            /* Codes_SRS_HTTP_RESPONSE_PARSER_01_012: [ The status code and a view over the reason phrase, without the leading spaces, shall be passed to `on_status`. ]*/
+            if ((instance->callbacks.on_status != NULL) &&
+                (instance->callbacks.on_status(instance->callback_context, (int)status_code, reason_phrase, (size_t)(line_end - reason_phrase)) != 0))
+            {
+                /* Codes_SRS_HTTP_RESPONSE_PARSER_01_030: [ If any callback returns non-zero, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+                LogError("on_status failed");
+                result = __FAILURE__;
+            }
+            else
+            {
+                instance->state = HTTP_RESPONSE_PARSER_STATE_HEADER_LINE;
+                result = 0;
+            }
+        }
+    }
+
+    return result;
+}
+
+static int end_of_headers(HTTP_RESPONSE_PARSER_INSTANCE* instance)
+{
+    int result;
+    /* Codes_SRS_HTTP_RESPONSE_PARSER_01_017: [ The response shall have a body when it is chunked or when its `Content-Length` is not zero; responses without either framing header have no body. ]*/
+    bool has_body = instance->chunked || (instance->content_length > 0);
+
+    /* Codes_SRS_HTTP_RESPONSE_PARSER_01_016: [ On the empty line that ends the headers, `on_headers_complete` shall be called with the content length, whether the body is chunked and the `has_body` flag. ]*/
+    if ((instance->callbacks.on_headers_complete != NULL) &&
+        (instance->callbacks.on_headers_complete(instance->callback_context, instance->content_length, instance->chunked, &has_body) != 0))
+    {
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_030: [ If any callback returns non-zero, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+        LogError("on_headers_complete failed");
+        result = __FAILURE__;
+    }
+    else
+    {
+        if (!has_body)
+        {
+            /* Codes_SRS_HTTP_RESPONSE_PARSER_01_018: [ If `has_body` is false after `on_headers_complete` returns, the response shall be complete right after the headers. ]*/
+            instance->state = HTTP_RESPONSE_PARSER_STATE_COMPLETE;
+        }
+        else if (instance->chunked)
+        {
+            instance->state = HTTP_RESPONSE_PARSER_STATE_CHUNK_SIZE;
+        }
+        else
+        {
+            instance->remaining_body_bytes = instance->content_length;
+            instance->state = (instance->content_length == 0) ? HTTP_RESPONSE_PARSER_STATE_COMPLETE : HTTP_RESPONSE_PARSER_STATE_BODY;
+        }
+
+        result = 0;
+    }
+
+    return result;
+}
+
+static int parse_header_line(HTTP_RESPONSE_PARSER_INSTANCE* instance, const char* line, size_t line_length)
+{
+    int result;
+    const char* colon;
+
+    if (line_length == 0)
+    {
+        result = end_of_headers(instance);
+    }
+    else if ((colon = (const char*)memchr(line, ':', line_length)) == NULL)
+    {
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_015: [ Header lines without a colon shall be ignored. ]*/
+        result = 0;
+    }
+    else
+    {
+        const char* line_end = line + line_length;
+        const char* value = colon + 1;
+        size_t name_length = (size_t)(colon - line);
+        size_t value_length;
+
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_013: [ For each header line, a view over the name and a view over the value, without leading and trailing whitespace, shall be passed to `on_header`. ]*/
+        while ((value < line_end) && IS_OWS(*value))
+        {
+            value++;
+        }
+        while ((line_end > value) && IS_OWS(line_end[-1]))
+        {
+            line_end--;
+        }
+        value_length = (size_t)(line_end - value);
+
+        result = 0;
+
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_014: [ The `Content-Length` and `Transfer-Encoding` headers shall be matched case-insensitively and used to frame the body. ]*/
+        if (equals_ignore_case(line, name_length, CONTENT_LENGTH_HEADER, sizeof(CONTENT_LENGTH_HEADER) - 1))
+        {
+            if (parse_decimal(value, value_length, &instance->content_length) != 0)
+            {
+                /* Codes_SRS_HTTP_RESPONSE_PARSER_01_019: [ If the `Content-Length` value is not a decimal number, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+                LogError("Invalid Content-Length header");
+                result = __FAILURE__;
+            }
+        }
+        else if (equals_ignore_case(line, name_length, TRANSFER_ENCODING_HEADER, sizeof(TRANSFER_ENCODING_HEADER) - 1))
+        {
+            /* chunked is always the last transfer coding applied */
+            const size_t chunked_length = sizeof(CHUNKED_CODING) - 1;
+            instance->chunked = (value_length >= chunked_length) &&
+                equals_ignore_case(value + value_length - chunked_length, chunked_length, CHUNKED_CODING, chunked_length) &&
+                ((value_length == chunked_length) || IS_OWS(value[value_length - chunked_length - 1]) || (value[value_length - chunked_length - 1] == ','));
+        }
+
+        if ((result == 0) &&
+            (instance->callbacks.on_header != NULL) &&
+            (instance->callbacks.on_header(instance->callback_context, line, name_length, value, value_length) != 0))
+        {
+            /* Codes_SRS_HTTP_RESPONSE_PARSER_01_030: [ If any callback returns non-zero, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+            LogError("on_header failed");
+            result = __FAILURE__;
+        }
+    }
+
+    return result;
+}
+
+static int parse_chunk_size_line(HTTP_RESPONSE_PARSER_INSTANCE* instance, const char* line, size_t line_length)
+{
+    int result;
+    size_t chunk_size = 0;
+    size_t i;
+
+    /* Codes_SRS_HTTP_RESPONSE_PARSER_01_021: [ Each chunk shall start with a line holding its size in hexadecimal, optionally followed by chunk extensions, which shall be ignored. ]*/
+    for (i = 0; i < line_length; i++)
+    {
+        int digit_value = HEX_DIGIT_VALUE(line[i]);
+        if ((digit_value < 0) ||
+            (chunk_size > (SIZE_MAX >> 4)))
+        {
+            break;
+        }
+        chunk_size = (chunk_size << 4) | (size_t)digit_value;
+    }
+
+    if ((i == 0) ||
+        ((i < line_length) && (line[i] != ';') && !IS_OWS(line[i])))
+    {
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_022: [ If a chunk size cannot be parsed, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+        LogError("Invalid chunk size");
+        result = __FAILURE__;
+    }
+    else if (chunk_size == 0)
+    {
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_024: [ A chunk of size zero shall end the body; the trailer lines that follow it shall be skipped up to the empty line that completes the response. ]*/
+        instance->state = HTTP_RESPONSE_PARSER_STATE_TRAILER_LINE;
+        result = 0;
+    }
+    else
+    {
+        instance->remaining_body_bytes = chunk_size;
+        instance->state = HTTP_RESPONSE_PARSER_STATE_CHUNK_DATA;
+        result = 0;
+    }
+
+    return result;
+}
+
+static int process_line(HTTP_RESPONSE_PARSER_INSTANCE* instance, const char* line, size_t line_length)
+{
+    int result;
+
+    /* Codes_SRS_HTTP_RESPONSE_PARSER_01_008: [ Lines shall end with LF; a CR right before the LF shall not be part of the line. ]*/
+    if ((line_length > 0) && (line[line_length - 1] == '\r'))
+    {
+        line_length--;
+    }
+
+    switch (instance->state)
+    {
+    case HTTP_RESPONSE_PARSER_STATE_STATUS_LINE:
+        result = parse_status_line(instance, line, line_length);
+        break;
+
+    case HTTP_RESPONSE_PARSER_STATE_HEADER_LINE:
+        result = parse_header_line(instance, line, line_length);
+        break;
+
+    case HTTP_RESPONSE_PARSER_STATE_CHUNK_SIZE:
+        result = parse_chunk_size_line(instance, line, line_length);
+        break;
+
+    case HTTP_RESPONSE_PARSER_STATE_CHUNK_DATA_END:
+        if (line_length != 0)
+        {
+            /* Codes_SRS_HTTP_RESPONSE_PARSER_01_025: [ If the chunk data is not followed by an empty line, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+            LogError("Chunk data is not terminated by CRLF");
+            result = __FAILURE__;
+        }
+        else
+        {
+            instance->state = HTTP_RESPONSE_PARSER_STATE_CHUNK_SIZE;
+            result = 0;
+        }
+        break;
+
+    case HTTP_RESPONSE_PARSER_STATE_TRAILER_LINE:
+        if (line_length == 0)
+        {
+            instance->state = HTTP_RESPONSE_PARSER_STATE_COMPLETE;
+        }
+        result = 0;
+        break;
+
+    default:
+        LogError("Line received in invalid state");
+        result = __FAILURE__;
+        break;
+    }
+
+    return result;
+}
+
+static int append_to_line(HTTP_RESPONSE_PARSER_INSTANCE* instance, const unsigned char* bytes, size_t size)
+{
+    int result;
+
+    if (size > (HTTP_RESPONSE_PARSER_MAX_LINE_LENGTH - instance->line_length))
+    {
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_009: [ If a line is longer than `HTTP_RESPONSE_PARSER_MAX_LINE_LENGTH`, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+        LogError("HTTP response line is too long");
+        result = __FAILURE__;
+    }
+    else
+    {
+        if (instance->line_length + size > instance->line_capacity)
+        {
+            size_t new_capacity = (instance->line_capacity == 0) ? INITIAL_LINE_CAPACITY : instance->line_capacity;
+            char* new_line;
+
+            while (new_capacity < instance->line_length + size)
+            {
+                new_capacity *= 2;
+            }
+
+            if ((new_line = (char*)realloc(instance->line, new_capacity)) == NULL)
+            {
+                /* Codes_SRS_HTTP_RESPONSE_PARSER_01_031: [ If any other error occurs, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+                LogError("Cannot grow the line buffer");
+                result = __FAILURE__;
+            }
+            else
+            {
+                instance->line = new_line;
+                instance->line_capacity = new_capacity;
+                result = 0;
+            }
+        }
+        else
+        {
+            result = 0;
+        }
+
+        if (result == 0)
+        {
+            (void)memcpy(instance->line + instance->line_length, bytes, size);
+            instance->line_length += size;
+        }
+    }
+
+    return result;
+}
+
+/* Consumes up to one line from [position, end) and returns how many bytes were used, or 0 on failure. */
+static size_t feed_line(HTTP_RESPONSE_PARSER_INSTANCE* instance, const unsigned char* position, const unsigned char* end)
+{
+    size_t result;
+    const unsigned char* line_feed = (const unsigned char*)memchr(position, '\n', (size_t)(end - position));
+
+    if (line_feed == NULL)
+    {
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_007: [ A line split across calls to `http_response_parser_feed` shall be kept by the parser until its end is received. ]*/
+        result = (append_to_line(instance, position, (size_t)(end - position)) != 0) ? 0 : (size_t)(end - position);
+    }
+    else if (instance->line_length == 0)
+    {
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_006: [ Lines received whole shall be parsed in place, without copying them. ]*/
+        if (((size_t)(line_feed - position) > HTTP_RESPONSE_PARSER_MAX_LINE_LENGTH) ||
+            (process_line(instance, (const char*)position, (size_t)(line_feed - position)) != 0))
+        {
+            result = 0;
+        }
+        else
+        {
+            result = (size_t)(line_feed - position) + 1;
+        }
+    }
+    else
+    {
+        if ((append_to_line(instance, position, (size_t)(line_feed - position)) != 0) ||
+            (process_line(instance, instance->line, instance->line_length) != 0))
+        {
+            result = 0;
+        }
+        else
+        {
+            result = (size_t)(line_feed - position) + 1;
+        }
+
+        instance->line_length = 0;
+    }
+
+    return result;
+}
+
+HTTP_RESPONSE_PARSER_HANDLE http_response_parser_create(const HTTP_RESPONSE_PARSER_CALLBACKS* callbacks, void* callback_context)
+{
+    HTTP_RESPONSE_PARSER_INSTANCE* result;
+
+    if (callbacks == NULL)
+    {
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_002: [ If `callbacks` is NULL, `http_response_parser_create` shall fail and return NULL. ]*/
+        LogError("NULL callbacks");
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_001: [ `http_response_parser_create` shall allocate a parser that reports the response parts through `callbacks`, passing `callback_context` to each of them, and that is ready to parse a status line. ]*/
+        result = (HTTP_RESPONSE_PARSER_INSTANCE*)malloc(sizeof(HTTP_RESPONSE_PARSER_INSTANCE));
+        if (result == NULL)
+        {
+            /* Codes_SRS_HTTP_RESPONSE_PARSER_01_003: [ If allocating memory fails, `http_response_parser_create` shall fail and return NULL. ]*/
+            LogError("Cannot allocate memory for the HTTP response parser");
+        }
+        else
+        {
+            result->callbacks = *callbacks;
+            result->callback_context = callback_context;
+            result->line = NULL;
+            result->line_capacity = 0;
+            (void)http_response_parser_reset(result);
+        }
+    }
+
+    return result;
+}
+
+void http_response_parser_destroy(HTTP_RESPONSE_PARSER_HANDLE http_response_parser)
+{
+    if (http_response_parser == NULL)
+    {
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_005: [ If `http_response_parser` is NULL, `http_response_parser_destroy` shall do nothing. ]*/
+        LogError("NULL http_response_parser");
+    }
+    else
+    {
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_004: [ `http_response_parser_destroy` shall free all resources associated with the parser. ]*/
+        free(http_response_parser->line);
+        free(http_response_parser);
+    }
+}
+
+int http_response_parser_reset(HTTP_RESPONSE_PARSER_HANDLE http_response_parser)
+{
+    int result;
+
+    if (http_response_parser == NULL)
+    {
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_041: [ If `http_response_parser` is NULL, `http_response_parser_reset` shall fail and return a non-zero value. ]*/
+        LogError("NULL http_response_parser");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_040: [ `http_response_parser_reset` shall discard any partially parsed response and prepare the parser for a new status line, keeping its line buffer for reuse. ]*/
+        http_response_parser->state = HTTP_RESPONSE_PARSER_STATE_STATUS_LINE;
+        http_response_parser->line_length = 0;
+        http_response_parser->content_length = 0;
+        http_response_parser->remaining_body_bytes = 0;
+        http_response_parser->chunked = false;
+        result = 0;
+    }
+
+    return result;
+}
+
+HTTP_RESPONSE_PARSER_RESULT http_response_parser_feed(HTTP_RESPONSE_PARSER_HANDLE http_response_parser, const unsigned char* buffer, size_t size, size_t* bytes_consumed)
+{
+    HTTP_RESPONSE_PARSER_RESULT result;
+
+    if ((http_response_parser == NULL) ||
+        ((buffer == NULL) && (size > 0)) ||
+        (bytes_consumed == NULL))
+    {
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_051: [ If `http_response_parser` or `bytes_consumed` is NULL, or `buffer` is NULL while `size` is not zero, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+        LogError("Invalid arguments: http_response_parser = %p, buffer = %p, size = %lu, bytes_consumed = %p",
+            http_response_parser, buffer, (unsigned long)size, bytes_consumed);
+        result = HTTP_RESPONSE_PARSER_ERROR;
+    }
+    else
+    {
+        const unsigned char* position = buffer;
+        const unsigned char* end = buffer + size;
+
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_050: [ `http_response_parser_feed` shall parse the `size` bytes in `buffer`, which may end anywhere in the response, and shall continue from where the previous call stopped. ]*/
+        while ((position < end) &&
+            (http_response_parser->state != HTTP_RESPONSE_PARSER_STATE_COMPLETE) &&
+            (http_response_parser->state != HTTP_RESPONSE_PARSER_STATE_ERROR))
+        {
+            if ((http_response_parser->state == HTTP_RESPONSE_PARSER_STATE_BODY) ||
+                (http_response_parser->state == HTTP_RESPONSE_PARSER_STATE_CHUNK_DATA))
+            {
+                size_t available = (size_t)(end - position);
+                size_t body_bytes = (available < http_response_parser->remaining_body_bytes) ? available : http_response_parser->remaining_body_bytes;
+
+                /* Codes_SRS_HTTP_RESPONSE_PARSER_01_020: [ Body bytes shall be passed to `on_body` as views into `buffer`, as soon as they are fed. ]*/
+                /* Codes_SRS_HTTP_RESPONSE_PARSER_01_023: [ For chunked bodies only the chunk data shall be passed to `on_body`. ]*/
+                if ((http_response_parser->callbacks.on_body != NULL) &&
+                    (http_response_parser->callbacks.on_body(http_response_parser->callback_context, position, body_bytes) != 0))
+                {
+                    /* Codes_SRS_HTTP_RESPONSE_PARSER_01_030: [ If any callback returns non-zero, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+                    LogError("on_body failed");
+                    http_response_parser->state = HTTP_RESPONSE_PARSER_STATE_ERROR;
+                }
+                else
+                {
+                    position += body_bytes;
+                    http_response_parser->remaining_body_bytes -= body_bytes;
+
+                    if (http_response_parser->remaining_body_bytes == 0)
+                    {
+                        if (http_response_parser->state == HTTP_RESPONSE_PARSER_STATE_BODY)
+                        {
+                            http_response_parser->state = HTTP_RESPONSE_PARSER_STATE_COMPLETE;
+                        }
+                        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_026: [ Once all the data of a chunk was passed to `on_body`, `on_chunk_complete` shall be called. ]*/
+                        else if ((http_response_parser->callbacks.on_chunk_complete != NULL) &&
+                            (http_response_parser->callbacks.on_chunk_complete(http_response_parser->callback_context) != 0))
+                        {
+                            /* Codes_SRS_HTTP_RESPONSE_PARSER_01_030: [ If any callback returns non-zero, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+                            LogError("on_chunk_complete failed");
+                            http_response_parser->state = HTTP_RESPONSE_PARSER_STATE_ERROR;
+                        }
+                        else
+                        {
+                            http_response_parser->state = HTTP_RESPONSE_PARSER_STATE_CHUNK_DATA_END;
+                        }
+                    }
+                }
+            }
+            else
+            {
+                size_t line_bytes = feed_line(http_response_parser, position, end);
+                if (line_bytes == 0)
+                {
+                    http_response_parser->state = HTTP_RESPONSE_PARSER_STATE_ERROR;
+                }
+                else
+                {
+                    position += line_bytes;
+                }
+            }
+        }
+
+        /* Codes_SRS_HTTP_RESPONSE_PARSER_01_052: [ `http_response_parser_feed` shall set `bytes_consumed` to the number of bytes it used, and shall not use the bytes that follow a complete response. ]*/
+        *bytes_consumed = (size_t)(position - buffer);
+
+        switch (http_response_parser->state)
+        {
+        case HTTP_RESPONSE_PARSER_STATE_COMPLETE:
+            /* Codes_SRS_HTTP_RESPONSE_PARSER_01_053: [ Once the whole response was parsed, `http_response_parser_feed` shall return `HTTP_RESPONSE_PARSER_COMPLETE` until `http_response_parser_reset` is called. ]*/
+            result = HTTP_RESPONSE_PARSER_COMPLETE;
+            break;
+
+        case HTTP_RESPONSE_PARSER_STATE_ERROR:
+            /* Codes_SRS_HTTP_RESPONSE_PARSER_01_054: [ After a failure, `http_response_parser_feed` shall return `HTTP_RESPONSE_PARSER_ERROR` until `http_response_parser_reset` is called. ]*/
+            result = HTTP_RESPONSE_PARSER_ERROR;
+            break;
+
+        default:
+            /* Codes_SRS_HTTP_RESPONSE_PARSER_01_055: [ While the response is incomplete, `http_response_parser_feed` shall return `HTTP_RESPONSE_PARSER_NEED_MORE_DATA`. ]*/
+            result = HTTP_RESPONSE_PARSER_NEED_MORE_DATA;
+            break;
+        }
+    }
+
+    return result;
+}
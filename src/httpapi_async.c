@@ -0,0 +1,968 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/httpapi_async.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/singlylinkedlist.h"
+#include "azure_c_shared_utility/xio.h"
+#include "azure_c_shared_utility/tlsio.h"
+#include "azure_c_shared_utility/platform.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/http_response_parser.h"
+#include "azure_c_shared_utility/shared_util_options.h"
+
+#define HTTPS_PORT 443
+
+DEFINE_ENUM_STRINGS(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_RESULT_VALUES);
+
+typedef enum ASYNC_CONNECTION_STATE_TAG
+{
+    ASYNC_CONNECTION_STATE_NOT_OPEN,
+    ASYNC_CONNECTION_STATE_OPENING,
+    ASYNC_CONNECTION_STATE_IDLE,
+    ASYNC_CONNECTION_STATE_BUSY,
+    ASYNC_CONNECTION_STATE_FAILED
+} ASYNC_CONNECTION_STATE;
+
+typedef struct ASYNC_REQUEST_TAG
+{
+    unsigned char* request_bytes;
+    size_t request_size;
+    ON_HTTPAPI_ASYNC_REQUEST_COMPLETE on_request_complete;
+    void* callback_context;
+    tickcounter_ms_t start_time;
+    unsigned int status_code;
+    HTTP_HEADERS_HANDLE response_headers;
+    BUFFER_HANDLE response_content;
+    size_t content_size;
+    bool chunked;
+    bool close_connection;
+    bool is_retried;
+} ASYNC_REQUEST;
+
+typedef struct ASYNC_CONNECTION_TAG
+{
+    struct HTTPAPI_ASYNC_INSTANCE_TAG* httpapi_async;
+    XIO_HANDLE xio;
+    HTTP_RESPONSE_PARSER_HANDLE response_parser;
+    ASYNC_CONNECTION_STATE state;
+    ASYNC_REQUEST* request;
+    bool is_response_complete;
+    /* set once a request completed on the connection, the server may have dropped it while it was idle */
+    bool is_reused;
+} ASYNC_CONNECTION;
+
+typedef struct HTTPAPI_ASYNC_INSTANCE_TAG
+{
+    char* host_name;
+    size_t max_connections;
+    size_t connection_count;
+    SINGLYLINKEDLIST_HANDLE pending_requests;
+    /* requests whose connection failed, sent before the pending ones since they were queued first */
+    SINGLYLINKEDLIST_HANDLE retry_requests;
+    SINGLYLINKEDLIST_HANDLE connections;
+    TICK_COUNTER_HANDLE tick_counter;
+    char* trusted_certs;
+    char* x509_certificate;
+    char* x509_private_key;
+    char* x509_ecc_certificate;
+    char* x509_ecc_alias_key;
+    unsigned int timeout_ms;
+} HTTPAPI_ASYNC_INSTANCE;
+
+static const char* get_request_type_string(HTTPAPI_REQUEST_TYPE request_type)
+{
+    const char* result;
+
+    switch (request_type)
+    {
+    case HTTPAPI_REQUEST_GET:
+        result = "GET";
+        break;
+    case HTTPAPI_REQUEST_POST:
+        result = "POST";
+        break;
+    case HTTPAPI_REQUEST_PUT:
+        result = "PUT";
+        break;
+    case HTTPAPI_REQUEST_DELETE:
+        result = "DELETE";
+        break;
+    case HTTPAPI_REQUEST_PATCH:
+        result = "PATCH";
+        break;
+    default:
+        result = NULL;
+        break;
+    }
+
+    return result;
+}
+
+/* The whole request (line, headers and content) is formatted up front into one buffer, so the caller's
+   headers and content can go away as soon as the request is queued, and a request is sent with a single xio_send. */
+static int format_request(const char* method, const char* relative_path, HTTP_HEADERS_HANDLE request_headers, const unsigned char* content, size_t content_length, unsigned char** request_bytes, size_t* request_size)
+{
+    int result;
+    size_t header_count;
+
+    if (HTTPHeaders_GetHeaderCount(request_headers, &header_count) != HTTP_HEADERS_OK)
+    {
+        LogError("Cannot get the request header count");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t i;
+        const char* name;
+        const char* value;
+        /* "METHOD path HTTP/1.1\r\n" ... "\r\n" */
+        size_t size = strlen(method) + 1 + strlen(relative_path) + 11 + 2;
+
+        result = 0;
+        for (i = 0; i < header_count; i++)
+        {
+            if (HTTPHeaders_GetHeaderNameValue(request_headers, i, &name, &value) != HTTP_HEADERS_OK)
+            {
+                LogError("Cannot get request header %lu", (unsigned long)i);
+                result = __FAILURE__;
+                break;
+            }
+            /* "name: value\r\n" */
+            size += strlen(name) + 2 + strlen(value) + 2;
+        }
+
+        if (result == 0)
+        {
+            unsigned char* bytes = (unsigned char*)malloc(size + content_length + 1);
+            if (bytes == NULL)
+            {
+                LogError("Cannot allocate memory for the request");
+                result = __FAILURE__;
+            }
+            else
+            {
+                char* position = (char*)bytes;
+                position += sprintf(position, "%s %s HTTP/1.1\r\n", method, relative_path);
+                for (i = 0; i < header_count; i++)
+                {
+                    (void)HTTPHeaders_GetHeaderNameValue(request_headers, i, &name, &value);
+                    position += sprintf(position, "%s: %s\r\n", name, value);
+                }
+                position += sprintf(position, "\r\n");
+
+                if (content_length > 0)
+                {
+                    (void)memcpy(position, content, content_length);
+                }
+
+                *request_bytes = bytes;
+                *request_size = size + content_length;
+            }
+        }
+    }
+
+    return result;
+}
+
+static void destroy_request(ASYNC_REQUEST* request)
+{
+    if (request->response_headers != NULL)
+    {
+        HTTPHeaders_Free(request->response_headers);
+    }
+    if (request->response_content != NULL)
+    {
+        BUFFER_delete(request->response_content);
+    }
+    free(request->request_bytes);
+    free(request);
+}
+
+/* Drops what was received of a response, for requests that are sent again. */
+static void discard_response(ASYNC_REQUEST* request)
+{
+    if (request->response_headers != NULL)
+    {
+        HTTPHeaders_Free(request->response_headers);
+        request->response_headers = NULL;
+    }
+    if (request->response_content != NULL)
+    {
+        BUFFER_delete(request->response_content);
+        request->response_content = NULL;
+    }
+    request->status_code = 0;
+    request->content_size = 0;
+    request->chunked = false;
+    request->close_connection = false;
+}
+
+static void complete_request(ASYNC_REQUEST* request, HTTPAPI_ASYNC_RESULT result)
+{
+    if (result == HTTPAPI_ASYNC_OK)
+    {
+        request->on_request_complete(request->callback_context, result, request->status_code, request->response_headers, request->response_content);
+    }
+    else
+    {
+        LogError("HTTP request failed: %s", ENUM_TO_STRING(HTTPAPI_ASYNC_RESULT, result));
+        request->on_request_complete(request->callback_context, result, 0, NULL, NULL);
+    }
+
+    destroy_request(request);
+}
+
+static int on_response_status(void* context, int status_code, const char* reason_phrase, size_t reason_phrase_length)
+{
+    ASYNC_CONNECTION* connection = (ASYNC_CONNECTION*)context;
+    (void)reason_phrase;
+    (void)reason_phrase_length;
+
+    connection->request->status_code = (unsigned int)status_code;
+
+    return 0;
+}
+
+static int on_response_header(void* context, const char* name, size_t name_length, const char* value, size_t value_length)
+{
+    int result;
+    ASYNC_REQUEST* request = ((ASYNC_CONNECTION*)context)->request;
+    /* HTTPHeaders wants NUL terminated strings, the parser hands out views */
+    char* name_value = (char*)malloc(name_length + value_length + 2);
+
+    if (name_value == NULL)
+    {
+        LogError("Cannot allocate memory for the response header");
+        result = __FAILURE__;
+    }
+    else
+    {
+        (void)memcpy(name_value, name, name_length);
+        name_value[name_length] = '\0';
+        (void)memcpy(name_value + name_length + 1, value, value_length);
+        name_value[name_length + 1 + value_length] = '\0';
+
+        /* Codes_SRS_HTTPAPI_ASYNC_01_022: [ If the response carries a `Connection: close` header, the connection shall be closed after the request completes instead of being reused. ]*/
+        if ((strcmp(name_value, "Connection") == 0) || (strcmp(name_value, "connection") == 0))
+        {
+            if ((strstr(name_value + name_length + 1, "close") != NULL) || (strstr(name_value + name_length + 1, "Close") != NULL))
+            {
+                request->close_connection = true;
+            }
+        }
+
+        if (HTTPHeaders_AddHeaderNameValuePair(request->response_headers, name_value, name_value + name_length + 1) != HTTP_HEADERS_OK)
+        {
+            LogError("Cannot add the response header");
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+
+        free(name_value);
+    }
+
+    return result;
+}
+
+static int on_response_headers_complete(void* context, size_t content_length, bool chunked, bool* has_body)
+{
+    int result;
+    ASYNC_REQUEST* request = ((ASYNC_CONNECTION*)context)->request;
+    (void)has_body;
+
+    request->chunked = chunked;
+
+    /* The size of a Content-Length body is known up front, so the content buffer is sized once. */
+    if (!chunked && (content_length > 0) &&
+        (BUFFER_pre_build(request->response_content, content_length) != 0))
+    {
+        LogError("Cannot allocate memory for the response content");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+static int on_response_body(void* context, const unsigned char* buffer, size_t size)
+{
+    int result;
+    ASYNC_REQUEST* request = ((ASYNC_CONNECTION*)context)->request;
+
+    if (request->chunked && (BUFFER_enlarge(request->response_content, size) != 0))
+    {
+        LogError("Cannot allocate memory for the response content");
+        result = __FAILURE__;
+    }
+    else
+    {
+        (void)memcpy(BUFFER_u_char(request->response_content) + request->content_size, buffer, size);
+        request->content_size += size;
+        result = 0;
+    }
+
+    return result;
+}
+
+static int on_response_chunk_complete(void* context)
+{
+    (void)context;
+    return 0;
+}
+
+static const HTTP_RESPONSE_PARSER_CALLBACKS response_parser_callbacks =
+{
+    on_response_status,
+    on_response_header,
+    on_response_headers_complete,
+    on_response_body,
+    on_response_chunk_complete
+};
+
+static void send_request(ASYNC_CONNECTION* connection);
+
+/* The xio callbacks only record what happened, requests are completed and connections destroyed by httpapi_async_dowork. */
+static void on_io_open_complete(void* context, IO_OPEN_RESULT_DETAILED open_result)
+{
+    ASYNC_CONNECTION* connection = (ASYNC_CONNECTION*)context;
+
+    if (connection->state == ASYNC_CONNECTION_STATE_OPENING)
+    {
+        if (open_result.result == IO_OPEN_OK)
+        {
+            send_request(connection);
+        }
+        else
+        {
+            LogError("Cannot open the connection to %s, code %d", connection->httpapi_async->host_name, open_result.code);
+            connection->state = ASYNC_CONNECTION_STATE_FAILED;
+        }
+    }
+}
+
+static void on_send_complete(void* context, IO_SEND_RESULT send_result)
+{
+    ASYNC_CONNECTION* connection = (ASYNC_CONNECTION*)context;
+
+    if (send_result != IO_SEND_OK)
+    {
+        LogError("Cannot send the request to %s", connection->httpapi_async->host_name);
+        connection->state = ASYNC_CONNECTION_STATE_FAILED;
+    }
+}
+
+static void on_bytes_received(void* context, const unsigned char* buffer, size_t size)
+{
+    ASYNC_CONNECTION* connection = (ASYNC_CONNECTION*)context;
+
+    if ((connection->state != ASYNC_CONNECTION_STATE_BUSY) || (connection->is_response_complete))
+    {
+        /* a server talking out of turn (e.g. a 408 on an idle connection) makes the connection unusable */
+        connection->state = ASYNC_CONNECTION_STATE_FAILED;
+    }
+    else
+    {
+        size_t bytes_consumed;
+        switch (http_response_parser_feed(connection->response_parser, buffer, size, &bytes_consumed))
+        {
+        case HTTP_RESPONSE_PARSER_COMPLETE:
+            connection->is_response_complete = true;
+            if (bytes_consumed < size)
+            {
+                /* nothing was asked for these bytes, the connection cannot be trusted for the next request */
+                connection->request->close_connection = true;
+            }
+            break;
+        case HTTP_RESPONSE_PARSER_NEED_MORE_DATA:
+            break;
+        default:
+            LogError("Cannot parse the response from %s", connection->httpapi_async->host_name);
+            connection->state = ASYNC_CONNECTION_STATE_FAILED;
+            break;
+        }
+    }
+}
+
+static void on_io_error(void* context)
+{
+    ASYNC_CONNECTION* connection = (ASYNC_CONNECTION*)context;
+    connection->state = ASYNC_CONNECTION_STATE_FAILED;
+}
+
+static void send_request(ASYNC_CONNECTION* connection)
+{
+    connection->state = ASYNC_CONNECTION_STATE_BUSY;
+    if (xio_send(connection->xio, connection->request->request_bytes, connection->request->request_size, on_send_complete, connection) != 0)
+    {
+        LogError("Cannot send the request to %s", connection->httpapi_async->host_name);
+        connection->state = ASYNC_CONNECTION_STATE_FAILED;
+    }
+}
+
+static int set_connection_options(HTTPAPI_ASYNC_INSTANCE* httpapi_async, XIO_HANDLE xio)
+{
+    int result;
+
+    if (((httpapi_async->trusted_certs != NULL) && (xio_setoption(xio, OPTION_TRUSTED_CERT, httpapi_async->trusted_certs) != 0)) ||
+        ((httpapi_async->x509_certificate != NULL) && (xio_setoption(xio, SU_OPTION_X509_CERT, httpapi_async->x509_certificate) != 0)) ||
+        ((httpapi_async->x509_private_key != NULL) && (xio_setoption(xio, SU_OPTION_X509_PRIVATE_KEY, httpapi_async->x509_private_key) != 0)) ||
+        ((httpapi_async->x509_ecc_certificate != NULL) && (xio_setoption(xio, OPTION_X509_ECC_CERT, httpapi_async->x509_ecc_certificate) != 0)) ||
+        ((httpapi_async->x509_ecc_alias_key != NULL) && (xio_setoption(xio, OPTION_X509_ECC_KEY, httpapi_async->x509_ecc_alias_key) != 0)))
+    {
+        LogError("Cannot set the TLS options on the connection");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+static ASYNC_CONNECTION* create_connection(HTTPAPI_ASYNC_INSTANCE* httpapi_async)
+{
+    ASYNC_CONNECTION* result = (ASYNC_CONNECTION*)malloc(sizeof(ASYNC_CONNECTION));
+
+    if (result == NULL)
+    {
+        LogError("Cannot allocate memory for the connection");
+    }
+    else
+    {
+        TLSIO_CONFIG tlsio_config;
+        tlsio_config.hostname = httpapi_async->host_name;
+        tlsio_config.port = HTTPS_PORT;
+        tlsio_config.underlying_io_interface = NULL;
+        tlsio_config.underlying_io_parameters = NULL;
+
+        result->httpapi_async = httpapi_async;
+        result->state = ASYNC_CONNECTION_STATE_NOT_OPEN;
+        result->request = NULL;
+        result->is_response_complete = false;
+        result->is_reused = false;
+
+        /* Codes_SRS_HTTPAPI_ASYNC_01_015: [ A new connection shall be created with `xio_create` over `platform_get_default_tlsio` for port 443 of `host_name`, and shall be passed the saved options. ]*/
+        if ((result->xio = xio_create(platform_get_default_tlsio(), &tlsio_config)) == NULL)
+        {
+            LogError("Cannot create the xio");
+            free(result);
+            result = NULL;
+        }
+        else if (set_connection_options(httpapi_async, result->xio) != 0)
+        {
+            xio_destroy(result->xio);
+            free(result);
+            result = NULL;
+        }
+        else if ((result->response_parser = http_response_parser_create(&response_parser_callbacks, result)) == NULL)
+        {
+            LogError("Cannot create the response parser");
+            xio_destroy(result->xio);
+            free(result);
+            result = NULL;
+        }
+        else if (singlylinkedlist_add(httpapi_async->connections, result) == NULL)
+        {
+            LogError("Cannot add the connection");
+            http_response_parser_destroy(result->response_parser);
+            xio_destroy(result->xio);
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            httpapi_async->connection_count++;
+        }
+    }
+
+    return result;
+}
+
+static void destroy_connection(ASYNC_CONNECTION* connection)
+{
+    xio_destroy(connection->xio);
+    http_response_parser_destroy(connection->response_parser);
+    free(connection);
+}
+
+static bool is_connection_available(LIST_ITEM_HANDLE list_item, const void* match_context)
+{
+    const ASYNC_CONNECTION* connection = (const ASYNC_CONNECTION*)singlylinkedlist_item_get_value(list_item);
+    (void)match_context;
+    return (connection->state == ASYNC_CONNECTION_STATE_IDLE) || (connection->state == ASYNC_CONNECTION_STATE_NOT_OPEN);
+}
+
+/* Returns 0 when the request is now owned by the connection, otherwise the request has been completed with an error. */
+static int start_request(HTTPAPI_ASYNC_INSTANCE* httpapi_async, ASYNC_CONNECTION* connection, ASYNC_REQUEST* request)
+{
+    int result;
+
+    if (((request->response_headers = HTTPHeaders_Alloc()) == NULL) ||
+        ((request->response_content = BUFFER_new()) == NULL) ||
+        (tickcounter_get_current_ms(httpapi_async->tick_counter, &request->start_time) != 0) ||
+        (http_response_parser_reset(connection->response_parser) != 0))
+    {
+        LogError("Cannot start the request");
+        complete_request(request, HTTPAPI_ASYNC_ERROR);
+        result = __FAILURE__;
+    }
+    else
+    {
+        connection->request = request;
+        connection->is_response_complete = false;
+
+        if (connection->state == ASYNC_CONNECTION_STATE_IDLE)
+        {
+            /* Codes_SRS_HTTPAPI_ASYNC_01_014: [ `httpapi_async_dowork` shall send the queued requests, in order, on idle connections first and on new connections while there are fewer than `max_connections`. ]*/
+            send_request(connection);
+        }
+        else
+        {
+            connection->state = ASYNC_CONNECTION_STATE_OPENING;
+            if (xio_open(connection->xio, on_io_open_complete, connection, on_bytes_received, connection, on_io_error, connection) != 0)
+            {
+                LogError("Cannot open the connection to %s", httpapi_async->host_name);
+                connection->state = ASYNC_CONNECTION_STATE_FAILED;
+            }
+        }
+
+        result = 0;
+    }
+
+    return result;
+}
+
+/* Codes_SRS_HTTPAPI_ASYNC_01_025: [ A request queued again shall be sent before all the requests that were queued with `httpapi_async_execute_request`, so a failed connection does not move it behind requests made after it. ]*/
+static LIST_ITEM_HANDLE get_next_request(HTTPAPI_ASYNC_INSTANCE* httpapi_async, SINGLYLINKEDLIST_HANDLE* queue)
+{
+    LIST_ITEM_HANDLE result = singlylinkedlist_get_head_item(httpapi_async->retry_requests);
+
+    if (result != NULL)
+    {
+        *queue = httpapi_async->retry_requests;
+    }
+    else
+    {
+        *queue = httpapi_async->pending_requests;
+        result = singlylinkedlist_get_head_item(httpapi_async->pending_requests);
+    }
+
+    return result;
+}
+
+static void dispatch_pending_requests(HTTPAPI_ASYNC_INSTANCE* httpapi_async)
+{
+    SINGLYLINKEDLIST_HANDLE queue;
+    LIST_ITEM_HANDLE pending_item;
+
+    while ((pending_item = get_next_request(httpapi_async, &queue)) != NULL)
+    {
+        ASYNC_REQUEST* request = (ASYNC_REQUEST*)singlylinkedlist_item_get_value(pending_item);
+        LIST_ITEM_HANDLE connection_item = singlylinkedlist_find(httpapi_async->connections, is_connection_available, NULL);
+        ASYNC_CONNECTION* connection;
+
+        if (connection_item != NULL)
+        {
+            connection = (ASYNC_CONNECTION*)singlylinkedlist_item_get_value(connection_item);
+        }
+        else if (httpapi_async->connection_count >= httpapi_async->max_connections)
+        {
+            /* all the connections are busy, the request waits for one to free up */
+            break;
+        }
+        else
+        {
+            connection = create_connection(httpapi_async);
+        }
+
+        if (connection == NULL)
+        {
+            if (httpapi_async->connection_count > 0)
+            {
+                /* retried once a connection frees up */
+                break;
+            }
+            else
+            {
+                /* Codes_SRS_HTTPAPI_ASYNC_01_016: [ If there are no connections and creating one fails, the first queued request shall be completed with `HTTPAPI_ASYNC_ERROR`. ]*/
+                (void)singlylinkedlist_remove(queue, pending_item);
+                complete_request(request, HTTPAPI_ASYNC_ERROR);
+            }
+        }
+        else
+        {
+            (void)singlylinkedlist_remove(queue, pending_item);
+            (void)start_request(httpapi_async, connection, request);
+        }
+    }
+}
+
+static int requeue_request(HTTPAPI_ASYNC_INSTANCE* httpapi_async, ASYNC_REQUEST* request)
+{
+    int result;
+
+    discard_response(request);
+    if (singlylinkedlist_add(httpapi_async->retry_requests, request) == NULL)
+    {
+        LogError("Cannot queue the request again");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+/* Completes the requests whose connection finished or failed, and destroys the failed connections. */
+static void process_connections(HTTPAPI_ASYNC_INSTANCE* httpapi_async)
+{
+    tickcounter_ms_t now;
+    bool has_time = (httpapi_async->timeout_ms > 0) && (tickcounter_get_current_ms(httpapi_async->tick_counter, &now) == 0);
+    LIST_ITEM_HANDLE connection_item = singlylinkedlist_get_head_item(httpapi_async->connections);
+
+    while (connection_item != NULL)
+    {
+        ASYNC_CONNECTION* connection = (ASYNC_CONNECTION*)singlylinkedlist_item_get_value(connection_item);
+        LIST_ITEM_HANDLE next_item = singlylinkedlist_get_next_item(connection_item);
+        ASYNC_REQUEST* request = connection->request;
+
+        if (connection->is_response_complete)
+        {
+            connection->request = NULL;
+            connection->is_response_complete = false;
+            connection->is_reused = true;
+            /* a response followed by the server closing the connection completes fine, the connection just is not kept */
+            connection->state = ((connection->state == ASYNC_CONNECTION_STATE_BUSY) && !request->close_connection) ? ASYNC_CONNECTION_STATE_IDLE : ASYNC_CONNECTION_STATE_FAILED;
+
+            /* Codes_SRS_HTTPAPI_ASYNC_01_017: [ When a response is complete, `httpapi_async_dowork` shall call `on_request_complete` with `HTTPAPI_ASYNC_OK`, the status code, the response headers and the response content, and shall keep the connection for the next request. ]*/
+            complete_request(request, HTTPAPI_ASYNC_OK);
+        }
+        else if ((request != NULL) && (connection->state == ASYNC_CONNECTION_STATE_FAILED))
+        {
+            connection->request = NULL;
+
+            if (connection->is_reused)
+            {
+                /* Codes_SRS_HTTPAPI_ASYNC_01_018: [ If a connection that already completed a request fails, its request shall be queued again without counting as a retry. ]*/
+                if (requeue_request(httpapi_async, request) != 0)
+                {
+                    complete_request(request, HTTPAPI_ASYNC_ERROR);
+                }
+            }
+            else if (!request->is_retried)
+            {
+                /* Codes_SRS_HTTPAPI_ASYNC_01_019: [ Otherwise, if a connection fails, its request shall be queued again once. ]*/
+                request->is_retried = true;
+                if (requeue_request(httpapi_async, request) != 0)
+                {
+                    complete_request(request, HTTPAPI_ASYNC_ERROR);
+                }
+            }
+            else
+            {
+                /* Codes_SRS_HTTPAPI_ASYNC_01_020: [ If the connection of a request that was already queued again fails, `on_request_complete` shall be called with `HTTPAPI_ASYNC_ERROR`. ]*/
+                complete_request(request, HTTPAPI_ASYNC_ERROR);
+            }
+        }
+        /* strictly longer, so that a coarse tick counter (whole seconds on some platforms) does not time requests out early */
+        else if ((request != NULL) && has_time && ((now - request->start_time) > httpapi_async->timeout_ms))
+        {
+            /* Codes_SRS_HTTPAPI_ASYNC_01_021: [ If the `timeout` option is set and a request has been in progress for longer than that many milliseconds, `on_request_complete` shall be called with `HTTPAPI_ASYNC_TIMEOUT` and the connection shall be closed. ]*/
+            connection->request = NULL;
+            connection->state = ASYNC_CONNECTION_STATE_FAILED;
+            complete_request(request, HTTPAPI_ASYNC_TIMEOUT);
+        }
+
+        if (connection->state == ASYNC_CONNECTION_STATE_FAILED)
+        {
+            (void)singlylinkedlist_remove(httpapi_async->connections, connection_item);
+            httpapi_async->connection_count--;
+            destroy_connection(connection);
+        }
+
+        connection_item = next_item;
+    }
+}
+
+HTTPAPI_ASYNC_HANDLE httpapi_async_create(const char* host_name, size_t max_connections)
+{
+    HTTPAPI_ASYNC_INSTANCE* result;
+
+    if ((host_name == NULL) || (max_connections == 0))
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_01_001: [ If `host_name` is NULL or `max_connections` is 0, `httpapi_async_create` shall fail and return NULL. ]*/
+        LogError("Invalid arguments: host_name = %p, max_connections = %lu", host_name, (unsigned long)max_connections);
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_01_002: [ `httpapi_async_create` shall allocate a new instance, copy `host_name` and create the request queue, the retry queue, the connection list and a tick counter. ]*/
+        result = (HTTPAPI_ASYNC_INSTANCE*)malloc(sizeof(HTTPAPI_ASYNC_INSTANCE));
+        if (result == NULL)
+        {
+            /* Codes_SRS_HTTPAPI_ASYNC_01_003: [ If any error occurs, `httpapi_async_create` shall fail and return NULL. ]*/
+            LogError("Cannot allocate memory for the httpapi_async instance");
+        }
+        else
+        {
+            (void)memset(result, 0, sizeof(HTTPAPI_ASYNC_INSTANCE));
+            result->max_connections = max_connections;
+
+            if (mallocAndStrcpy_s(&result->host_name, host_name) != 0)
+            {
+                LogError("Cannot copy the host name");
+                free(result);
+                result = NULL;
+            }
+            else if ((result->pending_requests = singlylinkedlist_create()) == NULL)
+            {
+                LogError("Cannot create the request queue");
+                free(result->host_name);
+                free(result);
+                result = NULL;
+            }
+            else if ((result->retry_requests = singlylinkedlist_create()) == NULL)
+            {
+                LogError("Cannot create the retry queue");
+                singlylinkedlist_destroy(result->pending_requests);
+                free(result->host_name);
+                free(result);
+                result = NULL;
+            }
+            else if ((result->connections = singlylinkedlist_create()) == NULL)
+            {
+                LogError("Cannot create the connection list");
+                singlylinkedlist_destroy(result->retry_requests);
+                singlylinkedlist_destroy(result->pending_requests);
+                free(result->host_name);
+                free(result);
+                result = NULL;
+            }
+            else if ((result->tick_counter = tickcounter_create()) == NULL)
+            {
+                LogError("Cannot create the tick counter");
+                singlylinkedlist_destroy(result->connections);
+                singlylinkedlist_destroy(result->retry_requests);
+                singlylinkedlist_destroy(result->pending_requests);
+                free(result->host_name);
+                free(result);
+                result = NULL;
+            }
+        }
+    }
+
+    return result;
+}
+
+void httpapi_async_destroy(HTTPAPI_ASYNC_HANDLE httpapi_async)
+{
+    /* Codes_SRS_HTTPAPI_ASYNC_01_004: [ If `httpapi_async` is NULL, `httpapi_async_destroy` shall do nothing. ]*/
+    if (httpapi_async != NULL)
+    {
+        LIST_ITEM_HANDLE list_item;
+
+        /* Codes_SRS_HTTPAPI_ASYNC_01_005: [ `httpapi_async_destroy` shall close all the connections, call `on_request_complete` with `HTTPAPI_ASYNC_CANCELLED` for every request that did not complete, and free all the resources. ]*/
+        while ((list_item = singlylinkedlist_get_head_item(httpapi_async->connections)) != NULL)
+        {
+            ASYNC_CONNECTION* connection = (ASYNC_CONNECTION*)singlylinkedlist_item_get_value(list_item);
+            ASYNC_REQUEST* request = connection->request;
+            (void)singlylinkedlist_remove(httpapi_async->connections, list_item);
+            destroy_connection(connection);
+            if (request != NULL)
+            {
+                complete_request(request, HTTPAPI_ASYNC_CANCELLED);
+            }
+        }
+
+        while ((list_item = singlylinkedlist_get_head_item(httpapi_async->retry_requests)) != NULL)
+        {
+            ASYNC_REQUEST* request = (ASYNC_REQUEST*)singlylinkedlist_item_get_value(list_item);
+            (void)singlylinkedlist_remove(httpapi_async->retry_requests, list_item);
+            complete_request(request, HTTPAPI_ASYNC_CANCELLED);
+        }
+
+        while ((list_item = singlylinkedlist_get_head_item(httpapi_async->pending_requests)) != NULL)
+        {
+            ASYNC_REQUEST* request = (ASYNC_REQUEST*)singlylinkedlist_item_get_value(list_item);
+            (void)singlylinkedlist_remove(httpapi_async->pending_requests, list_item);
+            complete_request(request, HTTPAPI_ASYNC_CANCELLED);
+        }
+
+        singlylinkedlist_destroy(httpapi_async->connections);
+        singlylinkedlist_destroy(httpapi_async->retry_requests);
+        singlylinkedlist_destroy(httpapi_async->pending_requests);
+        tickcounter_destroy(httpapi_async->tick_counter);
+        free(httpapi_async->trusted_certs);
+        free(httpapi_async->x509_certificate);
+        free(httpapi_async->x509_private_key);
+        free(httpapi_async->x509_ecc_certificate);
+        free(httpapi_async->x509_ecc_alias_key);
+        free(httpapi_async->host_name);
+        free(httpapi_async);
+    }
+}
+
+static int replace_string_option(char** destination, const void* value)
+{
+    int result;
+    char* copy;
+
+    if (mallocAndStrcpy_s(&copy, (const char*)value) != 0)
+    {
+        LogError("Cannot copy the option value");
+        result = __FAILURE__;
+    }
+    else
+    {
+        free(*destination);
+        *destination = copy;
+        result = 0;
+    }
+
+    return result;
+}
+
+int httpapi_async_set_option(HTTPAPI_ASYNC_HANDLE httpapi_async, const char* option_name, const void* value)
+{
+    int result;
+
+    if ((httpapi_async == NULL) || (option_name == NULL) || (value == NULL))
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_01_006: [ If `httpapi_async`, `option_name` or `value` is NULL, `httpapi_async_set_option` shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: httpapi_async = %p, option_name = %p, value = %p", httpapi_async, option_name, value);
+        result = __FAILURE__;
+    }
+    /* Codes_SRS_HTTPAPI_ASYNC_01_007: [ `httpapi_async_set_option` shall save a copy of the `TrustedCerts`, `x509certificate`, `x509privatekey`, `x509EccCertificate` and `x509EccAliasKey` options, to be passed to the connections created afterwards. ]*/
+    else if (strcmp(option_name, OPTION_TRUSTED_CERT) == 0)
+    {
+        result = replace_string_option(&httpapi_async->trusted_certs, value);
+    }
+    else if (strcmp(option_name, SU_OPTION_X509_CERT) == 0)
+    {
+        result = replace_string_option(&httpapi_async->x509_certificate, value);
+    }
+    else if (strcmp(option_name, SU_OPTION_X509_PRIVATE_KEY) == 0)
+    {
+        result = replace_string_option(&httpapi_async->x509_private_key, value);
+    }
+    else if (strcmp(option_name, OPTION_X509_ECC_CERT) == 0)
+    {
+        result = replace_string_option(&httpapi_async->x509_ecc_certificate, value);
+    }
+    else if (strcmp(option_name, OPTION_X509_ECC_KEY) == 0)
+    {
+        result = replace_string_option(&httpapi_async->x509_ecc_alias_key, value);
+    }
+    else if (strcmp(option_name, OPTION_HTTP_TIMEOUT) == 0)
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_01_008: [ The `timeout` option shall be read as an `unsigned int` number of milliseconds, 0 meaning no timeout. ]*/
+        httpapi_async->timeout_ms = *(const unsigned int*)value;
+        result = 0;
+    }
+    else
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_01_009: [ For any other option `httpapi_async_set_option` shall fail and return a non-zero value. ]*/
+        LogError("Option not supported: %s", option_name);
+        result = __FAILURE__;
+    }
+
+    return result;
+}
+
+int httpapi_async_execute_request(HTTPAPI_ASYNC_HANDLE httpapi_async, HTTPAPI_REQUEST_TYPE request_type, const char* relative_path, HTTP_HEADERS_HANDLE request_headers, const unsigned char* content, size_t content_length, ON_HTTPAPI_ASYNC_REQUEST_COMPLETE on_request_complete, void* callback_context)
+{
+    int result;
+    const char* method = get_request_type_string(request_type);
+
+    if ((httpapi_async == NULL) || (method == NULL) || (relative_path == NULL) || (request_headers == NULL) ||
+        ((content == NULL) && (content_length > 0)) || (on_request_complete == NULL))
+    {
+        /* Codes_SRS_HTTPAPI_ASYNC_01_010: [ If `httpapi_async`, `relative_path`, `request_headers` or `on_request_complete` is NULL, `request_type` is not valid, or `content` is NULL while `content_length` is not 0, `httpapi_async_execute_request` shall fail and return a non-zero value. ]*/
+        LogError("Invalid arguments: httpapi_async = %p, request_type = %d, relative_path = %p, request_headers = %p, content = %p, content_length = %lu, on_request_complete = %p",
+            httpapi_async, (int)request_type, relative_path, request_headers, content, (unsigned long)content_length, on_request_complete);
+        result = __FAILURE__;
+    }
+    else
+    {
+        ASYNC_REQUEST* request = (ASYNC_REQUEST*)malloc(sizeof(ASYNC_REQUEST));
+        if (request == NULL)
+        {
+            /* Codes_SRS_HTTPAPI_ASYNC_01_013: [ If any error occurs, `httpapi_async_execute_request` shall fail and return a non-zero value. ]*/
+            LogError("Cannot allocate memory for the request");
+            result = __FAILURE__;
+        }
+        else
+        {
+            (void)memset(request, 0, sizeof(ASYNC_REQUEST));
+            request->on_request_complete = on_request_complete;
+            request->callback_context = callback_context;
+
+            /* Codes_SRS_HTTPAPI_ASYNC_01_011: [ `httpapi_async_execute_request` shall format the request line, the headers and the content into one buffer, so `request_headers` and `content` are not used after it returns. ]*/
+            if (format_request(method, relative_path, request_headers, content, content_length, &request->request_bytes, &request->request_size) != 0)
+            {
+                free(request);
+                result = __FAILURE__;
+            }
+            /* Codes_SRS_HTTPAPI_ASYNC_01_012: [ `httpapi_async_execute_request` shall queue the request and return 0 without doing any IO. ]*/
+            else if (singlylinkedlist_add(httpapi_async->pending_requests, request) == NULL)
+            {
+                LogError("Cannot queue the request");
+                free(request->request_bytes);
+                free(request);
+                result = __FAILURE__;
+            }
+            else
+            {
+                result = 0;
+            }
+        }
+    }
+
+    return result;
+}
+
+void httpapi_async_dowork(HTTPAPI_ASYNC_HANDLE httpapi_async)
+{
+    /* Codes_SRS_HTTPAPI_ASYNC_01_023: [ If `httpapi_async` is NULL, `httpapi_async_dowork` shall do nothing. ]*/
+    if (httpapi_async != NULL)
+    {
+        LIST_ITEM_HANDLE connection_item;
+
+        dispatch_pending_requests(httpapi_async);
+
+        /* Codes_SRS_HTTPAPI_ASYNC_01_024: [ `httpapi_async_dowork` shall call `xio_dowork` on every connection, idle ones included so that connections dropped by the server are noticed. ]*/
+        connection_item = singlylinkedlist_get_head_item(httpapi_async->connections);
+        while (connection_item != NULL)
+        {
+            ASYNC_CONNECTION* connection = (ASYNC_CONNECTION*)singlylinkedlist_item_get_value(connection_item);
+            if ((connection->state != ASYNC_CONNECTION_STATE_NOT_OPEN) && (connection->state != ASYNC_CONNECTION_STATE_FAILED))
+            {
+                xio_dowork(connection->xio);
+            }
+            connection_item = singlylinkedlist_get_next_item(connection_item);
+        }
+
+        process_connections(httpapi_async);
+
+        /* connections freed by this pass can take queued requests right away */
+        dispatch_pending_requests(httpapi_async);
+    }
+}
@@ -2,6 +2,8 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/httpapiex.h"
 #include "azure_c_shared_utility/optimize_size.h"
@@ -9,6 +11,12 @@
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/vector.h"
+#include "azure_c_shared_utility/hash.h"
+#include "azure_c_shared_utility/shared_util_options.h"
+#include "azure_c_shared_utility/httpapi_async.h"
+
+/*how many connections the requests of HTTPAPIEX_ExecuteRequestAsync are spread over*/
+#define HTTPAPIEX_ASYNC_MAX_CONNECTIONS 16
 
 typedef struct HTTPAPIEX_SAVED_OPTION_TAG
 {
@@ -22,13 +30,24 @@ typedef struct HTTPAPIEX_HANDLE_DATA_TAG
     int k;
     HTTP_HANDLE httpHandle;
     VECTOR_HANDLE savedOptions;
+    HTTPAPIEX_POOL_HANDLE pool;
+    STRING_HANDLE poolKey; /*NULL when the options of the handle do not allow sharing connections*/
+    bool isPoolKeyValid;
+    HTTPAPI_ASYNC_HANDLE asyncRequests; /*created by the first HTTPAPIEX_ExecuteRequestAsync*/
+    bool isAsyncOptionRejected; /*an option set after asyncRequests was created does not apply to the async requests*/
 }HTTPAPIEX_HANDLE_DATA;
 
+typedef struct HTTPAPIEX_ASYNC_CONTEXT_TAG
+{
+    ON_HTTPAPIEX_REQUEST_COMPLETE onRequestComplete;
+    void* callbackContext;
+}HTTPAPIEX_ASYNC_CONTEXT;
+
 DEFINE_ENUM_STRINGS(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT_VALUES);
 
 #define LOG_HTTAPIEX_ERROR() LogError("error code = %s", ENUM_TO_STRING(HTTPAPIEX_RESULT, result))
 
-HTTPAPIEX_HANDLE HTTPAPIEX_Create(const char* hostName)
+static HTTPAPIEX_HANDLE createHandle(const char* hostName, HTTPAPIEX_POOL_HANDLE pool)
 {
     HTTPAPIEX_HANDLE result;
     /*Codes_SRS_HTTPAPIEX_02_001: [If parameter hostName is NULL then HTTPAPIEX_Create shall return NULL.]*/
@@ -70,6 +89,11 @@ HTTPAPIEX_HANDLE HTTPAPIEX_Create(const char* hostName)
                 {
                     handleData->k = -1;
                     handleData->httpHandle = NULL;
+                    handleData->pool = pool;
+                    handleData->poolKey = NULL;
+                    handleData->isPoolKeyValid = false;
+                    handleData->asyncRequests = NULL;
+                    handleData->isAsyncOptionRejected = false;
                     result = handleData;
                 }
             }
@@ -78,6 +102,197 @@ HTTPAPIEX_HANDLE HTTPAPIEX_Create(const char* hostName)
     return result;
 }
 
+HTTPAPIEX_HANDLE HTTPAPIEX_Create(const char* hostName)
+{
+    return createHandle(hostName, NULL);
+}
+
+HTTPAPIEX_HANDLE HTTPAPIEX_CreateWithPool(const char* hostName, HTTPAPIEX_POOL_HANDLE pool)
+{
+    /*Codes_SRS_HTTPAPIEX_01_001: [ HTTPAPIEX_CreateWithPool shall behave as HTTPAPIEX_Create and associate pool with the new handle. ]*/
+    /*Codes_SRS_HTTPAPIEX_01_002: [ If pool is NULL, the handle shall not share connections. ]*/
+    return createHandle(hostName, pool);
+}
+
+/*options that only select the TLS identity and trust of a connection, handles that saved nothing else can share connections*/
+static bool isPoolableOption(const char* optionName)
+{
+    return
+        (strcmp(optionName, OPTION_TRUSTED_CERT) == 0) ||
+        (strcmp(optionName, SU_OPTION_X509_CERT) == 0) ||
+        (strcmp(optionName, SU_OPTION_X509_PRIVATE_KEY) == 0) ||
+        (strcmp(optionName, OPTION_X509_ECC_CERT) == 0) ||
+        (strcmp(optionName, OPTION_X509_ECC_KEY) == 0);
+}
+
+/*appends to the key the hex SHA-256 of all the saved option names and values, so handles with different certificates never share a connection*/
+static int concatOptionsDigest(STRING_HANDLE key, VECTOR_HANDLE savedOptions)
+{
+    int result;
+    HASH_HANDLE hash;
+    BUFFER_HANDLE digest;
+
+    if ((hash = HASH_Create(HASH_ALGORITHM_SHA256)) == NULL)
+    {
+        LogError("unable to HASH_Create");
+        result = __FAILURE__;
+    }
+    else
+    {
+        if ((digest = BUFFER_new()) == NULL)
+        {
+            LogError("unable to BUFFER_new");
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t i;
+            size_t vectorSize = VECTOR_size(savedOptions);
+
+            result = 0;
+            for (i = 0; (result == 0) && (i < vectorSize); i++)
+            {
+                HTTPAPIEX_SAVED_OPTION* option = (HTTPAPIEX_SAVED_OPTION*)VECTOR_element(savedOptions, i);
+                const char* value = (const char*)option->value;
+                if ((HASH_Update(hash, (const unsigned char*)option->optionName, strlen(option->optionName) + 1) != 0) ||
+                    (HASH_Update(hash, (const unsigned char*)value, strlen(value) + 1) != 0))
+                {
+                    LogError("unable to HASH_Update");
+                    result = __FAILURE__;
+                }
+            }
+
+            if (result == 0)
+            {
+                if (HASH_Final(hash, digest) != 0)
+                {
+                    LogError("unable to HASH_Final");
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    static const char hexDigits[] = "0123456789abcdef";
+                    char hex[2 * 64 + 2];
+                    const unsigned char* bytes = BUFFER_u_char(digest);
+                    size_t length = BUFFER_length(digest);
+
+                    hex[0] = '\n';
+                    for (i = 0; (i < length) && (i < 64); i++)
+                    {
+                        hex[1 + 2 * i] = hexDigits[bytes[i] >> 4];
+                        hex[2 + 2 * i] = hexDigits[bytes[i] & 0x0F];
+                    }
+                    hex[1 + 2 * i] = '\0';
+
+                    if (STRING_concat(key, hex) != 0)
+                    {
+                        LogError("unable to STRING_concat");
+                        result = __FAILURE__;
+                    }
+                }
+            }
+
+            BUFFER_delete(digest);
+        }
+
+        HASH_Destroy(hash);
+    }
+
+    return result;
+}
+
+/*returns the key the connections of the handle are pooled under, NULL when they are not pooled*/
+static const char* getPoolKey(HTTPAPIEX_HANDLE_DATA* handleData)
+{
+    if (!handleData->isPoolKeyValid)
+    {
+        size_t i;
+        size_t vectorSize = VECTOR_size(handleData->savedOptions);
+        for (i = 0; i < vectorSize; i++)
+        {
+            if (!isPoolableOption(((HTTPAPIEX_SAVED_OPTION*)VECTOR_element(handleData->savedOptions, i))->optionName))
+            {
+                break;
+            }
+        }
+
+        if (i < vectorSize)
+        {
+            /*Codes_SRS_HTTPAPIEX_01_004: [ If any saved option is not one of TrustedCerts, x509certificate, x509privatekey, x509EccCertificate or x509EccAliasKey, HTTPAPIEX_ExecuteRequest shall not use the pool for that handle. ]*/
+            handleData->isPoolKeyValid = true;
+        }
+        /*Codes_SRS_HTTPAPIEX_01_003: [ Connections shall be pooled under a key made of the host name and, when there are saved options, the SHA-256 of their names and values. ]*/
+        else if ((handleData->poolKey = STRING_clone(handleData->hostName)) == NULL)
+        {
+            /*Codes_SRS_HTTPAPIEX_01_005: [ If building the key fails, HTTPAPIEX_ExecuteRequest shall not use the pool for that request. ]*/
+            LogError("unable to STRING_clone");
+        }
+        else if ((vectorSize > 0) && (concatOptionsDigest(handleData->poolKey, handleData->savedOptions) != 0))
+        {
+            STRING_delete(handleData->poolKey);
+            handleData->poolKey = NULL;
+        }
+        else
+        {
+            handleData->isPoolKeyValid = true;
+        }
+    }
+
+    return (handleData->poolKey == NULL) ? NULL : STRING_c_str(handleData->poolKey);
+}
+
+static bool isConnectionCloseResponse(HTTP_HEADERS_HANDLE responseHttpHeadersHandle)
+{
+    const char* connection = HTTPHeaders_FindHeaderValue(responseHttpHeadersHandle, "Connection");
+    if (connection == NULL)
+    {
+        connection = HTTPHeaders_FindHeaderValue(responseHttpHeadersHandle, "connection");
+    }
+    bool result = false;
+
+    if (connection != NULL)
+    {
+        /*Connection is a comma-separated list of tokens, e.g. "keep-alive, close", and tokens are case-insensitive*/
+        const char* token = connection;
+        while (!result && (*token != '\0'))
+        {
+            const char* tokenEnd;
+            size_t tokenLength;
+
+            while ((*token == ' ') || (*token == '\t') || (*token == ','))
+            {
+                token++;
+            }
+
+            tokenEnd = token;
+            while ((*tokenEnd != '\0') && (*tokenEnd != ','))
+            {
+                tokenEnd++;
+            }
+
+            tokenLength = (size_t)(tokenEnd - token);
+            while ((tokenLength > 0) && ((token[tokenLength - 1] == ' ') || (token[tokenLength - 1] == '\t')))
+            {
+                tokenLength--;
+            }
+
+            if (tokenLength == sizeof("close") - 1)
+            {
+                size_t i = 0;
+                while ((i < tokenLength) && (tolower((unsigned char)token[i]) == "close"[i]))
+                {
+                    i++;
+                }
+                result = (i == tokenLength);
+            }
+
+            token = tokenEnd;
+        }
+    }
+
+    return result;
+}
+
 /*this function builds the default request http headers if none are specified*/
 /*returns 0 if no error*/
 /*any other code is error*/
@@ -345,6 +560,10 @@ HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUE
                 /*Codes_SRS_HTTPAPIEX_02_026: [A step shall be retried at most once.]*/
                 /*Codes_SRS_HTTPAPIEX_02_027: [If a step has been retried then all subsequent steps shall be retried too.]*/
                 bool st[3] = { false, false, false }; /*the three levels of possible failure in resilient send: HTTAPI_Init, HTTPAPI_CreateConnection, HTTPAPI_ExecuteRequest*/
+                /*a pooled connection might have been dropped by the server while idle, once a connection failed the retries use fresh ones*/
+                const char* poolKey = (handleData->pool == NULL) ? NULL : getPoolKey(handleData);
+                bool canCheckout = (poolKey != NULL);
+                bool isPooledConnection = false;
                 if (handleData->k == -1)
                 {
                     handleData->k = 0;
@@ -382,7 +601,15 @@ HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUE
                         }
                         case 1:
                         {
-                            if ((handleData->httpHandle = HTTPAPI_CreateConnection(STRING_c_str(handleData->hostName))) == NULL)
+                            /*Codes_SRS_HTTPAPIEX_01_006: [ When the handle uses a pool, step 2 shall first try to take an idle connection from the pool by calling HTTPAPIEX_POOL_Checkout and shall only call HTTPAPI_CreateConnection when there is none. ]*/
+                            /*Codes_SRS_HTTPAPIEX_01_007: [ A connection taken from the pool shall not be passed the saved options again. ]*/
+                            if (canCheckout &&
+                                ((handleData->httpHandle = HTTPAPIEX_POOL_Checkout(handleData->pool, poolKey)) != NULL))
+                            {
+                                isPooledConnection = true;
+                                goOn = true;
+                            }
+                            else if ((handleData->httpHandle = HTTPAPI_CreateConnection(STRING_c_str(handleData->hostName))) == NULL)
                             {
                                 goOn = false;
                             }
@@ -431,6 +658,22 @@ HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUE
                     {
                         if (handleData->k == 2)
                         {
+                            if (poolKey != NULL)
+                            {
+                                if (isConnectionCloseResponse(toBeUsedResponseHttpHeadersHandle))
+                                {
+                                    /*Codes_SRS_HTTPAPIEX_01_009: [ If the Connection header of the response lists a `close` token, compared case-insensitively among its comma-separated tokens, the connection shall be closed instead. ]*/
+                                    HTTPAPI_CloseConnection(handleData->httpHandle);
+                                }
+                                else
+                                {
+                                    /*Codes_SRS_HTTPAPIEX_01_008: [ When the handle uses a pool, after a successful HTTPAPI_ExecuteRequest the connection shall be handed back to the pool by calling HTTPAPIEX_POOL_Checkin. ]*/
+                                    (void)HTTPAPIEX_POOL_Checkin(handleData->pool, poolKey, handleData->httpHandle);
+                                }
+                                handleData->httpHandle = NULL;
+                                handleData->k = 1;
+                            }
+
                             /*Codes_SRS_HTTPAPIEX_02_028: [HTTPAPIEX_ExecuteRequest shall return HTTPAPIEX_OK when a call to HTTPAPI_ExecuteRequest has been completed successfully.]*/
                             result = HTTPAPIEX_OK;
                             goto out;
@@ -457,6 +700,13 @@ HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUE
                         {
                             HTTPAPI_CloseConnection(handleData->httpHandle);
                             handleData->httpHandle = NULL;
+                            if (isPooledConnection)
+                            {
+                                /*Codes_SRS_HTTPAPIEX_01_010: [ If a connection taken from the pool fails, step 2 shall be repeated with a connection from HTTPAPI_CreateConnection, and that shall not count as a retry of step 2. ]*/
+                                isPooledConnection = false;
+                                canCheckout = false;
+                                st[1] = false;
+                            }
                             break;
                         }
                         case 2:
@@ -498,6 +748,161 @@ HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUE
 }
 
 
+static void onAsyncRequestComplete(void* context, HTTPAPI_ASYNC_RESULT result, unsigned int statusCode, HTTP_HEADERS_HANDLE responseHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    HTTPAPIEX_ASYNC_CONTEXT* asyncContext = (HTTPAPIEX_ASYNC_CONTEXT*)context;
+    HTTPAPIEX_RESULT asyncResult;
+
+    switch (result)
+    {
+    case HTTPAPI_ASYNC_OK:
+        /*Codes_SRS_HTTPAPIEX_01_017: [ When the request completes, onRequestComplete shall be called with HTTPAPIEX_OK, the status code, the response headers and the response content. ]*/
+        asyncResult = HTTPAPIEX_OK;
+        break;
+    case HTTPAPI_ASYNC_CANCELLED:
+        /*Codes_SRS_HTTPAPIEX_01_019: [ Requests that did not complete when the handle is destroyed shall complete with HTTPAPIEX_ERROR. ]*/
+        asyncResult = HTTPAPIEX_ERROR;
+        break;
+    default:
+        /*Codes_SRS_HTTPAPIEX_01_018: [ If the request fails or times out, onRequestComplete shall be called with HTTPAPIEX_RECOVERYFAILED. ]*/
+        asyncResult = HTTPAPIEX_RECOVERYFAILED;
+        break;
+    }
+
+    asyncContext->onRequestComplete(asyncContext->callbackContext, asyncResult, statusCode, responseHeadersHandle, responseContent);
+    free(asyncContext);
+}
+
+/*the async requests get their own connections, created with the options saved so far*/
+static HTTPAPI_ASYNC_HANDLE getAsyncRequests(HTTPAPIEX_HANDLE_DATA* handleData)
+{
+    if (handleData->asyncRequests == NULL)
+    {
+        /*Codes_SRS_HTTPAPIEX_01_014: [ The first call shall create the async requests engine of the handle by calling httpapi_async_create with the host name and pass it all the saved options. ]*/
+        handleData->asyncRequests = httpapi_async_create(STRING_c_str(handleData->hostName), HTTPAPIEX_ASYNC_MAX_CONNECTIONS);
+        if (handleData->asyncRequests == NULL)
+        {
+            LogError("unable to httpapi_async_create");
+        }
+        else
+        {
+            size_t i;
+            size_t vectorSize = VECTOR_size(handleData->savedOptions);
+            for (i = 0; i < vectorSize; i++)
+            {
+                HTTPAPIEX_SAVED_OPTION* option = (HTTPAPIEX_SAVED_OPTION*)VECTOR_element(handleData->savedOptions, i);
+                if (httpapi_async_set_option(handleData->asyncRequests, option->optionName, option->value) != 0)
+                {
+                    /*Codes_SRS_HTTPAPIEX_01_023: [ If the async requests engine rejects one of the saved options, like a proxy or any other option that is not a TLS identity option or "timeout", HTTPAPIEX_ExecuteRequestAsync shall destroy the engine, fail and return HTTPAPIEX_ERROR, so the requests are never sent without a setting of the handle. ]*/
+                    LogError("option %s does not apply to async requests", option->optionName);
+                    httpapi_async_destroy(handleData->asyncRequests);
+                    handleData->asyncRequests = NULL;
+                    break;
+                }
+            }
+        }
+    }
+
+    return handleData->asyncRequests;
+}
+
+HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequestAsync(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE requestHttpHeadersHandle, BUFFER_HANDLE requestContent, ON_HTTPAPIEX_REQUEST_COMPLETE onRequestComplete, void* callbackContext)
+{
+    HTTPAPIEX_RESULT result;
+    /*Codes_SRS_HTTPAPIEX_01_012: [ If handle or onRequestComplete is NULL, or requestType does not indicate a valid request, HTTPAPIEX_ExecuteRequestAsync shall fail and return HTTPAPIEX_INVALID_ARG. ]*/
+    if ((handle == NULL) ||
+        (onRequestComplete == NULL) ||
+        (requestType >= COUNT_ARG(HTTPAPI_REQUEST_TYPE_VALUES)))
+    {
+        result = HTTPAPIEX_INVALID_ARG;
+        LOG_HTTAPIEX_ERROR();
+    }
+    else
+    {
+        HTTPAPIEX_HANDLE_DATA* handleData = (HTTPAPIEX_HANDLE_DATA*)handle;
+        HTTPAPI_ASYNC_HANDLE asyncRequests;
+        HTTP_HEADERS_HANDLE toBeUsedRequestHttpHeadersHandle; bool isOriginalRequestHttpHeadersHandle;
+        BUFFER_HANDLE toBeUsedRequestContent; bool isOriginalRequestContent;
+        HTTPAPIEX_ASYNC_CONTEXT* asyncContext;
+
+        if (handleData->isAsyncOptionRejected)
+        {
+            /*Codes_SRS_HTTPAPIEX_01_022: [ When the option was saved and the handle has an async requests engine, HTTPAPIEX_SetOption shall pass the option to it by calling httpapi_async_set_option; if that fails, the following calls to HTTPAPIEX_ExecuteRequestAsync shall fail and return HTTPAPIEX_ERROR. ]*/
+            result = HTTPAPIEX_ERROR;
+            LOG_HTTAPIEX_ERROR();
+        }
+        else if ((asyncRequests = getAsyncRequests(handleData)) == NULL)
+        {
+            /*Codes_SRS_HTTPAPIEX_01_016: [ If any error occurs, HTTPAPIEX_ExecuteRequestAsync shall fail and return HTTPAPIEX_ERROR, and onRequestComplete shall not be called. ]*/
+            result = HTTPAPIEX_ERROR;
+            LOG_HTTAPIEX_ERROR();
+        }
+        else if (buildBufferIfNotExist(requestContent, &isOriginalRequestContent, &toBeUsedRequestContent) != 0)
+        {
+            result = HTTPAPIEX_ERROR;
+            LOG_HTTAPIEX_ERROR();
+        }
+        else
+        {
+            /*Codes_SRS_HTTPAPIEX_01_013: [ HTTPAPIEX_ExecuteRequestAsync shall build the request headers, relative path and content the same way HTTPAPIEX_ExecuteRequest does. ]*/
+            if (buildRequestHttpHeadersHandle(handleData, toBeUsedRequestContent, requestHttpHeadersHandle, &isOriginalRequestHttpHeadersHandle, &toBeUsedRequestHttpHeadersHandle) != 0)
+            {
+                result = HTTPAPIEX_ERROR;
+                LOG_HTTAPIEX_ERROR();
+            }
+            else
+            {
+                if ((asyncContext = (HTTPAPIEX_ASYNC_CONTEXT*)malloc(sizeof(HTTPAPIEX_ASYNC_CONTEXT))) == NULL)
+                {
+                    result = HTTPAPIEX_ERROR;
+                    LOG_HTTAPIEX_ERROR();
+                }
+                else
+                {
+                    asyncContext->onRequestComplete = onRequestComplete;
+                    asyncContext->callbackContext = callbackContext;
+
+                    /*Codes_SRS_HTTPAPIEX_01_015: [ HTTPAPIEX_ExecuteRequestAsync shall queue the request by calling httpapi_async_execute_request and return HTTPAPIEX_OK. ]*/
+                    if (httpapi_async_execute_request(asyncRequests, requestType, (relativePath == NULL) ? "" : relativePath, toBeUsedRequestHttpHeadersHandle,
+                        BUFFER_u_char(toBeUsedRequestContent), BUFFER_length(toBeUsedRequestContent), onAsyncRequestComplete, asyncContext) != 0)
+                    {
+                        free(asyncContext);
+                        result = HTTPAPIEX_ERROR;
+                        LOG_HTTAPIEX_ERROR();
+                    }
+                    else
+                    {
+                        result = HTTPAPIEX_OK;
+                    }
+                }
+
+                /*the request has been copied, the temporaries are not needed past this point*/
+                if (isOriginalRequestHttpHeadersHandle == false)
+                {
+                    HTTPHeaders_Free(toBeUsedRequestHttpHeadersHandle);
+                }
+            }
+
+            if (isOriginalRequestContent == false)
+            {
+                BUFFER_delete(toBeUsedRequestContent);
+            }
+        }
+    }
+    return result;
+}
+
+void HTTPAPIEX_DoWork(HTTPAPIEX_HANDLE handle)
+{
+    /*Codes_SRS_HTTPAPIEX_01_020: [ If handle is NULL, HTTPAPIEX_DoWork shall do nothing. ]*/
+    if ((handle != NULL) && (((HTTPAPIEX_HANDLE_DATA*)handle)->asyncRequests != NULL))
+    {
+        /*Codes_SRS_HTTPAPIEX_01_021: [ HTTPAPIEX_DoWork shall call httpapi_async_dowork when requests have been queued on the handle. ]*/
+        httpapi_async_dowork(((HTTPAPIEX_HANDLE_DATA*)handle)->asyncRequests);
+    }
+}
+
 void HTTPAPIEX_Destroy(HTTPAPIEX_HANDLE handle)
 {
     if (handle != NULL)
@@ -506,13 +911,26 @@ void HTTPAPIEX_Destroy(HTTPAPIEX_HANDLE handle)
         size_t i;
         size_t vectorSize;
         HTTPAPIEX_HANDLE_DATA* handleData = (HTTPAPIEX_HANDLE_DATA*)handle;
-        
-        if (handleData->k == 2)
+
+        if (handleData->asyncRequests != NULL)
+        {
+            httpapi_async_destroy(handleData->asyncRequests);
+        }
+
+        /*handles using a pool keep HTTPAPI initialized between requests without holding a connection*/
+        if (handleData->httpHandle != NULL)
         {
             HTTPAPI_CloseConnection(handleData->httpHandle);
+        }
+        if (handleData->k >= 1)
+        {
             HTTPAPI_Deinit();
         }
         STRING_delete(handleData->hostName);
+        if (handleData->poolKey != NULL)
+        {
+            STRING_delete(handleData->poolKey);
+        }
 
         vectorSize = VECTOR_size(handleData->savedOptions);
         for (i = 0; i < vectorSize; i++)
@@ -627,6 +1045,27 @@ HTTPAPIEX_RESULT HTTPAPIEX_SetOption(HTTPAPIEX_HANDLE handle, const char* option
             }
             else
             {
+                if (handleData->isPoolKeyValid)
+                {
+                    /*Codes_SRS_HTTPAPIEX_01_011: [ When the option was saved, HTTPAPIEX_SetOption shall discard the key that the connections of the handle are pooled under. ]*/
+                    if (handleData->poolKey != NULL)
+                    {
+                        STRING_delete(handleData->poolKey);
+                        handleData->poolKey = NULL;
+                    }
+                    handleData->isPoolKeyValid = false;
+                }
+
+                if (handleData->asyncRequests != NULL)
+                {
+                    /*Codes_SRS_HTTPAPIEX_01_022: [ When the option was saved and the handle has an async requests engine, HTTPAPIEX_SetOption shall pass the option to it by calling httpapi_async_set_option; if that fails, the following calls to HTTPAPIEX_ExecuteRequestAsync shall fail and return HTTPAPIEX_ERROR. ]*/
+                    if (httpapi_async_set_option(handleData->asyncRequests, optionName, value) != 0)
+                    {
+                        LogError("option %s does not apply to async requests", optionName);
+                        handleData->isAsyncOptionRejected = true;
+                    }
+                }
+
                 /*Codes_SRS_HTTPAPIEX_02_031: [If HTTPAPI_HANDLE exists then HTTPAPIEX_SetOption shall call HTTPAPI_SetOption passing the same optionName and value and shall return a value conforming to the below table:] */
                 if (handleData->httpHandle != NULL)
                 {
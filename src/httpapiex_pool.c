@@ -0,0 +1,286 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <string.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/httpapiex_pool.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/vector.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/tickcounter.h"
+
+typedef struct POOLED_CONNECTION_TAG
+{
+    char* key;
+    HTTP_HANDLE httpHandle;
+    tickcounter_ms_t idleSince;
+} POOLED_CONNECTION;
+
+typedef struct HTTPAPIEX_POOL_INSTANCE_TAG
+{
+    size_t maxConnectionsPerHost;
+    tickcounter_ms_t idleTimeoutInMs;
+    LOCK_HANDLE lock;
+    TICK_COUNTER_HANDLE tickCounter;
+    /*idle connections in check in order, so the ones that expire first are always at the front*/
+    VECTOR_HANDLE idleConnections;
+} HTTPAPIEX_POOL_INSTANCE;
+
+/*takes the oldest idle connection out of the pool if it outlived the idle timeout, returns NULL otherwise*/
+static HTTP_HANDLE takeExpiredConnection(HTTPAPIEX_POOL_INSTANCE* pool)
+{
+    HTTP_HANDLE result = NULL;
+
+    if (Lock(pool->lock) != LOCK_OK)
+    {
+        LogError("unable to Lock");
+    }
+    else
+    {
+        tickcounter_ms_t now;
+        POOLED_CONNECTION* oldest;
+        if ((VECTOR_size(pool->idleConnections) > 0) &&
+            ((oldest = (POOLED_CONNECTION*)VECTOR_front(pool->idleConnections)) != NULL) &&
+            (tickcounter_get_current_ms(pool->tickCounter, &now) == 0) &&
+            (now - oldest->idleSince >= pool->idleTimeoutInMs))
+        {
+            result = oldest->httpHandle;
+            free(oldest->key);
+            VECTOR_erase(pool->idleConnections, oldest, 1);
+        }
+
+        (void)Unlock(pool->lock);
+    }
+
+    return result;
+}
+
+/*connections are closed outside of the lock, closing a TLS connection can take a while*/
+static void closeExpiredConnections(HTTPAPIEX_POOL_INSTANCE* pool)
+{
+    HTTP_HANDLE expired;
+    while ((expired = takeExpiredConnection(pool)) != NULL)
+    {
+        HTTPAPI_CloseConnection(expired);
+    }
+}
+
+HTTPAPIEX_POOL_HANDLE HTTPAPIEX_POOL_Create(size_t maxConnectionsPerHost, unsigned int idleTimeoutInMs)
+{
+    HTTPAPIEX_POOL_INSTANCE* result;
+
+    /*Codes_SRS_HTTPAPIEX_POOL_01_001: [ If maxConnectionsPerHost is 0, HTTPAPIEX_POOL_Create shall fail and return NULL. ]*/
+    if (maxConnectionsPerHost == 0)
+    {
+        LogError("invalid (zero) maxConnectionsPerHost");
+        result = NULL;
+    }
+    else
+    {
+        /*Codes_SRS_HTTPAPIEX_POOL_01_002: [ HTTPAPIEX_POOL_Create shall allocate a new pool, call HTTPAPI_Init, create a lock, a tick counter and an empty vector of idle connections. ]*/
+        result = (HTTPAPIEX_POOL_INSTANCE*)malloc(sizeof(HTTPAPIEX_POOL_INSTANCE));
+        if (result == NULL)
+        {
+            /*Codes_SRS_HTTPAPIEX_POOL_01_003: [ If any error occurs, HTTPAPIEX_POOL_Create shall fail and return NULL. ]*/
+            LogError("malloc failed.");
+        }
+        else if (HTTPAPI_Init() != HTTPAPI_OK)
+        {
+            LogError("unable to HTTPAPI_Init");
+            free(result);
+            result = NULL;
+        }
+        else if ((result->lock = Lock_Init()) == NULL)
+        {
+            LogError("unable to Lock_Init");
+            HTTPAPI_Deinit();
+            free(result);
+            result = NULL;
+        }
+        else if ((result->tickCounter = tickcounter_create()) == NULL)
+        {
+            LogError("unable to tickcounter_create");
+            (void)Lock_Deinit(result->lock);
+            HTTPAPI_Deinit();
+            free(result);
+            result = NULL;
+        }
+        else if ((result->idleConnections = VECTOR_create(sizeof(POOLED_CONNECTION))) == NULL)
+        {
+            LogError("unable to VECTOR_create");
+            tickcounter_destroy(result->tickCounter);
+            (void)Lock_Deinit(result->lock);
+            HTTPAPI_Deinit();
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            result->maxConnectionsPerHost = maxConnectionsPerHost;
+            result->idleTimeoutInMs = idleTimeoutInMs;
+        }
+    }
+
+    return result;
+}
+
+void HTTPAPIEX_POOL_Destroy(HTTPAPIEX_POOL_HANDLE pool)
+{
+    /*Codes_SRS_HTTPAPIEX_POOL_01_004: [ If pool is NULL, HTTPAPIEX_POOL_Destroy shall do nothing. ]*/
+    if (pool != NULL)
+    {
+        /*Codes_SRS_HTTPAPIEX_POOL_01_005: [ HTTPAPIEX_POOL_Destroy shall close all the idle connections, free all the resources of the pool and call HTTPAPI_Deinit. ]*/
+        size_t i;
+        size_t count = VECTOR_size(pool->idleConnections);
+        for (i = 0; i < count; i++)
+        {
+            POOLED_CONNECTION* connection = (POOLED_CONNECTION*)VECTOR_element(pool->idleConnections, i);
+            HTTPAPI_CloseConnection(connection->httpHandle);
+            free(connection->key);
+        }
+        VECTOR_destroy(pool->idleConnections);
+        tickcounter_destroy(pool->tickCounter);
+        (void)Lock_Deinit(pool->lock);
+        HTTPAPI_Deinit();
+        free(pool);
+    }
+}
+
+HTTP_HANDLE HTTPAPIEX_POOL_Checkout(HTTPAPIEX_POOL_HANDLE pool, const char* key)
+{
+    HTTP_HANDLE result;
+
+    /*Codes_SRS_HTTPAPIEX_POOL_01_006: [ If pool or key is NULL, HTTPAPIEX_POOL_Checkout shall return NULL. ]*/
+    if ((pool == NULL) || (key == NULL))
+    {
+        LogError("invalid argument pool=%p, key=%p", pool, key);
+        result = NULL;
+    }
+    else
+    {
+        /*Codes_SRS_HTTPAPIEX_POOL_01_007: [ HTTPAPIEX_POOL_Checkout shall first close the idle connections that have been idle for idleTimeoutInMs or longer. ]*/
+        closeExpiredConnections(pool);
+
+        result = NULL;
+        if (Lock(pool->lock) != LOCK_OK)
+        {
+            /*Codes_SRS_HTTPAPIEX_POOL_01_009: [ If locking fails, HTTPAPIEX_POOL_Checkout shall return NULL. ]*/
+            LogError("unable to Lock");
+        }
+        else
+        {
+            /*Codes_SRS_HTTPAPIEX_POOL_01_008: [ HTTPAPIEX_POOL_Checkout shall remove from the pool and return the most recently checked in idle connection for key, or return NULL if there is none. ]*/
+            size_t i = VECTOR_size(pool->idleConnections);
+            while (i > 0)
+            {
+                POOLED_CONNECTION* connection = (POOLED_CONNECTION*)VECTOR_element(pool->idleConnections, --i);
+                if (strcmp(connection->key, key) == 0)
+                {
+                    result = connection->httpHandle;
+                    free(connection->key);
+                    VECTOR_erase(pool->idleConnections, connection, 1);
+                    break;
+                }
+            }
+
+            (void)Unlock(pool->lock);
+        }
+    }
+
+    return result;
+}
+
+int HTTPAPIEX_POOL_Checkin(HTTPAPIEX_POOL_HANDLE pool, const char* key, HTTP_HANDLE httpHandle)
+{
+    int result;
+
+    if ((pool == NULL) || (key == NULL) || (httpHandle == NULL))
+    {
+        /*Codes_SRS_HTTPAPIEX_POOL_01_010: [ If pool, key or httpHandle is NULL, HTTPAPIEX_POOL_Checkin shall close httpHandle if it is not NULL and return a non-zero value. ]*/
+        LogError("invalid argument pool=%p, key=%p, httpHandle=%p", pool, key, httpHandle);
+        if (httpHandle != NULL)
+        {
+            HTTPAPI_CloseConnection(httpHandle);
+        }
+        result = __FAILURE__;
+    }
+    else
+    {
+        closeExpiredConnections(pool);
+
+        if (Lock(pool->lock) != LOCK_OK)
+        {
+            LogError("unable to Lock");
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t i;
+            size_t count = VECTOR_size(pool->idleConnections);
+            size_t sameKey = 0;
+            POOLED_CONNECTION connection;
+
+            for (i = 0; i < count; i++)
+            {
+                if (strcmp(((POOLED_CONNECTION*)VECTOR_element(pool->idleConnections, i))->key, key) == 0)
+                {
+                    sameKey++;
+                }
+            }
+
+            if (sameKey >= pool->maxConnectionsPerHost)
+            {
+                /*Codes_SRS_HTTPAPIEX_POOL_01_012: [ If the pool already holds maxConnectionsPerHost idle connections for key, HTTPAPIEX_POOL_Checkin shall close httpHandle and return a non-zero value. ]*/
+                result = __FAILURE__;
+            }
+            else if (tickcounter_get_current_ms(pool->tickCounter, &connection.idleSince) != 0)
+            {
+                LogError("unable to tickcounter_get_current_ms");
+                result = __FAILURE__;
+            }
+            else if (mallocAndStrcpy_s(&connection.key, key) != 0)
+            {
+                LogError("unable to copy the key");
+                result = __FAILURE__;
+            }
+            else
+            {
+                /*Codes_SRS_HTTPAPIEX_POOL_01_011: [ HTTPAPIEX_POOL_Checkin shall add httpHandle to the idle connections of key, stamped with the current time, and return 0. ]*/
+                connection.httpHandle = httpHandle;
+                if (VECTOR_push_back(pool->idleConnections, &connection, 1) != 0)
+                {
+                    LogError("unable to VECTOR_push_back");
+                    free(connection.key);
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    result = 0;
+                }
+            }
+
+            (void)Unlock(pool->lock);
+        }
+
+        if (result != 0)
+        {
+            /*Codes_SRS_HTTPAPIEX_POOL_01_013: [ If any other error occurs, HTTPAPIEX_POOL_Checkin shall close httpHandle and return a non-zero value. ]*/
+            HTTPAPI_CloseConnection(httpHandle);
+        }
+    }
+
+    return result;
+}
+
+void HTTPAPIEX_POOL_DoWork(HTTPAPIEX_POOL_HANDLE pool)
+{
+    /*Codes_SRS_HTTPAPIEX_POOL_01_014: [ If pool is NULL, HTTPAPIEX_POOL_DoWork shall do nothing. ]*/
+    if (pool != NULL)
+    {
+        /*Codes_SRS_HTTPAPIEX_POOL_01_015: [ HTTPAPIEX_POOL_DoWork shall close the idle connections that have been idle for idleTimeoutInMs or longer. ]*/
+        closeExpiredConnections(pool);
+    }
+}
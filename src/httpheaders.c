@@ -299,6 +299,50 @@ HTTP_HEADERS_RESULT HTTPHeaders_GetHeader(HTTP_HEADERS_HANDLE handle, size_t ind
     return result;
 }
 
+HTTP_HEADERS_RESULT HTTPHeaders_GetHeaderNameValue(HTTP_HEADERS_HANDLE handle, size_t index, const char** name, const char** value)
+{
+    HTTP_HEADERS_RESULT result;
+
+    /*Codes_SRS_HTTP_HEADERS_01_002: [ If handle, name or value is NULL, HTTPHeaders_GetHeaderNameValue shall return HTTP_HEADERS_INVALID_ARG. ]*/
+    if (
+        (handle == NULL) ||
+        (name == NULL) ||
+        (value == NULL)
+        )
+    {
+        result = HTTP_HEADERS_INVALID_ARG;
+        LogError("invalid arg (NULL), result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+    }
+    else
+    {
+        HTTP_HEADERS_HANDLE_DATA* handleData = (HTTP_HEADERS_HANDLE_DATA*)handle;
+        const char*const* keys;
+        const char*const* values;
+        size_t headerCount;
+        if (Map_GetInternals(handleData->headers, &keys, &values, &headerCount) != MAP_OK)
+        {
+            /*Codes_SRS_HTTP_HEADERS_01_004: [ If Map_GetInternals fails, HTTPHeaders_GetHeaderNameValue shall return HTTP_HEADERS_ERROR. ]*/
+            result = HTTP_HEADERS_ERROR;
+            LogError("Map_GetInternals failed, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+        }
+        else if (index >= headerCount)
+        {
+            /*Codes_SRS_HTTP_HEADERS_01_003: [ If index is not smaller than the number of stored headers, HTTPHeaders_GetHeaderNameValue shall return HTTP_HEADERS_INVALID_ARG. ]*/
+            result = HTTP_HEADERS_INVALID_ARG;
+            LogError("index out of bounds, result= %s", ENUM_TO_STRING(HTTP_HEADERS_RESULT, result));
+        }
+        else
+        {
+            /*Codes_SRS_HTTP_HEADERS_01_001: [ HTTPHeaders_GetHeaderNameValue shall point name and value at the stored name and value of the index header, without copying them, and return HTTP_HEADERS_OK. ]*/
+            *name = keys[index];
+            *value = values[index];
+            result = HTTP_HEADERS_OK;
+        }
+    }
+
+    return result;
+}
+
 HTTP_HEADERS_HANDLE HTTPHeaders_Clone(HTTP_HEADERS_HANDLE handle)
 {
     HTTP_HEADERS_HANDLE_DATA* result;
@@ -6,20 +6,30 @@
 #include <string.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/sastoken.h"
-#include "azure_c_shared_utility/urlencode.h"
-#include "azure_c_shared_utility/hmacsha256.h"
+#include "azure_c_shared_utility/hash.h"
+#include "azure_c_shared_utility/sha.h"
 #include "azure_c_shared_utility/base64.h"
 #include "azure_c_shared_utility/agenttime.h"
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/buffer_.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/optimize_size.h"
 
-static double getExpiryValue(const char* expiryASCII)
+#define SAS_TOKEN_PREFIX "SharedAccessSignature sr="
+#define SAS_SIGNATURE_FIELD "&sig="
+#define SAS_EXPIRY_FIELD "&se="
+#define SAS_KEYNAME_FIELD "&skn="
+
+/* base64 of a SHA-256 hash is 44 characters, and URL encoding expands each of them to at most 3 */
+#define SAS_BASE64_SIGNATURE_SIZE ((((SHA256HashSize + 2) / 3) * 4) + 1)
+#define SAS_URL_ENCODED_SIGNATURE_SIZE ((SAS_BASE64_SIGNATURE_SIZE - 1) * 3 + 1)
+
+static double getExpiryValue(const char* expiryASCII, size_t length)
 {
     double value = 0;
     size_t i = 0;
-    for (i = 0; expiryASCII[i] != '\0'; i++)
+    for (i = 0; (i < length) && (expiryASCII[i] != '&'); i++)
     {
         if (expiryASCII[i] >= '0' && expiryASCII[i] <= '9')
         {
@@ -152,48 +162,27 @@ bool SASToken_Validate(STRING_HANDLE sasToken)
             }
             else
             {
-                char* expiryASCII = (char*)malloc(seStop - seStart + 1);
-                /*Codes_SRS_SASTOKEN_25_031: [**If malloc fails during validation then SASToken_Validate shall return false.**]***/
-                if (expiryASCII == NULL)
+                /*Codes_SRS_SASTOKEN_01_001: [SASToken_Validate shall read the se value in place from the token, without allocating memory.]*/
+                /* The se contains the expiration value; if a & is encountered then the se field is complete. */
+                double expiry = getExpiryValue(sasTokenArray + seStart, (size_t)(seStop - seStart));
+                /*Codes_SRS_SASTOKEN_25_029: [**SASToken_validate shall check for expiry time from token and if token has expired then would return false **]***/
+                if (expiry <= 0)
                 {
                     result = false;
                 }
                 else
                 {
-                    double expiry;
-                    // Add the Null terminator here
-                    memset(expiryASCII, 0, seStop - seStart + 1);
-                    for (i = seStart; i < seStop; i++)
-                    {
-                        // The se contains the expiration values, if a & token is encountered then 
-                        // the se field is complete.
-                        if (sasTokenArray[i] == '&')
-                        {
-                            break;
-                        }
-                        expiryASCII[i - seStart] = sasTokenArray[i];
-                    }
-                    expiry = getExpiryValue(expiryASCII);
-                    /*Codes_SRS_SASTOKEN_25_029: [**SASToken_validate shall check for expiry time from token and if token has expired then would return false **]***/
-                    if (expiry <= 0)
+                    double secSinceEpoch = get_difftime(get_time(NULL), (time_t)0);
+                    if (expiry < secSinceEpoch)
                     {
+                        /*Codes_SRS_SASTOKEN_25_029: [**SASToken_validate shall check for expiry time from token and if token has expired then would return false **]***/
                         result = false;
                     }
                     else
                     {
-                        double secSinceEpoch = get_difftime(get_time(NULL), (time_t)0);
-                        if (expiry < secSinceEpoch)
-                        {
-                            /*Codes_SRS_SASTOKEN_25_029: [**SASToken_validate shall check for expiry time from token and if token has expired then would return false **]***/
-                            result = false;
-                        }
-                        else
-                        {
-                            /*Codes_SRS_SASTOKEN_25_030: [**SASToken_validate shall return true only if the format is obeyed and the token has not yet expired **]***/
-                            result = true;
-                        }
+                        /*Codes_SRS_SASTOKEN_25_030: [**SASToken_validate shall return true only if the format is obeyed and the token has not yet expired **]***/
+                        result = true;
                     }
-                    free(expiryASCII);
                 }
             }
         }
@@ -202,12 +191,45 @@ bool SASToken_Validate(STRING_HANDLE sasToken)
     return result;
 }
 
-static STRING_HANDLE construct_sas_token(const char* key, const char* scope, const char* keyname, size_t expiry)
+static char* append_signature_char(char* position, char base64Char)
 {
-    STRING_HANDLE result;
+    /* '+', '/' and '=' are the only base64 characters that need URL encoding */
+    switch (base64Char)
+    {
+        case '+':
+            *position++ = '%'; *position++ = '2'; *position++ = 'b';
+            break;
+        case '/':
+            *position++ = '%'; *position++ = '2'; *position++ = 'f';
+            break;
+        case '=':
+            *position++ = '%'; *position++ = '3'; *position++ = 'd';
+            break;
+        default:
+            *position++ = base64Char;
+            break;
+    }
 
-    char tokenExpirationTime[32] = { 0 };
+    return position;
+}
 
+/* URL encodes a base64 signature, returning the encoded length */
+static size_t url_encode_signature(const char* base64Signature, char* urlEncodedSignature)
+{
+    char* position = urlEncodedSignature;
+
+    while (*base64Signature != '\0')
+    {
+        position = append_signature_char(position, *base64Signature++);
+    }
+
+    *position = '\0';
+    return (size_t)(position - urlEncodedSignature);
+}
+
+static int compute_signature(const char* key, const char* scope, const char* tokenExpirationTime, char* urlEncodedSignature, size_t* urlEncodedSignatureLength)
+{
+    int result;
     BUFFER_HANDLE decodedKey;
 
     /*Codes_SRS_SASTOKEN_06_029: [The key parameter is decoded from base64.]*/
@@ -215,90 +237,168 @@ static STRING_HANDLE construct_sas_token(const char* key, const char* scope, con
     {
         /*Codes_SRS_SASTOKEN_06_030: [If there is an error in the decoding then SASToken_Create shall return NULL.]*/
         LogError("Unable to decode the key for generating the SAS.");
-        result = NULL;
+        result = __FAILURE__;
     }
     else
     {
-        /*Codes_SRS_SASTOKEN_06_026: [If the conversion to string form fails for any reason then SASToken_Create shall return NULL.]*/
-        if (size_tToString(tokenExpirationTime, sizeof(tokenExpirationTime), expiry) != 0)
+        const unsigned char* keyBytes = BUFFER_u_char(decodedKey);
+        size_t keyLength = BUFFER_length(decodedKey);
+        HASH_HANDLE hmac;
+
+        /*Codes_SRS_SASTOKEN_06_009: [The scope is the basis for creating a STRING_HANDLE.]*/
+        /*Codes_SRS_SASTOKEN_06_010: [A "\n" is appended to that string.]*/
+        /*Codes_SRS_SASTOKEN_06_011: [tokenExpirationTime is appended to that string.]*/
+        /*Codes_SRS_SASTOKEN_06_012: [An HMAC256 hash is calculated using the decodedKey, over toBeHashed.]*/
+        if ((hmac = HASH_CreateHmac(HASH_ALGORITHM_SHA256, keyBytes, keyLength)) == NULL)
         {
-            LogError("For some reason converting seconds to a string failed.  No SAS can be generated.");
-            result = NULL;
+            /*Codes_SRS_SASTOKEN_06_013: [If an error is returned from the HMAC256 function then NULL is returned from SASToken_Create.]*/
+            LogError("Unable to create the HMAC to prepare SAS token.");
+            result = __FAILURE__;
         }
         else
         {
-            STRING_HANDLE toBeHashed = NULL;
-            BUFFER_HANDLE hash = NULL;
-            if (((hash = BUFFER_new()) == NULL) ||
-                ((toBeHashed = STRING_new()) == NULL) ||
-                ((result = STRING_new()) == NULL))
+            /* the HMAC keeps its own copy of the key, so the decoded key buffer receives the hash */
+            if ((HASH_Update(hmac, (const unsigned char*)scope, strlen(scope)) != 0) ||
+                (HASH_Update(hmac, (const unsigned char*)"\n", 1) != 0) ||
+                (HASH_Update(hmac, (const unsigned char*)tokenExpirationTime, strlen(tokenExpirationTime)) != 0) ||
+                (HASH_Final(hmac, decodedKey) != 0) ||
+                (BUFFER_length(decodedKey) != SHA256HashSize))
             {
-                LogError("Unable to allocate memory to prepare SAS token.");
-                result = NULL;
+                /*Codes_SRS_SASTOKEN_06_013: [If an error is returned from the HMAC256 function then NULL is returned from SASToken_Create.]*/
+                LogError("Unable to compute the HMAC to prepare SAS token.");
+                result = __FAILURE__;
             }
             else
             {
-                /*Codes_SRS_SASTOKEN_06_009: [The scope is the basis for creating a STRING_HANDLE.]*/
-                /*Codes_SRS_SASTOKEN_06_010: [A "\n" is appended to that string.]*/
-                /*Codes_SRS_SASTOKEN_06_011: [tokenExpirationTime is appended to that string.]*/
-                if ((STRING_concat(toBeHashed, scope) != 0) ||
-                    (STRING_concat(toBeHashed, "\n") != 0) ||
-                    (STRING_concat(toBeHashed, tokenExpirationTime) != 0))
+                char base64Signature[SAS_BASE64_SIGNATURE_SIZE];
+
+                /*Codes_SRS_SASTOKEN_06_015: [The hash is base 64 encoded.]*/
+                if (Base64_Encode_Bytes_Into(BUFFER_u_char(decodedKey), SHA256HashSize, base64Signature, sizeof(base64Signature)) != 0)
                 {
-                    LogError("Unable to build the input to the HMAC to prepare SAS token.");
-                    STRING_delete(result);
-                    result = NULL;
+                    /*Codes_SRS_SASTOKEN_06_014: [If there are any errors from the following operations then NULL shall be returned.]*/
+                    LogError("Unable to base64 encode the signature of the SAS token.");
+                    result = __FAILURE__;
                 }
                 else
                 {
-                    STRING_HANDLE base64Signature = NULL;
-                    STRING_HANDLE urlEncodedSignature = NULL;
-                    size_t inLen = STRING_length(toBeHashed);
-                    const unsigned char* inBuf = (const unsigned char*)STRING_c_str(toBeHashed);
-                    size_t outLen = BUFFER_length(decodedKey);
-                    unsigned char* outBuf = BUFFER_u_char(decodedKey);
-                    /*Codes_SRS_SASTOKEN_06_013: [If an error is returned from the HMAC256 function then NULL is returned from SASToken_Create.]*/
-                    /*Codes_SRS_SASTOKEN_06_012: [An HMAC256 hash is calculated using the decodedKey, over toBeHashed.]*/
-                    /*Codes_SRS_SASTOKEN_06_014: [If there are any errors from the following operations then NULL shall be returned.]*/
-                    /*Codes_SRS_SASTOKEN_06_015: [The hash is base 64 encoded.]*/
                     /*Codes_SRS_SASTOKEN_06_028: [base64Signature shall be url encoded.]*/
-                    /*Codes_SRS_SASTOKEN_06_016: [The string "SharedAccessSignature sr=" is the first part of the result of SASToken_Create.]*/
-                    /*Codes_SRS_SASTOKEN_06_017: [The scope parameter is appended to result.]*/
-                    /*Codes_SRS_SASTOKEN_06_018: [The string "&sig=" is appended to result.]*/
-                    /*Codes_SRS_SASTOKEN_06_019: [The string urlEncodedSignature shall be appended to result.]*/
-                    /*Codes_SRS_SASTOKEN_06_020: [The string "&se=" shall be appended to result.]*/
-                    /*Codes_SRS_SASTOKEN_06_021: [tokenExpirationTime is appended to result.]*/
-                    /*Codes_SRS_SASTOKEN_06_022: [If keyName is non-NULL, the string "&skn=" is appended to result.]*/
-                    /*Codes_SRS_SASTOKEN_06_023: [If keyName is non-NULL, the argument keyName is appended to result.]*/
-                    if ((HMACSHA256_ComputeHash(outBuf, outLen, inBuf, inLen, hash) != HMACSHA256_OK) ||
-                        ((base64Signature = Base64_Encoder(hash)) == NULL) ||
-                        ((urlEncodedSignature = URL_Encode(base64Signature)) == NULL) ||
-                        (STRING_copy(result, "SharedAccessSignature sr=") != 0) ||
-                        (STRING_concat(result, scope) != 0) ||
-                        (STRING_concat(result, "&sig=") != 0) ||
-                        (STRING_concat_with_STRING(result, urlEncodedSignature) != 0) ||
-                        (STRING_concat(result, "&se=") != 0) ||
-                        (STRING_concat(result, tokenExpirationTime) != 0) ||
-                        ((keyname != NULL) && (STRING_concat(result, "&skn=") != 0)) ||
-                        ((keyname != NULL) && (STRING_concat(result, keyname) != 0)))
-                    {
-                        LogError("Unable to build the SAS token.");
-                        STRING_delete(result);
-                        result = NULL;
-                    }
-                    else
-                    {
-                        /* everything OK */
-                    }
-                    STRING_delete(base64Signature);
-                    STRING_delete(urlEncodedSignature);
+                    *urlEncodedSignatureLength = url_encode_signature(base64Signature, urlEncodedSignature);
+                    result = 0;
                 }
             }
-            STRING_delete(toBeHashed);
-            BUFFER_delete(hash);
+
+            HASH_Destroy(hmac);
         }
+
         BUFFER_delete(decodedKey);
     }
+
+    return result;
+}
+
+static size_t get_token_length(size_t scopeLength, size_t signatureLength, size_t expiryLength, const char* keyname, size_t keynameLength)
+{
+    size_t fixedLength = (sizeof(SAS_TOKEN_PREFIX) - 1) + (sizeof(SAS_SIGNATURE_FIELD) - 1) + signatureLength +
+        (sizeof(SAS_EXPIRY_FIELD) - 1) + expiryLength + ((keyname == NULL) ? 0 : (sizeof(SAS_KEYNAME_FIELD) - 1));
+    size_t result;
+
+    /* a token that does not fit in a size_t together with its null terminator cannot be built */
+    if ((scopeLength > ((size_t)-1) - 1 - fixedLength) ||
+        (keynameLength > ((size_t)-1) - 1 - fixedLength - scopeLength))
+    {
+        result = 0;
+    }
+    else
+    {
+        result = fixedLength + scopeLength + keynameLength;
+    }
+
+    return result;
+}
+
+static void write_token(char* token, const char* scope, size_t scopeLength, const char* signature, size_t signatureLength, const char* tokenExpirationTime, size_t expiryLength, const char* keyname, size_t keynameLength)
+{
+    char* position = token;
+
+    /*Codes_SRS_SASTOKEN_06_016: [The string "SharedAccessSignature sr=" is the first part of the result of SASToken_Create.]*/
+    /*Codes_SRS_SASTOKEN_06_017: [The scope parameter is appended to result.]*/
+    /*Codes_SRS_SASTOKEN_06_018: [The string "&sig=" is appended to result.]*/
+    /*Codes_SRS_SASTOKEN_06_019: [The string urlEncodedSignature shall be appended to result.]*/
+    /*Codes_SRS_SASTOKEN_06_020: [The string "&se=" shall be appended to result.]*/
+    /*Codes_SRS_SASTOKEN_06_021: [tokenExpirationTime is appended to result.]*/
+    /*Codes_SRS_SASTOKEN_06_022: [If keyName is non-NULL, the string "&skn=" is appended to result.]*/
+    /*Codes_SRS_SASTOKEN_06_023: [If keyName is non-NULL, the argument keyName is appended to result.]*/
+    (void)memcpy(position, SAS_TOKEN_PREFIX, sizeof(SAS_TOKEN_PREFIX) - 1);
+    position += sizeof(SAS_TOKEN_PREFIX) - 1;
+    (void)memcpy(position, scope, scopeLength);
+    position += scopeLength;
+    (void)memcpy(position, SAS_SIGNATURE_FIELD, sizeof(SAS_SIGNATURE_FIELD) - 1);
+    position += sizeof(SAS_SIGNATURE_FIELD) - 1;
+    (void)memcpy(position, signature, signatureLength);
+    position += signatureLength;
+    (void)memcpy(position, SAS_EXPIRY_FIELD, sizeof(SAS_EXPIRY_FIELD) - 1);
+    position += sizeof(SAS_EXPIRY_FIELD) - 1;
+    (void)memcpy(position, tokenExpirationTime, expiryLength);
+    position += expiryLength;
+    if (keyname != NULL)
+    {
+        (void)memcpy(position, SAS_KEYNAME_FIELD, sizeof(SAS_KEYNAME_FIELD) - 1);
+        position += sizeof(SAS_KEYNAME_FIELD) - 1;
+        (void)memcpy(position, keyname, keynameLength);
+        position += keynameLength;
+    }
+    *position = '\0';
+}
+
+static STRING_HANDLE construct_sas_token(const char* key, const char* scope, const char* keyname, size_t expiry)
+{
+    STRING_HANDLE result;
+    char tokenExpirationTime[32] = { 0 };
+    char urlEncodedSignature[SAS_URL_ENCODED_SIGNATURE_SIZE];
+    size_t signatureLength;
+
+    /*Codes_SRS_SASTOKEN_06_026: [If the conversion to string form fails for any reason then SASToken_Create shall return NULL.]*/
+    if (size_tToString(tokenExpirationTime, sizeof(tokenExpirationTime), expiry) != 0)
+    {
+        LogError("For some reason converting seconds to a string failed.  No SAS can be generated.");
+        result = NULL;
+    }
+    /*Codes_SRS_SASTOKEN_06_014: [If there are any errors from the following operations then NULL shall be returned.]*/
+    else if (compute_signature(key, scope, tokenExpirationTime, urlEncodedSignature, &signatureLength) != 0)
+    {
+        result = NULL;
+    }
+    else
+    {
+        size_t scopeLength = strlen(scope);
+        size_t expiryLength = strlen(tokenExpirationTime);
+        size_t keynameLength = (keyname == NULL) ? 0 : strlen(keyname);
+        size_t tokenLength = get_token_length(scopeLength, signatureLength, expiryLength, keyname, keynameLength);
+        char* token;
+
+        if (tokenLength == 0)
+        {
+            LogError("The SAS token would be too long.");
+            result = NULL;
+        }
+        /*Codes_SRS_SASTOKEN_01_002: [The token shall be written into a single allocation of its exact length, which becomes the returned STRING_HANDLE.]*/
+        else if ((token = (char*)malloc(tokenLength + 1)) == NULL)
+        {
+            LogError("Unable to allocate memory to prepare SAS token.");
+            result = NULL;
+        }
+        else
+        {
+            write_token(token, scope, scopeLength, urlEncodedSignature, signatureLength, tokenExpirationTime, expiryLength, keyname, keynameLength);
+
+            if ((result = STRING_new_with_memory(token)) == NULL)
+            {
+                LogError("Unable to build the SAS token.");
+                free(token);
+            }
+        }
+    }
+
     return result;
 }
 
@@ -344,3 +444,57 @@ STRING_HANDLE SASToken_CreateString(const char* key, const char* scope, const ch
     }
     return result;
 }
+
+int SASToken_CreateString_Into(const char* key, const char* scope, const char* keyName, size_t expiry, char* destination, size_t destinationSize, size_t* tokenLength)
+{
+    int result;
+    char tokenExpirationTime[32] = { 0 };
+    char urlEncodedSignature[SAS_URL_ENCODED_SIGNATURE_SIZE];
+    size_t signatureLength;
+
+    /*Codes_SRS_SASTOKEN_01_003: [If key, scope, destination or tokenLength is NULL, or destinationSize is 0, SASToken_CreateString_Into shall fail and return a non-zero value.]*/
+    if ((key == NULL) ||
+        (scope == NULL) ||
+        (destination == NULL) ||
+        (destinationSize == 0) ||
+        (tokenLength == NULL))
+    {
+        LogError("Invalid Parameter to SASToken_CreateString_Into. key: %p, scope: %p, destination: %p, destinationSize: %lu, tokenLength: %p", key, scope, destination, (unsigned long)destinationSize, tokenLength);
+        result = __FAILURE__;
+    }
+    else if (size_tToString(tokenExpirationTime, sizeof(tokenExpirationTime), expiry) != 0)
+    {
+        /*Codes_SRS_SASTOKEN_01_005: [If any error occurs, SASToken_CreateString_Into shall fail and return a non-zero value.]*/
+        LogError("For some reason converting seconds to a string failed.  No SAS can be generated.");
+        result = __FAILURE__;
+    }
+    else if (compute_signature(key, scope, tokenExpirationTime, urlEncodedSignature, &signatureLength) != 0)
+    {
+        /*Codes_SRS_SASTOKEN_01_005: [If any error occurs, SASToken_CreateString_Into shall fail and return a non-zero value.]*/
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t scopeLength = strlen(scope);
+        size_t expiryLength = strlen(tokenExpirationTime);
+        size_t keyNameLength = (keyName == NULL) ? 0 : strlen(keyName);
+        size_t length = get_token_length(scopeLength, signatureLength, expiryLength, keyName, keyNameLength);
+
+        if ((length == 0) ||
+            (length >= destinationSize))
+        {
+            /*Codes_SRS_SASTOKEN_01_006: [If destinationSize is too small for the token and its null terminator, SASToken_CreateString_Into shall fail and return a non-zero value.]*/
+            LogError("The SAS token does not fit in %lu bytes.", (unsigned long)destinationSize);
+            result = __FAILURE__;
+        }
+        else
+        {
+            /*Codes_SRS_SASTOKEN_01_004: [SASToken_CreateString_Into shall write the same token as SASToken_CreateString into destination, null terminate it, store its length in tokenLength and return 0, without allocating memory for the token.]*/
+            write_token(destination, scope, scopeLength, urlEncodedSignature, signatureLength, tokenExpirationTime, expiryLength, keyName, keyNameLength);
+            *tokenLength = length;
+            result = 0;
+        }
+    }
+
+    return result;
+}
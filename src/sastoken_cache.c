@@ -0,0 +1,401 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include "azure_c_shared_utility/sastoken_cache.h"
+#include "azure_c_shared_utility/sastoken.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/singlylinkedlist.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+typedef struct SASTOKEN_CACHE_ENTRY_TAG
+{
+    /* key, scope and keyName live in the same allocation, right after the entry */
+    const char* key;
+    const char* scope;
+    const char* keyName;
+    size_t stringsSize;
+    STRING_HANDLE token;
+    double expiry;
+    double renewalTime;
+    double lastUsed;
+} SASTOKEN_CACHE_ENTRY;
+
+typedef struct SASTOKEN_CACHE_TAG
+{
+    SINGLYLINKEDLIST_HANDLE entries;
+    size_t tokenLifetime;
+    unsigned int renewalPercentage;
+    SASTOKEN_CACHE_STATISTICS statistics;
+} SASTOKEN_CACHE;
+
+typedef struct ENTRY_MATCH_CONTEXT_TAG
+{
+    const char* key;
+    const char* scope;
+    const char* keyName;
+} ENTRY_MATCH_CONTEXT;
+
+static bool entry_matches(LIST_ITEM_HANDLE list_item, const void* match_context)
+{
+    const SASTOKEN_CACHE_ENTRY* entry = (const SASTOKEN_CACHE_ENTRY*)singlylinkedlist_item_get_value(list_item);
+    const ENTRY_MATCH_CONTEXT* context = (const ENTRY_MATCH_CONTEXT*)match_context;
+
+    return (strcmp(entry->scope, context->scope) == 0) &&
+        (strcmp(entry->key, context->key) == 0) &&
+        ((entry->keyName == NULL) ? (context->keyName == NULL) : ((context->keyName != NULL) && (strcmp(entry->keyName, context->keyName) == 0)));
+}
+
+/* memset followed by free can be dropped by the optimizer, the volatile stores cannot */
+static void clear_memory(void* memory, size_t size)
+{
+    volatile unsigned char* bytes = (volatile unsigned char*)memory;
+    while (size > 0)
+    {
+        *bytes++ = 0;
+        size--;
+    }
+}
+
+static void destroy_token(STRING_HANDLE token)
+{
+    if (token != NULL)
+    {
+        clear_memory((void*)STRING_c_str(token), STRING_length(token));
+        STRING_delete(token);
+    }
+}
+
+static void destroy_entry(SASTOKEN_CACHE_ENTRY* entry)
+{
+    destroy_token(entry->token);
+    clear_memory(entry + 1, entry->stringsSize);
+    free(entry);
+}
+
+static SASTOKEN_CACHE_ENTRY* create_entry(const char* key, const char* scope, const char* keyName)
+{
+    SASTOKEN_CACHE_ENTRY* result;
+    size_t keySize = strlen(key) + 1;
+    size_t scopeSize = strlen(scope) + 1;
+    size_t keyNameSize = (keyName == NULL) ? 0 : strlen(keyName) + 1;
+
+    result = (SASTOKEN_CACHE_ENTRY*)malloc(sizeof(SASTOKEN_CACHE_ENTRY) + keySize + scopeSize + keyNameSize);
+    if (result == NULL)
+    {
+        LogError("Failure allocating SAS token cache entry.");
+    }
+    else
+    {
+        char* strings = (char*)(result + 1);
+
+        (void)memcpy(strings, key, keySize);
+        result->key = strings;
+        (void)memcpy(strings + keySize, scope, scopeSize);
+        result->scope = strings + keySize;
+        if (keyName == NULL)
+        {
+            result->keyName = NULL;
+        }
+        else
+        {
+            (void)memcpy(strings + keySize + scopeSize, keyName, keyNameSize);
+            result->keyName = strings + keySize + scopeSize;
+        }
+        result->stringsSize = keySize + scopeSize + keyNameSize;
+        result->token = NULL;
+        result->expiry = 0;
+        result->renewalTime = 0;
+        result->lastUsed = 0;
+    }
+
+    return result;
+}
+
+static int renew_entry(SASTOKEN_CACHE* cache, SASTOKEN_CACHE_ENTRY* entry, double now)
+{
+    int result;
+    double expiry = now + (double)cache->tokenLifetime;
+    STRING_HANDLE newToken = SASToken_CreateString(entry->key, entry->scope, entry->keyName, (size_t)expiry);
+
+    if (newToken == NULL)
+    {
+        LogError("Unable to create a new SAS token.");
+        result = __FAILURE__;
+    }
+    else
+    {
+        destroy_token(entry->token);
+        entry->token = newToken;
+        entry->expiry = expiry;
+        entry->renewalTime = now + ((double)cache->tokenLifetime * cache->renewalPercentage) / 100;
+        result = 0;
+    }
+
+    return result;
+}
+
+static bool get_now(double* now)
+{
+    bool result;
+    time_t currentTime = get_time(NULL);
+
+    if (currentTime == (time_t)-1)
+    {
+        LogError("Time does not appear to be working.");
+        result = false;
+    }
+    else
+    {
+        *now = get_difftime(currentTime, (time_t)0);
+        result = true;
+    }
+
+    return result;
+}
+
+SASTOKEN_CACHE_HANDLE SASTokenCache_Create(size_t tokenLifetime, unsigned int renewalPercentage)
+{
+    SASTOKEN_CACHE* result;
+
+    /* Codes_SRS_SASTOKEN_CACHE_01_001: [ If tokenLifetime is 0, SASTokenCache_Create shall fail and return NULL. ]*/
+    /* Codes_SRS_SASTOKEN_CACHE_01_002: [ If renewalPercentage is 0 or greater than 100, SASTokenCache_Create shall fail and return NULL. ]*/
+    if ((tokenLifetime == 0) ||
+        (renewalPercentage == 0) ||
+        (renewalPercentage > 100))
+    {
+        LogError("Invalid arguments: tokenLifetime = %lu, renewalPercentage = %u", (unsigned long)tokenLifetime, renewalPercentage);
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_003: [ SASTokenCache_Create shall allocate a new cache and return a non-NULL handle to it. ]*/
+        result = (SASTOKEN_CACHE*)malloc(sizeof(SASTOKEN_CACHE));
+        if (result == NULL)
+        {
+            /* Codes_SRS_SASTOKEN_CACHE_01_004: [ If any error occurs, SASTokenCache_Create shall fail and return NULL. ]*/
+            LogError("Failure allocating SAS token cache.");
+        }
+        else if ((result->entries = singlylinkedlist_create()) == NULL)
+        {
+            /* Codes_SRS_SASTOKEN_CACHE_01_004: [ If any error occurs, SASTokenCache_Create shall fail and return NULL. ]*/
+            LogError("Failure creating SAS token cache entry list.");
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            result->tokenLifetime = tokenLifetime;
+            result->renewalPercentage = renewalPercentage;
+            result->statistics.hits = 0;
+            result->statistics.misses = 0;
+            result->statistics.renewals = 0;
+            result->statistics.evictions = 0;
+        }
+    }
+
+    return result;
+}
+
+void SASTokenCache_Destroy(SASTOKEN_CACHE_HANDLE handle)
+{
+    /* Codes_SRS_SASTOKEN_CACHE_01_005: [ If handle is NULL, SASTokenCache_Destroy shall do nothing. ]*/
+    if (handle != NULL)
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_006: [ SASTokenCache_Destroy shall free all cached tokens and the cache itself. ]*/
+        /* Codes_SRS_SASTOKEN_CACHE_01_023: [ Before freeing an entry, SASTokenCache_Destroy and SASTokenCache_DoWork shall overwrite its key, scope, keyName and token with zeros. ]*/
+        LIST_ITEM_HANDLE item = singlylinkedlist_get_head_item(handle->entries);
+        while (item != NULL)
+        {
+            destroy_entry((SASTOKEN_CACHE_ENTRY*)singlylinkedlist_item_get_value(item));
+            item = singlylinkedlist_get_next_item(item);
+        }
+        singlylinkedlist_destroy(handle->entries);
+        free(handle);
+    }
+}
+
+const char* SASTokenCache_GetToken(SASTOKEN_CACHE_HANDLE handle, const char* key, const char* scope, const char* keyName)
+{
+    const char* result;
+    double now;
+
+    /* Codes_SRS_SASTOKEN_CACHE_01_007: [ If handle, key or scope is NULL, SASTokenCache_GetToken shall fail and return NULL. ]*/
+    if ((handle == NULL) ||
+        (key == NULL) ||
+        (scope == NULL))
+    {
+        LogError("Invalid arguments: handle = %p, key = %p, scope = %p", handle, key, scope);
+        result = NULL;
+    }
+    /* Codes_SRS_SASTOKEN_CACHE_01_008: [ If the current time cannot be obtained, SASTokenCache_GetToken shall fail and return NULL. ]*/
+    else if (!get_now(&now))
+    {
+        result = NULL;
+    }
+    else
+    {
+        ENTRY_MATCH_CONTEXT matchContext;
+        LIST_ITEM_HANDLE item;
+
+        matchContext.key = key;
+        matchContext.scope = scope;
+        matchContext.keyName = keyName;
+
+        /* Codes_SRS_SASTOKEN_CACHE_01_009: [ SASTokenCache_GetToken shall look up the entry cached for the (key, scope, keyName) triple; a NULL keyName only matches a NULL keyName. ]*/
+        item = singlylinkedlist_find(handle->entries, entry_matches, &matchContext);
+        if (item == NULL)
+        {
+            SASTOKEN_CACHE_ENTRY* entry;
+
+            /* Codes_SRS_SASTOKEN_CACHE_01_010: [ If no entry is cached, SASTokenCache_GetToken shall create a token expiring tokenLifetime seconds from now by calling SASToken_CreateString, cache it, count a miss and return it. ]*/
+            handle->statistics.misses++;
+            if ((entry = create_entry(key, scope, keyName)) == NULL)
+            {
+                /* Codes_SRS_SASTOKEN_CACHE_01_011: [ If creating or caching the new token fails, SASTokenCache_GetToken shall fail and return NULL. ]*/
+                result = NULL;
+            }
+            else if (renew_entry(handle, entry, now) != 0)
+            {
+                /* Codes_SRS_SASTOKEN_CACHE_01_011: [ If creating or caching the new token fails, SASTokenCache_GetToken shall fail and return NULL. ]*/
+                destroy_entry(entry);
+                result = NULL;
+            }
+            else if (singlylinkedlist_add(handle->entries, entry) == NULL)
+            {
+                /* Codes_SRS_SASTOKEN_CACHE_01_011: [ If creating or caching the new token fails, SASTokenCache_GetToken shall fail and return NULL. ]*/
+                LogError("Failure adding the SAS token to the cache.");
+                destroy_entry(entry);
+                result = NULL;
+            }
+            else
+            {
+                entry->lastUsed = now;
+                result = STRING_c_str(entry->token);
+            }
+        }
+        else
+        {
+            SASTOKEN_CACHE_ENTRY* entry = (SASTOKEN_CACHE_ENTRY*)singlylinkedlist_item_get_value(item);
+
+            entry->lastUsed = now;
+
+            if (now < entry->renewalTime)
+            {
+                /* Codes_SRS_SASTOKEN_CACHE_01_012: [ If the cached token has not yet reached renewalPercentage of its lifetime, SASTokenCache_GetToken shall count a hit and return it without creating a new token. ]*/
+                handle->statistics.hits++;
+                result = STRING_c_str(entry->token);
+            }
+            else
+            {
+                /* Codes_SRS_SASTOKEN_CACHE_01_013: [ Otherwise SASTokenCache_GetToken shall count a miss, replace the cached token with a newly created one and return it. ]*/
+                handle->statistics.misses++;
+                if (renew_entry(handle, entry, now) == 0)
+                {
+                    result = STRING_c_str(entry->token);
+                }
+                else if (now < entry->expiry)
+                {
+                    /* Codes_SRS_SASTOKEN_CACHE_01_014: [ If creating the new token fails and the cached token has not expired, SASTokenCache_GetToken shall return the cached token. ]*/
+                    result = STRING_c_str(entry->token);
+                }
+                else
+                {
+                    /* Codes_SRS_SASTOKEN_CACHE_01_015: [ If creating the new token fails and the cached token has expired, SASTokenCache_GetToken shall fail and return NULL. ]*/
+                    result = NULL;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+int SASTokenCache_DoWork(SASTOKEN_CACHE_HANDLE handle)
+{
+    int result;
+    double now;
+
+    if (handle == NULL)
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_016: [ If handle is NULL, SASTokenCache_DoWork shall fail and return a non-zero value. ]*/
+        LogError("NULL handle");
+        result = __FAILURE__;
+    }
+    else if (!get_now(&now))
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_017: [ If the current time cannot be obtained, SASTokenCache_DoWork shall fail and return a non-zero value. ]*/
+        result = __FAILURE__;
+    }
+    else
+    {
+        LIST_ITEM_HANDLE item = singlylinkedlist_get_head_item(handle->entries);
+
+        result = 0;
+
+        while (item != NULL)
+        {
+            SASTOKEN_CACHE_ENTRY* entry = (SASTOKEN_CACHE_ENTRY*)singlylinkedlist_item_get_value(item);
+            LIST_ITEM_HANDLE nextItem = singlylinkedlist_get_next_item(item);
+
+            if (now - entry->lastUsed >= (double)handle->tokenLifetime)
+            {
+                /* Codes_SRS_SASTOKEN_CACHE_01_022: [ SASTokenCache_DoWork shall remove, without renewing it, every entry that SASTokenCache_GetToken has not asked for during the last tokenLifetime seconds and count an eviction for each. ]*/
+                if (singlylinkedlist_remove(handle->entries, item) != 0)
+                {
+                    LogError("Failure removing an unused SAS token from the cache.");
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    destroy_entry(entry);
+                    handle->statistics.evictions++;
+                }
+            }
+            /* Codes_SRS_SASTOKEN_CACHE_01_018: [ SASTokenCache_DoWork shall renew every cached token that has reached renewalPercentage of its lifetime and count a renewal for each, so that SASTokenCache_GetToken keeps hitting when DoWork is driven from outside the request path. ]*/
+            else if (now >= entry->renewalTime)
+            {
+                if (renew_entry(handle, entry, now) != 0)
+                {
+                    /* Codes_SRS_SASTOKEN_CACHE_01_019: [ If renewing any token fails, SASTokenCache_DoWork shall still attempt the remaining ones, keep the failed entry's previous token and return a non-zero value. ]*/
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    handle->statistics.renewals++;
+                }
+            }
+            item = nextItem;
+        }
+    }
+
+    return result;
+}
+
+int SASTokenCache_GetStatistics(SASTOKEN_CACHE_HANDLE handle, SASTOKEN_CACHE_STATISTICS* statistics)
+{
+    int result;
+
+    /* Codes_SRS_SASTOKEN_CACHE_01_020: [ If handle or statistics is NULL, SASTokenCache_GetStatistics shall fail and return a non-zero value. ]*/
+    if ((handle == NULL) ||
+        (statistics == NULL))
+    {
+        LogError("Invalid arguments: handle = %p, statistics = %p", handle, statistics);
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_SASTOKEN_CACHE_01_021: [ SASTokenCache_GetStatistics shall copy the hit, miss, renewal and eviction counters into statistics and return 0. ]*/
+        *statistics = handle->statistics;
+        result = 0;
+    }
+
+    return result;
+}
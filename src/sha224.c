@@ -42,6 +42,8 @@
 #include <stdlib.h>
 #include "azure_c_shared_utility/gballoc.h"
 
+#include <string.h>
+
 #include "azure_c_shared_utility/sha.h"
 #include "azure_c_shared_utility/sha-private.h"
 /* Define the SHA shift, rotate left and rotate right macro */
@@ -75,6 +77,8 @@ static void SHA224_256Finalize(SHA256Context *context,
 static void SHA224_256PadMessage(SHA256Context *context,
     uint8_t Pad_Byte);
 static void SHA224_256ProcessMessageBlock(SHA256Context *context);
+static void SHA224_256Compress(uint32_t Intermediate_Hash[],
+    const uint8_t *block);
 static int SHA224_256Reset(SHA256Context *context, uint32_t *H0);
 static int SHA224_256ResultN(SHA256Context *context,
     uint8_t Message_Digest[], int HashSize);
@@ -241,20 +245,49 @@ int SHA256Input(SHA256Context *context, const uint8_t *message_array,
     if (context->Corrupted)
         return context->Corrupted;
 
-    while (length-- && !context->Corrupted) {
-
-#ifdef _MSC_VER
-        _Analysis_assume_(context->Message_Block_Index < SHA256_Message_Block_Size);
-#endif
-
-        context->Message_Block[context->Message_Block_Index++] =
-            (*message_array & 0xFF);
+    /*
+    * Add the whole length up front: 8 * length may not fit in 32 bits,
+    * so its upper bits are carried into Length_High separately.
+    */
+    addTemp = context->Length_Low;
+    context->Length_Low += (uint32_t)length << 3;
+    if ((context->Length_Low < addTemp) &&
+        (++context->Length_High == 0))
+        context->Corrupted = 1;
+    if (((uint32_t)length >> 29) != 0) {
+        addTemp = context->Length_High;
+        if ((context->Length_High += (uint32_t)length >> 29) < addTemp)
+            context->Corrupted = 1;
+    }
+    if (context->Corrupted)
+        return shaSuccess;
 
-        if (!SHA224_256AddLength(context, 8) &&
-            (context->Message_Block_Index == SHA256_Message_Block_Size))
+    /* top up a partially filled Message_Block first */
+    if (context->Message_Block_Index > 0) {
+        unsigned int fill = SHA256_Message_Block_Size -
+            context->Message_Block_Index;
+        if (fill > length)
+            fill = length;
+        (void)memcpy(context->Message_Block +
+            context->Message_Block_Index, message_array, fill);
+        context->Message_Block_Index += (int_least16_t)fill;
+        message_array += fill;
+        length -= fill;
+        if (context->Message_Block_Index == SHA256_Message_Block_Size)
             SHA224_256ProcessMessageBlock(context);
+    }
+
+    /* whole blocks are compressed straight from the caller's buffer */
+    while (length >= SHA256_Message_Block_Size) {
+        SHA224_256Compress(context->Intermediate_Hash, message_array);
+        message_array += SHA256_Message_Block_Size;
+        length -= SHA256_Message_Block_Size;
+    }
 
-        message_array++;
+    /* keep the tail for the next call or for the padding */
+    if (length > 0) {
+        (void)memcpy(context->Message_Block, message_array, length);
+        context->Message_Block_Index = (int_least16_t)length;
     }
 
     return shaSuccess;
@@ -446,80 +479,253 @@ static void SHA224_256PadMessage(SHA256Context *context,
 *
 * Returns:
 *   Nothing.
+*/
+static void SHA224_256ProcessMessageBlock(SHA256Context *context)
+{
+    SHA224_256Compress(context->Intermediate_Hash,
+        context->Message_Block);
+    context->Message_Block_Index = 0;
+}
+
+/* Constants defined in FIPS-180-2, section 4.2.2 */
+static const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
+    0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
+    0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
+    0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
+    0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+    0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
+    0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
+    0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
+    0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/*
+* One round of the SHA-256 compression. Instead of shifting the
+* eight working variables after every round, the callers rotate the
+* argument order, so each round only writes d and h.
+*/
+#define SHA256_ROUND(a, b, c, d, e, f, g, h, t)                  \
+    temp1 = (h) + SHA256_SIGMA1(e) + SHA_Ch((e), (f), (g)) +       \
+        SHA256_K[t] + W[(t) & 15];                                  \
+    (d) += temp1;                                                   \
+    (h) = temp1 + SHA256_SIGMA0(a) + SHA_Maj((a), (b), (c))
+
+/*
+* W[t] for t >= 16, computed in place over the 16 word window that
+* still holds W[t - 16]
+*/
+#define SHA256_SCHEDULE(t)                                          \
+    W[(t) & 15] += SHA256_sigma1(W[((t) - 2) & 15]) +               \
+        W[((t) - 7) & 15] + SHA256_sigma0(W[((t) - 15) & 15])
+
+/*
+* SHA224_256Compress
+*
+* Description:
+*   This function will compress one 512 bit block into the
+*   intermediate hash.
+*
+* Parameters:
+*   Intermediate_Hash: [in/out]
+*     The eight hash words to update
+*   block: [in]
+*     The 64 octets of the block, which need not be aligned
+*
+* Returns:
+*   Nothing.
 *
 * Comments:
 *   Many of the variable names in this code, especially the
 *   single character names, were used because those were the
-*   names used in the publication.
+*   names used in the publication. Only a 16 word window of the
+*   message schedule is kept, and the rounds are unrolled eight
+*   at a time so that the working variables stay in registers.
 */
-static void SHA224_256ProcessMessageBlock(SHA256Context *context)
+static void SHA224_256Compress(uint32_t Intermediate_Hash[],
+    const uint8_t *block)
 {
-    /* Constants defined in FIPS-180-2, section 4.2.2 */
-    static const uint32_t K[64] = {
-        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
-        0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
-        0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
-        0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
-        0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
-        0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
-        0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
-        0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
-        0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
-        0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
-        0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
-        0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-    };
     int        t, t4;                   /* Loop counter */
-    uint32_t   temp1, temp2;            /* Temporary word value */
-    uint32_t   W[64];                   /* Word sequence */
+    uint32_t   temp1;                   /* Temporary word value */
+    uint32_t   W[16];                   /* Word sequence window */
     uint32_t   A, B, C, D, E, F, G, H;  /* Word buffers */
 
     /*
     * Initialize the first 16 words in the array W
     */
     for (t = t4 = 0; t < 16; t++, t4 += 4)
-        W[t] = (((uint32_t)context->Message_Block[t4]) << 24) |
-        (((uint32_t)context->Message_Block[t4 + 1]) << 16) |
-        (((uint32_t)context->Message_Block[t4 + 2]) << 8) |
-        (((uint32_t)context->Message_Block[t4 + 3]));
-
-    for (t = 16; t < 64; t++)
-        W[t] = SHA256_sigma1(W[t - 2]) + W[t - 7] +
-        SHA256_sigma0(W[t - 15]) + W[t - 16];
-
-    A = context->Intermediate_Hash[0];
-    B = context->Intermediate_Hash[1];
-    C = context->Intermediate_Hash[2];
-    D = context->Intermediate_Hash[3];
-    E = context->Intermediate_Hash[4];
-    F = context->Intermediate_Hash[5];
-    G = context->Intermediate_Hash[6];
-    H = context->Intermediate_Hash[7];
-
-    for (t = 0; t < 64; t++) {
-        temp1 = H + SHA256_SIGMA1(E) + SHA_Ch(E, F, G) + K[t] + W[t];
-        temp2 = SHA256_SIGMA0(A) + SHA_Maj(A, B, C);
-        H = G;
-        G = F;
-        F = E;
-        E = D + temp1;
-        D = C;
-        C = B;
-        B = A;
-        A = temp1 + temp2;
+        W[t] = (((uint32_t)block[t4]) << 24) |
+        (((uint32_t)block[t4 + 1]) << 16) |
+        (((uint32_t)block[t4 + 2]) << 8) |
+        (((uint32_t)block[t4 + 3]));
+
+    A = Intermediate_Hash[0];
+    B = Intermediate_Hash[1];
+    C = Intermediate_Hash[2];
+    D = Intermediate_Hash[3];
+    E = Intermediate_Hash[4];
+    F = Intermediate_Hash[5];
+    G = Intermediate_Hash[6];
+    H = Intermediate_Hash[7];
+
+    for (t = 0; t < 16; t += 8) {
+        SHA256_ROUND(A, B, C, D, E, F, G, H, t);
+        SHA256_ROUND(H, A, B, C, D, E, F, G, t + 1);
+        SHA256_ROUND(G, H, A, B, C, D, E, F, t + 2);
+        SHA256_ROUND(F, G, H, A, B, C, D, E, t + 3);
+        SHA256_ROUND(E, F, G, H, A, B, C, D, t + 4);
+        SHA256_ROUND(D, E, F, G, H, A, B, C, t + 5);
+        SHA256_ROUND(C, D, E, F, G, H, A, B, t + 6);
+        SHA256_ROUND(B, C, D, E, F, G, H, A, t + 7);
+    }
+
+    for (; t < 64; t += 8) {
+        SHA256_SCHEDULE(t);
+        SHA256_ROUND(A, B, C, D, E, F, G, H, t);
+        SHA256_SCHEDULE(t + 1);
+        SHA256_ROUND(H, A, B, C, D, E, F, G, t + 1);
+        SHA256_SCHEDULE(t + 2);
+        SHA256_ROUND(G, H, A, B, C, D, E, F, t + 2);
+        SHA256_SCHEDULE(t + 3);
+        SHA256_ROUND(F, G, H, A, B, C, D, E, t + 3);
+        SHA256_SCHEDULE(t + 4);
+        SHA256_ROUND(E, F, G, H, A, B, C, D, t + 4);
+        SHA256_SCHEDULE(t + 5);
+        SHA256_ROUND(D, E, F, G, H, A, B, C, t + 5);
+        SHA256_SCHEDULE(t + 6);
+        SHA256_ROUND(C, D, E, F, G, H, A, B, t + 6);
+        SHA256_SCHEDULE(t + 7);
+        SHA256_ROUND(B, C, D, E, F, G, H, A, t + 7);
     }
 
-    context->Intermediate_Hash[0] += A;
-    context->Intermediate_Hash[1] += B;
-    context->Intermediate_Hash[2] += C;
-    context->Intermediate_Hash[3] += D;
-    context->Intermediate_Hash[4] += E;
-    context->Intermediate_Hash[5] += F;
-    context->Intermediate_Hash[6] += G;
-    context->Intermediate_Hash[7] += H;
+    Intermediate_Hash[0] += A;
+    Intermediate_Hash[1] += B;
+    Intermediate_Hash[2] += C;
+    Intermediate_Hash[3] += D;
+    Intermediate_Hash[4] += E;
+    Intermediate_Hash[5] += F;
+    Intermediate_Hash[6] += G;
+    Intermediate_Hash[7] += H;
+}
 
-    context->Message_Block_Index = 0;
+/*
+* The same round and schedule step applied to every lane. The
+* working variables are arrays indexed by lane, so each statement
+* is a loop over independent lanes that the compiler can map onto
+* vector registers without any intrinsics.
+*/
+#define SHA256_LANES_ROUND(a, b, c, d, e, f, g, h, t)               \
+    for (lane = 0; lane < SHA256_LANES; lane++) {                   \
+        temp1[lane] = (h)[lane] + SHA256_SIGMA1((e)[lane]) +        \
+            SHA_Ch((e)[lane], (f)[lane], (g)[lane]) +               \
+            SHA256_K[t] + W[(t) & 15][lane];                        \
+        (d)[lane] += temp1[lane];                                   \
+        (h)[lane] = temp1[lane] + SHA256_SIGMA0((a)[lane]) +        \
+            SHA_Maj((a)[lane], (b)[lane], (c)[lane]);               \
+    }
+
+#define SHA256_LANES_SCHEDULE(t)                                    \
+    for (lane = 0; lane < SHA256_LANES; lane++) {                   \
+        W[(t) & 15][lane] += SHA256_sigma1(W[((t) - 2) & 15][lane]) + \
+            W[((t) - 7) & 15][lane] +                               \
+            SHA256_sigma0(W[((t) - 15) & 15][lane]);                \
+    }
+
+/*
+* SHA256CompressLanes
+*
+* Description:
+*   This function will compress one 512 bit block into each of
+*   SHA256_LANES independent intermediate hashes, interleaving the
+*   rounds of all lanes.
+*
+* Parameters:
+*   Intermediate_Hash: [in/out]
+*     The eight hash words to update, word major: word i of lane l
+*     is Intermediate_Hash[i][l]
+*   blocks: [in]
+*     One 64 octet block per lane, which need not be aligned
+*
+* Returns:
+*   Nothing.
+*
+* Comments:
+*   The result for every lane is the same as SHA224_256Compress
+*   would give. Lanes that have nothing to hash still need a
+*   readable block; their hash words are simply ignored.
+*/
+void SHA256CompressLanes(uint32_t Intermediate_Hash[8][SHA256_LANES],
+    const uint8_t *blocks[SHA256_LANES])
+{
+    int        t, t4, lane;             /* Loop counters */
+    uint32_t   temp1[SHA256_LANES];     /* Temporary word values */
+    uint32_t   W[16][SHA256_LANES];     /* Word sequence windows */
+    uint32_t   A[SHA256_LANES], B[SHA256_LANES], C[SHA256_LANES],
+               D[SHA256_LANES], E[SHA256_LANES], F[SHA256_LANES],
+               G[SHA256_LANES], H[SHA256_LANES]; /* Word buffers */
+
+    for (lane = 0; lane < SHA256_LANES; lane++) {
+        const uint8_t *block = blocks[lane];
+        for (t = t4 = 0; t < 16; t++, t4 += 4)
+            W[t][lane] = (((uint32_t)block[t4]) << 24) |
+            (((uint32_t)block[t4 + 1]) << 16) |
+            (((uint32_t)block[t4 + 2]) << 8) |
+            (((uint32_t)block[t4 + 3]));
+
+        A[lane] = Intermediate_Hash[0][lane];
+        B[lane] = Intermediate_Hash[1][lane];
+        C[lane] = Intermediate_Hash[2][lane];
+        D[lane] = Intermediate_Hash[3][lane];
+        E[lane] = Intermediate_Hash[4][lane];
+        F[lane] = Intermediate_Hash[5][lane];
+        G[lane] = Intermediate_Hash[6][lane];
+        H[lane] = Intermediate_Hash[7][lane];
+    }
+
+    for (t = 0; t < 16; t += 8) {
+        SHA256_LANES_ROUND(A, B, C, D, E, F, G, H, t);
+        SHA256_LANES_ROUND(H, A, B, C, D, E, F, G, t + 1);
+        SHA256_LANES_ROUND(G, H, A, B, C, D, E, F, t + 2);
+        SHA256_LANES_ROUND(F, G, H, A, B, C, D, E, t + 3);
+        SHA256_LANES_ROUND(E, F, G, H, A, B, C, D, t + 4);
+        SHA256_LANES_ROUND(D, E, F, G, H, A, B, C, t + 5);
+        SHA256_LANES_ROUND(C, D, E, F, G, H, A, B, t + 6);
+        SHA256_LANES_ROUND(B, C, D, E, F, G, H, A, t + 7);
+    }
+
+    for (; t < 64; t += 8) {
+        SHA256_LANES_SCHEDULE(t);
+        SHA256_LANES_ROUND(A, B, C, D, E, F, G, H, t);
+        SHA256_LANES_SCHEDULE(t + 1);
+        SHA256_LANES_ROUND(H, A, B, C, D, E, F, G, t + 1);
+        SHA256_LANES_SCHEDULE(t + 2);
+        SHA256_LANES_ROUND(G, H, A, B, C, D, E, F, t + 2);
+        SHA256_LANES_SCHEDULE(t + 3);
+        SHA256_LANES_ROUND(F, G, H, A, B, C, D, E, t + 3);
+        SHA256_LANES_SCHEDULE(t + 4);
+        SHA256_LANES_ROUND(E, F, G, H, A, B, C, D, t + 4);
+        SHA256_LANES_SCHEDULE(t + 5);
+        SHA256_LANES_ROUND(D, E, F, G, H, A, B, C, t + 5);
+        SHA256_LANES_SCHEDULE(t + 6);
+        SHA256_LANES_ROUND(C, D, E, F, G, H, A, B, t + 6);
+        SHA256_LANES_SCHEDULE(t + 7);
+        SHA256_LANES_ROUND(B, C, D, E, F, G, H, A, t + 7);
+    }
+
+    for (lane = 0; lane < SHA256_LANES; lane++) {
+        Intermediate_Hash[0][lane] += A[lane];
+        Intermediate_Hash[1][lane] += B[lane];
+        Intermediate_Hash[2][lane] += C[lane];
+        Intermediate_Hash[3][lane] += D[lane];
+        Intermediate_Hash[4][lane] += E[lane];
+        Intermediate_Hash[5][lane] += F[lane];
+        Intermediate_Hash[6][lane] += G[lane];
+        Intermediate_Hash[7][lane] += H[lane];
+    }
 }
 
 /*
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <string.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/xlogging.h"
@@ -375,6 +376,188 @@ int StringToken_Split(const char* source, size_t length, const char** delimiters
     return result;
 }
 
+typedef struct DELIMITER_MATCHER_TAG
+{
+    const char** delimiters;
+    size_t* lengths;
+    size_t n_delims;
+    unsigned char first_chars[32];
+} DELIMITER_MATCHER;
+
+static int create_delimiter_matcher(DELIMITER_MATCHER* matcher, const char** delimiters, size_t n_delims)
+{
+    int result;
+
+    (void)memset(matcher->first_chars, 0, sizeof(matcher->first_chars));
+    matcher->delimiters = delimiters;
+    matcher->n_delims = n_delims;
+
+    // Codes_SRS_STRING_TOKENIZER_09_029: [ If any of the strings in delimiters are NULL, the function shall return a non-zero value ]
+    if ((matcher->lengths = get_delimiters_lengths(delimiters, n_delims)) == NULL)
+    {
+        LogError("Failed to get delimiters lengths");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t i;
+
+        for (i = 0; i < n_delims; i++)
+        {
+            // Empty delimiters never match, so they are left out of the table.
+            if (matcher->lengths[i] > 0)
+            {
+                unsigned char c = (unsigned char)delimiters[i][0];
+                matcher->first_chars[c >> 3] |= (unsigned char)(1 << (c & 7));
+            }
+        }
+
+        result = 0;
+    }
+
+    return result;
+}
+
+static void destroy_delimiter_matcher(DELIMITER_MATCHER* matcher)
+{
+    free(matcher->lengths);
+}
+
+// Returns the first delimiter occurrence in [position, stop_pos), preferring the delimiter listed first when several match at the same position.
+static const char* find_delimiter(const DELIMITER_MATCHER* matcher, const char* position, const char* stop_pos, size_t* delimiter_length)
+{
+    const char* result = NULL;
+
+    for (; position < stop_pos && result == NULL; position++)
+    {
+        unsigned char c = (unsigned char)*position;
+
+        if ((matcher->first_chars[c >> 3] & (1 << (c & 7))) != 0)
+        {
+            size_t j;
+            for (j = 0; j < matcher->n_delims; j++)
+            {
+                size_t length = matcher->lengths[j];
+
+                if (length > 0 &&
+                    length <= (size_t)(stop_pos - position) &&
+                    memcmp(position, matcher->delimiters[j], length) == 0)
+                {
+                    *delimiter_length = length;
+                    result = position;
+                    break;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+// Walks all the tokens of source. When tokens is NULL it only counts them and the bytes needed for their copies,
+// otherwise it stores each token in tokens, copied into string_buffer.
+static void split_tokens(const DELIMITER_MATCHER* matcher, const char* source, size_t length, bool include_empty, char** tokens, char* string_buffer, size_t* token_count, size_t* string_size)
+{
+    const char* stop_pos = source + length;
+    const char* token_start = source;
+    bool done = false;
+
+    *token_count = 0;
+    *string_size = 0;
+
+    while (!done)
+    {
+        size_t delimiter_length = 0;
+        const char* token_end = find_delimiter(matcher, token_start, stop_pos, &delimiter_length);
+        size_t token_length;
+
+        if (token_end == NULL)
+        {
+            token_end = stop_pos;
+            done = true;
+        }
+
+        token_length = token_end - token_start;
+
+        if (token_length > 0 || include_empty)
+        {
+            if (tokens != NULL)
+            {
+                if (token_length == 0)
+                {
+                    tokens[*token_count] = NULL;
+                }
+                else
+                {
+                    tokens[*token_count] = string_buffer + *string_size;
+                    (void)memcpy(tokens[*token_count], token_start, token_length);
+                    tokens[*token_count][token_length] = '\0';
+                }
+            }
+
+            (*token_count)++;
+            if (token_length > 0)
+            {
+                *string_size += token_length + 1;
+            }
+        }
+
+        token_start = token_end + delimiter_length;
+    }
+}
+
+int StringToken_SplitPacked(const char* source, size_t length, const char** delimiters, size_t n_delims, bool include_empty, char*** tokens, size_t* token_count)
+{
+    int result;
+    DELIMITER_MATCHER matcher;
+
+    // Codes_SRS_STRING_TOKENIZER_09_028: [ If source, delimiters, tokens or token_count are NULL, or n_delims is zero the function shall return a non-zero value ]
+    if (source == NULL || delimiters == NULL || n_delims == 0 || tokens == NULL || token_count == NULL)
+    {
+        LogError("Invalid argument (source=%p, delimiters=%p, n_delims=%lu, tokens=%p, token_count=%p)", source, delimiters, (unsigned long)n_delims, tokens, token_count);
+        result = __FAILURE__;
+    }
+    // Codes_SRS_STRING_TOKENIZER_09_033: [ If any memory allocation fails the function shall return a non-zero value ]
+    else if (create_delimiter_matcher(&matcher, delimiters, n_delims) != 0)
+    {
+        LogError("Failed creating the delimiter matcher");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t count;
+        size_t string_size;
+
+        // Codes_SRS_STRING_TOKENIZER_09_030: [ source (up to length) shall be split into the same tokens StringToken_Split produces ]
+        split_tokens(&matcher, source, length, include_empty, NULL, NULL, &count, &string_size);
+
+        if (count == 0)
+        {
+            // Codes_SRS_STRING_TOKENIZER_09_031: [ If there are no tokens, tokens shall be set to NULL and token_count to zero ]
+            *tokens = NULL;
+            *token_count = 0;
+            result = 0;
+        }
+        // Codes_SRS_STRING_TOKENIZER_09_032: [ The pointer array and the null-terminated copies of the tokens shall be stored in a single memory block, so that the caller releases everything by calling free on tokens ]
+        else if ((*tokens = (char**)malloc(sizeof(char*) * count + string_size)) == NULL)
+        {
+            // Codes_SRS_STRING_TOKENIZER_09_033: [ If any memory allocation fails the function shall return a non-zero value ]
+            LogError("Failed allocating the token array");
+            *token_count = 0;
+            result = __FAILURE__;
+        }
+        else
+        {
+            split_tokens(&matcher, source, length, include_empty, *tokens, (char*)(*tokens + count), token_count, &string_size);
+            result = 0;
+        }
+
+        destroy_delimiter_matcher(&matcher);
+    }
+
+    return result;
+}
+
 void StringToken_Destroy(STRING_TOKEN_HANDLE token)
 {
     if (token == NULL)
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include <stdbool.h>
+#include <string.h>
 #include "azure_c_shared_utility/string_tokenizer.h"
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/xlogging.h"
@@ -66,6 +67,85 @@ extern STRING_TOKENIZER_HANDLE STRING_TOKENIZER_create_from_char(const char* inp
     return (STRING_TOKENIZER_HANDLE)result;
 }
 
+#define IS_DELIMITER(compiled, c) (((compiled)->set[(unsigned char)(c) >> 3] & (1 << ((unsigned char)(c) & 7))) != 0)
+
+static void compile_delimiters(const char* delimiters, size_t delimiterSize, STRING_TOKENIZER_DELIMITERS* compiled)
+{
+    size_t i;
+
+    (void)memset(compiled->set, 0, sizeof(compiled->set));
+    for (i = 0; i < delimiterSize; i++)
+    {
+        unsigned char c = (unsigned char)delimiters[i];
+        compiled->set[c >> 3] |= (unsigned char)(1 << (c & 7));
+    }
+    compiled->count = delimiterSize;
+    compiled->first = delimiters[0];
+}
+
+/* Finds the next token and moves the current position past it (and past the delimiter that ends it, if any). */
+static int get_next_token_view(STRING_TOKEN* token, const STRING_TOKENIZER_DELIMITERS* delimiters, const char** tokenStart, size_t* tokenLength)
+{
+    int result;
+    const char* end = token->inputString + token->sizeOfinputString;
+    const char* position = token->currentPos;
+
+    /* Codes_SRS_STRING_04_005: [STRING_TOKENIZER_get_next_token searches the string inside STRING_TOKENIZER_HANDLE for the first character that is NOT contained in the current delimiter] */
+    while ((position < end) && IS_DELIMITER(delimiters, *position))
+    {
+        position++;
+    }
+
+    /* Codes_SRS_STRING_04_006: [If no such character is found, then STRING_TOKENIZER_get_next_token shall return a nonzero Value (You've reach the end of the string or the string consists with only delimiters).] */
+    token->currentPos = position;
+    if (position == end)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        const char* endOfToken;
+
+        /* Codes_SRS_STRING_04_007: [If such a character is found, STRING_TOKENIZER_get_next_token consider it as the start of a token.] */
+        /* Codes_SRS_STRING_04_008: [STRING_TOKENIZER_get_next_token than searches from the start of a token for a character that is contained in the delimiters string.] */
+        if (delimiters->count == 1)
+        {
+            /* memchr is the platform's vectorized scan, so the common single delimiter case does not go byte by byte */
+            endOfToken = (const char*)memchr(position, delimiters->first, end - position);
+        }
+        else
+        {
+            endOfToken = position;
+            while ((endOfToken < end) && !IS_DELIMITER(delimiters, *endOfToken))
+            {
+                endOfToken++;
+            }
+            if (endOfToken == end)
+            {
+                endOfToken = NULL;
+            }
+        }
+
+        *tokenStart = position;
+        if (endOfToken == NULL)
+        {
+            /* Codes_SRS_STRING_04_009: [If no such character is found, STRING_TOKENIZER_get_next_token extends the current token to the end of the string inside t, copies the token to output and returns 0.] */
+            *tokenLength = end - position;
+            token->currentPos = end;
+        }
+        else
+        {
+            /* Codes_SRS_STRING_04_010: [If such a character is found, STRING_TOKENIZER_get_next_token consider it the end of the token and copy it's content to output, updates the current position inside t to the next character and returns 0.] */
+            *tokenLength = endOfToken - position;
+            token->currentPos = endOfToken + 1;
+        }
+
+        result = 0;
+    }
+
+    return result;
+}
+
 int STRING_TOKENIZER_get_next_token(STRING_TOKENIZER_HANDLE tokenizer, STRING_HANDLE output, const char* delimiters)
 {
     int result;
@@ -94,91 +174,26 @@ int STRING_TOKENIZER_get_next_token(STRING_TOKENIZER_HANDLE tokenizer, STRING_HA
         }
         else
         {
-            size_t i;
-            /* Codes_SRS_STRING_04_005: [STRING_TOKENIZER_get_next_token searches the string inside STRING_TOKENIZER_HANDLE for the first character that is NOT contained in the current delimiter] */
-            for (i = 0; i < remainingInputStringSize; i++)
+            STRING_TOKENIZER_DELIMITERS compiled;
+            const char* tokenStart;
+            size_t tokenLength;
+
+            compile_delimiters(delimiters, delimitterSize, &compiled);
+
+            if (get_next_token_view(token, &compiled, &tokenStart, &tokenLength) != 0)
             {
-                size_t j;
-
-                bool foundDelimitter = false;
-                for (j = 0; j < delimitterSize; j++)
-                {
-                    if (token->currentPos[i] == delimiters[j])
-                    {
-                        foundDelimitter = true;
-                        break;
-                    }
-                }
-
-                /* Codes_SRS_STRING_04_007: [If such a character is found, STRING_TOKENIZER_get_next_token consider it as the start of a token.] */
-                if (!foundDelimitter)
-                {
-                    break;
-                }
+                result = __FAILURE__;
             }
-
-            /* Codes_SRS_STRING_04_006: [If no such character is found, then STRING_TOKENIZER_get_next_token shall return a nonzero Value (You've reach the end of the string or the string consists with only delimiters).] */
-            //At this point update Current Pos to the character of the last token found or end of String.
-            token->currentPos += i; 
-            
-            //Update the remainingInputStringSize
-            remainingInputStringSize -= i;
-            
-            /* Codes_SRS_STRING_04_006: [If no such character is found, then STRING_TOKENIZER_get_next_token shall return a nonzero Value (You've reach the end of the string or the string consists with only delimiters).] */
-            if (remainingInputStringSize == 0)
+            //copy here the string to output. 
+            else if (STRING_copy_n(output, tokenStart, tokenLength) != 0)
             {
+                LogError("Problem copying token to output String.");
+                token->currentPos = tokenStart;
                 result = __FAILURE__;
             }
             else
             {
-                bool foundDelimitter = false;
-                const char* endOfTokenPosition=NULL;
-                size_t amountOfCharactersToCopy;
-                size_t j;
-                //At this point the Current Pos is pointing to a character that is point to a nonDelimiter. So, now search for a Delimiter, till the end of the String. 
-                /*Codes_SRS_STRING_04_008: [STRING_TOKENIZER_get_next_token than searches from the start of a token for a character that is contained in the delimiters string.] */
-                /* Codes_SRS_STRING_04_009: [If no such character is found, STRING_TOKENIZER_get_next_token extends the current token to the end of the string inside t, copies the token to output and returns 0.] */
-                /* Codes_SRS_STRING_04_010: [If such a character is found, STRING_TOKENIZER_get_next_token consider it the end of the token and copy it's content to output, updates the current position inside t to the next character and returns 0.] */
-                for (j = 0; j < delimitterSize; j++)
-                {
-                    if ((endOfTokenPosition = strchr(token->currentPos, delimiters[j])) != NULL)
-                    {
-                        foundDelimitter = true;
-                        break;
-                    }
-                }
-
-                //If token not found, than update the EndOfToken to the end of the inputString;
-                if (endOfTokenPosition == NULL)
-                {
-                    amountOfCharactersToCopy = remainingInputStringSize;
-                }
-                else
-                {
-                    amountOfCharactersToCopy = endOfTokenPosition - token->currentPos;
-                }
-                
-                //copy here the string to output. 
-                if (STRING_copy_n(output, token->currentPos, amountOfCharactersToCopy) != 0)
-                {
-                    LogError("Problem copying token to output String.");
-                    result = __FAILURE__;
-                }
-                else
-                {
-                    //Update the Current position.
-                    //Check if end of String reached so, currentPos points to the end of String.
-                    if (foundDelimitter)
-                    {
-                        token->currentPos += amountOfCharactersToCopy + 1;
-                    }
-                    else
-                    {
-                        token->currentPos += amountOfCharactersToCopy;
-                    }
-                    
-                    result = 0; //Result will be on the output. 
-                }
+                result = 0; //Result will be on the output. 
             }
         }
     }
@@ -186,6 +201,66 @@ int STRING_TOKENIZER_get_next_token(STRING_TOKENIZER_HANDLE tokenizer, STRING_HA
     return result;
 }
 
+int STRING_TOKENIZER_compile_delimiters(const char* delimiters, STRING_TOKENIZER_DELIMITERS* compiled)
+{
+    int result;
+
+    /* Codes_SRS_STRING_TOKENIZER_01_001: [If delimiters or compiled is NULL, STRING_TOKENIZER_compile_delimiters shall fail and return a non-zero value.] */
+    if ((delimiters == NULL) ||
+        (compiled == NULL))
+    {
+        LogError("Invalid arguments: delimiters = %p, compiled = %p", delimiters, compiled);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t delimiterSize = strlen(delimiters);
+
+        /* Codes_SRS_STRING_TOKENIZER_01_002: [If delimiters is an empty string, STRING_TOKENIZER_compile_delimiters shall fail and return a non-zero value.] */
+        if (delimiterSize == 0)
+        {
+            LogError("Empty delimiters parameter.");
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_STRING_TOKENIZER_01_003: [STRING_TOKENIZER_compile_delimiters shall build in compiled a 256 bit lookup table with one bit set for each character of delimiters and return 0.] */
+            compile_delimiters(delimiters, delimiterSize, compiled);
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int STRING_TOKENIZER_get_next_token_view(STRING_TOKENIZER_HANDLE t, const STRING_TOKENIZER_DELIMITERS* delimiters, const char** token, size_t* token_length)
+{
+    int result;
+
+    /* Codes_SRS_STRING_TOKENIZER_01_004: [If any argument is NULL, STRING_TOKENIZER_get_next_token_view shall fail and return a non-zero value.] */
+    if ((t == NULL) ||
+        (delimiters == NULL) ||
+        (token == NULL) ||
+        (token_length == NULL))
+    {
+        LogError("Invalid arguments: t = %p, delimiters = %p, token = %p, token_length = %p", t, delimiters, token, token_length);
+        result = __FAILURE__;
+    }
+    /* Codes_SRS_STRING_TOKENIZER_01_005: [STRING_TOKENIZER_get_next_token_view shall find the next token exactly like STRING_TOKENIZER_get_next_token, using the compiled delimiters.] */
+    /* Codes_SRS_STRING_TOKENIZER_01_006: [On success STRING_TOKENIZER_get_next_token_view shall set token to the start of the token inside the tokenizer's copy of the input, set token_length to its length and return 0, without allocating or copying.] */
+    /* Codes_SRS_STRING_TOKENIZER_01_007: [If no more tokens are found, STRING_TOKENIZER_get_next_token_view shall return a non-zero value.] */
+    else if (get_next_token_view((STRING_TOKEN*)t, delimiters, token, token_length) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
 
 /* Codes_SRS_STRING_TOKENIZER_04_012: [STRING_TOKENIZER_destroy shall free the memory allocated by the STRING_TOKENIZER_create ] */
 void STRING_TOKENIZER_destroy(STRING_TOKENIZER_HANDLE t)
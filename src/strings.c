@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -255,6 +256,140 @@ STRING_HANDLE STRING_new_quoted(const char* source)
     return (STRING_HANDLE)result;
 }
 
+/*number of characters each input byte turns into inside a JSON string. 0 marks bytes outside [1...127] that cannot be represented*/
+static const unsigned char JSON_ESCAPED_LENGTH[256] =
+{
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, /*0x00 - 0x1F: \u00XX*/
+    1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /*0x20 - 0x3F: " and / are escaped*/
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1, /*0x40 - 0x5F: \ is escaped*/
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /*0x60 - 0x7F*/
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+#define JSON_WORD_ONES ((uint64_t)0x0101010101010101)
+#define JSON_WORD_HIGHS ((uint64_t)0x8080808080808080)
+#define JSON_WORD_HAS_ZERO_BYTE(w) (((w) - JSON_WORD_ONES) & ~(w) & JSON_WORD_HIGHS)
+
+/*checks 8 bytes at once: the result is 0 when no byte is below 0x20, no byte has the high bit set and no byte equals '"', '\\' or '/',
+that is when all 8 bytes can be copied to a JSON string unchanged*/
+static uint64_t json_word_needs_escaping(const unsigned char* source)
+{
+    uint64_t word;
+    uint64_t result;
+    (void)memcpy(&word, source, sizeof(uint64_t));
+    result = (word | ((word - JSON_WORD_ONES * 0x20) & ~word)) & JSON_WORD_HIGHS;
+    result |= JSON_WORD_HAS_ZERO_BYTE(word ^ (JSON_WORD_ONES * '"'));
+    result |= JSON_WORD_HAS_ZERO_BYTE(word ^ (JSON_WORD_ONES * '\\'));
+    result |= JSON_WORD_HAS_ZERO_BYTE(word ^ (JSON_WORD_ONES * '/'));
+    return result;
+}
+
+/*computes the size of the JSON representation of source (quotes included, '\0' excluded). Returns 0 if source cannot be represented*/
+static size_t json_escaped_size(const unsigned char* source, size_t length)
+{
+    size_t result = 2;
+    unsigned char invalid = 0;
+    size_t i = 0;
+    while (length - i >= sizeof(uint64_t))
+    {
+        if (json_word_needs_escaping(source + i) == 0)
+        {
+            result += sizeof(uint64_t);
+            i += sizeof(uint64_t);
+        }
+        else
+        {
+            size_t end = i + sizeof(uint64_t);
+            for (; i < end; i++)
+            {
+                unsigned char escapedLength = JSON_ESCAPED_LENGTH[source[i]];
+                invalid |= (escapedLength == 0);
+                result += escapedLength;
+            }
+        }
+    }
+    for (; i < length; i++)
+    {
+        unsigned char escapedLength = JSON_ESCAPED_LENGTH[source[i]];
+        invalid |= (escapedLength == 0);
+        result += escapedLength;
+    }
+
+    /*Codes_SRS_STRING_02_014: [If any character has the value outside [1...127] then STRING_new_JSON shall fail and return NULL.] */
+    return (invalid != 0) ? 0 : result;
+}
+
+/*writes the JSON representation of one character at destination and returns the number of characters written*/
+static size_t json_escape_character(char* destination, unsigned char c)
+{
+    size_t result;
+    if (c <= 0x1F)
+    {
+        /*Codes_SRS_STRING_02_019: [If the character code is less than 0x20 then it shall be represented as \u00xx, where xx is the hex representation of the character code.]*/
+        destination[0] = '\\';
+        destination[1] = 'u';
+        destination[2] = '0';
+        destination[3] = '0';
+        destination[4] = hexToASCII[(c & 0xF0) >> 4]; /*high nibble*/
+        destination[5] = hexToASCII[c & 0x0F]; /*low nibble*/
+        result = 6;
+    }
+    else if ((c == '"') || (c == '\\') || (c == '/'))
+    {
+        /*Codes_SRS_STRING_02_016: [If the character is " (quote) then it shall be repsented as \".] */
+        /*Codes_SRS_STRING_02_017: [If the character is \ (backslash) then it shall represented as \\.] */
+        /*Codes_SRS_STRING_02_018: [If the character is / (slash) then it shall be represented as \/.] */
+        destination[0] = '\\';
+        destination[1] = (char)c;
+        result = 2;
+    }
+    else
+    {
+        /*Codes_SRS_STRING_02_013: [The string shall copy the characters of source "as they are" (until the '\0' character) with the following exceptions:] */
+        destination[0] = (char)c;
+        result = 1;
+    }
+    return result;
+}
+
+/*writes the JSON representation of source (quotes included) followed by '\0' at destination. The caller has checked the input with json_escaped_size*/
+static void json_escape(char* destination, const unsigned char* source, size_t length)
+{
+    size_t pos = 0;
+    size_t i = 0;
+    /*Codes_SRS_STRING_02_012: [The string shall begin with the quote character.] */
+    destination[pos++] = '"';
+    while (length - i >= sizeof(uint64_t))
+    {
+        if (json_word_needs_escaping(source + i) == 0)
+        {
+            /*Codes_SRS_STRING_02_013: [The string shall copy the characters of source "as they are" (until the '\0' character) with the following exceptions:] */
+            (void)memcpy(destination + pos, source + i, sizeof(uint64_t));
+            pos += sizeof(uint64_t);
+            i += sizeof(uint64_t);
+        }
+        else
+        {
+            size_t end = i + sizeof(uint64_t);
+            for (; i < end; i++)
+            {
+                pos += json_escape_character(destination + pos, source[i]);
+            }
+        }
+    }
+    for (; i < length; i++)
+    {
+        pos += json_escape_character(destination + pos, source[i]);
+    }
+    /*Codes_SRS_STRING_02_020: [The string shall end with " (quote).] */
+    destination[pos++] = '"';
+    /*zero terminating it*/
+    destination[pos] = '\0';
+}
+
 /*this function takes a regular const char* and turns in into "this is a\"JSON\" strings\u0008" (starting and ending quote included)*/
 /*the newly created handle needs to be disposed of with STRING_delete*/
 /*returns NULL if there are errors*/
@@ -269,124 +404,78 @@ STRING_HANDLE STRING_new_JSON(const char* source)
     }
     else
     {
-        size_t i;
-        size_t nControlCharacters = 0; /*counts how many characters are to be expanded from 1 character to \uxxxx (6 characters)*/
-        size_t nEscapeCharacters = 0;
         size_t vlen = strlen(source);
-
-        for (i = 0; i < vlen; i++)
+        size_t jsonSize = json_escaped_size((const unsigned char*)source, vlen);
+        if (jsonSize == 0)
         {
-            /*Codes_SRS_STRING_02_014: [If any character has the value outside [1...127] then STRING_new_JSON shall fail and return NULL.] */
-            if ((unsigned char)source[i] >= 128) /*this be a UNICODE character begin*/
-            {
-                break;
-            }
-            else
-            {
-                if (source[i] <= 0x1F)
-                {
-                    nControlCharacters++;
-                }
-                else if (
-                    (source[i] == '"') ||
-                    (source[i] == '\\') ||
-                    (source[i] == '/')
-                    )
-                {
-                    nEscapeCharacters++;
-                }
-            }
+            result = NULL;
+            LogError("invalid character in input string");
         }
-
-        if (i < vlen)
+        else if ((result = (STRING*)malloc(sizeof(STRING))) == NULL)
+        {
+            /*Codes_SRS_STRING_02_021: [If the complete JSON representation cannot be produced, then STRING_new_JSON shall fail and return NULL.] */
+            LogError("malloc json failure");
+        }
+        else if ((result->s = (char*)malloc(jsonSize + 1)) == NULL)
         {
+            /*Codes_SRS_STRING_02_021: [If the complete JSON representation cannot be produced, then STRING_new_JSON shall fail and return NULL.] */
+            free(result);
             result = NULL;
+            LogError("malloc failed");
+        }
+        else
+        {
+            json_escape(result->s, (const unsigned char*)source, vlen);
+        }
+    }
+    return (STRING_HANDLE)result;
+}
+
+/*this function appends to handle the JSON representation of source (as produced by STRING_new_JSON)*/
+/*returns 0 if success*/
+/*any other error code is failure, in which case handle is left unchanged*/
+int STRING_concat_JSON(STRING_HANDLE handle, const char* source)
+{
+    int result;
+    if ((handle == NULL) || (source == NULL))
+    {
+        /*Codes_SRS_STRING_01_001: [ If handle or source is NULL then STRING_concat_JSON shall fail and return a non-zero value. ]*/
+        LogError("Invalid argument: handle = %p, source = %p", handle, source);
+        result = __FAILURE__;
+    }
+    else
+    {
+        STRING* dest = (STRING*)handle;
+        size_t vlen = strlen(source);
+        /*Codes_SRS_STRING_01_002: [ STRING_concat_JSON shall append to handle the same characters that STRING_new_JSON produces for source. ]*/
+        size_t jsonSize = json_escaped_size((const unsigned char*)source, vlen);
+        if (jsonSize == 0)
+        {
+            /*Codes_SRS_STRING_01_003: [ If any character of source has the value outside [1...127] then STRING_concat_JSON shall fail, leave handle unchanged and return a non-zero value. ]*/
             LogError("invalid character in input string");
+            result = __FAILURE__;
         }
         else
         {
-            size_t nAllocation = vlen + 5 * nControlCharacters + nEscapeCharacters + 3;
-            if ((result = (STRING*)malloc(sizeof(STRING))) == NULL)
-            {
-                /*Codes_SRS_STRING_02_021: [If the complete JSON representation cannot be produced, then STRING_new_JSON shall fail and return NULL.] */
-                LogError("malloc json failure");
-            }
-            else if ((result->s = (char*)malloc(nAllocation)) == NULL)
+            size_t destLength = strlen(dest->s);
+            /*Codes_SRS_STRING_01_004: [ STRING_concat_JSON shall grow the string held by handle with a single reallocation to the exact size needed. ]*/
+            char* temp = (char*)realloc(dest->s, destLength + jsonSize + 1);
+            if (temp == NULL)
             {
-                /*Codes_SRS_STRING_02_021: [If the complete JSON representation cannot be produced, then STRING_new_JSON shall fail and return NULL.] */
-                free(result);
-                result = NULL;
-                LogError("malloc failed");
+                /*Codes_SRS_STRING_01_005: [ If reallocating the string fails, STRING_concat_JSON shall leave handle unchanged and return a non-zero value. ]*/
+                LogError("Failure reallocating value.");
+                result = __FAILURE__;
             }
             else
             {
-                size_t pos = 0;
-                /*Codes_SRS_STRING_02_012: [The string shall begin with the quote character.] */
-                result->s[pos++] = '"';
-                for (i = 0; i < vlen; i++)
-                {
-                    if (source[i] <= 0x1F)
-                    {
-                        /*Codes_SRS_STRING_02_019: [If the character code is less than 0x20 then it shall be represented as \u00xx, where xx is the hex representation of the character code.]*/
-#ifdef _MSC_VER
-                        _Analysis_assume_(pos < nAllocation - 6);
-#endif
-                        result->s[pos++] = '\\';
-                        result->s[pos++] = 'u';
-                        result->s[pos++] = '0';
-                        result->s[pos++] = '0';
-                        result->s[pos++] = hexToASCII[(source[i] & 0xF0) >> 4]; /*high nibble*/
-                        result->s[pos++] = hexToASCII[source[i] & 0x0F]; /*low nibble*/
-                    }
-                    else if (source[i] == '"')
-                    {
-                        /*Codes_SRS_STRING_02_016: [If the character is " (quote) then it shall be repsented as \".] */
-#ifdef _MSC_VER
-                        _Analysis_assume_(pos < nAllocation - 2);
-#endif
-                        result->s[pos++] = '\\';
-                        result->s[pos++] = '"';
-                    }
-                    else if (source[i] == '\\')
-                    {
-                        /*Codes_SRS_STRING_02_017: [If the character is \ (backslash) then it shall represented as \\.] */
-#ifdef _MSC_VER
-                        _Analysis_assume_(pos < nAllocation - 2);
-#endif
-                        result->s[pos++] = '\\';
-                        result->s[pos++] = '\\';
-                    }
-                    else if (source[i] == '/')
-                    {
-                        /*Codes_SRS_STRING_02_018: [If the character is / (slash) then it shall be represented as \/.] */
-#ifdef _MSC_VER
-                        _Analysis_assume_(pos < nAllocation - 2);
-#endif
-                        result->s[pos++] = '\\';
-                        result->s[pos++] = '/';
-                    }
-                    else
-                    {
-                        /*Codes_SRS_STRING_02_013: [The string shall copy the characters of source "as they are" (until the '\0' character) with the following exceptions:] */
-#ifdef _MSC_VER
-                        _Analysis_assume_(pos < nAllocation - 1);
-#endif
-                        result->s[pos++] = source[i];
-                    }
-                }
-
-#ifdef _MSC_VER
-                _Analysis_assume_(pos < nAllocation - 2);
-#endif
-                /*Codes_SRS_STRING_02_020: [The string shall end with " (quote).] */
-                result->s[pos++] = '"';
-                /*zero terminating it*/
-                result->s[pos] = '\0';
+                dest->s = temp;
+                json_escape(dest->s + destLength, (const unsigned char*)source, vlen);
+                /*Codes_SRS_STRING_01_006: [ On success STRING_concat_JSON shall return 0. ]*/
+                result = 0;
             }
         }
-
     }
-    return (STRING_HANDLE)result;
+    return result;
 }
 
 /*this function will concatenate to the string s1 the string s2, resulting in s1+s2*/
@@ -17,16 +17,32 @@
     ((c >= 'A') && (c <= 'F')) ||   \
     ((c >= 'a') && (c <= 'f'))      \
 )
-#define IS_PRINTABLE(c) (                           \
-    (c == 0) ||                                     \
-    (c == '!') ||                                   \
-    (c == '(') || (c == ')') || (c == '*') ||       \
-    (c == '-') || (c == '.') ||                     \
-    ((c >= '0') && (c <= '9')) ||                   \
-    ((c >= 'A') && (c <= 'Z')) ||                   \
-    (c == '_') ||                                   \
-    ((c >= 'a') && (c <= 'z'))                      \
-)
+/*Number of characters each byte takes once encoded: 1 for the characters left as they are
+(including the null terminator), 3 for %xx and 6 for the two byte %c2%xx / %c3%xx form*/
+static const unsigned char URL_ENCODED_CHAR_SIZE[256] =
+{
+    1, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 1, 3, 3, 3, 3, 3, 3, 1, 1, 1, 3, 3, 1, 1, 3,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 3, 3,
+    3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 1,
+    3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 3,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6
+};
+
+#define IS_PRINTABLE(c) (URL_ENCODED_CHAR_SIZE[(unsigned char)(c)] == 1)
+
+/*Small inputs are encoded/decoded on the stack before being appended to a STRING*/
+#define URL_STACK_BUFFER_SIZE 128
 
 /*The below macros are to be called on the big nibble of a hex value*/
 #define IS_IN_ASCII_RANGE(c) (  \
@@ -103,119 +119,215 @@ static size_t URL_PrintableChar(unsigned char charVal, char* buffer)
     return size;
 }
 
-static size_t calculateDecodedStringSize(const char* encodedString, size_t len)
+static unsigned char charFromNibbles(char bigNibbleStr, char littleNibbleStr)
+{
+    unsigned char bigNibbleVal = NIBBLE_FROM_STRING(bigNibbleStr);
+    unsigned char littleNibbleVal = NIBBLE_FROM_STRING(littleNibbleStr);
+
+    return bigNibbleVal << 4 | littleNibbleVal;
+}
+
+static size_t url_encoded_length(const unsigned char* input, size_t input_length)
 {
-    size_t decodedSize = 0;
+    size_t result = 0;
+    size_t i;
+    for (i = 0; i < input_length; i++)
+    {
+        result += URL_ENCODED_CHAR_SIZE[input[i]];
+    }
+    return result;
+}
+
+/*Encodes input in one pass, copying runs of characters that need no encoding with a single memcpy.
+Fails (without writing past destination_size) if destination cannot hold the encoded string and its null terminator.*/
+static int url_encode_into(const unsigned char* input, size_t input_length, char* destination, size_t destination_size, size_t* encoded_length)
+{
+    int result = 0;
+    size_t written = 0;
+    size_t i = 0;
 
-    if (encodedString == NULL)
+    while (i < input_length)
     {
-        LogError("Null encoded string");
+        size_t run_start = i;
+        while ((i < input_length) && (URL_ENCODED_CHAR_SIZE[input[i]] == 1))
+        {
+            i++;
+        }
+
+        if (i > run_start)
+        {
+            size_t run_length = i - run_start;
+            if (written + run_length >= destination_size)
+            {
+                result = __FAILURE__;
+                break;
+            }
+            (void)memcpy(destination + written, input + run_start, run_length);
+            written += run_length;
+        }
+
+        if (i < input_length)
+        {
+            if (written + URL_ENCODED_CHAR_SIZE[input[i]] >= destination_size)
+            {
+                result = __FAILURE__;
+                break;
+            }
+            written += URL_PrintableChar(input[i], destination + written);
+            i++;
+        }
     }
-    else if (len == 0)
+
+    if (result == 0)
     {
-        decodedSize = 1; //for null terminator
+        destination[written] = '\0';
+        *encoded_length = written;
     }
-    else
+    return result;
+}
+
+/*Decodes and validates input in one pass. The decoded string is never longer than the input.
+Fails if the input is not a valid encoding or destination cannot hold the decoded string and its null terminator.*/
+static int url_decode_into(const char* input, size_t input_length, char* destination, size_t destination_size, size_t* decoded_length)
+{
+    int result = 0;
+    size_t written = 0;
+    size_t i = 0;
+
+    while (i < input_length)
     {
-        size_t remaining_len = len;
-        size_t next_step = 0;
-        size_t i = 0;
-        while (i < len)
+        size_t run_start = i;
+        while ((i < input_length) && IS_PRINTABLE(input[i]))
+        {
+            i++;
+        }
+
+        if (i > run_start)
+        {
+            size_t run_length = i - run_start;
+            if (written + run_length >= destination_size)
+            {
+                LogError("Destination buffer too small");
+                result = __FAILURE__;
+                break;
+            }
+            (void)memcpy(destination + written, input + run_start, run_length);
+            written += run_length;
+        }
+
+        if (i < input_length)
         {
             //percent encoded character
-            if (encodedString[i] == '%')
+            if (input[i] == '%')
             {
-                if (remaining_len < 3 || !IS_HEXDIGIT(encodedString[i+1]) || !IS_HEXDIGIT(encodedString[i+2]))
+                if ((input_length - i) < 3 || !IS_HEXDIGIT(input[i + 1]) || !IS_HEXDIGIT(input[i + 2]))
                 {
                     LogError("Incomplete or invalid percent encoding");
+                    result = __FAILURE__;
                     break;
                 }
-                else if (!IS_IN_ASCII_RANGE(encodedString[i+1]))
+                else if (!IS_IN_ASCII_RANGE(input[i + 1]))
                 {
                     LogError("Out of range of characters accepted by this decoder");
+                    result = __FAILURE__;
+                    break;
+                }
+                else if (written + 1 >= destination_size)
+                {
+                    LogError("Destination buffer too small");
+                    result = __FAILURE__;
                     break;
                 }
                 else
                 {
-                    decodedSize++;
-                    next_step = 3;
+                    destination[written++] = charFromNibbles(input[i + 1], input[i + 2]);
+                    i += 3;
                 }
             }
-            else if (!IS_PRINTABLE(encodedString[i]))
+            else
             {
                 LogError("Unprintable value in encoded string");
+                result = __FAILURE__;
                 break;
             }
-            //safe character
-            else
-            {
-                decodedSize++;
-                next_step = 1;
-            }
-
-            i += next_step;
-            remaining_len -= next_step;
         }
+    }
 
-        if (encodedString[i] != '\0') //i.e. broke out of above loop due to error
+    if (result == 0)
+    {
+        if (written >= destination_size)
         {
-            decodedSize = 0;
+            LogError("Destination buffer too small");
+            result = __FAILURE__;
         }
         else
         {
-            decodedSize++; //add space for the null terminator
+            destination[written] = '\0';
+            *decoded_length = written;
         }
     }
-    return decodedSize;
+    return result;
 }
 
-static unsigned char charFromNibbles(char bigNibbleStr, char littleNibbleStr)
+static STRING_HANDLE url_encode_impl(const char* textEncode)
 {
-    unsigned char bigNibbleVal = NIBBLE_FROM_STRING(bigNibbleStr);
-    unsigned char littleNibbleVal = NIBBLE_FROM_STRING(littleNibbleStr);
-
-    return bigNibbleVal << 4 | littleNibbleVal;
-}
+    STRING_HANDLE result;
+    size_t input_length = strlen(textEncode);
+    size_t encoded_size = url_encoded_length((const unsigned char*)textEncode, input_length) + 1;
+    char* encodedURL;
 
-static void createDecodedString(const char* input, size_t input_size, char* output)
-{
-    /* Note that there is no danger of reckless indexing here, as calculateDecodedStringSize()
-    has already checked lengths of strings to ensure the formatting is always correct*/
-    size_t i = 0;
-    while (i <= input_size) //the <= instead of < ensures the '\0' will be copied
+    if ((encodedURL = (char*)malloc(encoded_size)) == NULL)
     {
-        if (input[i] != '%')
-        {
-            *output++ = input[i];
-            i++;
-        }
-        else
+        /*Codes_SRS_URL_ENCODE_06_002: [If an error occurs during the encoding of input then URL_Encode will return NULL.]*/
+        result = NULL;
+        LogError("URL_Encode:: MALLOC failure on encode.");
+    }
+    else
+    {
+        size_t encoded_length;
+        (void)url_encode_into((const unsigned char*)textEncode, input_length, encodedURL, encoded_size, &encoded_length);
+
+        result = STRING_new_with_memory(encodedURL);
+        if (result == NULL)
         {
-            *output++ = charFromNibbles(input[i+1], input[i+2]);
-            i += 3;
+            LogError("URL_Encode:: MALLOC failure on encode.");
+            free(encodedURL);
         }
     }
+    return result;
 }
 
-static size_t URL_PrintableCharSize(unsigned char charVal)
+static STRING_HANDLE url_decode_impl(const char* textDecode)
 {
-    size_t size;
-    if (IS_PRINTABLE(charVal))
+    STRING_HANDLE result;
+    size_t input_length = strlen(textDecode);
+    char* decodedString;
+
+    if ((decodedString = (char*)malloc(input_length + 1)) == NULL)
     {
-        size = 1;
+        LogError("URL_Decode:: MALLOC failure on decode.");
+        result = NULL;
     }
     else
     {
-        if (charVal < 0x80)
+        size_t decoded_length;
+        if (url_decode_into(textDecode, input_length, decodedString, input_length + 1, &decoded_length) != 0)
         {
-            size = 3;
+            LogError("URL_Decode:: Invalid input string");
+            free(decodedString);
+            result = NULL;
         }
         else
         {
-            size = 6;
+            result = STRING_new_with_memory(decodedString);
+            if (result == NULL)
+            {
+                LogError("URL_Decode:: MALLOC failure on decode");
+                free(decodedString);
+            }
         }
     }
-    return size;
+    return result;
 }
 
 STRING_HANDLE URL_EncodeString(const char* textEncode)
@@ -227,16 +339,7 @@ STRING_HANDLE URL_EncodeString(const char* textEncode)
     }
     else
     {
-        STRING_HANDLE tempString = STRING_construct(textEncode);
-        if (tempString == NULL)
-        {
-            result = NULL;
-        }
-        else
-        {
-            result = URL_Encode(tempString);
-            STRING_delete(tempString);
-        }
+        result = url_encode_impl(textEncode);
     }
     return result;
 }
@@ -252,38 +355,88 @@ STRING_HANDLE URL_Encode(STRING_HANDLE input)
     }
     else
     {
-        size_t lengthOfResult = 0;
-        char* encodedURL;
-        const char* currentInput;
-        unsigned char currentUnsignedChar;
-        currentInput = STRING_c_str(input);
         /*Codes_SRS_URL_ENCODE_06_003: [If input is a zero length string then URL_Encode will return a zero length string.]*/
-        do
-        {
-            currentUnsignedChar = (unsigned char)(*currentInput++);
-            lengthOfResult += URL_PrintableCharSize(currentUnsignedChar);
-        } while (currentUnsignedChar != 0);
-        if ((encodedURL = (char*)malloc(lengthOfResult)) == NULL)
+        result = url_encode_impl(STRING_c_str(input));
+    }
+    return result;
+}
+
+int URL_EncodeString_Into(const char* textEncode, char* destination, size_t destination_size, size_t* encoded_length)
+{
+    int result;
+    if (textEncode == NULL || destination == NULL || destination_size == 0 || encoded_length == NULL)
+    {
+        /*Codes_SRS_URL_ENCODE_01_001: [If textEncode, destination or encoded_length is NULL, or destination_size is 0, URL_EncodeString_Into shall fail and return a non-zero value.]*/
+        LogError("URL_EncodeString_Into:: invalid argument textEncode=%p, destination=%p, destination_size=%zu, encoded_length=%p", textEncode, destination, destination_size, encoded_length);
+        result = __FAILURE__;
+    }
+    /*Codes_SRS_URL_ENCODE_01_002: [URL_EncodeString_Into shall encode textEncode into destination in a single pass, null terminate it, store its length in encoded_length and return 0.]*/
+    else if (url_encode_into((const unsigned char*)textEncode, strlen(textEncode), destination, destination_size, encoded_length) != 0)
+    {
+        /*Codes_SRS_URL_ENCODE_01_003: [If destination_size is too small for the encoded string and its null terminator, URL_EncodeString_Into shall fail and return a non-zero value.]*/
+        LogError("URL_EncodeString_Into:: destination buffer too small");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+int URL_EncodeString_Append(STRING_HANDLE destination, const char* textEncode)
+{
+    int result;
+    if (destination == NULL || textEncode == NULL)
+    {
+        /*Codes_SRS_URL_ENCODE_01_004: [If destination or textEncode is NULL, URL_EncodeString_Append shall fail and return a non-zero value.]*/
+        LogError("URL_EncodeString_Append:: invalid argument destination=%p, textEncode=%p", destination, textEncode);
+        result = __FAILURE__;
+    }
+    else
+    {
+        char stack_buffer[URL_STACK_BUFFER_SIZE];
+        size_t input_length = strlen(textEncode);
+        size_t encoded_length;
+
+        /*Codes_SRS_URL_ENCODE_01_005: [URL_EncodeString_Append shall encode textEncode and append the result to destination, using a stack buffer when the encoded string is small enough.]*/
+        if (url_encode_into((const unsigned char*)textEncode, input_length, stack_buffer, sizeof(stack_buffer), &encoded_length) == 0)
         {
-            /*Codes_SRS_URL_ENCODE_06_002: [If an error occurs during the encoding of input then URL_Encode will return NULL.]*/
-            result = NULL;
-            LogError("URL_Encode:: MALLOC failure on encode.");
+            if (STRING_concat(destination, stack_buffer) != 0)
+            {
+                /*Codes_SRS_URL_ENCODE_01_006: [If any error occurs, URL_EncodeString_Append shall fail and return a non-zero value.]*/
+                LogError("URL_EncodeString_Append:: STRING_concat failed");
+                result = __FAILURE__;
+            }
+            else
+            {
+                result = 0;
+            }
         }
         else
         {
-            size_t currentEncodePosition = 0;
-            currentInput = STRING_c_str(input);
-            do
+            size_t encoded_size = url_encoded_length((const unsigned char*)textEncode, input_length) + 1;
+            char* encoded = (char*)malloc(encoded_size);
+            if (encoded == NULL)
             {
-                currentUnsignedChar = (unsigned char)(*currentInput++);
-                currentEncodePosition += URL_PrintableChar(currentUnsignedChar, &encodedURL[currentEncodePosition]);
-            } while (currentUnsignedChar != 0);
-
-            result = STRING_new_with_memory(encodedURL);
-            if (result == NULL)
+                /*Codes_SRS_URL_ENCODE_01_006: [If any error occurs, URL_EncodeString_Append shall fail and return a non-zero value.]*/
+                LogError("URL_EncodeString_Append:: MALLOC failure on encode.");
+                result = __FAILURE__;
+            }
+            else
             {
-                LogError("URL_Encode:: MALLOC failure on encode.");
-                free(encodedURL);
+                (void)url_encode_into((const unsigned char*)textEncode, input_length, encoded, encoded_size, &encoded_length);
+                if (STRING_concat(destination, encoded) != 0)
+                {
+                    /*Codes_SRS_URL_ENCODE_01_006: [If any error occurs, URL_EncodeString_Append shall fail and return a non-zero value.]*/
+                    LogError("URL_EncodeString_Append:: STRING_concat failed");
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    result = 0;
+                }
+                free(encoded);
             }
         }
     }
@@ -299,16 +452,7 @@ STRING_HANDLE URL_DecodeString(const char* textDecode)
     }
     else
     {
-        STRING_HANDLE tempString = STRING_construct(textDecode);
-        if (tempString == NULL)
-        {
-            result = NULL;
-        }
-        else
-        {
-            result = URL_Decode(tempString);
-            STRING_delete(tempString);
-        }
+        result = url_decode_impl(textDecode);
     }
     return result;
 }
@@ -323,28 +467,87 @@ STRING_HANDLE URL_Decode(STRING_HANDLE input)
     }
     else
     {
-        size_t decodedStringSize;
-        char* decodedString;
-        const char* inputString = STRING_c_str(input);
-        size_t inputLen = strlen(inputString);
-        if ((decodedStringSize = calculateDecodedStringSize(inputString, inputLen)) == 0)
+        result = url_decode_impl(STRING_c_str(input));
+    }
+    return result;
+}
+
+int URL_DecodeString_Into(const char* textDecode, char* destination, size_t destination_size, size_t* decoded_length)
+{
+    int result;
+    if (textDecode == NULL || destination == NULL || destination_size == 0 || decoded_length == NULL)
+    {
+        /*Codes_SRS_URL_ENCODE_01_007: [If textDecode, destination or decoded_length is NULL, or destination_size is 0, URL_DecodeString_Into shall fail and return a non-zero value.]*/
+        LogError("URL_DecodeString_Into:: invalid argument textDecode=%p, destination=%p, destination_size=%zu, decoded_length=%p", textDecode, destination, destination_size, decoded_length);
+        result = __FAILURE__;
+    }
+    /*Codes_SRS_URL_ENCODE_01_008: [URL_DecodeString_Into shall decode textDecode into destination in a single pass, null terminate it, store its length in decoded_length and return 0.]*/
+    else if (url_decode_into(textDecode, strlen(textDecode), destination, destination_size, decoded_length) != 0)
+    {
+        /*Codes_SRS_URL_ENCODE_01_009: [If textDecode is not a valid encoding or destination_size is too small for the decoded string and its null terminator, URL_DecodeString_Into shall fail and return a non-zero value.]*/
+        LogError("URL_DecodeString_Into:: decode failed");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+int URL_DecodeString_Append(STRING_HANDLE destination, const char* textDecode)
+{
+    int result;
+    if (destination == NULL || textDecode == NULL)
+    {
+        /*Codes_SRS_URL_ENCODE_01_010: [If destination or textDecode is NULL, URL_DecodeString_Append shall fail and return a non-zero value.]*/
+        LogError("URL_DecodeString_Append:: invalid argument destination=%p, textDecode=%p", destination, textDecode);
+        result = __FAILURE__;
+    }
+    else
+    {
+        char stack_buffer[URL_STACK_BUFFER_SIZE];
+        size_t input_length = strlen(textDecode);
+        char* decoded;
+
+        /*Codes_SRS_URL_ENCODE_01_011: [URL_DecodeString_Append shall decode textDecode and append the result to destination, using a stack buffer when the input is small enough.]*/
+        if (input_length < sizeof(stack_buffer))
         {
-            LogError("URL_Decode:: Invalid input string");
-            result = NULL;
+            decoded = stack_buffer;
         }
-        else if ((decodedString = (char*)malloc(decodedStringSize)) == NULL)
+        else if ((decoded = (char*)malloc(input_length + 1)) == NULL)
         {
-            LogError("URL_Decode:: MALLOC failure on decode.");
-            result = NULL;
+            LogError("URL_DecodeString_Append:: MALLOC failure on decode.");
+        }
+
+        if (decoded == NULL)
+        {
+            /*Codes_SRS_URL_ENCODE_01_012: [If textDecode is not a valid encoding or any other error occurs, URL_DecodeString_Append shall fail and return a non-zero value.]*/
+            result = __FAILURE__;
         }
         else
         {
-            createDecodedString(inputString, inputLen, decodedString);
-            result = STRING_new_with_memory(decodedString);
-            if (result == NULL)
+            size_t decoded_length;
+            if (url_decode_into(textDecode, input_length, decoded, input_length + 1, &decoded_length) != 0)
             {
-                LogError("URL_Decode:: MALLOC failure on decode");
-                free(decodedString);
+                /*Codes_SRS_URL_ENCODE_01_012: [If textDecode is not a valid encoding or any other error occurs, URL_DecodeString_Append shall fail and return a non-zero value.]*/
+                LogError("URL_DecodeString_Append:: Invalid input string");
+                result = __FAILURE__;
+            }
+            else if (STRING_concat(destination, decoded) != 0)
+            {
+                /*Codes_SRS_URL_ENCODE_01_012: [If textDecode is not a valid encoding or any other error occurs, URL_DecodeString_Append shall fail and return a non-zero value.]*/
+                LogError("URL_DecodeString_Append:: STRING_concat failed");
+                result = __FAILURE__;
+            }
+            else
+            {
+                result = 0;
+            }
+
+            if (decoded != stack_buffer)
+            {
+                free(decoded);
             }
         }
     }
@@ -1,18 +1,130 @@
- // Copyright (c) Microsoft. All rights reserved.
+// Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #ifdef __cplusplus
 #include <cstdlib>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #else
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #endif
 
+#include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/utf8_checker.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+/* Validation is driven by a small state machine over byte classes. The states track how many
+   continuation bytes are still expected, with two extra states for the lead bytes 0xE0 and 0xF0
+   whose second byte is restricted so that overlong encodings are rejected (code points that would
+   fit in fewer bytes). */
+#define UTF8_STATE_ACCEPT           0
+#define UTF8_STATE_NEED_1           1
+#define UTF8_STATE_NEED_2           2
+#define UTF8_STATE_NEED_3           3
+#define UTF8_STATE_E0_NEED_2        4
+#define UTF8_STATE_F0_NEED_3        5
+#define UTF8_STATE_REJECT           6
+#define UTF8_STATE_COUNT            7
+
+#define UTF8_CLASS_COUNT            10
+
+/* 0: 0x00-0x7F, 1: 0x80-0x8F, 2: 0x90-0x9F, 3: 0xA0-0xBF, 4: invalid anywhere (0xC0, 0xC1, 0xF8-0xFF),
+   5: 0xC2-0xDF, 6: 0xE0, 7: 0xE1-0xEF, 8: 0xF0, 9: 0xF1-0xF7 */
+static const unsigned char UTF8_BYTE_CLASS[256] =
+{
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    4, 4, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    8, 9, 9, 9, 9, 9, 9, 9, 4, 4, 4, 4, 4, 4, 4, 4
+};
+
+static const unsigned char UTF8_TRANSITIONS[UTF8_STATE_COUNT][UTF8_CLASS_COUNT] =
+{
+    /* ACCEPT */        { UTF8_STATE_ACCEPT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_NEED_1, UTF8_STATE_E0_NEED_2, UTF8_STATE_NEED_2, UTF8_STATE_F0_NEED_3, UTF8_STATE_NEED_3 },
+    /* NEED_1 */        { UTF8_STATE_REJECT, UTF8_STATE_ACCEPT, UTF8_STATE_ACCEPT, UTF8_STATE_ACCEPT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT },
+    /* NEED_2 */        { UTF8_STATE_REJECT, UTF8_STATE_NEED_1, UTF8_STATE_NEED_1, UTF8_STATE_NEED_1, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT },
+    /* NEED_3 */        { UTF8_STATE_REJECT, UTF8_STATE_NEED_2, UTF8_STATE_NEED_2, UTF8_STATE_NEED_2, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT },
+    /* E0_NEED_2 */     { UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_NEED_1, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT },
+    /* F0_NEED_3 */     { UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_NEED_2, UTF8_STATE_NEED_2, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT },
+    /* REJECT */        { UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT, UTF8_STATE_REJECT }
+};
+
+#define UTF8_ASCII_BLOCK_SIZE       (2 * sizeof(uint64_t))
+#define UTF8_HIGH_BITS              0x8080808080808080ULL
+
+/* Returns the number of leading bytes of utf8_str that are 7-bit ASCII, looking at 16 bytes at a time */
+static size_t utf8_checker_ascii_prefix_length(const unsigned char* utf8_str, size_t length)
+{
+    size_t pos = 0;
+
+    while (length - pos >= UTF8_ASCII_BLOCK_SIZE)
+    {
+        uint64_t block[2];
+        (void)memcpy(block, utf8_str + pos, sizeof(block));
+        if (((block[0] | block[1]) & UTF8_HIGH_BITS) != 0)
+        {
+            break;
+        }
+        pos += UTF8_ASCII_BLOCK_SIZE;
+    }
+
+    while ((pos < length) && (utf8_str[pos] < 0x80))
+    {
+        pos++;
+    }
+
+    return pos;
+}
+
+static unsigned char utf8_checker_run(unsigned char state, const unsigned char* utf8_str, size_t length)
+{
+    size_t pos = 0;
+
+    while (pos < length)
+    {
+        unsigned char current = utf8_str[pos];
+        if ((state == UTF8_STATE_ACCEPT) && (current < 0x80))
+        {
+            /* Codes_SRS_UTF8_CHECKER_01_006: [ 00000000 0xxxxxxx 0xxxxxxx ]*/
+            pos++;
+            if ((pos < length) && (utf8_str[pos] < 0x80))
+            {
+                pos += utf8_checker_ascii_prefix_length(utf8_str + pos, length - pos);
+            }
+        }
+        else
+        {
+            /* Codes_SRS_UTF8_CHECKER_01_007: [ 00000yyy yyxxxxxx 110yyyyy 10xxxxxx ]*/
+            /* Codes_SRS_UTF8_CHECKER_01_008: [ zzzzyyyy yyxxxxxx 1110zzzz 10yyyyyy 10xxxxxx ]*/
+            /* Codes_SRS_UTF8_CHECKER_01_009: [ 000uuuuu zzzzyyyy yyxxxxxx 11110uuu 10uuzzzz 10yyyyyy 10xxxxxx ]*/
+            state = UTF8_TRANSITIONS[state][UTF8_BYTE_CLASS[current]];
+            if (state == UTF8_STATE_REJECT)
+            {
+                break;
+            }
+            pos++;
+        }
+    }
+
+    return state;
+}
 
 bool utf8_checker_is_valid_utf8(const unsigned char* utf8_str, size_t length)
 {
@@ -25,152 +137,101 @@ bool utf8_checker_is_valid_utf8(const unsigned char* utf8_str, size_t length)
     }
     else
     {
-        size_t pos = 0;
-
         /* Codes_SRS_UTF8_CHECKER_01_003: [ If `length` is 0, `utf8_checker_is_valid_utf8` shall consider `utf8_str` to be valid UTF-8 and return true. ]*/
-        result = true;
+        /* Codes_SRS_UTF8_CHECKER_01_001: [ `utf8_checker_is_valid_utf8` shall verify that the sequence of chars pointed to by `utf8_str` represent UTF-8 encoded codepoints. ]*/
+        /* Codes_SRS_UTF8_CHECKER_01_005: [ On success it shall return true. ]*/
+        result = (utf8_checker_run(UTF8_STATE_ACCEPT, utf8_str, length) == UTF8_STATE_ACCEPT);
+    }
+
+    return result;
+}
 
-        while ((result == true) &&
-               (pos < length))
+typedef struct UTF8_CHECKER_INSTANCE_TAG
+{
+    unsigned char state;
+} UTF8_CHECKER_INSTANCE;
+
+UTF8_CHECKER_HANDLE utf8_checker_create(void)
+{
+    /* Codes_SRS_UTF8_CHECKER_01_010: [ `utf8_checker_create` shall allocate a new checker instance and return a non-NULL handle to it. ]*/
+    UTF8_CHECKER_INSTANCE* result = (UTF8_CHECKER_INSTANCE*)malloc(sizeof(UTF8_CHECKER_INSTANCE));
+    if (result == NULL)
+    {
+        /* Codes_SRS_UTF8_CHECKER_01_011: [ If allocating memory fails, `utf8_checker_create` shall return NULL. ]*/
+        LogError("Cannot allocate memory for UTF-8 checker");
+    }
+    else
+    {
+        /* Codes_SRS_UTF8_CHECKER_01_012: [ A newly created checker shall be in the same state as one on which no bytes have been processed. ]*/
+        result->state = UTF8_STATE_ACCEPT;
+    }
+
+    return result;
+}
+
+void utf8_checker_destroy(UTF8_CHECKER_HANDLE utf8_checker)
+{
+    /* Codes_SRS_UTF8_CHECKER_01_014: [ If `utf8_checker` is NULL, `utf8_checker_destroy` shall do nothing. ]*/
+    if (utf8_checker != NULL)
+    {
+        /* Codes_SRS_UTF8_CHECKER_01_013: [ `utf8_checker_destroy` shall free the memory associated with the checker. ]*/
+        free(utf8_checker);
+    }
+}
+
+void utf8_checker_reset(UTF8_CHECKER_HANDLE utf8_checker)
+{
+    /* Codes_SRS_UTF8_CHECKER_01_016: [ If `utf8_checker` is NULL, `utf8_checker_reset` shall do nothing. ]*/
+    if (utf8_checker != NULL)
+    {
+        /* Codes_SRS_UTF8_CHECKER_01_015: [ `utf8_checker_reset` shall discard all bytes processed so far, including a previously detected invalid sequence. ]*/
+        utf8_checker->state = UTF8_STATE_ACCEPT;
+    }
+}
+
+bool utf8_checker_process(UTF8_CHECKER_HANDLE utf8_checker, const unsigned char* utf8_str, size_t length)
+{
+    bool result;
+
+    if ((utf8_checker == NULL) ||
+        (utf8_str == NULL))
+    {
+        /* Codes_SRS_UTF8_CHECKER_01_021: [ If `utf8_checker` or `utf8_str` is NULL, `utf8_checker_process` shall return false. ]*/
+        LogError("Bad arguments: utf8_checker = %p, utf8_str = %p", utf8_checker, utf8_str);
+        result = false;
+    }
+    else
+    {
+        /* Codes_SRS_UTF8_CHECKER_01_017: [ `utf8_checker_process` shall continue validating from where the previous call left off, so that a code point may be split across calls. ]*/
+        /* Codes_SRS_UTF8_CHECKER_01_020: [ Once an invalid sequence has been detected, `utf8_checker_process` shall return false without examining further bytes until the checker is reset. ]*/
+        if (utf8_checker->state != UTF8_STATE_REJECT)
         {
-            /* Codes_SRS_UTF8_CHECKER_01_001: [ `utf8_checker_is_valid_utf8` shall verify that the sequence of chars pointed to by `utf8_str` represent UTF-8 encoded codepoints. ]*/
-            if ((utf8_str[pos] >> 3) == 0x1E)
-            {
-                /* 4 bytes */
-                /* Codes_SRS_UTF8_CHECKER_01_009: [ 000uuuuu zzzzyyyy yyxxxxxx 11110uuu 10uuzzzz 10yyyyyy 10xxxxxx ]*/
-                uint32_t code_point = (utf8_str[pos] & 0x07);
-
-                pos++;
-                if ((pos < length) &&
-                    ((utf8_str[pos] >> 6) == 0x02))
-                {
-                    code_point <<= 6;
-                    code_point += utf8_str[pos] & 0x3F;
-
-                    pos++;
-                    if ((pos < length) &&
-                        ((utf8_str[pos] >> 6) == 0x02))
-                    {
-                        code_point <<= 6;
-                        code_point += utf8_str[pos] & 0x3F;
-
-                        pos++;
-                        if ((pos < length) &&
-                            ((utf8_str[pos] >> 6) == 0x02))
-                        {
-                            code_point <<= 6;
-                            code_point += utf8_str[pos] & 0x3F;
-
-                            if (code_point <= 0xFFFF)
-                            {
-                                result = false;
-                            }
-                            else
-                            {
-                                /* Codes_SRS_UTF8_CHECKER_01_005: [ On success it shall return true. ]*/
-                                result = true;
-                                pos++;
-                            }
-                        }
-                        else
-                        {
-                            result = false;
-                        }
-                    }
-                    else
-                    {
-                        result = false;
-                    }
-                }
-                else
-                {
-                    result = false;
-                }
-            }
-            else if ((utf8_str[pos] >> 4) == 0x0E)
-            {
-                /* 3 bytes */
-                /* Codes_SRS_UTF8_CHECKER_01_008: [ zzzzyyyy yyxxxxxx 1110zzzz 10yyyyyy 10xxxxxx ]*/
-                uint32_t code_point = (utf8_str[pos] & 0x0F);
-
-                pos++;
-                if ((pos < length) &&
-                    ((utf8_str[pos] >> 6) == 0x02))
-                {
-                    code_point <<= 6;
-                    code_point += utf8_str[pos] & 0x3F;
-
-                    pos++;
-                    if ((pos < length) &&
-                        ((utf8_str[pos] >> 6) == 0x02))
-                    {
-                        code_point <<= 6;
-                        code_point += utf8_str[pos] & 0x3F;
-
-                        if (code_point <= 0x7FF)
-                        {
-                            result = false;
-                        }
-                        else
-                        {
-                            /* Codes_SRS_UTF8_CHECKER_01_005: [ On success it shall return true. ]*/
-                            result = true;
-                            pos++;
-                        }
-                    }
-                    else
-                    {
-                        result = false;
-                    }
-                }
-                else
-                {
-                    result = false;
-                }
-            }
-            else if ((utf8_str[pos] >> 5) == 0x06)
-            {
-                /* 2 bytes */
-                /* Codes_SRS_UTF8_CHECKER_01_007: [ 00000yyy yyxxxxxx 110yyyyy 10xxxxxx ]*/
-                uint32_t code_point = (utf8_str[pos] & 0x1F);
-
-                pos++;
-                if ((pos < length) &&
-                    ((utf8_str[pos] >> 6) == 0x02))
-                {
-                    code_point <<= 6;
-                    code_point += utf8_str[pos] & 0x3F;
-
-                    if (code_point <= 0x7F)
-                    {
-                        result = false;
-                    }
-                    else
-                    {
-                        /* Codes_SRS_UTF8_CHECKER_01_005: [ On success it shall return true. ]*/
-                        result = true;
-                        pos++;
-                    }
-                }
-                else
-                {
-                    result = false;
-                }
-            }
-            else if ((utf8_str[pos] >> 7) == 0x00)
-            {
-                /* 1 byte */
-                /* Codes_SRS_UTF8_CHECKER_01_006: [ 00000000 0xxxxxxx 0xxxxxxx ]*/
-                /* Codes_SRS_UTF8_CHECKER_01_005: [ On success it shall return true. ]*/
-                result = true;
-                pos++;
-            }
-            else
-            {
-                /* error */
-                result = false;
-            }
+            utf8_checker->state = utf8_checker_run(utf8_checker->state, utf8_str, length);
         }
+
+        /* Codes_SRS_UTF8_CHECKER_01_018: [ If the bytes processed so far are valid UTF-8 or a prefix of valid UTF-8, `utf8_checker_process` shall return true. ]*/
+        /* Codes_SRS_UTF8_CHECKER_01_019: [ Otherwise `utf8_checker_process` shall return false. ]*/
+        result = (utf8_checker->state != UTF8_STATE_REJECT);
+    }
+
+    return result;
+}
+
+bool utf8_checker_is_complete(UTF8_CHECKER_HANDLE utf8_checker)
+{
+    bool result;
+
+    if (utf8_checker == NULL)
+    {
+        /* Codes_SRS_UTF8_CHECKER_01_024: [ If `utf8_checker` is NULL, `utf8_checker_is_complete` shall return false. ]*/
+        LogError("NULL utf8_checker");
+        result = false;
+    }
+    else
+    {
+        /* Codes_SRS_UTF8_CHECKER_01_022: [ `utf8_checker_is_complete` shall return true if all bytes processed so far form complete, valid UTF-8 codepoints. ]*/
+        /* Codes_SRS_UTF8_CHECKER_01_023: [ If an invalid sequence was detected or the last code point is incomplete, `utf8_checker_is_complete` shall return false. ]*/
+        result = (utf8_checker->state == UTF8_STATE_ACCEPT);
     }
 
     return result;
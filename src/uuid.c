@@ -2,7 +2,6 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
-#include <stdio.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/uuid.h"
 #include "azure_c_shared_utility/uniqueid.h"
@@ -11,15 +10,46 @@
 
 #define UUID_STRING_LENGTH          36
 #define UUID_STRING_SIZE            (UUID_STRING_LENGTH + 1)
+#define UUID_OCTET_COUNT            16
 #define __SUCCESS__                 0
-#define UUID_FORMAT_STRING          "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x"
 
-#define HEXA_DIGIT_VAL(c) \
-    ((((c) >= '0') && ((c) <= '9')) \
-        ? ((c) - '0') \
-        : (((c) >= 'a') && ((c) <= 'f')) \
-            ? ((c) - 'a' + 10) \
-            : (((c) >= 'A') && ((c) <= 'F')) ? ((c) - 'A' + 10) : -1)
+/* Values in the table are the nibble value, or 0xFF for characters that are not hex digits. */
+#define HEX_DIGIT_INVALID           0xFF
+
+static const char UUID_HEX_DIGITS[] = "0123456789abcdef";
+
+static const unsigned char HEX_DIGIT_VALUE[256] =
+{
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/* Non-zero for the octets that are followed by a dash in the 8-4-4-4-12 string layout. */
+static const unsigned char UUID_DASH_AFTER_OCTET[UUID_OCTET_COUNT] =
+{
+    0, 0, 0, 1, 0, 1, 0, 1, 0, 1, 0, 0, 0, 0, 0, 0
+};
+
+static void uuid_set_version_4(unsigned char* uuid_bytes)
+{
+    /* RFC 4122, section 4.4: version 4 in the high nibble of octet 6, variant 10x in the high bits of octet 8 */
+    uuid_bytes[6] = (unsigned char)((uuid_bytes[6] & 0x0F) | 0x40);
+    uuid_bytes[8] = (unsigned char)((uuid_bytes[8] & 0x3F) | 0x80);
+}
 
 int UUID_from_string(const char* uuid_string, UUID* uuid)
 {
@@ -33,60 +63,96 @@ int UUID_from_string(const char* uuid_string, UUID* uuid)
     }
     else
     {
-        size_t uuid_string_length = strlen(uuid_string);
+        // Codes_SRS_UUID_09_008: [ Each pair of digits in `uuid_string`, excluding dashes, shall be read as a single HEX value and saved on the respective position in `uuid` ]
+        const unsigned char* current = (const unsigned char*)uuid_string;
+        unsigned char* uuid_bytes = (unsigned char*)uuid;
+        size_t i;
 
-        if (uuid_string_length != UUID_STRING_LENGTH)
-        {
-            LogError("Unexpected size for an UUID string (%d)", uuid_string_length);
-            result = __FAILURE__;
-        }
-        else
-        {
-            // Codes_SRS_UUID_09_008: [ Each pair of digits in `uuid_string`, excluding dashes, shall be read as a single HEX value and saved on the respective position in `uuid` ]
-            size_t i, j;
-            unsigned char* uuid_bytes;
+        // Codes_SRS_UUID_09_010: [ If no failures occur, UUID_from_string shall return zero ]
+        result = __SUCCESS__;
 
-            uuid_bytes = (unsigned char*)uuid;
-            // Codes_SRS_UUID_09_010: [ If no failures occur, UUID_from_string shall return zero ]
-            result = __SUCCESS__;
+        /* A NUL terminator is neither a hex digit nor a dash, so a short string fails before reading past its end */
+        for (i = 0; i < UUID_OCTET_COUNT; i++)
+        {
+            unsigned char higher_order_digit = HEX_DIGIT_VALUE[current[0]];
+            unsigned char lower_order_digit;
 
-            for (i = 0, j = 0; i < uuid_string_length; )
+            if ((higher_order_digit == HEX_DIGIT_INVALID) ||
+                ((lower_order_digit = HEX_DIGIT_VALUE[current[1]]) == HEX_DIGIT_INVALID))
             {
-                bool mustBeDash = i == 8 || i == 13 || i == 18 || i == 23;
+                // Codes_SRS_UUID_09_009: [ If `uuid` fails to be generated, UUID_from_string shall return a non-zero value ]
+                LogError("Failed decoding UUID string (%d)", (int)((const char*)current - uuid_string));
+                result = __FAILURE__;
+                break;
+            }
 
-                if ((uuid_string[i] == '-') != mustBeDash)
+            uuid_bytes[i] = (unsigned char)((higher_order_digit << 4) | lower_order_digit);
+            current += 2;
+
+            if (UUID_DASH_AFTER_OCTET[i] != 0)
+            {
+                if (*current != '-')
                 {
                     // Codes_SRS_UUID_09_009: [ If `uuid` fails to be generated, UUID_from_string shall return a non-zero value ]
-                    LogError("Failed decoding UUID string (%d)", i);
+                    LogError("Failed decoding UUID string (%d)", (int)((const char*)current - uuid_string));
                     result = __FAILURE__;
                     break;
                 }
 
-                if (uuid_string[i] == '-')
-                {
-                    i++;
-                }
-                else
-                {
-                    int higherOrderDigit = HEXA_DIGIT_VAL(uuid_string[i]);
-                    int lowerOrderDigit = HEXA_DIGIT_VAL(uuid_string[i + 1]);
-
-                    if (higherOrderDigit == -1 || lowerOrderDigit == -1)
-                    {
-                        // Codes_SRS_UUID_09_009: [ If `uuid` fails to be generated, UUID_from_string shall return a non-zero value ]
-                        LogError("Failed decoding UUID string (%d)", i);
-                        result = __FAILURE__;
-                        break;
-                    }
-                    else
-                    {
-                        uuid_bytes[j] = (unsigned char)(higherOrderDigit * 16 + lowerOrderDigit);
-                        i += 2;
-                        j++;
-                    }
-                }
+                current++;
             }
         }
+
+        if ((result == __SUCCESS__) && (*current != '\0'))
+        {
+            LogError("Unexpected size for an UUID string");
+            result = __FAILURE__;
+        }
+    }
+
+    return result;
+}
+
+int UUID_to_string_into(UUID* uuid, char* destination, size_t destination_size)
+{
+    int result;
+
+    if ((uuid == NULL) ||
+        (destination == NULL))
+    {
+        /* Codes_SRS_UUID_01_001: [ If `uuid` or `destination` is NULL, `UUID_to_string_into` shall fail and return a non-zero value. ]*/
+        LogError("Invalid argument (uuid=%p, destination=%p)", uuid, destination);
+        result = __FAILURE__;
+    }
+    else if (destination_size < UUID_STRING_SIZE)
+    {
+        /* Codes_SRS_UUID_01_002: [ If `destination_size` is smaller than 37, `UUID_to_string_into` shall fail and return a non-zero value. ]*/
+        LogError("Destination buffer too small (%lu)", (unsigned long)destination_size);
+        result = __FAILURE__;
+    }
+    else
+    {
+        const unsigned char* uuid_bytes = (const unsigned char*)uuid;
+        char* current = destination;
+        size_t i;
+
+        /* Codes_SRS_UUID_01_003: [ `UUID_to_string_into` shall write the 36 character RFC 4122 representation of `uuid` using lowercase hex digits, followed by a NUL terminator, to `destination`. ]*/
+        for (i = 0; i < UUID_OCTET_COUNT; i++)
+        {
+            current[0] = UUID_HEX_DIGITS[uuid_bytes[i] >> 4];
+            current[1] = UUID_HEX_DIGITS[uuid_bytes[i] & 0x0F];
+            current += 2;
+
+            if (UUID_DASH_AFTER_OCTET[i] != 0)
+            {
+                *current++ = '-';
+            }
+        }
+
+        *current = '\0';
+
+        /* Codes_SRS_UUID_01_004: [ On success `UUID_to_string_into` shall return 0. ]*/
+        result = __SUCCESS__;
     }
 
     return result;
@@ -108,28 +174,13 @@ char* UUID_to_string(UUID* uuid)
         // Codes_SRS_UUID_09_013: [ If `uuid_string` fails to be allocated, UUID_to_string shall return NULL ]
         LogError("Failed allocating UUID string");
     }
-    else
+    // Codes_SRS_UUID_09_014: [ Each character in `uuid` shall be written in the respective positions of `uuid_string` as a 2-digit HEX value ]
+    else if (UUID_to_string_into(uuid, result, UUID_STRING_SIZE) != 0)
     {
-        unsigned char* uuid_bytes;
-        int number_of_chars_written;
-
-        uuid_bytes = (unsigned char*)uuid;
-
-        // Codes_SRS_UUID_09_014: [ Each character in `uuid` shall be written in the respective positions of `uuid_string` as a 2-digit HEX value ]
-        number_of_chars_written = sprintf(result, UUID_FORMAT_STRING,
-            uuid_bytes[0], uuid_bytes[1], uuid_bytes[2], uuid_bytes[3],
-            uuid_bytes[4], uuid_bytes[5],
-            uuid_bytes[6], uuid_bytes[7],
-            uuid_bytes[8], uuid_bytes[9],
-            uuid_bytes[10], uuid_bytes[11], uuid_bytes[12], uuid_bytes[13], uuid_bytes[14], uuid_bytes[15]);
-
-        if (number_of_chars_written != UUID_STRING_LENGTH)
-        {
-            // Tests_SRS_UUID_09_015: [ If `uuid_string` fails to be set, UUID_to_string shall return NULL ]
-            LogError("Failed encoding UUID string");
-            free(result);
-            result = NULL;
-        }
+        // Codes_SRS_UUID_09_015: [ If `uuid_string` fails to be set, UUID_to_string shall return NULL ]
+        LogError("Failed encoding UUID string");
+        free(result);
+        result = NULL;
     }
 
     // Codes_SRS_UUID_09_016: [ If no failures occur, UUID_to_string shall return `uuid_string` ]
@@ -146,42 +197,108 @@ int UUID_generate(UUID* uuid)
         LogError("Invalid argument (uuid is NULL)");
         result = __FAILURE__;
     }
+    // Codes_SRS_UUID_09_002: [ UUID_generate shall obtain 16 random bytes from UniqueId_GetRandomBytes ]
+    else if (UniqueId_GetRandomBytes((unsigned char*)uuid, UUID_OCTET_COUNT) != UNIQUEID_OK)
+    {
+        // Codes_SRS_UUID_09_003: [ If the random bytes fail to be obtained, UUID_generate shall fail and return a non-zero value ]
+        LogError("Failed generating UUID");
+        result = __FAILURE__;
+    }
     else
     {
-        char* uuid_string;
+        // Codes_SRS_UUID_09_004: [ The version and variant bits of `uuid` shall be set as per RFC 4122 for a version 4 (random) UUID ]
+        uuid_set_version_4((unsigned char*)uuid);
 
-        if ((uuid_string = (char*)malloc(sizeof(char) * UUID_STRING_SIZE)) == NULL)
-        {
-            // Codes_SRS_UUID_09_003: [ If the UUID string fails to be obtained, UUID_generate shall fail and return a non-zero value ]
-            LogError("Failed allocating UUID string");
-            result = __FAILURE__;
-        }
-        else
-        {
-            memset(uuid_string, 0, sizeof(char) * UUID_STRING_SIZE);
+        // Codes_SRS_UUID_09_006: [ If no failures occur, UUID_generate shall return zero ]
+        result = __SUCCESS__;
+    }
 
-            // Codes_SRS_UUID_09_002: [ UUID_generate shall obtain an UUID string from UniqueId_Generate ]
-            if (UniqueId_Generate(uuid_string, UUID_STRING_SIZE) != UNIQUEID_OK)
-            {
-                // Codes_SRS_UUID_09_003: [ If the UUID string fails to be obtained, UUID_generate shall fail and return a non-zero value ]
-                LogError("Failed generating UUID");
-                result = __FAILURE__;
-            }
-            // Codes_SRS_UUID_09_004: [ The UUID string shall be parsed into an UUID type (16 unsigned char array) and filled in `uuid` ]
-            else if (UUID_from_string(uuid_string, uuid) != 0)
-            {
-                // Codes_SRS_UUID_09_005: [ If `uuid` fails to be set, UUID_generate shall fail and return a non-zero value ]
-                LogError("Failed parsing UUID string");
-                result = __FAILURE__;
-            }
-            else
-            {
-                // Codes_SRS_UUID_09_006: [ If no failures occur, UUID_generate shall return zero ]
-                result = __SUCCESS__;
-            }
+    return result;
+}
+
+int UUID_generate_v7(UUID* uuid)
+{
+    int result;
+    uint64_t unix_time_ms;
+    uint16_t sequence;
+
+    /* Codes_SRS_UUID_01_010: [ If `uuid` is NULL, `UUID_generate_v7` shall fail and return a non-zero value. ]*/
+    if (uuid == NULL)
+    {
+        LogError("Invalid argument (uuid is NULL)");
+        result = __FAILURE__;
+    }
+    /* Codes_SRS_UUID_01_011: [ `UUID_generate_v7` shall obtain a millisecond Unix timestamp and a sequence number by calling `UniqueId_GetTimestampSequence`. ]*/
+    else if (UniqueId_GetTimestampSequence(&unix_time_ms, &sequence) != UNIQUEID_OK)
+    {
+        /* Codes_SRS_UUID_01_012: [ If `UniqueId_GetTimestampSequence` fails, `UUID_generate_v7` shall fail and return a non-zero value. ]*/
+        LogError("Failed getting UUID timestamp");
+        result = __FAILURE__;
+    }
+    /* Codes_SRS_UUID_01_013: [ `UUID_generate_v7` shall obtain the last 8 bytes of `uuid` by calling `UniqueId_GetRandomBytes`. ]*/
+    else if (UniqueId_GetRandomBytes((unsigned char*)uuid + 8, 8) != UNIQUEID_OK)
+    {
+        /* Codes_SRS_UUID_01_014: [ If `UniqueId_GetRandomBytes` fails, `UUID_generate_v7` shall fail and return a non-zero value. ]*/
+        LogError("Failed generating UUID random bits");
+        result = __FAILURE__;
+    }
+    else
+    {
+        unsigned char* uuid_bytes = (unsigned char*)uuid;
+
+        /* Codes_SRS_UUID_01_015: [ Octets 0 to 5 of `uuid` shall hold the 48 bit timestamp in big endian order. ]*/
+        uuid_bytes[0] = (unsigned char)(unix_time_ms >> 40);
+        uuid_bytes[1] = (unsigned char)(unix_time_ms >> 32);
+        uuid_bytes[2] = (unsigned char)(unix_time_ms >> 24);
+        uuid_bytes[3] = (unsigned char)(unix_time_ms >> 16);
+        uuid_bytes[4] = (unsigned char)(unix_time_ms >> 8);
+        uuid_bytes[5] = (unsigned char)unix_time_ms;
+
+        /* Codes_SRS_UUID_01_016: [ The version nibble shall be 7 and the following 12 bits shall hold the sequence number. ]*/
+        uuid_bytes[6] = (unsigned char)(0x70 | ((sequence >> 8) & 0x0F));
+        uuid_bytes[7] = (unsigned char)sequence;
+
+        /* Codes_SRS_UUID_01_017: [ The variant bits shall be set as per RFC 4122. ]*/
+        uuid_bytes[8] = (unsigned char)((uuid_bytes[8] & 0x3F) | 0x80);
+
+        /* Codes_SRS_UUID_01_018: [ On success `UUID_generate_v7` shall return 0. ]*/
+        result = __SUCCESS__;
+    }
+
+    return result;
+}
 
-            free(uuid_string);
+int UUID_generate_batch(UUID* uuids, size_t count)
+{
+    int result;
+
+    if ((uuids == NULL) ||
+        (count == 0) ||
+        (count > ((size_t)-1) / UUID_OCTET_COUNT))
+    {
+        /* Codes_SRS_UUID_01_005: [ If `uuids` is NULL or `count` is 0, `UUID_generate_batch` shall fail and return a non-zero value. ]*/
+        LogError("Invalid argument (uuids=%p, count=%lu)", uuids, (unsigned long)count);
+        result = __FAILURE__;
+    }
+    /* Codes_SRS_UUID_01_006: [ `UUID_generate_batch` shall obtain the random bytes for all `count` UUIDs with a single call to `UniqueId_GetRandomBytes`. ]*/
+    else if (UniqueId_GetRandomBytes((unsigned char*)uuids, count * UUID_OCTET_COUNT) != UNIQUEID_OK)
+    {
+        /* Codes_SRS_UUID_01_007: [ If `UniqueId_GetRandomBytes` fails, `UUID_generate_batch` shall fail and return a non-zero value. ]*/
+        LogError("Failed generating %lu UUIDs", (unsigned long)count);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t i;
+
+        /* Codes_SRS_UUID_01_008: [ The version and variant bits of each UUID shall be set as per RFC 4122 for a version 4 (random) UUID. ]*/
+        for (i = 0; i < count; i++)
+        {
+            uuid_set_version_4(uuids[i]);
         }
+
+        /* Codes_SRS_UUID_01_009: [ On success `UUID_generate_batch` shall return 0. ]*/
+        result = __SUCCESS__;
     }
 
     return result;
@@ -93,6 +93,8 @@ typedef struct UWS_CLIENT_INSTANCE_TAG
     unsigned char* fragment_buffer;
     size_t fragment_buffer_count;
     unsigned char fragmented_frame_type;
+    bool discard_fragments;
+    UTF8_CHECKER_HANDLE utf8_checker;
 } UWS_CLIENT_INSTANCE;
 
 void clear_pending_sends(UWS_CLIENT_INSTANCE* uws_client);
@@ -269,6 +271,8 @@ UWS_CLIENT_HANDLE uws_client_create(const char* hostname, unsigned int port, con
                                 result->fragment_buffer = NULL;
                                 result->fragment_buffer_count = 0;
                                 result->fragmented_frame_type = WS_FRAME_TYPE_UNKNOWN;
+                                result->discard_fragments = false;
+                                result->utf8_checker = NULL;
 
                                 result->protocol_count = protocol_count;
 
@@ -446,6 +450,8 @@ UWS_CLIENT_HANDLE uws_client_create_with_io(const IO_INTERFACE_DESCRIPTION* io_i
                                 result->fragment_buffer = NULL;
                                 result->fragment_buffer_count = 0;
                                 result->fragmented_frame_type = WS_FRAME_TYPE_UNKNOWN;
+                                result->discard_fragments = false;
+                                result->utf8_checker = NULL;
 
                                 result->protocol_count = protocol_count;
 
@@ -527,6 +533,12 @@ void uws_client_destroy(UWS_CLIENT_HANDLE uws_client)
         free(uws_client->stream_buffer);
         free(uws_client->fragment_buffer);
 
+        if (uws_client->utf8_checker != NULL)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_537: [ `uws_client_destroy` shall destroy the UTF-8 checker used for fragmented text messages by calling `utf8_checker_destroy`. ]*/
+            utf8_checker_destroy(uws_client->utf8_checker);
+        }
+
         /* Codes_SRS_UWS_CLIENT_01_021: [ `uws_client_destroy` shall perform a close action if the uws instance has already been open. ]*/
         switch (uws_client->uws_state)
         {
@@ -1019,6 +1031,54 @@ static int process_frame_fragment(UWS_CLIENT_INSTANCE *uws_client, size_t length
     return result;
 }
 
+static int validate_text_fragment(UWS_CLIENT_INSTANCE *uws_client, bool is_first, const unsigned char* payload, size_t length)
+{
+    int result;
+
+    if (is_first)
+    {
+        if (uws_client->utf8_checker == NULL)
+        {
+            /* Codes_SRS_UWS_CLIENT_01_534: [ The UTF-8 checker used for fragmented text messages shall be created by calling `utf8_checker_create` when the first fragmented text message is received. ]*/
+            uws_client->utf8_checker = utf8_checker_create();
+        }
+        else
+        {
+            utf8_checker_reset(uws_client->utf8_checker);
+        }
+    }
+
+    if (uws_client->utf8_checker == NULL)
+    {
+        LogError("Cannot create UTF-8 checker");
+        indicate_ws_error(uws_client, WS_ERROR_NOT_ENOUGH_MEMORY);
+        result = __FAILURE__;
+    }
+    /* Codes_SRS_UWS_CLIENT_01_535: [ Each fragment of a fragmented text message shall be validated as it is received by calling `utf8_checker_process`, so that a code point may span fragments. ]*/
+    else if (!utf8_checker_process(uws_client->utf8_checker, payload, length))
+    {
+        /* Codes_SRS_UWS_CLIENT_01_533: [ If the payload of a text message is not valid UTF-8, uws shall report the error by calling `on_ws_error` with `WS_ERROR_BAD_FRAME_RECEIVED` and drop the message. ]*/
+        /* Codes_SRS_UWS_CLIENT_01_538: [ If a fragment of a text message is not valid UTF-8, uws shall send a CLOSE frame with the status code 1007 (invalid frame payload data). ]*/
+        LogError("Text message fragment is not valid UTF-8");
+        indicate_ws_error_and_close(uws_client, WS_ERROR_BAD_FRAME_RECEIVED, 1007);
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    if (result != 0)
+    {
+        /* Codes_SRS_UWS_CLIENT_01_539: [ After a fragment of a text message fails validation, the remaining fragments of that message up to and including the final one shall be dropped without indicating further errors. ]*/
+        uws_client->fragment_buffer_count = 0;
+        uws_client->fragmented_frame_type = WS_FRAME_TYPE_UNKNOWN;
+        uws_client->discard_fragments = true;
+    }
+
+    return result;
+}
+
 static void on_underlying_io_bytes_received(void* context, const unsigned char* buffer, size_t size)
 {
     WS_OPEN_RESULT_DETAILED ws_open_result_detailed = { WS_OPEN_OK, 0 };
@@ -1299,6 +1359,25 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 /* Codes_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
                                 /* Codes_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
                                 /* Codes_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
+                                /* Codes_SRS_UWS_CLIENT_01_539: [ After a fragment of a text message fails validation, the remaining fragments of that message up to and including the final one shall be dropped without indicating further errors. ]*/
+                                if (uws_client->discard_fragments)
+                                {
+                                    if (is_final)
+                                    {
+                                        uws_client->discard_fragments = false;
+                                    }
+
+                                    decode_stream = 1;
+                                    break;
+                                }
+
+                                if ((uws_client->fragmented_frame_type == WS_FRAME_TYPE_TEXT) &&
+                                    (validate_text_fragment(uws_client, false, uws_client->stream_buffer + needed_bytes - length, length) != 0))
+                                {
+                                    decode_stream = 1;
+                                    break;
+                                }
+
                                 if (process_frame_fragment(uws_client, length, needed_bytes) != 0)
                                 {
                                     break;
@@ -1314,6 +1393,18 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                         decode_stream = 1;
                                         break;
                                     }
+
+                                    /* Codes_SRS_UWS_CLIENT_01_536: [ When the final fragment of a text message is received, uws shall call `utf8_checker_is_complete` and treat an incomplete code point at the end of the message as invalid UTF-8. ]*/
+                                    if ((uws_client->fragmented_frame_type == WS_FRAME_TYPE_TEXT) &&
+                                        !utf8_checker_is_complete(uws_client->utf8_checker))
+                                    {
+                                        LogError("Text message ends with an incomplete UTF-8 sequence");
+                                        indicate_ws_error(uws_client, WS_ERROR_BAD_FRAME_RECEIVED);
+                                        uws_client->fragment_buffer_count = 0;
+                                        uws_client->fragmented_frame_type = WS_FRAME_TYPE_UNKNOWN;
+                                        decode_stream = 1;
+                                        break;
+                                    }
                                     uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, uws_client->fragmented_frame_type, uws_client->fragment_buffer, uws_client->fragment_buffer_count);
                                     uws_client->fragment_buffer_count = 0;
                                     uws_client->fragmented_frame_type = WS_FRAME_TYPE_UNKNOWN;
@@ -1333,6 +1424,16 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 /* Codes_SRS_UWS_CLIENT_01_282: [ If the frame comprises an unfragmented message (Section 5.4), it is said that _A WebSocket Message Has Been Received_ with type /type/ and data /data/. ]*/
                                 if (is_final)
                                 {
+                                    /* Codes_SRS_UWS_CLIENT_01_532: [ The payload of a text frame shall be validated as UTF-8 by calling `utf8_checker_is_valid_utf8` before it is indicated via `on_ws_frame_received`. ]*/
+                                    if (!utf8_checker_is_valid_utf8(uws_client->stream_buffer + needed_bytes - length, length))
+                                    {
+                                        /* Codes_SRS_UWS_CLIENT_01_533: [ If the payload of a text message is not valid UTF-8, uws shall report the error by calling `on_ws_error` with `WS_ERROR_BAD_FRAME_RECEIVED` and drop the message. ]*/
+                                        LogError("Text frame payload is not valid UTF-8");
+                                        indicate_ws_error(uws_client, WS_ERROR_BAD_FRAME_RECEIVED);
+                                        decode_stream = 1;
+                                        break;
+                                    }
+
                                     uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, WS_FRAME_TYPE_TEXT, uws_client->stream_buffer + needed_bytes - length, length);
                                 }
                                 else
@@ -1348,6 +1449,12 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                     /* Codes_SRS_UWS_CLIENT_01_213: [ A fragmented message consists of a single frame with the FIN bit clear and an opcode other than 0, followed by zero or more frames with the FIN bit clear and the opcode set to 0, and terminated by a single frame with the FIN bit set and an opcode of 0. ]*/
                                     /* Codes_SRS_UWS_CLIENT_01_216: [ Message fragments MUST be delivered to the recipient in the order sent by the sender. ]*/
                                     /* Codes_SRS_UWS_CLIENT_01_219: [ A sender MAY create fragments of any size for non-control messages. ]*/
+                                    if (validate_text_fragment(uws_client, true, uws_client->stream_buffer + needed_bytes - length, length) != 0)
+                                    {
+                                        decode_stream = 1;
+                                        break;
+                                    }
+
                                     if (process_frame_fragment(uws_client, length, needed_bytes) != 0)
                                     {
                                         break;
@@ -1674,6 +1781,7 @@ int uws_client_open_async(UWS_CLIENT_HANDLE uws_client, ON_WS_OPEN_COMPLETE on_w
             uws_client->stream_buffer_count = 0;
             uws_client->fragment_buffer_count = 0;
             uws_client->fragmented_frame_type = WS_FRAME_TYPE_UNKNOWN;
+            uws_client->discard_fragments = false;
 
             uws_client->on_ws_open_complete = on_ws_open_complete;
             uws_client->on_ws_open_complete_context = on_ws_open_complete_context;
@@ -522,4 +522,203 @@ BEGIN_TEST_SUITE(base32_ut)
         STRING_delete(input);
     }
 
+    /* Tests_SRS_BASE32_07_028: [ If source contains a character that is not part of the base32 alphabet, base32_decode_impl shall fail. ] */
+    TEST_FUNCTION(Base32_Decode_String_invalid_char_fail)
+    {
+        //arrange
+        BUFFER_HANDLE result;
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+        //act
+        result = Base32_Decode_String("aebagb!f");
+
+        //assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        //cleanup
+    }
+
+    /* Tests_SRS_BASE32_07_024: [ base32_decode_impl shall loop through and collect 8 characters from the source variable. ] */
+    TEST_FUNCTION(Base32_Decode_String_upper_case_success)
+    {
+        //arrange
+        BUFFER_HANDLE result;
+
+        //act
+        result = Base32_Decode_String("AEBAGBAF");
+
+        //assert
+        ASSERT_IS_NOT_NULL(result);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(test_val_len[21].input_data, result, test_val_len[21].input_len));
+
+        //cleanup
+        BUFFER_delete(result);
+    }
+
+    /* Tests_SRS_BASE32_07_029: [ If source is NULL and size is not 0, or destination is NULL, Base32_Encode_Bytes_Into shall return a non-zero value. ] */
+    TEST_FUNCTION(Base32_Encode_Bytes_Into_source_NULL_fail)
+    {
+        //arrange
+        char destination[32];
+        int result;
+
+        //act
+        result = Base32_Encode_Bytes_Into(NULL, 10, destination, sizeof(destination));
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_BASE32_07_029: [ If source is NULL and size is not 0, or destination is NULL, Base32_Encode_Bytes_Into shall return a non-zero value. ] */
+    TEST_FUNCTION(Base32_Encode_Bytes_Into_destination_NULL_fail)
+    {
+        //arrange
+        int result;
+
+        //act
+        result = Base32_Encode_Bytes_Into(test_val_len[0].input_data, test_val_len[0].input_len, NULL, 32);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_BASE32_07_030: [ If destination_size is less than the encoded length plus the null terminator, Base32_Encode_Bytes_Into shall return a non-zero value. ] */
+    TEST_FUNCTION(Base32_Encode_Bytes_Into_destination_too_small_fail)
+    {
+        //arrange
+        char destination[8];
+        int result;
+
+        //act
+        result = Base32_Encode_Bytes_Into(test_val_len[21].input_data, test_val_len[21].input_len, destination, sizeof(destination));
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_BASE32_07_031: [ Base32_Encode_Bytes_Into shall write the null terminated base32 value of source into destination without allocating memory and return 0. ] */
+    TEST_FUNCTION(Base32_Encode_Bytes_Into_success)
+    {
+        size_t index;
+        size_t num_elements = sizeof(test_val_len) / sizeof(test_val_len[0]);
+
+        //arrange
+
+        //act
+        for (index = 0; index < num_elements; index++)
+        {
+            char destination[64];
+            char tmp_msg[64];
+            int result;
+            sprintf(tmp_msg, "Base32_Encode_Bytes_Into failure in test %zu", index);
+
+            result = Base32_Encode_Bytes_Into(test_val_len[index].input_data, test_val_len[index].input_len, destination, sizeof(destination));
+
+            //assert
+            ASSERT_ARE_EQUAL_WITH_MSG(int, 0, result, tmp_msg);
+            ASSERT_ARE_EQUAL_WITH_MSG(char_ptr, test_val_len[index].base32_data, destination, tmp_msg);
+        }
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_BASE32_07_032: [ If source, destination or decoded_size is NULL, Base32_Decode_String_Into shall return a non-zero value. ] */
+    TEST_FUNCTION(Base32_Decode_String_Into_NULL_params_fail)
+    {
+        //arrange
+        unsigned char destination[32];
+        size_t decoded_size;
+
+        //act
+        int result1 = Base32_Decode_String_Into(NULL, destination, sizeof(destination), &decoded_size);
+        int result2 = Base32_Decode_String_Into(test_val_len[0].base32_data, NULL, sizeof(destination), &decoded_size);
+        int result3 = Base32_Decode_String_Into(test_val_len[0].base32_data, destination, sizeof(destination), NULL);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+        ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+        ASSERT_ARE_NOT_EQUAL(int, 0, result3);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_BASE32_07_033: [ If the source length is not evenly divisible by 8, Base32_Decode_String_Into shall return a non-zero value. ] */
+    TEST_FUNCTION(Base32_Decode_String_Into_invalid_length_fail)
+    {
+        //arrange
+        unsigned char destination[32];
+        size_t decoded_size;
+        int result;
+
+        //act
+        result = Base32_Decode_String_Into("invalid_string", destination, sizeof(destination), &decoded_size);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_BASE32_07_034: [ If destination_size is less than 5 bytes for every 8 characters of source, Base32_Decode_String_Into shall return a non-zero value. ] */
+    TEST_FUNCTION(Base32_Decode_String_Into_destination_too_small_fail)
+    {
+        //arrange
+        unsigned char destination[4];
+        size_t decoded_size;
+        int result;
+
+        //act
+        result = Base32_Decode_String_Into(test_val_len[0].base32_data, destination, sizeof(destination), &decoded_size);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_BASE32_07_035: [ If source contains a character that is not part of the base32 alphabet, Base32_Decode_String_Into shall return a non-zero value. ] */
+    TEST_FUNCTION(Base32_Decode_String_Into_invalid_char_fail)
+    {
+        //arrange
+        unsigned char destination[32];
+        size_t decoded_size;
+        int result;
+
+        //act
+        result = Base32_Decode_String_Into("aebag\x80""af", destination, sizeof(destination), &decoded_size);
+
+        //assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_BASE32_07_036: [ On success Base32_Decode_String_Into shall write the decoded bytes into destination, set decoded_size to their count and return 0. ] */
+    TEST_FUNCTION(Base32_Decode_String_Into_success)
+    {
+        size_t index;
+        size_t num_elements = sizeof(test_val_len) / sizeof(test_val_len[0]);
+
+        //arrange
+
+        //act
+        for (index = 0; index < num_elements; index++)
+        {
+            unsigned char destination[64];
+            size_t decoded_size;
+            char tmp_msg[64];
+            int result;
+            sprintf(tmp_msg, "Base32_Decode_String_Into failure in test %zu", index);
+
+            result = Base32_Decode_String_Into(test_val_len[index].base32_data, destination, sizeof(destination), &decoded_size);
+
+            //assert
+            ASSERT_ARE_EQUAL_WITH_MSG(int, 0, result, tmp_msg);
+            ASSERT_ARE_EQUAL_WITH_MSG(size_t, test_val_len[index].input_len, decoded_size, tmp_msg);
+            ASSERT_ARE_EQUAL_WITH_MSG(int, 0, memcmp(test_val_len[index].input_data, destination, decoded_size), tmp_msg);
+        }
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
 END_TEST_SUITE(base32_ut)
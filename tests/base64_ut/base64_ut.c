@@ -1674,6 +1674,55 @@ TEST_FUNCTION(Base64_Encode_Bytes_exhaustive_succeeds)
     }
 }
 
+/*Tests_SRS_BASE64_01_001: [If source is NULL and size is not 0, or destination is NULL, Base64_Encode_Bytes_Into shall return a non-zero value.]*/
+TEST_FUNCTION(Base64_Encode_Bytes_Into_with_NULL_arguments_fails)
+{
+    ///arrange
+    char destination[16];
+
+    ///act
+    int result1 = Base64_Encode_Bytes_Into(NULL, 3, destination, sizeof(destination));
+    int result2 = Base64_Encode_Bytes_Into((const unsigned char*)"abc", 3, NULL, sizeof(destination));
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+}
+
+/*Tests_SRS_BASE64_01_002: [If destination_size is less than the encoded length plus the null terminator, Base64_Encode_Bytes_Into shall return a non-zero value.]*/
+TEST_FUNCTION(Base64_Encode_Bytes_Into_with_too_small_destination_fails)
+{
+    ///arrange
+    char destination[8];
+
+    ///act
+    int result = Base64_Encode_Bytes_Into((const unsigned char*)"abcd", 4, destination, sizeof(destination));
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/*Tests_SRS_BASE64_01_003: [Base64_Encode_Bytes_Into shall write the null terminated base64 encoding of source into destination without allocating memory and return 0.]*/
+TEST_FUNCTION(Base64_Encode_Bytes_Into_exhaustive_succeeds)
+{
+    ///arrange
+    size_t i;
+
+    for (i = 0; i < sizeof(testVector_BINARY_with_equal_signs) / sizeof(testVector_BINARY_with_equal_signs[0]); i++)
+    {
+        ///arrange
+        char destination[32];
+        int result;
+
+        ///act
+        result = Base64_Encode_Bytes_Into(testVector_BINARY_with_equal_signs[i].inputData, testVector_BINARY_with_equal_signs[i].inputLength, destination, strlen(testVector_BINARY_with_equal_signs[i].expectedOutput) + 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, testVector_BINARY_with_equal_signs[i].expectedOutput, destination);
+    }
+}
+
 TEST_FUNCTION(Base64_Decoder_exhaustive_succeeds)
 {
     size_t i;
@@ -3,8 +3,12 @@
 
 #ifdef __cplusplus
 #include <cstdlib>
+#include <cstdio>
+#include <cstring>
 #else
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #endif 
 
 static void* my_gballoc_malloc(size_t size)
@@ -1025,5 +1029,252 @@ TEST_FUNCTION(connectionstringparser_splitHostName_with_NULL_hostName_failed)
     STRING_delete(suffixString);
 }
 
+/* connectionstringparser_scan */
+
+typedef struct SCANNED_PAIRS_TAG
+{
+    size_t count;
+    char keys[4][32];
+    char values[4][32];
+    int stop_at;
+} SCANNED_PAIRS;
+
+static int test_on_pair(void* context, const char* key, size_t key_length, const char* value, size_t value_length)
+{
+    SCANNED_PAIRS* pairs = (SCANNED_PAIRS*)context;
+    int result;
+
+    if ((int)pairs->count == pairs->stop_at)
+    {
+        result = 1;
+    }
+    else
+    {
+        (void)sprintf(pairs->keys[pairs->count], "%.*s", (int)key_length, key);
+        (void)sprintf(pairs->values[pairs->count], "%.*s", (int)value_length, value);
+        pairs->count++;
+        result = 0;
+    }
+
+    return result;
+}
+
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_020: [If connection_string or on_pair is NULL, connectionstringparser_scan shall fail and return a non-zero value.] */
+TEST_FUNCTION(connectionstringparser_scan_with_NULL_connection_string_fails)
+{
+    // arrange
+    int result;
+    SCANNED_PAIRS pairs = { 0 };
+    pairs.stop_at = -1;
+
+    // act
+    result = connectionstringparser_scan(NULL, test_on_pair, &pairs);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_020: [If connection_string or on_pair is NULL, connectionstringparser_scan shall fail and return a non-zero value.] */
+TEST_FUNCTION(connectionstringparser_scan_with_NULL_on_pair_fails)
+{
+    // arrange
+    int result;
+
+    // act
+    result = connectionstringparser_scan("a=b", NULL, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_021: [connectionstringparser_scan shall walk the connection string once, without allocating memory or copying, and call on_pair with the key and value of each `key=value` pair, in order.] */
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_022: [Empty `;` separated segments shall be skipped.] */
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_023: [The key shall end at the first `=` of the pair; the value shall run from there to the next `;` or the end of the string and may contain `=`.] */
+TEST_FUNCTION(connectionstringparser_scan_reports_each_pair_in_order)
+{
+    // arrange
+    int result;
+    SCANNED_PAIRS pairs = { 0 };
+    pairs.stop_at = -1;
+
+    // act
+    result = connectionstringparser_scan(";a=b;;key2=val==;", test_on_pair, &pairs);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 2, pairs.count);
+    ASSERT_ARE_EQUAL(char_ptr, "a", pairs.keys[0]);
+    ASSERT_ARE_EQUAL(char_ptr, "b", pairs.values[0]);
+    ASSERT_ARE_EQUAL(char_ptr, "key2", pairs.keys[1]);
+    ASSERT_ARE_EQUAL(char_ptr, "val==", pairs.values[1]);
+}
+
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_021: [connectionstringparser_scan shall walk the connection string once, without allocating memory or copying, and call on_pair with the key and value of each `key=value` pair, in order.] */
+TEST_FUNCTION(connectionstringparser_scan_with_an_empty_string_reports_no_pairs)
+{
+    // arrange
+    int result;
+    SCANNED_PAIRS pairs = { 0 };
+    pairs.stop_at = -1;
+
+    // act
+    result = connectionstringparser_scan("", test_on_pair, &pairs);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 0, pairs.count);
+}
+
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_024: [If a pair has no `=` or an empty key, connectionstringparser_scan shall fail and return a non-zero value.] */
+TEST_FUNCTION(connectionstringparser_scan_with_a_pair_without_equal_sign_fails)
+{
+    // arrange
+    int result;
+    SCANNED_PAIRS pairs = { 0 };
+    pairs.stop_at = -1;
+
+    // act
+    result = connectionstringparser_scan("a=b;novalue;c=d", test_on_pair, &pairs);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, pairs.count);
+}
+
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_024: [If a pair has no `=` or an empty key, connectionstringparser_scan shall fail and return a non-zero value.] */
+TEST_FUNCTION(connectionstringparser_scan_with_an_empty_key_fails)
+{
+    // arrange
+    int result;
+    SCANNED_PAIRS pairs = { 0 };
+    pairs.stop_at = -1;
+
+    // act
+    result = connectionstringparser_scan("=b", test_on_pair, &pairs);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 0, pairs.count);
+}
+
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_025: [If a value is empty, connectionstringparser_scan shall fail and return a non-zero value.] */
+TEST_FUNCTION(connectionstringparser_scan_with_an_empty_value_fails)
+{
+    // arrange
+    int result;
+    SCANNED_PAIRS pairs = { 0 };
+    pairs.stop_at = -1;
+
+    // act
+    result = connectionstringparser_scan("a=;c=d", test_on_pair, &pairs);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 0, pairs.count);
+}
+
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_026: [If on_pair returns a non-zero value, connectionstringparser_scan shall stop and return a non-zero value.] */
+TEST_FUNCTION(when_on_pair_fails_connectionstringparser_scan_stops_and_fails)
+{
+    // arrange
+    int result;
+    SCANNED_PAIRS pairs = { 0 };
+    pairs.stop_at = 1;
+
+    // act
+    result = connectionstringparser_scan("a=b;c=d;e=f", test_on_pair, &pairs);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, pairs.count);
+}
+
+/* connectionstringparser_parse_fields */
+
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_027: [If connection_string or fields is NULL, connectionstringparser_parse_fields shall fail and return a non-zero value.] */
+TEST_FUNCTION(connectionstringparser_parse_fields_with_NULL_connection_string_fails)
+{
+    // arrange
+    int result;
+    CONNECTION_STRING_FIELDS fields;
+
+    // act
+    result = connectionstringparser_parse_fields(NULL, &fields);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_027: [If connection_string or fields is NULL, connectionstringparser_parse_fields shall fail and return a non-zero value.] */
+TEST_FUNCTION(connectionstringparser_parse_fields_with_NULL_fields_fails)
+{
+    // arrange
+    int result;
+
+    // act
+    result = connectionstringparser_parse_fields("HostName=h", NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_028: [connectionstringparser_parse_fields shall clear fields and scan the connection string with connectionstringparser_scan, pointing each well-known field (HostName, DeviceId, SharedAccessKey, SharedAccessKeyName, SharedAccessSignature) at its value inside connection_string.] */
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_029: [Keys other than the well-known ones shall be ignored.] */
+TEST_FUNCTION(connectionstringparser_parse_fields_points_the_well_known_fields_into_the_connection_string)
+{
+    // arrange
+    int result;
+    CONNECTION_STRING_FIELDS fields;
+    const char* connection_string = "HostName=hub.azure-devices.net;DeviceId=dev1;GatewayHostName=gw;SharedAccessKey=abc=";
+
+    // act
+    result = connectionstringparser_parse_fields(connection_string, &fields);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, (void*)(connection_string + 9), (void*)fields.hostName.value);
+    ASSERT_ARE_EQUAL(size_t, strlen("hub.azure-devices.net"), fields.hostName.length);
+    ASSERT_ARE_EQUAL(int, 0, strncmp("dev1", fields.deviceId.value, fields.deviceId.length));
+    ASSERT_ARE_EQUAL(size_t, 4, fields.deviceId.length);
+    ASSERT_ARE_EQUAL(int, 0, strncmp("abc=", fields.sharedAccessKey.value, fields.sharedAccessKey.length));
+    ASSERT_ARE_EQUAL(size_t, 4, fields.sharedAccessKey.length);
+    ASSERT_IS_NULL(fields.sharedAccessKeyName.value);
+    ASSERT_ARE_EQUAL(size_t, 0, fields.sharedAccessKeyName.length);
+    ASSERT_IS_NULL(fields.sharedAccessSignature.value);
+}
+
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_030: [If a well-known key appears more than once, connectionstringparser_parse_fields shall fail and return a non-zero value.] */
+TEST_FUNCTION(connectionstringparser_parse_fields_with_a_duplicate_key_fails)
+{
+    // arrange
+    int result;
+    CONNECTION_STRING_FIELDS fields;
+
+    // act
+    result = connectionstringparser_parse_fields("DeviceId=a;DeviceId=b", &fields);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/* Tests_SRS_CONNECTIONSTRINGPARSER_01_031: [If scanning fails, connectionstringparser_parse_fields shall fail and return a non-zero value.] */
+TEST_FUNCTION(connectionstringparser_parse_fields_with_a_malformed_string_fails)
+{
+    // arrange
+    int result;
+    CONNECTION_STRING_FIELDS fields;
+
+    // act
+    result = connectionstringparser_parse_fields("HostName=h;DeviceId", &fields);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
 
 END_TEST_SUITE(connectionstringparser_ut)
@@ -0,0 +1,630 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+
+void* real_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void* real_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+void real_free(void* ptr)
+{
+    free(ptr);
+}
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#undef ENABLE_MOCKS
+#include "azure_c_shared_utility/hash.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+static BUFFER_HANDLE digest;
+
+/* FIPS 180-2 / RFC 6234 and RFC 4231 vectors */
+static const unsigned char SHA256_abc[32] = { 0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23, 0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad };
+static const unsigned char SHA256_abcdbcde[32] = { 0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39, 0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1 };
+static const unsigned char SHA1_abc[20] = { 0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e, 0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d };
+static const unsigned char HMACSHA256_Jefe[32] = { 0x5b, 0xdc, 0xc1, 0x46, 0xbf, 0x60, 0x75, 0x4e, 0x6a, 0x04, 0x24, 0x26, 0x08, 0x95, 0x75, 0xc7, 0x5a, 0x00, 0x3f, 0x08, 0x9d, 0x27, 0x39, 0x83, 0x9d, 0xec, 0x58, 0xb9, 0x64, 0xec, 0x38, 0x43 };
+
+static const unsigned char SHA384_empty[48] = { 0x38, 0xb0, 0x60, 0xa7, 0x51, 0xac, 0x96, 0x38, 0x4c, 0xd9, 0x32, 0x7e, 0xb1, 0xb1, 0xe3, 0x6a, 0x21, 0xfd, 0xb7, 0x11, 0x14, 0xbe, 0x07, 0x43, 0x4c, 0x0c, 0xc7, 0xbf, 0x63, 0xf6, 0xe1, 0xda, 0x27, 0x4e, 0xde, 0xbf, 0xe7, 0x6f, 0x65, 0xfb, 0xd5, 0x1a, 0xd2, 0xf1, 0x48, 0x98, 0xb9, 0x5b };
+static const unsigned char SHA384_abc[48] = { 0xcb, 0x00, 0x75, 0x3f, 0x45, 0xa3, 0x5e, 0x8b, 0xb5, 0xa0, 0x3d, 0x69, 0x9a, 0xc6, 0x50, 0x07, 0x27, 0x2c, 0x32, 0xab, 0x0e, 0xde, 0xd1, 0x63, 0x1a, 0x8b, 0x60, 0x5a, 0x43, 0xff, 0x5b, 0xed, 0x80, 0x86, 0x07, 0x2b, 0xa1, 0xe7, 0xcc, 0x23, 0x58, 0xba, 0xec, 0xa1, 0x34, 0xc8, 0x25, 0xa7 };
+static const unsigned char SHA384_abcdefgh[48] = { 0x09, 0x33, 0x0c, 0x33, 0xf7, 0x11, 0x47, 0xe8, 0x3d, 0x19, 0x2f, 0xc7, 0x82, 0xcd, 0x1b, 0x47, 0x53, 0x11, 0x1b, 0x17, 0x3b, 0x3b, 0x05, 0xd2, 0x2f, 0xa0, 0x80, 0x86, 0xe3, 0xb0, 0xf7, 0x12, 0xfc, 0xc7, 0xc7, 0x1a, 0x55, 0x7e, 0x2d, 0xb9, 0x66, 0xc3, 0xe9, 0xfa, 0x91, 0x74, 0x60, 0x39 };
+static const unsigned char SHA384_million_a[48] = { 0x9d, 0x0e, 0x18, 0x09, 0x71, 0x64, 0x74, 0xcb, 0x08, 0x6e, 0x83, 0x4e, 0x31, 0x0a, 0x4a, 0x1c, 0xed, 0x14, 0x9e, 0x9c, 0x00, 0xf2, 0x48, 0x52, 0x79, 0x72, 0xce, 0xc5, 0x70, 0x4c, 0x2a, 0x5b, 0x07, 0xb8, 0xb3, 0xdc, 0x38, 0xec, 0xc4, 0xeb, 0xae, 0x97, 0xdd, 0xd8, 0x7f, 0x3d, 0x89, 0x85 };
+static const unsigned char SHA512_empty[64] = { 0xcf, 0x83, 0xe1, 0x35, 0x7e, 0xef, 0xb8, 0xbd, 0xf1, 0x54, 0x28, 0x50, 0xd6, 0x6d, 0x80, 0x07, 0xd6, 0x20, 0xe4, 0x05, 0x0b, 0x57, 0x15, 0xdc, 0x83, 0xf4, 0xa9, 0x21, 0xd3, 0x6c, 0xe9, 0xce, 0x47, 0xd0, 0xd1, 0x3c, 0x5d, 0x85, 0xf2, 0xb0, 0xff, 0x83, 0x18, 0xd2, 0x87, 0x7e, 0xec, 0x2f, 0x63, 0xb9, 0x31, 0xbd, 0x47, 0x41, 0x7a, 0x81, 0xa5, 0x38, 0x32, 0x7a, 0xf9, 0x27, 0xda, 0x3e };
+static const unsigned char SHA512_abc[64] = { 0xdd, 0xaf, 0x35, 0xa1, 0x93, 0x61, 0x7a, 0xba, 0xcc, 0x41, 0x73, 0x49, 0xae, 0x20, 0x41, 0x31, 0x12, 0xe6, 0xfa, 0x4e, 0x89, 0xa9, 0x7e, 0xa2, 0x0a, 0x9e, 0xee, 0xe6, 0x4b, 0x55, 0xd3, 0x9a, 0x21, 0x92, 0x99, 0x2a, 0x27, 0x4f, 0xc1, 0xa8, 0x36, 0xba, 0x3c, 0x23, 0xa3, 0xfe, 0xeb, 0xbd, 0x45, 0x4d, 0x44, 0x23, 0x64, 0x3c, 0xe8, 0x0e, 0x2a, 0x9a, 0xc9, 0x4f, 0xa5, 0x4c, 0xa4, 0x9f };
+static const unsigned char SHA512_abcdefgh[64] = { 0x8e, 0x95, 0x9b, 0x75, 0xda, 0xe3, 0x13, 0xda, 0x8c, 0xf4, 0xf7, 0x28, 0x14, 0xfc, 0x14, 0x3f, 0x8f, 0x77, 0x79, 0xc6, 0xeb, 0x9f, 0x7f, 0xa1, 0x72, 0x99, 0xae, 0xad, 0xb6, 0x88, 0x90, 0x18, 0x50, 0x1d, 0x28, 0x9e, 0x49, 0x00, 0xf7, 0xe4, 0x33, 0x1b, 0x99, 0xde, 0xc4, 0xb5, 0x43, 0x3a, 0xc7, 0xd3, 0x29, 0xee, 0xb6, 0xdd, 0x26, 0x54, 0x5e, 0x96, 0xe5, 0x5b, 0x87, 0x4b, 0xe9, 0x09 };
+static const unsigned char SHA512_million_a[64] = { 0xe7, 0x18, 0x48, 0x3d, 0x0c, 0xe7, 0x69, 0x64, 0x4e, 0x2e, 0x42, 0xc7, 0xbc, 0x15, 0xb4, 0x63, 0x8e, 0x1f, 0x98, 0xb1, 0x3b, 0x20, 0x44, 0x28, 0x56, 0x32, 0xa8, 0x03, 0xaf, 0xa9, 0x73, 0xeb, 0xde, 0x0f, 0xf2, 0x44, 0x87, 0x7e, 0xa6, 0x0a, 0x4c, 0xb0, 0x43, 0x2c, 0xe5, 0x77, 0xc3, 0x1b, 0xeb, 0x00, 0x9c, 0x5c, 0x2c, 0x49, 0xaa, 0x2e, 0x4e, 0xad, 0xb2, 0x17, 0xad, 0x8c, 0xc0, 0x9b };
+
+#define ABCDBCDE "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"
+#define ABCDEFGH "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static void assert_digest(const unsigned char* expected, size_t expectedSize)
+{
+    ASSERT_ARE_EQUAL(size_t, expectedSize, BUFFER_length(digest));
+    ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(digest), expected, expectedSize));
+}
+
+/* hashes repeatCount copies of data and checks the result against expected */
+static void assert_repeated_hash(HASH_ALGORITHM algorithm, const char* data, size_t repeatCount, const unsigned char* expected, size_t expectedSize)
+{
+    HASH_HANDLE handle = HASH_Create(algorithm);
+    size_t i;
+    ASSERT_IS_NOT_NULL(handle);
+
+    for (i = 0; i < repeatCount; i++)
+    {
+        ASSERT_ARE_EQUAL(int, 0, HASH_Update(handle, (const unsigned char*)data, strlen(data)));
+    }
+
+    ASSERT_ARE_EQUAL(int, 0, HASH_Final(handle, digest));
+    assert_digest(expected, expectedSize);
+
+    HASH_Destroy(handle);
+}
+
+BEGIN_TEST_SUITE(hash_unittests)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, real_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, real_free);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, real_realloc);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    digest = BUFFER_new();
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    BUFFER_delete(digest);
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* HASH_Create */
+
+/* Tests_SRS_HASH_01_001: [ If algorithm is not one of the HASH_ALGORITHM values, HASH_Create and HASH_CreateHmac shall fail and return NULL. ]*/
+TEST_FUNCTION(HASH_Create_with_unknown_algorithm_fails)
+{
+    // arrange
+
+    // act
+    HASH_HANDLE result = HASH_Create((HASH_ALGORITHM)42);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HASH_01_002: [ HASH_Create shall allocate a new hash instance and return a non-NULL handle to it. ]*/
+/* Tests_SRS_HASH_01_003: [ HASH_Create shall initialize a SHA context (USHAReset) for the algorithm. ]*/
+TEST_FUNCTION(HASH_Create_succeeds)
+{
+    // arrange
+    HASH_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+
+    // act
+    result = HASH_Create(HASH_ALGORITHM_SHA256);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HASH_Destroy(result);
+}
+
+/* Tests_SRS_HASH_01_004: [ If any error occurs, HASH_Create and HASH_CreateHmac shall fail and return NULL. ]*/
+TEST_FUNCTION(HASH_Create_when_malloc_fails_fails)
+{
+    // arrange
+    HASH_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument(1)
+        .SetReturn(NULL);
+
+    // act
+    result = HASH_Create(HASH_ALGORITHM_SHA256);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* HASH_CreateHmac */
+
+/* Tests_SRS_HASH_01_005: [ If key is NULL, keyLen is 0 or keyLen does not fit in an int, HASH_CreateHmac shall fail and return NULL. ]*/
+TEST_FUNCTION(HASH_CreateHmac_with_NULL_key_fails)
+{
+    // arrange
+
+    // act
+    HASH_HANDLE result = HASH_CreateHmac(HASH_ALGORITHM_SHA256, NULL, 4);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HASH_01_005: [ If key is NULL, keyLen is 0 or keyLen does not fit in an int, HASH_CreateHmac shall fail and return NULL. ]*/
+TEST_FUNCTION(HASH_CreateHmac_with_zero_keyLen_fails)
+{
+    // arrange
+
+    // act
+    HASH_HANDLE result = HASH_CreateHmac(HASH_ALGORITHM_SHA256, (const unsigned char*)"Jefe", 0);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HASH_01_006: [ HASH_CreateHmac shall initialize an HMAC context (hmacReset) for the algorithm and key. ]*/
+TEST_FUNCTION(HASH_CreateHmac_computes_the_HMAC_of_the_streamed_segments)
+{
+    // arrange
+    HASH_HANDLE handle = HASH_CreateHmac(HASH_ALGORITHM_SHA256, (const unsigned char*)"Jefe", 4);
+    int result;
+    ASSERT_ARE_EQUAL(int, 0, HASH_Update(handle, (const unsigned char*)"what do ya ", 11));
+
+    // act
+    result = HASH_Update(handle, (const unsigned char*)"want for nothing?", 17);
+    result |= HASH_Final(handle, digest);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    assert_digest(HMACSHA256_Jefe, sizeof(HMACSHA256_Jefe));
+
+    // cleanup
+    HASH_Destroy(handle);
+}
+
+/* HASH_Clone */
+
+/* Tests_SRS_HASH_01_007: [ If handle is NULL, HASH_Clone shall fail and return NULL. ]*/
+TEST_FUNCTION(HASH_Clone_with_NULL_handle_fails)
+{
+    // arrange
+
+    // act
+    HASH_HANDLE result = HASH_Clone(NULL);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HASH_01_008: [ HASH_Clone shall return a new handle whose state is a copy of the state of handle, so that both can be updated and completed independently. ]*/
+TEST_FUNCTION(HASH_Clone_continues_from_the_shared_prefix)
+{
+    // arrange
+    HASH_HANDLE handle = HASH_Create(HASH_ALGORITHM_SHA256);
+    HASH_HANDLE clone;
+    ASSERT_ARE_EQUAL(int, 0, HASH_Update(handle, (const unsigned char*)"ab", 2));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+
+    // act
+    clone = HASH_Clone(handle);
+
+    // assert
+    ASSERT_IS_NOT_NULL(clone);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, HASH_Update(handle, (const unsigned char*)"c", 1));
+    ASSERT_ARE_EQUAL(int, 0, HASH_Final(handle, digest));
+    assert_digest(SHA256_abc, sizeof(SHA256_abc));
+    ASSERT_ARE_EQUAL(int, 0, HASH_Update(clone, (const unsigned char*)ABCDBCDE + 2, strlen(ABCDBCDE) - 2));
+    ASSERT_ARE_EQUAL(int, 0, HASH_Final(clone, digest));
+    assert_digest(SHA256_abcdbcde, sizeof(SHA256_abcdbcde));
+
+    // cleanup
+    HASH_Destroy(clone);
+    HASH_Destroy(handle);
+}
+
+/* Tests_SRS_HASH_01_009: [ If allocating the copy fails, HASH_Clone shall fail and return NULL. ]*/
+TEST_FUNCTION(HASH_Clone_when_malloc_fails_fails)
+{
+    // arrange
+    HASH_HANDLE handle = HASH_Create(HASH_ALGORITHM_SHA256);
+    HASH_HANDLE clone;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument(1)
+        .SetReturn(NULL);
+
+    // act
+    clone = HASH_Clone(handle);
+
+    // assert
+    ASSERT_IS_NULL(clone);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HASH_Destroy(handle);
+}
+
+/* HASH_Destroy */
+
+/* Tests_SRS_HASH_01_010: [ If handle is NULL, HASH_Destroy shall do nothing. ]*/
+TEST_FUNCTION(HASH_Destroy_with_NULL_handle_does_nothing)
+{
+    // arrange
+
+    // act
+    HASH_Destroy(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HASH_01_011: [ HASH_Destroy shall clear the hash state (which may include key material) and free it. ]*/
+TEST_FUNCTION(HASH_Destroy_frees_the_instance)
+{
+    // arrange
+    HASH_HANDLE handle = HASH_Create(HASH_ALGORITHM_SHA256);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(handle));
+
+    // act
+    HASH_Destroy(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* HASH_Update */
+
+/* Tests_SRS_HASH_01_012: [ If handle is NULL, or data is NULL while size is not 0, HASH_Update shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(HASH_Update_with_NULL_handle_fails)
+{
+    // arrange
+
+    // act
+    int result = HASH_Update(NULL, (const unsigned char*)"abc", 3);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/* Tests_SRS_HASH_01_012: [ If handle is NULL, or data is NULL while size is not 0, HASH_Update shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(HASH_Update_with_NULL_data_and_non_zero_size_fails)
+{
+    // arrange
+    HASH_HANDLE handle = HASH_Create(HASH_ALGORITHM_SHA256);
+
+    // act
+    int result = HASH_Update(handle, NULL, 3);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    HASH_Destroy(handle);
+}
+
+/* Tests_SRS_HASH_01_013: [ HASH_Update shall add the size bytes at data to the hash, feeding them in pieces that fit in an int. ]*/
+/* Tests_SRS_HASH_01_015: [ On success HASH_Update shall return 0. ]*/
+TEST_FUNCTION(HASH_Update_with_segments_of_any_size_succeeds)
+{
+    // arrange
+    HASH_HANDLE handle = HASH_Create(HASH_ALGORITHM_SHA256);
+    int result;
+
+    // act
+    result = HASH_Update(handle, (const unsigned char*)ABCDBCDE, 5);
+    result |= HASH_Update(handle, NULL, 0);
+    result |= HASH_Update(handle, (const unsigned char*)ABCDBCDE + 5, strlen(ABCDBCDE) - 5);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, HASH_Final(handle, digest));
+    assert_digest(SHA256_abcdbcde, sizeof(SHA256_abcdbcde));
+
+    // cleanup
+    HASH_Destroy(handle);
+}
+
+/* Tests_SRS_HASH_01_014: [ If hashing fails (for example after HASH_Final), HASH_Update shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(HASH_Update_after_HASH_Final_fails)
+{
+    // arrange
+    HASH_HANDLE handle = HASH_Create(HASH_ALGORITHM_SHA256);
+    int result;
+    ASSERT_ARE_EQUAL(int, 0, HASH_Final(handle, digest));
+
+    // act
+    result = HASH_Update(handle, (const unsigned char*)"abc", 3);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    HASH_Destroy(handle);
+}
+
+/* HASH_UpdateWithBuffer */
+
+/* Tests_SRS_HASH_01_016: [ If handle or buffer is NULL, HASH_UpdateWithBuffer shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(HASH_UpdateWithBuffer_with_NULL_buffer_fails)
+{
+    // arrange
+    HASH_HANDLE handle = HASH_Create(HASH_ALGORITHM_SHA256);
+
+    // act
+    int result = HASH_UpdateWithBuffer(handle, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    HASH_Destroy(handle);
+}
+
+/* Tests_SRS_HASH_01_017: [ HASH_UpdateWithBuffer shall hash the content of buffer as HASH_Update does, without copying it. ]*/
+TEST_FUNCTION(HASH_UpdateWithBuffer_hashes_the_buffer_content)
+{
+    // arrange
+    HASH_HANDLE handle = HASH_Create(HASH_ALGORITHM_SHA1);
+    BUFFER_HANDLE buffer = BUFFER_create((const unsigned char*)"abc", 3);
+    int result;
+    umock_c_reset_all_calls();
+
+    // act
+    result = HASH_UpdateWithBuffer(handle, buffer);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, HASH_Final(handle, digest));
+    assert_digest(SHA1_abc, sizeof(SHA1_abc));
+
+    // cleanup
+    BUFFER_delete(buffer);
+    HASH_Destroy(handle);
+}
+
+/* HASH_UpdateWithConstBuffer */
+
+/* Tests_SRS_HASH_01_018: [ If handle or constBuffer is NULL, HASH_UpdateWithConstBuffer shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(HASH_UpdateWithConstBuffer_with_NULL_const_buffer_fails)
+{
+    // arrange
+    HASH_HANDLE handle = HASH_Create(HASH_ALGORITHM_SHA256);
+
+    // act
+    int result = HASH_UpdateWithConstBuffer(handle, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    HASH_Destroy(handle);
+}
+
+/* Tests_SRS_HASH_01_019: [ HASH_UpdateWithConstBuffer shall hash the content of constBuffer as HASH_Update does, without copying it. ]*/
+TEST_FUNCTION(HASH_UpdateWithConstBuffer_hashes_a_chain_of_segments)
+{
+    // arrange
+    HASH_HANDLE handle = HASH_Create(HASH_ALGORITHM_SHA256);
+    CONSTBUFFER_HANDLE segment1 = CONSTBUFFER_Create((const unsigned char*)ABCDBCDE, 20);
+    CONSTBUFFER_HANDLE segment2 = CONSTBUFFER_Create((const unsigned char*)ABCDBCDE + 20, strlen(ABCDBCDE) - 20);
+    int result;
+    umock_c_reset_all_calls();
+
+    // act
+    result = HASH_UpdateWithConstBuffer(handle, segment1);
+    result |= HASH_UpdateWithConstBuffer(handle, segment2);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, HASH_Final(handle, digest));
+    assert_digest(SHA256_abcdbcde, sizeof(SHA256_abcdbcde));
+
+    // cleanup
+    CONSTBUFFER_Destroy(segment1);
+    CONSTBUFFER_Destroy(segment2);
+    HASH_Destroy(handle);
+}
+
+/* HASH_Final */
+
+/* Tests_SRS_HASH_01_021: [ If handle or digest is NULL, HASH_Final shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(HASH_Final_with_NULL_digest_fails)
+{
+    // arrange
+    HASH_HANDLE handle = HASH_Create(HASH_ALGORITHM_SHA256);
+
+    // act
+    int result = HASH_Final(handle, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    HASH_Destroy(handle);
+}
+
+/* Tests_SRS_HASH_01_022: [ HASH_Final shall complete the hash (USHAResult or hmacResult). ]*/
+/* Tests_SRS_HASH_01_023: [ HASH_Final shall replace the content of digest with the digest bytes. ]*/
+/* Tests_SRS_HASH_01_025: [ On success HASH_Final shall return 0. ]*/
+TEST_FUNCTION(HASH_Final_replaces_the_digest_content)
+{
+    // arrange
+    HASH_HANDLE handle = HASH_Create(HASH_ALGORITHM_SHA256);
+    int result;
+    ASSERT_ARE_EQUAL(int, 0, BUFFER_build(digest, (const unsigned char*)"previous content", 16));
+    ASSERT_ARE_EQUAL(int, 0, HASH_Update(handle, (const unsigned char*)"abc", 3));
+
+    // act
+    result = HASH_Final(handle, digest);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    assert_digest(SHA256_abc, sizeof(SHA256_abc));
+
+    // cleanup
+    HASH_Destroy(handle);
+}
+
+/* Tests_SRS_HASH_01_024: [ If any error occurs, HASH_Final shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(HASH_Final_when_growing_the_digest_fails_fails)
+{
+    // arrange
+    HASH_HANDLE handle = HASH_Create(HASH_ALGORITHM_SHA256);
+    int result;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, 32))
+        .IgnoreArgument(1)
+        .SetReturn(NULL);
+
+    // act
+    result = HASH_Final(handle, digest);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HASH_Destroy(handle);
+}
+
+/* HASH_GetDigestSize */
+
+/* Tests_SRS_HASH_01_026: [ If handle is NULL, HASH_GetDigestSize shall return 0. ]*/
+TEST_FUNCTION(HASH_GetDigestSize_with_NULL_handle_returns_0)
+{
+    // arrange
+
+    // act
+    size_t result = HASH_GetDigestSize(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 0, result);
+}
+
+/* Tests_SRS_HASH_01_027: [ Otherwise HASH_GetDigestSize shall return the digest size of the algorithm in bytes. ]*/
+TEST_FUNCTION(HASH_GetDigestSize_returns_the_algorithm_digest_size)
+{
+    // arrange
+    HASH_HANDLE sha1 = HASH_Create(HASH_ALGORITHM_SHA1);
+    HASH_HANDLE sha384 = HASH_Create(HASH_ALGORITHM_SHA384);
+    HASH_HANDLE hmacSha512 = HASH_CreateHmac(HASH_ALGORITHM_SHA512, (const unsigned char*)"Jefe", 4);
+
+    // act
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 20, HASH_GetDigestSize(sha1));
+    ASSERT_ARE_EQUAL(size_t, 48, HASH_GetDigestSize(sha384));
+    ASSERT_ARE_EQUAL(size_t, 64, HASH_GetDigestSize(hmacSha512));
+
+    // cleanup
+    HASH_Destroy(sha1);
+    HASH_Destroy(sha384);
+    HASH_Destroy(hmacSha512);
+}
+/* SHA-384 and SHA-512 known answers (RFC 6234 section 8.5 test 1, 2, 3 and FIPS 180-2 empty message) */
+
+/* Tests_SRS_HASH_01_013: [ HASH_Update shall add the size bytes at data to the hash, feeding them in pieces that fit in an int. ]*/
+/* Tests_SRS_HASH_01_022: [ HASH_Final shall complete the hash (USHAResult or hmacResult). ]*/
+TEST_FUNCTION(HASH_Final_computes_the_SHA384_of_the_RFC_6234_messages)
+{
+    // arrange
+    // act
+    // assert
+    assert_repeated_hash(HASH_ALGORITHM_SHA384, "", 0, SHA384_empty, sizeof(SHA384_empty));
+    assert_repeated_hash(HASH_ALGORITHM_SHA384, "abc", 1, SHA384_abc, sizeof(SHA384_abc));
+    assert_repeated_hash(HASH_ALGORITHM_SHA384, ABCDEFGH, 1, SHA384_abcdefgh, sizeof(SHA384_abcdefgh));
+}
+
+/* Tests_SRS_HASH_01_013: [ HASH_Update shall add the size bytes at data to the hash, feeding them in pieces that fit in an int. ]*/
+/* Tests_SRS_HASH_01_022: [ HASH_Final shall complete the hash (USHAResult or hmacResult). ]*/
+TEST_FUNCTION(HASH_Final_computes_the_SHA384_of_one_million_a)
+{
+    // arrange
+    // act
+    // assert
+    assert_repeated_hash(HASH_ALGORITHM_SHA384, "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", 10000, SHA384_million_a, sizeof(SHA384_million_a));
+}
+
+/* Tests_SRS_HASH_01_013: [ HASH_Update shall add the size bytes at data to the hash, feeding them in pieces that fit in an int. ]*/
+/* Tests_SRS_HASH_01_022: [ HASH_Final shall complete the hash (USHAResult or hmacResult). ]*/
+TEST_FUNCTION(HASH_Final_computes_the_SHA512_of_the_RFC_6234_messages)
+{
+    // arrange
+    // act
+    // assert
+    assert_repeated_hash(HASH_ALGORITHM_SHA512, "", 0, SHA512_empty, sizeof(SHA512_empty));
+    assert_repeated_hash(HASH_ALGORITHM_SHA512, "abc", 1, SHA512_abc, sizeof(SHA512_abc));
+    assert_repeated_hash(HASH_ALGORITHM_SHA512, ABCDEFGH, 1, SHA512_abcdefgh, sizeof(SHA512_abcdefgh));
+}
+
+/* Tests_SRS_HASH_01_013: [ HASH_Update shall add the size bytes at data to the hash, feeding them in pieces that fit in an int. ]*/
+/* Tests_SRS_HASH_01_022: [ HASH_Final shall complete the hash (USHAResult or hmacResult). ]*/
+TEST_FUNCTION(HASH_Final_computes_the_SHA512_of_one_million_a)
+{
+    // arrange
+    // act
+    // assert
+    assert_repeated_hash(HASH_ALGORITHM_SHA512, "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", 10000, SHA512_million_a, sizeof(SHA512_million_a));
+}
+
+END_TEST_SUITE(hash_unittests)
@@ -6,6 +6,7 @@
 #else
 #include <stddef.h>
 #endif
+#include <time.h>
 
 #include "testrunnerswitcher.h"
 #include "umock_c.h"
@@ -30,6 +31,7 @@ void real_free(void* ptr)
 #include "azure_c_shared_utility/strings.h"
 #undef ENABLE_MOCKS
 #include "azure_c_shared_utility/hmacsha256.h"
+#include "azure_c_shared_utility/xlogging.h"
 
 static TEST_MUTEX_HANDLE g_testByTest;
 
@@ -170,4 +172,500 @@ TEST_FUNCTION(HMACSHA256_ComputeHash_Succeeds)
     ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hash), expectedHash, 8));
 }
 
+/* RFC 4231 test case 7: a key and a payload that both span more than one SHA-256 block */
+TEST_FUNCTION(HMACSHA256_ComputeHash_With_Multi_Block_Key_And_Payload_Succeeds)
+{
+    // arrange
+    static const unsigned char buffer[] = "This is a test using a larger than block-size key and a larger than block-size data. The key needs to be hashed before being used by the HMAC algorithm.";
+    unsigned char key[131];
+    unsigned char expectedHash[32] = { 0x9b, 0x09, 0xff, 0xa7, 0x1b, 0x94, 0x2f, 0xcb, 0x27, 0x63, 0x5f, 0xbc, 0xd5, 0xb0, 0xe9, 0x44, 0xbf, 0xdc, 0x63, 0x64, 0x4f, 0x07, 0x13, 0x93, 0x8a, 0x7f, 0x51, 0x53, 0x5c, 0x3a, 0x35, 0xe2 };
+    HMACSHA256_RESULT result;
+    (void)memset(key, 0xaa, sizeof(key));
+
+    // act
+    result = HMACSHA256_ComputeHash(key, sizeof(key), buffer, sizeof(buffer) - 1, hash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, result);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hash), expectedHash, sizeof(expectedHash)));
+}
+
+/* HMACSHA256_CreateKey */
+
+TEST_FUNCTION(HMACSHA256_CreateKey_With_NULL_Key_Fails)
+{
+    // arrange
+    static const unsigned char key[] = "key";
+
+    // act
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(NULL, sizeof(key) - 1);
+
+    // assert
+    ASSERT_IS_NULL(keyHandle);
+}
+
+TEST_FUNCTION(HMACSHA256_CreateKey_With_Zero_Key_Buffer_Size_Fails)
+{
+    // arrange
+    static const unsigned char key[] = "key";
+
+    // act
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(key, 0);
+
+    // assert
+    ASSERT_IS_NULL(keyHandle);
+}
+
+TEST_FUNCTION(HMACSHA256_CreateKey_When_malloc_Fails_Fails)
+{
+    // arrange
+    static const unsigned char key[] = "key";
+    HMACSHA256_KEY_HANDLE keyHandle;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument(1)
+        .SetReturn(NULL);
+
+    // act
+    keyHandle = HMACSHA256_CreateKey(key, sizeof(key) - 1);
+
+    // assert
+    ASSERT_IS_NULL(keyHandle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* HMACSHA256_ComputeHashWithKey */
+
+TEST_FUNCTION(HMACSHA256_ComputeHashWithKey_With_NULL_Key_Handle_Fails)
+{
+    // arrange
+    static const unsigned char buffer[] = "testPayload";
+
+    // act
+    HMACSHA256_RESULT result = HMACSHA256_ComputeHashWithKey(NULL, buffer, sizeof(buffer) - 1, hash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_INVALID_ARG, result);
+}
+
+TEST_FUNCTION(HMACSHA256_ComputeHashWithKey_With_NULL_Payload_Fails)
+{
+    // arrange
+    static const unsigned char key[] = "key";
+    static const unsigned char buffer[] = "testPayload";
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(key, sizeof(key) - 1);
+
+    // act
+    HMACSHA256_RESULT result = HMACSHA256_ComputeHashWithKey(keyHandle, NULL, sizeof(buffer) - 1, hash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_INVALID_ARG, result);
+
+    // cleanup
+    HMACSHA256_DestroyKey(keyHandle);
+}
+
+TEST_FUNCTION(HMACSHA256_ComputeHashWithKey_With_Zero_Payload_Buffer_Size_Fails)
+{
+    // arrange
+    static const unsigned char key[] = "key";
+    static const unsigned char buffer[] = "testPayload";
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(key, sizeof(key) - 1);
+
+    // act
+    HMACSHA256_RESULT result = HMACSHA256_ComputeHashWithKey(keyHandle, buffer, 0, hash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_INVALID_ARG, result);
+
+    // cleanup
+    HMACSHA256_DestroyKey(keyHandle);
+}
+
+TEST_FUNCTION(HMACSHA256_ComputeHashWithKey_With_NULL_Hash_Fails)
+{
+    // arrange
+    static const unsigned char key[] = "key";
+    static const unsigned char buffer[] = "testPayload";
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(key, sizeof(key) - 1);
+
+    // act
+    HMACSHA256_RESULT result = HMACSHA256_ComputeHashWithKey(keyHandle, buffer, sizeof(buffer) - 1, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_INVALID_ARG, result);
+
+    // cleanup
+    HMACSHA256_DestroyKey(keyHandle);
+}
+
+TEST_FUNCTION(HMACSHA256_ComputeHashWithKey_Succeeds)
+{
+    // arrange
+    static const unsigned char key[] = "key";
+    static const unsigned char buffer[] = "testPayload";
+    unsigned char expectedHash[32] = { 108, 7, 130, 47, 104, 233, 39, 188, 126, 122, 134, 187, 63, 19, 52, 120, 172, 7, 43, 25, 133, 60, 92, 217, 59, 59, 69, 116, 85, 104, 55, 224 };
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(key, sizeof(key) - 1);
+
+    // act
+    HMACSHA256_RESULT result = HMACSHA256_ComputeHashWithKey(keyHandle, buffer, sizeof(buffer) - 1, hash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, result);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hash), expectedHash, sizeof(expectedHash)));
+
+    // cleanup
+    HMACSHA256_DestroyKey(keyHandle);
+}
+
+TEST_FUNCTION(HMACSHA256_ComputeHashWithKey_Reusing_The_Key_Produces_The_Same_Hash_As_ComputeHash)
+{
+    // arrange
+    static const unsigned char key[] = "a key that is longer than the 64 byte SHA-256 block, so that it gets hashed first";
+    static const char* payloads[] = { "a", "testPayload", "a payload that does not fit in a single 64 byte SHA-256 block, so it spans two of them" };
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(key, sizeof(key) - 1);
+    BUFFER_HANDLE expectedHash = BUFFER_new();
+    size_t i;
+
+    for (i = 0; i < sizeof(payloads) / sizeof(payloads[0]); i++)
+    {
+        HMACSHA256_RESULT result;
+        BUFFER_HANDLE actualHash = BUFFER_new();
+        ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, HMACSHA256_ComputeHash(key, sizeof(key) - 1, (const unsigned char*)payloads[i], strlen(payloads[i]), expectedHash));
+
+        // act
+        result = HMACSHA256_ComputeHashWithKey(keyHandle, (const unsigned char*)payloads[i], strlen(payloads[i]), actualHash);
+
+        // assert
+        ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, result);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(expectedHash), BUFFER_u_char(actualHash), 32));
+
+        BUFFER_delete(actualHash);
+        BUFFER_delete(expectedHash);
+        expectedHash = BUFFER_new();
+    }
+
+    // cleanup
+    BUFFER_delete(expectedHash);
+    HMACSHA256_DestroyKey(keyHandle);
+}
+
+/* RFC 4231 test case 7 through a key handle */
+TEST_FUNCTION(HMACSHA256_ComputeHashWithKey_With_Multi_Block_Key_And_Payload_Succeeds)
+{
+    // arrange
+    static const unsigned char buffer[] = "This is a test using a larger than block-size key and a larger than block-size data. The key needs to be hashed before being used by the HMAC algorithm.";
+    unsigned char key[131];
+    unsigned char expectedHash[32] = { 0x9b, 0x09, 0xff, 0xa7, 0x1b, 0x94, 0x2f, 0xcb, 0x27, 0x63, 0x5f, 0xbc, 0xd5, 0xb0, 0xe9, 0x44, 0xbf, 0xdc, 0x63, 0x64, 0x4f, 0x07, 0x13, 0x93, 0x8a, 0x7f, 0x51, 0x53, 0x5c, 0x3a, 0x35, 0xe2 };
+    HMACSHA256_KEY_HANDLE keyHandle;
+    HMACSHA256_RESULT result;
+    (void)memset(key, 0xaa, sizeof(key));
+    keyHandle = HMACSHA256_CreateKey(key, sizeof(key));
+
+    // act
+    result = HMACSHA256_ComputeHashWithKey(keyHandle, buffer, sizeof(buffer) - 1, hash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, result);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hash), expectedHash, sizeof(expectedHash)));
+
+    // cleanup
+    HMACSHA256_DestroyKey(keyHandle);
+}
+
+TEST_FUNCTION(HMACSHA256_ComputeHashWithKey_Called_Twice_With_The_Same_Key_Produces_The_Same_Hash)
+{
+    // arrange
+    static const unsigned char key[] = "key";
+    static const unsigned char buffer[] = "testPayload";
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(key, sizeof(key) - 1);
+    BUFFER_HANDLE secondHash = BUFFER_new();
+    HMACSHA256_RESULT result;
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, HMACSHA256_ComputeHashWithKey(keyHandle, buffer, sizeof(buffer) - 1, hash));
+
+    // act
+    result = HMACSHA256_ComputeHashWithKey(keyHandle, buffer, sizeof(buffer) - 1, secondHash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, result);
+    ASSERT_ARE_EQUAL(size_t, BUFFER_length(hash), BUFFER_length(secondHash));
+    ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hash), BUFFER_u_char(secondHash), 32));
+
+    // cleanup
+    BUFFER_delete(secondHash);
+    HMACSHA256_DestroyKey(keyHandle);
+}
+
+/* HMACSHA256_ComputeHashBatch */
+
+#define TEST_BATCH_MAX_PAYLOADS 9
+#define TEST_BATCH_BENCHMARK_PAYLOADS 1024
+#define TEST_BATCH_BENCHMARK_PAYLOAD_SIZE 100
+#define TEST_BATCH_BENCHMARK_ROUNDS 20
+
+static const unsigned char test_batch_key[] = "key";
+static const unsigned char test_batch_payload[] = "testPayload";
+
+/* fills payloads with prefixes of data whose lengths walk across the one and two block padding boundaries */
+static void setup_batch_payloads(HMACSHA256_PAYLOAD* payloads, size_t payloadCount, const unsigned char* data, size_t firstLen)
+{
+    static const size_t lengths[] = { 1, 55, 56, 63, 64, 65, 119, 120, 128, 200 };
+    size_t i;
+
+    for (i = 0; i < payloadCount; i++)
+    {
+        payloads[i].payload = data;
+        payloads[i].payloadLen = lengths[(firstLen + i) % (sizeof(lengths) / sizeof(lengths[0]))];
+    }
+}
+
+TEST_FUNCTION(HMACSHA256_ComputeHashBatch_With_NULL_Key_Handle_Fails)
+{
+    // arrange
+    HMACSHA256_PAYLOAD payload = { test_batch_payload, sizeof(test_batch_payload) - 1 };
+
+    // act
+    HMACSHA256_RESULT result = HMACSHA256_ComputeHashBatch(NULL, &payload, 1, hash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_INVALID_ARG, result);
+}
+
+TEST_FUNCTION(HMACSHA256_ComputeHashBatch_With_NULL_Payloads_Fails)
+{
+    // arrange
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(test_batch_key, sizeof(test_batch_key) - 1);
+
+    // act
+    HMACSHA256_RESULT result = HMACSHA256_ComputeHashBatch(keyHandle, NULL, 1, hash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_INVALID_ARG, result);
+
+    // cleanup
+    HMACSHA256_DestroyKey(keyHandle);
+}
+
+TEST_FUNCTION(HMACSHA256_ComputeHashBatch_With_Zero_Payload_Count_Fails)
+{
+    // arrange
+    HMACSHA256_PAYLOAD payload = { test_batch_payload, sizeof(test_batch_payload) - 1 };
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(test_batch_key, sizeof(test_batch_key) - 1);
+
+    // act
+    HMACSHA256_RESULT result = HMACSHA256_ComputeHashBatch(keyHandle, &payload, 0, hash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_INVALID_ARG, result);
+
+    // cleanup
+    HMACSHA256_DestroyKey(keyHandle);
+}
+
+TEST_FUNCTION(HMACSHA256_ComputeHashBatch_With_NULL_Hashes_Fails)
+{
+    // arrange
+    HMACSHA256_PAYLOAD payload = { test_batch_payload, sizeof(test_batch_payload) - 1 };
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(test_batch_key, sizeof(test_batch_key) - 1);
+
+    // act
+    HMACSHA256_RESULT result = HMACSHA256_ComputeHashBatch(keyHandle, &payload, 1, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_INVALID_ARG, result);
+
+    // cleanup
+    HMACSHA256_DestroyKey(keyHandle);
+}
+
+TEST_FUNCTION(HMACSHA256_ComputeHashBatch_With_A_NULL_Payload_Entry_Fails_Without_Appending)
+{
+    // arrange
+    HMACSHA256_PAYLOAD payloads[5];
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(test_batch_key, sizeof(test_batch_key) - 1);
+    HMACSHA256_RESULT result;
+    setup_batch_payloads(payloads, 5, test_batch_payload, 0);
+    payloads[4].payload = NULL;
+
+    // act
+    result = HMACSHA256_ComputeHashBatch(keyHandle, payloads, 5, hash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(size_t, 0, BUFFER_length(hash));
+
+    // cleanup
+    HMACSHA256_DestroyKey(keyHandle);
+}
+
+TEST_FUNCTION(HMACSHA256_ComputeHashBatch_With_A_Zero_Length_Payload_Entry_Fails_Without_Appending)
+{
+    // arrange
+    HMACSHA256_PAYLOAD payloads[2];
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(test_batch_key, sizeof(test_batch_key) - 1);
+    HMACSHA256_RESULT result;
+    setup_batch_payloads(payloads, 2, test_batch_payload, 0);
+    payloads[1].payloadLen = 0;
+
+    // act
+    result = HMACSHA256_ComputeHashBatch(keyHandle, payloads, 2, hash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(size_t, 0, BUFFER_length(hash));
+
+    // cleanup
+    HMACSHA256_DestroyKey(keyHandle);
+}
+
+/* counts below SHA256_LANES take the scalar path, the others the lanes, lengths cover one and two padding blocks */
+TEST_FUNCTION(HMACSHA256_ComputeHashBatch_Produces_The_Same_Hashes_As_ComputeHashWithKey)
+{
+    // arrange
+    unsigned char data[200];
+    HMACSHA256_PAYLOAD payloads[TEST_BATCH_MAX_PAYLOADS];
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(test_batch_key, sizeof(test_batch_key) - 1);
+    size_t payloadCount;
+    size_t i;
+    for (i = 0; i < sizeof(data); i++)
+    {
+        data[i] = (unsigned char)(i * 7 + 1);
+    }
+
+    for (payloadCount = 1; payloadCount <= TEST_BATCH_MAX_PAYLOADS; payloadCount++)
+    {
+        HMACSHA256_RESULT result;
+        BUFFER_HANDLE hashes = BUFFER_new();
+        setup_batch_payloads(payloads, payloadCount, data, payloadCount);
+
+        // act
+        result = HMACSHA256_ComputeHashBatch(keyHandle, payloads, payloadCount, hashes);
+
+        // assert
+        ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, result);
+        ASSERT_ARE_EQUAL(size_t, payloadCount * 32, BUFFER_length(hashes));
+        for (i = 0; i < payloadCount; i++)
+        {
+            BUFFER_HANDLE expectedHash = BUFFER_new();
+            ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, HMACSHA256_ComputeHashWithKey(keyHandle, payloads[i].payload, payloads[i].payloadLen, expectedHash));
+            ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(expectedHash), BUFFER_u_char(hashes) + (i * 32), 32));
+            BUFFER_delete(expectedHash);
+        }
+
+        BUFFER_delete(hashes);
+    }
+
+    // cleanup
+    HMACSHA256_DestroyKey(keyHandle);
+}
+
+TEST_FUNCTION(HMACSHA256_ComputeHashBatch_Appends_To_The_Existing_Hashes)
+{
+    // arrange
+    static const unsigned char existing[] = { 1, 2, 3 };
+    unsigned char expectedHash[32] = { 108, 7, 130, 47, 104, 233, 39, 188, 126, 122, 134, 187, 63, 19, 52, 120, 172, 7, 43, 25, 133, 60, 92, 217, 59, 59, 69, 116, 85, 104, 55, 224 };
+    HMACSHA256_PAYLOAD payloads[5];
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(test_batch_key, sizeof(test_batch_key) - 1);
+    HMACSHA256_RESULT result;
+    size_t i;
+    for (i = 0; i < 5; i++)
+    {
+        payloads[i].payload = test_batch_payload;
+        payloads[i].payloadLen = sizeof(test_batch_payload) - 1;
+    }
+    ASSERT_ARE_EQUAL(int, 0, BUFFER_build(hash, existing, sizeof(existing)));
+
+    // act
+    result = HMACSHA256_ComputeHashBatch(keyHandle, payloads, 5, hash);
+
+    // assert
+    ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(existing) + (5 * 32), BUFFER_length(hash));
+    ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hash), existing, sizeof(existing)));
+    for (i = 0; i < 5; i++)
+    {
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(hash) + sizeof(existing) + (i * 32), expectedHash, sizeof(expectedHash)));
+    }
+
+    // cleanup
+    HMACSHA256_DestroyKey(keyHandle);
+}
+
+/* Benchmark: signs SAS token sized payloads one at a time and as a batch and logs both rates. Timings depend on the
+   machine, so only the hashes are asserted. */
+TEST_FUNCTION(HMACSHA256_ComputeHashBatch_Benchmark_Against_ComputeHashWithKey)
+{
+    // arrange
+    unsigned char* data = (unsigned char*)malloc(TEST_BATCH_BENCHMARK_PAYLOADS * TEST_BATCH_BENCHMARK_PAYLOAD_SIZE);
+    HMACSHA256_PAYLOAD* payloads = (HMACSHA256_PAYLOAD*)malloc(TEST_BATCH_BENCHMARK_PAYLOADS * sizeof(HMACSHA256_PAYLOAD));
+    HMACSHA256_KEY_HANDLE keyHandle = HMACSHA256_CreateKey(test_batch_key, sizeof(test_batch_key) - 1);
+    unsigned char* singleHashes = (unsigned char*)malloc(TEST_BATCH_BENCHMARK_PAYLOADS * 32);
+    BUFFER_HANDLE batchHashes = BUFFER_new();
+    clock_t start;
+    double singleSeconds;
+    double batchSeconds;
+    size_t round;
+    size_t i;
+    ASSERT_IS_NOT_NULL(data);
+    ASSERT_IS_NOT_NULL(payloads);
+    ASSERT_IS_NOT_NULL(singleHashes);
+    for (i = 0; i < TEST_BATCH_BENCHMARK_PAYLOADS * TEST_BATCH_BENCHMARK_PAYLOAD_SIZE; i++)
+    {
+        data[i] = (unsigned char)('a' + (i % 26));
+    }
+    for (i = 0; i < TEST_BATCH_BENCHMARK_PAYLOADS; i++)
+    {
+        payloads[i].payload = data + (i * TEST_BATCH_BENCHMARK_PAYLOAD_SIZE);
+        payloads[i].payloadLen = TEST_BATCH_BENCHMARK_PAYLOAD_SIZE - (i % 16);
+    }
+
+    // act
+    start = clock();
+    for (round = 0; round < TEST_BATCH_BENCHMARK_ROUNDS; round++)
+    {
+        for (i = 0; i < TEST_BATCH_BENCHMARK_PAYLOADS; i++)
+        {
+            BUFFER_unbuild(hash);
+            ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, HMACSHA256_ComputeHashWithKey(keyHandle, payloads[i].payload, payloads[i].payloadLen, hash));
+            (void)memcpy(singleHashes + (i * 32), BUFFER_u_char(hash), 32);
+        }
+    }
+    singleSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (round = 0; round < TEST_BATCH_BENCHMARK_ROUNDS; round++)
+    {
+        BUFFER_unbuild(batchHashes);
+        ASSERT_ARE_EQUAL(HMACSHA256_RESULT, HMACSHA256_OK, HMACSHA256_ComputeHashBatch(keyHandle, payloads, TEST_BATCH_BENCHMARK_PAYLOADS, batchHashes));
+    }
+    batchSeconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, TEST_BATCH_BENCHMARK_PAYLOADS * 32, BUFFER_length(batchHashes));
+    ASSERT_ARE_EQUAL(int, 0, memcmp(singleHashes, BUFFER_u_char(batchHashes), TEST_BATCH_BENCHMARK_PAYLOADS * 32));
+    LogInfo("HMACSHA256_ComputeHashWithKey: %.0f signatures/s, HMACSHA256_ComputeHashBatch: %.0f signatures/s",
+        (singleSeconds > 0) ? (TEST_BATCH_BENCHMARK_PAYLOADS * TEST_BATCH_BENCHMARK_ROUNDS) / singleSeconds : 0.0,
+        (batchSeconds > 0) ? (TEST_BATCH_BENCHMARK_PAYLOADS * TEST_BATCH_BENCHMARK_ROUNDS) / batchSeconds : 0.0);
+
+    // cleanup
+    BUFFER_delete(batchHashes);
+    free(singleHashes);
+    HMACSHA256_DestroyKey(keyHandle);
+    free(payloads);
+    free(data);
+}
+
+TEST_FUNCTION(HMACSHA256_DestroyKey_With_NULL_Does_Nothing)
+{
+    // arrange
+    umock_c_reset_all_calls();
+
+    // act
+    HMACSHA256_DestroyKey(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 END_TEST_SUITE(HMACSHA256_UnitTests)
@@ -2241,7 +2241,7 @@ TEST_FUNCTION(on_underlying_io_open_complete_in_CLOSING_indicates_an_error)
 
 /* on_underlying_io_bytes_received */
 
-/* Tests_SRS_HTTP_PROXY_IO_01_065: [ When bytes are received and the response to the CONNECT request was not yet received, the bytes shall be accumulated until a double new-line is detected. ]*/
+/* Tests_SRS_HTTP_PROXY_IO_01_065: [ When bytes are received and the response to the CONNECT request was not yet received, the bytes shall be fed to an HTTP response parser created with `http_response_parser_create` on the first received bytes. ]*/
 TEST_FUNCTION(on_underlying_io_bytes_received_with_1_byte_buffers_the_received_bytes)
 {
     // arrange
@@ -2252,7 +2252,8 @@ TEST_FUNCTION(on_underlying_io_bytes_received_with_1_byte_buffers_the_received_b
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); // response parser
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG)); // partial line
 
     // act
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)connect_response, 1);
@@ -2264,7 +2265,7 @@ TEST_FUNCTION(on_underlying_io_bytes_received_with_1_byte_buffers_the_received_b
     http_proxy_io_get_interface_description()->concrete_io_destroy(http_io);
 }
 
-/* Tests_SRS_HTTP_PROXY_IO_01_065: [ When bytes are received and the response to the CONNECT request was not yet received, the bytes shall be accumulated until a double new-line is detected. ]*/
+/* Tests_SRS_HTTP_PROXY_IO_01_065: [ When bytes are received and the response to the CONNECT request was not yet received, the bytes shall be fed to an HTTP response parser created with `http_response_parser_create` on the first received bytes. ]*/
 TEST_FUNCTION(on_underlying_io_bytes_received_with_2_times_1_byte_buffers_the_received_bytes)
 {
     // arrange
@@ -2276,7 +2277,6 @@ TEST_FUNCTION(on_underlying_io_bytes_received_with_2_times_1_byte_buffers_the_re
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)connect_response, 1);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
     // act
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)connect_response + 1, 1);
@@ -2288,7 +2288,7 @@ TEST_FUNCTION(on_underlying_io_bytes_received_with_2_times_1_byte_buffers_the_re
     http_proxy_io_get_interface_description()->concrete_io_destroy(http_io);
 }
 
-/* Tests_SRS_HTTP_PROXY_IO_01_066: [ When a double new-line is detected the response shall be parsed in order to extract the status code. ]*/
+/* Tests_SRS_HTTP_PROXY_IO_01_066: [ When the parser reports the whole response, the status code shall be checked and the parser shall be destroyed. ]*/
 /* Tests_SRS_HTTP_PROXY_IO_01_069: [ Any successful (2xx) response to a CONNECT request indicates that the proxy has established a connection to the requested host and port, and has switched to tunneling the current connection to that server connection. ]*/
 /* Tests_SRS_HTTP_PROXY_IO_01_070: [ When a success status code is parsed, the `on_open_complete` callback shall be triggered with `IO_OPEN_OK`, passing also the `on_open_complete_context` argument as `context`. ]*/
 /* Tests_SRS_HTTP_PROXY_IO_01_073: [ Once a success status code was parsed, the IO shall be OPEN. ]*/
@@ -2302,7 +2302,9 @@ TEST_FUNCTION(on_underlying_io_bytes_received_with_a_good_reply_indicates_OPEN_O
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); // response parser
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser line buffer
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser
     STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_OK));
 
     // act
@@ -2315,7 +2317,7 @@ TEST_FUNCTION(on_underlying_io_bytes_received_with_a_good_reply_indicates_OPEN_O
     http_proxy_io_get_interface_description()->concrete_io_destroy(http_io);
 }
 
-/* Tests_SRS_HTTP_PROXY_IO_01_066: [ When a double new-line is detected the response shall be parsed in order to extract the status code. ]*/
+/* Tests_SRS_HTTP_PROXY_IO_01_066: [ When the parser reports the whole response, the status code shall be checked and the parser shall be destroyed. ]*/
 TEST_FUNCTION(on_underlying_io_bytes_received_with_a_good_reply_in_2_chunks_indicates_OPEN_OK)
 {
     // arrange
@@ -2327,7 +2329,8 @@ TEST_FUNCTION(on_underlying_io_bytes_received_with_a_good_reply_in_2_chunks_indi
     g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)connect_response, sizeof(connect_response) - 2);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser line buffer
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser
     STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_OK));
 
     // act
@@ -2340,8 +2343,8 @@ TEST_FUNCTION(on_underlying_io_bytes_received_with_a_good_reply_in_2_chunks_indi
     http_proxy_io_get_interface_description()->concrete_io_destroy(http_io);
 }
 
-/* Tests_SRS_HTTP_PROXY_IO_01_067: [ If allocating memory for the buffered bytes fails, the `on_open_complete` callback shall be triggered with `IO_OPEN_ERROR`, passing also the `on_open_complete_context` argument as `context`. ]*/
-TEST_FUNCTION(when_allocating_memory_for_cached_data_in_on_underlying_io_bytes_an_error_is_triggered)
+/* Tests_SRS_HTTP_PROXY_IO_01_067: [ If creating the HTTP response parser fails, the `on_open_complete` callback shall be triggered with `IO_OPEN_ERROR`, passing also the `on_open_complete_context` argument as `context`. ]*/
+TEST_FUNCTION(when_creating_the_response_parser_in_on_underlying_io_bytes_received_fails_an_error_is_triggered)
 {
     // arrange
     CONCRETE_IO_HANDLE http_io;
@@ -2351,7 +2354,7 @@ TEST_FUNCTION(when_allocating_memory_for_cached_data_in_on_underlying_io_bytes_a
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
         .SetReturn(NULL);
     STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, NULL, NULL));
     STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_ERROR));
@@ -2366,7 +2369,7 @@ TEST_FUNCTION(when_allocating_memory_for_cached_data_in_on_underlying_io_bytes_a
     http_proxy_io_get_interface_description()->concrete_io_destroy(http_io);
 }
 
-/* Tests_SRS_HTTP_PROXY_IO_01_066: [ When a double new-line is detected the response shall be parsed in order to extract the status code. ]*/
+/* Tests_SRS_HTTP_PROXY_IO_01_066: [ When the parser reports the whole response, the status code shall be checked and the parser shall be destroyed. ]*/
 /* Tests_SRS_HTTP_PROXY_IO_01_069: [ Any successful (2xx) response to a CONNECT request indicates that the proxy has established a connection to the requested host and port, and has switched to tunneling the current connection to that server connection. ]*/
 /* Tests_SRS_HTTP_PROXY_IO_01_070: [ When a success status code is parsed, the `on_open_complete` callback shall be triggered with `IO_OPEN_OK`, passing also the `on_open_complete_context` argument as `context`. ]*/
 /* Tests_SRS_HTTP_PROXY_IO_01_073: [ Once a success status code was parsed, the IO shall be OPEN. ]*/
@@ -2381,7 +2384,9 @@ TEST_FUNCTION(on_underlying_io_bytes_received_with_a_good_reply_status_code_201_
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); // response parser
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser line buffer
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser
     STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_OK));
 
     // act
@@ -2394,7 +2399,7 @@ TEST_FUNCTION(on_underlying_io_bytes_received_with_a_good_reply_status_code_201_
     http_proxy_io_get_interface_description()->concrete_io_destroy(http_io);
 }
 
-/* Tests_SRS_HTTP_PROXY_IO_01_066: [ When a double new-line is detected the response shall be parsed in order to extract the status code. ]*/
+/* Tests_SRS_HTTP_PROXY_IO_01_066: [ When the parser reports the whole response, the status code shall be checked and the parser shall be destroyed. ]*/
 /* Tests_SRS_HTTP_PROXY_IO_01_069: [ Any successful (2xx) response to a CONNECT request indicates that the proxy has established a connection to the requested host and port, and has switched to tunneling the current connection to that server connection. ]*/
 /* Tests_SRS_HTTP_PROXY_IO_01_070: [ When a success status code is parsed, the `on_open_complete` callback shall be triggered with `IO_OPEN_OK`, passing also the `on_open_complete_context` argument as `context`. ]*/
 /* Tests_SRS_HTTP_PROXY_IO_01_073: [ Once a success status code was parsed, the IO shall be OPEN. ]*/
@@ -2409,7 +2414,9 @@ TEST_FUNCTION(on_underlying_io_bytes_received_with_a_good_reply_status_code_299_
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); // response parser
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser line buffer
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser
     STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_OK));
 
     // act
@@ -2422,7 +2429,7 @@ TEST_FUNCTION(on_underlying_io_bytes_received_with_a_good_reply_status_code_299_
     http_proxy_io_get_interface_description()->concrete_io_destroy(http_io);
 }
 
-/* Tests_SRS_HTTP_PROXY_IO_01_066: [ When a double new-line is detected the response shall be parsed in order to extract the status code. ]*/
+/* Tests_SRS_HTTP_PROXY_IO_01_066: [ When the parser reports the whole response, the status code shall be checked and the parser shall be destroyed. ]*/
 /* Tests_SRS_HTTP_PROXY_IO_01_069: [ Any successful (2xx) response to a CONNECT request indicates that the proxy has established a connection to the requested host and port, and has switched to tunneling the current connection to that server connection. ]*/
 /* Tests_SRS_HTTP_PROXY_IO_01_070: [ When a success status code is parsed, the `on_open_complete` callback shall be triggered with `IO_OPEN_OK`, passing also the `on_open_complete_context` argument as `context`. ]*/
 /* Tests_SRS_HTTP_PROXY_IO_01_073: [ Once a success status code was parsed, the IO shall be OPEN. ]*/
@@ -2438,7 +2445,9 @@ TEST_FUNCTION(on_underlying_io_bytes_received_with_a_good_reply_status_code_200_
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); // response parser
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser line buffer
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser
     STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_OK));
 
     // act
@@ -2463,7 +2472,9 @@ TEST_FUNCTION(on_underlying_io_bytes_received_with_a_199_code_indicates_an_error
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); // response parser
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser line buffer
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser
     STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, NULL, NULL));
     STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_ERROR));
 
@@ -2489,7 +2500,9 @@ TEST_FUNCTION(on_underlying_io_bytes_received_with_a_300_code_indicates_an_error
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); // response parser
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser line buffer
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser
     STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, NULL, NULL));
     STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_ERROR));
 
@@ -2549,7 +2562,9 @@ TEST_FUNCTION(one_extra_byte_gets_indicated_as_received)
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); // response parser
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser line buffer
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser
     STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_OK));
     STRICT_EXPECTED_CALL(test_on_bytes_received((void*)0x4243, IGNORED_PTR_ARG, sizeof(expected_bytes)))
         .ValidateArgumentBuffer(2, expected_bytes, sizeof(expected_bytes));
@@ -2577,7 +2592,9 @@ TEST_FUNCTION(three_extra_byte_get_indicated_as_received)
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); // response parser
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser line buffer
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser
     STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_OK));
     STRICT_EXPECTED_CALL(test_on_bytes_received((void*)0x4243, IGNORED_PTR_ARG, sizeof(expected_bytes)))
         .ValidateArgumentBuffer(2, expected_bytes, sizeof(expected_bytes));
@@ -2653,7 +2670,9 @@ TEST_FUNCTION(a_bad_reply_triggers_an_error_in_open_complete_callback)
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); // response parser
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser line buffer
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser
     STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, NULL, NULL));
     STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_ERROR));
 
@@ -2679,7 +2698,9 @@ TEST_FUNCTION(a_bad_reply_malformed_char_triggers_an_error_in_open_complete_call
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); // response parser
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser line buffer
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser
     STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, NULL, NULL));
     STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_ERROR));
 
@@ -2705,7 +2726,9 @@ TEST_FUNCTION(a_bad_reply_only_one_char_triggers_an_error_in_open_complete_callb
     g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); // response parser
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser line buffer
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); // response parser
     STRICT_EXPECTED_CALL(xio_close(TEST_IO_HANDLE, NULL, NULL));
     STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_ERROR));
 
@@ -0,0 +1,1072 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+
+void* real_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void* real_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+void real_free(void* ptr)
+{
+    free(ptr);
+}
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#undef ENABLE_MOCKS
+#include "azure_c_shared_utility/http_response_parser.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+/* What the callbacks saw, flattened so that a whole response can be checked with one string compare */
+typedef struct RECORDED_RESPONSE_TAG
+{
+    int status_code;
+    char reason_phrase[64];
+    char headers[512];
+    size_t content_length;
+    bool chunked;
+    unsigned char body[512];
+    size_t body_length;
+    size_t header_count;
+    size_t headers_complete_count;
+    size_t chunk_complete_count;
+    bool clear_has_body;
+    int status_result;
+    int header_result;
+    int headers_complete_result;
+    int body_result;
+    int chunk_complete_result;
+} RECORDED_RESPONSE;
+
+static RECORDED_RESPONSE recorded;
+
+static int test_on_status(void* context, int status_code, const char* reason_phrase, size_t reason_phrase_length)
+{
+    RECORDED_RESPONSE* response = (RECORDED_RESPONSE*)context;
+    response->status_code = status_code;
+    (void)memcpy(response->reason_phrase, reason_phrase, reason_phrase_length);
+    response->reason_phrase[reason_phrase_length] = '\0';
+    return response->status_result;
+}
+
+static int test_on_header(void* context, const char* name, size_t name_length, const char* value, size_t value_length)
+{
+    RECORDED_RESPONSE* response = (RECORDED_RESPONSE*)context;
+    size_t used = strlen(response->headers);
+    (void)memcpy(response->headers + used, name, name_length);
+    used += name_length;
+    response->headers[used++] = '=';
+    (void)memcpy(response->headers + used, value, value_length);
+    used += value_length;
+    response->headers[used++] = ';';
+    response->headers[used] = '\0';
+    response->header_count++;
+    return response->header_result;
+}
+
+static int test_on_headers_complete(void* context, size_t content_length, bool chunked, bool* has_body)
+{
+    RECORDED_RESPONSE* response = (RECORDED_RESPONSE*)context;
+    response->content_length = content_length;
+    response->chunked = chunked;
+    response->headers_complete_count++;
+    if (response->clear_has_body)
+    {
+        *has_body = false;
+    }
+    return response->headers_complete_result;
+}
+
+static int test_on_body(void* context, const unsigned char* buffer, size_t size)
+{
+    RECORDED_RESPONSE* response = (RECORDED_RESPONSE*)context;
+    (void)memcpy(response->body + response->body_length, buffer, size);
+    response->body_length += size;
+    return response->body_result;
+}
+
+static int test_on_chunk_complete(void* context)
+{
+    RECORDED_RESPONSE* response = (RECORDED_RESPONSE*)context;
+    response->chunk_complete_count++;
+    return response->chunk_complete_result;
+}
+
+static const HTTP_RESPONSE_PARSER_CALLBACKS test_callbacks =
+{
+    test_on_status,
+    test_on_header,
+    test_on_headers_complete,
+    test_on_body,
+    test_on_chunk_complete
+};
+
+static const char CONTENT_LENGTH_RESPONSE[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Length: 5\r\n"
+    "x-ms-request-id:  abc \r\n"
+    "\r\n"
+    "hello";
+
+static const char CHUNKED_RESPONSE[] =
+    "HTTP/1.1 201 Created\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "\r\n"
+    "3\r\n"
+    "abc\r\n"
+    "a;name=value\r\n"
+    "0123456789\r\n"
+    "0\r\n"
+    "x-trailer: 1\r\n"
+    "\r\n";
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static HTTP_RESPONSE_PARSER_RESULT feed_string(HTTP_RESPONSE_PARSER_HANDLE parser, const char* text, size_t* bytes_consumed)
+{
+    return http_response_parser_feed(parser, (const unsigned char*)text, strlen(text), bytes_consumed);
+}
+
+static void assert_content_length_response_recorded(void)
+{
+    ASSERT_ARE_EQUAL(int, 200, recorded.status_code);
+    ASSERT_ARE_EQUAL(char_ptr, "OK", recorded.reason_phrase);
+    ASSERT_ARE_EQUAL(char_ptr, "Content-Length=5;x-ms-request-id=abc;", recorded.headers);
+    ASSERT_ARE_EQUAL(size_t, 1, recorded.headers_complete_count);
+    ASSERT_ARE_EQUAL(size_t, 5, recorded.content_length);
+    ASSERT_IS_FALSE(recorded.chunked);
+    ASSERT_ARE_EQUAL(size_t, 5, recorded.body_length);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(recorded.body, "hello", 5));
+}
+
+static void assert_chunked_response_recorded(void)
+{
+    ASSERT_ARE_EQUAL(int, 201, recorded.status_code);
+    ASSERT_ARE_EQUAL(char_ptr, "Created", recorded.reason_phrase);
+    ASSERT_ARE_EQUAL(char_ptr, "Transfer-Encoding=chunked;", recorded.headers);
+    ASSERT_IS_TRUE(recorded.chunked);
+    ASSERT_ARE_EQUAL(size_t, 13, recorded.body_length);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(recorded.body, "abc0123456789", 13));
+    ASSERT_ARE_EQUAL(size_t, 2, recorded.chunk_complete_count);
+}
+
+/* Benchmark callbacks: only count what they are given, so that the time measured is the parser's */
+typedef struct BENCHMARK_COUNTS_TAG
+{
+    size_t header_count;
+    size_t body_length;
+} BENCHMARK_COUNTS;
+
+#define BENCHMARK_HEADER_COUNT 12
+#define BENCHMARK_BODY_LENGTH 4096
+#define BENCHMARK_CHUNK_LENGTH 512
+#define BENCHMARK_SEGMENT_SIZE 1460
+#define BENCHMARK_RESPONSES 20000
+
+static int benchmark_on_status(void* context, int status_code, const char* reason_phrase, size_t reason_phrase_length)
+{
+    (void)context;
+    (void)status_code;
+    (void)reason_phrase;
+    (void)reason_phrase_length;
+    return 0;
+}
+
+static int benchmark_on_header(void* context, const char* name, size_t name_length, const char* value, size_t value_length)
+{
+    (void)name;
+    (void)name_length;
+    (void)value;
+    (void)value_length;
+    ((BENCHMARK_COUNTS*)context)->header_count++;
+    return 0;
+}
+
+static int benchmark_on_headers_complete(void* context, size_t content_length, bool chunked, bool* has_body)
+{
+    (void)context;
+    (void)content_length;
+    (void)chunked;
+    (void)has_body;
+    return 0;
+}
+
+static int benchmark_on_body(void* context, const unsigned char* buffer, size_t size)
+{
+    (void)buffer;
+    ((BENCHMARK_COUNTS*)context)->body_length += size;
+    return 0;
+}
+
+static int benchmark_on_chunk_complete(void* context)
+{
+    (void)context;
+    return 0;
+}
+
+static const HTTP_RESPONSE_PARSER_CALLBACKS benchmark_callbacks =
+{
+    benchmark_on_status,
+    benchmark_on_header,
+    benchmark_on_headers_complete,
+    benchmark_on_body,
+    benchmark_on_chunk_complete
+};
+
+/* builds a response shaped like an IoT Hub reply: a dozen headers and a 4KB body, framed with Content-Length or chunked */
+static size_t build_benchmark_response(char* response, bool chunked)
+{
+    size_t length = (size_t)sprintf(response, "HTTP/1.1 200 OK\r\n");
+    size_t i;
+
+    for (i = 0; i < BENCHMARK_HEADER_COUNT - 1; i++)
+    {
+        length += (size_t)sprintf(response + length, "x-ms-header-%lu: 3f2c9a1e-5b7d-4e8f-a0c1-%012lu\r\n", (unsigned long)i, (unsigned long)i);
+    }
+
+    if (chunked)
+    {
+        length += (size_t)sprintf(response + length, "Transfer-Encoding: chunked\r\n\r\n");
+        for (i = 0; i < BENCHMARK_BODY_LENGTH; i += BENCHMARK_CHUNK_LENGTH)
+        {
+            length += (size_t)sprintf(response + length, "%x\r\n", (unsigned int)BENCHMARK_CHUNK_LENGTH);
+            (void)memset(response + length, 'a', BENCHMARK_CHUNK_LENGTH);
+            length += BENCHMARK_CHUNK_LENGTH;
+            length += (size_t)sprintf(response + length, "\r\n");
+        }
+        length += (size_t)sprintf(response + length, "0\r\n\r\n");
+    }
+    else
+    {
+        length += (size_t)sprintf(response + length, "Content-Length: %lu\r\n\r\n", (unsigned long)BENCHMARK_BODY_LENGTH);
+        (void)memset(response + length, 'a', BENCHMARK_BODY_LENGTH);
+        length += BENCHMARK_BODY_LENGTH;
+    }
+
+    return length;
+}
+
+/* parses the response BENCHMARK_RESPONSES times, fed segment_size bytes at a time, and returns the MB/s */
+static double run_benchmark(const char* response, size_t response_length, size_t segment_size)
+{
+    BENCHMARK_COUNTS counts = { 0, 0 };
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&benchmark_callbacks, &counts);
+    clock_t start;
+    double seconds;
+    size_t i;
+    ASSERT_IS_NOT_NULL(parser);
+
+    start = clock();
+    for (i = 0; i < BENCHMARK_RESPONSES; i++)
+    {
+        size_t offset = 0;
+        HTTP_RESPONSE_PARSER_RESULT result = HTTP_RESPONSE_PARSER_NEED_MORE_DATA;
+        while (result == HTTP_RESPONSE_PARSER_NEED_MORE_DATA)
+        {
+            size_t size = (response_length - offset < segment_size) ? response_length - offset : segment_size;
+            size_t bytes_consumed;
+            result = http_response_parser_feed(parser, (const unsigned char*)response + offset, size, &bytes_consumed);
+            offset += bytes_consumed;
+        }
+        ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_COMPLETE, result);
+        ASSERT_ARE_EQUAL(size_t, response_length, offset);
+        ASSERT_ARE_EQUAL(int, 0, http_response_parser_reset(parser));
+    }
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    ASSERT_ARE_EQUAL(size_t, (size_t)BENCHMARK_RESPONSES * BENCHMARK_HEADER_COUNT, counts.header_count);
+    ASSERT_ARE_EQUAL(size_t, (size_t)BENCHMARK_RESPONSES * BENCHMARK_BODY_LENGTH, counts.body_length);
+    http_response_parser_destroy(parser);
+
+    return (seconds > 0) ? ((double)response_length * BENCHMARK_RESPONSES) / (seconds * 1024 * 1024) : 0.0;
+}
+
+BEGIN_TEST_SUITE(http_response_parser_unittests)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, real_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, real_realloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, real_free);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    umock_c_reset_all_calls();
+    (void)memset(&recorded, 0, sizeof(recorded));
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* http_response_parser_create */
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_001: [ `http_response_parser_create` shall allocate a parser that reports the response parts through `callbacks`, passing `callback_context` to each of them, and that is ready to parse a status line. ]*/
+TEST_FUNCTION(http_response_parser_create_succeeds)
+{
+    // arrange
+    HTTP_RESPONSE_PARSER_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+
+    // act
+    result = http_response_parser_create(&test_callbacks, &recorded);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    http_response_parser_destroy(result);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_002: [ If `callbacks` is NULL, `http_response_parser_create` shall fail and return NULL. ]*/
+TEST_FUNCTION(http_response_parser_create_with_NULL_callbacks_fails)
+{
+    // arrange
+
+    // act
+    HTTP_RESPONSE_PARSER_HANDLE result = http_response_parser_create(NULL, &recorded);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_003: [ If allocating memory fails, `http_response_parser_create` shall fail and return NULL. ]*/
+TEST_FUNCTION(when_allocating_memory_fails_http_response_parser_create_fails)
+{
+    // arrange
+    HTTP_RESPONSE_PARSER_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument(1)
+        .SetReturn(NULL);
+
+    // act
+    result = http_response_parser_create(&test_callbacks, &recorded);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* http_response_parser_destroy */
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_004: [ `http_response_parser_destroy` shall free all resources associated with the parser. ]*/
+TEST_FUNCTION(http_response_parser_destroy_frees_the_line_buffer_and_the_parser)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+    (void)feed_string(parser, "HTTP/1.1 2", &bytes_consumed);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+
+    // act
+    http_response_parser_destroy(parser);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_005: [ If `http_response_parser` is NULL, `http_response_parser_destroy` shall do nothing. ]*/
+TEST_FUNCTION(http_response_parser_destroy_with_NULL_does_nothing)
+{
+    // arrange
+
+    // act
+    http_response_parser_destroy(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* http_response_parser_reset */
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_041: [ If `http_response_parser` is NULL, `http_response_parser_reset` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(http_response_parser_reset_with_NULL_fails)
+{
+    // arrange
+
+    // act
+    int result = http_response_parser_reset(NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_040: [ `http_response_parser_reset` shall discard any partially parsed response and prepare the parser for a new status line, keeping its line buffer for reuse. ]*/
+TEST_FUNCTION(http_response_parser_reset_discards_a_partial_response_and_keeps_the_line_buffer)
+{
+    // arrange
+    size_t bytes_consumed;
+    int result;
+    HTTP_RESPONSE_PARSER_RESULT feed_result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+    (void)feed_string(parser, "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 10\r\n\r\nabc", &bytes_consumed);
+    (void)feed_string(parser, "HTTP/1.1 2", &bytes_consumed);
+    (void)memset(&recorded, 0, sizeof(recorded));
+
+    // act
+    result = http_response_parser_reset(parser);
+    umock_c_reset_all_calls();
+    feed_result = feed_string(parser, "HTTP/1.1 200 OK\r\nContent-Length: 5\r\nx-ms-request-id:  abc \r\n", &bytes_consumed);
+    feed_result = feed_string(parser, "\r\nhe", &bytes_consumed);
+    feed_result = feed_string(parser, "llo", &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_COMPLETE, feed_result);
+    assert_content_length_response_recorded();
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* http_response_parser_feed */
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_051: [ If `http_response_parser` or `bytes_consumed` is NULL, or `buffer` is NULL while `size` is not zero, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+TEST_FUNCTION(http_response_parser_feed_with_NULL_parser_fails)
+{
+    // arrange
+    size_t bytes_consumed;
+
+    // act
+    HTTP_RESPONSE_PARSER_RESULT result = http_response_parser_feed(NULL, (const unsigned char*)CONTENT_LENGTH_RESPONSE, sizeof(CONTENT_LENGTH_RESPONSE) - 1, &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_ERROR, result);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_051: [ If `http_response_parser` or `bytes_consumed` is NULL, or `buffer` is NULL while `size` is not zero, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+TEST_FUNCTION(http_response_parser_feed_with_NULL_bytes_consumed_fails)
+{
+    // arrange
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+
+    // act
+    result = http_response_parser_feed(parser, (const unsigned char*)CONTENT_LENGTH_RESPONSE, sizeof(CONTENT_LENGTH_RESPONSE) - 1, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_ERROR, result);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_051: [ If `http_response_parser` or `bytes_consumed` is NULL, or `buffer` is NULL while `size` is not zero, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+TEST_FUNCTION(http_response_parser_feed_with_NULL_buffer_and_non_zero_size_fails)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+
+    // act
+    result = http_response_parser_feed(parser, NULL, 1, &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_ERROR, result);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_050: [ `http_response_parser_feed` shall parse the `size` bytes in `buffer`, which may end anywhere in the response, and shall continue from where the previous call stopped. ]*/
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_006: [ Lines received whole shall be parsed in place, without copying them. ]*/
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_012: [ The status code and a view over the reason phrase, without the leading spaces, shall be passed to `on_status`. ]*/
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_013: [ For each header line, a view over the name and a view over the value, without leading and trailing whitespace, shall be passed to `on_header`. ]*/
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_016: [ On the empty line that ends the headers, `on_headers_complete` shall be called with the content length, whether the body is chunked and the `has_body` flag. ]*/
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_020: [ Body bytes shall be passed to `on_body` as views into `buffer`, as soon as they are fed. ]*/
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_052: [ `http_response_parser_feed` shall set `bytes_consumed` to the number of bytes it used, and shall not use the bytes that follow a complete response. ]*/
+TEST_FUNCTION(http_response_parser_feed_parses_a_whole_content_length_response_without_allocating)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+    umock_c_reset_all_calls();
+
+    // act
+    result = feed_string(parser, CONTENT_LENGTH_RESPONSE, &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_COMPLETE, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(CONTENT_LENGTH_RESPONSE) - 1, bytes_consumed);
+    assert_content_length_response_recorded();
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_052: [ `http_response_parser_feed` shall set `bytes_consumed` to the number of bytes it used, and shall not use the bytes that follow a complete response. ]*/
+TEST_FUNCTION(http_response_parser_feed_does_not_consume_the_bytes_after_the_response)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+
+    // act
+    result = feed_string(parser, "HTTP/1.1 200 OK\r\nContent-Length: 5\r\nx-ms-request-id:  abc \r\n\r\nhelloHTTP/1.1", &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_COMPLETE, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(CONTENT_LENGTH_RESPONSE) - 1, bytes_consumed);
+    assert_content_length_response_recorded();
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_053: [ Once the whole response was parsed, `http_response_parser_feed` shall return `HTTP_RESPONSE_PARSER_COMPLETE` until `http_response_parser_reset` is called. ]*/
+TEST_FUNCTION(http_response_parser_feed_after_a_complete_response_returns_COMPLETE_without_consuming)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+    (void)feed_string(parser, CONTENT_LENGTH_RESPONSE, &bytes_consumed);
+
+    // act
+    result = feed_string(parser, "HTTP/1.1 200 OK\r\n", &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_COMPLETE, result);
+    ASSERT_ARE_EQUAL(size_t, 0, bytes_consumed);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_055: [ While the response is incomplete, `http_response_parser_feed` shall return `HTTP_RESPONSE_PARSER_NEED_MORE_DATA`. ]*/
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_007: [ A line split across calls to `http_response_parser_feed` shall be kept by the parser until its end is received. ]*/
+TEST_FUNCTION(http_response_parser_feed_parses_a_content_length_response_split_at_every_position)
+{
+    size_t split;
+    const size_t response_length = sizeof(CONTENT_LENGTH_RESPONSE) - 1;
+
+    for (split = 0; split <= response_length; split++)
+    {
+        // arrange
+        size_t first_consumed;
+        size_t second_consumed;
+        HTTP_RESPONSE_PARSER_RESULT first_result;
+        HTTP_RESPONSE_PARSER_RESULT second_result;
+        HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+        (void)memset(&recorded, 0, sizeof(recorded));
+
+        // act
+        first_result = http_response_parser_feed(parser, (const unsigned char*)CONTENT_LENGTH_RESPONSE, split, &first_consumed);
+        second_result = http_response_parser_feed(parser, (const unsigned char*)CONTENT_LENGTH_RESPONSE + split, response_length - split, &second_consumed);
+
+        // assert
+        ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, (split == response_length) ? HTTP_RESPONSE_PARSER_COMPLETE : HTTP_RESPONSE_PARSER_NEED_MORE_DATA, first_result);
+        ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_COMPLETE, second_result);
+        ASSERT_ARE_EQUAL(size_t, response_length, first_consumed + second_consumed);
+        assert_content_length_response_recorded();
+
+        // cleanup
+        http_response_parser_destroy(parser);
+    }
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_021: [ Each chunk shall start with a line holding its size in hexadecimal, optionally followed by chunk extensions, which shall be ignored. ]*/
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_023: [ For chunked bodies only the chunk data shall be passed to `on_body`. ]*/
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_024: [ A chunk of size zero shall end the body; the trailer lines that follow it shall be skipped up to the empty line that completes the response. ]*/
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_026: [ Once all the data of a chunk was passed to `on_body`, `on_chunk_complete` shall be called. ]*/
+TEST_FUNCTION(http_response_parser_feed_parses_a_chunked_response)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+    umock_c_reset_all_calls();
+
+    // act
+    result = feed_string(parser, CHUNKED_RESPONSE, &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_COMPLETE, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(CHUNKED_RESPONSE) - 1, bytes_consumed);
+    assert_chunked_response_recorded();
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_050: [ `http_response_parser_feed` shall parse the `size` bytes in `buffer`, which may end anywhere in the response, and shall continue from where the previous call stopped. ]*/
+TEST_FUNCTION(http_response_parser_feed_parses_a_chunked_response_fed_one_byte_at_a_time)
+{
+    // arrange
+    size_t i;
+    size_t total_consumed = 0;
+    HTTP_RESPONSE_PARSER_RESULT result = HTTP_RESPONSE_PARSER_NEED_MORE_DATA;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+
+    // act
+    for (i = 0; i < sizeof(CHUNKED_RESPONSE) - 1; i++)
+    {
+        size_t bytes_consumed;
+        ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_NEED_MORE_DATA, result);
+        result = http_response_parser_feed(parser, (const unsigned char*)CHUNKED_RESPONSE + i, 1, &bytes_consumed);
+        total_consumed += bytes_consumed;
+    }
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_COMPLETE, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(CHUNKED_RESPONSE) - 1, total_consumed);
+    assert_chunked_response_recorded();
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_008: [ Lines shall end with LF; a CR right before the LF shall not be part of the line. ]*/
+TEST_FUNCTION(http_response_parser_feed_accepts_lines_ending_with_a_bare_LF)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+
+    // act
+    result = feed_string(parser, "HTTP/1.1 200 OK\nContent-Length: 5\nx-ms-request-id: abc\n\nhello", &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_COMPLETE, result);
+    assert_content_length_response_recorded();
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_014: [ The `Content-Length` and `Transfer-Encoding` headers shall be matched case-insensitively and used to frame the body. ]*/
+TEST_FUNCTION(http_response_parser_feed_matches_the_framing_headers_case_insensitively)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+
+    // act
+    result = feed_string(parser, "HTTP/1.1 200 OK\r\ntransfer-encoding: gzip, CHUNKED\r\n\r\n2\r\nab\r\n0\r\n\r\n", &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_COMPLETE, result);
+    ASSERT_IS_TRUE(recorded.chunked);
+    ASSERT_ARE_EQUAL(size_t, 2, recorded.body_length);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_015: [ Header lines without a colon shall be ignored. ]*/
+TEST_FUNCTION(http_response_parser_feed_ignores_header_lines_without_a_colon)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+
+    // act
+    result = feed_string(parser, "HTTP/1.1 204 No Content\r\nnot a header\r\nA: b\r\n\r\n", &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_COMPLETE, result);
+    ASSERT_ARE_EQUAL(char_ptr, "A=b;", recorded.headers);
+    ASSERT_ARE_EQUAL(size_t, 1, recorded.header_count);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_017: [ The response shall have a body when it is chunked or when its `Content-Length` is not zero; responses without either framing header have no body. ]*/
+TEST_FUNCTION(http_response_parser_feed_completes_a_response_without_framing_headers_after_the_headers)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+
+    // act
+    result = feed_string(parser, "HTTP/1.1 200 Connection established\r\n\r\n\x16\x03", &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_COMPLETE, result);
+    ASSERT_ARE_EQUAL(size_t, strlen("HTTP/1.1 200 Connection established\r\n\r\n"), bytes_consumed);
+    ASSERT_ARE_EQUAL(char_ptr, "Connection established", recorded.reason_phrase);
+    ASSERT_ARE_EQUAL(size_t, 0, recorded.body_length);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_018: [ If `has_body` is false after `on_headers_complete` returns, the response shall be complete right after the headers. ]*/
+TEST_FUNCTION(when_on_headers_complete_clears_has_body_the_response_is_complete_after_the_headers)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+    recorded.clear_has_body = true;
+
+    // act
+    result = feed_string(parser, CONTENT_LENGTH_RESPONSE, &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_COMPLETE, result);
+    ASSERT_ARE_EQUAL(size_t, sizeof(CONTENT_LENGTH_RESPONSE) - 1 - 5, bytes_consumed);
+    ASSERT_ARE_EQUAL(size_t, 5, recorded.content_length);
+    ASSERT_ARE_EQUAL(size_t, 0, recorded.body_length);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_010: [ The status line shall start with `HTTP/`, followed by the protocol version, one or more spaces and a decimal status code. ]*/
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_011: [ If the status line cannot be parsed, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+TEST_FUNCTION(http_response_parser_feed_with_an_invalid_status_line_fails)
+{
+    static const char* invalid_status_lines[] =
+    {
+        "HTP/1.1 200 OK\r\n",
+        "HTTP/1.1\r\n",
+        "HTTP/1.1 OK\r\n",
+        "HTTP/1.1 20x OK\r\n",
+        "\r\n"
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(invalid_status_lines) / sizeof(invalid_status_lines[0]); i++)
+    {
+        // arrange
+        size_t bytes_consumed;
+        HTTP_RESPONSE_PARSER_RESULT result;
+        HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+
+        // act
+        result = feed_string(parser, invalid_status_lines[i], &bytes_consumed);
+
+        // assert
+        ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_ERROR, result);
+
+        // cleanup
+        http_response_parser_destroy(parser);
+    }
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_054: [ After a failure, `http_response_parser_feed` shall return `HTTP_RESPONSE_PARSER_ERROR` until `http_response_parser_reset` is called. ]*/
+TEST_FUNCTION(http_response_parser_feed_after_a_failure_fails_until_reset)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result_after_failure;
+    HTTP_RESPONSE_PARSER_RESULT result_after_reset;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+    (void)feed_string(parser, "garbage\r\n", &bytes_consumed);
+
+    // act
+    result_after_failure = feed_string(parser, CONTENT_LENGTH_RESPONSE, &bytes_consumed);
+    (void)http_response_parser_reset(parser);
+    result_after_reset = feed_string(parser, CONTENT_LENGTH_RESPONSE, &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_ERROR, result_after_failure);
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_COMPLETE, result_after_reset);
+    assert_content_length_response_recorded();
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_019: [ If the `Content-Length` value is not a decimal number, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+TEST_FUNCTION(http_response_parser_feed_with_an_invalid_content_length_fails)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+
+    // act
+    result = feed_string(parser, "HTTP/1.1 200 OK\r\nContent-Length: 5a\r\n\r\nhello", &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_ERROR, result);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_022: [ If a chunk size cannot be parsed, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+TEST_FUNCTION(http_response_parser_feed_with_an_invalid_chunk_size_fails)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+
+    // act
+    result = feed_string(parser, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nxyz\r\n", &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_ERROR, result);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_025: [ If the chunk data is not followed by an empty line, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+TEST_FUNCTION(http_response_parser_feed_with_chunk_data_longer_than_its_size_fails)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+
+    // act
+    result = feed_string(parser, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nabc\r\n0\r\n\r\n", &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_ERROR, result);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_009: [ If a line is longer than `HTTP_RESPONSE_PARSER_MAX_LINE_LENGTH`, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+TEST_FUNCTION(http_response_parser_feed_with_a_line_longer_than_the_maximum_fails)
+{
+    // arrange
+    size_t bytes_consumed;
+    size_t i;
+    HTTP_RESPONSE_PARSER_RESULT result = HTTP_RESPONSE_PARSER_NEED_MORE_DATA;
+    unsigned char header_piece[1024];
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+    (void)memset(header_piece, 'a', sizeof(header_piece));
+    (void)feed_string(parser, "HTTP/1.1 200 OK\r\nx-long: ", &bytes_consumed);
+
+    // act
+    for (i = 0; (i < 9) && (result == HTTP_RESPONSE_PARSER_NEED_MORE_DATA); i++)
+    {
+        result = http_response_parser_feed(parser, header_piece, sizeof(header_piece), &bytes_consumed);
+    }
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_ERROR, result);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_031: [ If any other error occurs, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+TEST_FUNCTION(when_growing_the_line_buffer_fails_http_response_parser_feed_fails)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+        .IgnoreArgument(2)
+        .SetReturn(NULL);
+
+    // act
+    result = feed_string(parser, "HTTP/1.1 2", &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_030: [ If any callback returns non-zero, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+TEST_FUNCTION(when_on_status_fails_http_response_parser_feed_fails)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+    recorded.status_result = 1;
+
+    // act
+    result = feed_string(parser, CONTENT_LENGTH_RESPONSE, &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_ERROR, result);
+    ASSERT_ARE_EQUAL(size_t, 0, recorded.header_count);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_030: [ If any callback returns non-zero, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+TEST_FUNCTION(when_on_header_fails_http_response_parser_feed_fails)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+    recorded.header_result = 1;
+
+    // act
+    result = feed_string(parser, CONTENT_LENGTH_RESPONSE, &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_ERROR, result);
+    ASSERT_ARE_EQUAL(size_t, 1, recorded.header_count);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_030: [ If any callback returns non-zero, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+TEST_FUNCTION(when_on_headers_complete_fails_http_response_parser_feed_fails)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+    recorded.headers_complete_result = 1;
+
+    // act
+    result = feed_string(parser, CONTENT_LENGTH_RESPONSE, &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_ERROR, result);
+    ASSERT_ARE_EQUAL(size_t, 0, recorded.body_length);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_030: [ If any callback returns non-zero, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+TEST_FUNCTION(when_on_body_fails_http_response_parser_feed_fails)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+    recorded.body_result = 1;
+
+    // act
+    result = feed_string(parser, CONTENT_LENGTH_RESPONSE, &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_ERROR, result);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Tests_SRS_HTTP_RESPONSE_PARSER_01_030: [ If any callback returns non-zero, `http_response_parser_feed` shall fail and return `HTTP_RESPONSE_PARSER_ERROR`. ]*/
+TEST_FUNCTION(when_on_chunk_complete_fails_http_response_parser_feed_fails)
+{
+    // arrange
+    size_t bytes_consumed;
+    HTTP_RESPONSE_PARSER_RESULT result;
+    HTTP_RESPONSE_PARSER_HANDLE parser = http_response_parser_create(&test_callbacks, &recorded);
+    recorded.chunk_complete_result = 1;
+
+    // act
+    result = feed_string(parser, CHUNKED_RESPONSE, &bytes_consumed);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTP_RESPONSE_PARSER_RESULT, HTTP_RESPONSE_PARSER_ERROR, result);
+    ASSERT_ARE_EQUAL(size_t, 1, recorded.chunk_complete_count);
+
+    // cleanup
+    http_response_parser_destroy(parser);
+}
+
+/* Benchmark: parses responses fed whole and in TCP sized segments and logs the throughput. Timings depend on the
+   machine, so only what the parser reported is asserted. */
+TEST_FUNCTION(http_response_parser_feed_benchmark)
+{
+    // arrange
+    char content_length_response[8192];
+    char chunked_response[8192];
+    size_t content_length_response_length = build_benchmark_response(content_length_response, false);
+    size_t chunked_response_length = build_benchmark_response(chunked_response, true);
+    double content_length_whole;
+    double content_length_segmented;
+    double chunked_whole;
+    double chunked_segmented;
+
+    // act
+    content_length_whole = run_benchmark(content_length_response, content_length_response_length, content_length_response_length);
+    content_length_segmented = run_benchmark(content_length_response, content_length_response_length, BENCHMARK_SEGMENT_SIZE);
+    chunked_whole = run_benchmark(chunked_response, chunked_response_length, chunked_response_length);
+    chunked_segmented = run_benchmark(chunked_response, chunked_response_length, BENCHMARK_SEGMENT_SIZE);
+
+    // assert
+    LogInfo("http_response_parser_feed MB/s: Content-Length whole %.0f, in %d byte segments %.0f; chunked whole %.0f, in %d byte segments %.0f",
+        content_length_whole, BENCHMARK_SEGMENT_SIZE, content_length_segmented, chunked_whole, BENCHMARK_SEGMENT_SIZE, chunked_segmented);
+}
+
+END_TEST_SUITE(http_response_parser_unittests)
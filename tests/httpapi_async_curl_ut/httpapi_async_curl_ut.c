@@ -0,0 +1,1851 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <cstdarg>
+#else
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#endif
+#include <poll.h>
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+/* the module frees the headers it gets from HTTPHeaders_GetHeader */
+static char* copy_string(const char* source)
+{
+    char* result = (char*)malloc(strlen(source) + 1);
+    if (result != NULL)
+    {
+        (void)strcpy(result, source);
+    }
+    return result;
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+
+/* the setopt and getinfo functions are variadic, so they are defined below on top of mockable functions, one per argument type */
+#define CURL_DISABLE_TYPECHECK
+#include "curl/curl.h"
+
+typedef void(*TEST_CURL_FUNCTION)(void);
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/httpapi.h"
+#include "azure_c_shared_utility/httpheaders.h"
+#ifdef USE_OPENSSL
+#include "azure_c_shared_utility/x509_openssl.h"
+#endif
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    MOCKABLE_FUNCTION(, CURL*, curl_easy_init);
+    MOCKABLE_FUNCTION(, void, curl_easy_cleanup, CURL*, curl);
+    MOCKABLE_FUNCTION(, CURLcode, curl_easy_setopt_long, CURL*, curl, CURLoption, option, long, value);
+    MOCKABLE_FUNCTION(, CURLcode, curl_easy_setopt_ptr, CURL*, curl, CURLoption, option, void*, value);
+    MOCKABLE_FUNCTION(, CURLcode, curl_easy_setopt_func, CURL*, curl, CURLoption, option, TEST_CURL_FUNCTION, value);
+    MOCKABLE_FUNCTION(, CURLcode, curl_easy_getinfo_ptr, CURL*, curl, CURLINFO, info, void*, value);
+    MOCKABLE_FUNCTION(, const char*, curl_easy_strerror, CURLcode, error);
+    MOCKABLE_FUNCTION(, struct curl_slist*, curl_slist_append, struct curl_slist*, list, const char*, string);
+    MOCKABLE_FUNCTION(, void, curl_slist_free_all, struct curl_slist*, list);
+    MOCKABLE_FUNCTION(, CURLM*, curl_multi_init);
+    MOCKABLE_FUNCTION(, CURLMcode, curl_multi_cleanup, CURLM*, multi);
+    MOCKABLE_FUNCTION(, CURLMcode, curl_multi_setopt_long, CURLM*, multi, CURLMoption, option, long, value);
+    MOCKABLE_FUNCTION(, CURLMcode, curl_multi_setopt_ptr, CURLM*, multi, CURLMoption, option, void*, value);
+    MOCKABLE_FUNCTION(, CURLMcode, curl_multi_setopt_func, CURLM*, multi, CURLMoption, option, TEST_CURL_FUNCTION, value);
+    MOCKABLE_FUNCTION(, CURLMcode, curl_multi_add_handle, CURLM*, multi, CURL*, curl);
+    MOCKABLE_FUNCTION(, CURLMcode, curl_multi_remove_handle, CURLM*, multi, CURL*, curl);
+    MOCKABLE_FUNCTION(, CURLMcode, curl_multi_socket_action, CURLM*, multi, curl_socket_t, s, int, ev_bitmask, int*, running_handles);
+    MOCKABLE_FUNCTION(, CURLMsg*, curl_multi_info_read, CURLM*, multi, int*, msgs_in_queue);
+    MOCKABLE_FUNCTION(, int, poll, struct pollfd*, fds, nfds_t, nfds, int, timeout);
+    MOCKABLE_FUNCTION(, curl_version_info_data*, curl_version_info, CURLversion, stamp);
+#ifdef __cplusplus
+}
+#endif
+#undef ENABLE_MOCKS
+
+#include "azure_c_shared_utility/httpapi_async.h"
+#include "azure_c_shared_utility/shared_util_options.h"
+
+CURLcode curl_easy_setopt(CURL* curl, CURLoption option, ...)
+{
+    CURLcode result;
+    va_list args;
+
+    va_start(args, option);
+    if (option < CURLOPTTYPE_OBJECTPOINT)
+    {
+        result = curl_easy_setopt_long(curl, option, va_arg(args, long));
+    }
+    else if (option < CURLOPTTYPE_FUNCTIONPOINT)
+    {
+        result = curl_easy_setopt_ptr(curl, option, va_arg(args, void*));
+    }
+    else if (option < CURLOPTTYPE_OFF_T)
+    {
+        result = curl_easy_setopt_func(curl, option, va_arg(args, TEST_CURL_FUNCTION));
+    }
+    else
+    {
+        result = CURLE_UNKNOWN_OPTION;
+    }
+    va_end(args);
+
+    return result;
+}
+
+CURLcode curl_easy_getinfo(CURL* curl, CURLINFO info, ...)
+{
+    CURLcode result;
+    va_list args;
+
+    va_start(args, info);
+    result = curl_easy_getinfo_ptr(curl, info, va_arg(args, void*));
+    va_end(args);
+
+    return result;
+}
+
+CURLMcode curl_multi_setopt(CURLM* multi, CURLMoption option, ...)
+{
+    CURLMcode result;
+    va_list args;
+
+    va_start(args, option);
+    if (option < CURLOPTTYPE_OBJECTPOINT)
+    {
+        result = curl_multi_setopt_long(multi, option, va_arg(args, long));
+    }
+    else if (option < CURLOPTTYPE_FUNCTIONPOINT)
+    {
+        result = curl_multi_setopt_ptr(multi, option, va_arg(args, void*));
+    }
+    else if (option < CURLOPTTYPE_OFF_T)
+    {
+        result = curl_multi_setopt_func(multi, option, va_arg(args, TEST_CURL_FUNCTION));
+    }
+    else
+    {
+        result = CURLM_UNKNOWN_OPTION;
+    }
+    va_end(args);
+
+    return result;
+}
+
+#define TEST_HOST_NAME "test.azure-devices.net"
+#define TEST_MULTI ((CURLM*)0x4242)
+#define TEST_REQUEST_HEADERS ((HTTP_HEADERS_HANDLE)0x4243)
+#define TEST_RESPONSE_HEADERS ((HTTP_HEADERS_HANDLE)0x4244)
+#define TEST_HEADER_LIST ((struct curl_slist*)0x4245)
+#define TEST_HEADER "Host: " TEST_HOST_NAME
+#define TEST_SOCKET 42
+#define TEST_MAX_CONNECTIONS 2
+#define TEST_MAX_EASY_HANDLES 8
+#define TEST_MAX_OPTIONS 32
+#define TEST_EASY(index) ((CURL*)&g_easy_handles[index])
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+/* the value of one curl_easy_setopt call, strings are copied since the module frees them once curl has its copy */
+typedef struct TEST_OPTION_TAG
+{
+    CURLoption option;
+    long long_value;
+    void* ptr_value;
+    TEST_CURL_FUNCTION function_value;
+    char string_value[128];
+} TEST_OPTION;
+
+/* one entry per curl_easy_init call, the CURL* is the address of the entry */
+typedef struct TEST_EASY_HANDLE_TAG
+{
+    TEST_OPTION options[TEST_MAX_OPTIONS];
+    size_t option_count;
+} TEST_EASY_HANDLE;
+
+static TEST_EASY_HANDLE g_easy_handles[TEST_MAX_EASY_HANDLES];
+static size_t g_easy_handle_count;
+static CURL* g_added_handles[TEST_MAX_EASY_HANDLES * 2];
+static size_t g_added_count;
+static CURLMcode g_add_handle_result;
+static curl_socket_callback g_on_socket;
+static void* g_socket_data;
+static curl_multi_timer_callback g_on_timer;
+static void* g_timer_data;
+static CURLMsg g_messages[TEST_MAX_EASY_HANDLES];
+static size_t g_message_count;
+static size_t g_message_index;
+static long g_response_code;
+static long g_response_http_version;
+static curl_version_info_data g_version_info;
+static short g_poll_revents;
+
+static int g_request_contexts[TEST_MAX_EASY_HANDLES];
+static void* g_contexts[TEST_MAX_EASY_HANDLES];
+static HTTPAPI_ASYNC_RESULT g_results[TEST_MAX_EASY_HANDLES];
+static size_t g_complete_count;
+static unsigned int g_status_code;
+static char g_content[64];
+
+static TEST_OPTION* add_option(CURL* curl, CURLoption option)
+{
+    TEST_EASY_HANDLE* easy_handle = (TEST_EASY_HANDLE*)curl;
+    TEST_OPTION* result;
+
+    if (easy_handle->option_count == TEST_MAX_OPTIONS)
+    {
+        ASSERT_FAIL("too many options set on the easy handle");
+        result = NULL;
+    }
+    else
+    {
+        result = &easy_handle->options[easy_handle->option_count++];
+        (void)memset(result, 0, sizeof(TEST_OPTION));
+        result->option = option;
+    }
+
+    return result;
+}
+
+/* returns the last value set for the option, NULL if it was not set */
+static const TEST_OPTION* find_option(size_t easy_index, CURLoption option)
+{
+    const TEST_OPTION* result = NULL;
+    size_t i;
+
+    for (i = 0; i < g_easy_handles[easy_index].option_count; i++)
+    {
+        if (g_easy_handles[easy_index].options[i].option == option)
+        {
+            result = &g_easy_handles[easy_index].options[i];
+        }
+    }
+
+    return result;
+}
+
+static CURL* my_curl_easy_init(void)
+{
+    CURL* result;
+
+    if (g_easy_handle_count == TEST_MAX_EASY_HANDLES)
+    {
+        result = NULL;
+    }
+    else
+    {
+        result = TEST_EASY(g_easy_handle_count++);
+    }
+
+    return result;
+}
+
+static CURLcode my_curl_easy_setopt_long(CURL* curl, CURLoption option, long value)
+{
+    TEST_OPTION* test_option = add_option(curl, option);
+    if (test_option != NULL)
+    {
+        test_option->long_value = value;
+    }
+    return CURLE_OK;
+}
+
+static CURLcode my_curl_easy_setopt_ptr(CURL* curl, CURLoption option, void* value)
+{
+    TEST_OPTION* test_option = add_option(curl, option);
+    if (test_option != NULL)
+    {
+        test_option->ptr_value = value;
+        if (((option == CURLOPT_URL) || (option == CURLOPT_PROXY) || (option == CURLOPT_PROXYUSERPWD) ||
+            (option == CURLOPT_CUSTOMREQUEST) || (option == CURLOPT_COPYPOSTFIELDS)) &&
+            (strlen((const char*)value) < sizeof(test_option->string_value)))
+        {
+            (void)strcpy(test_option->string_value, (const char*)value);
+        }
+    }
+    return CURLE_OK;
+}
+
+static CURLcode my_curl_easy_setopt_func(CURL* curl, CURLoption option, TEST_CURL_FUNCTION value)
+{
+    TEST_OPTION* test_option = add_option(curl, option);
+    if (test_option != NULL)
+    {
+        test_option->function_value = value;
+    }
+    return CURLE_OK;
+}
+
+static CURLcode my_curl_easy_getinfo_ptr(CURL* curl, CURLINFO info, void* value)
+{
+    CURLcode result = CURLE_OK;
+
+    if (info == CURLINFO_PRIVATE)
+    {
+        const TEST_OPTION* private_option = find_option((TEST_EASY_HANDLE*)curl - g_easy_handles, CURLOPT_PRIVATE);
+        *(char**)value = (private_option == NULL) ? NULL : (char*)private_option->ptr_value;
+    }
+    else if (info == CURLINFO_RESPONSE_CODE)
+    {
+        *(long*)value = g_response_code;
+    }
+#if LIBCURL_VERSION_NUM >= 0x073200
+    else if (info == CURLINFO_HTTP_VERSION)
+    {
+        *(long*)value = g_response_http_version;
+    }
+#endif
+    else
+    {
+        result = CURLE_UNKNOWN_OPTION;
+    }
+
+    return result;
+}
+
+static struct curl_slist* my_curl_slist_append(struct curl_slist* list, const char* string)
+{
+    (void)list;
+    (void)string;
+    return TEST_HEADER_LIST;
+}
+
+static CURLMcode my_curl_multi_setopt_ptr(CURLM* multi, CURLMoption option, void* value)
+{
+    (void)multi;
+    if (option == CURLMOPT_SOCKETDATA)
+    {
+        g_socket_data = value;
+    }
+    else if (option == CURLMOPT_TIMERDATA)
+    {
+        g_timer_data = value;
+    }
+    return CURLM_OK;
+}
+
+static CURLMcode my_curl_multi_setopt_func(CURLM* multi, CURLMoption option, TEST_CURL_FUNCTION value)
+{
+    (void)multi;
+    if (option == CURLMOPT_SOCKETFUNCTION)
+    {
+        g_on_socket = (curl_socket_callback)value;
+    }
+    else if (option == CURLMOPT_TIMERFUNCTION)
+    {
+        g_on_timer = (curl_multi_timer_callback)value;
+    }
+    return CURLM_OK;
+}
+
+static CURLMcode my_curl_multi_add_handle(CURLM* multi, CURL* curl)
+{
+    (void)multi;
+    if (g_add_handle_result == CURLM_OK)
+    {
+        g_added_handles[g_added_count++] = curl;
+    }
+    return g_add_handle_result;
+}
+
+static CURLMcode my_curl_multi_socket_action(CURLM* multi, curl_socket_t s, int ev_bitmask, int* running_handles)
+{
+    (void)multi;
+    (void)s;
+    (void)ev_bitmask;
+    *running_handles = 0;
+    return CURLM_OK;
+}
+
+static CURLMsg* my_curl_multi_info_read(CURLM* multi, int* msgs_in_queue)
+{
+    CURLMsg* result;
+    (void)multi;
+
+    if (g_message_index == g_message_count)
+    {
+        result = NULL;
+    }
+    else
+    {
+        result = &g_messages[g_message_index++];
+    }
+    *msgs_in_queue = (int)(g_message_count - g_message_index);
+
+    return result;
+}
+
+static int my_poll(struct pollfd* fds, nfds_t nfds, int timeout)
+{
+    int result = 0;
+    nfds_t i;
+    (void)timeout;
+
+    for (i = 0; i < nfds; i++)
+    {
+        fds[i].revents = fds[i].events & g_poll_revents;
+        if (fds[i].revents != 0)
+        {
+            result++;
+        }
+    }
+
+    return result;
+}
+
+static curl_version_info_data* my_curl_version_info(CURLversion stamp)
+{
+    (void)stamp;
+    return &g_version_info;
+}
+
+static HTTP_HEADERS_RESULT my_HTTPHeaders_GetHeaderCount(HTTP_HEADERS_HANDLE httpHeadersHandle, size_t* headersCount)
+{
+    (void)httpHeadersHandle;
+    *headersCount = 1;
+    return HTTP_HEADERS_OK;
+}
+
+static HTTP_HEADERS_RESULT my_HTTPHeaders_GetHeader(HTTP_HEADERS_HANDLE handle, size_t index, char** destination)
+{
+    (void)handle;
+    (void)index;
+    *destination = copy_string(TEST_HEADER);
+    return (*destination == NULL) ? HTTP_HEADERS_ALLOC_FAILED : HTTP_HEADERS_OK;
+}
+
+static void test_on_request_complete(void* context, HTTPAPI_ASYNC_RESULT result, unsigned int status_code, HTTP_HEADERS_HANDLE response_headers, BUFFER_HANDLE response_content)
+{
+    (void)response_headers;
+
+    if (g_complete_count < TEST_MAX_EASY_HANDLES)
+    {
+        g_contexts[g_complete_count] = context;
+        g_results[g_complete_count] = result;
+    }
+    g_complete_count++;
+    g_status_code = status_code;
+    g_content[0] = '\0';
+    if ((response_content != NULL) && (BUFFER_length(response_content) < sizeof(g_content)))
+    {
+        (void)memcpy(g_content, BUFFER_u_char(response_content), BUFFER_length(response_content));
+        g_content[BUFFER_length(response_content)] = '\0';
+    }
+}
+
+static HTTPAPI_ASYNC_HANDLE create_with_requests(size_t max_connections, size_t request_count)
+{
+    size_t i;
+    HTTPAPI_ASYNC_HANDLE result = httpapi_async_create(TEST_HOST_NAME, max_connections);
+    ASSERT_IS_NOT_NULL(result);
+
+    for (i = 0; i < request_count; i++)
+    {
+        int execute_result = httpapi_async_execute_request(result, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, &g_request_contexts[i]);
+        ASSERT_ARE_EQUAL(int, 0, execute_result);
+    }
+
+    umock_c_reset_all_calls();
+    return result;
+}
+
+/* the transfer of the easy handle ends with curl_result on the next curl_multi_info_read */
+static void complete_transfer(size_t easy_index, CURLcode curl_result)
+{
+    CURLMsg* message = &g_messages[g_message_count++];
+    message->msg = CURLMSG_DONE;
+    message->easy_handle = TEST_EASY(easy_index);
+    message->data.result = curl_result;
+}
+
+/* feeds a response to the header and write callbacks the module set on the easy handle */
+static void receive_response(size_t easy_index, const char* header_line, const char* content)
+{
+    const TEST_OPTION* header_function = find_option(easy_index, CURLOPT_HEADERFUNCTION);
+    const TEST_OPTION* header_data = find_option(easy_index, CURLOPT_HEADERDATA);
+    const TEST_OPTION* write_function = find_option(easy_index, CURLOPT_WRITEFUNCTION);
+    const TEST_OPTION* write_data = find_option(easy_index, CURLOPT_WRITEDATA);
+    char buffer[128];
+
+    ASSERT_IS_NOT_NULL(header_function);
+    ASSERT_IS_NOT_NULL(header_data);
+    ASSERT_IS_NOT_NULL(write_function);
+    ASSERT_IS_NOT_NULL(write_data);
+
+    (void)strcpy(buffer, header_line);
+    (void)((curl_write_callback)header_function->function_value)(buffer, 1, strlen(buffer), header_data->ptr_value);
+    (void)strcpy(buffer, content);
+    (void)((curl_write_callback)write_function->function_value)(buffer, 1, strlen(buffer), write_data->ptr_value);
+}
+
+static void setup_create_expected_calls(void)
+{
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof("https://" TEST_HOST_NAME)));
+    STRICT_EXPECTED_CALL(HTTPAPI_Init());
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /* the pending requests */
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /* the active requests */
+    STRICT_EXPECTED_CALL(curl_multi_init());
+}
+
+static void setup_get_request_options_expected_calls(CURL* curl)
+{
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof("https://" TEST_HOST_NAME "/path")));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_ptr(curl, CURLOPT_URL, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_ptr(curl, CURLOPT_PRIVATE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_long(curl, CURLOPT_NOSIGNAL, 1));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_long(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_ptr(curl, CURLOPT_HTTPHEADER, TEST_HEADER_LIST));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_func(curl, CURLOPT_HEADERFUNCTION, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_ptr(curl, CURLOPT_HEADERDATA, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_func(curl, CURLOPT_WRITEFUNCTION, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_ptr(curl, CURLOPT_WRITEDATA, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_long(curl, CURLOPT_VERBOSE, 0));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_long(curl, CURLOPT_LOW_SPEED_LIMIT, 0));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_long(curl, CURLOPT_LOW_SPEED_TIME, 0));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_long(curl, CURLOPT_FRESH_CONNECT, 0));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_long(curl, CURLOPT_FORBID_REUSE, 0));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_long(curl, CURLOPT_HTTPGET, 1));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+}
+
+TEST_DEFINE_ENUM_TYPE(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTPAPI_RESULT, HTTPAPI_RESULT_VALUES);
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+BEGIN_TEST_SUITE(httpapi_async_curl_unittests)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    int result;
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT);
+    REGISTER_TYPE(HTTPAPI_RESULT, HTTPAPI_RESULT);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(TEST_CURL_FUNCTION, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(CURLcode, int);
+    REGISTER_UMOCK_ALIAS_TYPE(CURLMcode, int);
+    REGISTER_UMOCK_ALIAS_TYPE(CURLoption, int);
+    REGISTER_UMOCK_ALIAS_TYPE(CURLMoption, int);
+    REGISTER_UMOCK_ALIAS_TYPE(CURLINFO, int);
+    REGISTER_UMOCK_ALIAS_TYPE(CURLversion, int);
+    REGISTER_UMOCK_ALIAS_TYPE(curl_socket_t, int);
+    REGISTER_UMOCK_ALIAS_TYPE(nfds_t, unsigned long);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPAPI_Init, HTTPAPI_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_Alloc, TEST_RESPONSE_HEADERS);
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_OK);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_GetHeaderCount, my_HTTPHeaders_GetHeaderCount);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_GetHeader, my_HTTPHeaders_GetHeader);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_easy_init, my_curl_easy_init);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_easy_setopt_long, my_curl_easy_setopt_long);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_easy_setopt_ptr, my_curl_easy_setopt_ptr);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_easy_setopt_func, my_curl_easy_setopt_func);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_easy_getinfo_ptr, my_curl_easy_getinfo_ptr);
+    REGISTER_GLOBAL_MOCK_RETURN(curl_easy_strerror, "test error");
+    REGISTER_GLOBAL_MOCK_HOOK(curl_slist_append, my_curl_slist_append);
+    REGISTER_GLOBAL_MOCK_RETURN(curl_multi_init, TEST_MULTI);
+    REGISTER_GLOBAL_MOCK_RETURN(curl_multi_cleanup, CURLM_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(curl_multi_setopt_long, CURLM_OK);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_multi_setopt_ptr, my_curl_multi_setopt_ptr);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_multi_setopt_func, my_curl_multi_setopt_func);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_multi_add_handle, my_curl_multi_add_handle);
+    REGISTER_GLOBAL_MOCK_RETURN(curl_multi_remove_handle, CURLM_OK);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_multi_socket_action, my_curl_multi_socket_action);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_multi_info_read, my_curl_multi_info_read);
+    REGISTER_GLOBAL_MOCK_HOOK(poll, my_poll);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_version_info, my_curl_version_info);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+    (void)memset(g_easy_handles, 0, sizeof(g_easy_handles));
+    g_easy_handle_count = 0;
+    g_added_count = 0;
+    g_add_handle_result = CURLM_OK;
+    g_on_socket = NULL;
+    g_socket_data = NULL;
+    g_on_timer = NULL;
+    g_timer_data = NULL;
+    g_message_count = 0;
+    g_message_index = 0;
+    g_response_code = 200;
+    g_response_http_version = CURL_HTTP_VERSION_1_1;
+    g_version_info.features = CURL_VERSION_HTTP2;
+    g_poll_revents = 0;
+    g_complete_count = 0;
+    g_status_code = 0;
+    g_content[0] = '\0';
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* httpapi_async_create */
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_001: [ If `host_name` is NULL or `max_connections` is 0, `httpapi_async_create` shall fail and return NULL. ]*/
+TEST_FUNCTION(httpapi_async_create_with_NULL_host_name_fails)
+{
+    // arrange
+
+    // act
+    HTTPAPI_ASYNC_HANDLE result = httpapi_async_create(NULL, TEST_MAX_CONNECTIONS);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_001: [ If `host_name` is NULL or `max_connections` is 0, `httpapi_async_create` shall fail and return NULL. ]*/
+TEST_FUNCTION(httpapi_async_create_with_zero_max_connections_fails)
+{
+    // arrange
+
+    // act
+    HTTPAPI_ASYNC_HANDLE result = httpapi_async_create(TEST_HOST_NAME, 0);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_002: [ `httpapi_async_create` shall allocate a new instance, build the `https://host_name` URL, call `HTTPAPI_Init`, create the pending and active request lists and create a multi handle with `curl_multi_init`. ]*/
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_003: [ `httpapi_async_create` shall set `CURLMOPT_MAX_HOST_CONNECTIONS` to `max_connections`, with libcurl 7.43 or later `CURLMOPT_PIPELINING` to `CURLPIPE_MULTIPLEX`, and the socket and timer callbacks on the multi handle. ]*/
+TEST_FUNCTION(httpapi_async_create_succeeds)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE result;
+    setup_create_expected_calls();
+    STRICT_EXPECTED_CALL(curl_multi_setopt_long(TEST_MULTI, CURLMOPT_MAX_HOST_CONNECTIONS, TEST_MAX_CONNECTIONS));
+#if LIBCURL_VERSION_NUM >= 0x072B00
+    STRICT_EXPECTED_CALL(curl_multi_setopt_long(TEST_MULTI, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX));
+#endif
+    STRICT_EXPECTED_CALL(curl_multi_setopt_func(TEST_MULTI, CURLMOPT_SOCKETFUNCTION, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_multi_setopt_ptr(TEST_MULTI, CURLMOPT_SOCKETDATA, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_multi_setopt_func(TEST_MULTI, CURLMOPT_TIMERFUNCTION, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_multi_setopt_ptr(TEST_MULTI, CURLMOPT_TIMERDATA, IGNORED_PTR_ARG));
+
+    // act
+    result = httpapi_async_create(TEST_HOST_NAME, TEST_MAX_CONNECTIONS);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(g_on_socket);
+    ASSERT_IS_NOT_NULL(g_on_timer);
+    ASSERT_ARE_EQUAL(void_ptr, result, g_socket_data);
+    ASSERT_ARE_EQUAL(void_ptr, result, g_timer_data);
+
+    // cleanup
+    httpapi_async_destroy(result);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_004: [ If any error occurs, `httpapi_async_create` shall release what it created, fail and return NULL. ]*/
+TEST_FUNCTION(when_allocating_the_instance_fails_httpapi_async_create_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    // act
+    result = httpapi_async_create(TEST_HOST_NAME, TEST_MAX_CONNECTIONS);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_004: [ If any error occurs, `httpapi_async_create` shall release what it created, fail and return NULL. ]*/
+TEST_FUNCTION(when_HTTPAPI_Init_fails_httpapi_async_create_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof("https://" TEST_HOST_NAME)));
+    STRICT_EXPECTED_CALL(HTTPAPI_Init())
+        .SetReturn(HTTPAPI_INIT_FAILED);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = httpapi_async_create(TEST_HOST_NAME, TEST_MAX_CONNECTIONS);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_004: [ If any error occurs, `httpapi_async_create` shall release what it created, fail and return NULL. ]*/
+TEST_FUNCTION(when_curl_multi_init_fails_httpapi_async_create_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof("https://" TEST_HOST_NAME)));
+    STRICT_EXPECTED_CALL(HTTPAPI_Init());
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(curl_multi_init())
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPI_Deinit());
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = httpapi_async_create(TEST_HOST_NAME, TEST_MAX_CONNECTIONS);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_004: [ If any error occurs, `httpapi_async_create` shall release what it created, fail and return NULL. ]*/
+TEST_FUNCTION(when_curl_multi_setopt_fails_httpapi_async_create_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE result;
+    setup_create_expected_calls();
+    STRICT_EXPECTED_CALL(curl_multi_setopt_long(TEST_MULTI, CURLMOPT_MAX_HOST_CONNECTIONS, TEST_MAX_CONNECTIONS))
+        .SetReturn(CURLM_UNKNOWN_OPTION);
+    STRICT_EXPECTED_CALL(curl_multi_cleanup(TEST_MULTI));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPI_Deinit());
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = httpapi_async_create(TEST_HOST_NAME, TEST_MAX_CONNECTIONS);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* httpapi_async_destroy */
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_005: [ If `httpapi_async` is NULL, `httpapi_async_destroy` shall do nothing. ]*/
+TEST_FUNCTION(httpapi_async_destroy_with_NULL_does_nothing)
+{
+    // arrange
+
+    // act
+    httpapi_async_destroy(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_006: [ `httpapi_async_destroy` shall call `on_request_complete` with `HTTPAPI_ASYNC_CANCELLED` for the requests handed to curl and then for the queued ones, clean up the multi handle, call `HTTPAPI_Deinit` and free all the resources. ]*/
+TEST_FUNCTION(httpapi_async_destroy_frees_the_multi_handle)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    size_t i;
+    STRICT_EXPECTED_CALL(curl_multi_cleanup(TEST_MULTI));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPI_Deinit());
+    for (i = 0; i < 9; i++)
+    {
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    }
+
+    // act
+    httpapi_async_destroy(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_006: [ `httpapi_async_destroy` shall call `on_request_complete` with `HTTPAPI_ASYNC_CANCELLED` for the requests handed to curl and then for the queued ones, clean up the multi handle, call `HTTPAPI_Deinit` and free all the resources. ]*/
+TEST_FUNCTION(httpapi_async_destroy_cancels_the_requests_in_progress_and_queued)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(1, 2);
+    httpapi_async_dowork(httpapi_async);
+    ASSERT_ARE_EQUAL(size_t, 1, g_added_count);
+
+    // act
+    httpapi_async_destroy(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 2, g_complete_count);
+    ASSERT_ARE_EQUAL(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_CANCELLED, g_results[0]);
+    ASSERT_ARE_EQUAL(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_CANCELLED, g_results[1]);
+    ASSERT_ARE_EQUAL(void_ptr, &g_request_contexts[0], g_contexts[0]);
+    ASSERT_ARE_EQUAL(void_ptr, &g_request_contexts[1], g_contexts[1]);
+}
+
+/* httpapi_async_set_option */
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_007: [ If `httpapi_async`, `option_name` or `value` is NULL, `httpapi_async_set_option` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_set_option_with_NULL_handle_fails)
+{
+    // arrange
+    unsigned int timeout = 1000;
+
+    // act
+    int result = httpapi_async_set_option(NULL, OPTION_HTTP_TIMEOUT, &timeout);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_007: [ If `httpapi_async`, `option_name` or `value` is NULL, `httpapi_async_set_option` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_set_option_with_NULL_option_name_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    unsigned int timeout = 1000;
+    int result;
+
+    // act
+    result = httpapi_async_set_option(httpapi_async, NULL, &timeout);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_007: [ If `httpapi_async`, `option_name` or `value` is NULL, `httpapi_async_set_option` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_set_option_with_NULL_value_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    int result;
+
+    // act
+    result = httpapi_async_set_option(httpapi_async, OPTION_HTTP_TIMEOUT, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_008: [ `httpapi_async_set_option` shall save a copy of the `TrustedCerts`, `x509certificate`, `x509privatekey`, `x509EccCertificate` and `x509EccAliasKey` options, and the requests created afterwards shall add them to the TLS context through `CURLOPT_SSL_CTX_FUNCTION`. ]*/
+TEST_FUNCTION(httpapi_async_set_option_trusted_certs_sets_the_ssl_ctx_function_on_the_requests)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    const TEST_OPTION* ssl_ctx_data;
+    int result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof("certs")));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+
+    // act
+    result = httpapi_async_set_option(httpapi_async, OPTION_TRUSTED_CERT, "certs");
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL));
+    ASSERT_IS_NOT_NULL(find_option(0, CURLOPT_SSL_CTX_FUNCTION));
+    ssl_ctx_data = find_option(0, CURLOPT_SSL_CTX_DATA);
+    ASSERT_IS_NOT_NULL(ssl_ctx_data);
+    ASSERT_ARE_EQUAL(void_ptr, httpapi_async, ssl_ctx_data->ptr_value);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_008: [ `httpapi_async_set_option` shall save a copy of the `TrustedCerts`, `x509certificate`, `x509privatekey`, `x509EccCertificate` and `x509EccAliasKey` options, and the requests created afterwards shall add them to the TLS context through `CURLOPT_SSL_CTX_FUNCTION`. ]*/
+TEST_FUNCTION(httpapi_async_set_option_x509_credentials_succeeds)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+
+    // act
+    int certificate_result = httpapi_async_set_option(httpapi_async, SU_OPTION_X509_CERT, "certificate");
+    int private_key_result = httpapi_async_set_option(httpapi_async, SU_OPTION_X509_PRIVATE_KEY, "key");
+    int ecc_certificate_result = httpapi_async_set_option(httpapi_async, OPTION_X509_ECC_CERT, "ecc certificate");
+    int ecc_key_result = httpapi_async_set_option(httpapi_async, OPTION_X509_ECC_KEY, "ecc key");
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, certificate_result);
+    ASSERT_ARE_EQUAL(int, 0, private_key_result);
+    ASSERT_ARE_EQUAL(int, 0, ecc_certificate_result);
+    ASSERT_ARE_EQUAL(int, 0, ecc_key_result);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_008: [ `httpapi_async_set_option` shall save a copy of the `TrustedCerts`, `x509certificate`, `x509privatekey`, `x509EccCertificate` and `x509EccAliasKey` options, and the requests created afterwards shall add them to the TLS context through `CURLOPT_SSL_CTX_FUNCTION`. ]*/
+TEST_FUNCTION(without_certificates_the_requests_do_not_set_the_ssl_ctx_function)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 1);
+
+    // act
+
+    // assert
+    ASSERT_IS_NULL(find_option(0, CURLOPT_SSL_CTX_FUNCTION));
+    ASSERT_IS_NULL(find_option(0, CURLOPT_SSL_CTX_DATA));
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_009: [ The `timeout` option shall be read as an `unsigned int` number of milliseconds and set as `CURLOPT_TIMEOUT_MS` on the requests created afterwards, 0 meaning no timeout. ]*/
+TEST_FUNCTION(httpapi_async_set_option_timeout_sets_the_timeout_of_the_requests)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    unsigned int timeout = 1234;
+    const TEST_OPTION* timeout_option;
+    int result;
+
+    // act
+    result = httpapi_async_set_option(httpapi_async, OPTION_HTTP_TIMEOUT, &timeout);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL));
+    timeout_option = find_option(0, CURLOPT_TIMEOUT_MS);
+    ASSERT_IS_NOT_NULL(timeout_option);
+    ASSERT_ARE_EQUAL(long, 1234, timeout_option->long_value);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_009: [ The `timeout` option shall be read as an `unsigned int` number of milliseconds and set as `CURLOPT_TIMEOUT_MS` on the requests created afterwards, 0 meaning no timeout. ]*/
+TEST_FUNCTION(httpapi_async_set_option_timeout_0_does_not_set_a_timeout)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    unsigned int timeout = 0;
+    int result;
+
+    // act
+    result = httpapi_async_set_option(httpapi_async, OPTION_HTTP_TIMEOUT, &timeout);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL));
+    ASSERT_IS_NULL(find_option(0, CURLOPT_TIMEOUT_MS));
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_010: [ The `proxy_data` option shall be read as an `HTTP_PROXY_OPTIONS` and set as `CURLOPT_PROXY` (`host_address:port`) and `CURLOPT_PROXYUSERPWD` (`username:password`) on the requests created afterwards. ]*/
+TEST_FUNCTION(httpapi_async_set_option_proxy_data_sets_the_proxy_of_the_requests)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    HTTP_PROXY_OPTIONS proxy_options = { "proxy.test", 8888, "user", "password" };
+    const TEST_OPTION* proxy;
+    const TEST_OPTION* proxy_user_password;
+    int result;
+
+    // act
+    result = httpapi_async_set_option(httpapi_async, OPTION_HTTP_PROXY, &proxy_options);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL));
+    proxy = find_option(0, CURLOPT_PROXY);
+    proxy_user_password = find_option(0, CURLOPT_PROXYUSERPWD);
+    ASSERT_IS_NOT_NULL(proxy);
+    ASSERT_IS_NOT_NULL(proxy_user_password);
+    ASSERT_ARE_EQUAL(char_ptr, "proxy.test:8888", proxy->string_value);
+    ASSERT_ARE_EQUAL(char_ptr, "user:password", proxy_user_password->string_value);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_010: [ The `proxy_data` option shall be read as an `HTTP_PROXY_OPTIONS` and set as `CURLOPT_PROXY` (`host_address:port`) and `CURLOPT_PROXYUSERPWD` (`username:password`) on the requests created afterwards. ]*/
+TEST_FUNCTION(httpapi_async_set_option_proxy_data_without_credentials_does_not_set_the_proxy_credentials)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    HTTP_PROXY_OPTIONS proxy_options = { "proxy.test", 8888, NULL, NULL };
+    int result;
+
+    // act
+    result = httpapi_async_set_option(httpapi_async, OPTION_HTTP_PROXY, &proxy_options);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL));
+    ASSERT_IS_NOT_NULL(find_option(0, CURLOPT_PROXY));
+    ASSERT_IS_NULL(find_option(0, CURLOPT_PROXYUSERPWD));
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_011: [ If `host_address` is NULL, or only one of `username` and `password` is NULL, setting `proxy_data` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_set_option_proxy_data_without_host_address_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    HTTP_PROXY_OPTIONS proxy_options = { NULL, 8888, NULL, NULL };
+    int result;
+
+    // act
+    result = httpapi_async_set_option(httpapi_async, OPTION_HTTP_PROXY, &proxy_options);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_011: [ If `host_address` is NULL, or only one of `username` and `password` is NULL, setting `proxy_data` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_set_option_proxy_data_with_username_and_no_password_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    HTTP_PROXY_OPTIONS proxy_options = { "proxy.test", 8888, "user", NULL };
+    int result;
+
+    // act
+    result = httpapi_async_set_option(httpapi_async, OPTION_HTTP_PROXY, &proxy_options);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_012: [ The `CURLOPT_LOW_SPEED_LIMIT`, `CURLOPT_LOW_SPEED_TIME`, `CURLOPT_FRESH_CONNECT`, `CURLOPT_FORBID_REUSE` and `CURLOPT_VERBOSE` options shall be read as a `long` and set on the requests created afterwards. ]*/
+TEST_FUNCTION(httpapi_async_set_option_curl_options_are_set_on_the_requests)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    long low_speed_limit = 10;
+    long low_speed_time = 20;
+    long fresh_connect = 1;
+    long forbid_reuse = 1;
+    long verbose = 1;
+
+    // act
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_set_option(httpapi_async, OPTION_CURL_LOW_SPEED_LIMIT, &low_speed_limit));
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_set_option(httpapi_async, OPTION_CURL_LOW_SPEED_TIME, &low_speed_time));
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_set_option(httpapi_async, OPTION_CURL_FRESH_CONNECT, &fresh_connect));
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_set_option(httpapi_async, OPTION_CURL_FORBID_REUSE, &forbid_reuse));
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_set_option(httpapi_async, OPTION_CURL_VERBOSE, &verbose));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL));
+    ASSERT_ARE_EQUAL(long, 10, find_option(0, CURLOPT_LOW_SPEED_LIMIT)->long_value);
+    ASSERT_ARE_EQUAL(long, 20, find_option(0, CURLOPT_LOW_SPEED_TIME)->long_value);
+    ASSERT_ARE_EQUAL(long, 1, find_option(0, CURLOPT_FRESH_CONNECT)->long_value);
+    ASSERT_ARE_EQUAL(long, 1, find_option(0, CURLOPT_FORBID_REUSE)->long_value);
+    ASSERT_ARE_EQUAL(long, 1, find_option(0, CURLOPT_VERBOSE)->long_value);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_028: [ The `CURLOPT_HTTP_VERSION` option shall be read as a `long` and set on the requests created afterwards when it is `CURL_HTTP_VERSION_NONE`, `CURL_HTTP_VERSION_1_0`, `CURL_HTTP_VERSION_1_1` or, with libcurl 7.49 or later, `CURL_HTTP_VERSION_2_0`, `CURL_HTTP_VERSION_2TLS` or `CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE`; for any other value setting it shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_set_option_http_version_1_0_is_set_on_the_requests)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    long http_version = CURL_HTTP_VERSION_1_0;
+    int result;
+    g_version_info.features = 0;
+
+    // act
+    result = httpapi_async_set_option(httpapi_async, OPTION_CURL_HTTP_VERSION, &http_version);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL));
+    ASSERT_ARE_EQUAL(long, CURL_HTTP_VERSION_1_0, find_option(0, CURLOPT_HTTP_VERSION)->long_value);
+#if LIBCURL_VERSION_NUM >= 0x072B00
+    ASSERT_IS_NULL(find_option(0, CURLOPT_PIPEWAIT));
+#endif
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+#if LIBCURL_VERSION_NUM >= 0x073100
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_028: [ The `CURLOPT_HTTP_VERSION` option shall be read as a `long` and set on the requests created afterwards when it is `CURL_HTTP_VERSION_NONE`, `CURL_HTTP_VERSION_1_0`, `CURL_HTTP_VERSION_1_1` or, with libcurl 7.49 or later, `CURL_HTTP_VERSION_2_0`, `CURL_HTTP_VERSION_2TLS` or `CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE`; for any other value setting it shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_set_option_http_version_2TLS_checks_libcurl_for_HTTP_2)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    long http_version = CURL_HTTP_VERSION_2TLS;
+    int result;
+    STRICT_EXPECTED_CALL(curl_version_info(CURLVERSION_NOW));
+
+    // act
+    result = httpapi_async_set_option(httpapi_async, OPTION_CURL_HTTP_VERSION, &http_version);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+#endif
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_028: [ The `CURLOPT_HTTP_VERSION` option shall be read as a `long` and set on the requests created afterwards when it is `CURL_HTTP_VERSION_NONE`, `CURL_HTTP_VERSION_1_0`, `CURL_HTTP_VERSION_1_1` or, with libcurl 7.49 or later, `CURL_HTTP_VERSION_2_0`, `CURL_HTTP_VERSION_2TLS` or `CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE`; for any other value setting it shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_set_option_unknown_http_version_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    long unknown_version = 42;
+    int unknown_result;
+#if LIBCURL_VERSION_NUM >= 0x074200
+    long http_3 = CURL_HTTP_VERSION_3;
+    int http_3_result;
+#endif
+
+    // act
+    unknown_result = httpapi_async_set_option(httpapi_async, OPTION_CURL_HTTP_VERSION, &unknown_version);
+#if LIBCURL_VERSION_NUM >= 0x074200
+    http_3_result = httpapi_async_set_option(httpapi_async, OPTION_CURL_HTTP_VERSION, &http_3);
+#endif
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, unknown_result);
+#if LIBCURL_VERSION_NUM >= 0x074200
+    ASSERT_ARE_NOT_EQUAL(int, 0, http_3_result);
+#endif
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL));
+    ASSERT_ARE_EQUAL(long, CURL_HTTP_VERSION_1_1, find_option(0, CURLOPT_HTTP_VERSION)->long_value);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+#if LIBCURL_VERSION_NUM >= 0x073100
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_029: [ If `CURLOPT_HTTP_VERSION` asks for HTTP/2 and `curl_version_info` does not report `CURL_VERSION_HTTP2`, setting it shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_set_option_http_version_2_without_HTTP_2_in_libcurl_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    long http_version = CURL_HTTP_VERSION_2_0;
+    int result;
+    g_version_info.features = 0;
+    STRICT_EXPECTED_CALL(curl_version_info(CURLVERSION_NOW));
+
+    // act
+    result = httpapi_async_set_option(httpapi_async, OPTION_CURL_HTTP_VERSION, &http_version);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL));
+    ASSERT_ARE_EQUAL(long, CURL_HTTP_VERSION_1_1, find_option(0, CURLOPT_HTTP_VERSION)->long_value);
+    ASSERT_IS_NULL(find_option(0, CURLOPT_PIPEWAIT));
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+#endif
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_013: [ The `CURLOPT_SHARE` option shall be accepted and ignored, since the requests of an instance already share the caches of the multi handle. ]*/
+TEST_FUNCTION(httpapi_async_set_option_curl_share_succeeds)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    long share = 1;
+    int result;
+
+    // act
+    result = httpapi_async_set_option(httpapi_async, OPTION_CURL_SHARE, &share);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_014: [ For any other option `httpapi_async_set_option` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_set_option_with_unknown_option_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    int value = 1;
+    int result;
+
+    // act
+    result = httpapi_async_set_option(httpapi_async, "unknown", &value);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* httpapi_async_execute_request */
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_015: [ If `httpapi_async`, `relative_path`, `request_headers` or `on_request_complete` is NULL, `request_type` is not valid, or `content` is NULL while `content_length` is not 0, `httpapi_async_execute_request` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_execute_request_with_NULL_handle_fails)
+{
+    // arrange
+
+    // act
+    int result = httpapi_async_execute_request(NULL, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_015: [ If `httpapi_async`, `relative_path`, `request_headers` or `on_request_complete` is NULL, `request_type` is not valid, or `content` is NULL while `content_length` is not 0, `httpapi_async_execute_request` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_execute_request_with_invalid_arguments_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+
+    // act
+    int null_path_result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, NULL, TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL);
+    int null_headers_result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", NULL, NULL, 0, test_on_request_complete, NULL);
+    int null_content_result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_POST, "/path", TEST_REQUEST_HEADERS, NULL, 1, test_on_request_complete, NULL);
+    int null_callback_result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, NULL, NULL);
+    int invalid_type_result = httpapi_async_execute_request(httpapi_async, (HTTPAPI_REQUEST_TYPE)42, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, null_path_result);
+    ASSERT_ARE_NOT_EQUAL(int, 0, null_headers_result);
+    ASSERT_ARE_NOT_EQUAL(int, 0, null_content_result);
+    ASSERT_ARE_NOT_EQUAL(int, 0, null_callback_result);
+    ASSERT_ARE_NOT_EQUAL(int, 0, invalid_type_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_016: [ `httpapi_async_execute_request` shall create an easy handle with `curl_easy_init` for the URL of `relative_path` on the host, with a copy of the headers made with `curl_slist_append`, so `request_headers` is not used after it returns. ]*/
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_017: [ A GET request shall set `CURLOPT_HTTPGET`; any other request shall copy `content` into the easy handle with `CURLOPT_COPYPOSTFIELDS`, and a request other than POST shall also set `CURLOPT_CUSTOMREQUEST`. ]*/
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_018: [ `httpapi_async_execute_request` shall queue the request and return 0 without adding it to the multi handle. ]*/
+TEST_FUNCTION(httpapi_async_execute_request_GET_succeeds)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    int result;
+    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderCount(TEST_REQUEST_HEADERS, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(TEST_REQUEST_HEADERS, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_slist_append(NULL, TEST_HEADER));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_easy_init());
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(NULL));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /* the response content */
+    setup_get_request_options_expected_calls(TEST_EASY(0));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /* the pending request item */
+
+    // act
+    result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, "https://" TEST_HOST_NAME "/path", find_option(0, CURLOPT_URL)->string_value);
+    ASSERT_ARE_EQUAL(size_t, 0, g_added_count);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_017: [ A GET request shall set `CURLOPT_HTTPGET`; any other request shall copy `content` into the easy handle with `CURLOPT_COPYPOSTFIELDS`, and a request other than POST shall also set `CURLOPT_CUSTOMREQUEST`. ]*/
+TEST_FUNCTION(httpapi_async_execute_request_PUT_copies_the_content_and_sets_the_method)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    const unsigned char content[] = "body";
+    int result;
+
+    // act
+    result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_PUT, "/path", TEST_REQUEST_HEADERS, content, sizeof(content) - 1, test_on_request_complete, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_NULL(find_option(0, CURLOPT_HTTPGET));
+    ASSERT_ARE_EQUAL(long, 4, find_option(0, CURLOPT_POSTFIELDSIZE)->long_value);
+    ASSERT_ARE_EQUAL(char_ptr, "body", find_option(0, CURLOPT_COPYPOSTFIELDS)->string_value);
+    ASSERT_ARE_EQUAL(char_ptr, "PUT", find_option(0, CURLOPT_CUSTOMREQUEST)->string_value);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_017: [ A GET request shall set `CURLOPT_HTTPGET`; any other request shall copy `content` into the easy handle with `CURLOPT_COPYPOSTFIELDS`, and a request other than POST shall also set `CURLOPT_CUSTOMREQUEST`. ]*/
+TEST_FUNCTION(httpapi_async_execute_request_POST_does_not_set_the_method)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    int result;
+
+    // act
+    result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_POST, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(long, 0, find_option(0, CURLOPT_POSTFIELDSIZE)->long_value);
+    ASSERT_ARE_EQUAL(char_ptr, "", find_option(0, CURLOPT_COPYPOSTFIELDS)->string_value);
+    ASSERT_IS_NULL(find_option(0, CURLOPT_CUSTOMREQUEST));
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_019: [ If any error occurs, `httpapi_async_execute_request` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_curl_easy_init_fails_httpapi_async_execute_request_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    int result;
+    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderCount(TEST_REQUEST_HEADERS, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(TEST_REQUEST_HEADERS, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_slist_append(NULL, TEST_HEADER));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_easy_init())
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(curl_slist_free_all(TEST_HEADER_LIST));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_019: [ If any error occurs, `httpapi_async_execute_request` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_curl_slist_append_fails_httpapi_async_execute_request_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    int result;
+    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderCount(TEST_REQUEST_HEADERS, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(TEST_REQUEST_HEADERS, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_slist_append(NULL, TEST_HEADER))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_slist_free_all(NULL));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_019: [ If any error occurs, `httpapi_async_execute_request` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_setting_a_request_option_fails_httpapi_async_execute_request_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    int result;
+    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderCount(TEST_REQUEST_HEADERS, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(TEST_REQUEST_HEADERS, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_slist_append(NULL, TEST_HEADER));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_easy_init());
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(NULL));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof("https://" TEST_HOST_NAME "/path")));
+    STRICT_EXPECTED_CALL(curl_easy_setopt_ptr(TEST_EASY(0), CURLOPT_URL, IGNORED_PTR_ARG))
+        .SetReturn(CURLE_OUT_OF_MEMORY);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_easy_cleanup(TEST_EASY(0)));
+    STRICT_EXPECTED_CALL(curl_slist_free_all(TEST_HEADER_LIST));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(TEST_RESPONSE_HEADERS));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+#if LIBCURL_VERSION_NUM >= 0x073100
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_030: [ When `CURLOPT_HTTP_VERSION` asks for HTTP/2, `httpapi_async_execute_request` shall also set `CURLOPT_PIPEWAIT`, so the request waits for a connection it can multiplex on instead of opening a new one. ]*/
+TEST_FUNCTION(httpapi_async_execute_request_with_HTTP_2_waits_to_multiplex)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    long http_version = CURL_HTTP_VERSION_2TLS;
+    int result;
+    const TEST_OPTION* pipewait;
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_set_option(httpapi_async, OPTION_CURL_HTTP_VERSION, &http_version));
+
+    // act
+    result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(long, CURL_HTTP_VERSION_2TLS, find_option(0, CURLOPT_HTTP_VERSION)->long_value);
+    pipewait = find_option(0, CURLOPT_PIPEWAIT);
+    ASSERT_IS_NOT_NULL(pipewait);
+    ASSERT_ARE_EQUAL(long, 1, pipewait->long_value);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+#endif
+
+#if LIBCURL_VERSION_NUM >= 0x072B00
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_030: [ When `CURLOPT_HTTP_VERSION` asks for HTTP/2, `httpapi_async_execute_request` shall also set `CURLOPT_PIPEWAIT`, so the request waits for a connection it can multiplex on instead of opening a new one. ]*/
+TEST_FUNCTION(httpapi_async_execute_request_with_HTTP_1_1_does_not_wait_to_multiplex)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    int result;
+
+    // act
+    result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(long, CURL_HTTP_VERSION_1_1, find_option(0, CURLOPT_HTTP_VERSION)->long_value);
+    ASSERT_IS_NULL(find_option(0, CURLOPT_PIPEWAIT));
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+#endif
+
+/* httpapi_async_dowork */
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_020: [ If `httpapi_async` is NULL, `httpapi_async_dowork` shall do nothing. ]*/
+TEST_FUNCTION(httpapi_async_dowork_with_NULL_does_nothing)
+{
+    // arrange
+
+    // act
+    httpapi_async_dowork(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_021: [ `httpapi_async_dowork` shall add the queued requests, in order, to the multi handle with `curl_multi_add_handle` while fewer than `max_connections` requests are in progress, or fewer than 100 times `max_connections` once a request completed over HTTP/2, which libcurl 7.50 or later reports. ]*/
+TEST_FUNCTION(httpapi_async_dowork_adds_the_queued_requests_in_order_up_to_max_connections)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 3);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 2, g_added_count);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_EASY(0), g_added_handles[0]);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_EASY(1), g_added_handles[1]);
+    ASSERT_ARE_EQUAL(size_t, 0, g_complete_count);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_021: [ `httpapi_async_dowork` shall add the queued requests, in order, to the multi handle with `curl_multi_add_handle` while fewer than `max_connections` requests are in progress, or fewer than 100 times `max_connections` once a request completed over HTTP/2, which libcurl 7.50 or later reports. ]*/
+TEST_FUNCTION(httpapi_async_dowork_adds_the_next_queued_request_when_a_request_completes)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(1, 2);
+    httpapi_async_dowork(httpapi_async);
+    complete_transfer(0, CURLE_OK);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_complete_count);
+    ASSERT_ARE_EQUAL(size_t, 2, g_added_count);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_EASY(1), g_added_handles[1]);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+#if LIBCURL_VERSION_NUM >= 0x073200
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_021: [ `httpapi_async_dowork` shall add the queued requests, in order, to the multi handle with `curl_multi_add_handle` while fewer than `max_connections` requests are in progress, or fewer than 100 times `max_connections` once a request completed over HTTP/2, which libcurl 7.50 or later reports. ]*/
+TEST_FUNCTION(httpapi_async_dowork_adds_more_requests_than_max_connections_once_a_response_came_over_http2)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(1, 4);
+    httpapi_async_dowork(httpapi_async);
+    ASSERT_ARE_EQUAL(size_t, 1, g_added_count);
+    g_response_http_version = CURL_HTTP_VERSION_2_0;
+    complete_transfer(0, CURLE_OK);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_complete_count);
+    ASSERT_ARE_EQUAL(size_t, 4, g_added_count);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+#endif
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_022: [ If `curl_multi_add_handle` fails, `on_request_complete` shall be called with `HTTPAPI_ASYNC_ERROR`. ]*/
+TEST_FUNCTION(when_curl_multi_add_handle_fails_the_request_completes_with_error)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(1, 1);
+    g_add_handle_result = CURLM_OUT_OF_MEMORY;
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_complete_count);
+    ASSERT_ARE_EQUAL(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_ERROR, g_results[0]);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_023: [ `httpapi_async_dowork` shall `poll` the sockets curl asked to watch without blocking and call `curl_multi_socket_action` for each ready socket, and with `CURL_SOCKET_TIMEOUT` while the curl timer is armed. ]*/
+TEST_FUNCTION(httpapi_async_dowork_calls_curl_multi_socket_action_for_a_ready_socket)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    ASSERT_ARE_EQUAL(int, 0, g_on_socket(TEST_EASY(0), TEST_SOCKET, CURL_POLL_IN, g_socket_data, NULL));
+    g_poll_revents = POLLIN;
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(poll(IGNORED_PTR_ARG, 1, 0));
+    STRICT_EXPECTED_CALL(curl_multi_socket_action(TEST_MULTI, TEST_SOCKET, CURL_CSELECT_IN, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_multi_info_read(TEST_MULTI, IGNORED_PTR_ARG));
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_023: [ `httpapi_async_dowork` shall `poll` the sockets curl asked to watch without blocking and call `curl_multi_socket_action` for each ready socket, and with `CURL_SOCKET_TIMEOUT` while the curl timer is armed. ]*/
+TEST_FUNCTION(httpapi_async_dowork_does_not_call_curl_multi_socket_action_when_no_socket_is_ready)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    ASSERT_ARE_EQUAL(int, 0, g_on_socket(TEST_EASY(0), TEST_SOCKET, CURL_POLL_INOUT, g_socket_data, NULL));
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(poll(IGNORED_PTR_ARG, 1, 0));
+    STRICT_EXPECTED_CALL(curl_multi_info_read(TEST_MULTI, IGNORED_PTR_ARG));
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_023: [ `httpapi_async_dowork` shall `poll` the sockets curl asked to watch without blocking and call `curl_multi_socket_action` for each ready socket, and with `CURL_SOCKET_TIMEOUT` while the curl timer is armed. ]*/
+TEST_FUNCTION(httpapi_async_dowork_stops_polling_a_socket_curl_removed)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    ASSERT_ARE_EQUAL(int, 0, g_on_socket(TEST_EASY(0), TEST_SOCKET, CURL_POLL_IN, g_socket_data, NULL));
+    ASSERT_ARE_EQUAL(int, 0, g_on_socket(TEST_EASY(0), TEST_SOCKET, CURL_POLL_REMOVE, g_socket_data, NULL));
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(curl_multi_info_read(TEST_MULTI, IGNORED_PTR_ARG));
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_023: [ `httpapi_async_dowork` shall `poll` the sockets curl asked to watch without blocking and call `curl_multi_socket_action` for each ready socket, and with `CURL_SOCKET_TIMEOUT` while the curl timer is armed. ]*/
+TEST_FUNCTION(httpapi_async_dowork_calls_curl_multi_socket_action_while_the_timer_is_armed)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    ASSERT_ARE_EQUAL(int, 0, g_on_timer(TEST_MULTI, 10, g_timer_data));
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(curl_multi_socket_action(TEST_MULTI, CURL_SOCKET_TIMEOUT, 0, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_multi_info_read(TEST_MULTI, IGNORED_PTR_ARG));
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_023: [ `httpapi_async_dowork` shall `poll` the sockets curl asked to watch without blocking and call `curl_multi_socket_action` for each ready socket, and with `CURL_SOCKET_TIMEOUT` while the curl timer is armed. ]*/
+TEST_FUNCTION(httpapi_async_dowork_does_not_call_curl_multi_socket_action_once_the_timer_is_disarmed)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    ASSERT_ARE_EQUAL(int, 0, g_on_timer(TEST_MULTI, 10, g_timer_data));
+    ASSERT_ARE_EQUAL(int, 0, g_on_timer(TEST_MULTI, -1, g_timer_data));
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(curl_multi_info_read(TEST_MULTI, IGNORED_PTR_ARG));
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_024: [ When a transfer completes with `CURLE_OK`, `httpapi_async_dowork` shall call `on_request_complete` with `HTTPAPI_ASYNC_OK`, the response status code, headers and content. ]*/
+TEST_FUNCTION(httpapi_async_dowork_completes_a_finished_transfer_with_the_response)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 1);
+    httpapi_async_dowork(httpapi_async);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(TEST_RESPONSE_HEADERS, "Content-Type", "text/plain"));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(2)); /* the response content */
+    receive_response(0, "Content-Type:  text/plain \r\n", "hi");
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    g_response_code = 204;
+    complete_transfer(0, CURLE_OK);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_complete_count);
+    ASSERT_ARE_EQUAL(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_OK, g_results[0]);
+    ASSERT_ARE_EQUAL(void_ptr, &g_request_contexts[0], g_contexts[0]);
+    ASSERT_ARE_EQUAL(int, 204, (int)g_status_code);
+    ASSERT_ARE_EQUAL(char_ptr, "hi", g_content);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_024: [ When a transfer completes with `CURLE_OK`, `httpapi_async_dowork` shall call `on_request_complete` with `HTTPAPI_ASYNC_OK`, the response status code, headers and content. ]*/
+TEST_FUNCTION(the_status_line_is_not_added_to_the_response_headers)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 1);
+    httpapi_async_dowork(httpapi_async);
+    umock_c_reset_all_calls();
+
+    // act
+    receive_response(0, "HTTP/1.1 200 OK\r\n", "");
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_025: [ When a transfer completes with `CURLE_OPERATION_TIMEDOUT`, `on_request_complete` shall be called with `HTTPAPI_ASYNC_TIMEOUT`. ]*/
+TEST_FUNCTION(httpapi_async_dowork_completes_a_timed_out_transfer_with_timeout)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 1);
+    httpapi_async_dowork(httpapi_async);
+    complete_transfer(0, CURLE_OPERATION_TIMEDOUT);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_complete_count);
+    ASSERT_ARE_EQUAL(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_TIMEOUT, g_results[0]);
+    ASSERT_ARE_EQUAL(size_t, 1, g_added_count);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_026: [ When a transfer fails with any other error, the request shall be added to the multi handle again once. ]*/
+TEST_FUNCTION(httpapi_async_dowork_adds_a_failed_transfer_again)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 1);
+    httpapi_async_dowork(httpapi_async);
+    complete_transfer(0, CURLE_SEND_ERROR);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 0, g_complete_count);
+    ASSERT_ARE_EQUAL(size_t, 2, g_added_count);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_EASY(0), g_added_handles[1]);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_027: [ If a request that was already sent again fails, or its response could not be stored, `on_request_complete` shall be called with `HTTPAPI_ASYNC_ERROR`. ]*/
+TEST_FUNCTION(httpapi_async_dowork_completes_a_transfer_that_fails_twice_with_error)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 1);
+    httpapi_async_dowork(httpapi_async);
+    complete_transfer(0, CURLE_SEND_ERROR);
+    httpapi_async_dowork(httpapi_async);
+    complete_transfer(0, CURLE_RECV_ERROR);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_complete_count);
+    ASSERT_ARE_EQUAL(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_ERROR, g_results[0]);
+    ASSERT_ARE_EQUAL(size_t, 2, g_added_count);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_CURL_01_027: [ If a request that was already sent again fails, or its response could not be stored, `on_request_complete` shall be called with `HTTPAPI_ASYNC_ERROR`. ]*/
+TEST_FUNCTION(when_a_response_header_cannot_be_stored_the_request_completes_with_error_without_retrying)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 1);
+    httpapi_async_dowork(httpapi_async);
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(TEST_RESPONSE_HEADERS, "Content-Type", "text/plain"))
+        .SetReturn(HTTP_HEADERS_ALLOC_FAILED);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    receive_response(0, "Content-Type: text/plain\r\n", "");
+    complete_transfer(0, CURLE_WRITE_ERROR);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_complete_count);
+    ASSERT_ARE_EQUAL(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_ERROR, g_results[0]);
+    ASSERT_ARE_EQUAL(size_t, 1, g_added_count);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+END_TEST_SUITE(httpapi_async_curl_unittests)
@@ -0,0 +1,817 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xio.h"
+#include "azure_c_shared_utility/platform.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/httpheaders.h"
+#undef ENABLE_MOCKS
+
+#include "azure_c_shared_utility/httpapi_async.h"
+
+#define TEST_HOST_NAME "test.azure-devices.net"
+#define TEST_TLS_IO_INTERFACE_DESCRIPTION ((const IO_INTERFACE_DESCRIPTION*)0x4242)
+#define TEST_TICK_COUNTER ((TICK_COUNTER_HANDLE)0x4243)
+#define TEST_REQUEST_HEADERS ((HTTP_HEADERS_HANDLE)0x4244)
+#define TEST_MAX_CONNECTIONS 2
+#define TEST_MAX_TEST_CONNECTIONS 4
+
+static const char TEST_RESPONSE[] = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nhi";
+static const char TEST_CLOSE_RESPONSE[] = "HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+/* one entry per xio_create call, the XIO_HANDLE is the address of the entry */
+typedef struct TEST_CONNECTION_TAG
+{
+    ON_BYTES_RECEIVED on_bytes_received;
+    void* on_bytes_received_context;
+    ON_IO_ERROR on_io_error;
+    void* on_io_error_context;
+    char sent[256];
+    size_t send_count;
+    bool is_destroyed;
+} TEST_CONNECTION;
+
+static TEST_CONNECTION g_connections[TEST_MAX_TEST_CONNECTIONS];
+static size_t g_connection_count;
+static IO_OPEN_RESULT g_open_result;
+static tickcounter_ms_t g_now;
+static const char* g_last_option_name;
+
+static size_t g_complete_count;
+static HTTPAPI_ASYNC_RESULT g_results[TEST_MAX_TEST_CONNECTIONS];
+static unsigned int g_status_code;
+static char g_content[16];
+
+static XIO_HANDLE my_xio_create(const IO_INTERFACE_DESCRIPTION* io_interface_description, const void* io_create_parameters)
+{
+    XIO_HANDLE result;
+    (void)io_interface_description;
+    (void)io_create_parameters;
+
+    if (g_connection_count == TEST_MAX_TEST_CONNECTIONS)
+    {
+        result = NULL;
+    }
+    else
+    {
+        result = (XIO_HANDLE)&g_connections[g_connection_count++];
+    }
+
+    return result;
+}
+
+static void my_xio_destroy(XIO_HANDLE xio)
+{
+    ((TEST_CONNECTION*)xio)->is_destroyed = true;
+}
+
+static int my_xio_open(XIO_HANDLE xio, ON_IO_OPEN_COMPLETE on_io_open_complete, void* on_io_open_complete_context, ON_BYTES_RECEIVED on_bytes_received, void* on_bytes_received_context, ON_IO_ERROR on_io_error, void* on_io_error_context)
+{
+    TEST_CONNECTION* connection = (TEST_CONNECTION*)xio;
+    IO_OPEN_RESULT_DETAILED open_result;
+
+    connection->on_bytes_received = on_bytes_received;
+    connection->on_bytes_received_context = on_bytes_received_context;
+    connection->on_io_error = on_io_error;
+    connection->on_io_error_context = on_io_error_context;
+
+    open_result.result = g_open_result;
+    open_result.code = 0;
+    on_io_open_complete(on_io_open_complete_context, open_result);
+
+    return 0;
+}
+
+static int my_xio_send(XIO_HANDLE xio, const void* buffer, size_t size, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+{
+    TEST_CONNECTION* connection = (TEST_CONNECTION*)xio;
+    (void)on_send_complete;
+    (void)callback_context;
+
+    if (size < sizeof(connection->sent))
+    {
+        (void)memcpy(connection->sent, buffer, size);
+        connection->sent[size] = '\0';
+    }
+    connection->send_count++;
+
+    return 0;
+}
+
+static int my_xio_setoption(XIO_HANDLE xio, const char* optionName, const void* value)
+{
+    (void)xio;
+    (void)value;
+    g_last_option_name = optionName;
+    return 0;
+}
+
+static int my_tickcounter_get_current_ms(TICK_COUNTER_HANDLE tick_counter, tickcounter_ms_t* current_ms)
+{
+    (void)tick_counter;
+    *current_ms = g_now;
+    return 0;
+}
+
+static HTTP_HEADERS_HANDLE my_HTTPHeaders_Alloc(void)
+{
+    return (HTTP_HEADERS_HANDLE)malloc(1);
+}
+
+static void my_HTTPHeaders_Free(HTTP_HEADERS_HANDLE httpHeadersHandle)
+{
+    free(httpHeadersHandle);
+}
+
+static HTTP_HEADERS_RESULT my_HTTPHeaders_GetHeaderCount(HTTP_HEADERS_HANDLE httpHeadersHandle, size_t* headersCount)
+{
+    (void)httpHeadersHandle;
+    *headersCount = 1;
+    return HTTP_HEADERS_OK;
+}
+
+static HTTP_HEADERS_RESULT my_HTTPHeaders_GetHeaderNameValue(HTTP_HEADERS_HANDLE handle, size_t index, const char** name, const char** value)
+{
+    (void)handle;
+    (void)index;
+    *name = "Host";
+    *value = TEST_HOST_NAME;
+    return HTTP_HEADERS_OK;
+}
+
+static void test_on_request_complete(void* context, HTTPAPI_ASYNC_RESULT result, unsigned int status_code, HTTP_HEADERS_HANDLE response_headers, BUFFER_HANDLE response_content)
+{
+    (void)context;
+    (void)response_headers;
+
+    if (g_complete_count < TEST_MAX_TEST_CONNECTIONS)
+    {
+        g_results[g_complete_count] = result;
+    }
+    g_complete_count++;
+    g_status_code = status_code;
+    g_content[0] = '\0';
+    if ((response_content != NULL) && (BUFFER_length(response_content) < sizeof(g_content)))
+    {
+        (void)memcpy(g_content, BUFFER_u_char(response_content), BUFFER_length(response_content));
+        g_content[BUFFER_length(response_content)] = '\0';
+    }
+}
+
+static void receive(size_t connection_index, const char* response)
+{
+    TEST_CONNECTION* connection = &g_connections[connection_index];
+    connection->on_bytes_received(connection->on_bytes_received_context, (const unsigned char*)response, strlen(response));
+}
+
+static HTTPAPI_ASYNC_HANDLE create_with_requests(size_t max_connections, size_t request_count)
+{
+    size_t i;
+    HTTPAPI_ASYNC_HANDLE result = httpapi_async_create(TEST_HOST_NAME, max_connections);
+    ASSERT_IS_NOT_NULL(result);
+
+    for (i = 0; i < request_count; i++)
+    {
+        int execute_result = httpapi_async_execute_request(result, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL);
+        ASSERT_ARE_EQUAL(int, 0, execute_result);
+    }
+
+    umock_c_reset_all_calls();
+    return result;
+}
+
+TEST_DEFINE_ENUM_TYPE(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+BEGIN_TEST_SUITE(httpapi_async_unittests)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    int result;
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT);
+    REGISTER_UMOCK_ALIAS_TYPE(XIO_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_IO_OPEN_COMPLETE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_BYTES_RECEIVED, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_IO_ERROR, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_SEND_COMPLETE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(TICK_COUNTER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_HANDLE, void*);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_HOOK(xio_create, my_xio_create);
+    REGISTER_GLOBAL_MOCK_HOOK(xio_destroy, my_xio_destroy);
+    REGISTER_GLOBAL_MOCK_HOOK(xio_open, my_xio_open);
+    REGISTER_GLOBAL_MOCK_HOOK(xio_send, my_xio_send);
+    REGISTER_GLOBAL_MOCK_HOOK(xio_setoption, my_xio_setoption);
+    REGISTER_GLOBAL_MOCK_RETURN(platform_get_default_tlsio, TEST_TLS_IO_INTERFACE_DESCRIPTION);
+    REGISTER_GLOBAL_MOCK_RETURN(tickcounter_create, TEST_TICK_COUNTER);
+    REGISTER_GLOBAL_MOCK_HOOK(tickcounter_get_current_ms, my_tickcounter_get_current_ms);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Alloc, my_HTTPHeaders_Alloc);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Free, my_HTTPHeaders_Free);
+    REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_OK);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_GetHeaderCount, my_HTTPHeaders_GetHeaderCount);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_GetHeaderNameValue, my_HTTPHeaders_GetHeaderNameValue);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+    (void)memset(g_connections, 0, sizeof(g_connections));
+    g_connection_count = 0;
+    g_open_result = IO_OPEN_OK;
+    g_now = 0;
+    g_last_option_name = NULL;
+    g_complete_count = 0;
+    g_status_code = 0;
+    g_content[0] = '\0';
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* httpapi_async_create */
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_001: [ If `host_name` is NULL or `max_connections` is 0, `httpapi_async_create` shall fail and return NULL. ]*/
+TEST_FUNCTION(httpapi_async_create_with_NULL_host_name_fails)
+{
+    // arrange
+
+    // act
+    HTTPAPI_ASYNC_HANDLE result = httpapi_async_create(NULL, TEST_MAX_CONNECTIONS);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_001: [ If `host_name` is NULL or `max_connections` is 0, `httpapi_async_create` shall fail and return NULL. ]*/
+TEST_FUNCTION(httpapi_async_create_with_zero_max_connections_fails)
+{
+    // arrange
+
+    // act
+    HTTPAPI_ASYNC_HANDLE result = httpapi_async_create(TEST_HOST_NAME, 0);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_002: [ `httpapi_async_create` shall allocate a new instance, copy `host_name` and create the request queue, the retry queue, the connection list and a tick counter. ]*/
+TEST_FUNCTION(httpapi_async_create_succeeds)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(TEST_HOST_NAME)));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /* the request queue */
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /* the retry queue */
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /* the connection list */
+    STRICT_EXPECTED_CALL(tickcounter_create());
+
+    // act
+    result = httpapi_async_create(TEST_HOST_NAME, TEST_MAX_CONNECTIONS);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(result);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_003: [ If any error occurs, `httpapi_async_create` shall fail and return NULL. ]*/
+TEST_FUNCTION(when_tickcounter_create_fails_httpapi_async_create_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(TEST_HOST_NAME)));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_create())
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = httpapi_async_create(TEST_HOST_NAME, TEST_MAX_CONNECTIONS);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_003: [ If any error occurs, `httpapi_async_create` shall fail and return NULL. ]*/
+TEST_FUNCTION(when_allocating_the_instance_fails_httpapi_async_create_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    // act
+    result = httpapi_async_create(TEST_HOST_NAME, TEST_MAX_CONNECTIONS);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* httpapi_async_destroy */
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_004: [ If `httpapi_async` is NULL, `httpapi_async_destroy` shall do nothing. ]*/
+TEST_FUNCTION(httpapi_async_destroy_with_NULL_does_nothing)
+{
+    // arrange
+
+    // act
+    httpapi_async_destroy(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_005: [ `httpapi_async_destroy` shall close all the connections, call `on_request_complete` with `HTTPAPI_ASYNC_CANCELLED` for every request that did not complete, and free all the resources. ]*/
+TEST_FUNCTION(httpapi_async_destroy_cancels_the_requests_in_progress_and_queued)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(1, 2);
+    httpapi_async_dowork(httpapi_async);
+
+    // act
+    httpapi_async_destroy(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 2, g_complete_count);
+    ASSERT_ARE_EQUAL(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_CANCELLED, g_results[0]);
+    ASSERT_ARE_EQUAL(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_CANCELLED, g_results[1]);
+    ASSERT_IS_TRUE(g_connections[0].is_destroyed);
+}
+
+/* httpapi_async_set_option */
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_006: [ If `httpapi_async`, `option_name` or `value` is NULL, `httpapi_async_set_option` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_set_option_with_NULL_httpapi_async_fails)
+{
+    // arrange
+
+    // act
+    int result = httpapi_async_set_option(NULL, "TrustedCerts", "certs");
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_006: [ If `httpapi_async`, `option_name` or `value` is NULL, `httpapi_async_set_option` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_set_option_with_NULL_value_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+
+    // act
+    int result = httpapi_async_set_option(httpapi_async, "TrustedCerts", NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_007: [ `httpapi_async_set_option` shall save a copy of the `TrustedCerts`, `x509certificate`, `x509privatekey`, `x509EccCertificate` and `x509EccAliasKey` options, to be passed to the connections created afterwards. ]*/
+/* Tests_SRS_HTTPAPI_ASYNC_01_015: [ A new connection shall be created with `xio_create` over `platform_get_default_tlsio` for port 443 of `host_name`, and shall be passed the saved options. ]*/
+TEST_FUNCTION(httpapi_async_set_option_TrustedCerts_is_passed_to_new_connections)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 1);
+    int result = httpapi_async_set_option(httpapi_async, "TrustedCerts", "certs");
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_connection_count);
+    ASSERT_ARE_EQUAL(char_ptr, "TrustedCerts", g_last_option_name);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_009: [ For any other option `httpapi_async_set_option` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_set_option_with_unknown_option_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+
+    // act
+    int result = httpapi_async_set_option(httpapi_async, "proxy_data", "proxy");
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* httpapi_async_execute_request */
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_010: [ If `httpapi_async`, `relative_path`, `request_headers` or `on_request_complete` is NULL, `request_type` is not valid, or `content` is NULL while `content_length` is not 0, `httpapi_async_execute_request` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_execute_request_with_NULL_httpapi_async_fails)
+{
+    // arrange
+
+    // act
+    int result = httpapi_async_execute_request(NULL, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_010: [ If `httpapi_async`, `relative_path`, `request_headers` or `on_request_complete` is NULL, `request_type` is not valid, or `content` is NULL while `content_length` is not 0, `httpapi_async_execute_request` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(httpapi_async_execute_request_with_NULL_content_and_non_zero_length_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+
+    // act
+    int result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_POST, "/path", TEST_REQUEST_HEADERS, NULL, 1, test_on_request_complete, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_012: [ `httpapi_async_execute_request` shall queue the request and return 0 without doing any IO. ]*/
+TEST_FUNCTION(httpapi_async_execute_request_queues_without_IO)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+
+    // act
+    int result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 0, g_connection_count);
+    ASSERT_ARE_EQUAL(size_t, 0, g_complete_count);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_011: [ `httpapi_async_execute_request` shall format the request line, the headers and the content into one buffer, so `request_headers` and `content` are not used after it returns. ]*/
+TEST_FUNCTION(httpapi_async_execute_request_sends_the_whole_request_at_once)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    int result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_POST, "/path", TEST_REQUEST_HEADERS, (const unsigned char*)"body", 4, test_on_request_complete, NULL);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_connections[0].send_count);
+    ASSERT_ARE_EQUAL(char_ptr, "POST /path HTTP/1.1\r\nHost: " TEST_HOST_NAME "\r\n\r\nbody", g_connections[0].sent);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_013: [ If any error occurs, `httpapi_async_execute_request` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_getting_the_request_headers_fails_httpapi_async_execute_request_fails)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 0);
+    int result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderCount(TEST_REQUEST_HEADERS, IGNORED_PTR_ARG))
+        .SetReturn(HTTP_HEADERS_ERROR);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* httpapi_async_dowork */
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_023: [ If `httpapi_async` is NULL, `httpapi_async_dowork` shall do nothing. ]*/
+TEST_FUNCTION(httpapi_async_dowork_with_NULL_does_nothing)
+{
+    // arrange
+
+    // act
+    httpapi_async_dowork(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_014: [ `httpapi_async_dowork` shall send the queued requests, in order, on idle connections first and on new connections while there are fewer than `max_connections`. ]*/
+TEST_FUNCTION(httpapi_async_dowork_opens_at_most_max_connections)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 3);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, TEST_MAX_CONNECTIONS, g_connection_count);
+    ASSERT_ARE_EQUAL(size_t, 1, g_connections[0].send_count);
+    ASSERT_ARE_EQUAL(size_t, 1, g_connections[1].send_count);
+    ASSERT_ARE_EQUAL(size_t, 0, g_complete_count);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_017: [ When a response is complete, `httpapi_async_dowork` shall call `on_request_complete` with `HTTPAPI_ASYNC_OK`, the status code, the response headers and the response content, and shall keep the connection for the next request. ]*/
+TEST_FUNCTION(httpapi_async_dowork_completes_a_received_response)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 1);
+    httpapi_async_dowork(httpapi_async);
+    receive(0, TEST_RESPONSE);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_complete_count);
+    ASSERT_ARE_EQUAL(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_OK, g_results[0]);
+    ASSERT_ARE_EQUAL(int, 200, (int)g_status_code);
+    ASSERT_ARE_EQUAL(char_ptr, "hi", g_content);
+    ASSERT_IS_FALSE(g_connections[0].is_destroyed);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_014: [ `httpapi_async_dowork` shall send the queued requests, in order, on idle connections first and on new connections while there are fewer than `max_connections`. ]*/
+TEST_FUNCTION(httpapi_async_dowork_sends_queued_requests_on_the_connection_that_freed_up)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 3);
+    httpapi_async_dowork(httpapi_async);
+    receive(0, TEST_RESPONSE);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, TEST_MAX_CONNECTIONS, g_connection_count);
+    ASSERT_ARE_EQUAL(size_t, 2, g_connections[0].send_count);
+    ASSERT_ARE_EQUAL(size_t, 1, g_complete_count);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_022: [ If the response carries a `Connection: close` header, the connection shall be closed after the request completes instead of being reused. ]*/
+TEST_FUNCTION(httpapi_async_dowork_does_not_reuse_a_connection_closed_by_the_server)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(1, 2);
+    httpapi_async_dowork(httpapi_async);
+    receive(0, TEST_CLOSE_RESPONSE);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_complete_count);
+    ASSERT_ARE_EQUAL(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_OK, g_results[0]);
+    ASSERT_IS_TRUE(g_connections[0].is_destroyed);
+    ASSERT_ARE_EQUAL(size_t, 2, g_connection_count);
+    ASSERT_ARE_EQUAL(size_t, 1, g_connections[1].send_count);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_018: [ If a connection that already completed a request fails, its request shall be queued again without counting as a retry. ]*/
+TEST_FUNCTION(httpapi_async_dowork_sends_again_the_request_of_a_reused_connection_that_failed)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(1, 2);
+    httpapi_async_dowork(httpapi_async);
+    receive(0, TEST_RESPONSE);
+    httpapi_async_dowork(httpapi_async);
+    g_connections[0].on_io_error(g_connections[0].on_io_error_context);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_complete_count);
+    ASSERT_IS_TRUE(g_connections[0].is_destroyed);
+    ASSERT_ARE_EQUAL(size_t, 1, g_connections[1].send_count);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_019: [ Otherwise, if a connection fails, its request shall be queued again once. ]*/
+/* Tests_SRS_HTTPAPI_ASYNC_01_020: [ If the connection of a request that was already queued again fails, `on_request_complete` shall be called with `HTTPAPI_ASYNC_ERROR`. ]*/
+TEST_FUNCTION(httpapi_async_dowork_retries_a_request_once_then_fails_it)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(1, 1);
+    g_open_result = IO_OPEN_ERROR;
+    httpapi_async_dowork(httpapi_async);
+    ASSERT_ARE_EQUAL(size_t, 0, g_complete_count);
+    ASSERT_ARE_EQUAL(size_t, 2, g_connection_count);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_complete_count);
+    ASSERT_ARE_EQUAL(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_ERROR, g_results[0]);
+    ASSERT_ARE_EQUAL(size_t, 2, g_connection_count);
+    ASSERT_IS_TRUE(g_connections[1].is_destroyed);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_025: [ A request queued again shall be sent before all the requests that were queued with `httpapi_async_execute_request`, so a failed connection does not move it behind requests made after it. ]*/
+TEST_FUNCTION(httpapi_async_dowork_sends_a_retried_request_before_the_queued_ones)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(1, 0);
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/first", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL));
+    ASSERT_ARE_EQUAL(int, 0, httpapi_async_execute_request(httpapi_async, HTTPAPI_REQUEST_GET, "/second", TEST_REQUEST_HEADERS, NULL, 0, test_on_request_complete, NULL));
+    httpapi_async_dowork(httpapi_async);
+    g_connections[0].on_io_error(g_connections[0].on_io_error_context);
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 0, g_complete_count);
+    ASSERT_IS_TRUE(g_connections[0].is_destroyed);
+    ASSERT_ARE_EQUAL(size_t, 1, g_connections[1].send_count);
+    ASSERT_IS_NOT_NULL(strstr(g_connections[1].sent, "GET /first "));
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_016: [ If there are no connections and creating one fails, the first queued request shall be completed with `HTTPAPI_ASYNC_ERROR`. ]*/
+TEST_FUNCTION(when_creating_a_connection_fails_httpapi_async_dowork_fails_the_request)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 1);
+    g_connection_count = TEST_MAX_TEST_CONNECTIONS;
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_complete_count);
+    ASSERT_ARE_EQUAL(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_ERROR, g_results[0]);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_008: [ The `timeout` option shall be read as an `unsigned int` number of milliseconds, 0 meaning no timeout. ]*/
+/* Tests_SRS_HTTPAPI_ASYNC_01_021: [ If the `timeout` option is set and a request has been in progress for longer than that many milliseconds, `on_request_complete` shall be called with `HTTPAPI_ASYNC_TIMEOUT` and the connection shall be closed. ]*/
+TEST_FUNCTION(httpapi_async_dowork_times_out_a_request_after_the_timeout)
+{
+    // arrange
+    unsigned int timeout = 1000;
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 1);
+    int result = httpapi_async_set_option(httpapi_async, "timeout", &timeout);
+    httpapi_async_dowork(httpapi_async);
+    g_now = 1000;
+    httpapi_async_dowork(httpapi_async);
+    ASSERT_ARE_EQUAL(size_t, 0, g_complete_count);
+    g_now = 1001;
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_complete_count);
+    ASSERT_ARE_EQUAL(HTTPAPI_ASYNC_RESULT, HTTPAPI_ASYNC_TIMEOUT, g_results[0]);
+    ASSERT_IS_TRUE(g_connections[0].is_destroyed);
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+/* Tests_SRS_HTTPAPI_ASYNC_01_024: [ `httpapi_async_dowork` shall call `xio_dowork` on every connection, idle ones included so that connections dropped by the server are noticed. ]*/
+TEST_FUNCTION(httpapi_async_dowork_calls_xio_dowork_on_idle_connections)
+{
+    // arrange
+    HTTPAPI_ASYNC_HANDLE httpapi_async = create_with_requests(TEST_MAX_CONNECTIONS, 1);
+    httpapi_async_dowork(httpapi_async);
+    receive(0, TEST_RESPONSE);
+    httpapi_async_dowork(httpapi_async);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(xio_dowork((XIO_HANDLE)&g_connections[0]));
+
+    // act
+    httpapi_async_dowork(httpapi_async);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    httpapi_async_destroy(httpapi_async);
+}
+
+END_TEST_SUITE(httpapi_async_unittests)
@@ -0,0 +1,1108 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <cstdarg>
+#else
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdarg.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+
+/* the setopt and getinfo functions are variadic, so they are defined below on top of mockable functions, one per argument type */
+#define CURL_DISABLE_TYPECHECK
+#include "curl/curl.h"
+
+typedef void(*TEST_CURL_FUNCTION)(void);
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/httpheaders.h"
+#include "azure_c_shared_utility/buffer_.h"
+#ifdef USE_OPENSSL
+#include "azure_c_shared_utility/x509_openssl.h"
+#endif
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    MOCKABLE_FUNCTION(, CURLcode, curl_global_init, long, flags);
+    MOCKABLE_FUNCTION(, void, curl_global_cleanup);
+    MOCKABLE_FUNCTION(, CURL*, curl_easy_init);
+    MOCKABLE_FUNCTION(, void, curl_easy_cleanup, CURL*, curl);
+    MOCKABLE_FUNCTION(, CURLcode, curl_easy_setopt_long, CURL*, curl, CURLoption, option, long, value);
+    MOCKABLE_FUNCTION(, CURLcode, curl_easy_setopt_ptr, CURL*, curl, CURLoption, option, void*, value);
+    MOCKABLE_FUNCTION(, CURLcode, curl_easy_setopt_func, CURL*, curl, CURLoption, option, TEST_CURL_FUNCTION, value);
+    MOCKABLE_FUNCTION(, CURLcode, curl_easy_getinfo_ptr, CURL*, curl, CURLINFO, info, void*, value);
+    MOCKABLE_FUNCTION(, CURLcode, curl_easy_perform, CURL*, curl);
+    MOCKABLE_FUNCTION(, const char*, curl_easy_strerror, CURLcode, error);
+    MOCKABLE_FUNCTION(, struct curl_slist*, curl_slist_append, struct curl_slist*, list, const char*, string);
+    MOCKABLE_FUNCTION(, void, curl_slist_free_all, struct curl_slist*, list);
+    MOCKABLE_FUNCTION(, CURLSH*, curl_share_init);
+    MOCKABLE_FUNCTION(, CURLSHcode, curl_share_cleanup, CURLSH*, share);
+    MOCKABLE_FUNCTION(, CURLSHcode, curl_share_setopt_lock_data, CURLSH*, share, CURLSHoption, option, int, value);
+    MOCKABLE_FUNCTION(, CURLSHcode, curl_share_setopt_func, CURLSH*, share, CURLSHoption, option, TEST_CURL_FUNCTION, value);
+    MOCKABLE_FUNCTION(, curl_version_info_data*, curl_version_info, CURLversion, stamp);
+#ifdef __cplusplus
+}
+#endif
+#undef ENABLE_MOCKS
+
+#include "azure_c_shared_utility/httpapi.h"
+#include "azure_c_shared_utility/shared_util_options.h"
+
+CURLcode curl_easy_setopt(CURL* curl, CURLoption option, ...)
+{
+    CURLcode result;
+    va_list args;
+
+    va_start(args, option);
+    if (option < CURLOPTTYPE_OBJECTPOINT)
+    {
+        result = curl_easy_setopt_long(curl, option, va_arg(args, long));
+    }
+    else if (option < CURLOPTTYPE_FUNCTIONPOINT)
+    {
+        result = curl_easy_setopt_ptr(curl, option, va_arg(args, void*));
+    }
+    else if (option < CURLOPTTYPE_OFF_T)
+    {
+        result = curl_easy_setopt_func(curl, option, va_arg(args, TEST_CURL_FUNCTION));
+    }
+    else
+    {
+        result = CURLE_UNKNOWN_OPTION;
+    }
+    va_end(args);
+
+    return result;
+}
+
+CURLcode curl_easy_getinfo(CURL* curl, CURLINFO info, ...)
+{
+    CURLcode result;
+    va_list args;
+
+    va_start(args, info);
+    result = curl_easy_getinfo_ptr(curl, info, va_arg(args, void*));
+    va_end(args);
+
+    return result;
+}
+
+CURLSHcode curl_share_setopt(CURLSH* share, CURLSHoption option, ...)
+{
+    CURLSHcode result;
+    va_list args;
+
+    va_start(args, option);
+    if ((option == CURLSHOPT_SHARE) || (option == CURLSHOPT_UNSHARE))
+    {
+        result = curl_share_setopt_lock_data(share, option, va_arg(args, int));
+    }
+    else if ((option == CURLSHOPT_LOCKFUNC) || (option == CURLSHOPT_UNLOCKFUNC))
+    {
+        result = curl_share_setopt_func(share, option, va_arg(args, TEST_CURL_FUNCTION));
+    }
+    else
+    {
+        result = CURLSHE_BAD_OPTION;
+    }
+    va_end(args);
+
+    return result;
+}
+
+#define TEST_HOST_NAME "test.azure-devices.net"
+#define TEST_CURL ((CURL*)0x4242)
+#define TEST_SHARE ((CURLSH*)0x4243)
+#define TEST_REQUEST_HEADERS ((HTTP_HEADERS_HANDLE)0x4244)
+#define TEST_MAX_OPTIONS 64
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+/* the value of one curl_easy_setopt call */
+typedef struct TEST_OPTION_TAG
+{
+    CURLoption option;
+    long long_value;
+    void* ptr_value;
+} TEST_OPTION;
+
+static TEST_OPTION g_options[TEST_MAX_OPTIONS];
+static size_t g_option_count;
+static CURLoption g_failing_option;
+static int g_locks[CURL_LOCK_DATA_LAST];
+static size_t g_lock_count;
+static curl_lock_function g_lock_function;
+static curl_unlock_function g_unlock_function;
+static curl_version_info_data g_version_info;
+
+#define TEST_LOCK(data) ((LOCK_HANDLE)&g_locks[data])
+
+static CURLcode record_option(CURLoption option, long long_value, void* ptr_value)
+{
+    CURLcode result;
+
+    if (option == g_failing_option)
+    {
+        result = CURLE_UNKNOWN_OPTION;
+    }
+    else
+    {
+        if (g_option_count < TEST_MAX_OPTIONS)
+        {
+            g_options[g_option_count].option = option;
+            g_options[g_option_count].long_value = long_value;
+            g_options[g_option_count].ptr_value = ptr_value;
+            g_option_count++;
+        }
+        result = CURLE_OK;
+    }
+
+    return result;
+}
+
+/* returns the last value set for the option, NULL if it was not set */
+static const TEST_OPTION* find_option(CURLoption option)
+{
+    const TEST_OPTION* result = NULL;
+    size_t i;
+
+    for (i = 0; i < g_option_count; i++)
+    {
+        if (g_options[i].option == option)
+        {
+            result = &g_options[i];
+        }
+    }
+
+    return result;
+}
+
+static CURLcode my_curl_easy_setopt_long(CURL* curl, CURLoption option, long value)
+{
+    (void)curl;
+    return record_option(option, value, NULL);
+}
+
+static CURLcode my_curl_easy_setopt_ptr(CURL* curl, CURLoption option, void* value)
+{
+    (void)curl;
+    return record_option(option, 0, value);
+}
+
+static CURLcode my_curl_easy_setopt_func(CURL* curl, CURLoption option, TEST_CURL_FUNCTION value)
+{
+    (void)curl;
+    (void)value;
+    return record_option(option, 0, NULL);
+}
+
+static CURLcode my_curl_easy_getinfo_ptr(CURL* curl, CURLINFO info, void* value)
+{
+    CURLcode result;
+    (void)curl;
+
+    if (info == CURLINFO_RESPONSE_CODE)
+    {
+        *(long*)value = 200;
+        result = CURLE_OK;
+    }
+    else
+    {
+        result = CURLE_UNKNOWN_OPTION;
+    }
+
+    return result;
+}
+
+static CURLSHcode my_curl_share_setopt_func(CURLSH* share, CURLSHoption option, TEST_CURL_FUNCTION value)
+{
+    (void)share;
+    if (option == CURLSHOPT_LOCKFUNC)
+    {
+        g_lock_function = (curl_lock_function)value;
+    }
+    else
+    {
+        g_unlock_function = (curl_unlock_function)value;
+    }
+    return CURLSHE_OK;
+}
+
+static LOCK_HANDLE my_Lock_Init(void)
+{
+    LOCK_HANDLE result;
+
+    if (g_lock_count == CURL_LOCK_DATA_LAST)
+    {
+        result = NULL;
+    }
+    else
+    {
+        result = TEST_LOCK(g_lock_count++);
+    }
+
+    return result;
+}
+
+static curl_version_info_data* my_curl_version_info(CURLversion stamp)
+{
+    (void)stamp;
+    return &g_version_info;
+}
+
+static HTTP_HEADERS_RESULT my_HTTPHeaders_GetHeaderCount(HTTP_HEADERS_HANDLE httpHeadersHandle, size_t* headersCount)
+{
+    (void)httpHeadersHandle;
+    *headersCount = 0;
+    return HTTP_HEADERS_OK;
+}
+
+static void setup_Lock_Init_expected_calls(void)
+{
+    size_t i;
+    for (i = 0; i < CURL_LOCK_DATA_LAST; i++)
+    {
+        STRICT_EXPECTED_CALL(Lock_Init());
+    }
+}
+
+static void setup_Lock_Deinit_expected_calls(size_t lock_count)
+{
+    size_t i;
+    for (i = 0; i < lock_count; i++)
+    {
+        STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK(i)));
+    }
+}
+
+static HTTPAPI_RESULT execute_get_request(HTTP_HANDLE handle)
+{
+    unsigned int status_code;
+    return HTTPAPI_ExecuteRequest(handle, HTTPAPI_REQUEST_GET, "/path", TEST_REQUEST_HEADERS, NULL, 0, &status_code, NULL, NULL);
+}
+
+TEST_DEFINE_ENUM_TYPE(HTTPAPI_RESULT, HTTPAPI_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTPAPI_RESULT, HTTPAPI_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(LOCK_RESULT, LOCK_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+BEGIN_TEST_SUITE(httpapi_curl_unittests)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    int result;
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_TYPE(HTTPAPI_RESULT, HTTPAPI_RESULT);
+    REGISTER_TYPE(LOCK_RESULT, LOCK_RESULT);
+    REGISTER_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(TEST_CURL_FUNCTION, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(CURLcode, int);
+    REGISTER_UMOCK_ALIAS_TYPE(CURLSHcode, int);
+    REGISTER_UMOCK_ALIAS_TYPE(CURLoption, int);
+    REGISTER_UMOCK_ALIAS_TYPE(CURLSHoption, int);
+    REGISTER_UMOCK_ALIAS_TYPE(CURLINFO, int);
+    REGISTER_UMOCK_ALIAS_TYPE(CURLversion, int);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_HOOK(Lock_Init, my_Lock_Init);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Deinit, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_GetHeaderCount, my_HTTPHeaders_GetHeaderCount);
+    REGISTER_GLOBAL_MOCK_RETURN(curl_global_init, CURLE_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(curl_easy_init, TEST_CURL);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_easy_setopt_long, my_curl_easy_setopt_long);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_easy_setopt_ptr, my_curl_easy_setopt_ptr);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_easy_setopt_func, my_curl_easy_setopt_func);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_easy_getinfo_ptr, my_curl_easy_getinfo_ptr);
+    REGISTER_GLOBAL_MOCK_RETURN(curl_easy_perform, CURLE_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(curl_easy_strerror, "test error");
+    REGISTER_GLOBAL_MOCK_RETURN(curl_share_init, TEST_SHARE);
+    REGISTER_GLOBAL_MOCK_RETURN(curl_share_cleanup, CURLSHE_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(curl_share_setopt_lock_data, CURLSHE_OK);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_share_setopt_func, my_curl_share_setopt_func);
+    REGISTER_GLOBAL_MOCK_HOOK(curl_version_info, my_curl_version_info);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+    g_option_count = 0;
+    g_failing_option = CURLOPT_LASTENTRY;
+    g_lock_count = 0;
+    g_lock_function = NULL;
+    g_unlock_function = NULL;
+    g_version_info.features = CURL_VERSION_HTTP2;
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* HTTPAPI_Init */
+
+/* Tests_SRS_HTTPAPI_CURL_01_001: [ On its first call, `HTTPAPI_Init` shall call `curl_global_init` and create the shared cache: one lock per `curl_lock_data` with `Lock_Init`, and a share handle with `curl_share_init`. ]*/
+/* Tests_SRS_HTTPAPI_CURL_01_002: [ `HTTPAPI_Init` shall set `CURLSHOPT_LOCKFUNC` and `CURLSHOPT_UNLOCKFUNC` on the share handle and share only `CURL_LOCK_DATA_DNS` and `CURL_LOCK_DATA_SSL_SESSION`. ]*/
+TEST_FUNCTION(HTTPAPI_Init_creates_the_shared_cache)
+{
+    // arrange
+    HTTPAPI_RESULT result;
+    STRICT_EXPECTED_CALL(curl_global_init(CURL_GLOBAL_NOTHING));
+    setup_Lock_Init_expected_calls();
+    STRICT_EXPECTED_CALL(curl_share_init());
+    STRICT_EXPECTED_CALL(curl_share_setopt_func(TEST_SHARE, CURLSHOPT_LOCKFUNC, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_share_setopt_func(TEST_SHARE, CURLSHOPT_UNLOCKFUNC, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_share_setopt_lock_data(TEST_SHARE, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS));
+    STRICT_EXPECTED_CALL(curl_share_setopt_lock_data(TEST_SHARE, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION));
+
+    // act
+    result = HTTPAPI_Init();
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(g_lock_function);
+    ASSERT_IS_NOT_NULL(g_unlock_function);
+
+    // cleanup
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_003: [ If `Lock_Init`, `curl_share_init` or `curl_share_setopt` fails, `HTTPAPI_Init` shall release what it created for the shared cache and still succeed; the handles then do not share their caches. ]*/
+TEST_FUNCTION(when_Lock_Init_fails_HTTPAPI_Init_releases_the_locks_and_succeeds)
+{
+    // arrange
+    HTTPAPI_RESULT result;
+    STRICT_EXPECTED_CALL(curl_global_init(CURL_GLOBAL_NOTHING));
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(Lock_Init())
+        .SetReturn(NULL);
+    setup_Lock_Deinit_expected_calls(2);
+
+    // act
+    result = HTTPAPI_Init();
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_003: [ If `Lock_Init`, `curl_share_init` or `curl_share_setopt` fails, `HTTPAPI_Init` shall release what it created for the shared cache and still succeed; the handles then do not share their caches. ]*/
+TEST_FUNCTION(when_curl_share_init_fails_HTTPAPI_Init_releases_the_locks_and_succeeds)
+{
+    // arrange
+    HTTPAPI_RESULT result;
+    STRICT_EXPECTED_CALL(curl_global_init(CURL_GLOBAL_NOTHING));
+    setup_Lock_Init_expected_calls();
+    STRICT_EXPECTED_CALL(curl_share_init())
+        .SetReturn(NULL);
+    setup_Lock_Deinit_expected_calls(CURL_LOCK_DATA_LAST);
+
+    // act
+    result = HTTPAPI_Init();
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_003: [ If `Lock_Init`, `curl_share_init` or `curl_share_setopt` fails, `HTTPAPI_Init` shall release what it created for the shared cache and still succeed; the handles then do not share their caches. ]*/
+TEST_FUNCTION(when_setting_the_lock_function_fails_HTTPAPI_Init_releases_the_shared_cache_and_succeeds)
+{
+    // arrange
+    HTTPAPI_RESULT result;
+    STRICT_EXPECTED_CALL(curl_global_init(CURL_GLOBAL_NOTHING));
+    setup_Lock_Init_expected_calls();
+    STRICT_EXPECTED_CALL(curl_share_init());
+    STRICT_EXPECTED_CALL(curl_share_setopt_func(TEST_SHARE, CURLSHOPT_LOCKFUNC, IGNORED_PTR_ARG))
+        .SetReturn(CURLSHE_BAD_OPTION);
+    STRICT_EXPECTED_CALL(curl_share_cleanup(TEST_SHARE));
+    setup_Lock_Deinit_expected_calls(CURL_LOCK_DATA_LAST);
+
+    // act
+    result = HTTPAPI_Init();
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_003: [ If `Lock_Init`, `curl_share_init` or `curl_share_setopt` fails, `HTTPAPI_Init` shall release what it created for the shared cache and still succeed; the handles then do not share their caches. ]*/
+TEST_FUNCTION(when_sharing_the_DNS_cache_fails_HTTPAPI_Init_releases_the_shared_cache_and_succeeds)
+{
+    // arrange
+    HTTPAPI_RESULT result;
+    STRICT_EXPECTED_CALL(curl_global_init(CURL_GLOBAL_NOTHING));
+    setup_Lock_Init_expected_calls();
+    STRICT_EXPECTED_CALL(curl_share_init());
+    STRICT_EXPECTED_CALL(curl_share_setopt_func(TEST_SHARE, CURLSHOPT_LOCKFUNC, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_share_setopt_func(TEST_SHARE, CURLSHOPT_UNLOCKFUNC, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_share_setopt_lock_data(TEST_SHARE, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS))
+        .SetReturn(CURLSHE_NOMEM);
+    STRICT_EXPECTED_CALL(curl_share_cleanup(TEST_SHARE));
+    setup_Lock_Deinit_expected_calls(CURL_LOCK_DATA_LAST);
+
+    // act
+    result = HTTPAPI_Init();
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_003: [ If `Lock_Init`, `curl_share_init` or `curl_share_setopt` fails, `HTTPAPI_Init` shall release what it created for the shared cache and still succeed; the handles then do not share their caches. ]*/
+TEST_FUNCTION(when_sharing_the_TLS_sessions_fails_HTTPAPI_Init_releases_the_shared_cache_and_succeeds)
+{
+    // arrange
+    HTTPAPI_RESULT result;
+    STRICT_EXPECTED_CALL(curl_global_init(CURL_GLOBAL_NOTHING));
+    setup_Lock_Init_expected_calls();
+    STRICT_EXPECTED_CALL(curl_share_init());
+    STRICT_EXPECTED_CALL(curl_share_setopt_func(TEST_SHARE, CURLSHOPT_LOCKFUNC, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_share_setopt_func(TEST_SHARE, CURLSHOPT_UNLOCKFUNC, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(curl_share_setopt_lock_data(TEST_SHARE, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS));
+    STRICT_EXPECTED_CALL(curl_share_setopt_lock_data(TEST_SHARE, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION))
+        .SetReturn(CURLSHE_NOT_BUILT_IN);
+    STRICT_EXPECTED_CALL(curl_share_cleanup(TEST_SHARE));
+    setup_Lock_Deinit_expected_calls(CURL_LOCK_DATA_LAST);
+
+    // act
+    result = HTTPAPI_Init();
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_004: [ If `curl_global_init` fails, `HTTPAPI_Init` shall fail and return `HTTPAPI_INIT_FAILED`. ]*/
+TEST_FUNCTION(when_curl_global_init_fails_HTTPAPI_Init_fails)
+{
+    // arrange
+    HTTPAPI_RESULT result;
+    STRICT_EXPECTED_CALL(curl_global_init(CURL_GLOBAL_NOTHING))
+        .SetReturn(CURLE_FAILED_INIT);
+
+    // act
+    result = HTTPAPI_Init();
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_INIT_FAILED, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_005: [ The following calls to `HTTPAPI_Init` shall only count the users and return `HTTPAPI_OK`. ]*/
+TEST_FUNCTION(HTTPAPI_Init_a_second_time_does_not_create_another_shared_cache)
+{
+    // arrange
+    HTTPAPI_RESULT result;
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    umock_c_reset_all_calls();
+
+    // act
+    result = HTTPAPI_Init();
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HTTPAPI_Deinit();
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_006: [ The lock function of the share handle shall call `Lock` on the lock of the `curl_lock_data` being locked, and the unlock function shall call `Unlock` on it. ]*/
+TEST_FUNCTION(the_lock_function_locks_the_lock_of_the_data)
+{
+    // arrange
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK(CURL_LOCK_DATA_DNS)));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK(CURL_LOCK_DATA_SSL_SESSION)));
+
+    // act
+    g_lock_function(TEST_CURL, CURL_LOCK_DATA_DNS, CURL_LOCK_ACCESS_SINGLE, NULL);
+    g_lock_function(TEST_CURL, CURL_LOCK_DATA_SSL_SESSION, CURL_LOCK_ACCESS_SHARED, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_006: [ The lock function of the share handle shall call `Lock` on the lock of the `curl_lock_data` being locked, and the unlock function shall call `Unlock` on it. ]*/
+TEST_FUNCTION(the_unlock_function_unlocks_the_lock_of_the_data)
+{
+    // arrange
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK(CURL_LOCK_DATA_SSL_SESSION)));
+
+    // act
+    g_unlock_function(TEST_CURL, CURL_LOCK_DATA_SSL_SESSION, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_006: [ The lock function of the share handle shall call `Lock` on the lock of the `curl_lock_data` being locked, and the unlock function shall call `Unlock` on it. ]*/
+TEST_FUNCTION(when_Lock_fails_the_lock_function_returns)
+{
+    // arrange
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK(CURL_LOCK_DATA_DNS)))
+        .SetReturn(LOCK_ERROR);
+
+    // act
+    g_lock_function(TEST_CURL, CURL_LOCK_DATA_DNS, CURL_LOCK_ACCESS_SINGLE, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HTTPAPI_Deinit();
+}
+
+/* HTTPAPI_Deinit */
+
+/* Tests_SRS_HTTPAPI_CURL_01_007: [ When its last user calls `HTTPAPI_Deinit`, it shall release the share handle with `curl_share_cleanup`, release the locks with `Lock_Deinit` and call `curl_global_cleanup`. ]*/
+TEST_FUNCTION(HTTPAPI_Deinit_releases_the_shared_cache)
+{
+    // arrange
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(curl_share_cleanup(TEST_SHARE));
+    setup_Lock_Deinit_expected_calls(CURL_LOCK_DATA_LAST);
+    STRICT_EXPECTED_CALL(curl_global_cleanup());
+
+    // act
+    HTTPAPI_Deinit();
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_007: [ When its last user calls `HTTPAPI_Deinit`, it shall release the share handle with `curl_share_cleanup`, release the locks with `Lock_Deinit` and call `curl_global_cleanup`. ]*/
+TEST_FUNCTION(HTTPAPI_Deinit_keeps_the_shared_cache_while_there_are_other_users)
+{
+    // arrange
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    umock_c_reset_all_calls();
+
+    // act
+    HTTPAPI_Deinit();
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_007: [ When its last user calls `HTTPAPI_Deinit`, it shall release the share handle with `curl_share_cleanup`, release the locks with `Lock_Deinit` and call `curl_global_cleanup`. ]*/
+TEST_FUNCTION(HTTPAPI_Deinit_without_a_shared_cache_only_calls_curl_global_cleanup)
+{
+    // arrange
+    STRICT_EXPECTED_CALL(curl_global_init(CURL_GLOBAL_NOTHING));
+    setup_Lock_Init_expected_calls();
+    STRICT_EXPECTED_CALL(curl_share_init())
+        .SetReturn(NULL);
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(curl_global_cleanup());
+
+    // act
+    HTTPAPI_Deinit();
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_008: [ If `curl_share_cleanup` fails because a handle that was not closed still uses the share, `HTTPAPI_Deinit` shall not release the locks. ]*/
+TEST_FUNCTION(when_curl_share_cleanup_fails_HTTPAPI_Deinit_does_not_release_the_locks)
+{
+    // arrange
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(curl_share_cleanup(TEST_SHARE))
+        .SetReturn(CURLSHE_IN_USE);
+    STRICT_EXPECTED_CALL(curl_global_cleanup());
+
+    // act
+    HTTPAPI_Deinit();
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* HTTPAPI_ExecuteRequest */
+
+/* Tests_SRS_HTTPAPI_CURL_01_010: [ `HTTPAPI_ExecuteRequest` shall set `CURLOPT_SHARE` to NULL when there is no share handle, when the handle did not opt in with `OPTION_CURL_SHARE`, or when it uses x509 credentials or `TrustedCerts`, since curl cannot tell apart the TLS sessions that use the certificates installed by the TLS context callback. ]*/
+/* Tests_SRS_HTTPAPI_CURL_01_013: [ `OPTION_CURL_SHARE` shall be read as a `long`: any value other than 0 attaches the handle to the shared cache on its next request, 0 detaches it again. Handles are not attached until they set the option. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest_does_not_attach_the_handle_by_default)
+{
+    // arrange
+    HTTP_HANDLE handle;
+    HTTPAPI_RESULT result;
+    const TEST_OPTION* share;
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    handle = HTTPAPI_CreateConnection(TEST_HOST_NAME);
+    ASSERT_IS_NOT_NULL(handle);
+
+    // act
+    result = execute_get_request(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    share = find_option(CURLOPT_SHARE);
+    ASSERT_IS_NOT_NULL(share);
+    ASSERT_IS_NULL(share->ptr_value);
+    ASSERT_IS_NULL(find_option(CURLOPT_MAXCONNECTS));
+
+    // cleanup
+    HTTPAPI_CloseConnection(handle);
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_009: [ When the handle opted in with `OPTION_CURL_SHARE`, `HTTPAPI_ExecuteRequest` shall attach the easy handle to the share handle with `CURLOPT_SHARE`. ]*/
+/* Tests_SRS_HTTPAPI_CURL_01_013: [ `OPTION_CURL_SHARE` shall be read as a `long`: any value other than 0 attaches the handle to the shared cache on its next request, 0 detaches it again. Handles are not attached until they set the option. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest_after_opting_in_attaches_the_handle_to_the_shared_cache)
+{
+    // arrange
+    HTTP_HANDLE handle;
+    HTTPAPI_RESULT result;
+    long use_shared_cache = 1;
+    const TEST_OPTION* share;
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    handle = HTTPAPI_CreateConnection(TEST_HOST_NAME);
+    ASSERT_IS_NOT_NULL(handle);
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_SetOption(handle, OPTION_CURL_SHARE, &use_shared_cache));
+
+    // act
+    result = execute_get_request(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    share = find_option(CURLOPT_SHARE);
+    ASSERT_IS_NOT_NULL(share);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_SHARE, share->ptr_value);
+
+    // cleanup
+    HTTPAPI_CloseConnection(handle);
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_010: [ `HTTPAPI_ExecuteRequest` shall set `CURLOPT_SHARE` to NULL when there is no share handle, when the handle did not opt in with `OPTION_CURL_SHARE`, or when it uses x509 credentials or `TrustedCerts`, since curl cannot tell apart the TLS sessions that use the certificates installed by the TLS context callback. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest_without_a_shared_cache_detaches_the_handle)
+{
+    // arrange
+    HTTP_HANDLE handle;
+    HTTPAPI_RESULT result;
+    long use_shared_cache = 1;
+    const TEST_OPTION* share;
+    STRICT_EXPECTED_CALL(curl_global_init(CURL_GLOBAL_NOTHING));
+    setup_Lock_Init_expected_calls();
+    STRICT_EXPECTED_CALL(curl_share_init())
+        .SetReturn(NULL);
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    handle = HTTPAPI_CreateConnection(TEST_HOST_NAME);
+    ASSERT_IS_NOT_NULL(handle);
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_SetOption(handle, OPTION_CURL_SHARE, &use_shared_cache));
+
+    // act
+    result = execute_get_request(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    share = find_option(CURLOPT_SHARE);
+    ASSERT_IS_NOT_NULL(share);
+    ASSERT_IS_NULL(share->ptr_value);
+
+    // cleanup
+    HTTPAPI_CloseConnection(handle);
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_010: [ `HTTPAPI_ExecuteRequest` shall set `CURLOPT_SHARE` to NULL when there is no share handle, when the handle did not opt in with `OPTION_CURL_SHARE`, or when it uses x509 credentials or `TrustedCerts`, since curl cannot tell apart the TLS sessions that use the certificates installed by the TLS context callback. ]*/
+/* Tests_SRS_HTTPAPI_CURL_01_013: [ `OPTION_CURL_SHARE` shall be read as a `long`: any value other than 0 attaches the handle to the shared cache on its next request, 0 detaches it again. Handles are not attached until they set the option. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest_after_opting_out_again_detaches_the_handle)
+{
+    // arrange
+    HTTP_HANDLE handle;
+    HTTPAPI_RESULT result;
+    long use_shared_cache = 1;
+    const TEST_OPTION* share;
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    handle = HTTPAPI_CreateConnection(TEST_HOST_NAME);
+    ASSERT_IS_NOT_NULL(handle);
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_SetOption(handle, OPTION_CURL_SHARE, &use_shared_cache));
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, execute_get_request(handle));
+    use_shared_cache = 0;
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_SetOption(handle, OPTION_CURL_SHARE, &use_shared_cache));
+
+    // act
+    result = execute_get_request(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    share = find_option(CURLOPT_SHARE);
+    ASSERT_IS_NOT_NULL(share);
+    ASSERT_IS_NULL(share->ptr_value);
+
+    // cleanup
+    HTTPAPI_CloseConnection(handle);
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_010: [ `HTTPAPI_ExecuteRequest` shall set `CURLOPT_SHARE` to NULL when there is no share handle, when the handle did not opt in with `OPTION_CURL_SHARE`, or when it uses x509 credentials or `TrustedCerts`, since curl cannot tell apart the TLS sessions that use the certificates installed by the TLS context callback. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest_with_trusted_certs_detaches_the_handle)
+{
+    // arrange
+    HTTP_HANDLE handle;
+    HTTPAPI_RESULT result;
+    long use_shared_cache = 1;
+    const TEST_OPTION* share;
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    handle = HTTPAPI_CreateConnection(TEST_HOST_NAME);
+    ASSERT_IS_NOT_NULL(handle);
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_SetOption(handle, OPTION_CURL_SHARE, &use_shared_cache));
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_SetOption(handle, "TrustedCerts", "certs"));
+
+    // act
+    result = execute_get_request(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    share = find_option(CURLOPT_SHARE);
+    ASSERT_IS_NOT_NULL(share);
+    ASSERT_IS_NULL(share->ptr_value);
+
+    // cleanup
+    HTTPAPI_CloseConnection(handle);
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_010: [ `HTTPAPI_ExecuteRequest` shall set `CURLOPT_SHARE` to NULL when there is no share handle, when the handle did not opt in with `OPTION_CURL_SHARE`, or when it uses x509 credentials or `TrustedCerts`, since curl cannot tell apart the TLS sessions that use the certificates installed by the TLS context callback. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest_with_an_x509_certificate_detaches_the_handle)
+{
+    // arrange
+    HTTP_HANDLE handle;
+    HTTPAPI_RESULT result;
+    long use_shared_cache = 1;
+    const TEST_OPTION* share;
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    handle = HTTPAPI_CreateConnection(TEST_HOST_NAME);
+    ASSERT_IS_NOT_NULL(handle);
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_SetOption(handle, OPTION_CURL_SHARE, &use_shared_cache));
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_SetOption(handle, SU_OPTION_X509_CERT, "certificate"));
+
+    // act
+    result = execute_get_request(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    share = find_option(CURLOPT_SHARE);
+    ASSERT_IS_NOT_NULL(share);
+    ASSERT_IS_NULL(share->ptr_value);
+
+    // cleanup
+    HTTPAPI_CloseConnection(handle);
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_012: [ If setting `CURLOPT_SHARE` fails, `HTTPAPI_ExecuteRequest` shall fail and return `HTTPAPI_SET_OPTION_FAILED`. ]*/
+TEST_FUNCTION(when_setting_CURLOPT_SHARE_fails_HTTPAPI_ExecuteRequest_fails)
+{
+    // arrange
+    HTTP_HANDLE handle;
+    HTTPAPI_RESULT result;
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    handle = HTTPAPI_CreateConnection(TEST_HOST_NAME);
+    ASSERT_IS_NOT_NULL(handle);
+    g_failing_option = CURLOPT_SHARE;
+
+    // act
+    result = execute_get_request(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_SET_OPTION_FAILED, result);
+    ASSERT_IS_NULL(find_option(CURLOPT_HTTPGET));
+
+    // cleanup
+    HTTPAPI_CloseConnection(handle);
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_018: [ `HTTPAPI_ExecuteRequest` shall set `CURLOPT_HTTP_VERSION` to the version set with `OPTION_CURL_HTTP_VERSION`, or to `CURL_HTTP_VERSION_1_1` when the option was not set. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest_asks_for_HTTP_1_1_by_default)
+{
+    // arrange
+    HTTP_HANDLE handle;
+    HTTPAPI_RESULT result;
+    const TEST_OPTION* http_version;
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    handle = HTTPAPI_CreateConnection(TEST_HOST_NAME);
+    ASSERT_IS_NOT_NULL(handle);
+
+    // act
+    result = execute_get_request(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    http_version = find_option(CURLOPT_HTTP_VERSION);
+    ASSERT_IS_NOT_NULL(http_version);
+    ASSERT_ARE_EQUAL(long, CURL_HTTP_VERSION_1_1, http_version->long_value);
+
+    // cleanup
+    HTTPAPI_CloseConnection(handle);
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_015: [ `OPTION_CURL_HTTP_VERSION` shall be read as a `long` and used by the next requests of the handle when it is `CURL_HTTP_VERSION_NONE`, `CURL_HTTP_VERSION_1_0`, `CURL_HTTP_VERSION_1_1`, `CURL_HTTP_VERSION_2_0`, `CURL_HTTP_VERSION_2TLS` or `CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE`. ]*/
+/* Tests_SRS_HTTPAPI_CURL_01_018: [ `HTTPAPI_ExecuteRequest` shall set `CURLOPT_HTTP_VERSION` to the version set with `OPTION_CURL_HTTP_VERSION`, or to `CURL_HTTP_VERSION_1_1` when the option was not set. ]*/
+TEST_FUNCTION(HTTPAPI_SetOption_HTTP_2_is_used_by_the_next_request)
+{
+    // arrange
+    HTTP_HANDLE handle;
+    HTTPAPI_RESULT result;
+    long version = CURL_HTTP_VERSION_2TLS;
+    const TEST_OPTION* http_version;
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    handle = HTTPAPI_CreateConnection(TEST_HOST_NAME);
+    ASSERT_IS_NOT_NULL(handle);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(curl_version_info(CURLVERSION_NOW));
+
+    // act
+    result = HTTPAPI_SetOption(handle, OPTION_CURL_HTTP_VERSION, &version);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, execute_get_request(handle));
+    http_version = find_option(CURLOPT_HTTP_VERSION);
+    ASSERT_IS_NOT_NULL(http_version);
+    ASSERT_ARE_EQUAL(long, CURL_HTTP_VERSION_2TLS, http_version->long_value);
+
+    // cleanup
+    HTTPAPI_CloseConnection(handle);
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_015: [ `OPTION_CURL_HTTP_VERSION` shall be read as a `long` and used by the next requests of the handle when it is `CURL_HTTP_VERSION_NONE`, `CURL_HTTP_VERSION_1_0`, `CURL_HTTP_VERSION_1_1`, `CURL_HTTP_VERSION_2_0`, `CURL_HTTP_VERSION_2TLS` or `CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE`. ]*/
+TEST_FUNCTION(HTTPAPI_SetOption_HTTP_1_0_does_not_check_the_libcurl_features)
+{
+    // arrange
+    HTTP_HANDLE handle;
+    HTTPAPI_RESULT result;
+    long version = CURL_HTTP_VERSION_1_0;
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    handle = HTTPAPI_CreateConnection(TEST_HOST_NAME);
+    ASSERT_IS_NOT_NULL(handle);
+    umock_c_reset_all_calls();
+    g_version_info.features = 0;
+
+    // act
+    result = HTTPAPI_SetOption(handle, OPTION_CURL_HTTP_VERSION, &version);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HTTPAPI_CloseConnection(handle);
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_016: [ For any other value of `OPTION_CURL_HTTP_VERSION`, `HTTPAPI_SetOption` shall fail and return `HTTPAPI_INVALID_ARG`. ]*/
+TEST_FUNCTION(HTTPAPI_SetOption_with_an_unknown_HTTP_version_fails)
+{
+    // arrange
+    HTTP_HANDLE handle;
+    HTTPAPI_RESULT result;
+    long version = 42;
+    const TEST_OPTION* http_version;
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    handle = HTTPAPI_CreateConnection(TEST_HOST_NAME);
+    ASSERT_IS_NOT_NULL(handle);
+
+    // act
+    result = HTTPAPI_SetOption(handle, OPTION_CURL_HTTP_VERSION, &version);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, execute_get_request(handle));
+    http_version = find_option(CURLOPT_HTTP_VERSION);
+    ASSERT_IS_NOT_NULL(http_version);
+    ASSERT_ARE_EQUAL(long, CURL_HTTP_VERSION_1_1, http_version->long_value);
+
+    // cleanup
+    HTTPAPI_CloseConnection(handle);
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_016: [ For any other value of `OPTION_CURL_HTTP_VERSION`, `HTTPAPI_SetOption` shall fail and return `HTTPAPI_INVALID_ARG`. ]*/
+TEST_FUNCTION(HTTPAPI_SetOption_HTTP_3_fails)
+{
+    // arrange
+    HTTP_HANDLE handle;
+    HTTPAPI_RESULT result;
+    long version = CURL_HTTP_VERSION_3;
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    handle = HTTPAPI_CreateConnection(TEST_HOST_NAME);
+    ASSERT_IS_NOT_NULL(handle);
+
+    // act
+    result = HTTPAPI_SetOption(handle, OPTION_CURL_HTTP_VERSION, &version);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_INVALID_ARG, result);
+
+    // cleanup
+    HTTPAPI_CloseConnection(handle);
+    HTTPAPI_Deinit();
+}
+
+/* Tests_SRS_HTTPAPI_CURL_01_017: [ If `OPTION_CURL_HTTP_VERSION` asks for HTTP/2 and `curl_version_info` does not report `CURL_VERSION_HTTP2`, `HTTPAPI_SetOption` shall fail and return `HTTPAPI_ERROR`. ]*/
+TEST_FUNCTION(HTTPAPI_SetOption_HTTP_2_without_HTTP_2_in_libcurl_fails)
+{
+    // arrange
+    HTTP_HANDLE handle;
+    HTTPAPI_RESULT result;
+    long version = CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE;
+    const TEST_OPTION* http_version;
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, HTTPAPI_Init());
+    handle = HTTPAPI_CreateConnection(TEST_HOST_NAME);
+    ASSERT_IS_NOT_NULL(handle);
+    g_version_info.features = 0;
+
+    // act
+    result = HTTPAPI_SetOption(handle, OPTION_CURL_HTTP_VERSION, &version);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_ERROR, result);
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, execute_get_request(handle));
+    http_version = find_option(CURLOPT_HTTP_VERSION);
+    ASSERT_IS_NOT_NULL(http_version);
+    ASSERT_ARE_EQUAL(long, CURL_HTTP_VERSION_1_1, http_version->long_value);
+
+    // cleanup
+    HTTPAPI_CloseConnection(handle);
+    HTTPAPI_Deinit();
+}
+
+/* HTTPAPI_CloneOption */
+
+/* Tests_SRS_HTTPAPI_CURL_01_014: [ `HTTPAPI_CloneOption` shall clone `OPTION_CURL_SHARE` and `OPTION_CURL_HTTP_VERSION` as a `long`. ]*/
+TEST_FUNCTION(HTTPAPI_CloneOption_clones_the_share_option)
+{
+    // arrange
+    long use_shared_cache = 0;
+    const void* saved_value = NULL;
+    HTTPAPI_RESULT result;
+
+    // act
+    result = HTTPAPI_CloneOption(OPTION_CURL_SHARE, &use_shared_cache, &saved_value);
+
+    // assert
+    ASSERT_ARE_EQUAL(HTTPAPI_RESULT, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NOT_NULL(saved_value);
+    ASSERT_ARE_NOT_EQUAL(void_ptr, &use_shared_cache, saved_value);
+    ASSERT_ARE_EQUAL(long, 0, *(const long*)saved_value);
+
+    // cleanup
+    free((void*)saved_value);
+}
+
+END_TEST_SUITE(httpapi_curl_unittests)
@@ -35,11 +35,16 @@ void* my_gballoc_malloc(size_t size)
 
 void* my_gballoc_realloc(void* ptr, size_t size)
 {
-    void* newptr = realloc(ptr, size);
+    void* newptr;
 
     if (ptr == NULL)
     {
-        currentmalloc_call++;
+        /* a realloc of NULL is a new allocation, so it can be made to fail as one */
+        newptr = my_gballoc_malloc(size);
+    }
+    else
+    {
+        newptr = realloc(ptr, size);
     }
 
     return newptr;
@@ -47,16 +52,21 @@ void* my_gballoc_realloc(void* ptr, size_t size)
 
 void my_gballoc_free(void* ptr)
 {
-    currentmalloc_call--;
+    if (ptr != NULL)
+    {
+        currentmalloc_call--;
+    }
     free(ptr);
 }
 
 #ifdef __cplusplus
 #include <cstddef>
 #include <ctime>
+#include <cstring>
 #else
 #include <stddef.h>
 #include <time.h>
+#include <string.h>
 #endif
 
 #include "testrunnerswitcher.h"
@@ -65,17 +75,26 @@ void my_gballoc_free(void* ptr)
 #include "azure_c_shared_utility/macro_utils.h"
 
 #define MAX_RECEIVE_BUFFER_SIZES    3
-#define HUGE_RELATIVE_PATH_SIZE		10000
+#define HUGE_HEADER_SIZE            9000
+#define HUGE_CONTENT_SIZE           5000
 
 #define TEST_CREATE_CONNECTION_HOST_NAME (const char*)"https://test.azure-devices.net"
 #define TEST_EXECUTE_REQUEST_RELATIVE_PATH (const char*)"/devices/Huzzah_w_DHT22/messages/events?api-version=2016-11-14"
 #define TEST_EXECUTE_REQUEST_CONTENT (const unsigned char*)"{\"ObjectType\":\"DeviceInfo\", \"Version\":\"1.0\", \"IsSimulatedDevice\":false, \"DeviceProperties\":{\"DeviceID\":\"Huzzah_w_DHT22\", \"HubEnabledState\":true}, \"Commands\":[{ \"Name\":\"SetHumidity\", \"Parameters\":[{\"Name\":\"humidity\",\"Type\":\"int\"}]},{ \"Name\":\"SetTemperature\", \"Parameters\":[{\"Name\":\"temperature\",\"Type\":\"int\"}]}]}"
-#define TEST_EXECUTE_REQUEST_CONTENT_LENGTH (size_t)320
+#define TEST_EXECUTE_REQUEST_CONTENT_LENGTH (size_t)311
 #define TEST_SETOPTIONS_CERTIFICATE	(const unsigned char*)"blah!blah!blah!"
 #define TEST_SETOPTIONS_X509CLIENTCERT	(const unsigned char*)"ADMITONE"
 #define TEST_SETOPTIONS_X509PRIVATEKEY	(const unsigned char*)"SPEAKFRIENDANDENTER"
 #define TEST_GET_HEADER_HEAD_COUNT (size_t)2
 
+/* Wait budgets of the adapter, and the number of fake clock steps each of them lasts. */
+#define TEST_OPEN_TIMEOUT_IN_MILLISECONDS       10000
+#define TEST_CLOSE_TIMEOUT_IN_MILLISECONDS      10000
+#define TEST_SEND_TIMEOUT_IN_MILLISECONDS       20000
+#define TEST_RECEIVE_TIMEOUT_IN_MILLISECONDS    20000
+
+/* The connection, the xio, the tick counter and the response parser. */
+#define TEST_CONNECTION_ALLOCATIONS 4
 
 #define ENABLE_MOCKS
 #include "azure_c_shared_utility/gballoc.h"
@@ -85,6 +104,7 @@ void my_gballoc_free(void* ptr)
 #include "azure_c_shared_utility/threadapi.h"
 #include "azure_c_shared_utility/platform.h"
 #include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/tickcounter.h"
 #undef ENABLE_MOCKS
 #include "azure_c_shared_utility/httpapi.h"
 #include "azure_c_shared_utility/shared_util_options.h"
@@ -115,6 +135,30 @@ void my_xio_destroy(XIO_HANDLE xio)
 }
 
 static int xio_setoption_shallReturn;
+static int xio_setoption_io_wait_shallReturn;
+static unsigned int xio_setoption_io_wait_ms;
+/* The fake clock moves forward on every read, so the request deadlines expire after a bounded number of waits. */
+#define FAKE_CLOCK_STEP_IN_MILLISECONDS 10
+static tickcounter_ms_t fake_clock_ms;
+
+TICK_COUNTER_HANDLE my_tickcounter_create(void)
+{
+    return (TICK_COUNTER_HANDLE)malloc(1);
+}
+
+void my_tickcounter_destroy(TICK_COUNTER_HANDLE tick_counter)
+{
+    free(tick_counter);
+}
+
+int my_tickcounter_get_current_ms(TICK_COUNTER_HANDLE tick_counter, tickcounter_ms_t* current_ms)
+{
+    (void)tick_counter;
+    *current_ms = fake_clock_ms;
+    fake_clock_ms += FAKE_CLOCK_STEP_IN_MILLISECONDS;
+    return 0;
+}
+
 int my_xio_setoption(XIO_HANDLE xio, const char* optionName, const void* value)
 {
     int result;
@@ -122,6 +166,11 @@ int my_xio_setoption(XIO_HANDLE xio, const char* optionName, const void* value)
     {
         result = __FAILURE__;
     }
+    else if (strcmp(optionName, OPTION_IO_WAIT_MS) == 0)
+    {
+        xio_setoption_io_wait_ms = *(const unsigned int*)value;
+        result = xio_setoption_io_wait_shallReturn;
+    }
     else
     {
         result = xio_setoption_shallReturn;
@@ -150,49 +199,26 @@ typedef enum xio_dowork_job_tag
 static const int xio_send_0[10] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 static const int xio_send_e[4] = { 123, 123, 123, 123 };
 static const int xio_send_0_e[4] = { 0, 123, 0, 0 };
-static const int xio_send_00_e[4] = { 0, 0, 123, 0 };
-static const int xio_send_7x0[7] = { 0, 0, 0, 0, 0, 0, 0 };
-static const int xio_send_6x0_e[7] = { 0, 0, 0, 0, 0, 0, 123 };
 static const xio_dowork_job doworkjob_end[1] = { XIO_DOWORK_JOB_END };
 static const xio_dowork_job doworkjob_oe[2] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_END };
 static const xio_dowork_job doworkjob_4none_oe[6] = { XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_END };
 static const xio_dowork_job doworkjob_4none_ee[6] = { XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_ERROR, XIO_DOWORK_JOB_END };
-static const xio_dowork_job doworkjob_o_3none_ee[6] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_NONE, XIO_DOWORK_JOB_ERROR, XIO_DOWORK_JOB_END };
-static const xio_dowork_job doworkjob_oee[3] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_ERROR, XIO_DOWORK_JOB_END };
-static const xio_dowork_job doworkjob_ose[3] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_END };
 static const xio_dowork_job doworkjob_ee[2] = { XIO_DOWORK_JOB_ERROR, XIO_DOWORK_JOB_END };
-static const xio_dowork_job doworkjob_o_re[3] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_END };
-static const xio_dowork_job doworkjob_o_rce[8] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_CLOSE, XIO_DOWORK_JOB_END };
-static const xio_dowork_job doworkjob_o_rc_error[9] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_CLOSE, XIO_DOWORK_JOB_ERROR, XIO_DOWORK_JOB_END };
-static const xio_dowork_job doworkjob_o_rre[4] = { XIO_DOWORK_JOB_OPEN, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_END };
-static const xio_dowork_job doworkjob_o_sre[15] = { XIO_DOWORK_JOB_OPEN, 
-    XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND,
-    XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_CLOSE, XIO_DOWORK_JOB_END };
+static const xio_dowork_job doworkjob_re[2] = { XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_END };
+static const xio_dowork_job doworkjob_rre[3] = { XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_END };
+static const xio_dowork_job doworkjob_ce[2] = { XIO_DOWORK_JOB_CLOSE, XIO_DOWORK_JOB_END };
+static const xio_dowork_job doworkjob_c_error[3] = { XIO_DOWORK_JOB_CLOSE, XIO_DOWORK_JOB_ERROR, XIO_DOWORK_JOB_END };
+static const xio_dowork_job doworkjob_se[2] = { XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_END };
+static const xio_dowork_job doworkjob_s_error[3] = { XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_ERROR, XIO_DOWORK_JOB_END };
+static const xio_dowork_job doworkjob_sse[3] = { XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_END };
+static const xio_dowork_job doworkjob_sre[3] = { XIO_DOWORK_JOB_SEND, XIO_DOWORK_JOB_RECEIVED, XIO_DOWORK_JOB_END };
 
 static const IO_OPEN_RESULT openresult_ok[1] = { IO_OPEN_OK };
 static const IO_OPEN_RESULT openresult_error[1] = { IO_OPEN_ERROR };
 
-static const IO_SEND_RESULT sendresult_error[1]  = { IO_SEND_ERROR };
-static const IO_SEND_RESULT sendresult_o_3error[4] = { IO_SEND_OK, IO_SEND_ERROR, IO_SEND_ERROR, IO_SEND_ERROR };
-static const IO_SEND_RESULT sendresult_7ok[7] = {
-    IO_SEND_OK,
-        IO_SEND_OK,
-        IO_SEND_OK,
-        IO_SEND_OK,
-        IO_SEND_OK,
-        IO_SEND_OK,
-        IO_SEND_OK
-};
-static const IO_SEND_RESULT sendresult_6ok_error[7] = {
-    IO_SEND_OK,
-    IO_SEND_OK,
-    IO_SEND_OK,
-    IO_SEND_OK,
-    IO_SEND_OK,
-    IO_SEND_OK,
-    IO_SEND_ERROR
-};
-
+static const IO_SEND_RESULT sendresult_ok[1] = { IO_SEND_OK };
+static const IO_SEND_RESULT sendresult_error[1] = { IO_SEND_ERROR };
+static const IO_SEND_RESULT sendresult_ok_error[2] = { IO_SEND_OK, IO_SEND_ERROR };
 
 static const xio_dowork_job* DoworkJobs = (const xio_dowork_job*)doworkjob_end;
 static const IO_OPEN_RESULT* DoworkJobsOpenResult;
@@ -299,7 +325,9 @@ int my_xio_send(XIO_HANDLE xio, const void* buffer, size_t size, ON_SEND_COMPLET
             xio_send_transmited_buffer_target--;
             if (xio_send_transmited_buffer_target == 0)
             {
-                (void)memcpy(xio_send_transmited_buffer, buffer, size);
+                size_t copySize = (size < (sizeof(xio_send_transmited_buffer) - 1)) ? size : (sizeof(xio_send_transmited_buffer) - 1);
+                (void)memcpy(xio_send_transmited_buffer, buffer, copySize);
+                xio_send_transmited_buffer[copySize] = '\0';
             }
         }
         result = xio_send_shallReturn[xio_send_shallReturn_counter];
@@ -327,7 +355,10 @@ void my_xio_dowork(XIO_HANDLE xio)
             {
                 if (my_on_io_open_complete != NULL)
                 {
-                    my_on_io_open_complete(my_on_io_open_complete_context, (*DoworkJobsOpenResult));
+                    IO_OPEN_RESULT_DETAILED open_result_detailed;
+                    open_result_detailed.result = (*DoworkJobsOpenResult);
+                    open_result_detailed.code = 0;
+                    my_on_io_open_complete(my_on_io_open_complete_context, open_result_detailed);
                 }
                 DoworkJobs++;
                 DoworkJobsOpenResult++;
@@ -393,6 +424,7 @@ void my_HTTPHeaders_Free(HTTP_HEADERS_HANDLE handle)
 }
 
 static BUFFER_HANDLE TestBufferHandle;
+static unsigned char TestBufferContent[256];
 
 BUFFER_HANDLE my_BUFFER_new(void)
 {
@@ -404,6 +436,12 @@ void my_BUFFER_delete(BUFFER_HANDLE handle)
     free(handle);
 }
 
+unsigned char* my_BUFFER_u_char(BUFFER_HANDLE handle)
+{
+    (void)handle;
+    return TestBufferContent;
+}
+
 static HTTP_HEADERS_RESULT HTTPHeaders_GetHeaderCount_shallReturn;
 HTTP_HEADERS_RESULT my_HTTPHeaders_GetHeaderCount(HTTP_HEADERS_HANDLE handle, size_t* headerCount)
 {
@@ -423,19 +461,19 @@ HTTP_HEADERS_RESULT my_HTTPHeaders_GetHeaderCount(HTTP_HEADERS_HANDLE handle, si
 }
 
 static HTTP_HEADERS_RESULT HTTPHeaders_GetHeader_shallReturn;
-HTTP_HEADERS_RESULT my_HTTPHeaders_GetHeader(HTTP_HEADERS_HANDLE handle, size_t index, char** destination)
+HTTP_HEADERS_RESULT my_HTTPHeaders_GetHeaderNameValue(HTTP_HEADERS_HANDLE handle, size_t index, const char** name, const char** value)
 {
     HTTP_HEADERS_RESULT result;
 
-    if ((handle == NULL) || (destination == NULL) || (index > TEST_GET_HEADER_HEAD_COUNT))
+    if ((handle == NULL) || (name == NULL) || (value == NULL) || (index > TEST_GET_HEADER_HEAD_COUNT))
     {
         result = HTTP_HEADERS_INVALID_ARG;
     }
     else
     {
-        *destination = (char*)malloc(11 * sizeof(char));
-        strcpy(*destination, "0123456789");
-        result = HTTPHeaders_GetHeaderCount_shallReturn;
+        *name = "01234";
+        *value = "56789";
+        result = HTTPHeaders_GetHeader_shallReturn;
     }
 
     return result;
@@ -447,14 +485,8 @@ const IO_INTERFACE_DESCRIPTION* my_platform_get_default_tlsio(void)
     return &default_tlsio;
 }
 
-
 static void createHttpObjects(HTTP_HEADERS_HANDLE* requestHttpHeaders, HTTP_HEADERS_HANDLE* responseHttpHeaders)
 {
-    STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
-    STRICT_EXPECTED_CALL(gballoc_malloc(1));
-    STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
-    STRICT_EXPECTED_CALL(gballoc_malloc(1));
-
     /*assumed to never fail*/
     *requestHttpHeaders = HTTPHeaders_Alloc();
     *responseHttpHeaders = HTTPHeaders_Alloc();
@@ -465,22 +497,18 @@ static void createHttpObjects(HTTP_HEADERS_HANDLE* requestHttpHeaders, HTTP_HEAD
     {
         ASSERT_FAIL("unable to build test prerequisites");
     }
+    umock_c_reset_all_calls();
 }
 
 static void destroyHttpObjects(HTTP_HEADERS_HANDLE* requestHttpHeaders, HTTP_HEADERS_HANDLE* responseHttpHeaders)
 {
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
-
     HTTPHeaders_Free(*requestHttpHeaders);
     *requestHttpHeaders = NULL;
     HTTPHeaders_Free(*responseHttpHeaders);
     *responseHttpHeaders = NULL;
 }
 
-static HTTP_HANDLE createHttpConnection(void)
+static void resetXioMock(void)
 {
     xio_open_shallReturn = 0;
     xio_send_shallReturn_counter = 0;
@@ -501,171 +529,270 @@ static HTTP_HANDLE createHttpConnection(void)
     my_on_io_error = NULL;
     my_on_io_error_context = NULL;
 
-    HTTPHeaders_GetHeaderCount_shallReturn = HTTP_HEADERS_OK;
     xio_setoption_shallReturn = 0;
-
     current_xioCreate_must_fail = false;
+}
 
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(platform_get_default_tlsio());
-    STRICT_EXPECTED_CALL(xio_create(&default_tlsio, IGNORED_PTR_ARG)).IgnoreArgument(2);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
+/* Opens a connection on the first dowork and leaves the mocks ready for the calls under test. */
+static HTTP_HANDLE createHttpConnection(void)
+{
+    HTTP_HANDLE result;
+
+    resetXioMock();
+    DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
+    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
 
     HTTPAPI_Init();
-    return HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 2 */
-}
+    result = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 4 */
+    ASSERT_IS_NOT_NULL(result);
 
-static void destroyHttpConnection(HTTP_HANDLE httpHandle)
-{
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
-    HTTPAPI_Deinit();
+    DoworkJobs = (const xio_dowork_job*)doworkjob_end;
+    umock_c_reset_all_calls();
+
+    return result;
 }
 
 static void setHttpCertificate(HTTP_HANDLE httpHandle)
 {
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
     /*Tests_SRS_HTTPAPI_COMPACT_21_056: [ The HTTPAPI_SetOption shall change the HTTP options. ]*/
     /*Tests_SRS_HTTPAPI_COMPACT_21_057: [ The HTTPAPI_SetOption shall receive a handle that identiry the HTTP connection. ]*/
     /*Tests_SRS_HTTPAPI_COMPACT_21_058: [ The HTTPAPI_SetOption shall receive the option as a pair optionName/value. ]*/
     HTTPAPI_SetOption(httpHandle, "TrustedCerts", TEST_SETOPTIONS_CERTIFICATE);				/* currentmalloc_call += 1 */
+    umock_c_reset_all_calls();
 }
 
 static void setHttpx509ClientCertificateAndKey(HTTP_HANDLE httpHandle)
 {
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
     /*Tests_SRS_HTTPAPI_COMPACT_21_056: [ The HTTPAPI_SetOption shall change the HTTP options. ]*/
     /*Tests_SRS_HTTPAPI_COMPACT_21_057: [ The HTTPAPI_SetOption shall receive a handle that identiry the HTTP connection. ]*/
     /*Tests_SRS_HTTPAPI_COMPACT_21_058: [ The HTTPAPI_SetOption shall receive the option as a pair optionName/value. ]*/
     HTTPAPI_SetOption(httpHandle, SU_OPTION_X509_CERT, TEST_SETOPTIONS_X509CLIENTCERT);				/* currentmalloc_call += 1 */
     HTTPAPI_SetOption(httpHandle, SU_OPTION_X509_PRIVATE_KEY, TEST_SETOPTIONS_X509PRIVATEKEY);				/* currentmalloc_call += 1 */
+    umock_c_reset_all_calls();
 }
 
-static void setupAllCallBeforeOpenHTTPsequence(HTTP_HEADERS_HANDLE requestHttpHeaders, int numberOfDoWork, bool useClientCert)
+/* A wait that the transport serves by blocking on its socket for the rest of the budget. */
+static void setupWaitForIO(void)
 {
-	int i;
-
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderCount(requestHttpHeaders, IGNORED_PTR_ARG))
-        .IgnoreArgument(2);
-    STRICT_EXPECTED_CALL(xio_setoption(IGNORED_PTR_ARG, "TrustedCerts", TEST_SETOPTIONS_CERTIFICATE))
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(xio_setoption(IGNORED_PTR_ARG, OPTION_IO_WAIT_MS, IGNORED_PTR_ARG))
         .IgnoreArgument(1)
         .IgnoreArgument(3);
-    if (useClientCert == true)
-    {
-        STRICT_EXPECTED_CALL(xio_setoption(IGNORED_PTR_ARG, SU_OPTION_X509_CERT, TEST_SETOPTIONS_X509CLIENTCERT))
-            .IgnoreArgument(1)
-            .IgnoreArgument(3);
-        STRICT_EXPECTED_CALL(xio_setoption(IGNORED_PTR_ARG, SU_OPTION_X509_PRIVATE_KEY, TEST_SETOPTIONS_X509PRIVATEKEY))
-            .IgnoreArgument(1)
-            .IgnoreArgument(3);
-    }
-    STRICT_EXPECTED_CALL(xio_open(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+}
+
+static void setupTickCounter(void)
+{
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
-    for (i = 0; i < numberOfDoWork; i++)
+}
+
+static void setupDowork(void)
+{
+    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+}
+
+/* Expects `count` doworks, with a wait between each two of them. */
+static void setupDoworkRetries(int count)
+{
+    int i;
+    for (i = 0; i < count; i++)
     {
-        STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
         if (i > 0)
         {
-            STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
+            setupWaitForIO();
         }
+        setupDowork();
     }
 }
 
-#define TEST_RECEIVED_ANSWER (const unsigned char*)"HTTP/111.222 433 555\r\ncontent-length:10\r\ntransfer-encoding:\r\n\r\n0123456789\r\n\r\n"
-static void setupAllCallBeforeReceiveHTTPsequenceWithSuccess()
+/* A wait that finds the budget spent. */
+static void setupWaitTimeout(void)
 {
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, DoworkJobsReceivedBuffer_size[0])).IgnoreArgument(1);
+    setupTickCounter();
+}
 
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, "content-length", "10")).IgnoreArgument(1);
+static void setupAllCallBeforeOpenHTTPsequence(void)
+{
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(platform_get_default_tlsio());
+    STRICT_EXPECTED_CALL(xio_create(&default_tlsio, IGNORED_PTR_ARG)).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(tickcounter_create());
+    STRICT_EXPECTED_CALL(gballoc_malloc(1));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(xio_open(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+}
 
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, "transfer-encoding", "")).IgnoreArgument(1);
+/* The dowork issued by xio_open, the start of the open deadline, and the doworks until the open completes. */
+static void setupAllCallForOpenHTTPsequence(int numberOfDoWork)
+{
+    setupDowork();
+    setupTickCounter();
+    setupDoworkRetries(numberOfDoWork - 1);
+}
 
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+static void setupAllCallForOpenFailedHTTPsequence(void)
+{
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))     /* the parser line */
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))     /* the parser */
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(tickcounter_destroy(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(xio_destroy(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
-
-    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).IgnoreAllArguments();
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))     /* the connection */
+        .IgnoreArgument(1);
 }
 
-static void setupAllCallBeforeSendHTTPsequenceWithSuccess(HTTP_HEADERS_HANDLE requestHttpHeaders)
+static void setupAllCallBeforeCloseHTTPsequence(void)
 {
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+    STRICT_EXPECTED_CALL(xio_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllArguments();
+    setupTickCounter();
+}
+
+/* numberOfBuffers counts the request buffer and the certificates owned by the connection. */
+static void setupAllCallForDestroyHTTPsequence(int numberOfBuffers)
+{
+    int i;
+    STRICT_EXPECTED_CALL(xio_destroy(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(tickcounter_destroy(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))     /* the parser line */
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))     /* the parser */
+        .IgnoreArgument(1);
+    for (i = 0; i < numberOfBuffers; i++)
+    {
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+    }
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))     /* the connection */
+        .IgnoreArgument(1);
 }
 
-static const IO_OPEN_RESULT* DoworkJobsOpenResult_ReceiveHead = (const IO_OPEN_RESULT*)openresult_ok;
-static const IO_SEND_RESULT* DoworkJobsSendResult_ReceiveHead = (const IO_SEND_RESULT*) sendresult_7ok;
+static void setupAllCallBeforeExecuteHTTPsequence(HTTP_HEADERS_HANDLE requestHttpHeaders)
+{
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    STRICT_EXPECTED_CALL(gballoc_malloc(1));
+    if (requestHttpHeaders != NULL)
+    {
+        STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderCount(requestHttpHeaders, IGNORED_PTR_ARG))
+            .IgnoreArgument(2);
+    }
+}
 
-static void PrepareReceiveHead(HTTP_HEADERS_HANDLE requestHttpHeaders, size_t bufferSize[], int doworkReduction[], int countSizes)
+static void setupAllCallAfterExecuteHTTPsequence(void)
 {
-	int countBuffer;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+}
 
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+static void setupAllCallBeforeSendHTTPsequence(HTTP_HEADERS_HANDLE requestHttpHeaders)
+{
+    size_t pass;
 
-    for (countBuffer = 0; countBuffer < countSizes; countBuffer++)
+    /* the headers are walked once to size the request buffer and once to serialize them */
+    for (pass = 0; pass < 2; pass++)
     {
-		int countChar;
-        if (countBuffer > 0)
+        size_t index;
+        for (index = 0; index < TEST_GET_HEADER_HEAD_COUNT; index++)
         {
-            STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
+            STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderNameValue(requestHttpHeaders, index, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .IgnoreArgument(3).IgnoreArgument(4);
         }
-        STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, bufferSize[countBuffer])).IgnoreArgument(1);
-        for (countChar = 0; countChar < doworkReduction[countBuffer]; countChar++)
+
+        if (pass == 0)
         {
-            STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-                .IgnoreArgument(1);
+            STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+                .IgnoreArgument(2);
         }
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+    }
+
+    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+}
+
+/* The request line, the headers and a small content go out in one write that completes inline. */
+static void setupAllCallBeforeSendHTTPsequenceWithSuccess(HTTP_HEADERS_HANDLE requestHttpHeaders)
+{
+    setupAllCallBeforeSendHTTPsequence(requestHttpHeaders);
+    setupTickCounter();
+}
+
+#define TEST_RECEIVED_ANSWER (const unsigned char*)"HTTP/111.222 433 555\r\ncontent-length:10\r\ntransfer-encoding:\r\n\r\n0123456789\r\n\r\n"
+/* The bytes of TEST_RECEIVED_ANSWER after the response, which are kept for the next response. */
+#define TEST_RECEIVED_ANSWER_TRAILING_BYTES 4
+
+/* The whole TEST_RECEIVED_ANSWER arrives in one dowork and is parsed in place. */
+static void setupAllCallBeforeReceiveHTTPsequenceWithSuccess(bool withResponseHeaders)
+{
+    setupTickCounter();
+    setupDowork();
+    if (withResponseHeaders)
+    {
+        STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, "content-length", "10"))
+            .IgnoreArgument(1);
+        STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, "transfer-encoding", ""))
             .IgnoreArgument(1);
     }
+    STRICT_EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, 10))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, TEST_RECEIVED_ANSWER_TRAILING_BYTES));
+    setupTickCounter();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+}
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+/* A response that the parser rejects as soon as it arrives. */
+static void setupAllCallForReceiveWithParserErrorHTTPsequence(size_t receivedSize)
+{
+    setupTickCounter();
+    setupDowork();
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, receivedSize));
+    setupTickCounter();
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
 }
 
+static void prepareReceivedAnswer(const unsigned char* answer)
+{
+    DoworkJobsReceivedBuffer = answer;
+    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)answer);
+    DoworkJobsReceivedBuffer_counter = 0;
+    DoworkJobs = (const xio_dowork_job*)doworkjob_re;
+}
+
+static HTTPAPI_RESULT executeRequest(HTTP_HANDLE httpHandle, HTTPAPI_REQUEST_TYPE requestType, HTTP_HEADERS_HANDLE requestHttpHeaders, const unsigned char* content, size_t contentLength, unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHttpHeaders)
+{
+    return HTTPAPI_ExecuteRequest(
+        httpHandle,
+        requestType,
+        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
+        requestHttpHeaders,
+        content,
+        contentLength,
+        statusCode,
+        responseHttpHeaders,
+        TestBufferHandle);
+}
 
 TEST_DEFINE_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
@@ -711,6 +838,7 @@ TEST_SUITE_INITIALIZE(setsBufferTempSize)
     REGISTER_UMOCK_ALIAS_TYPE(ON_BYTES_RECEIVED, void*);
     REGISTER_UMOCK_ALIAS_TYPE(ON_IO_ERROR, void*);
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(TICK_COUNTER_HANDLE, void*);
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
@@ -722,14 +850,19 @@ TEST_SUITE_INITIALIZE(setsBufferTempSize)
     REGISTER_GLOBAL_MOCK_HOOK(xio_close, my_xio_close);
     REGISTER_GLOBAL_MOCK_HOOK(xio_send, my_xio_send);
     REGISTER_GLOBAL_MOCK_HOOK(xio_dowork, my_xio_dowork);
+    REGISTER_GLOBAL_MOCK_HOOK(tickcounter_create, my_tickcounter_create);
+    REGISTER_GLOBAL_MOCK_HOOK(tickcounter_destroy, my_tickcounter_destroy);
+    REGISTER_GLOBAL_MOCK_HOOK(tickcounter_get_current_ms, my_tickcounter_get_current_ms);
 
     REGISTER_GLOBAL_MOCK_RETURN(HTTPHeaders_AddHeaderNameValuePair, HTTP_HEADERS_OK);
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Alloc, my_HTTPHeaders_Alloc);
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Free, my_HTTPHeaders_Free);
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_new, my_BUFFER_new);
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_delete, my_BUFFER_delete);
+    REGISTER_GLOBAL_MOCK_HOOK(BUFFER_u_char, my_BUFFER_u_char);
+    REGISTER_GLOBAL_MOCK_RETURN(BUFFER_pre_build, 0);
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_GetHeaderCount, my_HTTPHeaders_GetHeaderCount);
-    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_GetHeader, my_HTTPHeaders_GetHeader);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_GetHeaderNameValue, my_HTTPHeaders_GetHeaderNameValue);
 
     REGISTER_GLOBAL_MOCK_HOOK(platform_get_default_tlsio, my_platform_get_default_tlsio);
 }
@@ -755,9 +888,19 @@ TEST_FUNCTION_INITIALIZE(f)
 
     currentmalloc_call = 0;
     whenShallmalloc_fail = 0;
+    fake_clock_ms = 0;
 
     xio_send_transmited_buffer[0] = '\0';
+    xio_send_transmited_buffer_target = 0;
+    xio_setoption_io_wait_shallReturn = 0;
+    xio_setoption_io_wait_ms = 0;
+
+    HTTPHeaders_GetHeaderCount_shallReturn = HTTP_HEADERS_OK;
+    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
 
+    DoworkJobs = (const xio_dowork_job*)doworkjob_end;
+    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_ok;
+    DoworkJobsReceivedBuffer_counter = 0;
     call_on_send_complete_in_xio_send = true;
     SkipDoworkJobsOpenResult = 0;
     SkipDoworkJobsCloseResult = 0;
@@ -825,7 +968,7 @@ TEST_FUNCTION(HTTPAPI_CreateConnection__hostName_NULL_Failed)
     /// arrange
     HTTP_HANDLE httpHandle;
     HTTPAPI_Init();
-    current_xioCreate_must_fail = false;
+    resetXioMock();
 
     /// act
     httpHandle = HTTPAPI_CreateConnection(NULL);	/* currentmalloc_call += 0 */
@@ -846,7 +989,7 @@ TEST_FUNCTION(HTTPAPI_CreateConnection__empty_hostName_Failed)
     const char* hostName = "";
     HTTP_HANDLE httpHandle;
     HTTPAPI_Init();
-    current_xioCreate_must_fail = false;
+    resetXioMock();
 
     /// act
     httpHandle = HTTPAPI_CreateConnection(hostName);	/* currentmalloc_call += 0 */
@@ -862,27 +1005,29 @@ TEST_FUNCTION(HTTPAPI_CreateConnection__empty_hostName_Failed)
 
 /*Tests_SRS_HTTPAPI_COMPACT_21_011: [ The HTTPAPI_CreateConnection shall create an http connection to the host specified by the hostName parameter. ]*/
 /*Tests_SRS_HTTPAPI_COMPACT_21_012: [ The HTTPAPI_CreateConnection shall return a non-NULL handle on success. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_024: [ The HTTPAPI_CreateConnection shall open the transport connection with the host to send the request. ]*/
 TEST_FUNCTION(HTTPAPI_CreateConnection__valid_hostName_Succeed)
 {
     /// arrange
     HTTP_HANDLE httpHandle;
     HTTPAPI_Init();
-    current_xioCreate_must_fail = false;
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(platform_get_default_tlsio());
-    STRICT_EXPECTED_CALL(xio_create(&default_tlsio, IGNORED_PTR_ARG)).IgnoreArgument(2);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
+    resetXioMock();
+    DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
+    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
+
+    setupAllCallBeforeOpenHTTPsequence();
+    setupAllCallForOpenHTTPsequence(1);
 
     /// act
-    httpHandle = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 2 */
+    httpHandle = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 4 */
 
     /// assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 2, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS, currentmalloc_call);
     ASSERT_IS_NOT_NULL(httpHandle);
 
     /// cleanup
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 2 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
     HTTPAPI_Deinit();
 }
 
@@ -891,13 +1036,13 @@ TEST_FUNCTION(HTTPAPI_CreateConnection__no_enough_memory_failed)
 {
     /// arrange
     HTTP_HANDLE httpHandle;
-    current_xioCreate_must_fail = false;
+    resetXioMock();
     whenShallmalloc_fail = 1;
     HTTPAPI_Init();
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
 
     /// act
-    httpHandle = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 2 */
+    httpHandle = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 0 */
 
     /// assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -913,16 +1058,17 @@ TEST_FUNCTION(HTTPAPI_CreateConnection__create_xio_connection_failed)
 {
     /// arrange
     HTTP_HANDLE httpHandle;
+    resetXioMock();
     current_xioCreate_must_fail = true;
     HTTPAPI_Init();
 
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
     STRICT_EXPECTED_CALL(platform_get_default_tlsio());
     STRICT_EXPECTED_CALL(xio_create(&default_tlsio, IGNORED_PTR_ARG)).IgnoreArgument(2);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_NUM_ARG)).IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)).IgnoreArgument(1);
 
     /// act
-    httpHandle = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 2 */
+    httpHandle = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 0 */
 
     /// assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -933,776 +1079,481 @@ TEST_FUNCTION(HTTPAPI_CreateConnection__create_xio_connection_failed)
     HTTPAPI_Deinit();
 }
 
-/* HTTPAPI_CloseConnection */
-
-/*Tests_SRS_HTTPAPI_COMPACT_21_017: [ The HTTPAPI_CloseConnection shall close the connection previously created in HTTPAPI_ExecuteRequest. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_076: [ After close the connection, The HTTPAPI_CloseConnection shall destroy the connection previously created in HTTPAPI_CreateConnection. ]*/
-TEST_FUNCTION(HTTPAPI_CloseConnection__valid_hostName_Succeed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_025: [ If the open process failed, the HTTPAPI_ExecuteRequest shall not send any request and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_CreateConnection__xio_open_returns_LINE_failed)
 {
     /// arrange
-    HTTP_HANDLE httpHandle = createHttpConnection();
-    STRICT_EXPECTED_CALL(xio_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
+    HTTP_HANDLE httpHandle;
+    HTTPAPI_Init();
+    resetXioMock();
+    xio_open_shallReturn = __FAILURE__;
+
+    setupAllCallBeforeOpenHTTPsequence();
+    setupAllCallForOpenFailedHTTPsequence();
 
     /// act
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 2 */
+    httpHandle = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 0 */
 
     /// assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
+    ASSERT_IS_NULL(httpHandle);
 
     /// cleanup
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_020: [ If the connection handle is NULL, the HTTPAPI_CloseConnection shall not do anything. ]*/
-TEST_FUNCTION(HTTPAPI_CloseConnection__handle_NULL_Succeed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_025: [ If the open process failed, the HTTPAPI_ExecuteRequest shall not send any request and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_CreateConnection__on_io_open_complete_with_error_on_openning_failed)
 {
     /// arrange
-    HTTP_HANDLE httpHandle = NULL;
+    HTTP_HANDLE httpHandle;
     HTTPAPI_Init();
+    resetXioMock();
+    DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
+    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_error;
+
+    setupAllCallBeforeOpenHTTPsequence();
+    setupAllCallForOpenHTTPsequence(1);
+    setupAllCallForOpenFailedHTTPsequence();
 
     /// act
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 0 */
+    httpHandle = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 0 */
 
     /// assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
+    ASSERT_IS_NULL(httpHandle);
 
     /// cleanup
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_018: [ If there is a certificate associated to this connection, the HTTPAPI_CloseConnection shall free all allocated memory for the certificate. ]*/
-TEST_FUNCTION(HTTPAPI_CloseConnection__free_certificate_memory_succeed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_025: [ If the open process failed, the HTTPAPI_ExecuteRequest shall not send any request and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_CreateConnection__on_io_open_complete_with_error_on_working_failed)
 {
     /// arrange
-    HTTP_HANDLE httpHandle = createHttpConnection();
-    setHttpCertificate(httpHandle);
-    STRICT_EXPECTED_CALL(xio_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
+    HTTP_HANDLE httpHandle;
+    HTTPAPI_Init();
+    resetXioMock();
+    DoworkJobs = (const xio_dowork_job*)doworkjob_4none_oe;
+    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_error;
+
+    setupAllCallBeforeOpenHTTPsequence();
+    setupAllCallForOpenHTTPsequence(5);
+    setupAllCallForOpenFailedHTTPsequence();
 
     /// act
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    httpHandle = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 0 */
 
     /// assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
+    ASSERT_IS_NULL(httpHandle);
 
     /// cleanup
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_06_001: [ If there is a x509 client certificate associated to this connection, the HTTAPI_CloseConnection shall free all allocated memory for the certificate. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_06_002: [ If there is a x509 client private key associated to this connection, then HTTP_CloseConnection shall free all the allocated memory for the private key. ]*/
-TEST_FUNCTION(HTTPAPI_CloseConnection__free_x509client_memory_succeed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_077: [ The HTTPAPI_ExecuteRequest shall wait, at least, 10 seconds for the SSL open process. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall block on the transport until it can make progress, and only poll it between retries when the transport cannot wait on its own. ]*/
+TEST_FUNCTION(HTTPAPI_CreateConnection__on_io_open_complete_with_error_after_n_retry_failed)
 {
     /// arrange
-    HTTP_HANDLE httpHandle = createHttpConnection();
-    setHttpx509ClientCertificateAndKey(httpHandle);
-    umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(xio_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) // From the xio destroy
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) // the cert
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) // the key
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) // the instance.
-        .IgnoreArgument(1);
+    HTTP_HANDLE httpHandle;
+    HTTPAPI_Init();
+    resetXioMock();
+    DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
+    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_error;
+    SkipDoworkJobsOpenResult = 49;
+
+    setupAllCallBeforeOpenHTTPsequence();
+    setupAllCallForOpenHTTPsequence(50);
+    setupAllCallForOpenFailedHTTPsequence();
 
     /// act
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    httpHandle = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 0 */
 
     /// assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
+    ASSERT_IS_NULL(httpHandle);
 
     /// cleanup
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_087: [ If the xio return anything different than 0, the HTTPAPI_CloseConnection shall destroy the connection anyway. ]*/
-TEST_FUNCTION(HTTPAPI_CloseConnection__return_LINE_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_078: [ If the HTTPAPI_ExecuteRequest cannot open the connection in 10 seconds, it shall fail and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_CreateConnection__on_io_open_complete_with_timeout_failed)
 {
     /// arrange
-    HTTP_HANDLE httpHandle = createHttpConnection();
-    
-    xio_close_shallReturn = __FAILURE__;
-    DoworkJobsCloseSuccess = true;
-    SkipDoworkJobsCloseResult = 0;
-    call_on_io_close_complete_in_xio_close = true;
-    
-    STRICT_EXPECTED_CALL(xio_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
+    HTTP_HANDLE httpHandle;
+    HTTPAPI_Init();
+    resetXioMock();
+    DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
+    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
+    SkipDoworkJobsOpenResult = (TEST_OPEN_TIMEOUT_IN_MILLISECONDS / FAKE_CLOCK_STEP_IN_MILLISECONDS) + 1;
+
+    setupAllCallBeforeOpenHTTPsequence();
+    setupAllCallForOpenHTTPsequence((TEST_OPEN_TIMEOUT_IN_MILLISECONDS / FAKE_CLOCK_STEP_IN_MILLISECONDS) + 1);
+    setupWaitTimeout();
+    setupAllCallForOpenFailedHTTPsequence();
 
     /// act
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 2 */
+    httpHandle = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 0 */
 
-                                            /// assert
+    /// assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
+    ASSERT_IS_NULL(httpHandle);
 
     /// cleanup
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_084: [ The HTTPAPI_CloseConnection shall wait, at least, 10 seconds for the SSL close process. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_086: [ The HTTPAPI_CloseConnection shall wait, at least, 100 milliseconds between retries. ]*/
-TEST_FUNCTION(HTTPAPI_CloseConnection__close_on_dowork_succeed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_025: [ If the open process failed, the HTTPAPI_ExecuteRequest shall not send any request and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_CreateConnection__on_io_error_on_openning_failed)
 {
     /// arrange
-    unsigned int statusCode;
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
-    HTTP_HANDLE httpHandle = createHttpConnection();
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-
-    xio_close_shallReturn = 0;
-    DoworkJobsCloseSuccess = true;
-    SkipDoworkJobsCloseResult = 0;
-    call_on_io_close_complete_in_xio_close = false;
-
-    STRICT_EXPECTED_CALL(xio_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
+    HTTP_HANDLE httpHandle;
+    HTTPAPI_Init();
+    resetXioMock();
+    DoworkJobs = (const xio_dowork_job*)doworkjob_ee;
 
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
-    ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
+    setupAllCallBeforeOpenHTTPsequence();
+    setupAllCallForOpenHTTPsequence(1);
+    setupAllCallForOpenFailedHTTPsequence();
 
     /// act
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    httpHandle = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 0 */
 
     /// assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 2, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
+    ASSERT_IS_NULL(httpHandle);
 
     /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_084: [ The HTTPAPI_CloseConnection shall wait, at least, 10 seconds for the SSL close process. ]*/
-TEST_FUNCTION(HTTPAPI_CloseConnection__close_on_dowork_retry_n_succeed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_025: [ If the open process failed, the HTTPAPI_ExecuteRequest shall not send any request and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_CreateConnection__on_io_error_on_working_failed)
 {
     /// arrange
-	int i;
-    unsigned int statusCode;
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
-    HTTP_HANDLE httpHandle = createHttpConnection();
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-
-    xio_close_shallReturn = 0;
-    DoworkJobsCloseSuccess = true;
-    SkipDoworkJobsCloseResult = 90;
-    call_on_io_close_complete_in_xio_close = false;
+    HTTP_HANDLE httpHandle;
+    HTTPAPI_Init();
+    resetXioMock();
+    DoworkJobs = (const xio_dowork_job*)doworkjob_4none_ee;
 
-    STRICT_EXPECTED_CALL(xio_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    for (i = 0; i < SkipDoworkJobsCloseResult; i++)
-    {
-        STRICT_EXPECTED_CALL(xio_dowork(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    }
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
-    ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
+    setupAllCallBeforeOpenHTTPsequence();
+    setupAllCallForOpenHTTPsequence(5);
+    setupAllCallForOpenFailedHTTPsequence();
 
     /// act
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    httpHandle = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 0 */
 
-                                            /// assert
+    /// assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 2, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
+    ASSERT_IS_NULL(httpHandle);
 
     /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_084: [ The HTTPAPI_CloseConnection shall wait, at least, 10 seconds for the SSL close process. ]*/
-TEST_FUNCTION(HTTPAPI_CloseConnection__close_on_dowork_retry_n_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_077: [ The HTTPAPI_ExecuteRequest shall wait, at least, 10 seconds for the SSL open process. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall block on the transport until it can make progress, and only poll it between retries when the transport cannot wait on its own. ]*/
+TEST_FUNCTION(HTTPAPI_CreateConnection__retry_open_succeed)
 {
     /// arrange
-	int i;
-    unsigned int statusCode;
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
-    HTTP_HANDLE httpHandle = createHttpConnection();
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rc_error;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-
-    xio_close_shallReturn = 0;
-    DoworkJobsCloseSuccess = false;
-    SkipDoworkJobsCloseResult = 90;
-    call_on_io_close_complete_in_xio_close = false;
-
-    STRICT_EXPECTED_CALL(xio_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    for (i = 0; i < SkipDoworkJobsCloseResult + 1; i++)
-    {
-        STRICT_EXPECTED_CALL(xio_dowork(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    }
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
+    HTTP_HANDLE httpHandle;
+    HTTPAPI_Init();
+    resetXioMock();
+    DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
+    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
+    SkipDoworkJobsOpenResult = 49;
 
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
-    ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
+    setupAllCallBeforeOpenHTTPsequence();
+    setupAllCallForOpenHTTPsequence(50);
 
     /// act
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    httpHandle = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 4 */
 
-                                            /// assert
+    /// assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 2, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS, currentmalloc_call);
+    ASSERT_IS_NOT_NULL(httpHandle);
+    /* the last of the 48 waits only blocks for what is left of the open budget */
+    ASSERT_ARE_EQUAL(int, TEST_OPEN_TIMEOUT_IN_MILLISECONDS - (48 * FAKE_CLOCK_STEP_IN_MILLISECONDS), (int)xio_setoption_io_wait_ms);
 
     /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_085: [ If the HTTPAPI_CloseConnection retries 10 seconds to close the connection without success, it shall destroy the connection anyway. ]*/
-TEST_FUNCTION(HTTPAPI_CloseConnection__close_timeout_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall block on the transport until it can make progress, and only poll it between retries when the transport cannot wait on its own. ]*/
+TEST_FUNCTION(HTTPAPI_CreateConnection__io_wait_unsupported_polls_with_sleep_succeed)
 {
     /// arrange
-	int i;
-    unsigned int statusCode;
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
-    HTTP_HANDLE httpHandle = createHttpConnection();
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
+    HTTP_HANDLE httpHandle;
+    HTTPAPI_Init();
+    resetXioMock();
+    DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
+    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
+    SkipDoworkJobsOpenResult = 3;
+    xio_setoption_io_wait_shallReturn = __FAILURE__;
 
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
+    setupAllCallBeforeOpenHTTPsequence();
+    setupDowork();
+    setupTickCounter();
+    setupDowork();
+    /* the transport refuses the first wait, so that one and all the following sleep instead */
+    setupWaitForIO();
+    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(10));
+    setupDowork();
+    setupTickCounter();
+    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(10));
+    setupDowork();
 
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
+    /// act
+    httpHandle = HTTPAPI_CreateConnection(TEST_CREATE_CONNECTION_HOST_NAME);	/* currentmalloc_call += 4 */
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    /// assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS, currentmalloc_call);
+    ASSERT_IS_NOT_NULL(httpHandle);
 
-    xio_close_shallReturn = 0;
-    DoworkJobsCloseSuccess = true;
-    SkipDoworkJobsCloseResult = 101;
-    call_on_io_close_complete_in_xio_close = false;
+    /// cleanup
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
+    HTTPAPI_Deinit();
+}
 
-    STRICT_EXPECTED_CALL(xio_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    for (i = 0; i < SkipDoworkJobsCloseResult; i++)
-    {
-        STRICT_EXPECTED_CALL(xio_dowork(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    }
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_destroy(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
+/* HTTPAPI_CloseConnection */
 
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
-    ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
+/*Tests_SRS_HTTPAPI_COMPACT_21_017: [ The HTTPAPI_CloseConnection shall close the connection previously created in HTTPAPI_ExecuteRequest. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_076: [ After close the connection, The HTTPAPI_CloseConnection shall destroy the connection previously created in HTTPAPI_CreateConnection. ]*/
+TEST_FUNCTION(HTTPAPI_CloseConnection__valid_hostName_Succeed)
+{
+    /// arrange
+    HTTP_HANDLE httpHandle = createHttpConnection();
+    setupAllCallBeforeCloseHTTPsequence();
+    setupAllCallForDestroyHTTPsequence(0);
 
     /// act
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
 
-                                            /// assert
+    /// assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 2, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
 
     /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
     HTTPAPI_Deinit();
 }
 
-/* HTTPAPI_ExecuteRequest */
-
-/*Tests_SRS_HTTPAPI_COMPACT_21_034: [ If there is no previous connection, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__NULL_handle_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_020: [ If the connection handle is NULL, the HTTPAPI_CloseConnection shall not do anything. ]*/
+TEST_FUNCTION(HTTPAPI_CloseConnection__handle_NULL_Succeed)
 {
     /// arrange
-    unsigned int statusCode;
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    HTTP_HANDLE httpHandle = NULL;
+    HTTPAPI_Init();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        (HTTP_HANDLE)NULL,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 0 */
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 2, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
 
     /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_037: [ If the request type is unknown, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__invalid_request_type_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_018: [ If there is a certificate associated to this connection, the HTTPAPI_CloseConnection shall free all allocated memory for the certificate. ]*/
+TEST_FUNCTION(HTTPAPI_CloseConnection__free_certificate_memory_succeed)
 {
     /// arrange
-    unsigned int statusCode;
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    setHttpCertificate(httpHandle);
+    setupAllCallBeforeCloseHTTPsequence();
+    setupAllCallForDestroyHTTPsequence(1);
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        (HTTPAPI_REQUEST_TYPE)COUNT_ARG(HTTPAPI_REQUEST_TYPE_VALUES),
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 4, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
 
     /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 2 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_039: [ If the relativePath is NULL or invalid, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__NULL_relative_path_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_06_001: [ If there is a x509 client certificate associated to this connection, the HTTAPI_CloseConnection shall free all allocated memory for the certificate. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_06_002: [ If there is a x509 client private key associated to this connection, then HTTP_CloseConnection shall free all the allocated memory for the private key. ]*/
+TEST_FUNCTION(HTTPAPI_CloseConnection__free_x509client_memory_succeed)
 {
     /// arrange
-    unsigned int statusCode;
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    setHttpx509ClientCertificateAndKey(httpHandle);
+    setupAllCallBeforeCloseHTTPsequence();
+    setupAllCallForDestroyHTTPsequence(2);
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        NULL,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 6 */
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 4, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
 
     /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 2 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_041: [ If the httpHeadersHandle is NULL or invalid, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__NULL_http_headers_handle_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_087: [ If the xio return anything different than 0, the HTTPAPI_CloseConnection shall destroy the connection anyway. ]*/
+TEST_FUNCTION(HTTPAPI_CloseConnection__return_LINE_failed)
 {
     /// arrange
-    unsigned int statusCode;
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    xio_close_shallReturn = __FAILURE__;
+
+    STRICT_EXPECTED_CALL(xio_close(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+    setupAllCallForDestroyHTTPsequence(0);
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        (HTTP_HEADERS_HANDLE)NULL,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 4, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
 
     /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 2 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_041: [ If the httpHeadersHandle is NULL or invalid, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__invalid_http_headers_handle_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_084: [ The HTTPAPI_CloseConnection shall wait, at least, 10 seconds for the SSL close process. ]*/
+TEST_FUNCTION(HTTPAPI_CloseConnection__close_on_dowork_succeed)
 {
     /// arrange
-    unsigned int statusCode;
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    HTTPHeaders_GetHeaderCount_shallReturn = HTTP_HEADERS_INVALID_ARG;
+    DoworkJobs = (const xio_dowork_job*)doworkjob_ce;
+    call_on_io_close_complete_in_xio_close = false;
 
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderCount(requestHttpHeaders, IGNORED_PTR_ARG))
-        .IgnoreArgument(2);
+    setupAllCallBeforeCloseHTTPsequence();
+    setupDowork();
+    setupAllCallForDestroyHTTPsequence(0);
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 4, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
 
     /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 2 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_054: [ If Http header maker cannot provide the number of headers, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__http_headers_handle_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_084: [ The HTTPAPI_CloseConnection shall wait, at least, 10 seconds for the SSL close process. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_086: [ The HTTPAPI_CloseConnection shall block on the transport until the close can make progress, and only poll it between retries when the transport cannot wait on its own. ]*/
+TEST_FUNCTION(HTTPAPI_CloseConnection__close_on_dowork_retry_n_succeed)
 {
     /// arrange
-    unsigned int statusCode;
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    HTTPHeaders_GetHeaderCount_shallReturn = HTTP_HEADERS_ERROR;
+    DoworkJobs = (const xio_dowork_job*)doworkjob_ce;
+    SkipDoworkJobsCloseResult = 90;
+    call_on_io_close_complete_in_xio_close = false;
 
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderCount(requestHttpHeaders, IGNORED_PTR_ARG))
-        .IgnoreArgument(2);
+    setupAllCallBeforeCloseHTTPsequence();
+    setupDoworkRetries(91);
+    setupAllCallForDestroyHTTPsequence(0);
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 4, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
 
     /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 2 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_023: [ If the transport failed setting the Certificate, the HTTPAPI_ExecuteRequest shall not send any request and return HTTPAPI_SET_OPTION_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__certificate_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_084: [ The HTTPAPI_CloseConnection shall wait, at least, 10 seconds for the SSL close process. ]*/
+TEST_FUNCTION(HTTPAPI_CloseConnection__close_on_dowork_retry_n_failed)
 {
     /// arrange
-    unsigned int statusCode;
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
+    DoworkJobs = (const xio_dowork_job*)doworkjob_c_error;
+    DoworkJobsCloseSuccess = false;
+    SkipDoworkJobsCloseResult = 90;
+    call_on_io_close_complete_in_xio_close = false;
 
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-    xio_setoption_shallReturn = __FAILURE__;
-
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderCount(requestHttpHeaders, IGNORED_PTR_ARG))
-        .IgnoreArgument(2);
-    STRICT_EXPECTED_CALL(xio_setoption(IGNORED_PTR_ARG, "TrustedCerts", TEST_SETOPTIONS_CERTIFICATE))
-        .IgnoreArgument(1)
-        .IgnoreArgument(3);
+    setupAllCallBeforeCloseHTTPsequence();
+    setupDoworkRetries(92);
+    setupAllCallForDestroyHTTPsequence(0);
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_SET_OPTION_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
 
     /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_06_005: [ If the transport failed setting the client certificate, the HTTPAPI_ExecuteRequest shall not send any request and return HTTPAPI_SET_OPTION_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__x509client_certificate_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_085: [ If the HTTPAPI_CloseConnection retries 10 seconds to close the connection without success, it shall destroy the connection anyway. ]*/
+TEST_FUNCTION(HTTPAPI_CloseConnection__close_timeout_failed)
 {
     /// arrange
-    unsigned int statusCode;
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
+    DoworkJobs = (const xio_dowork_job*)doworkjob_ce;
+    SkipDoworkJobsCloseResult = TEST_CLOSE_TIMEOUT_IN_MILLISECONDS / FAKE_CLOCK_STEP_IN_MILLISECONDS;
+    call_on_io_close_complete_in_xio_close = false;
 
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    HTTPAPI_SetOption(httpHandle, SU_OPTION_X509_CERT, TEST_SETOPTIONS_X509CLIENTCERT);				/* currentmalloc_call += 1 */
-
-    xio_setoption_shallReturn = __FAILURE__;
-
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderCount(requestHttpHeaders, IGNORED_PTR_ARG))
-        .IgnoreArgument(2);
-    STRICT_EXPECTED_CALL(xio_setoption(IGNORED_PTR_ARG, SU_OPTION_X509_CERT, TEST_SETOPTIONS_X509CLIENTCERT))
-        .IgnoreArgument(1)
-        .IgnoreArgument(3);
+    setupAllCallBeforeCloseHTTPsequence();
+    setupDoworkRetries(TEST_CLOSE_TIMEOUT_IN_MILLISECONDS / FAKE_CLOCK_STEP_IN_MILLISECONDS);
+    setupWaitTimeout();
+    setupAllCallForDestroyHTTPsequence(0);
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_SET_OPTION_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
 
     /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_06_006: [ If the transport failed setting the client certificate private key, the HTTPAPI_ExecuteRequest shall not send any request and return HTTPAPI_SET_OPTION_FAILED. ] */
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__x509client_privatekey_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_086: [ The HTTPAPI_CloseConnection shall block on the transport until the close can make progress, and only poll it between retries when the transport cannot wait on its own. ]*/
+TEST_FUNCTION(HTTPAPI_CloseConnection__io_wait_unsupported_polls_with_sleep_succeed)
 {
     /// arrange
-    unsigned int statusCode;
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
+    DoworkJobs = (const xio_dowork_job*)doworkjob_ce;
+    SkipDoworkJobsCloseResult = 1;
+    call_on_io_close_complete_in_xio_close = false;
+    xio_setoption_io_wait_shallReturn = __FAILURE__;
 
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    HTTPAPI_SetOption(httpHandle, SU_OPTION_X509_PRIVATE_KEY, TEST_SETOPTIONS_X509PRIVATEKEY);				/* currentmalloc_call += 1 */
-
-    xio_setoption_shallReturn = __FAILURE__;
-
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderCount(requestHttpHeaders, IGNORED_PTR_ARG))
-        .IgnoreArgument(2);
-    STRICT_EXPECTED_CALL(xio_setoption(IGNORED_PTR_ARG, SU_OPTION_X509_PRIVATE_KEY, TEST_SETOPTIONS_X509PRIVATEKEY))
-        .IgnoreArgument(1)
-        .IgnoreArgument(3);
+    setupAllCallBeforeCloseHTTPsequence();
+    setupDowork();
+    setupWaitForIO();
+    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
+    setupDowork();
+    setupAllCallForDestroyHTTPsequence(0);
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_SET_OPTION_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, 0, currentmalloc_call);
 
     /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
     HTTPAPI_Deinit();
 }
 
@@ -1725,10 +1576,10 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__certificate_out_of_memory_failed)
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_ALLOC_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 2, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS, currentmalloc_call);
 
     /// cleanup
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 2 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
     HTTPAPI_Deinit();
 }
 
@@ -1749,10 +1600,10 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__certificate_succeed)
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 3, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 1, currentmalloc_call);
 
     /// cleanup
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
@@ -1787,10 +1638,10 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__certificate_NULL_optionName_failed)
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 2, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS, currentmalloc_call);
 
     /// cleanup
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 2 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
     HTTPAPI_Deinit();
 }
 
@@ -1808,10 +1659,10 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__certificate_invalid_optionName_failed)
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 2, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS, currentmalloc_call);
 
     /// cleanup
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 2 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
     HTTPAPI_Deinit();
 }
 
@@ -1829,10 +1680,10 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__certificate_NULL_value_failed)
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 2, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS, currentmalloc_call);
 
     /// cleanup
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 2 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
     HTTPAPI_Deinit();
 }
 
@@ -1955,127 +1806,37 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__clone_certificate_invalid_optionName_faile
     /// cleanup
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_025: [ If the open process failed, the HTTPAPI_ExecuteRequest shall not send any request and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__xoi_open_returns_LINE_failed)
-{
-    /// arrange
-    unsigned int statusCode;
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
-    HTTP_HANDLE httpHandle = createHttpConnection();
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-    xio_open_shallReturn = __FAILURE__;
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 0, false);
-
-    /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
-
-    /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_OPEN_REQUEST_FAILED, result);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
-
-    /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
-    HTTPAPI_Deinit();
-}
-
-/*Tests_SRS_HTTPAPI_COMPACT_21_025: [ If the open process failed, the HTTPAPI_ExecuteRequest shall not send any request and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_io_open_complete_with_error_on_openning_failed)
-{
-    /// arrange
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
-	HTTP_HANDLE httpHandle;
-    unsigned int statusCode;
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    httpHandle = createHttpConnection();
-    setHttpCertificate(httpHandle);
-
-    DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
-    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_error;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-
-    /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
-
-    /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_OPEN_REQUEST_FAILED, result);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
 
-    /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
-    HTTPAPI_Deinit();
-}
+/* HTTPAPI_ExecuteRequest */
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_025: [ If the open process failed, the HTTPAPI_ExecuteRequest shall not send any request and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_io_open_complete_with_error_on_working_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_034: [ If there is no previous connection, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__NULL_handle_failed)
 {
     /// arrange
     unsigned int statusCode;
     HTTPAPI_RESULT result;
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
-    HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
 
-    DoworkJobs = (const xio_dowork_job*) doworkjob_4none_oe;
-    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_error;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 5, false);
+    setupAllCallBeforeExecuteHTTPsequence(NULL);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest((HTTP_HANDLE)NULL, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_OPEN_REQUEST_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, 2, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_077: [ The HTTPAPI_ExecuteRequest shall wait, at least, 10 seconds for the SSL open process. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_078: [ If the HTTPAPI_ExecuteRequest cannot open the connection in 10 seconds, it shall fail and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_io_open_complete_with_error_after_n_retry_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_037: [ If the request type is unknown, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__invalid_request_type_failed)
 {
     /// arrange
     unsigned int statusCode;
@@ -2084,40 +1845,26 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_io_open_complete_with_error_after_n_ret
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobs = (const xio_dowork_job*)doworkjob_4none_oe;
-    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_error;
 
-    SkipDoworkJobsOpenResult = 5;
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, SkipDoworkJobsOpenResult+5, false);
+    setupAllCallBeforeExecuteHTTPsequence(NULL);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, (HTTPAPI_REQUEST_TYPE)COUNT_ARG(HTTPAPI_REQUEST_TYPE_VALUES), requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_OPEN_REQUEST_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 2, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
     HTTPAPI_Deinit();
 }
-
-/*Tests_SRS_HTTPAPI_COMPACT_21_077: [ The HTTPAPI_ExecuteRequest shall wait, at least, 10 seconds for the SSL open process. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_078: [ If the HTTPAPI_ExecuteRequest cannot open the connection in 10 seconds, it shall fail and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_io_open_complete_with_timeout_failed)
+
+/*Tests_SRS_HTTPAPI_COMPACT_21_039: [ If the relativePath is NULL or invalid, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__NULL_relative_path_failed)
 {
     /// arrange
     unsigned int statusCode;
@@ -2126,21 +1873,15 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_io_open_complete_with_timeout_failed)
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
 
-    DoworkJobs = (const xio_dowork_job*)doworkjob_4none_oe;
-    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
-
-    SkipDoworkJobsOpenResult = 98;
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, SkipDoworkJobsOpenResult + 4, false);
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
+    setupAllCallBeforeExecuteHTTPsequence(NULL);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
     result = HTTPAPI_ExecuteRequest(
         httpHandle,
         HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
+        NULL,
         requestHttpHeaders,
         TEST_EXECUTE_REQUEST_CONTENT,
         TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
@@ -2149,18 +1890,18 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_io_open_complete_with_timeout_failed)
         TestBufferHandle);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_OPEN_REQUEST_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 2, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_025: [ If the open process failed, the HTTPAPI_ExecuteRequest shall not send any request and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_io_error_on_openning_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_041: [ If the httpHeadersHandle is NULL or invalid, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__NULL_http_headers_handle_failed)
 {
     /// arrange
     unsigned int statusCode;
@@ -2169,37 +1910,26 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_io_error_on_openning_failed)
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobs = (const xio_dowork_job*)doworkjob_ee;
 
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeExecuteHTTPsequence(NULL);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, (HTTP_HEADERS_HANDLE)NULL, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_OPEN_REQUEST_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 2, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_025: [ If the open process failed, the HTTPAPI_ExecuteRequest shall not send any request and return HTTPAPI_OPEN_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_io_error_on_working_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_041: [ If the httpHeadersHandle is NULL or invalid, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__invalid_http_headers_handle_failed)
 {
     /// arrange
     unsigned int statusCode;
@@ -2208,37 +1938,27 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_io_error_on_working_failed)
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobs = (const xio_dowork_job*)doworkjob_4none_ee;
+    HTTPHeaders_GetHeaderCount_shallReturn = HTTP_HEADERS_INVALID_ARG;
 
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 5, false);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_OPEN_REQUEST_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 2, currentmalloc_call);
 
     /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders);	/* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__huge_relative_path_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_054: [ If Http header maker cannot provide the number of headers, the HTTPAPI_ExecuteRequest shall return HTTPAPI_INVALID_ARG. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__http_headers_handle_failed)
 {
     /// arrange
     unsigned int statusCode;
@@ -2246,52 +1966,28 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__huge_relative_path_failed)
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
-    size_t i;
-    char hugeRelativePath[HUGE_RELATIVE_PATH_SIZE];
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    HTTPHeaders_GetHeaderCount_shallReturn = HTTP_HEADERS_ERROR;
 
-    DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
-    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
-
-    setHttpCertificate(httpHandle);
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-
-    for (i = 0; i < HUGE_RELATIVE_PATH_SIZE; i++)
-    {
-        hugeRelativePath[i] = 'a';
-    }
-    hugeRelativePath[HUGE_RELATIVE_PATH_SIZE - 1] = '\0';
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        hugeRelativePath,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_STRING_PROCESSING_ERROR, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 2, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_026: [ If the open process succeed, the HTTPAPI_ExecuteRequest shall send the request message to the host. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_024: [ The HTTPAPI_ExecuteRequest shall open the transport connection with the host to send the request. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_022: [ If a Certificate was provided, the HTTPAPI_ExecuteRequest shall set this option on the transport layer. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_06_003: [ If the x509 client certificate is provided, the HTTPAPI_ExecuteRequest shall set this option on the transport layer. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_06_004: [ If the x509 client certificate private key is provided, the HTTPAPI_ExecuteRequest shall set this optionon the transport layer. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_SEND_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__io_send_header_return_error_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_027: [ If the HTTPAPI_ExecuteRequest cannot create a buffer to send the request, it shall not send any request and return HTTPAPI_STRING_PROCESSING_ERROR. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__get_header_failed)
 {
     /// arrange
     unsigned int statusCode;
@@ -2300,42 +1996,29 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__io_send_header_return_error_failed)
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_ERROR;
 
-    DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
-    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
-
-    setHttpCertificate(httpHandle);
-    setHttpx509ClientCertificateAndKey(httpHandle);
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, true);
-    xio_send_shallReturn = (const int*)xio_send_e;
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderNameValue(requestHttpHeaders, 0, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(3).IgnoreArgument(4);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_SEND_REQUEST_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_STRING_PROCESSING_ERROR, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 7, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 2, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_SEND_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_success_before_error_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_052: [ If any memory allocation get fail, the HTTPAPI_ExecuteRequest shall return HTTPAPI_ALLOC_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__huge_relative_path_failed)
 {
     /// arrange
     unsigned int statusCode;
@@ -2344,51 +2027,34 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_success_befor
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
-    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
-    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_o_3error;
-    xio_send_shallReturn = (const int*)xio_send_0_e;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    /* the connection, the header objects and the internal content buffer fit, the request buffer does not */
+    whenShallmalloc_fail = TEST_CONNECTION_ALLOCATIONS + 4;
+
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderNameValue(requestHttpHeaders, 0, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(3).IgnoreArgument(4);
+    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeaderNameValue(requestHttpHeaders, 1, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(3).IgnoreArgument(4);
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+        .IgnoreArgument(2);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_SEND_REQUEST_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_ALLOC_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 2, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 4 */
     HTTPAPI_Deinit();
 }
 
 /*Tests_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_SEND_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_2_success_before_error_failed)
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__io_send_header_return_error_failed)
 {
     /// arrange
     unsigned int statusCode;
@@ -2397,169 +2063,102 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_2_success_bef
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
-    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
-    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_o_3error;
-    xio_send_shallReturn = (const int*)xio_send_00_e;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
+    xio_send_shallReturn = (const int*)xio_send_e;
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequence(requestHttpHeaders);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_SEND_REQUEST_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_079: [ The HTTPAPI_ExecuteRequest shall wait, at least, 20 seconds to send a buffer using the SSL connection. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_080: [ If the HTTPAPI_ExecuteRequest retries to send the message for 20 seconds without success, it shall fail and return HTTPAPI_SEND_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_timeout_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_029: [ If the HTTPAPI_ExecuteRequest cannot send the buffer with the request, it shall return HTTPAPI_SEND_REQUEST_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_success_before_error_failed)
 {
     /// arrange
-	int i;
     unsigned int statusCode;
     HTTPAPI_RESULT result;
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
+    unsigned char hugeContent[HUGE_CONTENT_SIZE];
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobs = (const xio_dowork_job*)doworkjob_ose;
-    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
-    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_o_3error;
-    xio_send_shallReturn = (const int*)xio_send_00_e;
-    call_on_send_complete_in_xio_send = false;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    SkipDoworkJobsSendResult = 200;
-    for (i = 0; i < SkipDoworkJobsSendResult; i++)
-    {
-        STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    }
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
+    (void)memset(hugeContent, 'a', sizeof(hugeContent));
+    xio_send_shallReturn = (const int*)xio_send_0_e;
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    /* a content that does not fit in the request head goes out in a second write */
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, hugeContent, HUGE_CONTENT_SIZE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1).IgnoreArgument(4).IgnoreArgument(5);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_POST, requestHttpHeaders, hugeContent, sizeof(hugeContent), &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_SEND_REQUEST_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_079: [ The HTTPAPI_ExecuteRequest shall wait, at least, 20 seconds to send a buffer using the SSL connection. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_080: [ If the HTTPAPI_ExecuteRequest retries to send the message for 20 seconds without success, it shall fail and return HTTPAPI_SEND_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_retry_n_and_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_028: [ If the HTTPAPI_ExecuteRequest cannot send the request header, it shall return HTTPAPI_SEND_REQUEST_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_with_2_success_before_error_failed)
 {
     /// arrange
-	int i;
     unsigned int statusCode;
     HTTPAPI_RESULT result;
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
+    unsigned char hugeContent[HUGE_CONTENT_SIZE];
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobs = (const xio_dowork_job*)doworkjob_ose;
-    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
-    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_error;
-    xio_send_shallReturn = (const int*)xio_send_00_e;
+    (void)memset(hugeContent, 'a', sizeof(hugeContent));
     call_on_send_complete_in_xio_send = false;
+    DoworkJobs = (const xio_dowork_job*)doworkjob_s_error;
+    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_ok;
 
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    SkipDoworkJobsSendResult = 10;
-    for (i = 0; i < SkipDoworkJobsSendResult; i++)
-    {
-        STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    }
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    setupDowork();
+    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, hugeContent, HUGE_CONTENT_SIZE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1).IgnoreArgument(4).IgnoreArgument(5);
+    setupTickCounter();
+    setupDowork();
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_POST, requestHttpHeaders, hugeContent, sizeof(hugeContent), &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_SEND_REQUEST_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_029: [ If the HTTPAPI_ExecuteRequest cannot send the buffer with the request, it shall return HTTPAPI_SEND_REQUEST_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_buffer_complete_with_error_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_080: [ If the HTTPAPI_ExecuteRequest retries to send the message for 20 seconds without success, it shall fail and return HTTPAPI_SEND_REQUEST_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_timeout_failed)
 {
     /// arrange
     unsigned int statusCode;
@@ -2568,69 +2167,33 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_buffer_complete_with_error_failed)
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobs = (const xio_dowork_job*)doworkjob_oe;
-    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
-    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_6ok_error;
-    xio_send_shallReturn = (const int*)xio_send_6x0_e;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    call_on_send_complete_in_xio_send = false;
+    DoworkJobs = (const xio_dowork_job*)doworkjob_se;
+    SkipDoworkJobsSendResult = TEST_SEND_TIMEOUT_IN_MILLISECONDS / FAKE_CLOCK_STEP_IN_MILLISECONDS;
 
-    /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    setupDoworkRetries(TEST_SEND_TIMEOUT_IN_MILLISECONDS / FAKE_CLOCK_STEP_IN_MILLISECONDS);
+    setupWaitTimeout();
+    setupAllCallAfterExecuteHTTPsequence();
+
+    /// act
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_SEND_REQUEST_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_030: [ At the end of the transmission, the HTTPAPI_ExecuteRequest shall receive the response from the host. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_header_failed_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_079: [ The HTTPAPI_ExecuteRequest shall wait, at least, 20 seconds to send a buffer using the SSL connection. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall block on the transport until it can make progress, and only poll it between retries when the transport cannot wait on its own. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_header_complete_retry_n_and_failed)
 {
     /// arrange
     unsigned int statusCode;
@@ -2639,95 +2202,71 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_header_failed_failed)
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobs = (const xio_dowork_job*)doworkjob_oee;
-    DoworkJobsOpenResult = (const IO_OPEN_RESULT*)openresult_ok;
-    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_7ok;
+    call_on_send_complete_in_xio_send = false;
+    DoworkJobs = (const xio_dowork_job*)doworkjob_se;
+    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_error;
+    SkipDoworkJobsSendResult = 10;
 
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    setupDoworkRetries(11);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_READ_DATA_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_SEND_REQUEST_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_NULL_header_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_029: [ If the HTTPAPI_ExecuteRequest cannot send the buffer with the request, it shall return HTTPAPI_SEND_REQUEST_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_send_buffer_complete_with_error_failed)
 {
     /// arrange
     unsigned int statusCode;
     HTTPAPI_RESULT result;
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
+    unsigned char hugeContent[HUGE_CONTENT_SIZE];
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobsReceivedBuffer = NULL;
-    DoworkJobsReceivedBuffer_size[0] = 10;
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_re;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
+    (void)memset(hugeContent, 'a', sizeof(hugeContent));
+    call_on_send_complete_in_xio_send = false;
+    DoworkJobs = (const xio_dowork_job*)doworkjob_sse;
+    DoworkJobsSendResult = (const IO_SEND_RESULT*)sendresult_ok_error;
 
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    setupDowork();
+    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, hugeContent, HUGE_CONTENT_SIZE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1).IgnoreArgument(4).IgnoreArgument(5);
+    setupTickCounter();
+    setupDowork();
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_POST, requestHttpHeaders, hugeContent, sizeof(hugeContent), &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_READ_DATA_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_SEND_REQUEST_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_not_HTTP_header_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_header_failed_failed)
 {
     /// arrange
     unsigned int statusCode;
@@ -2736,524 +2275,342 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_not_HTTP_header_failed)
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobsReceivedBuffer = (const unsigned char*)"HTTPS/111.222 433 555\r\n";
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_re;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
+    DoworkJobs = (const xio_dowork_job*)doworkjob_ee;
 
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, DoworkJobsReceivedBuffer_size[0])).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    setupTickCounter();
+    setupDowork();
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_RECEIVE_RESPONSE_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_READ_DATA_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_wrong_URL_header_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_NULL_header_failed)
 {
     /// arrange
     unsigned int statusCode;
     HTTPAPI_RESULT result;
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
-    int doworkReduction[1] = { 0 };
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
+    DoworkJobsReceivedBuffer = NULL;
+    DoworkJobsReceivedBuffer_size[0] = 10;
+    DoworkJobs = (const xio_dowork_job*)doworkjob_re;
 
-    DoworkJobsReceivedBuffer = (const unsigned char*)"HTTP/111222 433 555\r\n";
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    PrepareReceiveHead(requestHttpHeaders, DoworkJobsReceivedBuffer_size, doworkReduction, 1);
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_re;
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    setupTickCounter();
+    setupDowork();
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_RECEIVE_RESPONSE_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_READ_DATA_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
 /*Tests_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_header_with_no_statusCode_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_073: [ The message received by the HTTPAPI_ExecuteRequest shall starts with a valid header. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_not_HTTP_header_failed)
 {
     /// arrange
     unsigned int statusCode;
     HTTPAPI_RESULT result;
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
-    int doworkReduction[1] = { 0 };
+    const unsigned char* answer = (const unsigned char*)"HTTPS/111.222 433 555\r\n";
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
+    prepareReceivedAnswer(answer);
 
-    DoworkJobsReceivedBuffer = (const unsigned char*)"HTTP/111.222\r\n";
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    PrepareReceiveHead(requestHttpHeaders, DoworkJobsReceivedBuffer_size, doworkReduction, 1);
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_re;
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    setupAllCallForReceiveWithParserErrorHTTPsequence(strlen((const char*)answer));
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_RECEIVE_RESPONSE_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
 /*Tests_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_header_incomplete_failed)
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_wrong_URL_header_failed)
 {
     /// arrange
     unsigned int statusCode;
     HTTPAPI_RESULT result;
-    int doworkReduction[1] = { 0 };
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
+    const unsigned char* answer = (const unsigned char*)"HTTP/111.222 4x3 555\r\n";
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
+    prepareReceivedAnswer(answer);
 
-    DoworkJobsReceivedBuffer = (const unsigned char*)"HTTP/111\r\n";
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    PrepareReceiveHead(requestHttpHeaders, DoworkJobsReceivedBuffer_size, doworkReduction, 1);
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_re;
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    setupAllCallForReceiveWithParserErrorHTTPsequence(strlen((const char*)answer));
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_RECEIVE_RESPONSE_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
 /*Tests_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_multi_header_with_size_0_and_error_failed)
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_header_with_no_statusCode_failed)
 {
     /// arrange
     unsigned int statusCode;
     HTTPAPI_RESULT result;
-    int doworkReduction[2] = { 0, 0 };
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
+    const unsigned char* answer = (const unsigned char*)"HTTP/111.222\r\n";
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
+    prepareReceivedAnswer(answer);
 
-    DoworkJobsReceivedBuffer = (const unsigned char*)"HTTP/111\r\n";
-    DoworkJobsReceivedBuffer_size[0] = 0;
-    DoworkJobsReceivedBuffer_size[1] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    PrepareReceiveHead(requestHttpHeaders, DoworkJobsReceivedBuffer_size, doworkReduction, 2);
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rre;
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    setupAllCallForReceiveWithParserErrorHTTPsequence(strlen((const char*)answer));
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_RECEIVE_RESPONSE_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__read_huge_header_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_header_incomplete_failed)
 {
     /// arrange
-	HTTP_HANDLE httpHandle;
     unsigned int statusCode;
     HTTPAPI_RESULT result;
-    int doworkReduction[1] = { 0 };
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
-    size_t i;
-    unsigned char hugeBuffer[3000] = "HTTP/111.";
+    const unsigned char* answer = (const unsigned char*)"HTTP/111\r\n";
+    HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    for (i = strlen((const char*)hugeBuffer); i < 3000; i++)
-    {
-        hugeBuffer[i] = 'a';
-    }
-    hugeBuffer[2995] = '\r';
-    hugeBuffer[2996] = '\n';
-    hugeBuffer[2997] = '\r';
-    hugeBuffer[2998] = '\n';
-    hugeBuffer[2999] = '\0';
-
-    httpHandle = createHttpConnection();
-    setHttpCertificate(httpHandle);
+    prepareReceivedAnswer(answer);
 
-    DoworkJobsReceivedBuffer = (const unsigned char*)hugeBuffer;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    PrepareReceiveHead(requestHttpHeaders, DoworkJobsReceivedBuffer_size, doworkReduction, 1);
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_re;
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    setupAllCallForReceiveWithParserErrorHTTPsequence(strlen((const char*)answer));
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_READ_DATA_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_RECEIVE_RESPONSE_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_032: [ If the HTTPAPI_ExecuteRequest cannot read the message with the request result, it shall return HTTPAPI_READ_DATA_FAILED. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__content_length_without_value_failed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__on_read_multi_header_with_size_0_and_error_failed)
 {
     /// arrange
     unsigned int statusCode;
     HTTPAPI_RESULT result;
-    int doworkReduction[1] = { 1 };
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
+    const unsigned char* answer = (const unsigned char*)"HTTP/111\r\n";
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
+    DoworkJobsReceivedBuffer = answer;
+    DoworkJobsReceivedBuffer_size[0] = 0;
+    DoworkJobsReceivedBuffer_size[1] = strlen((const char*)answer);
+    DoworkJobs = (const xio_dowork_job*)doworkjob_rre;
 
-    DoworkJobsReceivedBuffer = (const unsigned char*)"HTTP/111.222 433 555\r\ncontent-length:\r\n\r\n";
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    PrepareReceiveHead(requestHttpHeaders, DoworkJobsReceivedBuffer_size, doworkReduction, 1);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_re;
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    /* an empty read restarts the deadline like any other one */
+    setupTickCounter();
+    setupDowork();
+    setupAllCallForReceiveWithParserErrorHTTPsequence(strlen((const char*)answer));
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_READ_DATA_FAILED, result);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_RECEIVE_RESPONSE_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_031: [ After receive the response, the HTTPAPI_ExecuteRequest shall close the transport connection with the host. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_021: [ The HTTPAPI_ExecuteRequest shall execute the http communtication with the provided host, sending a request and reciving the response. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_040: [ The request shall contain the http header provided in httpHeadersHandle parameter. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_042: [ The request can contain the a content message, provided in content parameter. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_046: [ The HTTPAPI_ExecuteRequest shall return the http status reported by the host in the received response. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_047: [ The HTTPAPI_ExecuteRequest shall report the status in the statusCode parameter. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_050: [ If there is a content in the response, the HTTPAPI_ExecuteRequest shall copy it in the responseContent buffer. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_073: [ The message received by the HTTPAPI_ExecuteRequest shall starts with a valid header. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_074: [ After the header, the message received by the HTTPAPI_ExecuteRequest can contain addition information about the content. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_053: [ The HTTPAPI_ExecuteRequest shall produce a set of http header to send to the host. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_succeed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__read_huge_header_failed)
 {
     /// arrange
     unsigned int statusCode;
     HTTPAPI_RESULT result;
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
+    static const char statusLine[] = "HTTP/111.222 433 555\r\n";
+    static unsigned char answer[sizeof(statusLine) + HUGE_HEADER_SIZE + 4];
+    size_t answerSize;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    /* a header line longer than the parser accepts */
+    (void)memcpy(answer, statusLine, sizeof(statusLine) - 1);
+    (void)memset(answer + sizeof(statusLine) - 1, 'a', HUGE_HEADER_SIZE);
+    (void)memcpy(answer + sizeof(statusLine) - 1 + HUGE_HEADER_SIZE, "\r\n\r\n", 5);
+    answerSize = strlen((const char*)answer);
+    prepareReceivedAnswer(answer);
+
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    setupAllCallForReceiveWithParserErrorHTTPsequence(answerSize - (sizeof(statusLine) - 1));
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
-    ASSERT_ARE_EQUAL(int, 433, statusCode);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_RECEIVE_RESPONSE_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_077: [ The HTTPAPI_ExecuteRequest shall wait, at least, 10 seconds for the SSL open process. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_retry_open_succeed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_055: [ If the HTTPAPI_ExecuteRequest cannot parser the received message, it shall return HTTPAPI_RECEIVE_RESPONSE_FAILED. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__content_length_without_value_failed)
 {
     /// arrange
     unsigned int statusCode;
     HTTPAPI_RESULT result;
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
+    static const char statusLine[] = "HTTP/111.222 433 555\r\n";
+    const unsigned char* answer = (const unsigned char*)"HTTP/111.222 433 555\r\ncontent-length:\r\n\r\n";
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
-
-    SkipDoworkJobsOpenResult = 97;
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, SkipDoworkJobsOpenResult + 1, false);
+    prepareReceivedAnswer(answer);
 
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    setupAllCallForReceiveWithParserErrorHTTPsequence(strlen((const char*)answer) - (sizeof(statusLine) - 1));
+    setupAllCallAfterExecuteHTTPsequence();
 
-    /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    /// act
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
-    ASSERT_ARE_EQUAL(int, 433, statusCode);
+    ASSERT_ARE_EQUAL(int, HTTPAPI_RECEIVE_RESPONSE_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_079: [ The HTTPAPI_ExecuteRequest shall wait, at least, 20 seconds to send a buffer using the SSL connection. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_retry_send_succeed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_030: [ At the end of the transmission, the HTTPAPI_ExecuteRequest shall receive the response from the host. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_031: [ After receive the response, the HTTPAPI_ExecuteRequest shall close the transport connection with the host. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_033: [ If the whole process succeed, the HTTPAPI_ExecuteRequest shall retur HTTPAPI_OK. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_021: [ The HTTPAPI_ExecuteRequest shall execute the http communtication with the provided host, sending a request and reciving the response. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_040: [ The request shall contain the http header provided in httpHeadersHandle parameter. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_042: [ The request can contain the a content message, provided in content parameter. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_046: [ The HTTPAPI_ExecuteRequest shall return the http status reported by the host in the received response. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_047: [ The HTTPAPI_ExecuteRequest shall report the status in the statusCode parameter. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_050: [ If there is a content in the response, the HTTPAPI_ExecuteRequest shall copy it in the responseContent buffer. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_073: [ The message received by the HTTPAPI_ExecuteRequest shall starts with a valid header. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_074: [ After the header, the message received by the HTTPAPI_ExecuteRequest can contain addition information about the content. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_053: [ The HTTPAPI_ExecuteRequest shall produce a set of http header to send to the host. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_succeed)
 {
     /// arrange
     unsigned int statusCode;
-	int i;
     HTTPAPI_RESULT result;
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_sre;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
-    call_on_send_complete_in_xio_send = false;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    SkipDoworkJobsSendResult = 199;
-    for (i = 0; i < SkipDoworkJobsSendResult+1; i++)
-    {
-        STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    }
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
+    prepareReceivedAnswer(TEST_RECEIVED_ANSWER);
 
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess(true);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
     ASSERT_ARE_EQUAL(int, 433, statusCode);
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, 0, memcmp("0123456789", TestBufferContent, 10));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
@@ -3268,33 +2625,16 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_get_succeed)
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
+    prepareReceivedAnswer(TEST_RECEIVED_ANSWER);
+    xio_send_transmited_buffer_target = 1;
 
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-    xio_send_transmited_buffer_target = 1;
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess(true);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
@@ -3302,11 +2642,11 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_get_succeed)
     xio_send_transmited_buffer[3] = '\0';
     ASSERT_ARE_EQUAL(char_ptr, "GET", xio_send_transmited_buffer);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
@@ -3320,33 +2660,16 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_post_succeed)
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    prepareReceivedAnswer(TEST_RECEIVED_ANSWER);
+    xio_send_transmited_buffer_target = 1;
 
-    setHttpCertificate(httpHandle);
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-    xio_send_transmited_buffer_target = 1;
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess(true);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_POST,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_POST, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
@@ -3354,11 +2677,11 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_post_succeed)
     xio_send_transmited_buffer[4] = '\0';
     ASSERT_ARE_EQUAL(char_ptr, "POST", xio_send_transmited_buffer);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
@@ -3372,33 +2695,16 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_put_succeed)
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    prepareReceivedAnswer(TEST_RECEIVED_ANSWER);
+    xio_send_transmited_buffer_target = 1;
 
-    setHttpCertificate(httpHandle);
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-    xio_send_transmited_buffer_target = 1;
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess(true);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_PUT,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_PUT, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
@@ -3406,11 +2712,11 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_put_succeed)
     xio_send_transmited_buffer[3] = '\0';
     ASSERT_ARE_EQUAL(char_ptr, "PUT", xio_send_transmited_buffer);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
@@ -3424,33 +2730,16 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_delete_succeed)
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    prepareReceivedAnswer(TEST_RECEIVED_ANSWER);
+    xio_send_transmited_buffer_target = 1;
 
-    setHttpCertificate(httpHandle);
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-    xio_send_transmited_buffer_target = 1;
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess(true);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_DELETE,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_DELETE, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
@@ -3458,11 +2747,11 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_delete_succeed)
     xio_send_transmited_buffer[6] = '\0';
     ASSERT_ARE_EQUAL(char_ptr, "DELETE", xio_send_transmited_buffer);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
@@ -3476,33 +2765,16 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_patch_succeed)
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    prepareReceivedAnswer(TEST_RECEIVED_ANSWER);
+    xio_send_transmited_buffer_target = 1;
 
-    setHttpCertificate(httpHandle);
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-    xio_send_transmited_buffer_target = 1;
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess(true);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_PATCH,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_PATCH, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
@@ -3510,11 +2782,11 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_patch_succeed)
     xio_send_transmited_buffer[5] = '\0';
     ASSERT_ARE_EQUAL(char_ptr, "PATCH", xio_send_transmited_buffer);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
@@ -3528,45 +2800,28 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_relative_path_succeed)
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    prepareReceivedAnswer(TEST_RECEIVED_ANSWER);
+    xio_send_transmited_buffer_target = 1;
 
-    setHttpCertificate(httpHandle);
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-    xio_send_transmited_buffer_target = 1;
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess(true);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
     ASSERT_ARE_EQUAL(int, 433, statusCode);
-    xio_send_transmited_buffer[66] = '\0';
+    xio_send_transmited_buffer[4 + strlen(TEST_EXECUTE_REQUEST_RELATIVE_PATH)] = '\0';
     ASSERT_ARE_EQUAL(char_ptr, TEST_EXECUTE_REQUEST_RELATIVE_PATH, &(xio_send_transmited_buffer[4]));
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
@@ -3581,122 +2836,35 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_with_content_succeed)
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-
-    setHttpCertificate(httpHandle);
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-    xio_send_transmited_buffer_target = 7;
-
-    /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
-
-    /// assert
-    ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
-    ASSERT_ARE_EQUAL(int, 433, statusCode);
-    ASSERT_ARE_EQUAL(char_ptr, (const char*)TEST_EXECUTE_REQUEST_CONTENT, xio_send_transmited_buffer);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
-
-    /// cleanup
-    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
-    HTTPAPI_Deinit();
-}
-
-/*Tests_SRS_HTTPAPI_COMPACT_21_043: [ If the content is NULL, the HTTPAPI_ExecuteRequest shall send the request without content. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_NULL_content_succeed)
-{
-    /// arrange
-    unsigned int statusCode;
-    HTTPAPI_RESULT result;
-    HTTP_HEADERS_HANDLE requestHttpHeaders;
-    HTTP_HEADERS_HANDLE responseHttpHeaders;
-    HTTP_HANDLE httpHandle = createHttpConnection();
-    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-
-    setHttpCertificate(httpHandle);
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    prepareReceivedAnswer(TEST_RECEIVED_ANSWER);
+    xio_send_transmited_buffer_target = 1;
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-    xio_send_transmited_buffer_target = 7;
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess(true);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        NULL,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
     ASSERT_ARE_EQUAL(int, 433, statusCode);
-    ASSERT_ARE_EQUAL(char_ptr, (const char*)"", xio_send_transmited_buffer);
+    /* a small content goes out in the same write as the request head */
+    ASSERT_IS_NOT_NULL(strstr(xio_send_transmited_buffer, "\r\n\r\n"));
+    ASSERT_ARE_EQUAL(char_ptr, (const char*)TEST_EXECUTE_REQUEST_CONTENT, strstr(xio_send_transmited_buffer, "\r\n\r\n") + 4);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_045: [ If the contentLength is lower than one, the HTTPAPI_ExecuteRequest shall send the request without content. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_content_size_0_succeed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_043: [ If the content is NULL, the HTTPAPI_ExecuteRequest shall send the request without content. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_NULL_content_succeed)
 {
     /// arrange
     unsigned int statusCode;
@@ -3705,66 +2873,63 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_content_size_0_succeed)
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    prepareReceivedAnswer(TEST_RECEIVED_ANSWER);
+    xio_send_transmited_buffer_target = 1;
 
-    setHttpCertificate(httpHandle);
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess(true);
+    setupAllCallAfterExecuteHTTPsequence();
 
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    /// act
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, NULL, 0, &statusCode, responseHttpHeaders);
 
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
+    /// assert
+    ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(int, 433, statusCode);
+    ASSERT_IS_NOT_NULL(strstr(xio_send_transmited_buffer, "\r\n\r\n"));
+    ASSERT_ARE_EQUAL(char_ptr, "", strstr(xio_send_transmited_buffer, "\r\n\r\n") + 4);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
-    xio_send_transmited_buffer_target = 7;
+    /// cleanup
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
+    HTTPAPI_Deinit();
+}
+
+/*Tests_SRS_HTTPAPI_COMPACT_21_044: [ If the content is not NULL, the number of bytes in the content shall be provided in contentLength parameter. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_content_size_0_succeed)
+{
+    /// arrange
+    unsigned int statusCode;
+    HTTPAPI_RESULT result;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    HTTP_HANDLE httpHandle = createHttpConnection();
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    prepareReceivedAnswer(TEST_RECEIVED_ANSWER);
+    xio_send_transmited_buffer_target = 1;
+
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess(true);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        0,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, 0, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
     ASSERT_ARE_EQUAL(int, 433, statusCode);
-    ASSERT_ARE_EQUAL(char_ptr, (const char*)"", xio_send_transmited_buffer);
+    ASSERT_IS_NOT_NULL(strstr(xio_send_transmited_buffer, "\r\n\r\n"));
+    ASSERT_ARE_EQUAL(char_ptr, "", strstr(xio_send_transmited_buffer, "\r\n\r\n") + 4);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
@@ -3772,46 +2937,30 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__request_content_size_0_succeed)
 TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_no_statusCode_succeed)
 {
     /// arrange
+    unsigned int statusCode;
     HTTPAPI_RESULT result;
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    prepareReceivedAnswer(TEST_RECEIVED_ANSWER);
 
-    setHttpCertificate(httpHandle);
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
-
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess(true);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        NULL,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, NULL, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
@@ -3825,58 +2974,44 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_no_responseHeadersHandle_s
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    prepareReceivedAnswer(TEST_RECEIVED_ANSWER);
 
-    setHttpCertificate(httpHandle);
-    DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_re;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess(false);
+    setupAllCallAfterExecuteHTTPsequence();
 
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    /// act
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, NULL);
 
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_GetHeader(requestHttpHeaders, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_send(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, DoworkJobsReceivedBuffer_size[0])).IgnoreArgument(1);
+    /// assert
+    ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
+    ASSERT_ARE_EQUAL(int, 433, statusCode);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
+    /// cleanup
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
+    HTTPAPI_Deinit();
+}
 
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
+/*Tests_SRS_HTTPAPI_COMPACT_21_051: [ If the responseContent is NULL, the HTTPAPI_ExecuteRequest shall ignore any content in the response. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_responseContent_NULL_succeed)
+{
+    /// arrange
+    unsigned int statusCode;
+    HTTPAPI_RESULT result;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    HTTP_HANDLE httpHandle = createHttpConnection();
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    prepareReceivedAnswer(TEST_RECEIVED_ANSWER);
 
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
+    setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess(true);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
     result = HTTPAPI_ExecuteRequest(
@@ -3887,23 +3022,23 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_no_responseHeadersHandle_s
         TEST_EXECUTE_REQUEST_CONTENT,
         TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
         &statusCode,
-        NULL,
-        TestBufferHandle);
+        responseHttpHeaders,
+        NULL);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
     ASSERT_ARE_EQUAL(int, 433, statusCode);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_051: [ If the responseContent is NULL, the HTTPAPI_ExecuteRequest shall ignore any content in the response. ]*/
-TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_responseContent_NULL_succeed)
+/*Tests_SRS_HTTPAPI_COMPACT_21_079: [ The HTTPAPI_ExecuteRequest shall wait, at least, 20 seconds to send a buffer using the SSL connection. ]*/
+TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_retry_send_succeed)
 {
     /// arrange
     unsigned int statusCode;
@@ -3912,255 +3047,153 @@ TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_responseContent_NULL_succe
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-
-    setHttpCertificate(httpHandle);
     DoworkJobsReceivedBuffer = TEST_RECEIVED_ANSWER;
     DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
     DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_rce;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
+    call_on_send_complete_in_xio_send = false;
+    DoworkJobs = (const xio_dowork_job*)doworkjob_sre;
+    SkipDoworkJobsSendResult = 199;
 
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-    setupAllCallBeforeReceiveHTTPsequenceWithSuccess();
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    setupDoworkRetries(200);
+    setupAllCallBeforeReceiveHTTPsequenceWithSuccess(true);
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        NULL);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_OK, result);
     ASSERT_ARE_EQUAL(int, 433, statusCode);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
 /*Tests_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
 /*Tests_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
+/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall block on the transport until it can make progress, and only poll it between retries when the transport cannot wait on its own. ]*/
 TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_with_truncated_content_failed)
 {
     /// arrange
-	int i;
     unsigned int statusCode;
     HTTPAPI_RESULT result;
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobsReceivedBuffer = (const unsigned char*)"HTTP/111.222 433 555\r\ncontent-length:10\r\ntransfer-encoding:\r\n\r\n0123";
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_re;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
+    prepareReceivedAnswer((const unsigned char*)"HTTP/111.222 433 555\r\ncontent-length:10\r\ntransfer-encoding:\r\n\r\n01234");
 
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, DoworkJobsReceivedBuffer_size[0])).IgnoreArgument(1);
-
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+    setupTickCounter();
+    setupDowork();
+    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, "content-length", "10"))
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, "content-length", "10")).IgnoreArgument(1);
-
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, "transfer-encoding", "")).IgnoreArgument(1);
-
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, "transfer-encoding", ""))
         .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
+    STRICT_EXPECTED_CALL(BUFFER_pre_build(IGNORED_PTR_ARG, 10))
         .IgnoreArgument(1);
-
-    for (i = 0; i < 200; i++)
-    {
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-        STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-    }
-
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    /* the bytes restart the deadline, which then expires without the rest of the content */
+    setupTickCounter();
+    setupDoworkRetries(TEST_RECEIVE_TIMEOUT_IN_MILLISECONDS / FAKE_CLOCK_STEP_IN_MILLISECONDS);
+    setupWaitTimeout();
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_READ_DATA_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 3, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 5 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
 /*Tests_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
 TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_with_truncated_parameter_failed)
 {
     /// arrange
-	int i;
     unsigned int statusCode;
     HTTPAPI_RESULT result;
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobsReceivedBuffer = (const unsigned char*)"HTTP/111.222 433 555\r\ncontent-length:10\r\ntransfer-enc";
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_re;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
+    prepareReceivedAnswer((const unsigned char*)"HTTP/111.222 433 555\r\ncontent-len");
 
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, DoworkJobsReceivedBuffer_size[0])).IgnoreArgument(1);
-
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, "content-length", "10")).IgnoreArgument(1);
-
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-
-    for (i = 0; i < 200; i++)
-    {
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-        STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-    }
-
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    setupTickCounter();
+    setupDowork();
+    /* the parser keeps the partial header line until the rest of it arrives */
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+        .IgnoreArgument(2);
+    setupTickCounter();
+    setupDoworkRetries(TEST_RECEIVE_TIMEOUT_IN_MILLISECONDS / FAKE_CLOCK_STEP_IN_MILLISECONDS);
+    setupWaitTimeout();
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_READ_DATA_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 4, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 6 */
     HTTPAPI_Deinit();
 }
 
-/*Tests_SRS_HTTPAPI_COMPACT_21_081: [ The HTTPAPI_ExecuteRequest shall try to read the message with the response up to 20 seconds. ]*/
 /*Tests_SRS_HTTPAPI_COMPACT_21_082: [ If the HTTPAPI_ExecuteRequest retries 20 seconds to receive the message without success, it shall fail and return HTTPAPI_READ_DATA_FAILED. ]*/
-/*Tests_SRS_HTTPAPI_COMPACT_21_083: [ The HTTPAPI_ExecuteRequest shall wait, at least, 100 milliseconds between retries. ]*/
 TEST_FUNCTION(HTTPAPI_ExecuteRequest__Execute_request_with_truncated_header_failed)
 {
     /// arrange
-	int i;
     unsigned int statusCode;
     HTTPAPI_RESULT result;
     HTTP_HEADERS_HANDLE requestHttpHeaders;
     HTTP_HEADERS_HANDLE responseHttpHeaders;
     HTTP_HANDLE httpHandle = createHttpConnection();
     createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
-    setHttpCertificate(httpHandle);
-
-    DoworkJobsReceivedBuffer = (const unsigned char*)"HTTP/111.222 ";
-    DoworkJobsReceivedBuffer_size[0] = strlen((const char*)DoworkJobsReceivedBuffer);
-    DoworkJobsReceivedBuffer_counter = 0;
-    DoworkJobs = (const xio_dowork_job*)doworkjob_o_re;
-    DoworkJobsOpenResult = DoworkJobsOpenResult_ReceiveHead;
-    DoworkJobsSendResult = DoworkJobsSendResult_ReceiveHead;
+    prepareReceivedAnswer((const unsigned char*)"HTTP/111.222 ");
 
-    setupAllCallBeforeOpenHTTPsequence(requestHttpHeaders, 1, false);
+    setupAllCallBeforeExecuteHTTPsequence(requestHttpHeaders);
     setupAllCallBeforeSendHTTPsequenceWithSuccess(requestHttpHeaders);
-
-    STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_NUM_ARG, DoworkJobsReceivedBuffer_size[0])).IgnoreArgument(1);
-
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument(1);
-
-    for (i = 0; i < 200; i++)
-    {
-        STRICT_EXPECTED_CALL(ThreadAPI_Sleep(100));
-        STRICT_EXPECTED_CALL(xio_dowork(IGNORED_NUM_ARG))
-            .IgnoreArgument(1);
-    }
-
-
-    HTTPHeaders_GetHeader_shallReturn = HTTP_HEADERS_OK;
+    setupTickCounter();
+    setupDowork();
+    /* the parser keeps the partial status line until the rest of it arrives */
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+        .IgnoreArgument(2);
+    setupTickCounter();
+    setupDoworkRetries(TEST_RECEIVE_TIMEOUT_IN_MILLISECONDS / FAKE_CLOCK_STEP_IN_MILLISECONDS);
+    setupWaitTimeout();
+    setupAllCallAfterExecuteHTTPsequence();
 
     /// act
-    result = HTTPAPI_ExecuteRequest(
-        httpHandle,
-        HTTPAPI_REQUEST_GET,
-        TEST_EXECUTE_REQUEST_RELATIVE_PATH,
-        requestHttpHeaders,
-        TEST_EXECUTE_REQUEST_CONTENT,
-        TEST_EXECUTE_REQUEST_CONTENT_LENGTH,
-        &statusCode,
-        responseHttpHeaders,
-        TestBufferHandle);
+    result = executeRequest(httpHandle, HTTPAPI_REQUEST_GET, requestHttpHeaders, TEST_EXECUTE_REQUEST_CONTENT, TEST_EXECUTE_REQUEST_CONTENT_LENGTH, &statusCode, responseHttpHeaders);
 
     /// assert
     ASSERT_ARE_EQUAL(int, HTTPAPI_READ_DATA_FAILED, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    ASSERT_ARE_EQUAL(int, 5, currentmalloc_call);
+    ASSERT_ARE_EQUAL(int, TEST_CONNECTION_ALLOCATIONS + 4, currentmalloc_call);
 
     /// cleanup
     destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders); /* currentmalloc_call -= 2 */
-    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 3 */
+    HTTPAPI_CloseConnection(httpHandle);	/* currentmalloc_call -= 6 */
     HTTPAPI_Deinit();
 }
 
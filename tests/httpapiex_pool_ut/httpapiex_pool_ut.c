@@ -0,0 +1,597 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/httpapi.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#undef ENABLE_MOCKS
+
+#include "azure_c_shared_utility/httpapiex_pool.h"
+
+#define TEST_LOCK ((LOCK_HANDLE)0x4242)
+#define TEST_TICK_COUNTER ((TICK_COUNTER_HANDLE)0x4243)
+#define TEST_MAX_CONNECTIONS_PER_HOST 2
+#define TEST_IDLE_TIMEOUT_MS 30000
+#define TEST_KEY "host.azure-devices.net"
+#define TEST_OTHER_KEY "other.azure-devices.net"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+static tickcounter_ms_t g_now;
+static size_t g_closed_connections;
+static size_t g_init_calls;
+static LOCK_RESULT g_lock_result;
+
+static HTTPAPI_RESULT my_HTTPAPI_Init(void)
+{
+    g_init_calls++;
+    return HTTPAPI_OK;
+}
+
+static void my_HTTPAPI_Deinit(void)
+{
+    g_init_calls--;
+}
+
+static void my_HTTPAPI_CloseConnection(HTTP_HANDLE handle)
+{
+    g_closed_connections++;
+    my_gballoc_free(handle);
+}
+
+static LOCK_RESULT my_Lock(LOCK_HANDLE handle)
+{
+    (void)handle;
+    return g_lock_result;
+}
+
+static int my_tickcounter_get_current_ms(TICK_COUNTER_HANDLE tick_counter, tickcounter_ms_t* current_ms)
+{
+    (void)tick_counter;
+    *current_ms = g_now;
+    return 0;
+}
+
+static HTTP_HANDLE create_test_connection(void)
+{
+    return (HTTP_HANDLE)my_gballoc_malloc(1);
+}
+
+TEST_DEFINE_ENUM_TYPE(HTTPAPI_RESULT, HTTPAPI_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTPAPI_RESULT, HTTPAPI_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(LOCK_RESULT, LOCK_RESULT_VALUES);
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+BEGIN_TEST_SUITE(httpapiex_pool_unittests)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    int result;
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_TYPE(HTTPAPI_RESULT, HTTPAPI_RESULT);
+    REGISTER_TYPE(LOCK_RESULT, LOCK_RESULT);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTP_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(TICK_COUNTER_HANDLE, void*);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPI_Init, my_HTTPAPI_Init);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPI_Deinit, my_HTTPAPI_Deinit);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPI_CloseConnection, my_HTTPAPI_CloseConnection);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Init, TEST_LOCK);
+    REGISTER_GLOBAL_MOCK_HOOK(Lock, my_Lock);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Deinit, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(tickcounter_create, TEST_TICK_COUNTER);
+    REGISTER_GLOBAL_MOCK_HOOK(tickcounter_get_current_ms, my_tickcounter_get_current_ms);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+    g_now = 0;
+    g_closed_connections = 0;
+    g_init_calls = 0;
+    g_lock_result = LOCK_OK;
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* HTTPAPIEX_POOL_Create */
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_001: [ If maxConnectionsPerHost is 0, HTTPAPIEX_POOL_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_Create_with_zero_maxConnectionsPerHost_fails)
+{
+    // arrange
+
+    // act
+    HTTPAPIEX_POOL_HANDLE result = HTTPAPIEX_POOL_Create(0, TEST_IDLE_TIMEOUT_MS);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_002: [ HTTPAPIEX_POOL_Create shall allocate a new pool, call HTTPAPI_Init, create a lock, a tick counter and an empty vector of idle connections. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_Create_succeeds)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPI_Init());
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(tickcounter_create());
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*the vector*/
+
+    // act
+    result = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, g_init_calls);
+
+    // cleanup
+    HTTPAPIEX_POOL_Destroy(result);
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_003: [ If any error occurs, HTTPAPIEX_POOL_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(when_HTTPAPI_Init_fails_HTTPAPIEX_POOL_Create_fails)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPI_Init())
+        .SetReturn(HTTPAPI_INIT_FAILED);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_003: [ If any error occurs, HTTPAPIEX_POOL_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(when_creating_the_tick_counter_fails_HTTPAPIEX_POOL_Create_fails)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPI_Init());
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(tickcounter_create())
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK));
+    STRICT_EXPECTED_CALL(HTTPAPI_Deinit());
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, g_init_calls);
+}
+
+/* HTTPAPIEX_POOL_Destroy */
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_004: [ If pool is NULL, HTTPAPIEX_POOL_Destroy shall do nothing. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_Destroy_with_NULL_does_nothing)
+{
+    // arrange
+
+    // act
+    HTTPAPIEX_POOL_Destroy(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_005: [ HTTPAPIEX_POOL_Destroy shall close all the idle connections, free all the resources of the pool and call HTTPAPI_Deinit. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_Destroy_closes_the_idle_connections)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE pool = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+    (void)HTTPAPIEX_POOL_Checkin(pool, TEST_KEY, create_test_connection());
+    (void)HTTPAPIEX_POOL_Checkin(pool, TEST_OTHER_KEY, create_test_connection());
+
+    // act
+    HTTPAPIEX_POOL_Destroy(pool);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 2, g_closed_connections);
+    ASSERT_ARE_EQUAL(size_t, 0, g_init_calls);
+}
+
+/* HTTPAPIEX_POOL_Checkout */
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_006: [ If pool or key is NULL, HTTPAPIEX_POOL_Checkout shall return NULL. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_Checkout_with_NULL_pool_fails)
+{
+    // arrange
+
+    // act
+    HTTP_HANDLE result = HTTPAPIEX_POOL_Checkout(NULL, TEST_KEY);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_006: [ If pool or key is NULL, HTTPAPIEX_POOL_Checkout shall return NULL. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_Checkout_with_NULL_key_fails)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE pool = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+    HTTP_HANDLE result;
+    umock_c_reset_all_calls();
+
+    // act
+    result = HTTPAPIEX_POOL_Checkout(pool, NULL);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HTTPAPIEX_POOL_Destroy(pool);
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_008: [ HTTPAPIEX_POOL_Checkout shall remove from the pool and return the most recently checked in idle connection for key, or return NULL if there is none. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_Checkout_from_an_empty_pool_returns_NULL)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE pool = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+    HTTP_HANDLE result;
+
+    // act
+    result = HTTPAPIEX_POOL_Checkout(pool, TEST_KEY);
+
+    // assert
+    ASSERT_IS_NULL(result);
+
+    // cleanup
+    HTTPAPIEX_POOL_Destroy(pool);
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_008: [ HTTPAPIEX_POOL_Checkout shall remove from the pool and return the most recently checked in idle connection for key, or return NULL if there is none. ]*/
+/* Tests_SRS_HTTPAPIEX_POOL_01_011: [ HTTPAPIEX_POOL_Checkin shall add httpHandle to the idle connections of key, stamped with the current time, and return 0. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_Checkout_returns_the_connection_checked_in_for_the_key)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE pool = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+    HTTP_HANDLE connection = create_test_connection();
+    HTTP_HANDLE result;
+    ASSERT_ARE_EQUAL(int, 0, HTTPAPIEX_POOL_Checkin(pool, TEST_KEY, connection));
+
+    // act
+    result = HTTPAPIEX_POOL_Checkout(pool, TEST_KEY);
+
+    // assert
+    ASSERT_ARE_EQUAL(void_ptr, connection, result);
+    ASSERT_IS_NULL(HTTPAPIEX_POOL_Checkout(pool, TEST_KEY));
+    ASSERT_ARE_EQUAL(size_t, 0, g_closed_connections);
+
+    // cleanup
+    free(result);
+    HTTPAPIEX_POOL_Destroy(pool);
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_008: [ HTTPAPIEX_POOL_Checkout shall remove from the pool and return the most recently checked in idle connection for key, or return NULL if there is none. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_Checkout_does_not_return_connections_of_other_keys)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE pool = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+    HTTP_HANDLE result;
+    (void)HTTPAPIEX_POOL_Checkin(pool, TEST_OTHER_KEY, create_test_connection());
+
+    // act
+    result = HTTPAPIEX_POOL_Checkout(pool, TEST_KEY);
+
+    // assert
+    ASSERT_IS_NULL(result);
+
+    // cleanup
+    HTTPAPIEX_POOL_Destroy(pool);
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_008: [ HTTPAPIEX_POOL_Checkout shall remove from the pool and return the most recently checked in idle connection for key, or return NULL if there is none. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_Checkout_returns_the_most_recently_checked_in_connection_first)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE pool = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+    HTTP_HANDLE older = create_test_connection();
+    HTTP_HANDLE newer = create_test_connection();
+    HTTP_HANDLE first;
+    HTTP_HANDLE second;
+    (void)HTTPAPIEX_POOL_Checkin(pool, TEST_KEY, older);
+    g_now = 10;
+    (void)HTTPAPIEX_POOL_Checkin(pool, TEST_KEY, newer);
+
+    // act
+    first = HTTPAPIEX_POOL_Checkout(pool, TEST_KEY);
+    second = HTTPAPIEX_POOL_Checkout(pool, TEST_KEY);
+
+    // assert
+    ASSERT_ARE_EQUAL(void_ptr, newer, first);
+    ASSERT_ARE_EQUAL(void_ptr, older, second);
+
+    // cleanup
+    free(first);
+    free(second);
+    HTTPAPIEX_POOL_Destroy(pool);
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_007: [ HTTPAPIEX_POOL_Checkout shall first close the idle connections that have been idle for idleTimeoutInMs or longer. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_Checkout_closes_expired_connections)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE pool = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+    HTTP_HANDLE result;
+    (void)HTTPAPIEX_POOL_Checkin(pool, TEST_KEY, create_test_connection());
+    (void)HTTPAPIEX_POOL_Checkin(pool, TEST_OTHER_KEY, create_test_connection());
+    g_now = TEST_IDLE_TIMEOUT_MS;
+
+    // act
+    result = HTTPAPIEX_POOL_Checkout(pool, TEST_KEY);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(size_t, 2, g_closed_connections);
+
+    // cleanup
+    HTTPAPIEX_POOL_Destroy(pool);
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_007: [ HTTPAPIEX_POOL_Checkout shall first close the idle connections that have been idle for idleTimeoutInMs or longer. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_Checkout_keeps_connections_younger_than_the_idle_timeout)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE pool = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+    HTTP_HANDLE connection = create_test_connection();
+    HTTP_HANDLE result;
+    (void)HTTPAPIEX_POOL_Checkin(pool, TEST_KEY, connection);
+    g_now = TEST_IDLE_TIMEOUT_MS - 1;
+
+    // act
+    result = HTTPAPIEX_POOL_Checkout(pool, TEST_KEY);
+
+    // assert
+    ASSERT_ARE_EQUAL(void_ptr, connection, result);
+    ASSERT_ARE_EQUAL(size_t, 0, g_closed_connections);
+
+    // cleanup
+    free(result);
+    HTTPAPIEX_POOL_Destroy(pool);
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_009: [ If locking fails, HTTPAPIEX_POOL_Checkout shall return NULL. ]*/
+TEST_FUNCTION(when_Lock_fails_HTTPAPIEX_POOL_Checkout_returns_NULL)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE pool = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+    HTTP_HANDLE result;
+    (void)HTTPAPIEX_POOL_Checkin(pool, TEST_KEY, create_test_connection());
+    g_lock_result = LOCK_ERROR;
+
+    // act
+    result = HTTPAPIEX_POOL_Checkout(pool, TEST_KEY);
+
+    // assert
+    ASSERT_IS_NULL(result);
+
+    // cleanup
+    g_lock_result = LOCK_OK;
+    HTTPAPIEX_POOL_Destroy(pool);
+}
+
+/* HTTPAPIEX_POOL_Checkin */
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_010: [ If pool, key or httpHandle is NULL, HTTPAPIEX_POOL_Checkin shall close httpHandle if it is not NULL and return a non-zero value. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_Checkin_with_NULL_pool_closes_the_connection)
+{
+    // arrange
+    HTTP_HANDLE connection = create_test_connection();
+    int result;
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(HTTPAPI_CloseConnection(connection));
+
+    // act
+    result = HTTPAPIEX_POOL_Checkin(NULL, TEST_KEY, connection);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_010: [ If pool, key or httpHandle is NULL, HTTPAPIEX_POOL_Checkin shall close httpHandle if it is not NULL and return a non-zero value. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_Checkin_with_NULL_httpHandle_fails)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE pool = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+    int result;
+    umock_c_reset_all_calls();
+
+    // act
+    result = HTTPAPIEX_POOL_Checkin(pool, TEST_KEY, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    HTTPAPIEX_POOL_Destroy(pool);
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_012: [ If the pool already holds maxConnectionsPerHost idle connections for key, HTTPAPIEX_POOL_Checkin shall close httpHandle and return a non-zero value. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_Checkin_beyond_maxConnectionsPerHost_closes_the_connection)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE pool = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+    int result;
+    ASSERT_ARE_EQUAL(int, 0, HTTPAPIEX_POOL_Checkin(pool, TEST_KEY, create_test_connection()));
+    ASSERT_ARE_EQUAL(int, 0, HTTPAPIEX_POOL_Checkin(pool, TEST_KEY, create_test_connection()));
+
+    // act
+    result = HTTPAPIEX_POOL_Checkin(pool, TEST_KEY, create_test_connection());
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_closed_connections);
+    ASSERT_ARE_EQUAL(int, 0, HTTPAPIEX_POOL_Checkin(pool, TEST_OTHER_KEY, create_test_connection()));
+
+    // cleanup
+    HTTPAPIEX_POOL_Destroy(pool);
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_013: [ If any other error occurs, HTTPAPIEX_POOL_Checkin shall close httpHandle and return a non-zero value. ]*/
+TEST_FUNCTION(when_Lock_fails_HTTPAPIEX_POOL_Checkin_closes_the_connection)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE pool = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+    int result;
+    g_lock_result = LOCK_ERROR;
+
+    // act
+    result = HTTPAPIEX_POOL_Checkin(pool, TEST_KEY, create_test_connection());
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_closed_connections);
+
+    // cleanup
+    g_lock_result = LOCK_OK;
+    HTTPAPIEX_POOL_Destroy(pool);
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_013: [ If any other error occurs, HTTPAPIEX_POOL_Checkin shall close httpHandle and return a non-zero value. ]*/
+TEST_FUNCTION(when_copying_the_key_fails_HTTPAPIEX_POOL_Checkin_closes_the_connection)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE pool = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+    HTTP_HANDLE connection = create_test_connection();
+    int result;
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    // act
+    result = HTTPAPIEX_POOL_Checkin(pool, TEST_KEY, connection);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_closed_connections);
+
+    // cleanup
+    HTTPAPIEX_POOL_Destroy(pool);
+}
+
+/* HTTPAPIEX_POOL_DoWork */
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_014: [ If pool is NULL, HTTPAPIEX_POOL_DoWork shall do nothing. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_DoWork_with_NULL_does_nothing)
+{
+    // arrange
+
+    // act
+    HTTPAPIEX_POOL_DoWork(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_HTTPAPIEX_POOL_01_015: [ HTTPAPIEX_POOL_DoWork shall close the idle connections that have been idle for idleTimeoutInMs or longer. ]*/
+TEST_FUNCTION(HTTPAPIEX_POOL_DoWork_closes_only_the_expired_connections)
+{
+    // arrange
+    HTTPAPIEX_POOL_HANDLE pool = HTTPAPIEX_POOL_Create(TEST_MAX_CONNECTIONS_PER_HOST, TEST_IDLE_TIMEOUT_MS);
+    HTTP_HANDLE younger = create_test_connection();
+    HTTP_HANDLE result;
+    (void)HTTPAPIEX_POOL_Checkin(pool, TEST_KEY, create_test_connection());
+    g_now = 1000;
+    (void)HTTPAPIEX_POOL_Checkin(pool, TEST_KEY, younger);
+    g_now = TEST_IDLE_TIMEOUT_MS;
+
+    // act
+    HTTPAPIEX_POOL_DoWork(pool);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_closed_connections);
+    result = HTTPAPIEX_POOL_Checkout(pool, TEST_KEY);
+    ASSERT_ARE_EQUAL(void_ptr, younger, result);
+
+    // cleanup
+    free(result);
+    HTTPAPIEX_POOL_Destroy(pool);
+}
+
+END_TEST_SUITE(httpapiex_pool_unittests)
@@ -77,6 +77,9 @@ void my_gballoc_free(void* ptr)
 #include "azure_c_shared_utility/buffer_.h"
 #include "azure_c_shared_utility/httpheaders.h"
 #include "azure_c_shared_utility/httpapi.h"
+#include "azure_c_shared_utility/hash.h"
+#include "azure_c_shared_utility/httpapiex_pool.h"
+#include "azure_c_shared_utility/httpapi_async.h"
 
 static size_t currentHTTPAPI_SaveOption_call;
 static size_t whenShallHTTPAPI_SaveOption_fail;
@@ -106,6 +109,12 @@ void my_STRING_delete(STRING_HANDLE handle)
     free(handle);
 }
 
+STRING_HANDLE my_STRING_clone(STRING_HANDLE handle)
+{
+    (void)handle;
+    return (STRING_HANDLE)malloc(1);
+}
+
 HTTP_HEADERS_HANDLE my_HTTPHeaders_Alloc(void)
 {
     return (HTTP_HEADERS_HANDLE)malloc(1);
@@ -225,6 +234,13 @@ HTTPAPI_RESULT my_HTTPAPI_CloneOption(const char* optionName, const void* value,
             strcpy(temp, (const char*)value);
             *savedValue = temp;
         }
+        else if (strcmp("TrustedCerts", optionName) == 0)
+        {
+            char* temp;
+            temp = (char *)malloc(strlen((const char*)value) + 1);
+            strcpy(temp, (const char*)value);
+            *savedValue = temp;
+        }
         else
         {
             result2 = HTTPAPI_INVALID_ARG;
@@ -233,6 +249,65 @@ HTTPAPI_RESULT my_HTTPAPI_CloneOption(const char* optionName, const void* value,
     return result2;
 }
 
+/*the connection the next HTTPAPIEX_POOL_Checkout hands out, NULL when the pool is empty*/
+static HTTP_HANDLE pooledConnection;
+
+HTTP_HANDLE my_HTTPAPIEX_POOL_Checkout(HTTPAPIEX_POOL_HANDLE pool, const char* key)
+{
+    HTTP_HANDLE result2 = pooledConnection;
+    (void)pool;
+    (void)key;
+    pooledConnection = NULL;
+    return result2;
+}
+
+int my_HTTPAPIEX_POOL_Checkin(HTTPAPIEX_POOL_HANDLE pool, const char* key, HTTP_HANDLE httpHandle)
+{
+    (void)pool;
+    (void)key;
+    free(httpHandle);
+    return 0;
+}
+
+#define TEST_ASYNC_HANDLE (HTTPAPI_ASYNC_HANDLE)0x4B
+
+/*the completion callback of the last request queued with httpapi_async_execute_request*/
+static ON_HTTPAPI_ASYNC_REQUEST_COMPLETE asyncOnRequestComplete;
+static void* asyncCallbackContext;
+static const char* asyncRelativePath;
+static size_t asyncContentLength;
+static size_t httpapi_async_create_calls;
+static const char* asyncLastOptionName;
+
+HTTPAPI_ASYNC_HANDLE my_httpapi_async_create(const char* host_name, size_t max_connections)
+{
+    (void)host_name;
+    (void)max_connections;
+    httpapi_async_create_calls++;
+    return TEST_ASYNC_HANDLE;
+}
+
+int my_httpapi_async_execute_request(HTTPAPI_ASYNC_HANDLE httpapi_async, HTTPAPI_REQUEST_TYPE request_type, const char* relative_path, HTTP_HEADERS_HANDLE request_headers, const unsigned char* content, size_t content_length, ON_HTTPAPI_ASYNC_REQUEST_COMPLETE on_request_complete, void* callback_context)
+{
+    (void)httpapi_async;
+    (void)request_type;
+    (void)request_headers;
+    (void)content;
+    asyncRelativePath = relative_path;
+    asyncContentLength = content_length;
+    asyncOnRequestComplete = on_request_complete;
+    asyncCallbackContext = callback_context;
+    return 0;
+}
+
+int my_httpapi_async_set_option(HTTPAPI_ASYNC_HANDLE httpapi_async, const char* option_name, const void* value)
+{
+    (void)httpapi_async;
+    (void)value;
+    asyncLastOptionName = option_name;
+    return 0;
+}
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -279,6 +354,7 @@ TEST_DEFINE_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT_VALUES);
 TEST_DEFINE_ENUM_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(HASH_ALGORITHM, HASH_ALGORITHM_VALUES);
 
 #define TEST_HOSTNAME "aaa"
 #define TEST_RELATIVE_PATH "nothing/to/see/here/devices"
@@ -289,9 +365,24 @@ IMPLEMENT_UMOCK_C_ENUM_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE_VALUES);
 #define TEST_HTTP_HEADERS_HANDLE (HTTP_HEADERS_HANDLE) 0x47
 #define TEST_BUFFER_REQ_BODY    (BUFFER_HANDLE) 0x48
 #define TEST_BUFFER_RESP_BODY   (BUFFER_HANDLE) 0x49
+#define TEST_POOL               (HTTPAPIEX_POOL_HANDLE) 0x4A
 unsigned char* TEST_BUFFER = (unsigned char*)"333333";
 #define TEST_BUFFER_SIZE 6
 
+static HTTPAPIEX_RESULT asyncResult;
+static unsigned int asyncStatusCode;
+static size_t asyncCompleteCalls;
+
+static void onAsyncRequestComplete(void* context, HTTPAPIEX_RESULT result, unsigned int statusCode, HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    (void)context;
+    (void)responseHttpHeadersHandle;
+    (void)responseContent;
+    asyncResult = result;
+    asyncStatusCode = statusCode;
+    asyncCompleteCalls++;
+}
+
 static TEST_MUTEX_HANDLE g_testByTest;
 static TEST_MUTEX_HANDLE g_dllByDll;
 
@@ -408,6 +499,32 @@ static void prepareHTTPAPIEX_ExecuteRequest(unsigned int *asGivenByHttpApi, HTTP
         .SetReturn(resultToBeUsed);
 }
 
+/*expected calls of a handle using a pool from the moment it has a connection: the request and handing the connection back*/
+static void setupPooledHTTPsequence(HTTP_HEADERS_HANDLE requestHttpHeaders, HTTP_HEADERS_HANDLE responseHttpHeaders, BUFFER_HANDLE responseHttpBody)
+{
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .IgnoreArgument(1).SetReturn(TEST_BUFFER_SIZE);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .IgnoreArgument(1).SetReturn(TEST_BUFFER);
+    STRICT_EXPECTED_CALL(HTTPAPI_ExecuteRequest(
+        IGNORED_PTR_ARG,
+        HTTPAPI_REQUEST_PATCH,
+        TEST_RELATIVE_PATH,
+        requestHttpHeaders,
+        IGNORED_PTR_ARG,
+        TEST_BUFFER_SIZE,
+        IGNORED_PTR_ARG,
+        responseHttpHeaders,
+        responseHttpBody))
+        .IgnoreArgument(1)
+        .IgnoreArgument(5)
+        .IgnoreArgument(7);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(responseHttpHeaders, "Connection"));
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(responseHttpHeaders, "connection"));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_POOL_Checkin(TEST_POOL, TEST_HOSTNAME, IGNORED_PTR_ARG))
+        .IgnoreArgument(3);
+}
+
 DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
 
 static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
@@ -436,6 +553,7 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_TYPE(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT);
     REGISTER_TYPE(HTTP_HEADERS_RESULT, HTTP_HEADERS_RESULT);
     REGISTER_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE);
+    REGISTER_TYPE(HASH_ALGORITHM, HASH_ALGORITHM);
     REGISTER_UMOCK_ALIAS_TYPE(VECTOR_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(const VECTOR_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(PREDICATE_FUNCTION, void*);
@@ -443,12 +561,17 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTP_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_POOL_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HTTPAPI_ASYNC_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_HTTPAPI_ASYNC_REQUEST_COMPLETE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HASH_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(const unsigned char*, void*);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
     REGISTER_GLOBAL_MOCK_HOOK(STRING_construct, my_STRING_construct);
     REGISTER_GLOBAL_MOCK_HOOK(STRING_delete, my_STRING_delete);
+    REGISTER_GLOBAL_MOCK_HOOK(STRING_clone, my_STRING_clone);
     REGISTER_GLOBAL_MOCK_RETURN(STRING_c_str, TEST_HOSTNAME);
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Alloc, my_HTTPHeaders_Alloc);
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Free, my_HTTPHeaders_Free);
@@ -465,6 +588,11 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_RETURN(HTTPAPI_ExecuteRequest, HTTPAPI_OK);
     REGISTER_GLOBAL_MOCK_RETURN(HTTPAPI_SetOption, HTTPAPI_OK);
     REGISTER_GLOBAL_MOCK_HOOK(HTTPAPI_CloneOption, my_HTTPAPI_CloneOption);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_POOL_Checkout, my_HTTPAPIEX_POOL_Checkout);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_POOL_Checkin, my_HTTPAPIEX_POOL_Checkin);
+    REGISTER_GLOBAL_MOCK_HOOK(httpapi_async_create, my_httpapi_async_create);
+    REGISTER_GLOBAL_MOCK_HOOK(httpapi_async_execute_request, my_httpapi_async_execute_request);
+    REGISTER_GLOBAL_MOCK_HOOK(httpapi_async_set_option, my_httpapi_async_set_option);
     REGISTER_GLOBAL_MOCK_HOOK(VECTOR_create, real_VECTOR_create);
     REGISTER_GLOBAL_MOCK_HOOK(VECTOR_move, real_VECTOR_move);
     REGISTER_GLOBAL_MOCK_HOOK(VECTOR_destroy, real_VECTOR_destroy);
@@ -520,6 +648,18 @@ TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
     currentHTTPAPI_Init_call = 0;
     for (i = 0; i<N_MAX_FAILS; i++) whenShallHTTPAPI_Init_fail[i] = 0;
 
+    pooledConnection = NULL;
+
+    asyncOnRequestComplete = NULL;
+    asyncCallbackContext = NULL;
+    asyncRelativePath = NULL;
+    asyncContentLength = 0;
+    httpapi_async_create_calls = 0;
+    asyncLastOptionName = NULL;
+    asyncResult = HTTPAPIEX_OK;
+    asyncStatusCode = 0;
+    asyncCompleteCalls = 0;
+
     umock_c_reset_all_calls();
 }
 
@@ -3339,4 +3479,832 @@ TEST_FUNCTION(HTTPAPIEX_Destroy_with_NULL_argument_does_nothing)
     ///destroy
 }
 
+/*Tests_SRS_HTTPAPIEX_01_001: [ HTTPAPIEX_CreateWithPool shall behave as HTTPAPIEX_Create and associate pool with the new handle. ]*/
+TEST_FUNCTION(HTTPAPIEX_CreateWithPool_succeeds)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(STRING_construct(TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(VECTOR_create(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+
+    /// act
+    result = HTTPAPIEX_CreateWithPool(TEST_HOSTNAME, TEST_POOL);
+
+    /// assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    HTTPAPIEX_Destroy(result);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_001: [ HTTPAPIEX_CreateWithPool shall behave as HTTPAPIEX_Create and associate pool with the new handle. ]*/
+TEST_FUNCTION(HTTPAPIEX_CreateWithPool_with_NULL_hostName_fails)
+{
+    /// arrange
+
+    /// act
+    HTTPAPIEX_HANDLE result = HTTPAPIEX_CreateWithPool(NULL, TEST_POOL);
+
+    /// assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_HTTPAPIEX_01_003: [ Connections shall be pooled under a key made of the host name and, when there are saved options, the SHA-256 of their names and values. ]*/
+/*Tests_SRS_HTTPAPIEX_01_006: [ When the handle uses a pool, step 2 shall first try to take an idle connection from the pool by calling HTTPAPIEX_POOL_Checkout and shall only call HTTPAPI_CreateConnection when there is none. ]*/
+/*Tests_SRS_HTTPAPIEX_01_008: [ When the handle uses a pool, after a successful HTTPAPI_ExecuteRequest the connection shall be handed back to the pool by calling HTTPAPIEX_POOL_Checkin. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_pool_creates_a_connection_when_the_pool_has_none_and_checks_it_in)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_CreateWithPool(TEST_HOSTNAME, TEST_POOL);
+    unsigned int httpStatusCode;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    BUFFER_HANDLE requestHttpBody = TEST_BUFFER_REQ_BODY;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    BUFFER_HANDLE responseHttpBody = TEST_BUFFER_RESP_BODY;
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    umock_c_reset_all_calls();
+
+    setupAllCallBeforeHTTPsequence();
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)) /*no options, the key is the host name*/
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(STRING_clone(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPI_Init());
+    STRICT_EXPECTED_CALL(HTTPAPIEX_POOL_Checkout(TEST_POOL, TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPI_CreateConnection(TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    setupPooledHTTPsequence(requestHttpHeaders, responseHttpHeaders, responseHttpBody);
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequest(httpapiexhandle, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, requestHttpHeaders, requestHttpBody, &httpStatusCode, responseHttpHeaders, responseHttpBody);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_006: [ When the handle uses a pool, step 2 shall first try to take an idle connection from the pool by calling HTTPAPIEX_POOL_Checkout and shall only call HTTPAPI_CreateConnection when there is none. ]*/
+/*Tests_SRS_HTTPAPIEX_01_007: [ A connection taken from the pool shall not be passed the saved options again. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_pool_uses_a_pooled_connection)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_CreateWithPool(TEST_HOSTNAME, TEST_POOL);
+    unsigned int httpStatusCode;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    BUFFER_HANDLE requestHttpBody = TEST_BUFFER_REQ_BODY;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    BUFFER_HANDLE responseHttpBody = TEST_BUFFER_RESP_BODY;
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    (void)HTTPAPIEX_ExecuteRequest(httpapiexhandle, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, requestHttpHeaders, requestHttpBody, &httpStatusCode, responseHttpHeaders, responseHttpBody);
+    pooledConnection = (HTTP_HANDLE)malloc(1);
+    umock_c_reset_all_calls();
+
+    setupAllCallBeforeHTTPsequence();
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*the key is kept from the previous request*/
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPIEX_POOL_Checkout(TEST_POOL, TEST_HOSTNAME));
+    setupPooledHTTPsequence(requestHttpHeaders, responseHttpHeaders, responseHttpBody);
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequest(httpapiexhandle, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, requestHttpHeaders, requestHttpBody, &httpStatusCode, responseHttpHeaders, responseHttpBody);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+static HTTPAPIEX_RESULT execute_pooled_request_with_connection_header(const char* connectionHeaderValue, bool expectClose)
+{
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_CreateWithPool(TEST_HOSTNAME, TEST_POOL);
+    unsigned int httpStatusCode;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    BUFFER_HANDLE requestHttpBody = TEST_BUFFER_REQ_BODY;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    BUFFER_HANDLE responseHttpBody = TEST_BUFFER_RESP_BODY;
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    (void)HTTPAPIEX_ExecuteRequest(httpapiexhandle, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, requestHttpHeaders, requestHttpBody, &httpStatusCode, responseHttpHeaders, responseHttpBody);
+    pooledConnection = (HTTP_HANDLE)malloc(1);
+    umock_c_reset_all_calls();
+
+    setupAllCallBeforeHTTPsequence();
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPIEX_POOL_Checkout(TEST_POOL, TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .IgnoreArgument(1).SetReturn(TEST_BUFFER_SIZE);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .IgnoreArgument(1).SetReturn(TEST_BUFFER);
+    STRICT_EXPECTED_CALL(HTTPAPI_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, requestHttpHeaders, IGNORED_PTR_ARG, TEST_BUFFER_SIZE, IGNORED_PTR_ARG, responseHttpHeaders, responseHttpBody))
+        .IgnoreArgument(1)
+        .IgnoreArgument(5)
+        .IgnoreArgument(7);
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(responseHttpHeaders, "Connection"))
+        .SetReturn(connectionHeaderValue);
+    if (expectClose)
+    {
+        STRICT_EXPECTED_CALL(HTTPAPI_CloseConnection(IGNORED_PTR_ARG))
+            .IgnoreArgument(1);
+    }
+    else
+    {
+        STRICT_EXPECTED_CALL(HTTPAPIEX_POOL_Checkin(TEST_POOL, TEST_HOSTNAME, IGNORED_PTR_ARG))
+            .IgnoreArgument(3);
+    }
+
+    result = HTTPAPIEX_ExecuteRequest(httpapiexhandle, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, requestHttpHeaders, requestHttpBody, &httpStatusCode, responseHttpHeaders, responseHttpBody);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    HTTPAPIEX_Destroy(httpapiexhandle);
+    return result;
+}
+
+/*Tests_SRS_HTTPAPIEX_01_009: [ If the Connection header of the response lists a `close` token, compared case-insensitively among its comma-separated tokens, the connection shall be closed instead. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_pool_closes_the_connection_when_the_server_asks_to)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+
+    /// act
+    result = execute_pooled_request_with_connection_header("close", true);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_009: [ If the Connection header of the response lists a `close` token, compared case-insensitively among its comma-separated tokens, the connection shall be closed instead. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_pool_matches_the_close_token_case_insensitively)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+
+    /// act
+    result = execute_pooled_request_with_connection_header("CLOSE", true);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_009: [ If the Connection header of the response lists a `close` token, compared case-insensitively among its comma-separated tokens, the connection shall be closed instead. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_pool_finds_the_close_token_in_a_token_list)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+
+    /// act
+    result = execute_pooled_request_with_connection_header("keep-alive, close", true);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_009: [ If the Connection header of the response lists a `close` token, compared case-insensitively among its comma-separated tokens, the connection shall be closed instead. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_pool_does_not_close_for_a_token_that_only_contains_close)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+
+    /// act
+    result = execute_pooled_request_with_connection_header("keep-alive, closed", false);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_010: [ If a connection taken from the pool fails, step 2 shall be repeated with a connection from HTTPAPI_CreateConnection, and that shall not count as a retry of step 2. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_pool_replaces_a_failed_pooled_connection)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_CreateWithPool(TEST_HOSTNAME, TEST_POOL);
+    unsigned int httpStatusCode;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    BUFFER_HANDLE requestHttpBody = TEST_BUFFER_REQ_BODY;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    BUFFER_HANDLE responseHttpBody = TEST_BUFFER_RESP_BODY;
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    (void)HTTPAPIEX_ExecuteRequest(httpapiexhandle, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, requestHttpHeaders, requestHttpBody, &httpStatusCode, responseHttpHeaders, responseHttpBody);
+    pooledConnection = (HTTP_HANDLE)malloc(1);
+    umock_c_reset_all_calls();
+
+    setupAllCallBeforeHTTPsequence();
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPIEX_POOL_Checkout(TEST_POOL, TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .IgnoreArgument(1).SetReturn(TEST_BUFFER_SIZE);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .IgnoreArgument(1).SetReturn(TEST_BUFFER);
+    STRICT_EXPECTED_CALL(HTTPAPI_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, requestHttpHeaders, IGNORED_PTR_ARG, TEST_BUFFER_SIZE, IGNORED_PTR_ARG, responseHttpHeaders, responseHttpBody))
+        .IgnoreArgument(1)
+        .IgnoreArgument(5)
+        .IgnoreArgument(7)
+        .SetReturn(HTTPAPI_ERROR);
+    STRICT_EXPECTED_CALL(HTTPAPI_CloseConnection(IGNORED_PTR_ARG)) /*the server dropped the idle connection*/
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPI_CreateConnection(TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    setupPooledHTTPsequence(requestHttpHeaders, responseHttpHeaders, responseHttpBody);
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequest(httpapiexhandle, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, requestHttpHeaders, requestHttpBody, &httpStatusCode, responseHttpHeaders, responseHttpBody);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_004: [ If any saved option is not one of TrustedCerts, x509certificate, x509privatekey, x509EccCertificate or x509EccAliasKey, HTTPAPIEX_ExecuteRequest shall not use the pool for that handle. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_pool_does_not_share_connections_of_handles_with_other_options)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_CreateWithPool(TEST_HOSTNAME, TEST_POOL);
+    unsigned int httpStatusCode;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    BUFFER_HANDLE requestHttpBody = TEST_BUFFER_REQ_BODY;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    BUFFER_HANDLE responseHttpBody = TEST_BUFFER_RESP_BODY;
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    (void)HTTPAPIEX_SetOption(httpapiexhandle, "someOption1", (void*)"3");
+    umock_c_reset_all_calls();
+
+    setupAllCallBeforeHTTPsequence();
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPI_Init());
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPI_CreateConnection(TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPI_SetOption(IGNORED_PTR_ARG, "someOption1", (void*)"3"))
+        .IgnoreArgument(1)
+        .IgnoreArgument(3);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .IgnoreArgument(1).SetReturn(TEST_BUFFER_SIZE);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .IgnoreArgument(1).SetReturn(TEST_BUFFER);
+    STRICT_EXPECTED_CALL(HTTPAPI_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, requestHttpHeaders, IGNORED_PTR_ARG, TEST_BUFFER_SIZE, IGNORED_PTR_ARG, responseHttpHeaders, responseHttpBody))
+        .IgnoreArgument(1)
+        .IgnoreArgument(5)
+        .IgnoreArgument(7);
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequest(httpapiexhandle, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, requestHttpHeaders, requestHttpBody, &httpStatusCode, responseHttpHeaders, responseHttpBody);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_003: [ Connections shall be pooled under a key made of the host name and, when there are saved options, the SHA-256 of their names and values. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_pool_keys_connections_with_the_digest_of_the_trusted_certificates)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_CreateWithPool(TEST_HOSTNAME, TEST_POOL);
+    unsigned int httpStatusCode;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    BUFFER_HANDLE requestHttpBody = TEST_BUFFER_REQ_BODY;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    BUFFER_HANDLE responseHttpBody = TEST_BUFFER_RESP_BODY;
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    (void)HTTPAPIEX_SetOption(httpapiexhandle, "TrustedCerts", (void*)"certs");
+    umock_c_reset_all_calls();
+
+    setupAllCallBeforeHTTPsequence();
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(STRING_clone(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HASH_Create(HASH_ALGORITHM_SHA256))
+        .SetReturn((HASH_HANDLE)0x51);
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HASH_Update((HASH_HANDLE)0x51, IGNORED_PTR_ARG, sizeof("TrustedCerts")))
+        .IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(HASH_Update((HASH_HANDLE)0x51, IGNORED_PTR_ARG, sizeof("certs")))
+        .IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(HASH_Final((HASH_HANDLE)0x51, IGNORED_PTR_ARG))
+        .IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "\n333333333333"))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HASH_Destroy((HASH_HANDLE)0x51));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPI_Init());
+    STRICT_EXPECTED_CALL(HTTPAPIEX_POOL_Checkout(TEST_POOL, TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPI_CreateConnection(TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPI_SetOption(IGNORED_PTR_ARG, "TrustedCerts", (void*)"certs"))
+        .IgnoreArgument(1)
+        .IgnoreArgument(3);
+    setupPooledHTTPsequence(requestHttpHeaders, responseHttpHeaders, responseHttpBody);
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequest(httpapiexhandle, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, requestHttpHeaders, requestHttpBody, &httpStatusCode, responseHttpHeaders, responseHttpBody);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_005: [ If building the key fails, HTTPAPIEX_ExecuteRequest shall not use the pool for that request. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_with_pool_does_not_use_the_pool_when_building_the_key_fails)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_CreateWithPool(TEST_HOSTNAME, TEST_POOL);
+    unsigned int httpStatusCode;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    BUFFER_HANDLE requestHttpBody = TEST_BUFFER_REQ_BODY;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    BUFFER_HANDLE responseHttpBody = TEST_BUFFER_RESP_BODY;
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    umock_c_reset_all_calls();
+
+    setupAllCallBeforeHTTPsequence();
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(STRING_clone(IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .SetReturn(NULL);
+    setupAllCallForHTTPsequence(TEST_RELATIVE_PATH, requestHttpHeaders, requestHttpBody, responseHttpHeaders, responseHttpBody);
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequest(httpapiexhandle, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, requestHttpHeaders, requestHttpBody, &httpStatusCode, responseHttpHeaders, responseHttpBody);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_011: [ When the option was saved, HTTPAPIEX_SetOption shall discard the key that the connections of the handle are pooled under. ]*/
+TEST_FUNCTION(HTTPAPIEX_SetOption_with_pool_discards_the_pool_key)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_CreateWithPool(TEST_HOSTNAME, TEST_POOL);
+    unsigned int httpStatusCode;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    BUFFER_HANDLE requestHttpBody = TEST_BUFFER_REQ_BODY;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    BUFFER_HANDLE responseHttpBody = TEST_BUFFER_RESP_BODY;
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    (void)HTTPAPIEX_ExecuteRequest(httpapiexhandle, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, requestHttpHeaders, requestHttpBody, &httpStatusCode, responseHttpHeaders, responseHttpBody);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(HTTPAPI_CloneOption("someOption", "a", IGNORED_PTR_ARG));
+    EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, "someOption"));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "someOption"))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
+        .IgnoreArgument(1)
+        .IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is the pool key*/
+        .IgnoreArgument(1);
+
+    /// act
+    result = HTTPAPIEX_SetOption(httpapiexhandle, "someOption", "a");
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_02_042: [HTTPAPIEX_Destroy shall free all the resources used by HTTAPIEX_HANDLE.] */
+TEST_FUNCTION(HTTPAPIEX_Destroy_with_pool_after_a_request_frees_resources)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_CreateWithPool(TEST_HOSTNAME, TEST_POOL);
+    unsigned int httpStatusCode;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    BUFFER_HANDLE requestHttpBody = TEST_BUFFER_REQ_BODY;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    BUFFER_HANDLE responseHttpBody = TEST_BUFFER_RESP_BODY;
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    (void)HTTPAPIEX_ExecuteRequest(httpapiexhandle, HTTPAPI_REQUEST_PATCH, TEST_RELATIVE_PATH, requestHttpHeaders, requestHttpBody, &httpStatusCode, responseHttpHeaders, responseHttpBody);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(HTTPAPI_Deinit()); /*the connection is in the pool, only the HTTPAPI_Init is undone*/
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is hostname*/
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is the pool key*/
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_free(httpapiexhandle));
+
+    /// act
+    HTTPAPIEX_Destroy(httpapiexhandle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_012: [ If handle or onRequestComplete is NULL, or requestType does not indicate a valid request, HTTPAPIEX_ExecuteRequestAsync shall fail and return HTTPAPIEX_INVALID_ARG. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequestAsync_with_NULL_handle_fails)
+{
+    /// arrange
+
+    /// act
+    HTTPAPIEX_RESULT result = HTTPAPIEX_ExecuteRequestAsync(NULL, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, onAsyncRequestComplete, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_HTTPAPIEX_01_012: [ If handle or onRequestComplete is NULL, or requestType does not indicate a valid request, HTTPAPIEX_ExecuteRequestAsync shall fail and return HTTPAPIEX_INVALID_ARG. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequestAsync_with_NULL_onRequestComplete_fails)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    umock_c_reset_all_calls();
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequestAsync(httpapiexhandle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_013: [ HTTPAPIEX_ExecuteRequestAsync shall build the request headers, relative path and content the same way HTTPAPIEX_ExecuteRequest does. ]*/
+/*Tests_SRS_HTTPAPIEX_01_014: [ The first call shall create the async requests engine of the handle by calling httpapi_async_create with the host name and pass it all the saved options. ]*/
+/*Tests_SRS_HTTPAPIEX_01_015: [ HTTPAPIEX_ExecuteRequestAsync shall queue the request by calling httpapi_async_execute_request and return HTTPAPIEX_OK. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequestAsync_queues_the_request)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    (void)HTTPAPIEX_SetOption(httpapiexhandle, "TrustedCerts", "certs");
+    umock_c_reset_all_calls();
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequestAsync(httpapiexhandle, HTTPAPI_REQUEST_POST, TEST_RELATIVE_PATH, NULL, NULL, onAsyncRequestComplete, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 1, httpapi_async_create_calls);
+    ASSERT_ARE_EQUAL(char_ptr, "TrustedCerts", asyncLastOptionName);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_RELATIVE_PATH, asyncRelativePath);
+    ASSERT_ARE_EQUAL(size_t, TEST_BUFFER_SIZE, asyncContentLength);
+    ASSERT_IS_NOT_NULL(asyncOnRequestComplete);
+    ASSERT_ARE_EQUAL(size_t, 0, asyncCompleteCalls);
+
+    ///destroy
+    asyncOnRequestComplete(asyncCallbackContext, HTTPAPI_ASYNC_CANCELLED, 0, NULL, NULL);
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_014: [ The first call shall create the async requests engine of the handle by calling httpapi_async_create with the host name and pass it all the saved options. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequestAsync_creates_the_async_requests_engine_once)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    (void)HTTPAPIEX_ExecuteRequestAsync(httpapiexhandle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, onAsyncRequestComplete, NULL);
+    asyncOnRequestComplete(asyncCallbackContext, HTTPAPI_ASYNC_OK, 200, NULL, NULL);
+
+    /// act
+    (void)HTTPAPIEX_ExecuteRequestAsync(httpapiexhandle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, onAsyncRequestComplete, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 1, httpapi_async_create_calls);
+
+    ///destroy
+    asyncOnRequestComplete(asyncCallbackContext, HTTPAPI_ASYNC_CANCELLED, 0, NULL, NULL);
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_016: [ If any error occurs, HTTPAPIEX_ExecuteRequestAsync shall fail and return HTTPAPIEX_ERROR, and onRequestComplete shall not be called. ]*/
+TEST_FUNCTION(when_httpapi_async_create_fails_HTTPAPIEX_ExecuteRequestAsync_fails)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(httpapi_async_create(TEST_HOSTNAME, IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequestAsync(httpapiexhandle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, onAsyncRequestComplete, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, asyncCompleteCalls);
+
+    ///destroy
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_023: [ If the async requests engine rejects one of the saved options, like a proxy or any other option that is not a TLS identity option or "timeout", HTTPAPIEX_ExecuteRequestAsync shall destroy the engine, fail and return HTTPAPIEX_ERROR, so the requests are never sent without a setting of the handle. ]*/
+TEST_FUNCTION(when_a_saved_option_does_not_apply_to_async_requests_HTTPAPIEX_ExecuteRequestAsync_fails)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    (void)HTTPAPIEX_SetOption(httpapiexhandle, "someOption", "333");
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(httpapi_async_create(TEST_HOSTNAME, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0));
+    STRICT_EXPECTED_CALL(httpapi_async_set_option(TEST_ASYNC_HANDLE, "someOption", IGNORED_PTR_ARG))
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(httpapi_async_destroy(TEST_ASYNC_HANDLE));
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequestAsync(httpapiexhandle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, onAsyncRequestComplete, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, asyncCompleteCalls);
+
+    ///destroy
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_016: [ If any error occurs, HTTPAPIEX_ExecuteRequestAsync shall fail and return HTTPAPIEX_ERROR, and onRequestComplete shall not be called. ]*/
+TEST_FUNCTION(when_httpapi_async_execute_request_fails_HTTPAPIEX_ExecuteRequestAsync_fails)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(httpapi_async_execute_request(TEST_ASYNC_HANDLE, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(1);
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequestAsync(httpapiexhandle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, onAsyncRequestComplete, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_ERROR, result);
+    ASSERT_ARE_EQUAL(size_t, 0, asyncCompleteCalls);
+
+    ///destroy
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_017: [ When the request completes, onRequestComplete shall be called with HTTPAPIEX_OK, the status code, the response headers and the response content. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequestAsync_completes_with_HTTPAPIEX_OK)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    (void)HTTPAPIEX_ExecuteRequestAsync(httpapiexhandle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, onAsyncRequestComplete, NULL);
+
+    /// act
+    asyncOnRequestComplete(asyncCallbackContext, HTTPAPI_ASYNC_OK, 204, TEST_RESPONSE_HTTP_HEADERS, TEST_RESPONSE_BODY);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 1, asyncCompleteCalls);
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, asyncResult);
+    ASSERT_ARE_EQUAL(int, 204, (int)asyncStatusCode);
+
+    ///destroy
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_018: [ If the request fails or times out, onRequestComplete shall be called with HTTPAPIEX_RECOVERYFAILED. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequestAsync_timed_out_completes_with_HTTPAPIEX_RECOVERYFAILED)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    (void)HTTPAPIEX_ExecuteRequestAsync(httpapiexhandle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, onAsyncRequestComplete, NULL);
+
+    /// act
+    asyncOnRequestComplete(asyncCallbackContext, HTTPAPI_ASYNC_TIMEOUT, 0, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 1, asyncCompleteCalls);
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_RECOVERYFAILED, asyncResult);
+
+    ///destroy
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_019: [ Requests that did not complete when the handle is destroyed shall complete with HTTPAPIEX_ERROR. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequestAsync_cancelled_completes_with_HTTPAPIEX_ERROR)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    (void)HTTPAPIEX_ExecuteRequestAsync(httpapiexhandle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, onAsyncRequestComplete, NULL);
+
+    /// act
+    asyncOnRequestComplete(asyncCallbackContext, HTTPAPI_ASYNC_CANCELLED, 0, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 1, asyncCompleteCalls);
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_ERROR, asyncResult);
+
+    ///destroy
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_020: [ If handle is NULL, HTTPAPIEX_DoWork shall do nothing. ]*/
+TEST_FUNCTION(HTTPAPIEX_DoWork_with_NULL_handle_does_nothing)
+{
+    /// arrange
+
+    /// act
+    HTTPAPIEX_DoWork(NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_HTTPAPIEX_01_021: [ HTTPAPIEX_DoWork shall call httpapi_async_dowork when requests have been queued on the handle. ]*/
+TEST_FUNCTION(HTTPAPIEX_DoWork_without_async_requests_does_nothing)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    umock_c_reset_all_calls();
+
+    /// act
+    HTTPAPIEX_DoWork(httpapiexhandle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_021: [ HTTPAPIEX_DoWork shall call httpapi_async_dowork when requests have been queued on the handle. ]*/
+TEST_FUNCTION(HTTPAPIEX_DoWork_calls_httpapi_async_dowork)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    (void)HTTPAPIEX_ExecuteRequestAsync(httpapiexhandle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, onAsyncRequestComplete, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(httpapi_async_dowork(TEST_ASYNC_HANDLE));
+
+    /// act
+    HTTPAPIEX_DoWork(httpapiexhandle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    asyncOnRequestComplete(asyncCallbackContext, HTTPAPI_ASYNC_CANCELLED, 0, NULL, NULL);
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_022: [ When the option was saved and the handle has an async requests engine, HTTPAPIEX_SetOption shall pass the option to it by calling httpapi_async_set_option; if that fails, the following calls to HTTPAPIEX_ExecuteRequestAsync shall fail and return HTTPAPIEX_ERROR. ]*/
+TEST_FUNCTION(HTTPAPIEX_SetOption_passes_the_option_to_the_async_requests_engine)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    (void)HTTPAPIEX_ExecuteRequestAsync(httpapiexhandle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, onAsyncRequestComplete, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(httpapi_async_set_option(TEST_ASYNC_HANDLE, "someOption", IGNORED_PTR_ARG))
+        .SetReturn(1);
+
+    /// act
+    result = HTTPAPIEX_SetOption(httpapiexhandle, "someOption", "333");
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+
+    ///destroy
+    asyncOnRequestComplete(asyncCallbackContext, HTTPAPI_ASYNC_CANCELLED, 0, NULL, NULL);
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_01_022: [ When the option was saved and the handle has an async requests engine, HTTPAPIEX_SetOption shall pass the option to it by calling httpapi_async_set_option; if that fails, the following calls to HTTPAPIEX_ExecuteRequestAsync shall fail and return HTTPAPIEX_ERROR. ]*/
+TEST_FUNCTION(when_the_async_requests_engine_rejects_an_option_HTTPAPIEX_ExecuteRequestAsync_fails)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    (void)HTTPAPIEX_ExecuteRequestAsync(httpapiexhandle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, onAsyncRequestComplete, NULL);
+    asyncOnRequestComplete(asyncCallbackContext, HTTPAPI_ASYNC_OK, 200, NULL, NULL);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(httpapi_async_set_option(TEST_ASYNC_HANDLE, "someOption", IGNORED_PTR_ARG))
+        .SetReturn(1);
+    (void)HTTPAPIEX_SetOption(httpapiexhandle, "someOption", "333");
+    asyncRelativePath = NULL;
+    umock_c_reset_all_calls();
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequestAsync(httpapiexhandle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, onAsyncRequestComplete, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(asyncRelativePath);
+    ASSERT_ARE_EQUAL(size_t, 1, asyncCompleteCalls);
+
+    ///destroy
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_02_042: [HTTPAPIEX_Destroy shall free all the resources used by HTTAPIEX_HANDLE.] */
+TEST_FUNCTION(HTTPAPIEX_Destroy_destroys_the_async_requests_engine)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    (void)HTTPAPIEX_ExecuteRequestAsync(httpapiexhandle, HTTPAPI_REQUEST_GET, TEST_RELATIVE_PATH, NULL, NULL, onAsyncRequestComplete, NULL);
+    asyncOnRequestComplete(asyncCallbackContext, HTTPAPI_ASYNC_OK, 200, NULL, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(httpapi_async_destroy(TEST_ASYNC_HANDLE));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is hostname*/
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_free(httpapiexhandle));
+
+    /// act
+    HTTPAPIEX_Destroy(httpapiexhandle);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 END_TEST_SUITE(httpapiex_unittests)
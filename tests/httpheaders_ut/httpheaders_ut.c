@@ -1232,6 +1232,152 @@ BEGIN_TEST_SUITE(HTTPHeaders_UnitTests)
             free(headerValue);
         }
 
+        /*Tests_SRS_HTTP_HEADERS_01_002: [ If handle, name or value is NULL, HTTPHeaders_GetHeaderNameValue shall return HTTP_HEADERS_INVALID_ARG. ]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeaderNameValue_with_NULL_handle_fails)
+        {
+            ///arrange
+            const char* name;
+            const char* value;
+
+            ///act
+            HTTP_HEADERS_RESULT res = HTTPHeaders_GetHeaderNameValue(NULL, 0, &name, &value);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_01_002: [ If handle, name or value is NULL, HTTPHeaders_GetHeaderNameValue shall return HTTP_HEADERS_INVALID_ARG. ]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeaderNameValue_with_NULL_name_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            const char* value;
+            umock_c_reset_all_calls();
+
+            ///act
+            res = HTTPHeaders_GetHeaderNameValue(httpHandle, 0, NULL, &value);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_01_002: [ If handle, name or value is NULL, HTTPHeaders_GetHeaderNameValue shall return HTTP_HEADERS_INVALID_ARG. ]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeaderNameValue_with_NULL_value_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            const char* name;
+            umock_c_reset_all_calls();
+
+            ///act
+            res = HTTPHeaders_GetHeaderNameValue(httpHandle, 0, &name, NULL);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_01_003: [ If index is not smaller than the number of stored headers, HTTPHeaders_GetHeaderNameValue shall return HTTP_HEADERS_INVALID_ARG. ]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeaderNameValue_with_index_too_big_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            const char* keys[1] = { "a" };
+            const char** pKeys = &keys[0];
+            const char* values[1] = { "b" };
+            const char** pValues = &values[0];
+            const size_t one = 1;
+            const char* name;
+            const char* value;
+            umock_c_reset_all_calls();
+
+            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .IgnoreArgument(1)
+                .CopyOutArgumentBuffer(2, &pKeys, sizeof(pKeys))
+                .CopyOutArgumentBuffer(3, &pValues, sizeof(pValues))
+                .CopyOutArgumentBuffer(4, &one, sizeof(one));
+
+            ///act
+            res = HTTPHeaders_GetHeaderNameValue(httpHandle, 1, &name, &value);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_INVALID_ARG, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_01_001: [ HTTPHeaders_GetHeaderNameValue shall point name and value at the stored name and value of the index header, without copying them, and return HTTP_HEADERS_OK. ]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeaderNameValue_succeeds_without_allocating)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            const char* keys[2] = { "a", "c" };
+            const char** pKeys = &keys[0];
+            const char* values[2] = { "b", "d" };
+            const char** pValues = &values[0];
+            const size_t two = 2;
+            const char* name;
+            const char* value;
+            umock_c_reset_all_calls();
+
+            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .IgnoreArgument(1)
+                .CopyOutArgumentBuffer(2, &pKeys, sizeof(pKeys))
+                .CopyOutArgumentBuffer(3, &pValues, sizeof(pValues))
+                .CopyOutArgumentBuffer(4, &two, sizeof(two));
+
+            ///act
+            res = HTTPHeaders_GetHeaderNameValue(httpHandle, 1, &name, &value);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_OK, res);
+            ASSERT_ARE_EQUAL(void_ptr, (void*)keys[1], (void*)name);
+            ASSERT_ARE_EQUAL(void_ptr, (void*)values[1], (void*)value);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
+        /*Tests_SRS_HTTP_HEADERS_01_004: [ If Map_GetInternals fails, HTTPHeaders_GetHeaderNameValue shall return HTTP_HEADERS_ERROR. ]*/
+        TEST_FUNCTION(HTTPHeaders_GetHeaderNameValue_fails_when_Map_GetInternals_fails)
+        {
+            ///arrange
+            HTTP_HEADERS_RESULT res;
+            HTTP_HEADERS_HANDLE httpHandle = HTTPHeaders_Alloc();
+            const char* name;
+            const char* value;
+            umock_c_reset_all_calls();
+
+            STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .IgnoreAllArguments()
+                .SetReturn(MAP_ERROR);
+
+            ///act
+            res = HTTPHeaders_GetHeaderNameValue(httpHandle, 0, &name, &value);
+
+            ///assert
+            ASSERT_ARE_EQUAL(HTTP_HEADERS_RESULT, HTTP_HEADERS_ERROR, res);
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            HTTPHeaders_Free(httpHandle);
+        }
+
         /*Tests_SRS_HTTP_HEADERS_99_031:[ If name contains the character ":" then the return value shall be HTTP_HEADERS_INVALID_ARG.]*/
         TEST_FUNCTION(HTTPHeaders_AddHeaderNameValuePair_with_colon_in_name_fails)
         {
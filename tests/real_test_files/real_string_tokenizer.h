@@ -8,11 +8,15 @@
     REGISTER_GLOBAL_MOCK_HOOK(STRING_TOKENIZER_create, real_STRING_TOKENIZER_create); \
     REGISTER_GLOBAL_MOCK_HOOK(STRING_TOKENIZER_create_from_char, real_STRING_TOKENIZER_create_from_char); \
     REGISTER_GLOBAL_MOCK_HOOK(STRING_TOKENIZER_get_next_token, real_STRING_TOKENIZER_get_next_token); \
+    REGISTER_GLOBAL_MOCK_HOOK(STRING_TOKENIZER_compile_delimiters, real_STRING_TOKENIZER_compile_delimiters); \
+    REGISTER_GLOBAL_MOCK_HOOK(STRING_TOKENIZER_get_next_token_view, real_STRING_TOKENIZER_get_next_token_view); \
     REGISTER_GLOBAL_MOCK_HOOK(STRING_TOKENIZER_destroy, real_STRING_TOKENIZER_destroy); 
 
 #define STRING_TOKENIZER_create               real_STRING_TOKENIZER_create
 #define STRING_TOKENIZER_create_from_char     real_STRING_TOKENIZER_create_from_char
 #define STRING_TOKENIZER_get_next_token       real_STRING_TOKENIZER_get_next_token
+#define STRING_TOKENIZER_compile_delimiters   real_STRING_TOKENIZER_compile_delimiters
+#define STRING_TOKENIZER_get_next_token_view  real_STRING_TOKENIZER_get_next_token_view
 #define STRING_TOKENIZER_destroy              real_STRING_TOKENIZER_destroy
 
 #undef STRING_TOKENIZER_H
@@ -23,6 +27,8 @@
 #undef STRING_TOKENIZER_create                  
 #undef STRING_TOKENIZER_create_from_char                
 #undef STRING_TOKENIZER_get_next_token            
+#undef STRING_TOKENIZER_compile_delimiters
+#undef STRING_TOKENIZER_get_next_token_view
 #undef STRING_TOKENIZER_destroy          
  
 #endif
@@ -26,6 +26,8 @@
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_concat, __LINE__); \
     REGISTER_GLOBAL_MOCK_HOOK(STRING_concat_with_STRING, real_STRING_concat_with_STRING); \
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_concat_with_STRING, __LINE__); \
+    REGISTER_GLOBAL_MOCK_HOOK(STRING_concat_JSON, real_STRING_concat_JSON); \
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_concat_JSON, __LINE__); \
     REGISTER_GLOBAL_MOCK_HOOK(STRING_quote, real_STRING_quote); \
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_quote, __LINE__); \
     REGISTER_GLOBAL_MOCK_HOOK(STRING_copy, real_STRING_copy); \
@@ -51,6 +53,7 @@
 #define STRING_delete                   real_STRING_delete 
 #define STRING_concat                   real_STRING_concat 
 #define STRING_concat_with_STRING       real_STRING_concat_with_STRING 
+#define STRING_concat_JSON              real_STRING_concat_JSON 
 #define STRING_quote                    real_STRING_quote 
 #define STRING_copy                     real_STRING_copy 
 #define STRING_copy_n                   real_STRING_copy_n 
@@ -77,6 +80,7 @@
 #undef STRING_delete               
 #undef STRING_concat               
 #undef STRING_concat_with_STRING   
+#undef STRING_concat_JSON          
 #undef STRING_quote                
 #undef STRING_copy                 
 #undef STRING_copy_n               
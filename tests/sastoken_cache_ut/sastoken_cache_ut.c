@@ -0,0 +1,800 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#endif
+
+#define MAX_TRACKED_BLOCKS 64
+
+/* live allocations are tracked so that frees of blocks still holding a key or a token can be counted */
+typedef struct TRACKED_BLOCK_TAG
+{
+    void* ptr;
+    size_t size;
+} TRACKED_BLOCK;
+
+static TRACKED_BLOCK g_tracked_blocks[MAX_TRACKED_BLOCKS];
+static size_t g_secrets_freed;
+
+static TRACKED_BLOCK* find_tracked_block(const void* ptr)
+{
+    size_t i;
+    TRACKED_BLOCK* result = NULL;
+
+    for (i = 0; i < MAX_TRACKED_BLOCKS; i++)
+    {
+        if (g_tracked_blocks[i].ptr == ptr)
+        {
+            result = &g_tracked_blocks[i];
+            break;
+        }
+    }
+
+    return result;
+}
+
+static void track_block(void* ptr, size_t size)
+{
+    TRACKED_BLOCK* block = find_tracked_block(NULL);
+    if ((ptr != NULL) && (block != NULL))
+    {
+        block->ptr = ptr;
+        block->size = size;
+    }
+}
+
+static int block_contains(const TRACKED_BLOCK* block, const char* text)
+{
+    size_t textLength = strlen(text);
+    size_t i;
+    int result = 0;
+
+    for (i = 0; i + textLength <= block->size; i++)
+    {
+        if (memcmp((const char*)block->ptr + i, text, textLength) == 0)
+        {
+            result = 1;
+            break;
+        }
+    }
+
+    return result;
+}
+
+static void* my_gballoc_malloc(size_t size)
+{
+    void* result = malloc(size);
+    track_block(result, size);
+    return result;
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    void* result = realloc(ptr, size);
+    TRACKED_BLOCK* block = find_tracked_block(ptr);
+    if ((result != NULL) && (ptr != NULL) && (block != NULL))
+    {
+        block->ptr = NULL;
+    }
+    if (result != NULL)
+    {
+        track_block(result, size);
+    }
+    return result;
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    TRACKED_BLOCK* block = (ptr == NULL) ? NULL : find_tracked_block(ptr);
+    if (block != NULL)
+    {
+        if (block_contains(block, "a2V5") || block_contains(block, "token"))
+        {
+            g_secrets_freed++;
+        }
+        block->ptr = NULL;
+    }
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/sastoken.h"
+#undef ENABLE_MOCKS
+
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/sastoken_cache.h"
+
+#define TEST_KEY "a2V5"
+#define TEST_SCOPE "myhub.azure-devices.net/devices/dev1"
+#define TEST_KEYNAME "owner"
+#define TEST_START_TIME ((time_t)1000)
+#define TEST_LIFETIME 3600
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+static time_t g_current_time;
+static size_t g_tokens_created;
+static bool g_fail_token_creation;
+static size_t g_last_expiry;
+
+static time_t my_get_time(time_t* currentTime)
+{
+    (void)currentTime;
+    return g_current_time;
+}
+
+static double my_get_difftime(time_t stopTime, time_t startTime)
+{
+    return (double)(stopTime - startTime);
+}
+
+static STRING_HANDLE my_SASToken_CreateString(const char* key, const char* scope, const char* keyName, size_t expiry)
+{
+    STRING_HANDLE result;
+    (void)key;
+    (void)scope;
+    (void)keyName;
+
+    if (g_fail_token_creation)
+    {
+        result = NULL;
+    }
+    else
+    {
+        char token[64];
+        (void)sprintf(token, "token%lu", (unsigned long)g_tokens_created);
+        g_tokens_created++;
+        g_last_expiry = expiry;
+        result = STRING_construct(token);
+    }
+
+    return result;
+}
+
+int umocktypes_copy_time_t(time_t* destination, const time_t* source)
+{
+    *destination = *source;
+    return 0;
+}
+
+void umocktypes_free_time_t(time_t* value)
+{
+    (void)value;
+}
+
+char* umocktypes_stringify_time_t(const time_t* value)
+{
+    char temp_str[32];
+    char* result;
+    int length = snprintf(temp_str, sizeof(temp_str), "%d", (int)(*value));
+    if (length <= 0)
+    {
+        result = NULL;
+    }
+    else
+    {
+        result = (char*)malloc(length + 1);
+        (void)memcpy(result, temp_str, length + 1);
+    }
+    return result;
+}
+
+int umocktypes_are_equal_time_t(time_t* left, time_t* right)
+{
+    return (*left == *right) ? 1 : 0;
+}
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static void assert_statistics(SASTOKEN_CACHE_HANDLE cache, size_t hits, size_t misses, size_t renewals)
+{
+    SASTOKEN_CACHE_STATISTICS statistics;
+    ASSERT_ARE_EQUAL(int, 0, SASTokenCache_GetStatistics(cache, &statistics));
+    ASSERT_ARE_EQUAL(size_t, hits, statistics.hits);
+    ASSERT_ARE_EQUAL(size_t, misses, statistics.misses);
+    ASSERT_ARE_EQUAL(size_t, renewals, statistics.renewals);
+}
+
+static void assert_evictions(SASTOKEN_CACHE_HANDLE cache, size_t evictions)
+{
+    SASTOKEN_CACHE_STATISTICS statistics;
+    ASSERT_ARE_EQUAL(int, 0, SASTokenCache_GetStatistics(cache, &statistics));
+    ASSERT_ARE_EQUAL(size_t, evictions, statistics.evictions);
+}
+
+BEGIN_TEST_SUITE(sastoken_cache_unittests)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    int result;
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_TYPE(time_t, time_t);
+    REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_HOOK(get_time, my_get_time);
+    REGISTER_GLOBAL_MOCK_HOOK(get_difftime, my_get_difftime);
+    REGISTER_GLOBAL_MOCK_HOOK(SASToken_CreateString, my_SASToken_CreateString);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+    g_current_time = TEST_START_TIME;
+    g_tokens_created = 0;
+    g_fail_token_creation = false;
+    g_last_expiry = 0;
+    g_secrets_freed = 0;
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* SASTokenCache_Create */
+
+/* Tests_SRS_SASTOKEN_CACHE_01_001: [ If tokenLifetime is 0, SASTokenCache_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(SASTokenCache_Create_with_zero_lifetime_fails)
+{
+    // arrange
+
+    // act
+    SASTOKEN_CACHE_HANDLE result = SASTokenCache_Create(0, 80);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_002: [ If renewalPercentage is 0 or greater than 100, SASTokenCache_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(SASTokenCache_Create_with_zero_renewal_percentage_fails)
+{
+    // arrange
+
+    // act
+    SASTOKEN_CACHE_HANDLE result = SASTokenCache_Create(TEST_LIFETIME, 0);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_002: [ If renewalPercentage is 0 or greater than 100, SASTokenCache_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(SASTokenCache_Create_with_renewal_percentage_above_100_fails)
+{
+    // arrange
+
+    // act
+    SASTOKEN_CACHE_HANDLE result = SASTokenCache_Create(TEST_LIFETIME, 101);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_003: [ SASTokenCache_Create shall allocate a new cache and return a non-NULL handle to it. ]*/
+TEST_FUNCTION(SASTokenCache_Create_succeeds)
+{
+    // arrange
+    SASTOKEN_CACHE_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+
+    // act
+    result = SASTokenCache_Create(TEST_LIFETIME, 80);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    assert_statistics(result, 0, 0, 0);
+
+    // cleanup
+    SASTokenCache_Destroy(result);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_004: [ If any error occurs, SASTokenCache_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(when_allocating_the_cache_fails_SASTokenCache_Create_fails)
+{
+    // arrange
+    SASTOKEN_CACHE_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    // act
+    result = SASTokenCache_Create(TEST_LIFETIME, 80);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_004: [ If any error occurs, SASTokenCache_Create shall fail and return NULL. ]*/
+TEST_FUNCTION(when_creating_the_entry_list_fails_SASTokenCache_Create_fails)
+{
+    // arrange
+    SASTOKEN_CACHE_HANDLE result;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    result = SASTokenCache_Create(TEST_LIFETIME, 80);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* SASTokenCache_Destroy */
+
+/* Tests_SRS_SASTOKEN_CACHE_01_005: [ If handle is NULL, SASTokenCache_Destroy shall do nothing. ]*/
+TEST_FUNCTION(SASTokenCache_Destroy_with_NULL_handle_does_nothing)
+{
+    // arrange
+
+    // act
+    SASTokenCache_Destroy(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_006: [ SASTokenCache_Destroy shall free all cached tokens and the cache itself. ]*/
+/* Tests_SRS_SASTOKEN_CACHE_01_023: [ Before freeing an entry, SASTokenCache_Destroy and SASTokenCache_DoWork shall overwrite its key, scope, keyName and token with zeros. ]*/
+TEST_FUNCTION(SASTokenCache_Destroy_clears_the_cached_keys_and_tokens)
+{
+    // arrange
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 80);
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, NULL);
+
+    // act
+    SASTokenCache_Destroy(cache);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 0, g_secrets_freed);
+}
+
+/* SASTokenCache_GetToken */
+
+/* Tests_SRS_SASTOKEN_CACHE_01_007: [ If handle, key or scope is NULL, SASTokenCache_GetToken shall fail and return NULL. ]*/
+TEST_FUNCTION(SASTokenCache_GetToken_with_NULL_handle_fails)
+{
+    // arrange
+
+    // act
+    const char* result = SASTokenCache_GetToken(NULL, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_007: [ If handle, key or scope is NULL, SASTokenCache_GetToken shall fail and return NULL. ]*/
+TEST_FUNCTION(SASTokenCache_GetToken_with_NULL_key_or_scope_fails)
+{
+    // arrange
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 80);
+    umock_c_reset_all_calls();
+
+    // act
+    const char* result1 = SASTokenCache_GetToken(cache, NULL, TEST_SCOPE, TEST_KEYNAME);
+    const char* result2 = SASTokenCache_GetToken(cache, TEST_KEY, NULL, TEST_KEYNAME);
+
+    // assert
+    ASSERT_IS_NULL(result1);
+    ASSERT_IS_NULL(result2);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_008: [ If the current time cannot be obtained, SASTokenCache_GetToken shall fail and return NULL. ]*/
+TEST_FUNCTION(when_get_time_fails_SASTokenCache_GetToken_fails)
+{
+    // arrange
+    const char* result;
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 80);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(get_time(NULL))
+        .SetReturn((time_t)-1);
+
+    // act
+    result = SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_010: [ If no entry is cached, SASTokenCache_GetToken shall create a token expiring tokenLifetime seconds from now by calling SASToken_CreateString, cache it, count a miss and return it. ]*/
+TEST_FUNCTION(SASTokenCache_GetToken_creates_the_first_token)
+{
+    // arrange
+    const char* result;
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 80);
+
+    // act
+    result = SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, "token0", result);
+    ASSERT_ARE_EQUAL(size_t, 1, g_tokens_created);
+    ASSERT_ARE_EQUAL(size_t, (size_t)TEST_START_TIME + TEST_LIFETIME, g_last_expiry);
+    assert_statistics(cache, 0, 1, 0);
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_011: [ If creating or caching the new token fails, SASTokenCache_GetToken shall fail and return NULL. ]*/
+TEST_FUNCTION(when_creating_the_first_token_fails_SASTokenCache_GetToken_fails)
+{
+    // arrange
+    const char* result;
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 80);
+    g_fail_token_creation = true;
+
+    // act
+    result = SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    assert_statistics(cache, 0, 1, 0);
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_011: [ If creating or caching the new token fails, SASTokenCache_GetToken shall fail and return NULL. ]*/
+TEST_FUNCTION(when_allocating_the_entry_fails_SASTokenCache_GetToken_fails)
+{
+    // arrange
+    const char* result;
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 80);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(TEST_START_TIME, (time_t)0));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    // act
+    result = SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_012: [ If the cached token has not yet reached renewalPercentage of its lifetime, SASTokenCache_GetToken shall count a hit and return it without creating a new token. ]*/
+TEST_FUNCTION(SASTokenCache_GetToken_returns_the_cached_token_before_the_renewal_point)
+{
+    // arrange
+    const char* first;
+    const char* second;
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 80);
+    first = SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+    g_current_time = TEST_START_TIME + (TEST_LIFETIME * 80 / 100) - 1;
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, (time_t)0))
+        .IgnoreArgument_stopTime();
+
+    // act
+    second = SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, (void*)first, (void*)second);
+    ASSERT_ARE_EQUAL(size_t, 1, g_tokens_created);
+    assert_statistics(cache, 1, 1, 0);
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_009: [ SASTokenCache_GetToken shall look up the entry cached for the (key, scope, keyName) triple; a NULL keyName only matches a NULL keyName. ]*/
+TEST_FUNCTION(SASTokenCache_GetToken_keeps_separate_entries_per_key_scope_and_keyName)
+{
+    // arrange
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 80);
+
+    // act
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, NULL);
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE "/other", TEST_KEYNAME);
+    (void)SASTokenCache_GetToken(cache, "b3RoZXI=", TEST_SCOPE, TEST_KEYNAME);
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, NULL);
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 4, g_tokens_created);
+    assert_statistics(cache, 2, 4, 0);
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_013: [ Otherwise SASTokenCache_GetToken shall count a miss, replace the cached token with a newly created one and return it. ]*/
+TEST_FUNCTION(SASTokenCache_GetToken_renews_the_token_at_the_renewal_point)
+{
+    // arrange
+    const char* result;
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 80);
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+    g_current_time = TEST_START_TIME + (TEST_LIFETIME * 80 / 100);
+
+    // act
+    result = SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, "token1", result);
+    ASSERT_ARE_EQUAL(size_t, (size_t)g_current_time + TEST_LIFETIME, g_last_expiry);
+    assert_statistics(cache, 0, 2, 0);
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_014: [ If creating the new token fails and the cached token has not expired, SASTokenCache_GetToken shall return the cached token. ]*/
+TEST_FUNCTION(when_renewing_fails_before_expiry_SASTokenCache_GetToken_returns_the_cached_token)
+{
+    // arrange
+    const char* result;
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 80);
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+    g_current_time = TEST_START_TIME + TEST_LIFETIME - 1;
+    g_fail_token_creation = true;
+
+    // act
+    result = SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, "token0", result);
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_015: [ If creating the new token fails and the cached token has expired, SASTokenCache_GetToken shall fail and return NULL. ]*/
+TEST_FUNCTION(when_renewing_fails_after_expiry_SASTokenCache_GetToken_fails)
+{
+    // arrange
+    const char* result;
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 80);
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+    g_current_time = TEST_START_TIME + TEST_LIFETIME;
+    g_fail_token_creation = true;
+
+    // act
+    result = SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+
+    // assert
+    ASSERT_IS_NULL(result);
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+/* SASTokenCache_DoWork */
+
+/* Tests_SRS_SASTOKEN_CACHE_01_016: [ If handle is NULL, SASTokenCache_DoWork shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(SASTokenCache_DoWork_with_NULL_handle_fails)
+{
+    // arrange
+
+    // act
+    int result = SASTokenCache_DoWork(NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_017: [ If the current time cannot be obtained, SASTokenCache_DoWork shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(when_get_time_fails_SASTokenCache_DoWork_fails)
+{
+    // arrange
+    int result;
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 80);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(get_time(NULL))
+        .SetReturn((time_t)-1);
+
+    // act
+    result = SASTokenCache_DoWork(cache);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_018: [ SASTokenCache_DoWork shall renew every cached token that has reached renewalPercentage of its lifetime and count a renewal for each, so that SASTokenCache_GetToken keeps hitting when DoWork is driven from outside the request path. ]*/
+TEST_FUNCTION(SASTokenCache_DoWork_renews_due_tokens_ahead_of_GetToken)
+{
+    // arrange
+    int result;
+    const char* token;
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 50);
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+    g_current_time = TEST_START_TIME + 100;
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, NULL);
+    g_current_time = TEST_START_TIME + (TEST_LIFETIME / 2);
+
+    // act
+    result = SASTokenCache_DoWork(cache);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 3, g_tokens_created);
+    token = SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+    ASSERT_ARE_EQUAL(char_ptr, "token2", token);
+    assert_statistics(cache, 1, 2, 1);
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_022: [ SASTokenCache_DoWork shall remove, without renewing it, every entry that SASTokenCache_GetToken has not asked for during the last tokenLifetime seconds and count an eviction for each. ]*/
+/* Tests_SRS_SASTOKEN_CACHE_01_023: [ Before freeing an entry, SASTokenCache_Destroy and SASTokenCache_DoWork shall overwrite its key, scope, keyName and token with zeros. ]*/
+TEST_FUNCTION(SASTokenCache_DoWork_evicts_the_entries_unused_for_a_token_lifetime)
+{
+    // arrange
+    int result;
+    const char* token;
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 50);
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, NULL);
+    g_current_time = TEST_START_TIME + (TEST_LIFETIME / 2);
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, NULL);
+    g_current_time = TEST_START_TIME + TEST_LIFETIME;
+    g_secrets_freed = 0;
+
+    // act
+    result = SASTokenCache_DoWork(cache);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 0, g_secrets_freed);
+    ASSERT_ARE_EQUAL(size_t, 4, g_tokens_created);
+    assert_evictions(cache, 1);
+    token = SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+    ASSERT_ARE_EQUAL(char_ptr, "token4", token);
+    token = SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, NULL);
+    ASSERT_ARE_EQUAL(char_ptr, "token3", token);
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_022: [ SASTokenCache_DoWork shall remove, without renewing it, every entry that SASTokenCache_GetToken has not asked for during the last tokenLifetime seconds and count an eviction for each. ]*/
+TEST_FUNCTION(SASTokenCache_DoWork_keeps_the_entries_used_during_the_last_token_lifetime)
+{
+    // arrange
+    int result;
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 50);
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+    g_current_time = TEST_START_TIME + TEST_LIFETIME - 1;
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+    g_current_time = TEST_START_TIME + TEST_LIFETIME;
+
+    // act
+    result = SASTokenCache_DoWork(cache);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    assert_evictions(cache, 0);
+    assert_statistics(cache, 0, 2, 0);
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+/* Tests_SRS_SASTOKEN_CACHE_01_019: [ If renewing any token fails, SASTokenCache_DoWork shall still attempt the remaining ones, keep the failed entry's previous token and return a non-zero value. ]*/
+TEST_FUNCTION(when_renewing_fails_SASTokenCache_DoWork_keeps_the_previous_token_and_fails)
+{
+    // arrange
+    int result;
+    const char* token;
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 50);
+    (void)SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+    g_current_time = TEST_START_TIME + (TEST_LIFETIME / 2);
+    g_fail_token_creation = true;
+
+    // act
+    result = SASTokenCache_DoWork(cache);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    token = SASTokenCache_GetToken(cache, TEST_KEY, TEST_SCOPE, TEST_KEYNAME);
+    ASSERT_ARE_EQUAL(char_ptr, "token0", token);
+    assert_statistics(cache, 0, 2, 0);
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+/* SASTokenCache_GetStatistics */
+
+/* Tests_SRS_SASTOKEN_CACHE_01_020: [ If handle or statistics is NULL, SASTokenCache_GetStatistics shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(SASTokenCache_GetStatistics_with_NULL_arguments_fails)
+{
+    // arrange
+    SASTOKEN_CACHE_STATISTICS statistics;
+    SASTOKEN_CACHE_HANDLE cache = SASTokenCache_Create(TEST_LIFETIME, 80);
+    umock_c_reset_all_calls();
+
+    // act
+    int result1 = SASTokenCache_GetStatistics(NULL, &statistics);
+    int result2 = SASTokenCache_GetStatistics(cache, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    SASTokenCache_Destroy(cache);
+}
+
+END_TEST_SUITE(sastoken_cache_unittests)
@@ -0,0 +1,175 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+
+void* real_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void* real_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+void real_free(void* ptr)
+{
+    free(ptr);
+}
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/agenttime.h"
+#undef ENABLE_MOCKS
+#include "azure_c_shared_utility/sastoken.h"
+#include "azure_c_shared_utility/strings.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+/* HMAC-SHA256 of "<scope>\n<expiry>", base64 encoded and url encoded with lowercase escapes */
+#define TEST_KEY "a2V5a2V5a2V5"
+#define TEST_SCOPE "myhub.azure-devices.net/devices/dev1"
+#define TEST_KEYNAME "iothubowner"
+#define TEST_EXPIRY 1700000000
+#define TEST_TOKEN "SharedAccessSignature sr=" TEST_SCOPE "&sig=%2fLqmup6i5GcHiChsrLDYuqYZcWWRHKyPFOUxBrdif%2bo%3d&se=1700000000"
+#define TEST_TOKEN_WITH_KEYNAME TEST_TOKEN "&skn=" TEST_KEYNAME
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+BEGIN_TEST_SUITE(sastoken_signature_unittests)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, real_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, real_free);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, real_realloc);
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/*Tests_SRS_SASTOKEN_06_012: [An HMAC256 hash is calculated using the decodedKey, over toBeHashed.]*/
+/*Tests_SRS_SASTOKEN_06_015: [The hash is base 64 encoded.]*/
+/*Tests_SRS_SASTOKEN_06_028: [base64Signature shall be url encoded.]*/
+TEST_FUNCTION(SASToken_CreateString_produces_the_known_token)
+{
+    // arrange
+    STRING_HANDLE token;
+
+    // act
+    token = SASToken_CreateString(TEST_KEY, TEST_SCOPE, NULL, TEST_EXPIRY);
+
+    // assert
+    ASSERT_IS_NOT_NULL(token);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_TOKEN, STRING_c_str(token));
+
+    // cleanup
+    STRING_delete(token);
+}
+
+/*Tests_SRS_SASTOKEN_06_022: [If keyName is non-NULL, the string "&skn=" is appended to result.]*/
+/*Tests_SRS_SASTOKEN_06_023: [If keyName is non-NULL, the argument keyName is appended to result.]*/
+TEST_FUNCTION(SASToken_Create_with_a_keyName_produces_the_known_token)
+{
+    // arrange
+    STRING_HANDLE key = STRING_construct(TEST_KEY);
+    STRING_HANDLE scope = STRING_construct(TEST_SCOPE);
+    STRING_HANDLE keyName = STRING_construct(TEST_KEYNAME);
+    STRING_HANDLE token;
+
+    // act
+    token = SASToken_Create(key, scope, keyName, TEST_EXPIRY);
+
+    // assert
+    ASSERT_IS_NOT_NULL(token);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_TOKEN_WITH_KEYNAME, STRING_c_str(token));
+
+    // cleanup
+    STRING_delete(token);
+    STRING_delete(keyName);
+    STRING_delete(scope);
+    STRING_delete(key);
+}
+
+TEST_FUNCTION(SASToken_CreateString_with_a_signature_ending_in_padding_produces_the_known_token)
+{
+    // arrange
+    STRING_HANDLE token;
+
+    // act
+    token = SASToken_CreateString("MTIzNDU2Nzg5MA==", "scope", NULL, 0);
+
+    // assert
+    ASSERT_IS_NOT_NULL(token);
+    ASSERT_ARE_EQUAL(char_ptr, "SharedAccessSignature sr=scope&sig=7qeNTdwvObIA0IHnQIDQCgUojR0nV%2fah3EVyWUG1z5Y%3d&se=0", STRING_c_str(token));
+
+    // cleanup
+    STRING_delete(token);
+}
+
+/*Tests_SRS_SASTOKEN_01_004: [SASToken_CreateString_Into shall write the same token as SASToken_CreateString into destination, null terminate it, store its length in tokenLength and return 0, without allocating memory for the token.]*/
+TEST_FUNCTION(SASToken_CreateString_Into_produces_the_known_token)
+{
+    // arrange
+    char token[sizeof(TEST_TOKEN_WITH_KEYNAME)];
+    size_t tokenLength;
+    int result;
+
+    // act
+    result = SASToken_CreateString_Into(TEST_KEY, TEST_SCOPE, TEST_KEYNAME, TEST_EXPIRY, token, sizeof(token), &tokenLength);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_TOKEN_WITH_KEYNAME, token);
+    ASSERT_ARE_EQUAL(size_t, sizeof(TEST_TOKEN_WITH_KEYNAME) - 1, tokenLength);
+}
+
+END_TEST_SUITE(sastoken_signature_unittests)
@@ -33,40 +33,24 @@ static void my_gballoc_free(void* ptr)
 
 #include "azure_c_shared_utility/gballoc.h"
 
-#include "azure_c_shared_utility/hmacsha256.h"
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/buffer_.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
-#include "azure_c_shared_utility/urlencode.h"
+#include "azure_c_shared_utility/hash.h"
 #include "azure_c_shared_utility/base64.h"
 #include "azure_c_shared_utility/agenttime.h"
 
 #undef ENABLE_MOCKS
 
 
-TEST_DEFINE_ENUM_TYPE(HMACSHA256_RESULT, HMACSHA256_RESULT_VALUES);
-IMPLEMENT_UMOCK_C_ENUM_TYPE(HMACSHA256_RESULT, HMACSHA256_RESULT_VALUES);
-
 double my_get_difftime(time_t stopTime, time_t startTime)
 {
     return (double)(stopTime - startTime);
 }
 
-STRING_HANDLE my_STRING_new(void)
-{
-    return (STRING_HANDLE)malloc(1);
-}
-
-BUFFER_HANDLE my_BUFFER_new(void)
-{
-    return (BUFFER_HANDLE)malloc(1);
-}
+#define TEST_RESULT_HANDLE (STRING_HANDLE)0x53
 
-STRING_HANDLE my_Base64_Encode(BUFFER_HANDLE input)
-{
-    (void)input;
-    return (STRING_HANDLE)malloc(1);
-}
+static char* g_token;
 
 BUFFER_HANDLE my_Base64_Decoder(const char* source)
 {
@@ -74,10 +58,12 @@ BUFFER_HANDLE my_Base64_Decoder(const char* source)
     return (BUFFER_HANDLE)malloc(1);
 }
 
-STRING_HANDLE my_URL_Encode(STRING_HANDLE input)
+int my_Base64_Encode_Bytes_Into(const unsigned char* source, size_t size, char* destination, size_t destination_size);
+
+STRING_HANDLE my_STRING_new_with_memory(const char* memory)
 {
-    (void)input;
-    return (STRING_HANDLE)malloc(1);
+    g_token = (char*)memory;
+    return TEST_RESULT_HANDLE;
 }
 
 #include "azure_c_shared_utility/sastoken.h"
@@ -89,17 +75,11 @@ STRING_HANDLE my_URL_Encode(STRING_HANDLE input)
 #define TEST_SCOPE_HANDLE (STRING_HANDLE)0x48
 #define TEST_KEY_HANDLE (STRING_HANDLE)0x49
 #define TEST_KEYNAME_HANDLE (STRING_HANDLE)0x50
-#define TEST_HASH_HANDLE (BUFFER_HANDLE)0x51
-#define TEST_TOBEHASHED_HANDLE (STRING_HANDLE)0x52
-#define TEST_RESULT_HANDLE (STRING_HANDLE)0x53
-#define TEST_BASE64SIGNATURE_HANDLE (STRING_HANDLE)0x54
-#define TEST_URLENCODEDSIGNATURE_HANDLE (STRING_HANDLE)0x55
 #define TEST_DECODEDKEY_HANDLE (BUFFER_HANDLE)0x56
+#define TEST_HASH_HANDLE (HASH_HANDLE)0x57
 #define TEST_TIME_T ((time_t)3600)
 #define TEST_PTR_DECODEDKEY (unsigned char*)0x123
-#define TEST_LENGTH_DECODEDKEY (size_t)32
-#define TEST_PTR_TOBEHASHED (const char*)0x456
-#define TEST_LENGTH_TOBEHASHED (size_t)456
+#define TEST_LENGTH_DECODEDKEY sizeof(TEST_UNSIGNED_CHAR_ARRAY)
 #define TEST_EXPIRY ((size_t)7200)
 #define TEST_LATER_TIME (time_t) 11
 #define TEST_EARLY_TIME (time_t) 10
@@ -109,6 +89,19 @@ static const char* TEST_NULL_STRING_VALUE = 0x00;
 static char TEST_CHAR_ARRAY[10] = "ABCD";
 static unsigned char TEST_UNSIGNED_CHAR_ARRAY[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09 };
 static char TEST_TOKEN_EXPIRATION_TIME[32] = "7200";
+/* base64 "++++////AAA...A=", so the signature exercises every character that needs URL encoding */
+static unsigned char TEST_DIGEST[32] = { 0xfb, 0xef, 0xbe, 0xff, 0xff, 0xff };
+#define TEST_BASE64_DIGEST "++++////AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA="
+#define TEST_URL_ENCODED_DIGEST "%2b%2b%2b%2b%2f%2f%2f%2fAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA%3d"
+
+int my_Base64_Encode_Bytes_Into(const unsigned char* source, size_t size, char* destination, size_t destination_size)
+{
+    (void)source;
+    (void)size;
+    (void)destination_size;
+    (void)strcpy(destination, TEST_BASE64_DIGEST);
+    return 0;
+}
 
 static TEST_MUTEX_HANDLE g_testByTest;
 static TEST_MUTEX_HANDLE g_dllByDll;
@@ -131,6 +124,29 @@ extern "C"
 }
 #endif
 
+static void setup_decode_key_expected_calls(void)
+{
+    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
+    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
+}
+
+static void setup_signature_expected_calls(const char* scope)
+{
+    setup_decode_key_expected_calls();
+    STRICT_EXPECTED_CALL(HASH_CreateHmac(HASH_ALGORITHM_SHA256, TEST_UNSIGNED_CHAR_ARRAY, TEST_LENGTH_DECODEDKEY));
+    STRICT_EXPECTED_CALL(HASH_Update(TEST_HASH_HANDLE, IGNORED_PTR_ARG, strlen(scope))).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(HASH_Update(TEST_HASH_HANDLE, IGNORED_PTR_ARG, 1)).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(HASH_Update(TEST_HASH_HANDLE, IGNORED_PTR_ARG, 4)).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(HASH_Final(TEST_HASH_HANDLE, TEST_DECODEDKEY_HANDLE));
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(sizeof(TEST_DIGEST));
+    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_DIGEST);
+    STRICT_EXPECTED_CALL(Base64_Encode_Bytes_Into(TEST_DIGEST, sizeof(TEST_DIGEST), IGNORED_PTR_ARG, sizeof(TEST_BASE64_DIGEST))).IgnoreArgument(3);
+    STRICT_EXPECTED_CALL(HASH_Destroy(TEST_HASH_HANDLE));
+    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+}
+
 BEGIN_TEST_SUITE(sastoken_unittests)
 
 TEST_SUITE_INITIALIZE(TestClassInitialize)
@@ -147,30 +163,29 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(size_t, unsigned int);
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HASH_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(HASH_ALGORITHM, int);
+    REGISTER_UMOCK_ALIAS_TYPE(const unsigned char*, void*);
 
     result = umocktypes_charptr_register_types();
     ASSERT_ARE_EQUAL(int, 0, result);
-    REGISTER_TYPE(HMACSHA256_RESULT, HMACSHA256_RESULT);
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
 
-    REGISTER_GLOBAL_MOCK_HOOK(STRING_new, my_STRING_new);
-    REGISTER_GLOBAL_MOCK_RETURN(STRING_concat, 0);
-    REGISTER_GLOBAL_MOCK_RETURN(STRING_concat_with_STRING, 0);
     REGISTER_GLOBAL_MOCK_RETURN(STRING_c_str, &TEST_CHAR_ARRAY[0]);
     REGISTER_GLOBAL_MOCK_RETURN(STRING_length, 1);
-    REGISTER_GLOBAL_MOCK_RETURN(STRING_copy, 0);
+    REGISTER_GLOBAL_MOCK_HOOK(STRING_new_with_memory, my_STRING_new_with_memory);
 
-    REGISTER_GLOBAL_MOCK_HOOK(BUFFER_new, my_BUFFER_new);
     REGISTER_GLOBAL_MOCK_RETURN(BUFFER_u_char, &TEST_UNSIGNED_CHAR_ARRAY[0]);
     REGISTER_GLOBAL_MOCK_RETURN(BUFFER_length, 1);
 
-    REGISTER_GLOBAL_MOCK_HOOK(Base64_Encoder, my_Base64_Encode);
     REGISTER_GLOBAL_MOCK_HOOK(Base64_Decoder, my_Base64_Decoder);
-    REGISTER_GLOBAL_MOCK_HOOK(URL_Encode, my_URL_Encode);
-    REGISTER_GLOBAL_MOCK_RETURN(HMACSHA256_ComputeHash, HMACSHA256_OK);
+    REGISTER_GLOBAL_MOCK_HOOK(Base64_Encode_Bytes_Into, my_Base64_Encode_Bytes_Into);
+    REGISTER_GLOBAL_MOCK_RETURN(HASH_CreateHmac, TEST_HASH_HANDLE);
+    REGISTER_GLOBAL_MOCK_RETURN(HASH_Update, 0);
+    REGISTER_GLOBAL_MOCK_RETURN(HASH_Final, 0);
     REGISTER_GLOBAL_MOCK_RETURN(size_tToString, 0);
 
     REGISTER_GLOBAL_MOCK_RETURN(get_time, TEST_TIME_T);
@@ -194,10 +209,12 @@ TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
     }
 
     umock_c_reset_all_calls();
+    g_token = NULL;
 }
 
 TEST_FUNCTION_CLEANUP(TestMethodCleanup)
 {
+    my_gballoc_free(g_token);
     TEST_MUTEX_RELEASE(g_testByTest);
 }
 
@@ -607,10 +624,8 @@ TEST_FUNCTION(SASToken_validate_proper_format_1_pass)
 
     STRICT_EXPECTED_CALL(STRING_c_str(handle)).SetReturn(TEST_INVALID_SE);
     STRICT_EXPECTED_CALL(STRING_length(handle)).SetReturn(TEST_INVALID_SE_LENGTH);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).IgnoreAllArguments().SetReturn(TEST_TIME_T);
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)).IgnoreAllArguments();
 
     // act
     result = SASToken_Validate(handle);
@@ -632,10 +647,8 @@ TEST_FUNCTION(SASToken_validate_proper_format_with_skn_1_pass)
 
     STRICT_EXPECTED_CALL(STRING_c_str(handle)).SetReturn(TEST_INVALID_SE);
     STRICT_EXPECTED_CALL(STRING_length(handle)).SetReturn(TEST_INVALID_SE_LENGTH);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).IgnoreAllArguments().SetReturn(TEST_TIME_T);
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)).IgnoreAllArguments();
 
     // act
     result = SASToken_Validate(handle);
@@ -656,10 +669,8 @@ TEST_FUNCTION(SASToken_validate_proper_format_with_skn_expired_se_fail)
 
     STRICT_EXPECTED_CALL(STRING_c_str(handle)).SetReturn(TEST_INVALID_SE);
     STRICT_EXPECTED_CALL(STRING_length(handle)).SetReturn(TEST_INVALID_SE_LENGTH);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).IgnoreAllArguments().SetReturn(TEST_TIME_T);
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)).IgnoreAllArguments();
 
     // act
     result = SASToken_Validate(handle);
@@ -680,10 +691,8 @@ TEST_FUNCTION(SASToken_validate_proper_format_2_pass)
 
     STRICT_EXPECTED_CALL(STRING_c_str(handle)).SetReturn(TEST_INVALID_SE);
     STRICT_EXPECTED_CALL(STRING_length(handle)).SetReturn(TEST_INVALID_SE_LENGTH);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).IgnoreAllArguments().SetReturn(TEST_TIME_T);
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)).IgnoreAllArguments();
 
     // act
     result = SASToken_Validate(handle);
@@ -704,10 +713,8 @@ TEST_FUNCTION(SASToken_validate_proper_format_3_pass)
 
     STRICT_EXPECTED_CALL(STRING_c_str(handle)).SetReturn(TEST_INVALID_SE);
     STRICT_EXPECTED_CALL(STRING_length(handle)).SetReturn(TEST_INVALID_SE_LENGTH);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).IgnoreAllArguments().SetReturn(TEST_TIME_T);
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)).IgnoreAllArguments();
 
     // act
     result = SASToken_Validate(handle);
@@ -728,10 +735,8 @@ TEST_FUNCTION(SASToken_validate_not_expired_pass)
 
     STRICT_EXPECTED_CALL(STRING_c_str(handle)).SetReturn(TEST_INVALID_SE);
     STRICT_EXPECTED_CALL(STRING_length(handle)).SetReturn(TEST_INVALID_SE_LENGTH);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).IgnoreAllArguments().SetReturn(TEST_EARLY_TIME);
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)).IgnoreAllArguments();
 
     // act
     result = SASToken_Validate(handle);
@@ -753,10 +758,8 @@ TEST_FUNCTION(SASToken_validate_expired_fail)
 
     STRICT_EXPECTED_CALL(STRING_c_str(handle)).SetReturn(TEST_INVALID_SE);
     STRICT_EXPECTED_CALL(STRING_length(handle)).SetReturn(TEST_INVALID_SE_LENGTH);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(get_time(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(get_difftime(TEST_TIME_T, IGNORED_NUM_ARG)).IgnoreAllArguments().SetReturn(TEST_LATER_TIME);
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)).IgnoreAllArguments();
 
     // act
     result = SASToken_Validate(handle);
@@ -777,8 +780,6 @@ TEST_FUNCTION(SASToken_validate_invalid_expiry_1_fail)
 
     STRICT_EXPECTED_CALL(STRING_c_str(handle)).SetReturn(TEST_INVALID_SE);
     STRICT_EXPECTED_CALL(STRING_length(handle)).SetReturn(TEST_INVALID_SE_LENGTH);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)).IgnoreAllArguments();
 
     // act
     result = SASToken_Validate(handle);
@@ -799,8 +800,6 @@ TEST_FUNCTION(SASToken_validate_invalid_expiry_2_fail)
 
     STRICT_EXPECTED_CALL(STRING_c_str(handle)).SetReturn(TEST_INVALID_SE);
     STRICT_EXPECTED_CALL(STRING_length(handle)).SetReturn(TEST_INVALID_SE_LENGTH);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)).IgnoreAllArguments();
 
     // act
     result = SASToken_Validate(handle);
@@ -821,8 +820,6 @@ TEST_FUNCTION(SASToken_validate_invalid_expiry_3_fail)
 
     STRICT_EXPECTED_CALL(STRING_c_str(handle)).SetReturn(TEST_INVALID_SE);
     STRICT_EXPECTED_CALL(STRING_length(handle)).SetReturn(TEST_INVALID_SE_LENGTH);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)).IgnoreAllArguments();
 
     // act
     result = SASToken_Validate(handle);
@@ -843,8 +840,6 @@ TEST_FUNCTION(SASToken_validate_invalid_expiry_4_fail)
 
     STRICT_EXPECTED_CALL(STRING_c_str(handle)).SetReturn(TEST_INVALID_SE);
     STRICT_EXPECTED_CALL(STRING_length(handle)).SetReturn(TEST_INVALID_SE_LENGTH);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)).IgnoreAllArguments();
 
     // act
     result = SASToken_Validate(handle);
@@ -865,8 +860,6 @@ TEST_FUNCTION(SASToken_validate_invalid_expiry_5_fail)
 
     STRICT_EXPECTED_CALL(STRING_c_str(handle)).SetReturn(TEST_INVALID_SE);
     STRICT_EXPECTED_CALL(STRING_length(handle)).SetReturn(TEST_INVALID_SE_LENGTH);
-    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)).IgnoreAllArguments();
 
     // act
     result = SASToken_Validate(handle);
@@ -905,6 +898,7 @@ TEST_FUNCTION(SASToken_Create_null_scope_fails)
 }
 
 /*Tests_SRS_SASTOKEN_06_007: [keyName is optional and can be set to NULL.]*/
+/*Tests_SRS_SASTOKEN_06_022: [If keyName is non-NULL, the string "&skn=" is appended to result.]*/
 TEST_FUNCTION(SASToken_Create_null_keyName_succeeds)
 {
     // arrange
@@ -913,68 +907,19 @@ TEST_FUNCTION(SASToken_Create_null_keyName_succeeds)
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
     STRICT_EXPECTED_CALL(STRING_c_str(NULL)).SetReturn(NULL);
-
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n"));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(STRING_length(TEST_TOBEHASHED_HANDLE)).SetReturn(TEST_LENGTH_TOBEHASHED);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
-
-    STRICT_EXPECTED_CALL(HMACSHA256_ComputeHash(IGNORED_PTR_ARG, TEST_LENGTH_DECODEDKEY, IGNORED_PTR_ARG, TEST_LENGTH_TOBEHASHED, TEST_HASH_HANDLE)).IgnoreArgument(1).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(Base64_Encoder(TEST_HASH_HANDLE)).SetReturn(TEST_BASE64SIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(URL_Encode(TEST_BASE64SIGNATURE_HANDLE)).SetReturn(TEST_URLENCODEDSIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_copy(TEST_RESULT_HANDLE, "SharedAccessSignature sr="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&sig="));
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(TEST_RESULT_HANDLE, TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&se="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_BASE64SIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
-
+    setup_signature_expected_calls(TEST_STRING_VALUE);
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof("SharedAccessSignature sr=Test string value&sig=" TEST_URL_ENCODED_DIGEST "&se=7200")));
+    STRICT_EXPECTED_CALL(STRING_new_with_memory(IGNORED_PTR_ARG)).IgnoreArgument(1);
 
     // act
     handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_NULL_STRING_HANDLE, TEST_EXPIRY);
 
     // assert
-    ASSERT_IS_NOT_NULL(handle);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_RESULT_HANDLE, handle);
+    ASSERT_ARE_EQUAL(char_ptr, "SharedAccessSignature sr=Test string value&sig=" TEST_URL_ENCODED_DIGEST "&se=7200", g_token);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
-/*Tests_SRS_SASTOKEN_06_030: [If there is an error in the decoding then SASToken_Create shall return NULL.]*/
-TEST_FUNCTION(SASToken_Create_decoded_key_fails)
-{
-    // arrange
-    STRING_HANDLE handle;
-
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_NULL_BUFFER_HANDLE);
-
-    // act
-    handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_KEYNAME_HANDLE, TEST_EXPIRY);
-
-    // assert
-    ASSERT_IS_NULL(handle);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-}
-
-/*Tests_SRS_SASTOKEN_06_029: [The key parameter is decoded from base64.]*/
 /*Tests_SRS_SASTOKEN_06_026: [If the conversion to string form fails for any reason then SASToken_Create shall return NULL.]*/
 TEST_FUNCTION(SASToken_Create_size_tToString_fails)
 {
@@ -984,37 +929,7 @@ TEST_FUNCTION(SASToken_Create_size_tToString_fails)
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME)).SetReturn(-1);
-
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
-
-    // act
-    handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_KEYNAME_HANDLE, TEST_EXPIRY);
-
-    // assert
-    ASSERT_IS_NULL(handle);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-}
-
-/*Tests_SRS_SASTOKEN_06_024: [The size_t value ((size_t) (difftime(get_time(NULL),0) + 3600)) is converted to a string form.]*/
-TEST_FUNCTION(SASToken_Create_buffer_new_fails)
-{
-    // arrange
-    STRING_HANDLE handle;
-
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(NULL);
-
-    STRICT_EXPECTED_CALL(STRING_delete(NULL));
-    STRICT_EXPECTED_CALL(BUFFER_delete(NULL));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).SetReturn(-1);
 
     // act
     handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_KEYNAME_HANDLE, TEST_EXPIRY);
@@ -1024,33 +939,9 @@ TEST_FUNCTION(SASToken_Create_buffer_new_fails)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
-TEST_FUNCTION(SASToken_Create_first_string_new_fails)
-{
-    // arrange
-    STRING_HANDLE handle;
-
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(NULL);
-
-    STRICT_EXPECTED_CALL(STRING_delete(NULL));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
-
-    // act
-    handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_KEYNAME_HANDLE, TEST_EXPIRY);
-
-    // assert
-    ASSERT_IS_NULL(handle);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-}
-
-TEST_FUNCTION(SASToken_Create_second_string_new_fails)
+/*Tests_SRS_SASTOKEN_06_029: [The key parameter is decoded from base64.]*/
+/*Tests_SRS_SASTOKEN_06_030: [If there is an error in the decoding then SASToken_Create shall return NULL.]*/
+TEST_FUNCTION(SASToken_Create_decoded_key_fails)
 {
     // arrange
     STRING_HANDLE handle;
@@ -1058,16 +949,8 @@ TEST_FUNCTION(SASToken_Create_second_string_new_fails)
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
     STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(NULL);
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_NULL_BUFFER_HANDLE);
 
     // act
     handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_KEYNAME_HANDLE, TEST_EXPIRY);
@@ -1077,7 +960,8 @@ TEST_FUNCTION(SASToken_Create_second_string_new_fails)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
-TEST_FUNCTION(SASToken_Create_build_to_be_hashed_part1_fails)
+/*Tests_SRS_SASTOKEN_06_013: [If an error is returned from the HMAC256 function then NULL is returned from SASToken_Create.]*/
+TEST_FUNCTION(SASToken_Create_HASH_CreateHmac_fails)
 {
     // arrange
     STRING_HANDLE handle;
@@ -1085,18 +969,8 @@ TEST_FUNCTION(SASToken_Create_build_to_be_hashed_part1_fails)
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG)).SetReturn(1);
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_RESULT_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
+    setup_decode_key_expected_calls();
+    STRICT_EXPECTED_CALL(HASH_CreateHmac(HASH_ALGORITHM_SHA256, TEST_UNSIGNED_CHAR_ARRAY, TEST_LENGTH_DECODEDKEY)).SetReturn(NULL);
     STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
 
     // act
@@ -1107,8 +981,8 @@ TEST_FUNCTION(SASToken_Create_build_to_be_hashed_part1_fails)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
-/*Tests_SRS_SASTOKEN_06_009: [The scope is the basis for creating a STRING_HANDLE.]*/
-TEST_FUNCTION(SASToken_Create_build_to_be_hashed_part2_fails)
+/*Tests_SRS_SASTOKEN_06_013: [If an error is returned from the HMAC256 function then NULL is returned from SASToken_Create.]*/
+TEST_FUNCTION(SASToken_Create_HASH_Update_fails)
 {
     // arrange
     STRING_HANDLE handle;
@@ -1116,19 +990,10 @@ TEST_FUNCTION(SASToken_Create_build_to_be_hashed_part2_fails)
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n")).SetReturn(1);
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_RESULT_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
+    setup_decode_key_expected_calls();
+    STRICT_EXPECTED_CALL(HASH_CreateHmac(HASH_ALGORITHM_SHA256, TEST_UNSIGNED_CHAR_ARRAY, TEST_LENGTH_DECODEDKEY));
+    STRICT_EXPECTED_CALL(HASH_Update(TEST_HASH_HANDLE, IGNORED_PTR_ARG, strlen(TEST_STRING_VALUE))).IgnoreArgument(2).SetReturn(1);
+    STRICT_EXPECTED_CALL(HASH_Destroy(TEST_HASH_HANDLE));
     STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
 
     // act
@@ -1139,8 +1004,8 @@ TEST_FUNCTION(SASToken_Create_build_to_be_hashed_part2_fails)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
-/*Tests_SRS_SASTOKEN_06_010: [A "\n" is appended to that string.]*/
-TEST_FUNCTION(SASToken_Create_build_to_be_hashed_part3_fails)
+/*Tests_SRS_SASTOKEN_06_013: [If an error is returned from the HMAC256 function then NULL is returned from SASToken_Create.]*/
+TEST_FUNCTION(SASToken_Create_HASH_Final_fails)
 {
     // arrange
     STRING_HANDLE handle;
@@ -1148,20 +1013,13 @@ TEST_FUNCTION(SASToken_Create_build_to_be_hashed_part3_fails)
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n"));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, TEST_TOKEN_EXPIRATION_TIME)).SetReturn(1);
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_RESULT_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
+    setup_decode_key_expected_calls();
+    STRICT_EXPECTED_CALL(HASH_CreateHmac(HASH_ALGORITHM_SHA256, TEST_UNSIGNED_CHAR_ARRAY, TEST_LENGTH_DECODEDKEY));
+    STRICT_EXPECTED_CALL(HASH_Update(TEST_HASH_HANDLE, IGNORED_PTR_ARG, strlen(TEST_STRING_VALUE))).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(HASH_Update(TEST_HASH_HANDLE, IGNORED_PTR_ARG, 1)).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(HASH_Update(TEST_HASH_HANDLE, IGNORED_PTR_ARG, 4)).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(HASH_Final(TEST_HASH_HANDLE, TEST_DECODEDKEY_HANDLE)).SetReturn(1);
+    STRICT_EXPECTED_CALL(HASH_Destroy(TEST_HASH_HANDLE));
     STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
 
     // act
@@ -1172,9 +1030,8 @@ TEST_FUNCTION(SASToken_Create_build_to_be_hashed_part3_fails)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
-/*Tests_SRS_SASTOKEN_06_011: [tokenExpirationTime is appended to that string.]*/
 /*Tests_SRS_SASTOKEN_06_013: [If an error is returned from the HMAC256 function then NULL is returned from SASToken_Create.]*/
-TEST_FUNCTION(SASToken_Create_HMAC256_fails)
+TEST_FUNCTION(SASToken_Create_with_a_hash_that_is_not_32_bytes_fails)
 {
     // arrange
     STRING_HANDLE handle;
@@ -1182,29 +1039,14 @@ TEST_FUNCTION(SASToken_Create_HMAC256_fails)
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n"));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(STRING_length(TEST_TOBEHASHED_HANDLE)).SetReturn(TEST_LENGTH_TOBEHASHED);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
-
-    STRICT_EXPECTED_CALL(HMACSHA256_ComputeHash(IGNORED_PTR_ARG, TEST_LENGTH_DECODEDKEY, IGNORED_PTR_ARG, TEST_LENGTH_TOBEHASHED, TEST_HASH_HANDLE)).SetReturn(HMACSHA256_ERROR);
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_RESULT_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(NULL));
-    STRICT_EXPECTED_CALL(STRING_delete(NULL));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
+    setup_decode_key_expected_calls();
+    STRICT_EXPECTED_CALL(HASH_CreateHmac(HASH_ALGORITHM_SHA256, TEST_UNSIGNED_CHAR_ARRAY, TEST_LENGTH_DECODEDKEY));
+    STRICT_EXPECTED_CALL(HASH_Update(TEST_HASH_HANDLE, IGNORED_PTR_ARG, strlen(TEST_STRING_VALUE))).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(HASH_Update(TEST_HASH_HANDLE, IGNORED_PTR_ARG, 1)).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(HASH_Update(TEST_HASH_HANDLE, IGNORED_PTR_ARG, 4)).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(HASH_Final(TEST_HASH_HANDLE, TEST_DECODEDKEY_HANDLE));
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(20);
+    STRICT_EXPECTED_CALL(HASH_Destroy(TEST_HASH_HANDLE));
     STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
 
     // act
@@ -1215,10 +1057,8 @@ TEST_FUNCTION(SASToken_Create_HMAC256_fails)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
-
-/*Tests_SRS_SASTOKEN_06_012: [An HMAC256 hash is calculated using the decodedKey, over toBeHashed.]*/
 /*Tests_SRS_SASTOKEN_06_014: [If there are any errors from the following operations then NULL shall be returned.]*/
-TEST_FUNCTION(SASToken_Create_HMAC256_passes_signature_encode_fails)
+TEST_FUNCTION(SASToken_Create_Base64_Encode_Bytes_Into_fails)
 {
     // arrange
     STRING_HANDLE handle;
@@ -1226,30 +1066,16 @@ TEST_FUNCTION(SASToken_Create_HMAC256_passes_signature_encode_fails)
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n"));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(STRING_length(TEST_TOBEHASHED_HANDLE)).SetReturn(TEST_LENGTH_TOBEHASHED);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
-
-    STRICT_EXPECTED_CALL(HMACSHA256_ComputeHash(IGNORED_PTR_ARG, TEST_LENGTH_DECODEDKEY, IGNORED_PTR_ARG, TEST_LENGTH_TOBEHASHED, TEST_HASH_HANDLE)).IgnoreArgument(1).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(Base64_Encoder(TEST_HASH_HANDLE)).SetReturn(NULL);
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_RESULT_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(NULL));
-    STRICT_EXPECTED_CALL(STRING_delete(NULL));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
+    setup_decode_key_expected_calls();
+    STRICT_EXPECTED_CALL(HASH_CreateHmac(HASH_ALGORITHM_SHA256, TEST_UNSIGNED_CHAR_ARRAY, TEST_LENGTH_DECODEDKEY));
+    STRICT_EXPECTED_CALL(HASH_Update(TEST_HASH_HANDLE, IGNORED_PTR_ARG, strlen(TEST_STRING_VALUE))).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(HASH_Update(TEST_HASH_HANDLE, IGNORED_PTR_ARG, 1)).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(HASH_Update(TEST_HASH_HANDLE, IGNORED_PTR_ARG, 4)).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(HASH_Final(TEST_HASH_HANDLE, TEST_DECODEDKEY_HANDLE));
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(sizeof(TEST_DIGEST));
+    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_DIGEST);
+    STRICT_EXPECTED_CALL(Base64_Encode_Bytes_Into(TEST_DIGEST, sizeof(TEST_DIGEST), IGNORED_PTR_ARG, sizeof(TEST_BASE64_DIGEST))).IgnoreArgument(3).SetReturn(1);
+    STRICT_EXPECTED_CALL(HASH_Destroy(TEST_HASH_HANDLE));
     STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
 
     // act
@@ -1261,8 +1087,7 @@ TEST_FUNCTION(SASToken_Create_HMAC256_passes_signature_encode_fails)
 }
 
 /*Tests_SRS_SASTOKEN_06_014: [If there are any errors from the following operations then NULL shall be returned.]*/
-/*Tests_SRS_SASTOKEN_06_015: [The hash is base 64 encoded.]*/
-TEST_FUNCTION(SASToken_Create_building_token_signature_url_encoding_fails)
+TEST_FUNCTION(SASToken_Create_token_allocation_fails)
 {
     // arrange
     STRING_HANDLE handle;
@@ -1270,32 +1095,8 @@ TEST_FUNCTION(SASToken_Create_building_token_signature_url_encoding_fails)
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n"));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(STRING_length(TEST_TOBEHASHED_HANDLE)).SetReturn(TEST_LENGTH_TOBEHASHED);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
-
-    STRICT_EXPECTED_CALL(HMACSHA256_ComputeHash(IGNORED_PTR_ARG, TEST_LENGTH_DECODEDKEY, IGNORED_PTR_ARG, TEST_LENGTH_TOBEHASHED, TEST_HASH_HANDLE)).IgnoreArgument(1).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(Base64_Encoder(TEST_HASH_HANDLE)).SetReturn(TEST_BASE64SIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(URL_Encode(TEST_BASE64SIGNATURE_HANDLE)).SetReturn(NULL);
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_RESULT_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_BASE64SIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(NULL));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+    setup_signature_expected_calls(TEST_STRING_VALUE);
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1).SetReturn(NULL);
 
     // act
     handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_KEYNAME_HANDLE, TEST_EXPIRY);
@@ -1306,8 +1107,7 @@ TEST_FUNCTION(SASToken_Create_building_token_signature_url_encoding_fails)
 }
 
 /*Tests_SRS_SASTOKEN_06_014: [If there are any errors from the following operations then NULL shall be returned.]*/
-/*Tests_SRS_SASTOKEN_06_028: [base64Signature shall be url encoded.]*/
-TEST_FUNCTION(SASToken_Create_building_token_copy_scope_identifier_fails)
+TEST_FUNCTION(SASToken_Create_STRING_new_with_memory_fails)
 {
     // arrange
     STRING_HANDLE handle;
@@ -1315,33 +1115,10 @@ TEST_FUNCTION(SASToken_Create_building_token_copy_scope_identifier_fails)
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n"));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(STRING_length(TEST_TOBEHASHED_HANDLE)).SetReturn(TEST_LENGTH_TOBEHASHED);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
-
-    STRICT_EXPECTED_CALL(HMACSHA256_ComputeHash(IGNORED_PTR_ARG, TEST_LENGTH_DECODEDKEY, IGNORED_PTR_ARG, TEST_LENGTH_TOBEHASHED, TEST_HASH_HANDLE)).IgnoreArgument(1).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(Base64_Encoder(TEST_HASH_HANDLE)).SetReturn(TEST_BASE64SIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(URL_Encode(TEST_BASE64SIGNATURE_HANDLE)).SetReturn(TEST_URLENCODEDSIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_copy(TEST_RESULT_HANDLE, "SharedAccessSignature sr=")).SetReturn(1);
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_RESULT_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_BASE64SIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+    setup_signature_expected_calls(TEST_STRING_VALUE);
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(STRING_new_with_memory(IGNORED_PTR_ARG)).IgnoreArgument(1).SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)).IgnoreArgument(1);
 
     // act
     handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_KEYNAME_HANDLE, TEST_EXPIRY);
@@ -1349,106 +1126,26 @@ TEST_FUNCTION(SASToken_Create_building_token_copy_scope_identifier_fails)
     // assert
     ASSERT_IS_NULL(handle);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-}
 
-/*Tests_SRS_SASTOKEN_06_016: [The string "SharedAccessSignature sr=" is the first part of the result of SASToken_Create.]*/
-/*Tests_SRS_SASTOKEN_06_014: [If there are any errors from the following operations then NULL shall be returned.]*/
-TEST_FUNCTION(SASToken_Create_building_token_concat_scope_fails)
-{
-    // arrange
-    STRING_HANDLE handle;
-
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n"));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(STRING_length(TEST_TOBEHASHED_HANDLE)).SetReturn(TEST_LENGTH_TOBEHASHED);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
-
-    STRICT_EXPECTED_CALL(HMACSHA256_ComputeHash(IGNORED_PTR_ARG, TEST_LENGTH_DECODEDKEY, IGNORED_PTR_ARG, TEST_LENGTH_TOBEHASHED, TEST_HASH_HANDLE)).IgnoreArgument(1).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(Base64_Encoder(TEST_HASH_HANDLE)).SetReturn(TEST_BASE64SIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(URL_Encode(TEST_BASE64SIGNATURE_HANDLE)).SetReturn(TEST_URLENCODEDSIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_copy(TEST_RESULT_HANDLE, "SharedAccessSignature sr="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, IGNORED_PTR_ARG)).SetReturn(1);
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_RESULT_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_BASE64SIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
-
-    // act
-    handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_KEYNAME_HANDLE, TEST_EXPIRY);
-
-    // assert
-    ASSERT_IS_NULL(handle);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    // cleanup
+    g_token = NULL;
 }
 
-/*Tests_SRS_SASTOKEN_06_014: [If there are any errors from the following operations then NULL shall be returned.]*/
+/*Tests_SRS_SASTOKEN_06_009: [The scope is the basis for creating a STRING_HANDLE.]*/
+/*Tests_SRS_SASTOKEN_06_010: [A "\n" is appended to that string.]*/
+/*Tests_SRS_SASTOKEN_06_011: [tokenExpirationTime is appended to that string.]*/
+/*Tests_SRS_SASTOKEN_06_012: [An HMAC256 hash is calculated using the decodedKey, over toBeHashed.]*/
+/*Tests_SRS_SASTOKEN_06_015: [The hash is base 64 encoded.]*/
+/*Tests_SRS_SASTOKEN_06_028: [base64Signature shall be url encoded.]*/
+/*Tests_SRS_SASTOKEN_06_016: [The string "SharedAccessSignature sr=" is the first part of the result of SASToken_Create.]*/
 /*Tests_SRS_SASTOKEN_06_017: [The scope parameter is appended to result.]*/
-TEST_FUNCTION(SASToken_Create_building_token_concat_signature_identifier_fails)
-{
-    // arrange
-    STRING_HANDLE handle;
-
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n"));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(STRING_length(TEST_TOBEHASHED_HANDLE)).SetReturn(TEST_LENGTH_TOBEHASHED);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
-
-    STRICT_EXPECTED_CALL(HMACSHA256_ComputeHash(IGNORED_PTR_ARG, TEST_LENGTH_DECODEDKEY, IGNORED_PTR_ARG, TEST_LENGTH_TOBEHASHED, TEST_HASH_HANDLE)).IgnoreArgument(1).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(Base64_Encoder(TEST_HASH_HANDLE)).SetReturn(TEST_BASE64SIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(URL_Encode(TEST_BASE64SIGNATURE_HANDLE)).SetReturn(TEST_URLENCODEDSIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_copy(TEST_RESULT_HANDLE, "SharedAccessSignature sr="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&sig=")).SetReturn(1);
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_RESULT_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_BASE64SIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
-
-    // act
-    handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_KEYNAME_HANDLE, TEST_EXPIRY);
-
-    // assert
-    ASSERT_IS_NULL(handle);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-}
-
-/*Tests_SRS_SASTOKEN_06_014: [If there are any errors from the following operations then NULL shall be returned.]*/
 /*Tests_SRS_SASTOKEN_06_018: [The string "&sig=" is appended to result.]*/
-TEST_FUNCTION(SASToken_Create_building_token_concat_signature_fails)
+/*Tests_SRS_SASTOKEN_06_019: [The string urlEncodedSignature shall be appended to result.]*/
+/*Tests_SRS_SASTOKEN_06_020: [The string "&se=" shall be appended to result.]*/
+/*Tests_SRS_SASTOKEN_06_021: [tokenExpirationTime is appended to result.]*/
+/*Tests_SRS_SASTOKEN_06_023: [If keyName is non-NULL, the argument keyName is appended to result.]*/
+/*Tests_SRS_SASTOKEN_01_002: [The token shall be written into a single allocation of its exact length, which becomes the returned STRING_HANDLE.]*/
+TEST_FUNCTION(SASToken_Create_succeeds)
 {
     // arrange
     STRING_HANDLE handle;
@@ -1456,347 +1153,136 @@ TEST_FUNCTION(SASToken_Create_building_token_concat_signature_fails)
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n"));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(STRING_length(TEST_TOBEHASHED_HANDLE)).SetReturn(TEST_LENGTH_TOBEHASHED);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
-
-    STRICT_EXPECTED_CALL(HMACSHA256_ComputeHash(IGNORED_PTR_ARG, TEST_LENGTH_DECODEDKEY, IGNORED_PTR_ARG, TEST_LENGTH_TOBEHASHED, TEST_HASH_HANDLE)).IgnoreArgument(1).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(Base64_Encoder(TEST_HASH_HANDLE)).SetReturn(TEST_BASE64SIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(URL_Encode(TEST_BASE64SIGNATURE_HANDLE)).SetReturn(TEST_URLENCODEDSIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_copy(TEST_RESULT_HANDLE, "SharedAccessSignature sr="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&sig="));
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(TEST_RESULT_HANDLE, TEST_URLENCODEDSIGNATURE_HANDLE)).SetReturn(1);
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_RESULT_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_BASE64SIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+    setup_signature_expected_calls(TEST_STRING_VALUE);
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof("SharedAccessSignature sr=Test string value&sig=" TEST_URL_ENCODED_DIGEST "&se=7200&skn=Test string value")));
+    STRICT_EXPECTED_CALL(STRING_new_with_memory(IGNORED_PTR_ARG)).IgnoreArgument(1);
 
     // act
     handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_KEYNAME_HANDLE, TEST_EXPIRY);
 
     // assert
-    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_RESULT_HANDLE, handle);
+    ASSERT_ARE_EQUAL(char_ptr, "SharedAccessSignature sr=Test string value&sig=" TEST_URL_ENCODED_DIGEST "&se=7200&skn=Test string value", g_token);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
-/*Tests_SRS_SASTOKEN_06_014: [If there are any errors from the following operations then NULL shall be returned.]*/
-/*Tests_SRS_SASTOKEN_06_019: [The string urlEncodedSignature shall be appended to result.]*/
-TEST_FUNCTION(SASToken_Create_building_token_concat_token_expiration_time_identifier_fails)
+TEST_FUNCTION(SASToken_CreateString_succeeds)
 {
     // arrange
     STRING_HANDLE handle;
 
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n"));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(STRING_length(TEST_TOBEHASHED_HANDLE)).SetReturn(TEST_LENGTH_TOBEHASHED);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
-
-    STRICT_EXPECTED_CALL(HMACSHA256_ComputeHash(IGNORED_PTR_ARG, TEST_LENGTH_DECODEDKEY, IGNORED_PTR_ARG, TEST_LENGTH_TOBEHASHED, TEST_HASH_HANDLE)).IgnoreArgument(1).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(Base64_Encoder(TEST_HASH_HANDLE)).SetReturn(TEST_BASE64SIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(URL_Encode(TEST_BASE64SIGNATURE_HANDLE)).SetReturn(TEST_URLENCODEDSIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_copy(TEST_RESULT_HANDLE, "SharedAccessSignature sr="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&sig="));
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(TEST_RESULT_HANDLE, TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&se=")).SetReturn(1);
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_RESULT_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_BASE64SIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+    setup_signature_expected_calls(TEST_STRING_VALUE);
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof("SharedAccessSignature sr=Test string value&sig=" TEST_URL_ENCODED_DIGEST "&se=7200&skn=Test string value")));
+    STRICT_EXPECTED_CALL(STRING_new_with_memory(IGNORED_PTR_ARG)).IgnoreArgument(1);
 
     // act
-    handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_KEYNAME_HANDLE, TEST_EXPIRY);
+    handle = SASToken_CreateString(TEST_CHAR_ARRAY, TEST_STRING_VALUE, TEST_STRING_VALUE, TEST_EXPIRY);
 
     // assert
-    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_RESULT_HANDLE, handle);
+    ASSERT_ARE_EQUAL(char_ptr, "SharedAccessSignature sr=Test string value&sig=" TEST_URL_ENCODED_DIGEST "&se=7200&skn=Test string value", g_token);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
-/*Tests_SRS_SASTOKEN_06_014: [If there are any errors from the following operations then NULL shall be returned.]*/
-/*Tests_SRS_SASTOKEN_06_020: [The string "&se=" shall be appended to result.]*/
-TEST_FUNCTION(SASToken_Create_building_token_concat_token_expiration_time_fails)
+/* SASToken_CreateString_Into */
+
+/*Tests_SRS_SASTOKEN_01_003: [If key, scope, destination or tokenLength is NULL, or destinationSize is 0, SASToken_CreateString_Into shall fail and return a non-zero value.]*/
+TEST_FUNCTION(SASToken_CreateString_Into_with_invalid_arguments_fails)
 {
     // arrange
-    STRING_HANDLE handle;
-
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n"));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(STRING_length(TEST_TOBEHASHED_HANDLE)).SetReturn(TEST_LENGTH_TOBEHASHED);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
-
-    STRICT_EXPECTED_CALL(HMACSHA256_ComputeHash(IGNORED_PTR_ARG, TEST_LENGTH_DECODEDKEY, IGNORED_PTR_ARG, TEST_LENGTH_TOBEHASHED, TEST_HASH_HANDLE)).IgnoreArgument(1).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(Base64_Encoder(TEST_HASH_HANDLE)).SetReturn(TEST_BASE64SIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(URL_Encode(TEST_BASE64SIGNATURE_HANDLE)).SetReturn(TEST_URLENCODEDSIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_copy(TEST_RESULT_HANDLE, "SharedAccessSignature sr="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&sig="));
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(TEST_RESULT_HANDLE, TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&se="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, TEST_TOKEN_EXPIRATION_TIME)).SetReturn(1);
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_RESULT_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_BASE64SIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+    char token[256];
+    size_t tokenLength;
+    int result[5];
 
     // act
-    handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_KEYNAME_HANDLE, TEST_EXPIRY);
+    result[0] = SASToken_CreateString_Into(NULL, TEST_STRING_VALUE, NULL, TEST_EXPIRY, token, sizeof(token), &tokenLength);
+    result[1] = SASToken_CreateString_Into(TEST_CHAR_ARRAY, NULL, NULL, TEST_EXPIRY, token, sizeof(token), &tokenLength);
+    result[2] = SASToken_CreateString_Into(TEST_CHAR_ARRAY, TEST_STRING_VALUE, NULL, TEST_EXPIRY, NULL, sizeof(token), &tokenLength);
+    result[3] = SASToken_CreateString_Into(TEST_CHAR_ARRAY, TEST_STRING_VALUE, NULL, TEST_EXPIRY, token, 0, &tokenLength);
+    result[4] = SASToken_CreateString_Into(TEST_CHAR_ARRAY, TEST_STRING_VALUE, NULL, TEST_EXPIRY, token, sizeof(token), NULL);
 
     // assert
-    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result[0]);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result[1]);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result[2]);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result[3]);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result[4]);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
-/*Tests_SRS_SASTOKEN_06_014: [If there are any errors from the following operations then NULL shall be returned.]*/
-/*Tests_SRS_SASTOKEN_06_021: [tokenExpirationTime is appended to result.]*/
-TEST_FUNCTION(SASToken_Create_building_token_concat_keyname_identifier_fails)
+/*Tests_SRS_SASTOKEN_01_004: [SASToken_CreateString_Into shall write the same token as SASToken_CreateString into destination, null terminate it, store its length in tokenLength and return 0, without allocating memory for the token.]*/
+TEST_FUNCTION(SASToken_CreateString_Into_writes_the_token_into_the_destination)
 {
     // arrange
-    STRING_HANDLE handle;
-
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n"));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(STRING_length(TEST_TOBEHASHED_HANDLE)).SetReturn(TEST_LENGTH_TOBEHASHED);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
+    char token[sizeof("SharedAccessSignature sr=Test string value&sig=" TEST_URL_ENCODED_DIGEST "&se=7200&skn=Test string value")];
+    size_t tokenLength;
+    int result;
 
-    STRICT_EXPECTED_CALL(HMACSHA256_ComputeHash(IGNORED_PTR_ARG, TEST_LENGTH_DECODEDKEY, IGNORED_PTR_ARG, TEST_LENGTH_TOBEHASHED, TEST_HASH_HANDLE)).IgnoreArgument(1).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(Base64_Encoder(TEST_HASH_HANDLE)).SetReturn(TEST_BASE64SIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(URL_Encode(TEST_BASE64SIGNATURE_HANDLE)).SetReturn(TEST_URLENCODEDSIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_copy(TEST_RESULT_HANDLE, "SharedAccessSignature sr="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&sig="));
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(TEST_RESULT_HANDLE, TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&se="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&skn=")).SetReturn(1);
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_RESULT_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_BASE64SIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+    setup_signature_expected_calls(TEST_STRING_VALUE);
 
     // act
-    handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_KEYNAME_HANDLE, TEST_EXPIRY);
+    result = SASToken_CreateString_Into(TEST_CHAR_ARRAY, TEST_STRING_VALUE, TEST_STRING_VALUE, TEST_EXPIRY, token, sizeof(token), &tokenLength);
 
     // assert
-    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "SharedAccessSignature sr=Test string value&sig=" TEST_URL_ENCODED_DIGEST "&se=7200&skn=Test string value", token);
+    ASSERT_ARE_EQUAL(size_t, sizeof(token) - 1, tokenLength);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
-/*Tests_SRS_SASTOKEN_06_014: [If there are any errors from the following operations then NULL shall be returned.]*/
-/*Tests_SRS_SASTOKEN_06_022: [If keyName is non-NULL, the string "&skn=" is appended to result.]*/
-TEST_FUNCTION(SASToken_Create_building_token_concat_keyname_fails)
+/*Tests_SRS_SASTOKEN_01_006: [If destinationSize is too small for the token and its null terminator, SASToken_CreateString_Into shall fail and return a non-zero value.]*/
+TEST_FUNCTION(SASToken_CreateString_Into_with_a_destination_one_byte_too_small_fails)
 {
     // arrange
-    STRING_HANDLE handle;
-
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n"));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(STRING_length(TEST_TOBEHASHED_HANDLE)).SetReturn(TEST_LENGTH_TOBEHASHED);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
+    char token[sizeof("SharedAccessSignature sr=Test string value&sig=" TEST_URL_ENCODED_DIGEST "&se=7200&skn=Test string value") - 1];
+    size_t tokenLength;
+    int result;
 
-    STRICT_EXPECTED_CALL(HMACSHA256_ComputeHash(IGNORED_PTR_ARG, TEST_LENGTH_DECODEDKEY, IGNORED_PTR_ARG, TEST_LENGTH_TOBEHASHED, TEST_HASH_HANDLE)).IgnoreArgument(1).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(Base64_Encoder(TEST_HASH_HANDLE)).SetReturn(TEST_BASE64SIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(URL_Encode(TEST_BASE64SIGNATURE_HANDLE)).SetReturn(TEST_URLENCODEDSIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_copy(TEST_RESULT_HANDLE, "SharedAccessSignature sr="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&sig="));
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(TEST_RESULT_HANDLE, TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&se="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&skn="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, IGNORED_PTR_ARG)).SetReturn(1);
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_RESULT_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_BASE64SIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+    setup_signature_expected_calls(TEST_STRING_VALUE);
 
     // act
-    handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_KEYNAME_HANDLE, TEST_EXPIRY);
+    result = SASToken_CreateString_Into(TEST_CHAR_ARRAY, TEST_STRING_VALUE, TEST_STRING_VALUE, TEST_EXPIRY, token, sizeof(token), &tokenLength);
 
     // assert
-    ASSERT_IS_NULL(handle);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
-/*Tests_SRS_SASTOKEN_06_023: [The argument keyName is appended to result.]*/
-TEST_FUNCTION(SASToken_Create_succeeds)
+/*Tests_SRS_SASTOKEN_01_005: [If any error occurs, SASToken_CreateString_Into shall fail and return a non-zero value.]*/
+TEST_FUNCTION(when_signing_fails_SASToken_CreateString_Into_fails)
 {
     // arrange
-    STRING_HANDLE handle;
-
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEY_HANDLE)).SetReturn(&TEST_CHAR_ARRAY[0]);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_SCOPE_HANDLE)).SetReturn(TEST_STRING_VALUE);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_KEYNAME_HANDLE)).SetReturn(TEST_STRING_VALUE);
-
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n"));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(STRING_length(TEST_TOBEHASHED_HANDLE)).SetReturn(TEST_LENGTH_TOBEHASHED);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
+    char token[256];
+    size_t tokenLength;
+    int result;
 
-    STRICT_EXPECTED_CALL(HMACSHA256_ComputeHash(IGNORED_PTR_ARG, TEST_LENGTH_DECODEDKEY, IGNORED_PTR_ARG, TEST_LENGTH_TOBEHASHED, TEST_HASH_HANDLE)).IgnoreArgument(1).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(Base64_Encoder(TEST_HASH_HANDLE)).SetReturn(TEST_BASE64SIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(URL_Encode(TEST_BASE64SIGNATURE_HANDLE)).SetReturn(TEST_URLENCODEDSIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_copy(TEST_RESULT_HANDLE, "SharedAccessSignature sr="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&sig="));
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(TEST_RESULT_HANDLE, TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&se="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&skn="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, IGNORED_PTR_ARG));
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_BASE64SIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
+    setup_decode_key_expected_calls();
+    STRICT_EXPECTED_CALL(HASH_CreateHmac(HASH_ALGORITHM_SHA256, TEST_UNSIGNED_CHAR_ARRAY, TEST_LENGTH_DECODEDKEY)).SetReturn(NULL);
     STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
 
     // act
-    handle = SASToken_Create(TEST_KEY_HANDLE, TEST_SCOPE_HANDLE, TEST_KEYNAME_HANDLE, TEST_EXPIRY);
+    result = SASToken_CreateString_Into(TEST_CHAR_ARRAY, TEST_STRING_VALUE, NULL, TEST_EXPIRY, token, sizeof(token), &tokenLength);
 
     // assert
-    ASSERT_IS_NOT_NULL(handle);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
-TEST_FUNCTION(SASToken_CreateString_succeeds)
+/*Tests_SRS_SASTOKEN_01_005: [If any error occurs, SASToken_CreateString_Into shall fail and return a non-zero value.]*/
+TEST_FUNCTION(when_size_tToString_fails_SASToken_CreateString_Into_fails)
 {
     // arrange
-    STRING_HANDLE handle;
-
-    STRICT_EXPECTED_CALL(Base64_Decoder(&TEST_CHAR_ARRAY[0])).SetReturn(TEST_DECODEDKEY_HANDLE);
-    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).CopyOutArgumentBuffer(1, TEST_TOKEN_EXPIRATION_TIME, sizeof(TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(BUFFER_new()).SetReturn(TEST_HASH_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_TOBEHASHED_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_new()).SetReturn(TEST_RESULT_HANDLE);
-
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, "\n"));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_TOBEHASHED_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-
-    STRICT_EXPECTED_CALL(STRING_length(TEST_TOBEHASHED_HANDLE)).SetReturn(TEST_LENGTH_TOBEHASHED);
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(TEST_LENGTH_DECODEDKEY);
-    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE));
+    char token[256];
+    size_t tokenLength;
+    int result;
 
-    STRICT_EXPECTED_CALL(HMACSHA256_ComputeHash(IGNORED_PTR_ARG, TEST_LENGTH_DECODEDKEY, IGNORED_PTR_ARG, TEST_LENGTH_TOBEHASHED, TEST_HASH_HANDLE)).IgnoreArgument(1).IgnoreArgument(3);
-    STRICT_EXPECTED_CALL(Base64_Encoder(TEST_HASH_HANDLE)).SetReturn(TEST_BASE64SIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(URL_Encode(TEST_BASE64SIGNATURE_HANDLE)).SetReturn(TEST_URLENCODEDSIGNATURE_HANDLE);
-    STRICT_EXPECTED_CALL(STRING_copy(TEST_RESULT_HANDLE, "SharedAccessSignature sr="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&sig="));
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(TEST_RESULT_HANDLE, TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&se="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, TEST_TOKEN_EXPIRATION_TIME));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, "&skn="));
-    STRICT_EXPECTED_CALL(STRING_concat(TEST_RESULT_HANDLE, IGNORED_PTR_ARG));
-
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_BASE64SIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_URLENCODEDSIGNATURE_HANDLE));
-    STRICT_EXPECTED_CALL(STRING_delete(TEST_TOBEHASHED_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_HASH_HANDLE));
-    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, sizeof(TEST_TOKEN_EXPIRATION_TIME), TEST_EXPIRY)).IgnoreArgument(1).SetReturn(-1);
 
     // act
-    handle = SASToken_CreateString(TEST_CHAR_ARRAY, TEST_STRING_VALUE, TEST_STRING_VALUE, TEST_EXPIRY);
+    result = SASToken_CreateString_Into(TEST_CHAR_ARRAY, TEST_STRING_VALUE, NULL, TEST_EXPIRY, token, sizeof(token), &tokenLength);
 
     // assert
-    ASSERT_IS_NOT_NULL(handle);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
@@ -2,12 +2,32 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #ifdef __cplusplus
+#include <cstdlib>
 #include <cstdint>
+#include <climits>
 #else
+#include <stdlib.h>
 #include <stdint.h>
+#include <limits.h>
 #endif
 
+#include <errno.h>
+#include <poll.h>
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
 #include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
 
 #define ENABLE_MOCKS
 
@@ -15,18 +35,290 @@
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/optionhandler.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+    MOCKABLE_FUNCTION(, int, poll, struct pollfd*, fds, nfds_t, nfds, int, timeout);
+    MOCKABLE_FUNCTION(, int, close, int, fd);
+#ifdef __cplusplus
+}
+#endif
+
 #undef ENABLE_MOCKS
 
 #include "azure_c_shared_utility/socketio.h"
+#include "azure_c_shared_utility/shared_util_options.h"
 
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netdb.h>
 
-TEST_MUTEX_HANDLE test_serialize_mutex;
+#define TEST_ACCEPTED_SOCKET        42
+#define TEST_IO_WAIT_MS             100
+
+static SINGLYLINKEDLIST_HANDLE TEST_SINGLYLINKEDLIST_HANDLE = (SINGLYLINKEDLIST_HANDLE)0x4242;
+static LIST_ITEM_HANDLE TEST_LIST_ITEM_HANDLE = (LIST_ITEM_HANDLE)0x4243;
+
+static short poll_events;
+static int poll_fd;
+static int poll_errno;
+
+static int my_poll(struct pollfd* fds, nfds_t nfds, int timeout)
+{
+    int result;
+
+    (void)nfds;
+    (void)timeout;
+    poll_fd = fds->fd;
+    poll_events = fds->events;
+    if (poll_errno != 0)
+    {
+        errno = poll_errno;
+        result = -1;
+    }
+    else
+    {
+        fds->revents = POLLIN;
+        result = 1;
+    }
+
+    return result;
+}
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+static CONCRETE_IO_HANDLE create_accepted_socket_io(void)
+{
+    int accepted_socket = TEST_ACCEPTED_SOCKET;
+    SOCKETIO_CONFIG socket_config = { NULL, 0, &accepted_socket };
+    CONCRETE_IO_HANDLE result = socketio_create(&socket_config);
+    ASSERT_IS_NOT_NULL(result);
+    umock_c_reset_all_calls();
+    return result;
+}
 
 BEGIN_TEST_SUITE(socketio_berkeley_unittests)
 
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_UMOCK_ALIAS_TYPE(SINGLYLINKEDLIST_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LIST_ITEM_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(nfds_t, unsigned long);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_RETURN(singlylinkedlist_create, TEST_SINGLYLINKEDLIST_HANDLE);
+    REGISTER_GLOBAL_MOCK_HOOK(poll, my_poll);
+    REGISTER_GLOBAL_MOCK_RETURN(close, 0);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    umock_c_reset_all_calls();
+    REGISTER_GLOBAL_MOCK_RETURN(singlylinkedlist_get_head_item, NULL);
+    poll_events = 0;
+    poll_fd = -1;
+    poll_errno = 0;
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+// socketio_setoption OPTION_IO_WAIT_MS tests
+
+TEST_FUNCTION(socketio_setoption_io_wait_ms_polls_the_socket_for_input)
+{
+    // arrange
+    unsigned int wait_ms = TEST_IO_WAIT_MS;
+    int result;
+    CONCRETE_IO_HANDLE socket_io = create_accepted_socket_io();
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SINGLYLINKEDLIST_HANDLE));
+    STRICT_EXPECTED_CALL(poll(IGNORED_PTR_ARG, 1, TEST_IO_WAIT_MS))
+        .IgnoreArgument_fds();
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_IO_WAIT_MS, &wait_ms);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, TEST_ACCEPTED_SOCKET, poll_fd);
+    ASSERT_ARE_EQUAL(int, POLLIN, poll_events);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_io_wait_ms_with_pending_sends_polls_the_socket_for_output)
+{
+    // arrange
+    unsigned int wait_ms = TEST_IO_WAIT_MS;
+    int result;
+    CONCRETE_IO_HANDLE socket_io = create_accepted_socket_io();
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SINGLYLINKEDLIST_HANDLE))
+        .SetReturn(TEST_LIST_ITEM_HANDLE);
+    STRICT_EXPECTED_CALL(poll(IGNORED_PTR_ARG, 1, TEST_IO_WAIT_MS))
+        .IgnoreArgument_fds();
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_IO_WAIT_MS, &wait_ms);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, POLLIN | POLLOUT, poll_events);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_io_wait_ms_clamps_the_timeout_to_int_max)
+{
+    // arrange
+    unsigned int wait_ms = UINT_MAX;
+    int result;
+    CONCRETE_IO_HANDLE socket_io = create_accepted_socket_io();
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SINGLYLINKEDLIST_HANDLE));
+    STRICT_EXPECTED_CALL(poll(IGNORED_PTR_ARG, 1, INT_MAX))
+        .IgnoreArgument_fds();
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_IO_WAIT_MS, &wait_ms);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_io_wait_ms_interrupted_poll_succeeds)
+{
+    // arrange
+    unsigned int wait_ms = TEST_IO_WAIT_MS;
+    int result;
+    CONCRETE_IO_HANDLE socket_io = create_accepted_socket_io();
+    poll_errno = EINTR;
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SINGLYLINKEDLIST_HANDLE));
+    STRICT_EXPECTED_CALL(poll(IGNORED_PTR_ARG, 1, TEST_IO_WAIT_MS))
+        .IgnoreArgument_fds();
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_IO_WAIT_MS, &wait_ms);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_io_wait_ms_fails_when_poll_fails)
+{
+    // arrange
+    unsigned int wait_ms = TEST_IO_WAIT_MS;
+    int result;
+    CONCRETE_IO_HANDLE socket_io = create_accepted_socket_io();
+    poll_errno = EBADF;
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SINGLYLINKEDLIST_HANDLE));
+    STRICT_EXPECTED_CALL(poll(IGNORED_PTR_ARG, 1, TEST_IO_WAIT_MS))
+        .IgnoreArgument_fds();
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_IO_WAIT_MS, &wait_ms);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+/* A failed wait is what makes the callers fall back to polling with a sleep. */
+TEST_FUNCTION(socketio_setoption_io_wait_ms_on_a_closed_socket_fails_without_polling)
+{
+    // arrange
+    unsigned int wait_ms = TEST_IO_WAIT_MS;
+    int result;
+    SOCKETIO_CONFIG socket_config = { "test.azure-devices.net", 443, NULL };
+    CONCRETE_IO_HANDLE socket_io = socketio_create(&socket_config);
+    ASSERT_IS_NOT_NULL(socket_io);
+    umock_c_reset_all_calls();
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_IO_WAIT_MS, &wait_ms);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_setoption_io_wait_ms_with_NULL_value_fails)
+{
+    // arrange
+    int result;
+    CONCRETE_IO_HANDLE socket_io = create_accepted_socket_io();
+
+    // act
+    result = socketio_setoption(socket_io, OPTION_IO_WAIT_MS, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
 #if 0
 
 // SOCKETIO_SETOPTION TESTS WERE WORKING BEFORE SWITCH TO umock_c...need to finish the conversion
@@ -0,0 +1,588 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#include "testrunnerswitcher.h"
+
+static size_t currentmalloc_call;
+static size_t whenShallmalloc_fail;
+
+void* my_gballoc_malloc(size_t size)
+{
+    void* result;
+    currentmalloc_call++;
+    if (whenShallmalloc_fail > 0)
+    {
+        if (currentmalloc_call == whenShallmalloc_fail)
+        {
+            result = NULL;
+        }
+        else
+        {
+            result = malloc(size);
+        }
+    }
+    else
+    {
+        result = malloc(size);
+    }
+    return result;
+}
+
+void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "azure_c_shared_utility/string_token.h"
+
+#define ENABLE_MOCKS
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "azure_c_shared_utility/gballoc.h"
+
+static TEST_MUTEX_HANDLE g_dllByDll;
+static TEST_MUTEX_HANDLE g_testByTest;
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static void assert_tokens(char** tokens, size_t token_count, const char* const* expected, size_t expected_count)
+{
+    size_t i;
+
+    ASSERT_ARE_EQUAL(size_t, expected_count, token_count);
+
+    for (i = 0; i < expected_count; i++)
+    {
+        if (expected[i] == NULL)
+        {
+            ASSERT_IS_NULL(tokens[i]);
+        }
+        else
+        {
+            ASSERT_ARE_EQUAL(char_ptr, expected[i], tokens[i]);
+        }
+    }
+}
+
+/* splits source with both StringToken_Split and StringToken_SplitPacked and checks that both produce the expected tokens */
+static void assert_split(const char* source, const char** delimiters, size_t n_delims, bool include_empty, const char* const* expected, size_t expected_count)
+{
+    char** tokens;
+    size_t token_count;
+    size_t i;
+
+    ASSERT_ARE_EQUAL(int, 0, StringToken_Split(source, strlen(source), delimiters, n_delims, include_empty, &tokens, &token_count));
+    assert_tokens(tokens, token_count, expected, expected_count);
+    for (i = 0; i < token_count; i++)
+    {
+        free(tokens[i]);
+    }
+    free(tokens);
+
+    ASSERT_ARE_EQUAL(int, 0, StringToken_SplitPacked(source, strlen(source), delimiters, n_delims, include_empty, &tokens, &token_count));
+    assert_tokens(tokens, token_count, expected, expected_count);
+    free(tokens);
+}
+
+BEGIN_TEST_SUITE(string_token_unittests)
+
+    TEST_SUITE_INITIALIZE(setsBufferTempSize)
+    {
+        int result;
+
+        TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+        g_testByTest = TEST_MUTEX_CREATE();
+        ASSERT_IS_NOT_NULL(g_testByTest);
+
+        umock_c_init(on_umock_c_error);
+
+        result = umocktypes_charptr_register_types();
+        ASSERT_ARE_EQUAL(int, 0, result);
+
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+        REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    }
+
+    TEST_SUITE_CLEANUP(TestClassCleanup)
+    {
+        umock_c_deinit();
+
+        TEST_MUTEX_DESTROY(g_testByTest);
+        TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    }
+
+    TEST_FUNCTION_INITIALIZE(a)
+    {
+        if (TEST_MUTEX_ACQUIRE(g_testByTest))
+        {
+            ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+        }
+
+        umock_c_reset_all_calls();
+
+        currentmalloc_call = 0;
+        whenShallmalloc_fail = 0;
+    }
+
+    TEST_FUNCTION_CLEANUP(cleans)
+    {
+        TEST_MUTEX_RELEASE(g_testByTest);
+    }
+
+    /* StringToken_GetFirst */
+
+    /* Tests_SRS_STRING_TOKENIZER_09_001: [ If source or delimiters are NULL, or n_delims is zero, the function shall return NULL ] */
+    TEST_FUNCTION(StringToken_GetFirst_with_invalid_arguments_fails)
+    {
+        ///arrange
+        const char* delimiters[] = { "," };
+
+        ///act
+        STRING_TOKEN_HANDLE t1 = StringToken_GetFirst(NULL, 3, delimiters, 1);
+        STRING_TOKEN_HANDLE t2 = StringToken_GetFirst("a,b", 3, NULL, 1);
+        STRING_TOKEN_HANDLE t3 = StringToken_GetFirst("a,b", 3, delimiters, 0);
+
+        ///assert
+        ASSERT_IS_NULL(t1);
+        ASSERT_IS_NULL(t2);
+        ASSERT_IS_NULL(t3);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_002: [ If any of the strings in delimiters are NULL, the function shall return NULL ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_007: [ If any failure occurs, all memory allocated by this function shall be released ] */
+    TEST_FUNCTION(StringToken_GetFirst_with_a_NULL_delimiter_fails)
+    {
+        ///arrange
+        const char* delimiters[] = { ",", NULL };
+
+        ///act
+        STRING_TOKEN_HANDLE t = StringToken_GetFirst("a,b", 3, delimiters, 2);
+
+        ///assert
+        ASSERT_IS_NULL(t);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_004: [ If the STRING_TOKEN structure fails to be allocated, the function shall return NULL ] */
+    TEST_FUNCTION(when_malloc_fails_StringToken_GetFirst_fails)
+    {
+        ///arrange
+        const char* delimiters[] = { "," };
+        whenShallmalloc_fail = 1;
+
+        ///act
+        STRING_TOKEN_HANDLE t = StringToken_GetFirst("a,b", 3, delimiters, 1);
+
+        ///assert
+        ASSERT_IS_NULL(t);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_003: [ A STRING_TOKEN structure shall be allocated to hold the token parameters ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_005: [ The source string shall be split in a token starting from the beginning of source up to occurrence of any one of the demiliters, whichever occurs first in the order provided ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_010: [ The next token shall be selected starting from the position in source right after the previous delimiter up to occurrence of any one of demiliters, whichever occurs first in the order provided ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_011: [ If the source string, starting right after the position of the last delimiter found, does not have any of the demiliters, the resulting token shall be the entire remaining of the source string ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_012: [ If a token was identified, the function shall return true ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_014: [ The function shall return the pointer to the position in source where the current token starts. ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_016: [ The function shall return the length of the current token ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_018: [ The function shall return a pointer to the delimiter that defined the current token, as passed to the previous call to StringToken_GetNext() or StringToken_GetFirst() ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_019: [ If the current token extends to the end of source, the function shall return NULL ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_009: [ If the previous token already extended to the end of source, the function shall return false ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_021: [ Otherwise the memory allocated for STRING_TOKEN shall be released ] */
+    TEST_FUNCTION(StringToken_GetFirst_and_GetNext_walk_all_tokens)
+    {
+        ///arrange
+        const char* source = "a::bc:d";
+        const char* delimiters[] = { "::", ":" };
+        STRING_TOKEN_HANDLE t;
+        bool next[3];
+
+        ///act
+        t = StringToken_GetFirst(source, strlen(source), delimiters, 2);
+
+        ///assert
+        ASSERT_IS_NOT_NULL(t);
+        ASSERT_ARE_EQUAL(void_ptr, (void*)source, (void*)StringToken_GetValue(t));
+        ASSERT_ARE_EQUAL(size_t, 1, StringToken_GetLength(t));
+        ASSERT_ARE_EQUAL(void_ptr, (void*)delimiters[0], (void*)StringToken_GetDelimiter(t));
+
+        next[0] = StringToken_GetNext(t, delimiters, 2);
+        ASSERT_IS_TRUE(next[0]);
+        ASSERT_ARE_EQUAL(void_ptr, (void*)(source + 3), (void*)StringToken_GetValue(t));
+        ASSERT_ARE_EQUAL(size_t, 2, StringToken_GetLength(t));
+        ASSERT_ARE_EQUAL(void_ptr, (void*)delimiters[1], (void*)StringToken_GetDelimiter(t));
+
+        next[1] = StringToken_GetNext(t, delimiters, 2);
+        ASSERT_IS_TRUE(next[1]);
+        ASSERT_ARE_EQUAL(void_ptr, (void*)(source + 6), (void*)StringToken_GetValue(t));
+        ASSERT_ARE_EQUAL(size_t, 1, StringToken_GetLength(t));
+        ASSERT_IS_NULL(StringToken_GetDelimiter(t));
+
+        next[2] = StringToken_GetNext(t, delimiters, 2);
+        ASSERT_IS_FALSE(next[2]);
+
+        ///cleanup
+        StringToken_Destroy(t);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_006: [ If the source string does not have any of the demiliters, the resulting token shall be the entire source string ] */
+    TEST_FUNCTION(StringToken_GetFirst_without_delimiters_in_source_returns_the_whole_source)
+    {
+        ///arrange
+        const char* source = "abc";
+        const char* delimiters[] = { "," };
+        STRING_TOKEN_HANDLE t;
+
+        ///act
+        t = StringToken_GetFirst(source, strlen(source), delimiters, 1);
+
+        ///assert
+        ASSERT_IS_NOT_NULL(t);
+        ASSERT_ARE_EQUAL(void_ptr, (void*)source, (void*)StringToken_GetValue(t));
+        ASSERT_ARE_EQUAL(size_t, 3, StringToken_GetLength(t));
+        ASSERT_IS_NULL(StringToken_GetDelimiter(t));
+        ASSERT_IS_FALSE(StringToken_GetNext(t, delimiters, 1));
+
+        ///cleanup
+        StringToken_Destroy(t);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_008: [ If token or delimiters are NULL, or n_delims is zero, the function shall return false ] */
+    TEST_FUNCTION(StringToken_GetNext_with_invalid_arguments_fails)
+    {
+        ///arrange
+        const char* delimiters[] = { "," };
+        STRING_TOKEN_HANDLE t = StringToken_GetFirst("a,b", 3, delimiters, 1);
+        bool r1;
+        bool r2;
+        bool r3;
+        ASSERT_IS_NOT_NULL(t);
+
+        ///act
+        r1 = StringToken_GetNext(NULL, delimiters, 1);
+        r2 = StringToken_GetNext(t, NULL, 1);
+        r3 = StringToken_GetNext(t, delimiters, 0);
+
+        ///assert
+        ASSERT_IS_FALSE(r1);
+        ASSERT_IS_FALSE(r2);
+        ASSERT_IS_FALSE(r3);
+
+        ///cleanup
+        StringToken_Destroy(t);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_013: [ If token is NULL the function shall return NULL ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_015: [ If token is NULL the function shall return zero ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_017: [ If token is NULL the function shall return NULL ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_020: [ If token is NULL the function shall return ] */
+    TEST_FUNCTION(StringToken_getters_with_NULL_token_fail)
+    {
+        ///act
+        const char* value = StringToken_GetValue(NULL);
+        size_t length = StringToken_GetLength(NULL);
+        const char* delimiter = StringToken_GetDelimiter(NULL);
+        StringToken_Destroy(NULL);
+
+        ///assert
+        ASSERT_IS_NULL(value);
+        ASSERT_ARE_EQUAL(size_t, 0, length);
+        ASSERT_IS_NULL(delimiter);
+    }
+
+    /* StringToken_Split and StringToken_SplitPacked */
+
+    /* Tests_SRS_STRING_TOKENIZER_09_022: [ If source, delimiters, token or token_count are NULL, or n_delims is zero the function shall return a non-zero value ] */
+    TEST_FUNCTION(StringToken_Split_with_invalid_arguments_fails)
+    {
+        ///arrange
+        const char* delimiters[] = { "," };
+        char** tokens;
+        size_t token_count;
+        int result[5];
+
+        ///act
+        result[0] = StringToken_Split(NULL, 3, delimiters, 1, false, &tokens, &token_count);
+        result[1] = StringToken_Split("a,b", 3, NULL, 1, false, &tokens, &token_count);
+        result[2] = StringToken_Split("a,b", 3, delimiters, 0, false, &tokens, &token_count);
+        result[3] = StringToken_Split("a,b", 3, delimiters, 1, false, NULL, &token_count);
+        result[4] = StringToken_Split("a,b", 3, delimiters, 1, false, &tokens, NULL);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result[0]);
+        ASSERT_ARE_NOT_EQUAL(int, 0, result[1]);
+        ASSERT_ARE_NOT_EQUAL(int, 0, result[2]);
+        ASSERT_ARE_NOT_EQUAL(int, 0, result[3]);
+        ASSERT_ARE_NOT_EQUAL(int, 0, result[4]);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_028: [ If source, delimiters, tokens or token_count are NULL, or n_delims is zero the function shall return a non-zero value ] */
+    TEST_FUNCTION(StringToken_SplitPacked_with_invalid_arguments_fails)
+    {
+        ///arrange
+        const char* delimiters[] = { "," };
+        char** tokens;
+        size_t token_count;
+        int result[5];
+
+        ///act
+        result[0] = StringToken_SplitPacked(NULL, 3, delimiters, 1, false, &tokens, &token_count);
+        result[1] = StringToken_SplitPacked("a,b", 3, NULL, 1, false, &tokens, &token_count);
+        result[2] = StringToken_SplitPacked("a,b", 3, delimiters, 0, false, &tokens, &token_count);
+        result[3] = StringToken_SplitPacked("a,b", 3, delimiters, 1, false, NULL, &token_count);
+        result[4] = StringToken_SplitPacked("a,b", 3, delimiters, 1, false, &tokens, NULL);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result[0]);
+        ASSERT_ARE_NOT_EQUAL(int, 0, result[1]);
+        ASSERT_ARE_NOT_EQUAL(int, 0, result[2]);
+        ASSERT_ARE_NOT_EQUAL(int, 0, result[3]);
+        ASSERT_ARE_NOT_EQUAL(int, 0, result[4]);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_031: [ If there are no tokens, tokens shall be set to NULL and token_count to zero ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_024: [ All NULL tokens shall be ommited if include_empty is not TRUE ] */
+    TEST_FUNCTION(StringToken_Split_of_an_empty_source_succeeds)
+    {
+        ///arrange
+        const char* delimiters[] = { "," };
+        const char* expected_with_empty[] = { NULL };
+        char** tokens;
+        size_t token_count;
+        int result;
+
+        ///act
+        result = StringToken_SplitPacked("", 0, delimiters, 1, false, &tokens, &token_count);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_IS_NULL(tokens);
+        ASSERT_ARE_EQUAL(size_t, 0, token_count);
+        assert_split("", delimiters, 1, false, NULL, 0);
+        assert_split("", delimiters, 1, true, expected_with_empty, 1);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_023: [ source (up to length) shall be split into individual tokens separated by any of delimiters ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_025: [ The tokens shall be stored in tokens, and their count stored in token_count ] */
+    /* Tests_SRS_STRING_TOKENIZER_09_030: [ source (up to length) shall be split into the same tokens StringToken_Split produces ] */
+    TEST_FUNCTION(StringToken_Split_without_delimiters_in_source_returns_the_whole_source)
+    {
+        ///arrange
+        const char* delimiters[] = { "," };
+        const char* expected[] = { "abc" };
+
+        ///act and assert
+        assert_split("abc", delimiters, 1, false, expected, 1);
+        assert_split("abc", delimiters, 1, true, expected, 1);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_024: [ All NULL tokens shall be ommited if include_empty is not TRUE ] */
+    TEST_FUNCTION(StringToken_Split_with_leading_and_trailing_delimiters_succeeds)
+    {
+        ///arrange
+        const char* delimiters[] = { "," };
+        const char* expected[] = { "a", "b" };
+        const char* expected_with_empty[] = { NULL, "a", "b", NULL };
+
+        ///act and assert
+        assert_split(",a,b,", delimiters, 1, false, expected, 2);
+        assert_split(",a,b,", delimiters, 1, true, expected_with_empty, 4);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_024: [ All NULL tokens shall be ommited if include_empty is not TRUE ] */
+    TEST_FUNCTION(StringToken_Split_with_adjacent_delimiters_succeeds)
+    {
+        ///arrange
+        const char* delimiters[] = { "," };
+        const char* expected[] = { "a", "b" };
+        const char* expected_with_empty[] = { "a", NULL, NULL, "b" };
+        const char* expected_only_delimiters[] = { NULL, NULL, NULL };
+
+        ///act and assert
+        assert_split("a,,,b", delimiters, 1, false, expected, 2);
+        assert_split("a,,,b", delimiters, 1, true, expected_with_empty, 4);
+        assert_split(",,", delimiters, 1, false, NULL, 0);
+        assert_split(",,", delimiters, 1, true, expected_only_delimiters, 3);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_023: [ source (up to length) shall be split into individual tokens separated by any of delimiters ] */
+    TEST_FUNCTION(StringToken_Split_with_multi_character_delimiters_succeeds)
+    {
+        ///arrange
+        const char* delimiters[] = { "\r\n", ";" };
+        const char* expected[] = { "a", "b\r", "c", "d" };
+
+        ///act and assert
+        assert_split("a\r\nb\r;c\r\nd", delimiters, 2, false, expected, 4);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_005: [ The source string shall be split in a token starting from the beginning of source up to occurrence of any one of the demiliters, whichever occurs first in the order provided ] */
+    TEST_FUNCTION(StringToken_Split_with_overlapping_delimiters_prefers_the_one_listed_first)
+    {
+        ///arrange
+        const char* short_first[] = { "ab", "aba" };
+        const char* long_first[] = { "aba", "ab" };
+        const char* expected_short_first[] = { "x", "ay" };
+        const char* expected_long_first[] = { "x", "y" };
+        const char* colons[] = { ":", "::" };
+        const char* expected_colons[] = { "a", NULL, "b" };
+
+        ///act and assert
+        assert_split("xabay", short_first, 2, false, expected_short_first, 2);
+        assert_split("xabay", long_first, 2, false, expected_long_first, 2);
+        assert_split("a::b", colons, 2, true, expected_colons, 3);
+    }
+
+    TEST_FUNCTION(StringToken_Split_with_a_delimiter_longer_than_the_rest_of_the_source_succeeds)
+    {
+        ///arrange
+        const char* delimiters[] = { "abc" };
+        const char* expected[] = { "xab" };
+
+        ///act and assert
+        assert_split("xab", delimiters, 1, false, expected, 1);
+    }
+
+    TEST_FUNCTION(StringToken_Split_ignores_empty_delimiters)
+    {
+        ///arrange
+        const char* delimiters[] = { "", "," };
+        const char* only_empty[] = { "" };
+        const char* expected[] = { "a", "b" };
+        const char* expected_whole[] = { "a,b" };
+
+        ///act and assert
+        assert_split("a,b", delimiters, 2, false, expected, 2);
+        assert_split("a,b", only_empty, 1, false, expected_whole, 1);
+    }
+
+    TEST_FUNCTION(StringToken_Split_only_splits_up_to_length)
+    {
+        ///arrange
+        const char* delimiters[] = { "," };
+        char** tokens;
+        size_t token_count;
+        const char* expected[] = { "a", "b" };
+
+        ///act
+        int result = StringToken_SplitPacked("a,bc,d", 3, delimiters, 1, false, &tokens, &token_count);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        assert_tokens(tokens, token_count, expected, 2);
+
+        ///cleanup
+        free(tokens);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_029: [ If any of the strings in delimiters are NULL, the function shall return a non-zero value ] */
+    TEST_FUNCTION(StringToken_SplitPacked_with_a_NULL_delimiter_fails)
+    {
+        ///arrange
+        const char* delimiters[] = { ",", NULL };
+        char** tokens;
+        size_t token_count;
+
+        ///act
+        int result = StringToken_SplitPacked("a,b", 3, delimiters, 2, false, &tokens, &token_count);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_032: [ The pointer array and the null-terminated copies of the tokens shall be stored in a single memory block, so that the caller releases everything by calling free on tokens ] */
+    TEST_FUNCTION(StringToken_SplitPacked_returns_a_single_memory_block)
+    {
+        ///arrange
+        const char* delimiters[] = { ",", ";" };
+        const char* expected[] = { "ab", "c", "def" };
+        char** tokens;
+        size_t token_count;
+
+        ///act
+        int result = StringToken_SplitPacked("ab,c;def", 8, delimiters, 2, false, &tokens, &token_count);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        assert_tokens(tokens, token_count, expected, 3);
+        ASSERT_ARE_EQUAL(void_ptr, (void*)(tokens + 3), (void*)tokens[0]);
+        ASSERT_ARE_EQUAL(void_ptr, (void*)(tokens[0] + 3), (void*)tokens[1]);
+        ASSERT_ARE_EQUAL(void_ptr, (void*)(tokens[1] + 2), (void*)tokens[2]);
+
+        ///cleanup
+        free(tokens);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_033: [ If any memory allocation fails the function shall return a non-zero value ] */
+    TEST_FUNCTION(when_malloc_fails_StringToken_SplitPacked_fails)
+    {
+        ///arrange
+        const char* delimiters[] = { "," };
+        size_t i;
+        size_t malloc_count;
+        char** tokens;
+        size_t token_count;
+
+        ASSERT_ARE_EQUAL(int, 0, StringToken_SplitPacked("a,b", 3, delimiters, 1, false, &tokens, &token_count));
+        free(tokens);
+        malloc_count = currentmalloc_call;
+
+        for (i = 1; i <= malloc_count; i++)
+        {
+            char tmp_msg[64];
+            int result;
+
+            currentmalloc_call = 0;
+            whenShallmalloc_fail = i;
+
+            ///act
+            result = StringToken_SplitPacked("a,b", 3, delimiters, 1, false, &tokens, &token_count);
+
+            ///assert
+            (void)sprintf(tmp_msg, "StringToken_SplitPacked failure in malloc %lu", (unsigned long)i);
+            ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, 0, result, tmp_msg);
+        }
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_09_026: [ If any failures splitting or storing the tokens occur the function shall return a non-zero value ] */
+    TEST_FUNCTION(when_malloc_fails_StringToken_Split_fails)
+    {
+        ///arrange
+        const char* delimiters[] = { "," };
+        char** tokens;
+        size_t token_count;
+        int result;
+
+        // the tokenizer and the delimiter lengths are allocated before the first token copy
+        whenShallmalloc_fail = 3;
+
+        ///act
+        result = StringToken_Split("a,b", 3, delimiters, 1, false, &tokens, &token_count);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, 0, token_count);
+    }
+
+END_TEST_SUITE(string_token_unittests)
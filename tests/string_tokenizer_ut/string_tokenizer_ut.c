@@ -4,9 +4,11 @@
 #ifdef __cplusplus
 #include <cstdlib>
 #include <cstddef>
+#include <cstring>
 #else
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
 #endif
 
 #include "testrunnerswitcher.h"
@@ -777,6 +779,180 @@ BEGIN_TEST_SUITE(string_tokenizer_unittests)
         STRING_delete(input_string_handle);
         STRING_delete(output_string_handle);
     }
+    /* Tests_SRS_STRING_04_008: [STRING_TOKENIZER_get_next_token than searches from the start of a token for a character that is contained in the delimiters string.] */
+    TEST_FUNCTION(STRING_TOKENIZER_get_next_token_ends_the_token_at_the_first_of_any_delimiter)
+    {
+        ///arrange
+        int r;
+        STRING_HANDLE output_string_handle = STRING_new();
+        STRING_TOKENIZER_HANDLE t = STRING_TOKENIZER_create_from_char("a;b=c");
+
+        umock_c_reset_all_calls();
+
+        EXPECTED_CALL(gballoc_realloc(0, 0))  //Alloc memory to copy result. 
+            .IgnoreArgument(1)
+            .IgnoreArgument(2);
+
+        ///act
+        r = STRING_TOKENIZER_get_next_token(t, output_string_handle, "=;");
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, r);
+        ASSERT_ARE_EQUAL(char_ptr, "a", STRING_c_str(output_string_handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///Cleanup
+        STRING_TOKENIZER_destroy(t);
+        STRING_delete(output_string_handle);
+    }
+
+    /* STRING_TOKENIZER_compile_delimiters */
+
+    /* Tests_SRS_STRING_TOKENIZER_01_001: [If delimiters or compiled is NULL, STRING_TOKENIZER_compile_delimiters shall fail and return a non-zero value.] */
+    TEST_FUNCTION(STRING_TOKENIZER_compile_delimiters_with_NULL_delimiters_fails)
+    {
+        ///arrange
+        int r;
+        STRING_TOKENIZER_DELIMITERS compiled;
+
+        ///act
+        r = STRING_TOKENIZER_compile_delimiters(NULL, &compiled);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, r);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_01_001: [If delimiters or compiled is NULL, STRING_TOKENIZER_compile_delimiters shall fail and return a non-zero value.] */
+    TEST_FUNCTION(STRING_TOKENIZER_compile_delimiters_with_NULL_compiled_fails)
+    {
+        ///arrange
+        int r;
+
+        ///act
+        r = STRING_TOKENIZER_compile_delimiters(";", NULL);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, r);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_01_002: [If delimiters is an empty string, STRING_TOKENIZER_compile_delimiters shall fail and return a non-zero value.] */
+    TEST_FUNCTION(STRING_TOKENIZER_compile_delimiters_with_empty_delimiters_fails)
+    {
+        ///arrange
+        int r;
+        STRING_TOKENIZER_DELIMITERS compiled;
+
+        ///act
+        r = STRING_TOKENIZER_compile_delimiters("", &compiled);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, r);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_01_003: [STRING_TOKENIZER_compile_delimiters shall build in compiled a 256 bit lookup table with one bit set for each character of delimiters and return 0.] */
+    TEST_FUNCTION(STRING_TOKENIZER_compile_delimiters_succeeds)
+    {
+        ///arrange
+        int r;
+        STRING_TOKENIZER_DELIMITERS compiled;
+
+        ///act
+        r = STRING_TOKENIZER_compile_delimiters("\r\n\xFF", &compiled);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, r);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(int, 1 << ('\r' & 7), compiled.set['\r' >> 3] & (1 << ('\r' & 7)));
+        ASSERT_ARE_EQUAL(int, 1 << ('\n' & 7), compiled.set['\n' >> 3] & (1 << ('\n' & 7)));
+        ASSERT_ARE_EQUAL(int, 0x80, compiled.set[31]);
+        ASSERT_ARE_EQUAL(int, 0, compiled.set[' ' >> 3]);
+    }
+
+    /* STRING_TOKENIZER_get_next_token_view */
+
+    /* Tests_SRS_STRING_TOKENIZER_01_004: [If any argument is NULL, STRING_TOKENIZER_get_next_token_view shall fail and return a non-zero value.] */
+    TEST_FUNCTION(STRING_TOKENIZER_get_next_token_view_with_NULL_arguments_fails)
+    {
+        ///arrange
+        int r1, r2, r3, r4;
+        const char* token;
+        size_t token_length;
+        STRING_TOKENIZER_DELIMITERS compiled;
+        STRING_TOKENIZER_HANDLE t = STRING_TOKENIZER_create_from_char("a;b");
+        (void)STRING_TOKENIZER_compile_delimiters(";", &compiled);
+
+        umock_c_reset_all_calls();
+
+        ///act
+        r1 = STRING_TOKENIZER_get_next_token_view(NULL, &compiled, &token, &token_length);
+        r2 = STRING_TOKENIZER_get_next_token_view(t, NULL, &token, &token_length);
+        r3 = STRING_TOKENIZER_get_next_token_view(t, &compiled, NULL, &token_length);
+        r4 = STRING_TOKENIZER_get_next_token_view(t, &compiled, &token, NULL);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, r1);
+        ASSERT_ARE_NOT_EQUAL(int, 0, r2);
+        ASSERT_ARE_NOT_EQUAL(int, 0, r3);
+        ASSERT_ARE_NOT_EQUAL(int, 0, r4);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///Cleanup
+        STRING_TOKENIZER_destroy(t);
+    }
+
+    /* Tests_SRS_STRING_TOKENIZER_01_005: [STRING_TOKENIZER_get_next_token_view shall find the next token exactly like STRING_TOKENIZER_get_next_token, using the compiled delimiters.] */
+    /* Tests_SRS_STRING_TOKENIZER_01_006: [On success STRING_TOKENIZER_get_next_token_view shall set token to the start of the token inside the tokenizer's copy of the input, set token_length to its length and return 0, without allocating or copying.] */
+    /* Tests_SRS_STRING_TOKENIZER_01_007: [If no more tokens are found, STRING_TOKENIZER_get_next_token_view shall return a non-zero value.] */
+    TEST_FUNCTION(STRING_TOKENIZER_get_next_token_view_returns_the_tokens_without_allocating)
+    {
+        ///arrange
+        int r;
+        const char* token;
+        size_t token_length;
+        STRING_TOKENIZER_DELIMITERS compiled;
+        STRING_TOKENIZER_HANDLE t = STRING_TOKENIZER_create_from_char(";;key=value;x");
+        (void)STRING_TOKENIZER_compile_delimiters("=;", &compiled);
+
+        umock_c_reset_all_calls();
+
+        ///act1
+        r = STRING_TOKENIZER_get_next_token_view(t, &compiled, &token, &token_length);
+
+        ///assert1
+        ASSERT_ARE_EQUAL(int, 0, r);
+        ASSERT_ARE_EQUAL(size_t, 3, token_length);
+        ASSERT_ARE_EQUAL(int, 0, strncmp("key", token, token_length));
+
+        ///act2
+        r = STRING_TOKENIZER_get_next_token_view(t, &compiled, &token, &token_length);
+
+        ///assert2
+        ASSERT_ARE_EQUAL(int, 0, r);
+        ASSERT_ARE_EQUAL(size_t, 5, token_length);
+        ASSERT_ARE_EQUAL(int, 0, strncmp("value", token, token_length));
+
+        ///act3
+        r = STRING_TOKENIZER_get_next_token_view(t, &compiled, &token, &token_length);
+
+        ///assert3
+        ASSERT_ARE_EQUAL(int, 0, r);
+        ASSERT_ARE_EQUAL(size_t, 1, token_length);
+        ASSERT_ARE_EQUAL(char, 'x', token[0]);
+
+        ///act4
+        r = STRING_TOKENIZER_get_next_token_view(t, &compiled, &token, &token_length);
+
+        ///assert4
+        ASSERT_ARE_NOT_EQUAL(int, 0, r);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///Cleanup
+        STRING_TOKENIZER_destroy(t);
+    }
+
     /* STRING_TOKENIZER_delete */
     /*Test_SRS_STRING_TOKENIZER_04_012: [STRING_TOKENIZER_destroy shall free the memory allocated by the STRING_TOKENIZER_create ] */
     TEST_FUNCTION(STRING_TOKENIZER_DESTROY_Succeed)
@@ -73,6 +73,8 @@ static const struct JSONEncoding {
         { "\\", "\"\\\\\"" },
         { "\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0A\x0B\x0C\x0D\x0E\x0F\x10\x11\x12\x13\x14\x15\x16\x17\x18\x19\x1A\x1B\x1C\x1D\x1E\x1F some text\"\\a/a", 
           "\"\\u0001\\u0002\\u0003\\u0004\\u0005\\u0006\\u0007\\u0008\\u0009\\u000A\\u000B\\u000C\\u000D\\u000E\\u000F\\u0010\\u0011\\u0012\\u0013\\u0014\\u0015\\u0016\\u0017\\u0018\\u0019\\u001A\\u001B\\u001C\\u001D\\u001E\\u001F some text\\\"\\\\a\\/a\"" },
+        { "0123456789abcdef0123456789abcdef", "\"0123456789abcdef0123456789abcdef\"" }, /*whole clean words*/
+        { "01234567\"9abcdef/123456\x7F", "\"01234567\\\"9abcdef\\/123456\x7F\"" }, /*escapes inside a word and in the tail*/
 
     };
 
@@ -1351,6 +1353,130 @@ BEGIN_TEST_SUITE(strings_unittests)
         ///cleanup
     }
 
+    /*Tests_SRS_STRING_02_014: [If any character has the value outside [1...127] then STRING_new_JSON shall fail and return NULL.] */
+    TEST_FUNCTION(STRING_new_JSON_when_character_not_ASCII_after_clean_words_fails)
+    {
+        ///arrange
+
+        ///act
+        STRING_HANDLE result = STRING_new_JSON("0123456789abcdef\x80");
+
+        ///assert
+        ASSERT_IS_NULL(result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+    }
+
+    /*Tests_SRS_STRING_01_001: [ If handle or source is NULL then STRING_concat_JSON shall fail and return a non-zero value. ]*/
+    TEST_FUNCTION(STRING_concat_JSON_with_NULL_handle_fails)
+    {
+        ///arrange
+        int result;
+
+        ///act
+        result = STRING_concat_JSON(NULL, "a");
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_STRING_01_001: [ If handle or source is NULL then STRING_concat_JSON shall fail and return a non-zero value. ]*/
+    TEST_FUNCTION(STRING_concat_JSON_with_NULL_source_fails)
+    {
+        ///arrange
+        int result;
+        STRING_HANDLE handle = STRING_construct(INITIAL_STRING_VALUE);
+        umock_c_reset_all_calls();
+
+        ///act
+        result = STRING_concat_JSON(handle, NULL);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, INITIAL_STRING_VALUE, STRING_c_str(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        STRING_delete(handle);
+    }
+
+    /*Tests_SRS_STRING_01_002: [ STRING_concat_JSON shall append to handle the same characters that STRING_new_JSON produces for source. ]*/
+    /*Tests_SRS_STRING_01_004: [ STRING_concat_JSON shall grow the string held by handle with a single reallocation to the exact size needed. ]*/
+    /*Tests_SRS_STRING_01_006: [ On success STRING_concat_JSON shall return 0. ]*/
+    TEST_FUNCTION(STRING_concat_JSON_succeeds)
+    {
+        size_t i;
+        for (i = 0; i < sizeof(JSONtests) / sizeof(JSONtests[0]); i++)
+        {
+            ///arrange
+            int result;
+            char expected[512];
+            STRING_HANDLE handle = STRING_construct(INITIAL_STRING_VALUE);
+            (void)sprintf(expected, "%s%s", INITIAL_STRING_VALUE, JSONtests[i].expectedJSON);
+            umock_c_reset_all_calls();
+
+            STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, strlen(expected) + 1))
+                .IgnoreArgument(1);
+
+            ///act
+            result = STRING_concat_JSON(handle, JSONtests[i].source);
+
+            ///assert
+            ASSERT_ARE_EQUAL(int, 0, result);
+            ASSERT_ARE_EQUAL(char_ptr, expected, STRING_c_str(handle));
+            ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+            ///cleanup
+            STRING_delete(handle);
+        }
+    }
+
+    /*Tests_SRS_STRING_01_003: [ If any character of source has the value outside [1...127] then STRING_concat_JSON shall fail, leave handle unchanged and return a non-zero value. ]*/
+    TEST_FUNCTION(STRING_concat_JSON_when_character_not_ASCII_fails)
+    {
+        ///arrange
+        int result;
+        STRING_HANDLE handle = STRING_construct(INITIAL_STRING_VALUE);
+        umock_c_reset_all_calls();
+
+        ///act
+        result = STRING_concat_JSON(handle, "a\xFF");
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, INITIAL_STRING_VALUE, STRING_c_str(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        STRING_delete(handle);
+    }
+
+    /*Tests_SRS_STRING_01_005: [ If reallocating the string fails, STRING_concat_JSON shall leave handle unchanged and return a non-zero value. ]*/
+    TEST_FUNCTION(STRING_concat_JSON_when_realloc_fails_fails)
+    {
+        ///arrange
+        int result;
+        STRING_HANDLE handle = STRING_construct(INITIAL_STRING_VALUE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, strlen(INITIAL_STRING_VALUE) + strlen("\"ab\"") + 1))
+            .IgnoreArgument(1)
+            .SetReturn(NULL);
+
+        ///act
+        result = STRING_concat_JSON(handle, "ab");
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, INITIAL_STRING_VALUE, STRING_c_str(handle));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        STRING_delete(handle);
+    }
+
     /*Tests_SRS_STRING_02_022: [ If source is NULL and size > 0 then STRING_from_BUFFER shall fail and return NULL. ]*/
     TEST_FUNCTION(STRING_from_byte_array_with_NULL_array_and_size_not_zero_fails)
     {
@@ -3,8 +3,12 @@
 
 #ifdef __cplusplus
 #include <cstdlib>
+#include <cstring>
+#include <ctime>
 #else
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #endif
 
 #include "testrunnerswitcher.h"
@@ -97,4 +101,122 @@ TEST_FUNCTION(UniqueId_Generate_Succeed)
     ASSERT_ARE_EQUAL(size_t, 36, strlen(uid) );
 }
 
+/* UniqueId_GetRandomBytes */
+
+/* Tests_SRS_UNIQUEID_01_002: [ If buffer is NULL or size is 0 then UniqueId_GetRandomBytes shall return UNIQUEID_INVALID_ARG ] */
+TEST_FUNCTION(UniqueId_GetRandomBytes_buffer_NULL_Fail)
+{
+    //Arrange
+
+    //Act
+    UNIQUEID_RESULT result = UniqueId_GetRandomBytes(NULL, 16);
+
+    //Assert
+    ASSERT_ARE_EQUAL(UNIQUEID_RESULT, UNIQUEID_INVALID_ARG, result);
+}
+
+/* Tests_SRS_UNIQUEID_01_002: [ If buffer is NULL or size is 0 then UniqueId_GetRandomBytes shall return UNIQUEID_INVALID_ARG ] */
+TEST_FUNCTION(UniqueId_GetRandomBytes_size_zero_Fail)
+{
+    //Arrange
+    unsigned char buffer[16];
+
+    //Act
+    UNIQUEID_RESULT result = UniqueId_GetRandomBytes(buffer, 0);
+
+    //Assert
+    ASSERT_ARE_EQUAL(UNIQUEID_RESULT, UNIQUEID_INVALID_ARG, result);
+}
+
+/* Tests_SRS_UNIQUEID_01_001: [ UniqueId_GetRandomBytes shall fill buffer with size bytes from a cryptographically secure random source. ] */
+TEST_FUNCTION(UniqueId_GetRandomBytes_consecutive_calls_return_different_bytes)
+{
+    //Arrange
+    unsigned char buffer1[16];
+    unsigned char buffer2[16];
+    UNIQUEID_RESULT result1;
+    UNIQUEID_RESULT result2;
+
+    //Act
+    result1 = UniqueId_GetRandomBytes(buffer1, sizeof(buffer1));
+    result2 = UniqueId_GetRandomBytes(buffer2, sizeof(buffer2));
+
+    //Assert
+    ASSERT_ARE_EQUAL(UNIQUEID_RESULT, UNIQUEID_OK, result1);
+    ASSERT_ARE_EQUAL(UNIQUEID_RESULT, UNIQUEID_OK, result2);
+    ASSERT_ARE_NOT_EQUAL(int, 0, memcmp(buffer1, buffer2, sizeof(buffer1)));
+}
+
+/* Tests_SRS_UNIQUEID_01_001: [ UniqueId_GetRandomBytes shall fill buffer with size bytes from a cryptographically secure random source. ] */
+TEST_FUNCTION(UniqueId_GetRandomBytes_more_bytes_than_the_pool_Succeed)
+{
+    //Arrange
+    unsigned char buffer[2048];
+    unsigned char zeros[64] = { 0 };
+
+    //Act
+    UNIQUEID_RESULT result = UniqueId_GetRandomBytes(buffer, sizeof(buffer));
+
+    //Assert
+    ASSERT_ARE_EQUAL(UNIQUEID_RESULT, UNIQUEID_OK, result);
+    ASSERT_ARE_NOT_EQUAL(int, 0, memcmp(buffer + sizeof(buffer) - sizeof(zeros), zeros, sizeof(zeros)));
+}
+
+/* UniqueId_GetTimestampSequence */
+
+/* Tests_SRS_UNIQUEID_01_006: [ If unix_time_ms or sequence is NULL then UniqueId_GetTimestampSequence shall return UNIQUEID_INVALID_ARG ] */
+TEST_FUNCTION(UniqueId_GetTimestampSequence_unix_time_ms_NULL_Fail)
+{
+    //Arrange
+    uint16_t sequence;
+
+    //Act
+    UNIQUEID_RESULT result = UniqueId_GetTimestampSequence(NULL, &sequence);
+
+    //Assert
+    ASSERT_ARE_EQUAL(UNIQUEID_RESULT, UNIQUEID_INVALID_ARG, result);
+}
+
+/* Tests_SRS_UNIQUEID_01_006: [ If unix_time_ms or sequence is NULL then UniqueId_GetTimestampSequence shall return UNIQUEID_INVALID_ARG ] */
+TEST_FUNCTION(UniqueId_GetTimestampSequence_sequence_NULL_Fail)
+{
+    //Arrange
+    uint64_t unix_time_ms;
+
+    //Act
+    UNIQUEID_RESULT result = UniqueId_GetTimestampSequence(&unix_time_ms, NULL);
+
+    //Assert
+    ASSERT_ARE_EQUAL(UNIQUEID_RESULT, UNIQUEID_INVALID_ARG, result);
+}
+
+/* Tests_SRS_UNIQUEID_01_004: [ UniqueId_GetTimestampSequence shall return the current time in milliseconds since the Unix epoch and a 12 bit sequence number. ] */
+/* Tests_SRS_UNIQUEID_01_005: [ The pairs returned by UniqueId_GetTimestampSequence within a process shall be strictly increasing, also when called concurrently. ] */
+TEST_FUNCTION(UniqueId_GetTimestampSequence_returns_increasing_values)
+{
+    //Arrange
+    uint64_t previous_ms = 0;
+    uint16_t previous_sequence = 0;
+    uint64_t start_ms = (uint64_t)time(NULL) * 1000;
+    size_t i;
+
+    for (i = 0; i < 10000; i++)
+    {
+        uint64_t unix_time_ms;
+        uint16_t sequence;
+
+        //Act
+        UNIQUEID_RESULT result = UniqueId_GetTimestampSequence(&unix_time_ms, &sequence);
+
+        //Assert
+        ASSERT_ARE_EQUAL(UNIQUEID_RESULT, UNIQUEID_OK, result);
+        ASSERT_IS_TRUE(sequence <= 0xFFF);
+        ASSERT_IS_TRUE(unix_time_ms + 1000 >= start_ms);
+        ASSERT_IS_TRUE((unix_time_ms > previous_ms) || ((unix_time_ms == previous_ms) && (sequence > previous_sequence)));
+
+        previous_ms = unix_time_ms;
+        previous_sequence = sequence;
+    }
+}
+
 END_TEST_SUITE(uniqueid_unittests)
@@ -1300,4 +1300,251 @@ TEST_FUNCTION(URL_Decode_Extended_ASCII_chars)
     }
 }
 
+/*Tests_SRS_URL_ENCODE_01_001: [If textEncode, destination or encoded_length is NULL, or destination_size is 0, URL_EncodeString_Into shall fail and return a non-zero value.]*/
+TEST_FUNCTION(URL_EncodeString_Into_invalid_args_fail)
+{
+    //arrange
+    char destination[32];
+    size_t encoded_length;
+
+    //act
+    int result1 = URL_EncodeString_Into(NULL, destination, sizeof(destination), &encoded_length);
+    int result2 = URL_EncodeString_Into("hello world", NULL, sizeof(destination), &encoded_length);
+    int result3 = URL_EncodeString_Into("hello world", destination, 0, &encoded_length);
+    int result4 = URL_EncodeString_Into("hello world", destination, sizeof(destination), NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result3);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result4);
+}
+
+/*Tests_SRS_URL_ENCODE_01_002: [URL_EncodeString_Into shall encode textEncode into destination in a single pass, null terminate it, store its length in encoded_length and return 0.]*/
+TEST_FUNCTION(URL_EncodeString_Into_Exhaustive_chars)
+{
+    size_t i;
+    size_t numberOfTests = sizeof(testVector) / sizeof(testVector[i]);
+    for (i = 0; i < numberOfTests; i++)
+    {
+        //arrange
+        char destination[16];
+        size_t encoded_length;
+
+        //act
+        int result = URL_EncodeString_Into(testVector[i].inputData, destination, sizeof(destination), &encoded_length);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, testVector[i].expectedOutput, destination);
+        ASSERT_ARE_EQUAL(size_t, strlen(testVector[i].expectedOutput), encoded_length);
+    }
+}
+
+/*Tests_SRS_URL_ENCODE_01_002: [URL_EncodeString_Into shall encode textEncode into destination in a single pass, null terminate it, store its length in encoded_length and return 0.]*/
+TEST_FUNCTION(URL_EncodeString_Into_full_url_exact_size_succeeds)
+{
+    //arrange
+    const char* fullUrl = "https://one.two.three.four-five.com/six/Seven('EightNine1234567890.Ten_Eleven')?twelve-thirteen=2015-11-31 HTTP/1.1";
+    const char* expected = "https%3a%2f%2fone.two.three.four-five.com%2fsix%2fSeven(%27EightNine1234567890.Ten_Eleven%27)%3ftwelve-thirteen%3d2015-11-31%20HTTP%2f1.1";
+    char destination[256];
+    size_t encoded_length;
+
+    //act
+    int result = URL_EncodeString_Into(fullUrl, destination, strlen(expected) + 1, &encoded_length);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, expected, destination);
+    ASSERT_ARE_EQUAL(size_t, strlen(expected), encoded_length);
+}
+
+/*Tests_SRS_URL_ENCODE_01_003: [If destination_size is too small for the encoded string and its null terminator, URL_EncodeString_Into shall fail and return a non-zero value.]*/
+TEST_FUNCTION(URL_EncodeString_Into_destination_too_small_fails)
+{
+    //arrange
+    char destination[32];
+    size_t encoded_length;
+
+    //act
+    int result1 = URL_EncodeString_Into("hello world", destination, strlen("hello%20world"), &encoded_length);
+    int result2 = URL_EncodeString_Into("hello", destination, strlen("hello"), &encoded_length);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+}
+
+/*Tests_SRS_URL_ENCODE_01_004: [If destination or textEncode is NULL, URL_EncodeString_Append shall fail and return a non-zero value.]*/
+TEST_FUNCTION(URL_EncodeString_Append_invalid_args_fail)
+{
+    //arrange
+    STRING_HANDLE destination = STRING_new();
+
+    //act
+    int result1 = URL_EncodeString_Append(NULL, "hello world");
+    int result2 = URL_EncodeString_Append(destination, NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+    ASSERT_ARE_EQUAL(char_ptr, "", STRING_c_str(destination));
+
+    //cleanup
+    STRING_delete(destination);
+}
+
+/*Tests_SRS_URL_ENCODE_01_005: [URL_EncodeString_Append shall encode textEncode and append the result to destination, using a stack buffer when the encoded string is small enough.]*/
+TEST_FUNCTION(URL_EncodeString_Append_appends_encoded_string)
+{
+    //arrange
+    STRING_HANDLE destination = STRING_construct("sr=");
+
+    //act
+    int result = URL_EncodeString_Append(destination, "/getalarm('Le Pichet')");
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "sr=%2fgetalarm(%27Le%20Pichet%27)", STRING_c_str(destination));
+
+    //cleanup
+    STRING_delete(destination);
+}
+
+/*Tests_SRS_URL_ENCODE_01_005: [URL_EncodeString_Append shall encode textEncode and append the result to destination, using a stack buffer when the encoded string is small enough.]*/
+TEST_FUNCTION(URL_EncodeString_Append_large_input_appends_encoded_string)
+{
+    //arrange
+    char input[201];
+    STRING_HANDLE expected = STRING_new();
+    STRING_HANDLE destination = STRING_new();
+    size_t i;
+    int result;
+    for (i = 0; i < 200; i++)
+    {
+        input[i] = (i % 2 == 0) ? 'a' : '/';
+        ASSERT_ARE_EQUAL(int, 0, STRING_concat(expected, (i % 2 == 0) ? "a" : "%2f"));
+    }
+    input[200] = '\0';
+
+    //act
+    result = URL_EncodeString_Append(destination, input);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, STRING_c_str(expected), STRING_c_str(destination));
+
+    //cleanup
+    STRING_delete(expected);
+    STRING_delete(destination);
+}
+
+/*Tests_SRS_URL_ENCODE_01_007: [If textDecode, destination or decoded_length is NULL, or destination_size is 0, URL_DecodeString_Into shall fail and return a non-zero value.]*/
+TEST_FUNCTION(URL_DecodeString_Into_invalid_args_fail)
+{
+    //arrange
+    char destination[32];
+    size_t decoded_length;
+
+    //act
+    int result1 = URL_DecodeString_Into(NULL, destination, sizeof(destination), &decoded_length);
+    int result2 = URL_DecodeString_Into("hello%20world", NULL, sizeof(destination), &decoded_length);
+    int result3 = URL_DecodeString_Into("hello%20world", destination, 0, &decoded_length);
+    int result4 = URL_DecodeString_Into("hello%20world", destination, sizeof(destination), NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result3);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result4);
+}
+
+/*Tests_SRS_URL_ENCODE_01_008: [URL_DecodeString_Into shall decode textDecode into destination in a single pass, null terminate it, store its length in decoded_length and return 0.]*/
+TEST_FUNCTION(URL_DecodeString_Into_path_with_device)
+{
+    //arrange
+    char destination[32];
+    size_t decoded_length;
+
+    //act
+    int result = URL_DecodeString_Into("%2fgetalarm(%27Le%20Pichet%27)", destination, sizeof(destination), &decoded_length);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "/getalarm('Le Pichet')", destination);
+    ASSERT_ARE_EQUAL(size_t, strlen("/getalarm('Le Pichet')"), decoded_length);
+}
+
+/*Tests_SRS_URL_ENCODE_01_009: [If textDecode is not a valid encoding or destination_size is too small for the decoded string and its null terminator, URL_DecodeString_Into shall fail and return a non-zero value.]*/
+TEST_FUNCTION(URL_DecodeString_Into_invalid_input_or_too_small_fails)
+{
+    //arrange
+    char destination[32];
+    size_t decoded_length;
+
+    //act
+    int result1 = URL_DecodeString_Into("hello world", destination, sizeof(destination), &decoded_length);
+    int result2 = URL_DecodeString_Into("%7", destination, sizeof(destination), &decoded_length);
+    int result3 = URL_DecodeString_Into("%c3%bf", destination, sizeof(destination), &decoded_length);
+    int result4 = URL_DecodeString_Into("hello%20world", destination, strlen("hello world"), &decoded_length);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result3);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result4);
+}
+
+/*Tests_SRS_URL_ENCODE_01_010: [If destination or textDecode is NULL, URL_DecodeString_Append shall fail and return a non-zero value.]*/
+TEST_FUNCTION(URL_DecodeString_Append_invalid_args_fail)
+{
+    //arrange
+    STRING_HANDLE destination = STRING_new();
+
+    //act
+    int result1 = URL_DecodeString_Append(NULL, "hello%20world");
+    int result2 = URL_DecodeString_Append(destination, NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+
+    //cleanup
+    STRING_delete(destination);
+}
+
+/*Tests_SRS_URL_ENCODE_01_011: [URL_DecodeString_Append shall decode textDecode and append the result to destination, using a stack buffer when the input is small enough.]*/
+TEST_FUNCTION(URL_DecodeString_Append_appends_decoded_string)
+{
+    //arrange
+    STRING_HANDLE destination = STRING_construct("path=");
+
+    //act
+    int result = URL_DecodeString_Append(destination, "%2fgetalarm(%27Le%20Pichet%27)");
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "path=/getalarm('Le Pichet')", STRING_c_str(destination));
+
+    //cleanup
+    STRING_delete(destination);
+}
+
+/*Tests_SRS_URL_ENCODE_01_012: [If textDecode is not a valid encoding or any other error occurs, URL_DecodeString_Append shall fail and return a non-zero value.]*/
+TEST_FUNCTION(URL_DecodeString_Append_invalid_encoding_fails)
+{
+    //arrange
+    STRING_HANDLE destination = STRING_construct("path=");
+
+    //act
+    int result = URL_DecodeString_Append(destination, "hello%20world&mistake");
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "path=", STRING_c_str(destination));
+
+    //cleanup
+    STRING_delete(destination);
+}
+
 END_TEST_SUITE(URLEncode_UnitTests)
@@ -13,9 +13,11 @@
 
 #ifdef __cplusplus
 #include <cstddef>
+#include <cstring>
 #else
 #include <stddef.h>
 #include <stdbool.h>
+#include <string.h>
 #endif
 
 #include "testrunnerswitcher.h"
@@ -561,4 +563,271 @@ TEST_FUNCTION(utf8_checker_with_4th_char_bad_fails)
     ASSERT_IS_FALSE(result);
 }
 
+/* Tests_SRS_UTF8_CHECKER_01_001: [ `utf8_checker_is_valid_utf8` shall verify that the sequence of chars pointed to by `utf8_str` represent UTF-8 encoded codepoints. ]*/
+/* Tests_SRS_UTF8_CHECKER_01_006: [ 00000000 0xxxxxxx 0xxxxxxx ]*/
+TEST_FUNCTION(utf8_checker_with_a_long_ascii_string_succeeds)
+{
+    // arrange
+    bool result;
+    const char* test_str = "The quick brown fox jumps over the lazy dog, 0123456789 times.";
+
+    // act
+    result = utf8_checker_is_valid_utf8((const unsigned char*)test_str, strlen(test_str));
+
+    // assert
+    ASSERT_IS_TRUE(result);
+}
+
+/* Tests_SRS_UTF8_CHECKER_01_001: [ `utf8_checker_is_valid_utf8` shall verify that the sequence of chars pointed to by `utf8_str` represent UTF-8 encoded codepoints. ]*/
+TEST_FUNCTION(utf8_checker_with_a_bad_byte_after_a_long_ascii_run_fails)
+{
+    // arrange
+    size_t i;
+    unsigned char test_str[48];
+    (void)memset(test_str, 'a', sizeof(test_str));
+
+    for (i = 0; i < sizeof(test_str); i++)
+    {
+        bool result;
+        test_str[i] = 0xFF;
+
+        // act
+        result = utf8_checker_is_valid_utf8(test_str, sizeof(test_str));
+
+        // assert
+        ASSERT_IS_FALSE(result);
+
+        test_str[i] = 'a';
+    }
+}
+
+/* Tests_SRS_UTF8_CHECKER_01_001: [ `utf8_checker_is_valid_utf8` shall verify that the sequence of chars pointed to by `utf8_str` represent UTF-8 encoded codepoints. ]*/
+/* Tests_SRS_UTF8_CHECKER_01_007: [ 00000yyy yyxxxxxx 110yyyyy 10xxxxxx ]*/
+/* Tests_SRS_UTF8_CHECKER_01_008: [ zzzzyyyy yyxxxxxx 1110zzzz 10yyyyyy 10xxxxxx ]*/
+/* Tests_SRS_UTF8_CHECKER_01_009: [ 000uuuuu zzzzyyyy yyxxxxxx 11110uuu 10uuzzzz 10yyyyyy 10xxxxxx ]*/
+TEST_FUNCTION(utf8_checker_with_mixed_scripts_after_a_long_ascii_run_succeeds)
+{
+    // arrange
+    bool result;
+    unsigned char test_str[] =
+    {
+        'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r',
+        0xC3, 0xA9, 'x', 0xE4, 0xB8, 0xAD, 0xF0, 0x9F, 0x98, 0x80,
+        'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r'
+    };
+
+    // act
+    result = utf8_checker_is_valid_utf8(test_str, sizeof(test_str));
+
+    // assert
+    ASSERT_IS_TRUE(result);
+}
+
+/* Tests_SRS_UTF8_CHECKER_01_008: [ zzzzyyyy yyxxxxxx 1110zzzz 10yyyyyy 10xxxxxx ]*/
+TEST_FUNCTION(utf8_checker_with_an_overlong_3_byte_code_with_E0_lead_fails)
+{
+    // arrange
+    bool result;
+    unsigned char test_str[] = { 0xE0, 0x9F, 0xBF };
+
+    // act
+    result = utf8_checker_is_valid_utf8(test_str, sizeof(test_str));
+
+    // assert
+    ASSERT_IS_FALSE(result);
+}
+
+/* Tests_SRS_UTF8_CHECKER_01_009: [ 000uuuuu zzzzyyyy yyxxxxxx 11110uuu 10uuzzzz 10yyyyyy 10xxxxxx ]*/
+TEST_FUNCTION(utf8_checker_with_an_overlong_4_byte_code_with_F0_lead_fails)
+{
+    // arrange
+    bool result;
+    unsigned char test_str[] = { 0xF0, 0x8F, 0xBF, 0xBF };
+
+    // act
+    result = utf8_checker_is_valid_utf8(test_str, sizeof(test_str));
+
+    // assert
+    ASSERT_IS_FALSE(result);
+}
+
+/* utf8_checker_create */
+
+/* Tests_SRS_UTF8_CHECKER_01_010: [ `utf8_checker_create` shall allocate a new checker instance and return a non-NULL handle to it. ]*/
+/* Tests_SRS_UTF8_CHECKER_01_012: [ A newly created checker shall be in the same state as one on which no bytes have been processed. ]*/
+TEST_FUNCTION(utf8_checker_create_returns_a_checker_that_is_complete)
+{
+    // arrange
+    UTF8_CHECKER_HANDLE utf8_checker;
+
+    // act
+    utf8_checker = utf8_checker_create();
+
+    // assert
+    ASSERT_IS_NOT_NULL(utf8_checker);
+    ASSERT_IS_TRUE(utf8_checker_is_complete(utf8_checker));
+
+    // cleanup
+    utf8_checker_destroy(utf8_checker);
+}
+
+/* utf8_checker_destroy */
+
+/* Tests_SRS_UTF8_CHECKER_01_014: [ If `utf8_checker` is NULL, `utf8_checker_destroy` shall do nothing. ]*/
+TEST_FUNCTION(utf8_checker_destroy_with_NULL_does_nothing)
+{
+    // arrange
+
+    // act
+    utf8_checker_destroy(NULL);
+
+    // assert
+    // no explicit assert
+}
+
+/* utf8_checker_process */
+
+/* Tests_SRS_UTF8_CHECKER_01_021: [ If `utf8_checker` or `utf8_str` is NULL, `utf8_checker_process` shall return false. ]*/
+TEST_FUNCTION(utf8_checker_process_with_NULL_handle_fails)
+{
+    // arrange
+    bool result;
+
+    // act
+    result = utf8_checker_process(NULL, (const unsigned char*)"a", 1);
+
+    // assert
+    ASSERT_IS_FALSE(result);
+}
+
+/* Tests_SRS_UTF8_CHECKER_01_021: [ If `utf8_checker` or `utf8_str` is NULL, `utf8_checker_process` shall return false. ]*/
+TEST_FUNCTION(utf8_checker_process_with_NULL_utf8_str_fails)
+{
+    // arrange
+    bool result;
+    UTF8_CHECKER_HANDLE utf8_checker = utf8_checker_create();
+
+    // act
+    result = utf8_checker_process(utf8_checker, NULL, 1);
+
+    // assert
+    ASSERT_IS_FALSE(result);
+
+    // cleanup
+    utf8_checker_destroy(utf8_checker);
+}
+
+/* Tests_SRS_UTF8_CHECKER_01_017: [ `utf8_checker_process` shall continue validating from where the previous call left off, so that a code point may be split across calls. ]*/
+/* Tests_SRS_UTF8_CHECKER_01_018: [ If the bytes processed so far are valid UTF-8 or a prefix of valid UTF-8, `utf8_checker_process` shall return true. ]*/
+/* Tests_SRS_UTF8_CHECKER_01_022: [ `utf8_checker_is_complete` shall return true if all bytes processed so far form complete, valid UTF-8 codepoints. ]*/
+/* Tests_SRS_UTF8_CHECKER_01_023: [ If an invalid sequence was detected or the last code point is incomplete, `utf8_checker_is_complete` shall return false. ]*/
+TEST_FUNCTION(utf8_checker_process_with_the_input_split_at_every_position_succeeds)
+{
+    // arrange
+    unsigned char test_str[] = { 'a', 0xC3, 0xA9, 'x', 0xE4, 0xB8, 0xAD, 0xF0, 0x9F, 0x98, 0x80, 'z' };
+    size_t split;
+    UTF8_CHECKER_HANDLE utf8_checker = utf8_checker_create();
+
+    for (split = 0; split <= sizeof(test_str); split++)
+    {
+        bool first_result;
+        bool second_result;
+        utf8_checker_reset(utf8_checker);
+
+        // act
+        first_result = utf8_checker_process(utf8_checker, test_str, split);
+        second_result = utf8_checker_process(utf8_checker, test_str + split, sizeof(test_str) - split);
+
+        // assert
+        ASSERT_IS_TRUE(first_result);
+        ASSERT_IS_TRUE(second_result);
+        ASSERT_IS_TRUE(utf8_checker_is_complete(utf8_checker));
+    }
+
+    // cleanup
+    utf8_checker_destroy(utf8_checker);
+}
+
+/* Tests_SRS_UTF8_CHECKER_01_018: [ If the bytes processed so far are valid UTF-8 or a prefix of valid UTF-8, `utf8_checker_process` shall return true. ]*/
+/* Tests_SRS_UTF8_CHECKER_01_023: [ If an invalid sequence was detected or the last code point is incomplete, `utf8_checker_is_complete` shall return false. ]*/
+TEST_FUNCTION(utf8_checker_process_with_a_truncated_code_point_is_not_complete)
+{
+    // arrange
+    bool result;
+    unsigned char test_str[] = { 'a', 0xE4, 0xB8 };
+    UTF8_CHECKER_HANDLE utf8_checker = utf8_checker_create();
+
+    // act
+    result = utf8_checker_process(utf8_checker, test_str, sizeof(test_str));
+
+    // assert
+    ASSERT_IS_TRUE(result);
+    ASSERT_IS_FALSE(utf8_checker_is_complete(utf8_checker));
+
+    // cleanup
+    utf8_checker_destroy(utf8_checker);
+}
+
+/* Tests_SRS_UTF8_CHECKER_01_019: [ Otherwise `utf8_checker_process` shall return false. ]*/
+/* Tests_SRS_UTF8_CHECKER_01_020: [ Once an invalid sequence has been detected, `utf8_checker_process` shall return false without examining further bytes until the checker is reset. ]*/
+TEST_FUNCTION(utf8_checker_process_after_an_invalid_sequence_keeps_failing)
+{
+    // arrange
+    bool first_result;
+    bool second_result;
+    unsigned char test_str[] = { 0xC3 };
+    UTF8_CHECKER_HANDLE utf8_checker = utf8_checker_create();
+    (void)utf8_checker_process(utf8_checker, test_str, sizeof(test_str));
+
+    // act
+    first_result = utf8_checker_process(utf8_checker, (const unsigned char*)"a", 1);
+    second_result = utf8_checker_process(utf8_checker, (const unsigned char*)"a", 1);
+
+    // assert
+    ASSERT_IS_FALSE(first_result);
+    ASSERT_IS_FALSE(second_result);
+    ASSERT_IS_FALSE(utf8_checker_is_complete(utf8_checker));
+
+    // cleanup
+    utf8_checker_destroy(utf8_checker);
+}
+
+/* utf8_checker_reset */
+
+/* Tests_SRS_UTF8_CHECKER_01_015: [ `utf8_checker_reset` shall discard all bytes processed so far, including a previously detected invalid sequence. ]*/
+TEST_FUNCTION(utf8_checker_reset_after_an_invalid_sequence_allows_new_input)
+{
+    // arrange
+    bool result;
+    unsigned char test_str[] = { 0xFF };
+    UTF8_CHECKER_HANDLE utf8_checker = utf8_checker_create();
+    (void)utf8_checker_process(utf8_checker, test_str, sizeof(test_str));
+
+    // act
+    utf8_checker_reset(utf8_checker);
+    result = utf8_checker_process(utf8_checker, (const unsigned char*)"abc", 3);
+
+    // assert
+    ASSERT_IS_TRUE(result);
+    ASSERT_IS_TRUE(utf8_checker_is_complete(utf8_checker));
+
+    // cleanup
+    utf8_checker_destroy(utf8_checker);
+}
+
+/* utf8_checker_is_complete */
+
+/* Tests_SRS_UTF8_CHECKER_01_024: [ If `utf8_checker` is NULL, `utf8_checker_is_complete` shall return false. ]*/
+TEST_FUNCTION(utf8_checker_is_complete_with_NULL_handle_returns_false)
+{
+    // arrange
+    bool result;
+
+    // act
+    result = utf8_checker_is_complete(NULL);
+
+    // assert
+    ASSERT_IS_FALSE(result);
+}
+
 END_TEST_SUITE(utf8_checker_ut)
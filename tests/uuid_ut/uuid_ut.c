@@ -3,8 +3,10 @@
 
 #ifdef __cplusplus
 #include <cstdlib>
+#include <cstring>
 #else
 #include <stdlib.h>
+#include <string.h>
 #endif
 
 #include "testrunnerswitcher.h"
@@ -40,27 +42,40 @@ static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 static UUID TEST_UUID = { 222, 193, 74, 152, 197, 252, 67, 14, 180, 227, 51, 193, 196, 52, 220, 175 };
 static char* TEST_UUID_STRING = "dec14a98-c5fc-430e-b4e3-33c1c434dcaf";
 
-static UNIQUEID_RESULT mock_UniqueId_Generate_result;
-static UNIQUEID_RESULT mock_UniqueId_Generate(char* uid, size_t bufferSize)
+static UNIQUEID_RESULT mock_UniqueId_GetRandomBytes_result;
+static UNIQUEID_RESULT mock_UniqueId_GetRandomBytes(unsigned char* buffer, size_t size)
 {
-    (void)memcpy(uid, TEST_UUID_STRING, bufferSize);
-    return mock_UniqueId_Generate_result;
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        buffer[i] = TEST_UUID[i % UUID_OCTET_COUNT];
+    }
+    return mock_UniqueId_GetRandomBytes_result;
+}
+
+static UNIQUEID_RESULT mock_UniqueId_GetTimestampSequence(uint64_t* unix_time_ms, uint16_t* sequence)
+{
+    *unix_time_ms = 0x0123456789ABULL;
+    *sequence = 0xCDE;
+    return UNIQUEID_OK;
 }
 
 static void initialize_variables()
 {
-    mock_UniqueId_Generate_result = UNIQUEID_OK;
+    mock_UniqueId_GetRandomBytes_result = UNIQUEID_OK;
 }
 
 static void register_global_mock_returns()
 {
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(malloc, NULL);
-    REGISTER_GLOBAL_MOCK_FAIL_RETURN(UniqueId_Generate, UNIQUEID_ERROR);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(UniqueId_GetRandomBytes, UNIQUEID_ERROR);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(UniqueId_GetTimestampSequence, UNIQUEID_ERROR);
 }
 
 static void register_global_function_hooks()
 {
-    REGISTER_GLOBAL_MOCK_HOOK(UniqueId_Generate, mock_UniqueId_Generate);
+    REGISTER_GLOBAL_MOCK_HOOK(UniqueId_GetRandomBytes, mock_UniqueId_GetRandomBytes);
+    REGISTER_GLOBAL_MOCK_HOOK(UniqueId_GetTimestampSequence, mock_UniqueId_GetTimestampSequence);
 }
 
 static void register_mock_aliases()
@@ -123,21 +138,17 @@ TEST_FUNCTION(UUID_generate_NULL_uuid)
     ASSERT_ARE_NOT_EQUAL(int, 0, result);
 }
 
-// Tests_SRS_UUID_09_002: [ UUID_generate shall obtain an UUID string from UniqueId_Generate ]
-// Tests_SRS_UUID_09_004: [ The UUID string shall be parsed into an UUID type (16 unsigned char array) and filled in `uuid` ]  
+// Tests_SRS_UUID_09_002: [ UUID_generate shall obtain 16 random bytes from UniqueId_GetRandomBytes ]
+// Tests_SRS_UUID_09_004: [ The version and variant bits of `uuid` shall be set as per RFC 4122 for a version 4 (random) UUID ]
 // Tests_SRS_UUID_09_006: [ If no failures occur, UUID_generate shall return zero ]
 TEST_FUNCTION(UUID_generate_succeed)
 {
     //Arrange
     UUID uuid;
     int result;
-    char uuid_string[UUID_STRING_SIZE];
 
     umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(malloc(UUID_STRING_SIZE))
-        .SetReturn(uuid_string);
-    STRICT_EXPECTED_CALL(UniqueId_Generate(uuid_string, UUID_STRING_SIZE));
-    STRICT_EXPECTED_CALL(free(uuid_string));
+    STRICT_EXPECTED_CALL(UniqueId_GetRandomBytes(IGNORED_PTR_ARG, UUID_OCTET_COUNT));
 
     //Act
     result = UUID_generate(&uuid);
@@ -155,38 +166,118 @@ TEST_FUNCTION(UUID_generate_succeed)
     }
 }
 
-// Tests_SRS_UUID_09_003: [ If the UUID string fails to be obtained, UUID_generate shall fail and return a non-zero value ]
-// Tests_SRS_UUID_09_005: [ If `uuid` fails to be set, UUID_generate shall fail and return a non-zero value ]
+// Tests_SRS_UUID_09_004: [ The version and variant bits of `uuid` shall be set as per RFC 4122 for a version 4 (random) UUID ]
+TEST_FUNCTION(UUID_generate_sets_the_version_and_variant_bits)
+{
+    //Arrange
+    UUID uuid;
+    int result;
+
+    umock_c_reset_all_calls();
+    mock_UniqueId_GetRandomBytes_result = UNIQUEID_OK;
+    STRICT_EXPECTED_CALL(UniqueId_GetRandomBytes(IGNORED_PTR_ARG, UUID_OCTET_COUNT));
+
+    //Act
+    result = UUID_generate(&uuid);
+
+    //Assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0x40, uuid[6] & 0xF0);
+    ASSERT_ARE_EQUAL(int, 0x80, uuid[8] & 0xC0);
+}
+
+// Tests_SRS_UUID_09_003: [ If the random bytes fail to be obtained, UUID_generate shall fail and return a non-zero value ]
 TEST_FUNCTION(UUID_generate_failure_checks)
+{
+    //Arrange
+    UUID uuid;
+    int result;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(UniqueId_GetRandomBytes(IGNORED_PTR_ARG, UUID_OCTET_COUNT))
+        .SetReturn(UNIQUEID_ERROR);
+
+    //Act
+    result = UUID_generate(&uuid);
+
+    //Assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+// Tests_SRS_UUID_01_010: [ If `uuid` is NULL, `UUID_generate_v7` shall fail and return a non-zero value. ]
+TEST_FUNCTION(UUID_generate_v7_NULL_uuid)
+{
+    //Arrange
+    int result;
+
+    umock_c_reset_all_calls();
+
+    //Act
+    result = UUID_generate_v7(NULL);
+
+    //Assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+// Tests_SRS_UUID_01_011: [ `UUID_generate_v7` shall obtain a millisecond Unix timestamp and a sequence number by calling `UniqueId_GetTimestampSequence`. ]
+// Tests_SRS_UUID_01_013: [ `UUID_generate_v7` shall obtain the last 8 bytes of `uuid` by calling `UniqueId_GetRandomBytes`. ]
+// Tests_SRS_UUID_01_015: [ Octets 0 to 5 of `uuid` shall hold the 48 bit timestamp in big endian order. ]
+// Tests_SRS_UUID_01_016: [ The version nibble shall be 7 and the following 12 bits shall hold the sequence number. ]
+// Tests_SRS_UUID_01_017: [ The variant bits shall be set as per RFC 4122. ]
+// Tests_SRS_UUID_01_018: [ On success `UUID_generate_v7` shall return 0. ]
+TEST_FUNCTION(UUID_generate_v7_succeed)
+{
+    //Arrange
+    static const unsigned char expected_prefix[8] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0x7C, 0xDE };
+    UUID uuid;
+    int result;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(UniqueId_GetTimestampSequence(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(UniqueId_GetRandomBytes(IGNORED_PTR_ARG, 8));
+
+    //Act
+    result = UUID_generate_v7(&uuid);
+
+    //Assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(uuid, expected_prefix, sizeof(expected_prefix)));
+    ASSERT_ARE_EQUAL(int, 0x80, uuid[8] & 0xC0);
+    ASSERT_ARE_EQUAL(int, TEST_UUID[1], uuid[9]);
+    ASSERT_ARE_EQUAL(int, TEST_UUID[7], uuid[15]);
+}
+
+// Tests_SRS_UUID_01_012: [ If `UniqueId_GetTimestampSequence` fails, `UUID_generate_v7` shall fail and return a non-zero value. ]
+// Tests_SRS_UUID_01_014: [ If `UniqueId_GetRandomBytes` fails, `UUID_generate_v7` shall fail and return a non-zero value. ]
+TEST_FUNCTION(UUID_generate_v7_failure_checks)
 {
     //Arrange
     UUID uuid;
     int result;
     size_t i;
-    char uuid_string[UUID_STRING_SIZE];
 
     ASSERT_ARE_EQUAL(int, 0, umock_c_negative_tests_init());
 
     umock_c_reset_all_calls();
-    STRICT_EXPECTED_CALL(malloc(UUID_STRING_SIZE))
-        .SetReturn(uuid_string);
-    STRICT_EXPECTED_CALL(UniqueId_Generate(uuid_string, UUID_STRING_SIZE));
-    STRICT_EXPECTED_CALL(free(uuid_string));
+    STRICT_EXPECTED_CALL(UniqueId_GetTimestampSequence(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(UniqueId_GetRandomBytes(IGNORED_PTR_ARG, 8));
     umock_c_negative_tests_snapshot();
 
     for (i = 0; i < umock_c_negative_tests_call_count(); i++)
     {
         char temp_str[64];
 
-        if (i == 2) continue;
-
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(i);
 
         (void)sprintf(temp_str, "On failed call %zu", i);
 
         // act
-        result = UUID_generate(&uuid);
+        result = UUID_generate_v7(&uuid);
 
         // assert
         ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, 0, result, temp_str);
@@ -196,6 +287,90 @@ TEST_FUNCTION(UUID_generate_failure_checks)
     umock_c_negative_tests_deinit();
 }
 
+// Tests_SRS_UUID_01_005: [ If `uuids` is NULL or `count` is 0, `UUID_generate_batch` shall fail and return a non-zero value. ]
+TEST_FUNCTION(UUID_generate_batch_NULL_uuids)
+{
+    //Arrange
+    int result;
+
+    umock_c_reset_all_calls();
+
+    //Act
+    result = UUID_generate_batch(NULL, 2);
+
+    //Assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+// Tests_SRS_UUID_01_005: [ If `uuids` is NULL or `count` is 0, `UUID_generate_batch` shall fail and return a non-zero value. ]
+TEST_FUNCTION(UUID_generate_batch_zero_count)
+{
+    //Arrange
+    UUID uuids[2];
+    int result;
+
+    umock_c_reset_all_calls();
+
+    //Act
+    result = UUID_generate_batch(uuids, 0);
+
+    //Assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+// Tests_SRS_UUID_01_006: [ `UUID_generate_batch` shall obtain the random bytes for all `count` UUIDs with a single call to `UniqueId_GetRandomBytes`. ]
+// Tests_SRS_UUID_01_008: [ The version and variant bits of each UUID shall be set as per RFC 4122 for a version 4 (random) UUID. ]
+// Tests_SRS_UUID_01_009: [ On success `UUID_generate_batch` shall return 0. ]
+TEST_FUNCTION(UUID_generate_batch_succeed)
+{
+    //Arrange
+    UUID uuids[3];
+    int result;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(UniqueId_GetRandomBytes(IGNORED_PTR_ARG, 3 * UUID_OCTET_COUNT));
+
+    //Act
+    result = UUID_generate_batch(uuids, 3);
+
+    //Assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    {
+        int i;
+        int j;
+        for (j = 0; j < 3; j++)
+        {
+            for (i = 0; i < UUID_OCTET_COUNT; i++)
+            {
+                ASSERT_ARE_EQUAL(int, TEST_UUID[i], uuids[j][i]);
+            }
+        }
+    }
+}
+
+// Tests_SRS_UUID_01_007: [ If `UniqueId_GetRandomBytes` fails, `UUID_generate_batch` shall fail and return a non-zero value. ]
+TEST_FUNCTION(UUID_generate_batch_failure_checks)
+{
+    //Arrange
+    UUID uuids[3];
+    int result;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(UniqueId_GetRandomBytes(IGNORED_PTR_ARG, 3 * UUID_OCTET_COUNT))
+        .SetReturn(UNIQUEID_ERROR);
+
+    //Act
+    result = UUID_generate_batch(uuids, 3);
+
+    //Assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
 // Tests_SRS_UUID_09_011: [ If `uuid` is NULL, UUID_to_string shall return a non-zero value ]  
 TEST_FUNCTION(UUID_to_string_NULL_uuid)
 {
@@ -325,7 +500,131 @@ TEST_FUNCTION(UUID_from_string_succeed)
     }
 }
 
+// Tests_SRS_UUID_09_008: [ Each pair of digits in `uuid_string`, excluding dashes, shall be read as a single HEX value and saved on the respective position in `uuid` ]
+TEST_FUNCTION(UUID_from_string_with_uppercase_digits_succeed)
+{
+    //Arrange
+    int result;
+    UUID uuid;
+
+    umock_c_reset_all_calls();
+
+    //Act
+    result = UUID_from_string("DEC14A98-C5FC-430E-B4E3-33C1C434DCAF", &uuid);
+
+    //Assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    {
+        int i;
+        for (i = 0; i < UUID_OCTET_COUNT; i++)
+        {
+            ASSERT_ARE_EQUAL(int, TEST_UUID[i], uuid[i]);
+        }
+    }
+}
+
 // Tests_SRS_UUID_09_009: [ If `uuid` fails to be generated, UUID_from_string shall return a non-zero value ]
-// To be implemented once sscanf mock is implemented.
+TEST_FUNCTION(UUID_from_string_with_invalid_strings_fails)
+{
+    //Arrange
+    static const char* invalid_strings[] =
+    {
+        "",
+        "dec14a98-c5fc-430e-b4e3-33c1c434dca",
+        "dec14a98-c5fc-430e-b4e3-33c1c434dcaf0",
+        "dec14a98c5fc-430e-b4e3-33c1c434dcaf0",
+        "dec14a98-c5fc-430e-b4e3+33c1c434dcaf",
+        "dec14a98-c5fc-430e-b4e3-33c1c434dcag",
+        "gec14a98-c5fc-430e-b4e3-33c1c434dcaf",
+        "dec14a98-c5fc-430e-b4e3-33c1c434dc-f"
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(invalid_strings) / sizeof(invalid_strings[0]); i++)
+    {
+        int result;
+        UUID uuid;
+
+        umock_c_reset_all_calls();
+
+        //Act
+        result = UUID_from_string(invalid_strings[i], &uuid);
+
+        //Assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, 0, result, invalid_strings[i]);
+    }
+}
+
+// Tests_SRS_UUID_01_001: [ If `uuid` or `destination` is NULL, `UUID_to_string_into` shall fail and return a non-zero value. ]
+TEST_FUNCTION(UUID_to_string_into_NULL_uuid)
+{
+    //Arrange
+    int result;
+    char buffer[UUID_STRING_SIZE];
+
+    umock_c_reset_all_calls();
+
+    //Act
+    result = UUID_to_string_into(NULL, buffer, sizeof(buffer));
+
+    //Assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+// Tests_SRS_UUID_01_001: [ If `uuid` or `destination` is NULL, `UUID_to_string_into` shall fail and return a non-zero value. ]
+TEST_FUNCTION(UUID_to_string_into_NULL_destination)
+{
+    //Arrange
+    int result;
+
+    umock_c_reset_all_calls();
+
+    //Act
+    result = UUID_to_string_into(&TEST_UUID, NULL, UUID_STRING_SIZE);
+
+    //Assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+// Tests_SRS_UUID_01_002: [ If `destination_size` is smaller than 37, `UUID_to_string_into` shall fail and return a non-zero value. ]
+TEST_FUNCTION(UUID_to_string_into_buffer_too_small)
+{
+    //Arrange
+    int result;
+    char buffer[UUID_STRING_SIZE];
+
+    umock_c_reset_all_calls();
+
+    //Act
+    result = UUID_to_string_into(&TEST_UUID, buffer, UUID_STRING_LENGTH);
+
+    //Assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+// Tests_SRS_UUID_01_003: [ `UUID_to_string_into` shall write the 36 character RFC 4122 representation of `uuid` using lowercase hex digits, followed by a NUL terminator, to `destination`. ]
+// Tests_SRS_UUID_01_004: [ On success `UUID_to_string_into` shall return 0. ]
+TEST_FUNCTION(UUID_to_string_into_succeed)
+{
+    //Arrange
+    int result;
+    char buffer[UUID_STRING_SIZE];
+
+    umock_c_reset_all_calls();
+
+    //Act
+    result = UUID_to_string_into(&TEST_UUID, buffer, sizeof(buffer));
+
+    //Assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_UUID_STRING, buffer);
+}
 
 END_TEST_SUITE(uuid_unittests)
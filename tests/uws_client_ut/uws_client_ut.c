@@ -60,6 +60,7 @@ Tests_SRS_UWS_CLIENT_01_211: [ One implication of this is that in absence of ext
 #include "azure_c_shared_utility/uws_frame_encoder.h"
 #include "azure_c_shared_utility/gb_rand.h"
 #include "azure_c_shared_utility/base64.h"
+#include "azure_c_shared_utility/utf8_checker.h"
 
 TEST_DEFINE_ENUM_TYPE(IO_OPEN_RESULT, IO_OPEN_RESULT_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(IO_OPEN_RESULT, IO_OPEN_RESULT_VALUES);
@@ -77,6 +78,7 @@ static const LIST_ITEM_HANDLE TEST_LIST_ITEM_HANDLE = (LIST_ITEM_HANDLE)0x4243;
 static const XIO_HANDLE TEST_IO_HANDLE = (XIO_HANDLE)0x4244;
 static const OPTIONHANDLER_HANDLE TEST_IO_OPTIONHANDLER_HANDLE = (OPTIONHANDLER_HANDLE)0x4446;
 static const OPTIONHANDLER_HANDLE TEST_OPTIONHANDLER_HANDLE = (OPTIONHANDLER_HANDLE)0x4447;
+static const UTF8_CHECKER_HANDLE TEST_UTF8_CHECKER_HANDLE = (UTF8_CHECKER_HANDLE)0x4448;
 static const STRING_HANDLE BASE64_ENCODED_STRING = (STRING_HANDLE)0x4447;
 
 static size_t currentmalloc_call;
@@ -212,7 +214,6 @@ static LIST_ITEM_HANDLE my_singlylinkedlist_find(SINGLYLINKEDLIST_HANDLE handle,
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/socketio.h"
 #include "azure_c_shared_utility/platform.h"
-#include "azure_c_shared_utility/utf8_checker.h"
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/optionhandler.h"
 
@@ -468,6 +469,9 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_RETURN(xio_create, TEST_IO_HANDLE);
     REGISTER_GLOBAL_MOCK_RETURN(xio_retrieveoptions, TEST_IO_OPTIONHANDLER_HANDLE);
     REGISTER_GLOBAL_MOCK_RETURN(utf8_checker_is_valid_utf8, true);
+    REGISTER_GLOBAL_MOCK_RETURN(utf8_checker_create, TEST_UTF8_CHECKER_HANDLE);
+    REGISTER_GLOBAL_MOCK_RETURN(utf8_checker_process, true);
+    REGISTER_GLOBAL_MOCK_RETURN(utf8_checker_is_complete, true);
     REGISTER_GLOBAL_MOCK_RETURN(Base64_Encode_Bytes, BASE64_ENCODED_STRING);
     REGISTER_GLOBAL_MOCK_RETURN(OptionHandler_FeedOptions, OPTIONHANDLER_OK);
     REGISTER_GLOBAL_MOCK_RETURN(OptionHandler_AddOption, OPTIONHANDLER_OK);
@@ -502,6 +506,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(OPTIONHANDLER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(UTF8_CHECKER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(pfCloneOption, void*);
     REGISTER_UMOCK_ALIAS_TYPE(pfSetOption, void*);
     REGISTER_UMOCK_ALIAS_TYPE(pfDestroyOption, void*);
@@ -3856,6 +3861,8 @@ TEST_FUNCTION(when_a_1_byte_text_frame_is_received_it_shall_be_indicated_to_the_
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_is_valid_utf8(IGNORED_PTR_ARG, 1))
+        .ValidateArgumentBuffer(1, expected_payload, sizeof(expected_payload));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 1))
         .ValidateArgumentBuffer(3, expected_payload, sizeof(expected_payload));
 
@@ -3924,6 +3931,7 @@ TEST_FUNCTION(when_a_0_bytes_text_frame_is_received_it_shall_be_indicated_to_the
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_is_valid_utf8(IGNORED_PTR_ARG, 0));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 0))
         .IgnoreArgument_buffer();
 
@@ -3978,11 +3986,18 @@ TEST_FUNCTION(when_a_fragmented_text_frame_is_received_it_shall_be_indicated_to_
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_create());
+    STRICT_EXPECTED_CALL(utf8_checker_process(TEST_UTF8_CHECKER_HANDLE, IGNORED_PTR_ARG, 125))
+        .ValidateArgumentBuffer(2, result_payload, 125);
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_process(TEST_UTF8_CHECKER_HANDLE, IGNORED_PTR_ARG, 130))
+        .ValidateArgumentBuffer(2, result_payload + 125, 130);
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_process(TEST_UTF8_CHECKER_HANDLE, IGNORED_PTR_ARG, 0));
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_is_complete(TEST_UTF8_CHECKER_HANDLE));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 255))
         .ValidateArgumentBuffer(3, result_payload, 255);
 
@@ -4181,6 +4196,8 @@ TEST_FUNCTION(pong_frame_can_be_injected_in_middle_of_fragmented_message)
     umock_c_reset_all_calls();
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_create());
+    STRICT_EXPECTED_CALL(utf8_checker_process(TEST_UTF8_CHECKER_HANDLE, IGNORED_PTR_ARG, 125));
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
@@ -4199,9 +4216,12 @@ TEST_FUNCTION(pong_frame_can_be_injected_in_middle_of_fragmented_message)
         .ValidateArgumentValue_handle(&buffer_handle);
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_process(TEST_UTF8_CHECKER_HANDLE, IGNORED_PTR_ARG, 130));
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_process(TEST_UTF8_CHECKER_HANDLE, IGNORED_PTR_ARG, 0));
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_is_complete(TEST_UTF8_CHECKER_HANDLE));
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 255))
         .ValidateArgumentBuffer(3, result_payload, 255);
 
@@ -4219,6 +4239,282 @@ TEST_FUNCTION(pong_frame_can_be_injected_in_middle_of_fragmented_message)
     uws_client_destroy(uws_client);
 }
 
+/* Tests_SRS_UWS_CLIENT_01_532: [ The payload of a text frame shall be validated as UTF-8 by calling `utf8_checker_is_valid_utf8` before it is indicated via `on_ws_frame_received`. ]*/
+/* Tests_SRS_UWS_CLIENT_01_533: [ If the payload of a text message is not valid UTF-8, uws shall report the error by calling `on_ws_error` with `WS_ERROR_BAD_FRAME_RECEIVED` and drop the message. ]*/
+TEST_FUNCTION(when_a_text_frame_with_invalid_UTF8_is_received_an_error_is_indicated)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char test_frame[] = { 0x81, 0x01, 0xFF };
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_is_valid_utf8(IGNORED_PTR_ARG, 1))
+        .SetReturn(false);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, test_frame, sizeof(test_frame));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_533: [ If the payload of a text message is not valid UTF-8, uws shall report the error by calling `on_ws_error` with `WS_ERROR_BAD_FRAME_RECEIVED` and drop the message. ]*/
+/* Tests_SRS_UWS_CLIENT_01_535: [ Each fragment of a fragmented text message shall be validated as it is received by calling `utf8_checker_process`, so that a code point may span fragments. ]*/
+/* Tests_SRS_UWS_CLIENT_01_538: [ If a fragment of a text message is not valid UTF-8, uws shall send a CLOSE frame with the status code 1007 (invalid frame payload data). ]*/
+TEST_FUNCTION(when_a_fragment_of_a_text_message_is_not_valid_UTF8_an_error_is_indicated_before_the_fragment_is_accumulated)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char first_fragment[] = { 0x01, 0x01, 'a' };
+    const unsigned char middle_fragment[] = { 0x00, 0x01, 0xFF };
+    unsigned char close_frame_payload[] = { 0x03, 0xEF };
+    unsigned char close_frame[] = { 0x88, 0x82, 0x00, 0x00, 0x00, 0x00, 0x03, 0xEF };
+    BUFFER_HANDLE buffer_handle;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    g_on_bytes_received(g_on_bytes_received_context, first_fragment, sizeof(first_fragment));
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_process(TEST_UTF8_CHECKER_HANDLE, IGNORED_PTR_ARG, 1))
+        .SetReturn(false);
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
+        .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(close_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, close_frame, sizeof(close_frame), IGNORED_PTR_ARG, NULL))
+        .ValidateArgumentBuffer(2, close_frame, sizeof(close_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, middle_fragment, sizeof(middle_fragment));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_539: [ After a fragment of a text message fails validation, the remaining fragments of that message up to and including the final one shall be dropped without indicating further errors. ]*/
+TEST_FUNCTION(after_an_invalid_text_fragment_a_continuation_frame_is_dropped_without_another_error)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char first_fragment[] = { 0x01, 0x01, 0xFF };
+    const unsigned char last_fragment[] = { 0x80, 0x01, 'a' };
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    STRICT_EXPECTED_CALL(utf8_checker_process(TEST_UTF8_CHECKER_HANDLE, IGNORED_PTR_ARG, 1))
+        .SetReturn(false);
+    g_on_bytes_received(g_on_bytes_received_context, first_fragment, sizeof(first_fragment));
+    umock_c_reset_all_calls();
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, last_fragment, sizeof(last_fragment));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_538: [ If a fragment of a text message is not valid UTF-8, uws shall send a CLOSE frame with the status code 1007 (invalid frame payload data). ]*/
+/* Tests_SRS_UWS_CLIENT_01_539: [ After a fragment of a text message fails validation, the remaining fragments of that message up to and including the final one shall be dropped without indicating further errors. ]*/
+TEST_FUNCTION(when_an_invalid_first_text_fragment_and_a_continuation_frame_are_received_together_the_connection_is_closed_once)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char fragments[] = { 0x01, 0x01, 0xFF, 0x00, 0x01, 0xFF, 0x80, 0x01, 'a' };
+    unsigned char close_frame_payload[] = { 0x03, 0xEF };
+    unsigned char close_frame[] = { 0x88, 0x82, 0x00, 0x00, 0x00, 0x00, 0x03, 0xEF };
+    BUFFER_HANDLE buffer_handle;
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_create());
+    STRICT_EXPECTED_CALL(utf8_checker_process(TEST_UTF8_CHECKER_HANDLE, IGNORED_PTR_ARG, 1))
+        .SetReturn(false);
+    STRICT_EXPECTED_CALL(uws_frame_encoder_encode(WS_CLOSE_FRAME, IGNORED_PTR_ARG, sizeof(close_frame_payload), true, true, 0))
+        .ValidateArgumentBuffer(2, close_frame_payload, sizeof(close_frame_payload))
+        .CaptureReturn(&buffer_handle);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(close_frame);
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle)
+        .SetReturn(sizeof(close_frame));
+    STRICT_EXPECTED_CALL(xio_send(TEST_IO_HANDLE, close_frame, sizeof(close_frame), IGNORED_PTR_ARG, NULL))
+        .ValidateArgumentBuffer(2, close_frame, sizeof(close_frame));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .ValidateArgumentValue_handle(&buffer_handle);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, fragments, sizeof(fragments));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_536: [ When the final fragment of a text message is received, uws shall call `utf8_checker_is_complete` and treat an incomplete code point at the end of the message as invalid UTF-8. ]*/
+TEST_FUNCTION(when_a_fragmented_text_message_ends_with_an_incomplete_code_point_an_error_is_indicated)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char first_fragment[] = { 0x01, 0x01, 'a' };
+    const unsigned char last_fragment[] = { 0x80, 0x01, 0xC3 };
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    g_on_bytes_received(g_on_bytes_received_context, first_fragment, sizeof(first_fragment));
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_process(TEST_UTF8_CHECKER_HANDLE, IGNORED_PTR_ARG, 1));
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_is_complete(TEST_UTF8_CHECKER_HANDLE))
+        .SetReturn(false);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_BAD_FRAME_RECEIVED));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, last_fragment, sizeof(last_fragment));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_534: [ The UTF-8 checker used for fragmented text messages shall be created by calling `utf8_checker_create` when the first fragmented text message is received. ]*/
+TEST_FUNCTION(when_a_second_fragmented_text_message_is_received_the_UTF8_checker_is_reset)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char first_fragment[] = { 0x01, 0x01, 'a' };
+    const unsigned char last_fragment[] = { 0x80, 0x01, 'b' };
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    g_on_bytes_received(g_on_bytes_received_context, first_fragment, sizeof(first_fragment));
+    g_on_bytes_received(g_on_bytes_received_context, last_fragment, sizeof(last_fragment));
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_reset(TEST_UTF8_CHECKER_HANDLE));
+    STRICT_EXPECTED_CALL(utf8_checker_process(TEST_UTF8_CHECKER_HANDLE, IGNORED_PTR_ARG, 1));
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, first_fragment, sizeof(first_fragment));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
+/* Tests_SRS_UWS_CLIENT_01_534: [ The UTF-8 checker used for fragmented text messages shall be created by calling `utf8_checker_create` when the first fragmented text message is received. ]*/
+TEST_FUNCTION(when_creating_the_UTF8_checker_fails_an_error_is_indicated)
+{
+    // arrange
+    TLSIO_CONFIG tlsio_config;
+    UWS_CLIENT_HANDLE uws_client;
+    const char test_upgrade_response[] = "HTTP/1.1 101 Switching Protocols\r\n\r\n";
+    const unsigned char first_fragment[] = { 0x01, 0x01, 'a' };
+
+    tlsio_config.hostname = "test_host";
+    tlsio_config.port = 444;
+
+    uws_client = uws_client_create("test_host", 444, "/aaa", true, protocols, sizeof(protocols) / sizeof(protocols[0]));
+    (void)uws_client_open_async(uws_client, test_on_ws_open_complete, (void*)0x4242, test_on_ws_frame_received, (void*)0x4243, test_on_ws_peer_closed, (void*)0x4301, test_on_ws_error, (void*)0x4244);
+    g_on_io_open_complete(g_on_io_open_complete_context, IO_OPEN_OK);
+    g_on_bytes_received(g_on_bytes_received_context, (const unsigned char*)test_upgrade_response, sizeof(test_upgrade_response) - 1);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(utf8_checker_create())
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(test_on_ws_error((void*)0x4244, WS_ERROR_NOT_ENOUGH_MEMORY));
+
+    // act
+    g_on_bytes_received(g_on_bytes_received_context, first_fragment, sizeof(first_fragment));
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    uws_client_destroy(uws_client);
+}
+
 /* Tests_SRS_UWS_CLIENT_01_215: [ Control frames themselves MUST NOT be fragmented. ]*/
 TEST_FUNCTION(when_a_fragmented_control_frame_is_received_there_is_an_error)
 {
@@ -4951,6 +5247,8 @@ TEST_FUNCTION(when_2_complete_frames_are_received_together_with_the_upgrade_requ
 
     EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(test_on_ws_open_complete((void*)0x4242, WS_OPEN_OK));
+    STRICT_EXPECTED_CALL(utf8_checker_is_valid_utf8(IGNORED_PTR_ARG, 1))
+        .ValidateArgumentBuffer(1, "a", 1);
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_TEXT, IGNORED_PTR_ARG, 1))
         .ValidateArgumentBuffer(3, "a", 1);
     STRICT_EXPECTED_CALL(test_on_ws_frame_received((void*)0x4243, WS_FRAME_TYPE_BINARY, IGNORED_PTR_ARG, 0))